@@ -32,68 +32,36 @@
 
 #include "core/os/os.h"
 
-void CommandQueueMT::lock() {
-	mutex.lock();
-}
-
-void CommandQueueMT::unlock() {
-	mutex.unlock();
-}
-
 void CommandQueueMT::wait_for_flush() {
 	// wait one millisecond for a flush to happen
 	OS::get_singleton()->delay_usec(1000);
 }
 
 CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
-	int idx = -1;
-
 	while (true) {
-		lock();
 		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
-			if (!sync_sems[i].in_use) {
-				sync_sems[i].in_use = true;
-				idx = i;
-				break;
+			bool expected = false;
+			if (sync_sems[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				return &sync_sems[i];
 			}
 		}
-		unlock();
 
-		if (idx == -1) {
-			wait_for_flush();
-		} else {
-			break;
-		}
+		wait_for_flush();
 	}
-
-	return &sync_sems[idx];
 }
 
-bool CommandQueueMT::dealloc_one() {
-tryagain:
-	if (dealloc_ptr == write_ptr) {
-		// The queue is empty
-		return false;
-	}
-
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
-
-	if (size == 0) {
-		// End of command buffer wrap down
-		dealloc_ptr = 0;
-		goto tryagain;
-	}
-
-	if (size & 1) {
-		// Still used, nothing can be deallocated
-		return false;
-	}
-
-	dealloc_ptr += (size >> 1) + 8;
-	return true;
+void CommandQueueMT::_wait_sync_sem(SyncSemaphore *p_sem) {
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	p_sem->sem.wait();
+	sync_stall_usec.fetch_add(OS::get_singleton()->get_ticks_usec() - from, std::memory_order_relaxed);
+	sync_stall_count.fetch_add(1, std::memory_order_relaxed);
+	p_sem->in_use.store(false, std::memory_order_release);
 }
 
 CommandQueueMT::CommandQueueMT(bool p_sync) {
+	command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
+	zeromem(command_mem, COMMAND_MEM_SIZE);
+
 	if (p_sync) {
 		sync = memnew(Semaphore);
 	}
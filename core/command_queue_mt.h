@@ -31,12 +31,15 @@
 #ifndef COMMAND_QUEUE_MT_H
 #define COMMAND_QUEUE_MT_H
 
+#include "core/os/copymem.h"
 #include "core/os/memory.h"
-#include "core/os/mutex.h"
 #include "core/os/semaphore.h"
 #include "core/simple_type.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+#include <thread>
+
 #define COMMA(N) _COMMA_##N
 #define _COMMA_0
 #define _COMMA_1 ,
@@ -248,11 +251,11 @@
 #define DECL_PUSH(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>       \
 	void push(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
-		CMD_TYPE(N) *cmd = allocate_and_lock<CMD_TYPE(N)>();                 \
+		CMD_TYPE(N) *cmd = allocate<CMD_TYPE(N)>();                          \
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
+		commit(cmd);                                                         \
 		if (sync)                                                            \
 			sync->post();                                                    \
 	}
@@ -262,18 +265,18 @@
 #define DECL_PUSH_AND_RET(N)                                                                   \
 	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R>                \
 	void push_and_ret(T *p_instance, M p_method, COMMA_SEP_LIST(PARAM, N) COMMA(N) R *r_ret) { \
+		_pre_sync();                                                                           \
 		SyncSemaphore *ss = _alloc_sync_sem();                                                 \
-		CMD_RET_TYPE(N) *cmd = allocate_and_lock<CMD_RET_TYPE(N)>();                           \
+		CMD_RET_TYPE(N) *cmd = allocate<CMD_RET_TYPE(N)>();                                    \
 		cmd->instance = p_instance;                                                            \
 		cmd->method = p_method;                                                                \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
+		commit(cmd);                                                                           \
 		if (sync)                                                                              \
 			sync->post();                                                                      \
-		ss->sem.wait();                                                                        \
-		ss->in_use = false;                                                                    \
+		_wait_sync_sem(ss);                                                                    \
 	}
 
 #define CMD_SYNC_TYPE(N) CommandSync##N<T, M COMMA(N) COMMA_SEP_LIST(TYPE_ARG, N)>
@@ -281,25 +284,29 @@
 #define DECL_PUSH_AND_SYNC(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>                \
 	void push_and_sync(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
+		_pre_sync();                                                                  \
 		SyncSemaphore *ss = _alloc_sync_sem();                                        \
-		CMD_SYNC_TYPE(N) *cmd = allocate_and_lock<CMD_SYNC_TYPE(N)>();                \
+		CMD_SYNC_TYPE(N) *cmd = allocate<CMD_SYNC_TYPE(N)>();                         \
 		cmd->instance = p_instance;                                                   \
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
+		commit(cmd);                                                                  \
 		if (sync)                                                                     \
 			sync->post();                                                             \
-		ss->sem.wait();                                                               \
-		ss->in_use = false;                                                           \
+		_wait_sync_sem(ss);                                                           \
 	}
 
 #define MAX_CMD_PARAMS 15
 
+// Multiple producer, single consumer queue of server commands.
+// Pushing does not lock: producers reserve room in the ring buffer with an
+// atomic and publish the command once written, the consumer runs commands in
+// the order they were reserved and gives the room back afterwards.
 class CommandQueueMT {
 	struct SyncSemaphore {
 		Semaphore sem;
-		bool in_use = false;
+		std::atomic<bool> in_use = { false };
 	};
 
 	struct CommandBase {
@@ -335,135 +342,116 @@ class CommandQueueMT {
 		SYNC_SEMAPHORES = 8
 	};
 
-	uint8_t *command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
-	uint32_t read_ptr = 0;
-	uint32_t write_ptr = 0;
-	uint32_t dealloc_ptr = 0;
+	// Precedes every command in the buffer. A size of 0 means the rest of the
+	// buffer was skipped and the next command is at the beginning.
+	struct CommandHeader {
+		uint32_t size;
+		std::atomic<uint32_t> ready;
+	};
+
+	static_assert(sizeof(CommandHeader) == 8, "Command header must keep commands 8 byte aligned.");
+
+	uint8_t *command_mem = nullptr;
+	// Both grow forever, positions in the buffer are taken modulo its size.
+	std::atomic<uint64_t> write_pos = { 0 };
+	std::atomic<uint64_t> read_pos = { 0 };
 	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex mutex;
 	Semaphore *sync = nullptr;
 
+	void (*pre_sync_func)(void *) = nullptr;
+	void *pre_sync_userdata = nullptr;
+
+	std::atomic<uint64_t> sync_stall_count = { 0 };
+	std::atomic<uint64_t> sync_stall_usec = { 0 };
+
 	template <class T>
 	T *allocate() {
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1)) + 8;
-
-	tryagain:
-
-		if (write_ptr < dealloc_ptr) {
-			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
-				// There is no more room, try to deallocate something
-				if (dealloc_one()) {
-					goto tryagain;
-				}
-				return nullptr;
+		const uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
+		const uint32_t alloc_size = size + sizeof(CommandHeader);
+
+		uint64_t pos = write_pos.load(std::memory_order_relaxed);
+		uint32_t padding;
+		while (true) {
+			uint32_t offset = pos % COMMAND_MEM_SIZE;
+			// Commands are never split, skip the end of the buffer if it does not fit.
+			padding = (COMMAND_MEM_SIZE - offset) < alloc_size ? COMMAND_MEM_SIZE - offset : 0;
+			uint64_t end = pos + padding + alloc_size;
+
+			if (end - read_pos.load(std::memory_order_acquire) > COMMAND_MEM_SIZE) {
+				// sleep a little until fetch happened and some room is made
+				wait_for_flush();
+				pos = write_pos.load(std::memory_order_relaxed);
+				continue;
 			}
-		} else {
-			// ahead of dealloc_ptr, check that there is room
-
-			if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + sizeof(uint32_t)) {
-				// no room at the end, wrap down;
 
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
-
-					// There is no more room, try to deallocate something
-					if (dealloc_one()) {
-						goto tryagain;
-					}
-					return nullptr;
-				}
-
-				// if this happens, it's a bug
-				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < 8, nullptr);
-				// zero means, wrap to beginning
-
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-				*p = 0;
-				write_ptr = 0;
-				goto tryagain;
+			if (write_pos.compare_exchange_weak(pos, end, std::memory_order_acq_rel)) {
+				break;
 			}
 		}
-		// Allocate the size and the 'in use' bit.
-		// First bit used to mark if command is still in use (1)
-		// or if it has been destroyed and can be deallocated (0).
-		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = (size << 1) | 1;
-		write_ptr += 8;
-		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += size;
-		return cmd;
-	}
 
-	template <class T>
-	T *allocate_and_lock() {
-		lock();
-		T *ret;
-
-		while ((ret = allocate<T>()) == nullptr) {
-			unlock();
-			// sleep a little until fetch happened and some room is made
-			wait_for_flush();
-			lock();
+		if (padding) {
+			CommandHeader *skip = reinterpret_cast<CommandHeader *>(&command_mem[pos % COMMAND_MEM_SIZE]);
+			skip->size = 0;
+			skip->ready.store(1, std::memory_order_release);
+			pos += padding;
 		}
 
-		return ret;
+		CommandHeader *header = reinterpret_cast<CommandHeader *>(&command_mem[pos % COMMAND_MEM_SIZE]);
+		header->size = size;
+		return memnew_placement(&command_mem[pos % COMMAND_MEM_SIZE + sizeof(CommandHeader)], T);
 	}
 
-	bool flush_one(bool p_lock = true) {
-		if (p_lock) {
-			lock();
-		}
-	tryagain:
-
-		// tried to read an empty queue
-		if (read_ptr == write_ptr) {
-			if (p_lock) {
-				unlock();
-			}
-			return false;
-		}
-
-		uint32_t size_ptr = read_ptr;
-		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
+	// Makes a command written by allocate() visible to the consumer.
+	_FORCE_INLINE_ void commit(CommandBase *p_cmd) {
+		CommandHeader *header = reinterpret_cast<CommandHeader *>(reinterpret_cast<uint8_t *>(p_cmd) - sizeof(CommandHeader));
+		header->ready.store(1, std::memory_order_release);
+	}
 
-		if (size == 0) {
-			//end of ringbuffer, wrap
-			read_ptr = 0;
-			goto tryagain;
+	_FORCE_INLINE_ void _pre_sync() {
+		if (pre_sync_func) {
+			pre_sync_func(pre_sync_userdata);
 		}
+	}
 
-		read_ptr += 8;
-
-		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
+	bool flush_one() {
+		while (true) {
+			uint64_t pos = read_pos.load(std::memory_order_relaxed);
+			if (pos == write_pos.load(std::memory_order_acquire)) {
+				// tried to read an empty queue
+				return false;
+			}
 
-		read_ptr += size;
+			uint32_t offset = pos % COMMAND_MEM_SIZE;
+			CommandHeader *header = reinterpret_cast<CommandHeader *>(&command_mem[offset]);
+			if (!header->ready.load(std::memory_order_acquire)) {
+				// Reserved, but the producer is still writing it.
+				std::this_thread::yield();
+				continue;
+			}
 
-		if (p_lock) {
-			unlock();
-		}
-		cmd->call();
-		if (p_lock) {
-			lock();
-		}
+			uint32_t size = header->size;
+			if (size == 0) {
+				//end of ringbuffer, wrap
+				zeromem(&command_mem[offset], COMMAND_MEM_SIZE - offset);
+				read_pos.store(pos + (COMMAND_MEM_SIZE - offset), std::memory_order_release);
+				continue;
+			}
 
-		cmd->post();
-		cmd->~CommandBase();
-		*(uint32_t *)&command_mem[size_ptr] &= ~1;
+			CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[offset + sizeof(CommandHeader)]);
+			cmd->call();
+			cmd->post();
+			cmd->~CommandBase();
 
-		if (p_lock) {
-			unlock();
+			// Clear it so stale data is never taken for the header of a later command.
+			zeromem(&command_mem[offset], size + sizeof(CommandHeader));
+			read_pos.store(pos + size + sizeof(CommandHeader), std::memory_order_release);
+			return true;
 		}
-		return true;
 	}
 
-	void lock();
-	void unlock();
 	void wait_for_flush();
 	SyncSemaphore *_alloc_sync_sem();
-	bool dealloc_one();
+	void _wait_sync_sem(SyncSemaphore *p_sem);
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -486,12 +474,21 @@ public:
 
 	void flush_all() {
 		//ERR_FAIL_COND(sync);
-		lock();
-		while (flush_one(false)) {
+		while (flush_one()) {
 		}
-		unlock();
 	}
 
+	// Called from the pushing thread before any command that waits for the
+	// server, so work deferred by the caller can be pushed ahead of it.
+	void set_pre_sync_callback(void (*p_func)(void *), void *p_userdata) {
+		pre_sync_func = p_func;
+		pre_sync_userdata = p_userdata;
+	}
+
+	// Totals since the queue was created, for commands that had to wait for the server.
+	uint64_t get_sync_stall_count() const { return sync_stall_count.load(std::memory_order_relaxed); }
+	uint64_t get_sync_stall_usec() const { return sync_stall_usec.load(std::memory_order_relaxed); }
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
@@ -36,7 +36,11 @@
 #include "core/io/resource_loader.h"
 #include "core/math/math_funcs.h"
 #include "core/os/copymem.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
 #include "core/print_string.h"
+#include "core/simd.h"
+#include "core/thread_work_pool.h"
 
 #include <stdio.h>
 
@@ -387,12 +391,301 @@ int Image::get_mipmap_count() const {
 	}
 }
 
+// Large images are processed in bands of rows on a shared pool of threads.
+// Only one operation uses the pool at a time, others (e.g. from the import
+// threads) run on their own thread rather than waiting for it.
+static ThreadWorkPool *image_thread_pool = nullptr;
+static Mutex image_thread_pool_mutex;
+static int image_thread_count = -1;
+
+#ifdef SIMD_ENABLED
+static bool image_simd_enabled = true;
+#else
+static bool image_simd_enabled = false;
+#endif
+
+// Below this many pixels, waking up the threads costs more than it saves.
+static const uint64_t IMAGE_PARALLEL_MIN_PIXELS = 128 * 128;
+
+template <class C>
+struct ImageRowBands {
+	C *job = nullptr;
+	uint32_t rows = 0;
+	uint32_t band_rows = 0;
+
+	void process_band(uint32_t p_band, void *p_userdata) {
+		uint32_t from = p_band * band_rows;
+		job->process_rows(from, MIN(from + band_rows, rows));
+	}
+};
+
+// Calls p_job->process_rows(from, to) until all of [0, p_rows) is done.
+// Bands never overlap, so jobs writing only to their own rows need no locking.
+template <class C>
+static void _process_rows(C *p_job, uint32_t p_rows, uint32_t p_row_pixels) {
+#ifndef NO_THREADS
+	if (image_thread_count != 0 && p_rows > 1 && uint64_t(p_rows) * p_row_pixels >= IMAGE_PARALLEL_MIN_PIXELS && image_thread_pool_mutex.try_lock() == OK) {
+		if (!image_thread_pool) {
+			image_thread_pool = memnew(ThreadWorkPool);
+			image_thread_pool->init(image_thread_count);
+		}
+
+		uint32_t threads = image_thread_pool->get_thread_count();
+		if (threads > 1) {
+			// A few bands per thread, so threads finishing early can take more.
+			ImageRowBands<C> bands;
+			bands.job = p_job;
+			bands.rows = p_rows;
+			bands.band_rows = MAX(p_rows / (threads * 4), 1u);
+			image_thread_pool->do_work((p_rows + bands.band_rows - 1) / bands.band_rows, &bands, &ImageRowBands<C>::process_band, nullptr);
+
+			image_thread_pool_mutex.unlock();
+			return;
+		}
+		image_thread_pool_mutex.unlock();
+	}
+#endif
+	p_job->process_rows(0, p_rows);
+}
+
+void Image::set_thread_count(int p_count) {
+	MutexLock lock(image_thread_pool_mutex);
+	if (image_thread_pool && p_count != image_thread_count) {
+		image_thread_pool->finish();
+		memdelete(image_thread_pool);
+		image_thread_pool = nullptr;
+	}
+	image_thread_count = p_count;
+}
+
+int Image::get_thread_count() {
+	MutexLock lock(image_thread_pool_mutex);
+	if (image_thread_count < 0) {
+		return OS::get_singleton()->get_processor_count();
+	}
+	return image_thread_count;
+}
+
+void Image::finish_threads() {
+	MutexLock lock(image_thread_pool_mutex);
+	if (image_thread_pool) {
+		image_thread_pool->finish();
+		memdelete(image_thread_pool);
+		image_thread_pool = nullptr;
+	}
+}
+
+void Image::set_simd_enabled(bool p_enabled) {
+#ifdef SIMD_ENABLED
+	image_simd_enabled = p_enabled;
+#endif
+}
+
+bool Image::is_simd_enabled() {
+	return image_simd_enabled;
+}
+
+struct ImageProcessRowsJob {
+	Image::ProcessRowsFunc func = nullptr;
+	void *userdata = nullptr;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+		func(userdata, p_from, p_to);
+	}
+};
+
+void Image::process_rows(uint32_t p_rows, uint32_t p_row_pixels, ProcessRowsFunc p_func, void *p_userdata) {
+	ImageProcessRowsJob job;
+	job.func = p_func;
+	job.userdata = p_userdata;
+	_process_rows(&job, p_rows, p_row_pixels);
+}
+
+struct ImageCompressBlockRowsJob {
+	Image::CompressBlockRowFunc func = nullptr;
+	void *userdata = nullptr;
+	const Image::CompressBlockRow *rows = nullptr;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+		for (uint32_t i = p_from; i < p_to; i++) {
+			func(userdata, rows[i]);
+		}
+	}
+};
+
+void Image::compress_block_rows(Format p_target_format, uint8_t *p_dst, CompressBlockRowFunc p_func, void *p_userdata) const {
+	ERR_FAIL_COND_MSG(!_can_modify(format), "Cannot compress an image that is already compressed or in a custom format.");
+
+	int mm_count = mipmaps ? get_image_required_mipmaps(width, height, p_target_format) : 0;
+	int pixel_size = get_format_pixel_size(format);
+	int block_size = (16 * get_format_pixel_size(p_target_format)) >> get_format_pixel_rshift(p_target_format);
+
+	Vector<CompressBlockRow> rows;
+	const uint8_t *src = data.ptr();
+
+	for (int i = 0; i <= mm_count; i++) {
+		int src_ofs, w, h;
+		_get_mipmap_offset_and_size(i, src_ofs, w, h);
+		uint8_t *dst = p_dst + get_image_mipmap_offset(width, height, p_target_format, i);
+		int row_blocks = (w + 3) / 4;
+
+		for (int y = 0; y < h; y += 4) {
+			CompressBlockRow row;
+			row.src = src + src_ofs + y * w * pixel_size;
+			row.dst = dst + (y / 4) * row_blocks * block_size;
+			row.width = w;
+			row.height = MIN(h - y, 4);
+			row.mipmap = i;
+			rows.push_back(row);
+		}
+	}
+
+	ImageCompressBlockRowsJob job;
+	job.func = p_func;
+	job.userdata = p_userdata;
+	job.rows = rows.ptr();
+	// Compressing a row of blocks takes far longer than filtering it, always worth the threads.
+	_process_rows(&job, rows.size(), IMAGE_PARALLEL_MIN_PIXELS);
+}
+
+// Averages 2x2 blocks of RGBA8 pixels from two source rows, rounding exactly like
+// Image::average_4_uint8(). Returns how many destination pixels were done, the
+// caller finishes the row.
+static uint32_t _average_4_rgba_simd(const uint8_t *p_up, const uint8_t *p_down, uint8_t *p_dst, uint32_t p_count) {
+	uint32_t i = 0;
+#ifdef SIMD_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+	for (; i + 1 < p_count; i += 2) {
+		__m128i up = _mm_loadu_si128((const __m128i *)(p_up + i * 8));
+		__m128i down = _mm_loadu_si128((const __m128i *)(p_down + i * 8));
+		// Source pixels 0 and 1, then 2 and 3, widened to 16 bits.
+		__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(down, zero));
+		__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(down, zero));
+		__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+		sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+		_mm_storel_epi64((__m128i *)(p_dst + i * 4), _mm_packus_epi16(sum, sum));
+	}
+#elif defined(SIMD_NEON)
+	for (; i + 1 < p_count; i += 2) {
+		uint8x16_t up = vld1q_u8(p_up + i * 8);
+		uint8x16_t down = vld1q_u8(p_down + i * 8);
+		uint16x8_t lo = vaddl_u8(vget_low_u8(up), vget_low_u8(down));
+		uint16x8_t hi = vaddl_u8(vget_high_u8(up), vget_high_u8(down));
+		uint16x8_t sum = vcombine_u16(vadd_u16(vget_low_u16(lo), vget_high_u16(lo)), vadd_u16(vget_low_u16(hi), vget_high_u16(hi)));
+		// Rounding shift, (sum + 2) >> 2.
+		vst1_u8(p_dst + i * 4, vrshrn_n_u16(sum, 2));
+	}
+#endif
+	return i;
+}
+
+// Same for RGBAF, adding in the same order as Image::average_4_float().
+static uint32_t _average_4_rgba_simd(const float *p_up, const float *p_down, float *p_dst, uint32_t p_count) {
+	uint32_t i = 0;
+#ifdef SIMD_SSE2
+	const __m128 quarter = _mm_set1_ps(0.25f);
+	for (; i < p_count; i++) {
+		__m128 sum = _mm_add_ps(_mm_loadu_ps(p_up + i * 8), _mm_loadu_ps(p_up + i * 8 + 4));
+		sum = _mm_add_ps(_mm_add_ps(sum, _mm_loadu_ps(p_down + i * 8)), _mm_loadu_ps(p_down + i * 8 + 4));
+		_mm_storeu_ps(p_dst + i * 4, _mm_mul_ps(sum, quarter));
+	}
+#elif defined(SIMD_NEON)
+	const float32x4_t quarter = vdupq_n_f32(0.25f);
+	for (; i < p_count; i++) {
+		float32x4_t sum = vaddq_f32(vld1q_f32(p_up + i * 8), vld1q_f32(p_up + i * 8 + 4));
+		sum = vaddq_f32(vaddq_f32(sum, vld1q_f32(p_down + i * 8)), vld1q_f32(p_down + i * 8 + 4));
+		vst1q_f32(p_dst + i * 4, vmulq_f32(sum, quarter));
+	}
+#endif
+	return i;
+}
+
+// Other components (half, RGBE9995) have no SIMD version.
+template <class Component>
+static uint32_t _average_4_rgba_simd(const Component *p_up, const Component *p_down, Component *p_dst, uint32_t p_count) {
+	return 0;
+}
+
+// Converts RGBAF pixels to RGBA8, scaling and clamping in double precision and
+// truncating like _set_color_at_ofs(). Returns how many pixels were done.
+static uint32_t _rgbaf_to_rgba8_simd(const float *p_src, uint8_t *p_dst, uint32_t p_count) {
+	uint32_t i = 0;
+#ifdef SIMD_SSE2
+	const __m128d scale = _mm_set1_pd(255.0);
+	const __m128d min = _mm_setzero_pd();
+	const __m128d max = _mm_set1_pd(255.0);
+	for (; i < p_count; i++) {
+		__m128 c = _mm_loadu_ps(p_src + i * 4);
+		__m128d rg = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_cvtps_pd(c), scale), min), max);
+		__m128d ba = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(c, c)), scale), min), max);
+		__m128i rgba = _mm_unpacklo_epi64(_mm_cvttpd_epi32(rg), _mm_cvttpd_epi32(ba));
+		rgba = _mm_packs_epi32(rgba, rgba);
+		rgba = _mm_packus_epi16(rgba, rgba);
+		uint32_t packed = _mm_cvtsi128_si32(rgba);
+		copymem(p_dst + i * 4, &packed, 4);
+	}
+#endif
+	return i;
+}
+
+// sRGB <-> linear tables, to filter 8 bit color in linear space.
+struct ImageSRGBTables {
+	enum {
+		BUCKETS = 4096
+	};
+
+	float to_linear[256];
+	// Linear values halfway (in sRGB) between i and i + 1, so the rounded sRGB
+	// value of a linear one is the number of thresholds below it.
+	float thresholds[255];
+	// Number of thresholds below the start of each bucket of linear values.
+	// Buckets are narrower than the gaps between thresholds, so counting from
+	// there takes a step or two at most. A power of two, so finding the bucket
+	// of a value doesn't round.
+	uint8_t bucket_start[BUCKETS + 1];
+
+	static float srgb_to_linear(double p_srgb) {
+		// Same curve as Color::to_linear().
+		return p_srgb < 0.04045 ? p_srgb * (1.0 / 12.92) : Math::pow((p_srgb + 0.055) * (1.0 / (1 + 0.055)), 2.4);
+	}
+
+	_FORCE_INLINE_ uint8_t to_srgb(float p_linear) const {
+		int srgb = bucket_start[CLAMP(int(p_linear * BUCKETS), 0, int(BUCKETS))];
+		while (srgb < 255 && thresholds[srgb] < p_linear) {
+			srgb++;
+		}
+		return srgb;
+	}
+
+	ImageSRGBTables() {
+		for (int i = 0; i < 256; i++) {
+			to_linear[i] = srgb_to_linear(i / 255.0);
+		}
+		for (int i = 0; i < 255; i++) {
+			thresholds[i] = srgb_to_linear((i + 0.5) / 255.0);
+		}
+		int srgb = 0;
+		for (int i = 0; i <= BUCKETS; i++) {
+			while (srgb < 255 && thresholds[srgb] < float(i) / BUCKETS) {
+				srgb++;
+			}
+			bucket_start[i] = srgb;
+		}
+	}
+};
+
+static const ImageSRGBTables &_get_srgb_tables() {
+	static ImageSRGBTables tables;
+	return tables;
+}
+
 //using template generates perfectly optimized code due to constant expression reduction and unused variable removal present in all compilers
 template <uint32_t read_bytes, bool read_alpha, uint32_t write_bytes, bool write_alpha, bool read_gray, bool write_gray>
-static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p_dst) {
+static void _convert_rows(int p_width, const uint8_t *p_src, uint8_t *p_dst, int p_from_row, int p_to_row) {
 	uint32_t max_bytes = MAX(read_bytes, write_bytes);
 
-	for (int y = 0; y < p_height; y++) {
+	for (int y = p_from_row; y < p_to_row; y++) {
 		for (int x = 0; x < p_width; x++) {
 			const uint8_t *rofs = &p_src[((y * p_width) + x) * (read_bytes + (read_alpha ? 1 : 0))];
 			uint8_t *wofs = &p_dst[((y * p_width) + x) * (write_bytes + (write_alpha ? 1 : 0))];
@@ -429,6 +722,59 @@ static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p
 	}
 }
 
+struct ImageConvertJob {
+	void (*rows_func)(int, const uint8_t *, uint8_t *, int, int) = nullptr;
+	int width = 0;
+	const uint8_t *src = nullptr;
+	uint8_t *dst = nullptr;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+		rows_func(width, src, dst, p_from, p_to);
+	}
+};
+
+template <uint32_t read_bytes, bool read_alpha, uint32_t write_bytes, bool write_alpha, bool read_gray, bool write_gray>
+static void _convert(int p_width, int p_height, const uint8_t *p_src, uint8_t *p_dst) {
+	ImageConvertJob job;
+	job.rows_func = _convert_rows<read_bytes, read_alpha, write_bytes, write_alpha, read_gray, write_gray>;
+	job.width = p_width;
+	job.src = p_src;
+	job.dst = p_dst;
+	_process_rows(&job, p_height, p_width);
+}
+
+// Converts through Color, for the formats _convert() can't handle.
+struct Image::ColorConvertJob {
+	const Image *src_image = nullptr;
+	Image *dst_image = nullptr;
+	const uint8_t *src = nullptr;
+	uint8_t *dst = nullptr;
+	float byte_to_float[256];
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+		uint32_t width = src_image->width;
+		uint32_t from = p_from * width;
+		uint32_t to = p_to * width;
+
+		if (src_image->format == FORMAT_RGBA8 && dst_image->format == FORMAT_RGBAF) {
+			// Table built with the same expression as _get_color_at_ofs().
+			float *dst_float = (float *)dst;
+			for (uint32_t i = from * 4; i < to * 4; i++) {
+				dst_float[i] = byte_to_float[src[i]];
+			}
+			return;
+		}
+
+		if (src_image->format == FORMAT_RGBAF && dst_image->format == FORMAT_RGBA8 && image_simd_enabled) {
+			from += _rgbaf_to_rgba8_simd((const float *)src + from * 4, dst + from * 4, to - from);
+		}
+
+		for (uint32_t i = from; i < to; i++) {
+			dst_image->_set_color_at_ofs(dst, i, src_image->_get_color_at_ofs(src, i));
+		}
+	}
+};
+
 void Image::convert(Format p_new_format) {
 	if (data.size() == 0) {
 		return;
@@ -442,14 +788,18 @@ void Image::convert(Format p_new_format) {
 		ERR_FAIL_MSG("Cannot convert to <-> from compressed formats. Use compress() and decompress() instead.");
 
 	} else if (format > FORMAT_RGBA8 || p_new_format > FORMAT_RGBA8) {
-		//use put/set pixel which is slower but works with non byte formats
+		//convert through Color, which is slower but works with non byte formats
 		Image new_img(width, height, false, p_new_format);
 
-		for (int i = 0; i < width; i++) {
-			for (int j = 0; j < height; j++) {
-				new_img.set_pixel(i, j, get_pixel(i, j));
-			}
+		ColorConvertJob job;
+		job.src_image = this;
+		job.dst_image = &new_img;
+		job.src = data.ptr();
+		job.dst = new_img.data.ptrw();
+		for (int i = 0; i < 256; i++) {
+			job.byte_to_float[i] = i / 255.0;
 		}
+		_process_rows(&job, height, width);
 
 		if (has_mipmaps()) {
 			new_img.generate_mipmaps();
@@ -587,8 +937,36 @@ static double _bicubic_interp_kernel(double x) {
 	return bc;
 }
 
+typedef void (*ImageScaleRowsFunc)(const uint8_t *, uint8_t *, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+
+struct ImageScaleJob {
+	ImageScaleRowsFunc rows_func = nullptr;
+	const uint8_t *src = nullptr;
+	uint8_t *dst = nullptr;
+	uint32_t src_width = 0;
+	uint32_t src_height = 0;
+	uint32_t dst_width = 0;
+	uint32_t dst_height = 0;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+		rows_func(src, dst, src_width, src_height, dst_width, dst_height, p_from, p_to);
+	}
+};
+
+static void _scale_parallel(ImageScaleRowsFunc p_rows_func, const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	ImageScaleJob job;
+	job.rows_func = p_rows_func;
+	job.src = p_src;
+	job.dst = p_dst;
+	job.src_width = p_src_width;
+	job.src_height = p_src_height;
+	job.dst_width = p_dst_width;
+	job.dst_height = p_dst_height;
+	_process_rows(&job, p_dst_height, p_dst_width);
+}
+
 template <int CC, class T>
-static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_cubic_rows(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 	// get source image size
 	int width = p_src_width;
 	int height = p_src_height;
@@ -603,7 +981,7 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 	int xmax = width - 1;
 	// temporary pointer
 
-	for (uint32_t y = 0; y < p_dst_height; y++) {
+	for (uint32_t y = p_from_row; y < p_to_row; y++) {
 		// Y coordinates
 		oy = (double)y * yfac - 0.5f;
 		oy1 = (int)oy;
@@ -675,7 +1053,12 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 }
 
 template <int CC, class T>
-static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	_scale_parallel(_scale_cubic_rows<CC, T>, p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height);
+}
+
+template <int CC, class T>
+static void _scale_bilinear_rows(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 	enum {
 		FRAC_BITS = 8,
 		FRAC_LEN = (1 << FRAC_BITS),
@@ -683,7 +1066,7 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 		FRAC_MASK = FRAC_LEN - 1
 	};
 
-	for (uint32_t i = 0; i < p_dst_height; i++) {
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 		// Add 0.5 in order to interpolate based on pixel center
 		uint32_t src_yofs_up_fp = (i + 0.5) * p_src_height * FRAC_LEN / p_dst_height;
 		// Calculate nearest src pixel center above current, and truncate to get y index
@@ -712,6 +1095,39 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 			src_xofs_left *= CC;
 			src_xofs_right *= CC;
 
+#ifdef SIMD_ENABLED
+			if (sizeof(T) == 4 && CC == 4 && image_simd_enabled) {
+				// Same operations as the float path below, on the four channels at once.
+				const float *src = (const float *)p_src;
+				float *dst = (float *)p_dst + i * p_dst_width * CC + j * CC;
+#ifdef SIMD_SSE2
+				__m128 xofs_frac = _mm_set1_ps(float(src_xofs_frac) / (1 << FRAC_BITS));
+				__m128 yofs_frac = _mm_set1_ps(float(src_yofs_frac) / (1 << FRAC_BITS));
+				__m128 p00 = _mm_loadu_ps(src + y_ofs_up + src_xofs_left);
+				__m128 p10 = _mm_loadu_ps(src + y_ofs_up + src_xofs_right);
+				__m128 p01 = _mm_loadu_ps(src + y_ofs_down + src_xofs_left);
+				__m128 p11 = _mm_loadu_ps(src + y_ofs_down + src_xofs_right);
+
+				__m128 interp_up = _mm_add_ps(p00, _mm_mul_ps(_mm_sub_ps(p10, p00), xofs_frac));
+				__m128 interp_down = _mm_add_ps(p01, _mm_mul_ps(_mm_sub_ps(p11, p01), xofs_frac));
+				_mm_storeu_ps(dst, _mm_add_ps(interp_up, _mm_mul_ps(_mm_sub_ps(interp_down, interp_up), yofs_frac)));
+#else
+				float32x4_t xofs_frac = vdupq_n_f32(float(src_xofs_frac) / (1 << FRAC_BITS));
+				float32x4_t yofs_frac = vdupq_n_f32(float(src_yofs_frac) / (1 << FRAC_BITS));
+				float32x4_t p00 = vld1q_f32(src + y_ofs_up + src_xofs_left);
+				float32x4_t p10 = vld1q_f32(src + y_ofs_up + src_xofs_right);
+				float32x4_t p01 = vld1q_f32(src + y_ofs_down + src_xofs_left);
+				float32x4_t p11 = vld1q_f32(src + y_ofs_down + src_xofs_right);
+
+				// Not vmlaq_f32, which may fuse and round differently.
+				float32x4_t interp_up = vaddq_f32(p00, vmulq_f32(vsubq_f32(p10, p00), xofs_frac));
+				float32x4_t interp_down = vaddq_f32(p01, vmulq_f32(vsubq_f32(p11, p01), xofs_frac));
+				vst1q_f32(dst, vaddq_f32(interp_up, vmulq_f32(vsubq_f32(interp_down, interp_up), yofs_frac)));
+#endif
+				continue;
+			}
+#endif
+
 			for (uint32_t l = 0; l < CC; l++) {
 				if (sizeof(T) == 1) { //uint8
 					uint32_t p00 = p_src[y_ofs_up + src_xofs_left + l] << FRAC_BITS;
@@ -765,8 +1181,13 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 }
 
 template <int CC, class T>
-static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
-	for (uint32_t i = 0; i < p_dst_height; i++) {
+static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	_scale_parallel(_scale_bilinear_rows<CC, T>, p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height);
+}
+
+template <int CC, class T>
+static void _scale_nearest_rows(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 		uint32_t src_yofs = i * p_src_height / p_dst_height;
 		uint32_t y_ofs = src_yofs * p_src_width * CC;
 
@@ -785,123 +1206,151 @@ static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict
 	}
 }
 
+template <int CC, class T>
+static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	_scale_parallel(_scale_nearest_rows<CC, T>, p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height);
+}
+
 #define LANCZOS_TYPE 3
 
 static float _lanczos(float p_x) {
 	return Math::abs(p_x) >= LANCZOS_TYPE ? 0 : Math::sincn(p_x) * Math::sincn(p_x / LANCZOS_TYPE);
 }
 
+// First pass, filters rows of the source horizontally into rows of p_buffer (src_height x dst_width floats).
 template <int CC, class T>
-static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+static void _scale_lanczos_h_rows(const uint8_t *__restrict p_src, uint8_t *__restrict p_buffer, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
 	int32_t src_width = p_src_width;
-	int32_t src_height = p_src_height;
-	int32_t dst_height = p_dst_height;
 	int32_t dst_width = p_dst_width;
+	float *buffer = (float *)p_buffer;
 
-	uint32_t buffer_size = src_height * dst_width * CC;
-	float *buffer = memnew_arr(float, buffer_size); // Store the first pass in a buffer
+	float x_scale = float(src_width) / float(dst_width);
 
-	{ // FIRST PASS (horizontal)
+	float scale_factor = MAX(x_scale, 1); // A larger kernel is required only when downscaling
+	int32_t half_kernel = LANCZOS_TYPE * scale_factor;
 
-		float x_scale = float(src_width) / float(dst_width);
+	float *kernel = memnew_arr(float, half_kernel * 2);
 
-		float scale_factor = MAX(x_scale, 1); // A larger kernel is required only when downscaling
-		int32_t half_kernel = LANCZOS_TYPE * scale_factor;
+	for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
+		// The corresponding point on the source image
+		float src_x = (buffer_x + 0.5f) * x_scale; // Offset by 0.5 so it uses the pixel's center
+		int32_t start_x = MAX(0, int32_t(src_x) - half_kernel + 1);
+		int32_t end_x = MIN(src_width - 1, int32_t(src_x) + half_kernel);
 
-		float *kernel = memnew_arr(float, half_kernel * 2);
+		// Create the kernel used by all the pixels of the column
+		for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
+			kernel[target_x - start_x] = _lanczos((target_x + 0.5f - src_x) / scale_factor);
+		}
 
-		for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
-			// The corresponding point on the source image
-			float src_x = (buffer_x + 0.5f) * x_scale; // Offset by 0.5 so it uses the pixel's center
-			int32_t start_x = MAX(0, int32_t(src_x) - half_kernel + 1);
-			int32_t end_x = MIN(src_width - 1, int32_t(src_x) + half_kernel);
+		for (int32_t buffer_y = p_from_row; buffer_y < int32_t(p_to_row); buffer_y++) {
+			float pixel[CC] = { 0 };
+			float weight = 0;
 
-			// Create the kernel used by all the pixels of the column
 			for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
-				kernel[target_x - start_x] = _lanczos((target_x + 0.5f - src_x) / scale_factor);
-			}
+				float lanczos_val = kernel[target_x - start_x];
+				weight += lanczos_val;
 
-			for (int32_t buffer_y = 0; buffer_y < src_height; buffer_y++) {
-				float pixel[CC] = { 0 };
-				float weight = 0;
+				const T *__restrict src_data = ((const T *)p_src) + (buffer_y * src_width + target_x) * CC;
 
-				for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
-					float lanczos_val = kernel[target_x - start_x];
-					weight += lanczos_val;
-
-					const T *__restrict src_data = ((const T *)p_src) + (buffer_y * src_width + target_x) * CC;
-
-					for (uint32_t i = 0; i < CC; i++) {
-						if (sizeof(T) == 2) { //half float
-							pixel[i] += Math::half_to_float(src_data[i]) * lanczos_val;
-						} else {
-							pixel[i] += src_data[i] * lanczos_val;
-						}
+				for (uint32_t i = 0; i < CC; i++) {
+					if (sizeof(T) == 2) { //half float
+						pixel[i] += Math::half_to_float(src_data[i]) * lanczos_val;
+					} else {
+						pixel[i] += src_data[i] * lanczos_val;
 					}
 				}
+			}
 
-				float *dst_data = ((float *)buffer) + (buffer_y * dst_width + buffer_x) * CC;
+			float *dst_data = buffer + (buffer_y * dst_width + buffer_x) * CC;
 
-				for (uint32_t i = 0; i < CC; i++) {
-					dst_data[i] = pixel[i] / weight; // Normalize the sum of all the samples
-				}
+			for (uint32_t i = 0; i < CC; i++) {
+				dst_data[i] = pixel[i] / weight; // Normalize the sum of all the samples
 			}
 		}
+	}
 
-		memdelete_arr(kernel);
-	} // End of first pass
+	memdelete_arr(kernel);
+}
 
-	{ // SECOND PASS (vertical + result)
+// Second pass, filters p_buffer vertically into rows of the result.
+template <int CC, class T>
+static void _scale_lanczos_v_rows(const uint8_t *__restrict p_buffer, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, uint32_t p_from_row, uint32_t p_to_row) {
+	int32_t src_height = p_src_height;
+	int32_t dst_height = p_dst_height;
+	int32_t dst_width = p_dst_width;
+	const float *buffer = (const float *)p_buffer;
 
-		float y_scale = float(src_height) / float(dst_height);
+	float y_scale = float(src_height) / float(dst_height);
 
-		float scale_factor = MAX(y_scale, 1);
-		int32_t half_kernel = LANCZOS_TYPE * scale_factor;
+	float scale_factor = MAX(y_scale, 1);
+	int32_t half_kernel = LANCZOS_TYPE * scale_factor;
 
-		float *kernel = memnew_arr(float, half_kernel * 2);
+	float *kernel = memnew_arr(float, half_kernel * 2);
 
-		for (int32_t dst_y = 0; dst_y < dst_height; dst_y++) {
-			float buffer_y = (dst_y + 0.5f) * y_scale;
-			int32_t start_y = MAX(0, int32_t(buffer_y) - half_kernel + 1);
-			int32_t end_y = MIN(src_height - 1, int32_t(buffer_y) + half_kernel);
+	for (int32_t dst_y = p_from_row; dst_y < int32_t(p_to_row); dst_y++) {
+		float buffer_y = (dst_y + 0.5f) * y_scale;
+		int32_t start_y = MAX(0, int32_t(buffer_y) - half_kernel + 1);
+		int32_t end_y = MIN(src_height - 1, int32_t(buffer_y) + half_kernel);
 
-			for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
-				kernel[target_y - start_y] = _lanczos((target_y + 0.5f - buffer_y) / scale_factor);
-			}
+		for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
+			kernel[target_y - start_y] = _lanczos((target_y + 0.5f - buffer_y) / scale_factor);
+		}
 
-			for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
-				float pixel[CC] = { 0 };
-				float weight = 0;
+		for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
+			float pixel[CC] = { 0 };
+			float weight = 0;
 
-				for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
-					float lanczos_val = kernel[target_y - start_y];
-					weight += lanczos_val;
+			for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
+				float lanczos_val = kernel[target_y - start_y];
+				weight += lanczos_val;
 
-					float *buffer_data = ((float *)buffer) + (target_y * dst_width + dst_x) * CC;
+				const float *buffer_data = buffer + (target_y * dst_width + dst_x) * CC;
 
-					for (uint32_t i = 0; i < CC; i++) {
-						pixel[i] += buffer_data[i] * lanczos_val;
-					}
+				for (uint32_t i = 0; i < CC; i++) {
+					pixel[i] += buffer_data[i] * lanczos_val;
 				}
+			}
 
-				T *dst_data = ((T *)p_dst) + (dst_y * dst_width + dst_x) * CC;
+			T *dst_data = ((T *)p_dst) + (dst_y * dst_width + dst_x) * CC;
 
-				for (uint32_t i = 0; i < CC; i++) {
-					pixel[i] /= weight;
-
-					if (sizeof(T) == 1) { //byte
-						dst_data[i] = CLAMP(Math::fast_ftoi(pixel[i]), 0, 255);
-					} else if (sizeof(T) == 2) { //half float
-						dst_data[i] = Math::make_half_float(pixel[i]);
-					} else { // float
-						dst_data[i] = pixel[i];
-					}
+			for (uint32_t i = 0; i < CC; i++) {
+				pixel[i] /= weight;
+
+				if (sizeof(T) == 1) { //byte
+					dst_data[i] = CLAMP(Math::fast_ftoi(pixel[i]), 0, 255);
+				} else if (sizeof(T) == 2) { //half float
+					dst_data[i] = Math::make_half_float(pixel[i]);
+				} else { // float
+					dst_data[i] = pixel[i];
 				}
 			}
 		}
+	}
+
+	memdelete_arr(kernel);
+}
+
+template <int CC, class T>
+static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	uint32_t buffer_size = p_src_height * p_dst_width * CC;
+	float *buffer = memnew_arr(float, buffer_size); // Store the first pass in a buffer
+
+	ImageScaleJob job;
+	job.src_width = p_src_width;
+	job.src_height = p_src_height;
+	job.dst_width = p_dst_width;
+	job.dst_height = p_dst_height;
 
-		memdelete_arr(kernel);
-	} // End of second pass
+	// The second pass needs every row of the first one, so they run one after the other.
+	job.rows_func = _scale_lanczos_h_rows<CC, T>;
+	job.src = p_src;
+	job.dst = (uint8_t *)buffer;
+	_process_rows(&job, p_src_height, p_dst_width);
+
+	job.rows_func = _scale_lanczos_v_rows<CC, T>;
+	job.src = (const uint8_t *)buffer;
+	job.dst = p_dst;
+	_process_rows(&job, p_dst_height, p_dst_width);
 
 	memdelete_arr(buffer);
 }
@@ -1414,20 +1863,28 @@ bool Image::_can_modify(Format p_format) const {
 template <class Component, int CC, bool renormalize,
 		void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
 		void (*renormalize_func)(Component *)>
-static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+static void _generate_po2_mipmap_rows(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_from_row, uint32_t p_to_row) {
 	//fast power of 2 mipmap generation
 	uint32_t dst_w = MAX(p_width >> 1, 1);
-	uint32_t dst_h = MAX(p_height >> 1, 1);
 
 	int right_step = (p_width == 1) ? 0 : CC;
 	int down_step = (p_height == 1) ? 0 : (p_width * CC);
 
-	for (uint32_t i = 0; i < dst_h; i++) {
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
 		const Component *rup_ptr = &p_src[i * 2 * down_step];
 		const Component *rdown_ptr = rup_ptr + down_step;
 		Component *dst_ptr = &p_dst[i * dst_w * CC];
 		uint32_t count = dst_w;
 
+		if (CC == 4 && !renormalize && right_step && image_simd_enabled) {
+			// Only for the uint8 and float components, always averaged with average_4_uint8 and average_4_float.
+			uint32_t done = _average_4_rgba_simd(rup_ptr, rdown_ptr, dst_ptr, count);
+			count -= done;
+			dst_ptr += done * CC;
+			rup_ptr += done * right_step * 2;
+			rdown_ptr += done * right_step * 2;
+		}
+
 		while (count) {
 			count--;
 			for (int j = 0; j < CC; j++) {
@@ -1445,6 +1902,70 @@ static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint3
 	}
 }
 
+template <class Component>
+struct ImageMipmapJob {
+	void (*rows_func)(const Component *, Component *, uint32_t, uint32_t, uint32_t, uint32_t) = nullptr;
+	const Component *src = nullptr;
+	Component *dst = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	void process_rows(uint32_t p_from, uint32_t p_to) {
+		rows_func(src, dst, width, height, p_from, p_to);
+	}
+};
+
+template <class Component>
+static void _generate_po2_mipmap_parallel(void (*p_rows_func)(const Component *, Component *, uint32_t, uint32_t, uint32_t, uint32_t), const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+	ImageMipmapJob<Component> job;
+	job.rows_func = p_rows_func;
+	job.src = p_src;
+	job.dst = p_dst;
+	job.width = p_width;
+	job.height = p_height;
+	_process_rows(&job, MAX(p_height >> 1, 1), MAX(p_width >> 1, 1));
+}
+
+template <class Component, int CC, bool renormalize,
+		void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
+		void (*renormalize_func)(Component *)>
+static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+	_generate_po2_mipmap_parallel(_generate_po2_mipmap_rows<Component, CC, renormalize, average_func, renormalize_func>, p_src, p_dst, p_width, p_height);
+}
+
+// Same as above for RGB8 and RGBA8 holding sRGB color, which is averaged in linear
+// space (alpha is already linear). Averaging the sRGB values directly darkens the
+// smaller mipmaps wherever dark and light texels meet.
+template <int CC>
+static void _generate_po2_mipmap_srgb_rows(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_from_row, uint32_t p_to_row) {
+	const ImageSRGBTables &srgb = _get_srgb_tables();
+
+	uint32_t dst_w = MAX(p_width >> 1, 1);
+
+	int right_step = (p_width == 1) ? 0 : CC;
+	int down_step = (p_height == 1) ? 0 : (p_width * CC);
+
+	for (uint32_t i = p_from_row; i < p_to_row; i++) {
+		const uint8_t *rup_ptr = &p_src[i * 2 * down_step];
+		const uint8_t *rdown_ptr = rup_ptr + down_step;
+		uint8_t *dst_ptr = &p_dst[i * dst_w * CC];
+
+		for (uint32_t j = 0; j < dst_w; j++) {
+			for (int k = 0; k < 3; k++) {
+				float linear = (srgb.to_linear[rup_ptr[k]] + srgb.to_linear[rup_ptr[k + right_step]] + srgb.to_linear[rdown_ptr[k]] + srgb.to_linear[rdown_ptr[k + right_step]]) * 0.25f;
+				dst_ptr[k] = srgb.to_srgb(linear);
+			}
+			if (CC == 4) {
+				dst_ptr[3] = (rup_ptr[3] + rup_ptr[3 + right_step] + rdown_ptr[3] + rdown_ptr[3 + right_step] + 2) >> 2;
+			}
+
+			dst_ptr += CC;
+			rup_ptr += right_step * 2;
+			rdown_ptr += right_step * 2;
+		}
+	}
+}
+
 void Image::shrink_x2() {
 	ERR_FAIL_COND(data.size() == 0);
 
@@ -1563,7 +2084,7 @@ void Image::normalize() {
 	}
 }
 
-Error Image::generate_mipmaps(bool p_renormalize) {
+Error Image::generate_mipmaps(bool p_renormalize, bool p_srgb) {
 	ERR_FAIL_COND_V_MSG(!_can_modify(format), ERR_UNAVAILABLE, "Cannot generate mipmaps in compressed or custom image formats.");
 
 	ERR_FAIL_COND_V_MSG(format == FORMAT_RGBA4444, ERR_UNAVAILABLE, "Cannot generate mipmaps from RGBA4444 format.");
@@ -1598,6 +2119,8 @@ Error Image::generate_mipmaps(bool p_renormalize) {
 			case FORMAT_RGB8:
 				if (p_renormalize) {
 					_generate_po2_mipmap<uint8_t, 3, true, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+				} else if (p_srgb) {
+					_generate_po2_mipmap_parallel(_generate_po2_mipmap_srgb_rows<3>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h);
 				} else {
 					_generate_po2_mipmap<uint8_t, 3, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
 				}
@@ -1606,6 +2129,8 @@ Error Image::generate_mipmaps(bool p_renormalize) {
 			case FORMAT_RGBA8:
 				if (p_renormalize) {
 					_generate_po2_mipmap<uint8_t, 4, true, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+				} else if (p_srgb) {
+					_generate_po2_mipmap_parallel(_generate_po2_mipmap_srgb_rows<4>, &wp[prev_ofs], &wp[ofs], prev_w, prev_h);
 				} else {
 					_generate_po2_mipmap<uint8_t, 4, false, Image::average_4_uint8, Image::renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
 				}
@@ -3013,7 +3538,7 @@ void Image::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("crop", "width", "height"), &Image::crop);
 	ClassDB::bind_method(D_METHOD("flip_x"), &Image::flip_x);
 	ClassDB::bind_method(D_METHOD("flip_y"), &Image::flip_y);
-	ClassDB::bind_method(D_METHOD("generate_mipmaps", "renormalize"), &Image::generate_mipmaps, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("generate_mipmaps", "renormalize", "srgb"), &Image::generate_mipmaps, DEFVAL(false), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("clear_mipmaps"), &Image::clear_mipmaps);
 
 	ClassDB::bind_method(D_METHOD("create", "width", "height", "use_mipmaps", "format"), &Image::_create_empty);
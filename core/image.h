@@ -160,6 +160,8 @@ public:
 	_FORCE_INLINE_ Color _get_color_at_ofs(const uint8_t *ptr, uint32_t ofs) const;
 	_FORCE_INLINE_ void _set_color_at_ofs(uint8_t *ptr, uint32_t ofs, const Color &p_color);
 
+	struct ColorConvertJob;
+
 protected:
 	static void _bind_methods();
 
@@ -249,7 +251,7 @@ public:
 	/**
 	 * Generate a mipmap to an image (creates an image 1/4 the size, with averaging of 4->1)
 	 */
-	Error generate_mipmaps(bool p_renormalize = false);
+	Error generate_mipmaps(bool p_renormalize = false, bool p_srgb = false);
 
 	enum RoughnessChannel {
 		ROUGHNESS_CHANNEL_R,
@@ -318,6 +320,31 @@ public:
 	static int get_image_mipmap_offset(int p_width, int p_height, Format p_format, int p_mipmap);
 	static int get_image_mipmap_offset_and_dimensions(int p_width, int p_height, Format p_format, int p_mipmap, int &r_w, int &r_h);
 
+	// Large images are resized, mipmapped and converted on a shared pool of threads.
+	// -1 uses one per core, 0 or 1 does everything on the calling thread.
+	static void set_thread_count(int p_count);
+	static int get_thread_count();
+	static void finish_threads();
+	static void set_simd_enabled(bool p_enabled);
+	static bool is_simd_enabled();
+
+	// Calls p_func for bands of [0, p_rows) on the same pool, when there are enough pixels for it to pay off.
+	typedef void (*ProcessRowsFunc)(void *p_userdata, uint32_t p_from, uint32_t p_to);
+	static void process_rows(uint32_t p_rows, uint32_t p_row_pixels, ProcessRowsFunc p_func, void *p_userdata);
+
+	// One row of 4x4 blocks of one mipmap, for the block compressors.
+	struct CompressBlockRow {
+		const uint8_t *src = nullptr; // Top left pixel of the row, rows are width pixels apart.
+		uint8_t *dst = nullptr; // First block of the row.
+		int width = 0; // Of the mipmap.
+		int height = 0; // Pixel rows, 4 except maybe for the last block row.
+		int mipmap = 0;
+	};
+	typedef void (*CompressBlockRowFunc)(void *p_userdata, const CompressBlockRow &p_row);
+	// Runs p_func for every block row of every mipmap on the pool. p_dst must hold
+	// get_image_data_size(width, height, p_target_format, has_mipmaps()) bytes.
+	void compress_block_rows(Format p_target_format, uint8_t *p_dst, CompressBlockRowFunc p_func, void *p_userdata) const;
+
 	enum CompressMode {
 		COMPRESS_S3TC,
 		COMPRESS_PVRTC2,
@@ -30,6 +30,8 @@
 
 #include "image_loader.h"
 
+#include "core/io/file_access_memory.h"
+#include "core/os/mutex.h"
 #include "core/print_string.h"
 
 bool ImageFormatLoader::recognize(const String &p_extension) const {
@@ -84,6 +86,210 @@ Error ImageLoader::load_image(String p_file, Ref<Image> p_image, FileAccess *p_c
 	return ERR_FILE_UNRECOGNIZED;
 }
 
+void ImageRowReducer::init(int p_width, int p_height, int p_components, int p_reduce, uint8_t *p_dst) {
+	width = p_width;
+	height = p_height;
+	components = p_components;
+	reduce = p_reduce;
+	dst_width = MAX(p_width >> p_reduce, 1);
+	dst_height = MAX(p_height >> p_reduce, 1);
+	dst = p_dst;
+	row = 0;
+	block_rows = 0;
+
+	sums.resize(reduce ? dst_width * components : 0);
+	for (uint32_t i = 0; i < sums.size(); i++) {
+		sums[i] = 0;
+	}
+}
+
+void ImageRowReducer::_flush() {
+	int dst_row = MIN((row - 1) >> reduce, dst_height - 1);
+	uint8_t *dst_ptr = dst + dst_row * dst_width * components;
+
+	for (int x = 0; x < dst_width; x++) {
+		int columns = x == dst_width - 1 ? width - (x << reduce) : 1 << reduce;
+		uint32_t count = columns * block_rows;
+		for (int c = 0; c < components; c++) {
+			uint32_t &sum = sums[x * components + c];
+			dst_ptr[x * components + c] = (sum + count / 2) / count;
+			sum = 0;
+		}
+	}
+	block_rows = 0;
+}
+
+void ImageRowReducer::push_row(const uint8_t *p_row, int p_pixel_stride) {
+	ERR_FAIL_COND(row >= height);
+
+	if (reduce == 0) {
+		uint8_t *dst_ptr = dst + row * width * components;
+		if (p_pixel_stride == components) {
+			copymem(dst_ptr, p_row, width * components);
+		} else {
+			for (int x = 0; x < width; x++) {
+				for (int c = 0; c < components; c++) {
+					dst_ptr[x * components + c] = p_row[x * p_pixel_stride + c];
+				}
+			}
+		}
+		row++;
+		return;
+	}
+
+	for (int x = 0; x < width; x++) {
+		uint32_t *sum = &sums[MIN(x >> reduce, dst_width - 1) * components];
+		const uint8_t *src = &p_row[x * p_pixel_stride];
+		for (int c = 0; c < components; c++) {
+			sum[c] += src[c];
+		}
+	}
+	block_rows++;
+	row++;
+
+	if (row == height || MIN(row >> reduce, dst_height - 1) != MIN((row - 1) >> reduce, dst_height - 1)) {
+		_flush();
+	}
+}
+
+/////////////////
+
+// Loaders that can't decode from memory aren't required to be thread safe.
+static Mutex image_loader_fallback_mutex;
+
+Ref<Image> ImageLoader::_load_image_fallback(ImageFormatLoader *p_loader, const uint8_t *p_buffer, int p_size, Error &r_error) {
+	Ref<Image> image;
+	image.instance();
+
+	FileAccessMemory f;
+	r_error = f.open_custom(p_buffer, p_size);
+	if (r_error != OK) {
+		return Ref<Image>();
+	}
+
+	MutexLock lock(image_loader_fallback_mutex);
+	r_error = p_loader->load_image(image, &f, false, 1.0);
+	if (r_error != OK) {
+		return Ref<Image>();
+	}
+	return image;
+}
+
+Error ImageLoader::get_buffer_info(const String &p_extension, const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) {
+	ImageFormatLoader *format_loader = recognize(p_extension);
+	ERR_FAIL_COND_V_MSG(!format_loader, ERR_FILE_UNRECOGNIZED, "No image loader for extension '" + p_extension + "'.");
+
+	if (format_loader->can_decode_buffer()) {
+		return format_loader->get_buffer_info(p_buffer, p_size, r_size, r_format);
+	}
+
+	// Has to be decoded to know.
+	Error err;
+	Ref<Image> image = _load_image_fallback(format_loader, p_buffer, p_size, err);
+	if (err != OK) {
+		return err;
+	}
+	r_size = image->get_size();
+	r_format = image->get_format();
+	return OK;
+}
+
+int ImageLoader::get_decoded_size(const Size2i &p_size, Image::Format p_format, int p_reduce) {
+	return Image::get_image_data_size(MAX(p_size.width >> p_reduce, 1), MAX(p_size.height >> p_reduce, 1), p_format);
+}
+
+Error ImageLoader::_decode_item(DecodeItem &p_item) {
+	if (p_item.buffer.empty()) {
+		Error err;
+		p_item.buffer = FileAccess::get_file_as_array(p_item.path, &err);
+		if (err != OK) {
+			return err;
+		}
+	}
+	String extension = p_item.extension.empty() ? p_item.path.get_extension() : p_item.extension;
+	int reduce = MAX(p_item.reduce, 0);
+
+	ImageFormatLoader *format_loader = recognize(extension);
+	if (!format_loader) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	Ref<Image> image;
+	Size2i size;
+	Image::Format format;
+	Error err;
+
+	if (format_loader->can_decode_buffer()) {
+		err = format_loader->get_buffer_info(p_item.buffer.ptr(), p_item.buffer.size(), size, format);
+		if (err != OK) {
+			return err;
+		}
+	} else {
+		image = _load_image_fallback(format_loader, p_item.buffer.ptr(), p_item.buffer.size(), err);
+		if (err != OK) {
+			return err;
+		}
+		if (reduce) {
+			ERR_FAIL_COND_V_MSG(image->is_compressed(), ERR_UNAVAILABLE, "Compressed images can only be decoded at full size.");
+			image->resize(MAX(image->get_width() >> reduce, 1), MAX(image->get_height() >> reduce, 1), Image::INTERPOLATE_TRILINEAR);
+		}
+		size = image->get_size();
+		format = image->get_format();
+		reduce = 0;
+	}
+
+	int data_size = get_decoded_size(size, format, reduce);
+	p_item.size = Size2i(MAX(size.width >> reduce, 1), MAX(size.height >> reduce, 1));
+	p_item.format = format;
+
+	if (p_item.dst) {
+		ERR_FAIL_COND_V_MSG(p_item.dst_size < data_size, ERR_INVALID_PARAMETER, vformat("Image needs a buffer of %d bytes.", data_size));
+		if (image.is_valid()) {
+			copymem(p_item.dst, image->get_data().ptr(), data_size);
+			return OK;
+		}
+		return format_loader->decode_buffer(p_item.buffer.ptr(), p_item.buffer.size(), reduce, p_item.dst);
+	}
+
+	if (image.is_null()) {
+		Vector<uint8_t> data;
+		data.resize(data_size);
+		err = format_loader->decode_buffer(p_item.buffer.ptr(), p_item.buffer.size(), reduce, data.ptrw());
+		if (err != OK) {
+			return err;
+		}
+		image.instance();
+		image->create(p_item.size.width, p_item.size.height, false, format, data);
+	}
+	p_item.image = image;
+	return OK;
+}
+
+void ImageLoader::_decode_batch_items(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+	DecodeItem *items = (DecodeItem *)p_userdata;
+	for (uint32_t i = p_from; i < p_to; i++) {
+		DecodeItem &item = items[i];
+		item.error = _decode_item(item);
+		if (item.error != OK) {
+			ERR_PRINT("Error decoding image: " + (item.path.empty() ? "(buffer " + itos(i) + ")" : item.path));
+		}
+	}
+}
+
+Error ImageLoader::decode_batch(DecodeItem *p_items, int p_count) {
+	ERR_FAIL_COND_V(p_count < 0, ERR_INVALID_PARAMETER);
+
+	// Any image takes long enough to decode to be worth a thread of its own.
+	Image::process_rows(p_count, 1 << 16, _decode_batch_items, p_items);
+
+	for (int i = 0; i < p_count; i++) {
+		if (p_items[i].error != OK) {
+			return p_items[i].error;
+		}
+	}
+	return OK;
+}
+
 void ImageLoader::get_recognized_extensions(List<String> *p_extensions) {
 	for (int i = 0; i < loader.size(); i++) {
 		loader[i]->get_recognized_extensions(p_extensions);
@@ -34,6 +34,7 @@
 #include "core/image.h"
 #include "core/io/resource_loader.h"
 #include "core/list.h"
+#include "core/local_vector.h"
 #include "core/os/file_access.h"
 #include "core/ustring.h"
 
@@ -48,17 +49,78 @@ protected:
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
 	bool recognize(const String &p_extension) const;
 
+	// Decoding from memory, used by ImageLoader::decode_batch() from several threads at once.
+	// Loaders that don't support it are run one at a time through load_image() instead.
+	virtual bool can_decode_buffer() const { return false; }
+	virtual Error get_buffer_info(const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) const { return ERR_UNAVAILABLE; }
+	// Writes the image halved p_reduce times to p_dst, which holds exactly that (see ImageLoader::get_decoded_size()).
+	virtual Error decode_buffer(const uint8_t *p_buffer, int p_size, int p_reduce, uint8_t *p_dst) const { return ERR_UNAVAILABLE; }
+
 public:
 	virtual ~ImageFormatLoader() {}
 };
 
+// Box filters 8 bits per component rows as a decoder produces them, so images can be
+// decoded at a reduced size without holding the full size one in memory.
+// The size is halved p_reduce times like mipmaps are, extra rows and columns go to the last pixel.
+class ImageRowReducer {
+	int width = 0;
+	int height = 0;
+	int components = 0;
+	int reduce = 0;
+	int dst_width = 0;
+	int dst_height = 0;
+	uint8_t *dst = nullptr;
+	int row = 0;
+	int block_rows = 0;
+	LocalVector<uint32_t> sums;
+
+	void _flush();
+
+public:
+	void init(int p_width, int p_height, int p_components, int p_reduce, uint8_t *p_dst);
+	// p_pixel_stride is the distance between the pixels of p_row, at least p_components.
+	void push_row(const uint8_t *p_row, int p_pixel_stride);
+	bool is_done() const { return row == height; }
+};
+
 class ImageLoader {
 	static Vector<ImageFormatLoader *> loader;
 	friend class ResourceFormatLoaderImage;
 
 protected:
+public:
+	// One image of ImageLoader::decode_batch().
+	struct DecodeItem {
+		String path; // Read when buffer is empty.
+		Vector<uint8_t> buffer; // Contents of the encoded file.
+		String extension; // Picks the loader, taken from path when empty.
+		int reduce = 0; // Halves the size this many times, like mipmaps.
+		uint8_t *dst = nullptr; // Caller owned, of dst_size bytes. If null, image is created instead.
+		int dst_size = 0;
+
+		Error error = ERR_UNCONFIGURED;
+		Size2i size; // After the reduction.
+		Image::Format format = Image::FORMAT_MAX;
+		Ref<Image> image;
+	};
+
+private:
+	static Ref<Image> _load_image_fallback(ImageFormatLoader *p_loader, const uint8_t *p_buffer, int p_size, Error &r_error);
+	static Error _decode_item(DecodeItem &p_item);
+	static void _decode_batch_items(void *p_userdata, uint32_t p_from, uint32_t p_to);
+
 public:
 	static Error load_image(String p_file, Ref<Image> p_image, FileAccess *p_custom = nullptr, bool p_force_linear = false, float p_scale = 1.0);
+
+	// Size and format of an encoded image, without decoding it. Reading the header is cheap,
+	// so callers can use it to allocate the buffers given to decode_batch().
+	static Error get_buffer_info(const String &p_extension, const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format);
+	static int get_decoded_size(const Size2i &p_size, Image::Format p_format, int p_reduce);
+	// Decodes the items in parallel on the image thread pool, sets the results of each one.
+	// Returns OK when all of them were decoded.
+	static Error decode_batch(DecodeItem *p_items, int p_count);
+
 	static void get_recognized_extensions(List<String> *p_extensions);
 	static ImageFormatLoader *recognize(const String &p_extension);
 
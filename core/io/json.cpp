@@ -27,12 +27,27 @@
 /* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
-
 #include "json.h"
 
+#include "core/hash_map.h"
+#include "core/local_vector.h"
 #include "core/print_string.h"
 
-const char *JSON::tk_name[TK_MAX] = {
+enum JSONTokenType {
+	TK_CURLY_BRACKET_OPEN,
+	TK_CURLY_BRACKET_CLOSE,
+	TK_BRACKET_OPEN,
+	TK_BRACKET_CLOSE,
+	TK_IDENTIFIER,
+	TK_STRING,
+	TK_NUMBER,
+	TK_COLON,
+	TK_COMMA,
+	TK_EOF,
+	TK_MAX
+};
+
+static const char *tk_name[TK_MAX] = {
 	"'{'",
 	"'}'",
 	"'['",
@@ -45,89 +60,210 @@ const char *JSON::tk_name[TK_MAX] = {
 	"EOF",
 };
 
-static String _make_indent(const String &p_indent, int p_size) {
-	String indent_text = "";
-	if (!p_indent.empty()) {
-		for (int i = 0; i < p_size; i++) {
-			indent_text += p_indent;
-		}
+struct JSONToken {
+	JSONTokenType type;
+	Variant value;
+};
+
+static _FORCE_INLINE_ void _append_run(String &r_str, const CharType *p_run, int p_len) {
+	if (r_str.empty()) {
+		r_str = String(p_run, p_len);
+	} else {
+		r_str += String(p_run, p_len);
 	}
-	return indent_text;
 }
 
-String JSON::_print_var(const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys) {
-	String colon = ":";
-	String end_statement = "";
+static _FORCE_INLINE_ void _append_run(String &r_str, const uint8_t *p_run, int p_len) {
+	String run;
+	run.parse_utf8((const char *)p_run, p_len);
+	if (r_str.empty()) {
+		r_str = run;
+	} else {
+		r_str += run;
+	}
+}
 
-	if (!p_indent.empty()) {
-		colon += " ";
-		end_statement += "\n";
+// Works on either UTF-32 (CharType) or UTF-8 (uint8_t) input. Strings are
+// sliced out of the input in runs instead of being built one character at a time.
+template <class C>
+class JSONTokenizer {
+	const C *str;
+	int len;
+	int index = 0;
+
+	_FORCE_INLINE_ uint32_t _peek(int p_ofs = 0) const {
+		return index + p_ofs < len ? uint32_t(str[index + p_ofs]) : 0;
 	}
 
-	switch (p_var.get_type()) {
-		case Variant::NIL:
-			return "null";
-		case Variant::BOOL:
-			return p_var.operator bool() ? "true" : "false";
-		case Variant::INT:
-			return itos(p_var);
-		case Variant::FLOAT:
-			return rtos(p_var);
-		case Variant::PACKED_INT32_ARRAY:
-		case Variant::PACKED_INT64_ARRAY:
-		case Variant::PACKED_FLOAT32_ARRAY:
-		case Variant::PACKED_FLOAT64_ARRAY:
-		case Variant::PACKED_STRING_ARRAY:
-		case Variant::ARRAY: {
-			String s = "[";
-			s += end_statement;
-			Array a = p_var;
-			for (int i = 0; i < a.size(); i++) {
-				if (i > 0) {
-					s += ",";
-					s += end_statement;
-				}
-				s += _make_indent(p_indent, p_cur_indent + 1) + _print_var(a[i], p_indent, p_cur_indent + 1, p_sort_keys);
-			}
-			s += end_statement + _make_indent(p_indent, p_cur_indent) + "]";
-			return s;
-		}
-		case Variant::DICTIONARY: {
-			String s = "{";
-			s += end_statement;
-			Dictionary d = p_var;
-			List<Variant> keys;
-			d.get_key_list(&keys);
+	Error _parse_string(String &r_str);
+	Error _parse_number(double &r_number);
 
-			if (p_sort_keys) {
-				keys.sort();
+public:
+	int line = 0;
+	String err_str;
+
+	Error get_token(JSONToken &r_token);
+
+	JSONTokenizer(const C *p_str, int p_len) :
+			str(p_str),
+			len(p_len) {}
+};
+
+template <class C>
+Error JSONTokenizer<C>::_parse_string(String &r_str) {
+	index++; // Opening quote.
+	int run_from = index;
+
+	while (true) {
+		uint32_t c = _peek();
+		if (c == 0) {
+			err_str = "Unterminated String";
+			return ERR_PARSE_ERROR;
+		} else if (c == '"') {
+			if (index > run_from) {
+				_append_run(r_str, &str[run_from], index - run_from);
+			}
+			index++;
+			return OK;
+		} else if (c == '\\') {
+			if (index > run_from) {
+				_append_run(r_str, &str[run_from], index - run_from);
 			}
+			//escaped characters...
+			index++;
+			uint32_t next = _peek();
+			if (next == 0) {
+				err_str = "Unterminated String";
+				return ERR_PARSE_ERROR;
+			}
+			CharType res = 0;
 
-			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
-				if (E != keys.front()) {
-					s += ",";
-					s += end_statement;
-				}
-				s += _make_indent(p_indent, p_cur_indent + 1) + _print_var(String(E->get()), p_indent, p_cur_indent + 1, p_sort_keys);
-				s += colon;
-				s += _print_var(d[E->get()], p_indent, p_cur_indent + 1, p_sort_keys);
+			switch (next) {
+				case 'b':
+					res = 8;
+					break;
+				case 't':
+					res = 9;
+					break;
+				case 'n':
+					res = 10;
+					break;
+				case 'f':
+					res = 12;
+					break;
+				case 'r':
+					res = 13;
+					break;
+				case 'u': {
+					// hex number
+					for (int j = 0; j < 4; j++) {
+						uint32_t h = _peek(j + 1);
+						if (h == 0) {
+							err_str = "Unterminated String";
+							return ERR_PARSE_ERROR;
+						}
+						CharType v;
+						if (h >= '0' && h <= '9') {
+							v = h - '0';
+						} else if (h >= 'a' && h <= 'f') {
+							v = h - 'a' + 10;
+						} else if (h >= 'A' && h <= 'F') {
+							v = h - 'A' + 10;
+						} else {
+							err_str = "Malformed hex constant in string";
+							return ERR_PARSE_ERROR;
+						}
+
+						res <<= 4;
+						res |= v;
+					}
+					index += 4;
+
+				} break;
+				default: {
+					res = next;
+				} break;
 			}
 
-			s += end_statement + _make_indent(p_indent, p_cur_indent) + "}";
-			return s;
+			r_str += res;
+			index++;
+			run_from = index;
+		} else {
+			if (c == '\n') {
+				line++;
+			}
+			index++;
 		}
-		default:
-			return "\"" + String(p_var).json_escape() + "\"";
 	}
 }
 
-String JSON::print(const Variant &p_var, const String &p_indent, bool p_sort_keys) {
-	return _print_var(p_var, p_indent, 0, p_sort_keys);
+template <class C>
+Error JSONTokenizer<C>::_parse_number(double &r_number) {
+	int from = index;
+	bool negative = false;
+	if (_peek() == '-') {
+		negative = true;
+		index++;
+	}
+
+	// Plain integers that fit in a double's mantissa are accumulated directly.
+	uint64_t integer = 0;
+	int digits = 0;
+	while (_peek() >= '0' && _peek() <= '9') {
+		integer = integer * 10 + (_peek() - '0');
+		digits++;
+		index++;
+	}
+
+	uint32_t c = _peek();
+	if (c != '.' && c != 'e' && c != 'E' && digits > 0 && digits <= 15) {
+		r_number = negative ? -double(integer) : double(integer);
+		return OK;
+	}
+
+	if (c == '.') {
+		index++;
+		while (_peek() >= '0' && _peek() <= '9') {
+			index++;
+		}
+	}
+	c = _peek();
+	if (c == 'e' || c == 'E') {
+		index++;
+		if (_peek() == '+' || _peek() == '-') {
+			index++;
+		}
+		while (_peek() >= '0' && _peek() <= '9') {
+			index++;
+		}
+	}
+
+	// Numbers are pure ASCII, so they can be narrowed for the conversion.
+	char buf[64];
+	int num_len = index - from;
+	if (num_len < (int)sizeof(buf)) {
+		for (int i = 0; i < num_len; i++) {
+			buf[i] = char(str[from + i]);
+		}
+		buf[num_len] = 0;
+		r_number = String::to_float(buf);
+	} else {
+		CharString long_number;
+		long_number.resize(num_len + 1);
+		for (int i = 0; i < num_len; i++) {
+			long_number.set(i, char(str[from + i]));
+		}
+		long_number.set(num_len, 0);
+		r_number = String::to_float(long_number.get_data());
+	}
+	return OK;
 }
 
-Error JSON::_get_token(const CharType *p_str, int &index, int p_len, Token &r_token, int &line, String &r_err_str) {
-	while (p_len > 0) {
-		switch (p_str[index]) {
+template <class C>
+Error JSONTokenizer<C>::get_token(JSONToken &r_token) {
+	while (true) {
+		uint32_t c = _peek();
+		switch (c) {
 			case '\n': {
 				line++;
 				index++;
@@ -168,290 +304,408 @@ Error JSON::_get_token(const CharType *p_str, int &index, int p_len, Token &r_to
 				return OK;
 			}
 			case '"': {
-				index++;
-				String str;
-				while (true) {
-					if (p_str[index] == 0) {
-						r_err_str = "Unterminated String";
-						return ERR_PARSE_ERROR;
-					} else if (p_str[index] == '"') {
-						index++;
-						break;
-					} else if (p_str[index] == '\\') {
-						//escaped characters...
-						index++;
-						CharType next = p_str[index];
-						if (next == 0) {
-							r_err_str = "Unterminated String";
-							return ERR_PARSE_ERROR;
-						}
-						CharType res = 0;
-
-						switch (next) {
-							case 'b':
-								res = 8;
-								break;
-							case 't':
-								res = 9;
-								break;
-							case 'n':
-								res = 10;
-								break;
-							case 'f':
-								res = 12;
-								break;
-							case 'r':
-								res = 13;
-								break;
-							case 'u': {
-								// hex number
-								for (int j = 0; j < 4; j++) {
-									CharType c = p_str[index + j + 1];
-									if (c == 0) {
-										r_err_str = "Unterminated String";
-										return ERR_PARSE_ERROR;
-									}
-									if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
-										r_err_str = "Malformed hex constant in string";
-										return ERR_PARSE_ERROR;
-									}
-									CharType v;
-									if (c >= '0' && c <= '9') {
-										v = c - '0';
-									} else if (c >= 'a' && c <= 'f') {
-										v = c - 'a';
-										v += 10;
-									} else if (c >= 'A' && c <= 'F') {
-										v = c - 'A';
-										v += 10;
-									} else {
-										ERR_PRINT("Bug parsing hex constant.");
-										v = 0;
-									}
-
-									res <<= 4;
-									res |= v;
-								}
-								index += 4; //will add at the end anyway
-
-							} break;
-							default: {
-								res = next;
-							} break;
-						}
-
-						str += res;
-
-					} else {
-						if (p_str[index] == '\n') {
-							line++;
-						}
-						str += p_str[index];
-					}
-					index++;
+				String s;
+				Error err = _parse_string(s);
+				if (err) {
+					return err;
 				}
-
 				r_token.type = TK_STRING;
-				r_token.value = str;
+				r_token.value = s;
 				return OK;
 
 			} break;
 			default: {
-				if (p_str[index] <= 32) {
+				if (c <= 32) {
 					index++;
 					break;
 				}
 
-				if (p_str[index] == '-' || (p_str[index] >= '0' && p_str[index] <= '9')) {
+				if (c == '-' || (c >= '0' && c <= '9')) {
 					//a number
-					const CharType *rptr;
-					double number = String::to_float(&p_str[index], &rptr);
-					index += (rptr - &p_str[index]);
+					double number;
+					Error err = _parse_number(number);
+					if (err) {
+						return err;
+					}
 					r_token.type = TK_NUMBER;
 					r_token.value = number;
 					return OK;
 
-				} else if ((p_str[index] >= 'A' && p_str[index] <= 'Z') || (p_str[index] >= 'a' && p_str[index] <= 'z')) {
-					String id;
-
-					while ((p_str[index] >= 'A' && p_str[index] <= 'Z') || (p_str[index] >= 'a' && p_str[index] <= 'z')) {
-						id += p_str[index];
+				} else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+					int from = index;
+					while ((_peek() >= 'A' && _peek() <= 'Z') || (_peek() >= 'a' && _peek() <= 'z')) {
 						index++;
 					}
 
+					String id;
+					_append_run(id, &str[from], index - from);
 					r_token.type = TK_IDENTIFIER;
 					r_token.value = id;
 					return OK;
 				} else {
-					r_err_str = "Unexpected character.";
+					err_str = "Unexpected character.";
 					return ERR_PARSE_ERROR;
 				}
 			}
 		}
 	}
-
-	return ERR_PARSE_ERROR;
 }
 
-Error JSON::_parse_value(Variant &value, Token &token, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str) {
-	if (token.type == TK_CURLY_BRACKET_OPEN) {
-		Dictionary d;
-		Error err = _parse_object(d, p_str, index, p_len, line, r_err_str);
-		if (err) {
-			return err;
+// Parses a single value without recursion, reporting structure to a handler.
+// The handler is a template parameter so the DOM builder is called directly.
+template <class C, class H>
+static Error _parse_json(JSONTokenizer<C> &p_tokenizer, H &p_handler) {
+	enum State {
+		STATE_VALUE,
+		STATE_ARRAY_VALUE_OR_END,
+		STATE_OBJECT_KEY_OR_END,
+		STATE_AFTER_VALUE,
+	};
+
+	LocalVector<bool> in_object;
+	State state = STATE_VALUE;
+	JSONToken token;
+	bool reuse_token = false;
+
+	while (true) {
+		if (state == STATE_AFTER_VALUE && in_object.size() == 0) {
+			return OK; // Anything after the top-level value is ignored.
 		}
-		value = d;
-		return OK;
-	} else if (token.type == TK_BRACKET_OPEN) {
-		Array a;
-		Error err = _parse_array(a, p_str, index, p_len, line, r_err_str);
+
+		if (!reuse_token) {
+			Error err = p_tokenizer.get_token(token);
+			if (err) {
+				return err;
+			}
+		}
+		reuse_token = false;
+
+		Error err = OK;
+
+		switch (state) {
+			case STATE_VALUE: {
+				if (token.type == TK_CURLY_BRACKET_OPEN) {
+					err = p_handler.object_begin();
+					in_object.push_back(true);
+					state = STATE_OBJECT_KEY_OR_END;
+				} else if (token.type == TK_BRACKET_OPEN) {
+					err = p_handler.array_begin();
+					in_object.push_back(false);
+					state = STATE_ARRAY_VALUE_OR_END;
+				} else if (token.type == TK_IDENTIFIER) {
+					String id = token.value;
+					if (id == "true") {
+						err = p_handler.value(true);
+					} else if (id == "false") {
+						err = p_handler.value(false);
+					} else if (id == "null") {
+						err = p_handler.value(Variant());
+					} else {
+						p_tokenizer.err_str = "Expected 'true','false' or 'null', got '" + id + "'.";
+						return ERR_PARSE_ERROR;
+					}
+					state = STATE_AFTER_VALUE;
+				} else if (token.type == TK_NUMBER || token.type == TK_STRING) {
+					err = p_handler.value(token.value);
+					state = STATE_AFTER_VALUE;
+				} else {
+					p_tokenizer.err_str = "Expected value, got " + String(tk_name[token.type]) + ".";
+					return ERR_PARSE_ERROR;
+				}
+			} break;
+			case STATE_ARRAY_VALUE_OR_END: {
+				if (token.type == TK_BRACKET_CLOSE) {
+					in_object.resize(in_object.size() - 1);
+					err = p_handler.array_end();
+					state = STATE_AFTER_VALUE;
+				} else if (token.type == TK_EOF) {
+					p_tokenizer.err_str = "Expected ']'";
+					return ERR_PARSE_ERROR;
+				} else {
+					reuse_token = true;
+					state = STATE_VALUE;
+				}
+			} break;
+			case STATE_OBJECT_KEY_OR_END: {
+				if (token.type == TK_CURLY_BRACKET_CLOSE) {
+					in_object.resize(in_object.size() - 1);
+					err = p_handler.object_end();
+					state = STATE_AFTER_VALUE;
+					break;
+				} else if (token.type == TK_EOF) {
+					p_tokenizer.err_str = "Expected '}'";
+					return ERR_PARSE_ERROR;
+				} else if (token.type != TK_STRING) {
+					p_tokenizer.err_str = "Expected key";
+					return ERR_PARSE_ERROR;
+				}
+
+				err = p_handler.key(token.value);
+				if (err) {
+					return err;
+				}
+
+				err = p_tokenizer.get_token(token);
+				if (err) {
+					return err;
+				}
+				if (token.type != TK_COLON) {
+					p_tokenizer.err_str = "Expected ':'";
+					return ERR_PARSE_ERROR;
+				}
+				state = STATE_VALUE;
+			} break;
+			case STATE_AFTER_VALUE: {
+				if (in_object[in_object.size() - 1]) {
+					if (token.type == TK_CURLY_BRACKET_CLOSE) {
+						in_object.resize(in_object.size() - 1);
+						err = p_handler.object_end();
+					} else if (token.type == TK_COMMA) {
+						state = STATE_OBJECT_KEY_OR_END;
+					} else if (token.type == TK_EOF) {
+						p_tokenizer.err_str = "Expected '}'";
+						return ERR_PARSE_ERROR;
+					} else {
+						p_tokenizer.err_str = "Expected '}' or ','";
+						return ERR_PARSE_ERROR;
+					}
+				} else {
+					if (token.type == TK_BRACKET_CLOSE) {
+						in_object.resize(in_object.size() - 1);
+						err = p_handler.array_end();
+					} else if (token.type == TK_COMMA) {
+						state = STATE_ARRAY_VALUE_OR_END;
+					} else if (token.type == TK_EOF) {
+						p_tokenizer.err_str = "Expected ']'";
+						return ERR_PARSE_ERROR;
+					} else {
+						p_tokenizer.err_str = "Expected ','";
+						return ERR_PARSE_ERROR;
+					}
+				}
+			} break;
+		}
+
 		if (err) {
 			return err;
 		}
-		value = a;
-		return OK;
+	}
+}
 
-	} else if (token.type == TK_IDENTIFIER) {
-		String id = token.value;
-		if (id == "true") {
-			value = true;
-		} else if (id == "false") {
-			value = false;
-		} else if (id == "null") {
-			value = Variant();
+class JSONVariantBuilder {
+	Variant &root;
+
+	// Containers are reference counted, so they are added to their parent
+	// when opened and filled in place.
+	LocalVector<bool> in_object;
+	LocalVector<Array> arrays;
+	LocalVector<Dictionary> dictionaries;
+	String current_key;
+
+	// Objects in large documents tend to repeat the same keys, share their buffers.
+	HashMap<String, String> interned_keys;
+
+	_FORCE_INLINE_ void _add(const Variant &p_value) {
+		if (in_object.size() == 0) {
+			root = p_value;
+		} else if (in_object[in_object.size() - 1]) {
+			dictionaries[dictionaries.size() - 1][current_key] = p_value;
 		} else {
-			r_err_str = "Expected 'true','false' or 'null', got '" + id + "'.";
-			return ERR_PARSE_ERROR;
+			arrays[arrays.size() - 1].push_back(p_value);
 		}
-		return OK;
+	}
 
-	} else if (token.type == TK_NUMBER) {
-		value = token.value;
+public:
+	Error object_begin() {
+		Dictionary d;
+		_add(d);
+		dictionaries.push_back(d);
+		in_object.push_back(true);
 		return OK;
-	} else if (token.type == TK_STRING) {
-		value = token.value;
+	}
+
+	Error object_end() {
+		dictionaries.resize(dictionaries.size() - 1);
+		in_object.resize(in_object.size() - 1);
 		return OK;
-	} else {
-		r_err_str = "Expected value, got " + String(tk_name[token.type]) + ".";
-		return ERR_PARSE_ERROR;
 	}
-}
 
-Error JSON::_parse_array(Array &array, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str) {
-	Token token;
-	bool need_comma = false;
+	Error array_begin() {
+		Array a;
+		_add(a);
+		arrays.push_back(a);
+		in_object.push_back(false);
+		return OK;
+	}
 
-	while (index < p_len) {
-		Error err = _get_token(p_str, index, p_len, token, line, r_err_str);
-		if (err != OK) {
-			return err;
-		}
+	Error array_end() {
+		arrays.resize(arrays.size() - 1);
+		in_object.resize(in_object.size() - 1);
+		return OK;
+	}
 
-		if (token.type == TK_BRACKET_CLOSE) {
-			return OK;
+	Error key(const String &p_key) {
+		const String *interned = interned_keys.getptr(p_key);
+		if (interned) {
+			current_key = *interned;
+		} else {
+			interned_keys.set(p_key, p_key);
+			current_key = p_key;
 		}
+		return OK;
+	}
 
-		if (need_comma) {
-			if (token.type != TK_COMMA) {
-				r_err_str = "Expected ','";
-				return ERR_PARSE_ERROR;
-			} else {
-				need_comma = false;
-				continue;
-			}
-		}
+	Error value(const Variant &p_value) {
+		_add(p_value);
+		return OK;
+	}
 
-		Variant v;
-		err = _parse_value(v, token, p_str, index, p_len, line, r_err_str);
-		if (err) {
-			return err;
-		}
+	JSONVariantBuilder(Variant &r_root) :
+			root(r_root) {}
+};
 
-		array.push_back(v);
-		need_comma = true;
-	}
+class JSONEventForwarder {
+	JSON::ParseEventCallback callback;
+	void *userdata;
+
+public:
+	Error object_begin() { return callback(userdata, JSON::PARSE_EVENT_OBJECT_BEGIN, Variant()); }
+	Error object_end() { return callback(userdata, JSON::PARSE_EVENT_OBJECT_END, Variant()); }
+	Error array_begin() { return callback(userdata, JSON::PARSE_EVENT_ARRAY_BEGIN, Variant()); }
+	Error array_end() { return callback(userdata, JSON::PARSE_EVENT_ARRAY_END, Variant()); }
+	Error key(const String &p_key) { return callback(userdata, JSON::PARSE_EVENT_KEY, p_key); }
+	Error value(const Variant &p_value) { return callback(userdata, JSON::PARSE_EVENT_VALUE, p_value); }
+
+	JSONEventForwarder(JSON::ParseEventCallback p_callback, void *p_userdata) :
+			callback(p_callback),
+			userdata(p_userdata) {}
+};
 
-	r_err_str = "Expected ']'";
-	return ERR_PARSE_ERROR;
+template <class C, class H>
+static Error _parse(const C *p_str, int p_len, H &p_handler, String &r_err_str, int &r_err_line) {
+	JSONTokenizer<C> tokenizer(p_str, p_len);
+	Error err = _parse_json(tokenizer, p_handler);
+	r_err_str = tokenizer.err_str;
+	r_err_line = tokenizer.line;
+	return err;
 }
 
-Error JSON::_parse_object(Dictionary &object, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str) {
-	bool at_key = true;
-	String key;
-	Token token;
-	bool need_comma = false;
+static _FORCE_INLINE_ void _append_indent(const String &p_indent, int p_size, StringBuilder &r_builder) {
+	for (int i = 0; i < p_size; i++) {
+		r_builder.append(p_indent);
+	}
+}
 
-	while (index < p_len) {
-		if (at_key) {
-			Error err = _get_token(p_str, index, p_len, token, line, r_err_str);
-			if (err != OK) {
-				return err;
-			}
+static _FORCE_INLINE_ void _append_string(const String &p_string, StringBuilder &r_builder) {
+	r_builder.append("\"");
+	r_builder.append(p_string.json_escape());
+	r_builder.append("\"");
+}
 
-			if (token.type == TK_CURLY_BRACKET_CLOSE) {
-				return OK;
-			}
+void JSON::_print_var(const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys, StringBuilder &r_builder) {
+	const char *colon = p_indent.empty() ? ":" : ": ";
+	const char *end_statement = p_indent.empty() ? "" : "\n";
 
-			if (need_comma) {
-				if (token.type != TK_COMMA) {
-					r_err_str = "Expected '}' or ','";
-					return ERR_PARSE_ERROR;
-				} else {
-					need_comma = false;
-					continue;
+	switch (p_var.get_type()) {
+		case Variant::NIL:
+			r_builder.append("null");
+			break;
+		case Variant::BOOL:
+			r_builder.append(p_var.operator bool() ? "true" : "false");
+			break;
+		case Variant::INT:
+			r_builder.append(itos(p_var));
+			break;
+		case Variant::FLOAT:
+			r_builder.append(rtos(p_var));
+			break;
+		case Variant::PACKED_INT32_ARRAY:
+		case Variant::PACKED_INT64_ARRAY:
+		case Variant::PACKED_FLOAT32_ARRAY:
+		case Variant::PACKED_FLOAT64_ARRAY:
+		case Variant::PACKED_STRING_ARRAY:
+		case Variant::ARRAY: {
+			r_builder.append("[");
+			r_builder.append(end_statement);
+			Array a = p_var;
+			for (int i = 0; i < a.size(); i++) {
+				if (i > 0) {
+					r_builder.append(",");
+					r_builder.append(end_statement);
 				}
+				_append_indent(p_indent, p_cur_indent + 1, r_builder);
+				_print_var(a[i], p_indent, p_cur_indent + 1, p_sort_keys, r_builder);
 			}
+			r_builder.append(end_statement);
+			_append_indent(p_indent, p_cur_indent, r_builder);
+			r_builder.append("]");
+		} break;
+		case Variant::DICTIONARY: {
+			r_builder.append("{");
+			r_builder.append(end_statement);
+			Dictionary d = p_var;
+			List<Variant> keys;
+			d.get_key_list(&keys);
 
-			if (token.type != TK_STRING) {
-				r_err_str = "Expected key";
-				return ERR_PARSE_ERROR;
+			if (p_sort_keys) {
+				keys.sort();
 			}
 
-			key = token.value;
-			err = _get_token(p_str, index, p_len, token, line, r_err_str);
-			if (err != OK) {
-				return err;
-			}
-			if (token.type != TK_COLON) {
-				r_err_str = "Expected ':'";
-				return ERR_PARSE_ERROR;
-			}
-			at_key = false;
-		} else {
-			Error err = _get_token(p_str, index, p_len, token, line, r_err_str);
-			if (err != OK) {
-				return err;
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				if (E != keys.front()) {
+					r_builder.append(",");
+					r_builder.append(end_statement);
+				}
+				_append_indent(p_indent, p_cur_indent + 1, r_builder);
+				_append_string(E->get(), r_builder);
+				r_builder.append(colon);
+				_print_var(d[E->get()], p_indent, p_cur_indent + 1, p_sort_keys, r_builder);
 			}
 
-			Variant v;
-			err = _parse_value(v, token, p_str, index, p_len, line, r_err_str);
-			if (err) {
-				return err;
-			}
-			object[key] = v;
-			need_comma = true;
-			at_key = true;
-		}
+			r_builder.append(end_statement);
+			_append_indent(p_indent, p_cur_indent, r_builder);
+			r_builder.append("}");
+		} break;
+		default:
+			_append_string(p_var, r_builder);
 	}
+}
 
-	r_err_str = "Expected '}'";
-	return ERR_PARSE_ERROR;
+String JSON::print(const Variant &p_var, const String &p_indent, bool p_sort_keys) {
+	StringBuilder builder;
+	_print_var(p_var, p_indent, 0, p_sort_keys, builder);
+	return builder.as_string();
 }
 
 Error JSON::parse(const String &p_json, Variant &r_ret, String &r_err_str, int &r_err_line) {
-	const CharType *str = p_json.ptr();
-	int idx = 0;
-	int len = p_json.length();
-	Token token;
-	r_err_line = 0;
-	String aux_key;
-
-	Error err = _get_token(str, idx, len, token, r_err_line, r_err_str);
-	if (err) {
-		return err;
+	// Built aside, so the caller's value is left untouched on errors.
+	Variant ret;
+	JSONVariantBuilder builder(ret);
+	Error err = _parse(p_json.ptr(), p_json.length(), builder, r_err_str, r_err_line);
+	if (err == OK) {
+		r_ret = ret;
 	}
+	return err;
+}
 
-	err = _parse_value(r_ret, token, str, idx, len, r_err_line, r_err_str);
-
+Error JSON::parse_utf8(const uint8_t *p_utf8, int p_len, Variant &r_ret, String &r_err_str, int &r_err_line) {
+	Variant ret;
+	JSONVariantBuilder builder(ret);
+	Error err = _parse(p_utf8, p_len, builder, r_err_str, r_err_line);
+	if (err == OK) {
+		r_ret = ret;
+	}
 	return err;
 }
+
+Error JSON::parse_events(const String &p_json, ParseEventCallback p_callback, void *p_userdata, String &r_err_str, int &r_err_line) {
+	ERR_FAIL_NULL_V(p_callback, ERR_INVALID_PARAMETER);
+	JSONEventForwarder forwarder(p_callback, p_userdata);
+	return _parse(p_json.ptr(), p_json.length(), forwarder, r_err_str, r_err_line);
+}
+
+Error JSON::parse_events_utf8(const uint8_t *p_utf8, int p_len, ParseEventCallback p_callback, void *p_userdata, String &r_err_str, int &r_err_line) {
+	ERR_FAIL_NULL_V(p_callback, ERR_INVALID_PARAMETER);
+	JSONEventForwarder forwarder(p_callback, p_userdata);
+	return _parse(p_utf8, p_len, forwarder, r_err_str, r_err_line);
+}
@@ -31,48 +31,32 @@
 #ifndef JSON_H
 #define JSON_H
 
+#include "core/string_builder.h"
 #include "core/variant.h"
 
 class JSON {
-	enum TokenType {
-		TK_CURLY_BRACKET_OPEN,
-		TK_CURLY_BRACKET_CLOSE,
-		TK_BRACKET_OPEN,
-		TK_BRACKET_CLOSE,
-		TK_IDENTIFIER,
-		TK_STRING,
-		TK_NUMBER,
-		TK_COLON,
-		TK_COMMA,
-		TK_EOF,
-		TK_MAX
-	};
-
-	enum Expecting {
+	static void _print_var(const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys, StringBuilder &r_builder);
 
-		EXPECT_OBJECT,
-		EXPECT_OBJECT_KEY,
-		EXPECT_COLON,
-		EXPECT_OBJECT_VALUE,
-	};
-
-	struct Token {
-		TokenType type;
-		Variant value;
+public:
+	enum ParseEvent {
+		PARSE_EVENT_OBJECT_BEGIN,
+		PARSE_EVENT_OBJECT_END,
+		PARSE_EVENT_ARRAY_BEGIN,
+		PARSE_EVENT_ARRAY_END,
+		PARSE_EVENT_KEY, // Value is the key String.
+		PARSE_EVENT_VALUE, // Value is a bool, float, String or null.
 	};
 
-	static const char *tk_name[TK_MAX];
+	// Returning an error from the callback stops parsing, and the error is returned by the parse function.
+	typedef Error (*ParseEventCallback)(void *p_userdata, ParseEvent p_event, const Variant &p_value);
 
-	static String _print_var(const Variant &p_var, const String &p_indent, int p_cur_indent, bool p_sort_keys);
-
-	static Error _get_token(const CharType *p_str, int &index, int p_len, Token &r_token, int &line, String &r_err_str);
-	static Error _parse_value(Variant &value, Token &token, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str);
-	static Error _parse_array(Array &array, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str);
-	static Error _parse_object(Dictionary &object, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str);
-
-public:
 	static String print(const Variant &p_var, const String &p_indent = "", bool p_sort_keys = true);
 	static Error parse(const String &p_json, Variant &r_ret, String &r_err_str, int &r_err_line);
+	static Error parse_utf8(const uint8_t *p_utf8, int p_len, Variant &r_ret, String &r_err_str, int &r_err_line);
+
+	// Streaming (SAX-style) parsing, no Variant tree is built.
+	static Error parse_events(const String &p_json, ParseEventCallback p_callback, void *p_userdata, String &r_err_str, int &r_err_line);
+	static Error parse_events_utf8(const uint8_t *p_utf8, int p_len, ParseEventCallback p_callback, void *p_userdata, String &r_err_str, int &r_err_line);
 };
 
 #endif // JSON_H
@@ -31,6 +31,7 @@
 #include "resource_format_binary.h"
 
 #include "core/image.h"
+#include "core/io/compression.h"
 #include "core/io/file_access_compressed.h"
 #include "core/io/marshalls.h"
 #include "core/os/dir_access.h"
@@ -81,15 +82,21 @@ enum {
 	VARIANT_VECTOR3I = 47,
 	VARIANT_INT64_ARRAY = 48,
 	VARIANT_FLOAT64_ARRAY = 49,
+	VARIANT_BLOB = 50,
 	OBJECT_EMPTY = 0,
 	OBJECT_EXTERNAL_RESOURCE = 1,
 	OBJECT_INTERNAL_RESOURCE = 2,
 	OBJECT_EXTERNAL_RESOURCE_INDEX = 3,
 	//version 2: added 64 bits support for float and int
 	//version 3: changed nodepath encoding
-	FORMAT_VERSION = 3,
+	//version 4: large packed arrays can be stored as separate, optionally compressed blobs
+	FORMAT_VERSION = 4,
 	FORMAT_VERSION_CAN_RENAME_DEPS = 1,
 	FORMAT_VERSION_NO_NODEPATH_PROPERTY = 3,
+	FORMAT_VERSION_BLOBS = 4,
+	BLOB_COMPRESSION_NONE = 0,
+	BLOB_COMPRESSION_ZSTD = 1,
+	BLOB_MIN_SIZE = 4096, //packed arrays smaller than this (in bytes) are always stored inline
 
 };
 
@@ -597,6 +604,10 @@ Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 
 			r_v = array;
 		} break;
+		case VARIANT_BLOB: {
+			uint32_t index = f->get_32();
+			return _parse_blob(index, r_v);
+		} break;
 		default: {
 			ERR_FAIL_V(ERR_FILE_CORRUPT);
 		} break;
@@ -605,6 +616,74 @@ Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 	return OK; //never reach anyway
 }
 
+Error ResourceLoaderBinary::_read_blob_data(const Blob &p_blob, uint8_t *r_data, uint64_t p_size) {
+	f->seek(blob_table_ofs + p_blob.offset);
+
+	switch (p_blob.compression) {
+		case BLOB_COMPRESSION_NONE: {
+			ERR_FAIL_COND_V(p_blob.size != p_size, ERR_FILE_CORRUPT);
+			ERR_FAIL_COND_V(f->get_buffer(r_data, p_size) != (int)p_size, ERR_FILE_CORRUPT);
+		} break;
+		case BLOB_COMPRESSION_ZSTD: {
+			ERR_FAIL_COND_V(p_blob.size > INT32_MAX || p_size > INT32_MAX, ERR_FILE_CORRUPT);
+			Vector<uint8_t> compressed;
+			compressed.resize(p_blob.size);
+			ERR_FAIL_COND_V(f->get_buffer(compressed.ptrw(), p_blob.size) != (int)p_blob.size, ERR_FILE_CORRUPT);
+			int ret = Compression::decompress(r_data, p_size, compressed.ptr(), p_blob.size, Compression::MODE_ZSTD);
+			ERR_FAIL_COND_V_MSG(ret != (int)p_size, ERR_FILE_CORRUPT, "Failed to decompress blob in binary resource file: " + local_path + ".");
+		} break;
+		default: {
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		}
+	}
+
+	return OK;
+}
+
+Error ResourceLoaderBinary::_parse_blob(uint32_t p_index, Variant &r_v) {
+	ERR_FAIL_UNSIGNED_INDEX_V(p_index, (uint32_t)blobs.size(), ERR_FILE_CORRUPT);
+	const Blob &blob = blobs[p_index];
+
+	// Blobs are only read once the property holding them is parsed, so
+	// sub-resources that are already cached never touch their data.
+	uint64_t pos = f->get_position();
+	Error err = OK;
+
+	switch (blob.type) {
+		case VARIANT_RAW_ARRAY: {
+			Vector<uint8_t> array;
+			array.resize(blob.count);
+			err = _read_blob_data(blob, array.ptrw(), blob.count);
+			r_v = array;
+		} break;
+		case VARIANT_VECTOR3_ARRAY: {
+			ERR_FAIL_COND_V_MSG(sizeof(Vector3) != 12, ERR_UNAVAILABLE, "Vector3 size is NOT 12!");
+			Vector<Vector3> array;
+			array.resize(blob.count);
+			Vector3 *w = array.ptrw();
+			err = _read_blob_data(blob, (uint8_t *)w, uint64_t(blob.count) * sizeof(Vector3));
+#ifdef BIG_ENDIAN_ENABLED
+			{
+				uint32_t *ptr = (uint32_t *)w;
+				for (uint32_t i = 0; i < blob.count * 3; i++) {
+					ptr[i] = BSWAP32(ptr[i]);
+				}
+			}
+
+#endif
+			r_v = array;
+		} break;
+		default: {
+			err = ERR_FILE_CORRUPT;
+		}
+	}
+
+	f->seek(pos);
+
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Corrupt blob in binary resource file: " + local_path + ".");
+	return OK;
+}
+
 void ResourceLoaderBinary::set_local_path(const String &p_local_path) {
 	res_path = p_local_path;
 }
@@ -871,7 +950,12 @@ void ResourceLoaderBinary::open(FileAccess *p_f) {
 	print_bl("type: " + type);
 
 	importmd_ofs = f->get_64();
-	for (int i = 0; i < 14; i++) {
+	int reserved_fields = 14;
+	if (ver_format >= FORMAT_VERSION_BLOBS) {
+		blob_table_ofs = f->get_64();
+		reserved_fields -= 2;
+	}
+	for (int i = 0; i < reserved_fields; i++) {
 		f->get_32(); //skip a few reserved fields
 	}
 
@@ -906,6 +990,23 @@ void ResourceLoaderBinary::open(FileAccess *p_f) {
 
 	print_bl("int resources: " + itos(int_resources_size));
 
+	if (blob_table_ofs) {
+		// Only the table is read here, blob contents are read on demand.
+		f->seek(blob_table_ofs);
+		uint32_t blob_count = f->get_32();
+		blobs.resize(blob_count);
+		for (uint32_t i = 0; i < blob_count; i++) {
+			Blob &blob = blobs.write[i];
+			blob.type = f->get_32();
+			blob.compression = f->get_32();
+			blob.count = f->get_32();
+			blob.offset = f->get_64();
+			blob.size = f->get_64();
+		}
+
+		print_bl("blobs: " + itos(blob_count));
+	}
+
 	if (f->eof_reached()) {
 		error = ERR_FILE_CORRUPT;
 		f->close();
@@ -1151,7 +1252,15 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 	size_t importmd_ofs = f->get_64();
 	fw->store_64(0); //metadata offset
 
-	for (int i = 0; i < 14; i++) {
+	int reserved_fields = 14;
+	uint64_t blob_table_ofs = 0;
+	if (ver_format >= FORMAT_VERSION_BLOBS) {
+		blob_table_ofs = f->get_64();
+		fw->store_64(0); //blob table offset
+		reserved_fields -= 2;
+	}
+
+	for (int i = 0; i < reserved_fields; i++) {
 		fw->store_32(0);
 		f->get_32();
 	}
@@ -1217,6 +1326,10 @@ Error ResourceFormatLoaderBinary::rename_dependencies(const String &p_path, cons
 
 	fw->seek(md_ofs);
 	fw->store_64(importmd_ofs + size_diff);
+	if (blob_table_ofs) {
+		// Blob offsets are relative to the table, so only the table moves.
+		fw->store_64(blob_table_ofs + size_diff);
+	}
 
 	memdelete(f);
 	memdelete(fw);
@@ -1260,10 +1373,10 @@ void ResourceFormatSaverBinaryInstance::_pad_buffer(FileAccess *f, int p_bytes)
 }
 
 void ResourceFormatSaverBinaryInstance::_write_variant(const Variant &p_property, const PropertyInfo &p_hint) {
-	write_variant(f, p_property, resource_set, external_resources, string_map, p_hint);
+	write_variant(f, p_property, resource_set, external_resources, string_map, p_hint, big_endian ? nullptr : &blobs);
 }
 
-void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint) {
+void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint, Vector<Variant> *r_blobs) {
 	switch (p_property.get_type()) {
 		case Variant::NIL: {
 			f->store_32(VARIANT_NIL);
@@ -1516,8 +1629,8 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 					continue;
 				*/
 
-				write_variant(f, E->get(), resource_set, external_resources, string_map);
-				write_variant(f, d[E->get()], resource_set, external_resources, string_map);
+				write_variant(f, E->get(), resource_set, external_resources, string_map, PropertyInfo(), r_blobs);
+				write_variant(f, d[E->get()], resource_set, external_resources, string_map, PropertyInfo(), r_blobs);
 			}
 
 		} break;
@@ -1526,14 +1639,21 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 			Array a = p_property;
 			f->store_32(uint32_t(a.size()));
 			for (int i = 0; i < a.size(); i++) {
-				write_variant(f, a[i], resource_set, external_resources, string_map);
+				write_variant(f, a[i], resource_set, external_resources, string_map, PropertyInfo(), r_blobs);
 			}
 
 		} break;
 		case Variant::PACKED_BYTE_ARRAY: {
-			f->store_32(VARIANT_RAW_ARRAY);
 			Vector<uint8_t> arr = p_property;
 			int len = arr.size();
+			if (r_blobs && len >= BLOB_MIN_SIZE) {
+				f->store_32(VARIANT_BLOB);
+				f->store_32(r_blobs->size());
+				r_blobs->push_back(p_property);
+				break;
+			}
+
+			f->store_32(VARIANT_RAW_ARRAY);
 			f->store_32(len);
 			const uint8_t *r = arr.ptr();
 			f->store_buffer(r, len);
@@ -1596,9 +1716,18 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
 
 		} break;
 		case Variant::PACKED_VECTOR3_ARRAY: {
-			f->store_32(VARIANT_VECTOR3_ARRAY);
 			Vector<Vector3> arr = p_property;
 			int len = arr.size();
+#ifndef BIG_ENDIAN_ENABLED
+			if (r_blobs && sizeof(Vector3) == 12 && len * sizeof(Vector3) >= BLOB_MIN_SIZE) {
+				f->store_32(VARIANT_BLOB);
+				f->store_32(r_blobs->size());
+				r_blobs->push_back(p_property);
+				break;
+			}
+#endif
+
+			f->store_32(VARIANT_VECTOR3_ARRAY);
 			f->store_32(len);
 			const Vector3 *r = arr.ptr();
 			for (int i = 0; i < len; i++) {
@@ -1737,6 +1866,69 @@ void ResourceFormatSaverBinaryInstance::save_unicode_string(FileAccess *f, const
 	f->store_buffer((const uint8_t *)utf8.get_data(), utf8.length() + 1);
 }
 
+void ResourceFormatSaverBinaryInstance::_write_blobs() {
+	// Blob contents are prepared first so the table, which precedes them,
+	// can hold final offsets and sizes.
+	Vector<Vector<uint8_t>> blob_data;
+	Vector<uint32_t> blob_types;
+	Vector<uint32_t> blob_compression;
+	Vector<uint32_t> blob_counts;
+
+	for (int i = 0; i < blobs.size(); i++) {
+		Vector<uint8_t> data;
+		uint32_t type;
+		uint32_t count;
+
+		if (blobs[i].get_type() == Variant::PACKED_BYTE_ARRAY) {
+			data = blobs[i];
+			type = VARIANT_RAW_ARRAY;
+			count = data.size();
+		} else {
+			Vector<Vector3> arr = blobs[i];
+			data.resize(arr.size() * sizeof(Vector3));
+			copymem(data.ptrw(), arr.ptr(), data.size());
+			type = VARIANT_VECTOR3_ARRAY;
+			count = arr.size();
+		}
+
+		uint32_t compression = BLOB_COMPRESSION_NONE;
+		if (compress_blobs) {
+			Vector<uint8_t> compressed;
+			compressed.resize(Compression::get_max_compressed_buffer_size(data.size(), Compression::MODE_ZSTD));
+			int compressed_size = Compression::compress(compressed.ptrw(), data.ptr(), data.size(), Compression::MODE_ZSTD);
+			if (compressed_size > 0 && compressed_size < data.size()) {
+				compressed.resize(compressed_size);
+				data = compressed;
+				compression = BLOB_COMPRESSION_ZSTD;
+			}
+		}
+
+		blob_data.push_back(data);
+		blob_types.push_back(type);
+		blob_compression.push_back(compression);
+		blob_counts.push_back(count);
+	}
+
+	const uint64_t entry_size = 4 + 4 + 4 + 8 + 8;
+	uint64_t offset = 4 + entry_size * blobs.size();
+
+	f->store_32(blobs.size());
+	for (int i = 0; i < blob_data.size(); i++) {
+		f->store_32(blob_types[i]);
+		f->store_32(blob_compression[i]);
+		f->store_32(blob_counts[i]);
+		f->store_64(offset);
+		f->store_64(blob_data[i].size());
+		offset += blob_data[i].size();
+		offset += (4 - (blob_data[i].size() % 4)) % 4;
+	}
+
+	for (int i = 0; i < blob_data.size(); i++) {
+		f->store_buffer(blob_data[i].ptr(), blob_data[i].size());
+		_pad_buffer(f, blob_data[i].size());
+	}
+}
+
 int ResourceFormatSaverBinaryInstance::get_string_index(const String &p_string) {
 	StringName s = p_string;
 	if (string_map.has(s)) {
@@ -1770,6 +1962,8 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 	bundle_resources = p_flags & ResourceSaver::FLAG_BUNDLE_RESOURCES;
 	big_endian = p_flags & ResourceSaver::FLAG_SAVE_BIG_ENDIAN;
 	takeover_paths = p_flags & ResourceSaver::FLAG_REPLACE_SUBRESOURCE_PATHS;
+	// Don't compress blobs twice when the whole file is already compressed.
+	compress_blobs = !(p_flags & ResourceSaver::FLAG_COMPRESS);
 
 	if (!p_path.begins_with("res://")) {
 		takeover_paths = false;
@@ -1806,7 +2000,9 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 
 	save_unicode_string(f, p_resource->get_class());
 	f->store_64(0); //offset to import metadata
-	for (int i = 0; i < 14; i++) {
+	uint64_t blob_table_ofs_pos = f->get_position();
+	f->store_64(0); //offset to blob table
+	for (int i = 0; i < 12; i++) {
 		f->store_32(0); // reserved
 	}
 
@@ -1935,6 +2131,13 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 		}
 	}
 
+	if (blobs.size()) {
+		uint64_t blob_table_ofs = f->get_position();
+		_write_blobs();
+		f->seek(blob_table_ofs_pos);
+		f->store_64(blob_table_ofs);
+	}
+
 	for (int i = 0; i < ofs_table.size(); i++) {
 		f->seek(ofs_pos[i]);
 		f->store_64(ofs_table[i]);
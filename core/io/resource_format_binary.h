@@ -72,6 +72,20 @@ class ResourceLoaderBinary {
 	Vector<IntResource> internal_resources;
 	Map<String, RES> internal_index_cache;
 
+	struct Blob {
+		uint32_t type = 0;
+		uint32_t compression = 0;
+		uint32_t count = 0;
+		uint64_t offset = 0; // Relative to the start of the blob table.
+		uint64_t size = 0;
+	};
+
+	uint64_t blob_table_ofs = 0;
+	Vector<Blob> blobs;
+
+	Error _read_blob_data(const Blob &p_blob, uint8_t *r_data, uint64_t p_size);
+	Error _parse_blob(uint32_t p_index, Variant &r_v);
+
 	String get_unicode_string();
 	void _advance_padding(uint32_t p_len);
 
@@ -138,6 +152,10 @@ class ResourceFormatSaverBinaryInstance {
 	Map<RES, int> external_resources;
 	List<RES> saved_resources;
 
+	// Large packed arrays, stored out of line after all resources.
+	Vector<Variant> blobs;
+	bool compress_blobs = true;
+
 	struct Property {
 		int name_idx;
 		Variant value;
@@ -154,10 +172,11 @@ class ResourceFormatSaverBinaryInstance {
 	void _find_resources(const Variant &p_variant, bool p_main = false);
 	static void save_unicode_string(FileAccess *f, const String &p_string, bool p_bit_on_len = false);
 	int get_string_index(const String &p_string);
+	void _write_blobs();
 
 public:
 	Error save(const String &p_path, const RES &p_resource, uint32_t p_flags = 0);
-	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint = PropertyInfo());
+	static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, Map<RES, int> &external_resources, Map<StringName, int> &string_map, const PropertyInfo &p_hint = PropertyInfo(), Vector<Variant> *r_blobs = nullptr);
 };
 
 class ResourceFormatSaverBinary : public ResourceFormatSaver {
@@ -50,6 +50,7 @@ Error ResourceFormatImporter::_get_path_and_type(const String &p_path, PathAndTy
 
 	VariantParser::StreamFile stream;
 	stream.f = f;
+	stream.readahead_enabled = true;
 
 	String assign;
 	Variant value;
@@ -216,6 +217,31 @@ int ResourceFormatImporter::get_import_order(const String &p_path) const {
 	return 0;
 }
 
+void ResourceFormatImporter::get_import_order_threads_and_importer(const String &p_path, int &r_order, bool &r_can_threads, String &r_importer) const {
+	r_order = 0;
+	r_can_threads = false;
+	r_importer = String();
+
+	Ref<ResourceImporter> importer;
+
+	if (FileAccess::exists(p_path + ".import")) {
+		PathAndType pat;
+		Error err = _get_path_and_type(p_path, pat);
+
+		if (err == OK) {
+			importer = get_importer_by_name(pat.importer);
+		}
+	} else {
+		importer = get_importer_by_extension(p_path.get_extension().to_lower());
+	}
+
+	if (importer.is_valid()) {
+		r_order = importer->get_import_order();
+		r_can_threads = importer->can_import_threaded();
+		r_importer = importer->get_importer_name();
+	}
+}
+
 bool ResourceFormatImporter::handles_type(const String &p_type) const {
 	for (int i = 0; i < importers.size(); i++) {
 		String res_type = importers[i]->get_resource_type();
@@ -251,6 +277,7 @@ void ResourceFormatImporter::get_internal_resource_path_list(const String &p_pat
 
 	VariantParser::StreamFile stream;
 	stream.f = f;
+	stream.readahead_enabled = true;
 
 	String assign;
 	Variant value;
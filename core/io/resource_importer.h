@@ -72,6 +72,7 @@ public:
 
 	virtual bool can_be_imported(const String &p_path) const;
 	virtual int get_import_order(const String &p_path) const;
+	void get_import_order_threads_and_importer(const String &p_path, int &r_order, bool &r_can_threads, String &r_importer) const;
 
 	String get_internal_resource_path(const String &p_path) const;
 	void get_internal_resource_path_list(const String &p_path, List<String> *r_paths);
@@ -126,6 +127,13 @@ public:
 	virtual Error import_group_file(const String &p_group_file, const Map<String, Map<StringName, Variant>> &p_source_file_options, const Map<String, String> &p_base_paths) { return ERR_UNAVAILABLE; }
 	virtual bool are_import_settings_valid(const String &p_path) const { return true; }
 	virtual String get_import_settings_string() const { return String(); }
+
+	// Importers returning true here must be safe to call import() from several threads at once.
+	virtual bool can_import_threaded() const { return false; }
+
+	// Importers returning true here must write nothing but the files under p_save_path, and depend on
+	// nothing but the source file and the options, so the result can be cached by content.
+	virtual bool can_cache_import(const Map<StringName, Variant> &p_options) const { return false; }
 };
 
 #endif // RESOURCE_IMPORTER_H
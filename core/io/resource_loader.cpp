@@ -906,6 +906,7 @@ String ResourceLoader::_path_remap(const String &p_path, bool *r_translation_rem
 		if (f) {
 			VariantParser::StreamFile stream;
 			stream.f = f;
+			stream.readahead_enabled = true;
 
 			String assign;
 			Variant value;
@@ -0,0 +1,665 @@
+/*************************************************************************/
+/*  cull_bvh.h                                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef CULL_BVH_H
+#define CULL_BVH_H
+
+#include "core/local_vector.h"
+#include "core/math/aabb.h"
+#include "core/math/geometry_3d.h"
+#include "core/sort_array.h"
+
+/**
+ * Bounding volume hierarchy for culling many AABBs with frustums and boxes.
+ *
+ * The tree is kept in flat arrays and every node stores the bounds of its four
+ * children per axis, so a plane can be tested against the four of them with the
+ * same few instructions (which compilers turn into SIMD code).
+ *
+ * Moving elements only refits the bounds of their branch. New elements are kept
+ * aside and tested one by one until enough of them accumulate, and then the tree
+ * is rebuilt. update() must be called after changes and before culling, culling
+ * itself is read only and can run from several threads at once.
+ *
+ * Elements can also have a visibility range, the distances from a point (usually
+ * the camera) to their center between which they are returned. Nodes keep the
+ * loosest range of their children, so whole branches that are too close or too far
+ * are skipped during the traversal.
+ */
+
+typedef uint32_t CullBVHElementID;
+
+#define CULL_BVH_INVALID_ID 0
+
+template <class T>
+class CullBVH {
+	enum {
+		LEAF_SIZE = 8,
+		REBUILD_PENDING_MIN = 64,
+		INVALID_INDEX = 0xFFFFFFFF,
+	};
+
+	enum ElementState {
+		STATE_FREE,
+		STATE_PENDING, // Not in the tree yet.
+		STATE_TREE,
+		STATE_TREE_REMOVED, // Still referenced by a leaf until the next rebuild.
+	};
+
+	struct Element {
+		AABB aabb;
+		T *userdata = nullptr;
+		uint32_t mask = 0;
+		real_t range_begin = 0;
+		real_t range_end = RANGE_UNLIMITED;
+		ElementState state = STATE_FREE;
+		uint32_t index = INVALID_INDEX; // Node owning the leaf, or position in the pending list.
+	};
+
+	struct Node {
+		real_t min_x[4];
+		real_t min_y[4];
+		real_t min_z[4];
+		real_t max_x[4];
+		real_t max_y[4];
+		real_t max_z[4];
+		uint32_t mask[4]; // All element masks of the child ORed together, 0 for unused children.
+		real_t range_begin[4]; // Smallest range begin of the child.
+		real_t range_end[4]; // Largest range end of the child.
+		uint32_t child[4]; // Index of the child node, or of the first element in leaf_elements.
+		uint32_t leaf_count[4]; // 0 if the child is a node.
+		uint32_t parent;
+		bool dirty;
+	};
+
+	struct BuildRef {
+		uint32_t id;
+		Vector3 center;
+	};
+
+	struct BuildRefCompare {
+		int axis = 0;
+		_FORCE_INLINE_ bool operator()(const BuildRef &p_a, const BuildRef &p_b) const {
+			return p_a.center[axis] < p_b.center[axis];
+		}
+	};
+
+	static constexpr real_t RANGE_UNLIMITED = 1e18; // Still fits in a float once squared.
+
+	LocalVector<Element> elements;
+	LocalVector<uint32_t> free_elements;
+	LocalVector<uint32_t> removed_elements; // Can only be reused after a rebuild.
+	LocalVector<uint32_t> pending;
+
+	LocalVector<Node> nodes;
+	LocalVector<uint32_t> leaf_elements;
+	uint32_t tree_element_count = 0;
+	uint32_t moves_since_build = 0;
+	bool needs_refit = false;
+
+	_FORCE_INLINE_ static void _set_child_empty(Node &r_node, int p_child) {
+		r_node.min_x[p_child] = r_node.min_y[p_child] = r_node.min_z[p_child] = 1e20;
+		r_node.max_x[p_child] = r_node.max_y[p_child] = r_node.max_z[p_child] = -1e20;
+		r_node.mask[p_child] = 0;
+		r_node.range_begin[p_child] = RANGE_UNLIMITED;
+		r_node.range_end[p_child] = 0;
+		r_node.child[p_child] = INVALID_INDEX;
+		r_node.leaf_count[p_child] = 0;
+	}
+
+	_FORCE_INLINE_ static void _set_child_bounds(Node &r_node, int p_child, const AABB &p_aabb) {
+		r_node.min_x[p_child] = p_aabb.position.x;
+		r_node.min_y[p_child] = p_aabb.position.y;
+		r_node.min_z[p_child] = p_aabb.position.z;
+		r_node.max_x[p_child] = p_aabb.position.x + p_aabb.size.x;
+		r_node.max_y[p_child] = p_aabb.position.y + p_aabb.size.y;
+		r_node.max_z[p_child] = p_aabb.position.z + p_aabb.size.z;
+	}
+
+	_FORCE_INLINE_ static AABB _get_node_bounds(const Node &p_node) {
+		Vector3 min(1e20, 1e20, 1e20);
+		Vector3 max(-1e20, -1e20, -1e20);
+		for (int i = 0; i < 4; i++) {
+			if (!p_node.mask[i]) {
+				continue;
+			}
+			min.x = MIN(min.x, p_node.min_x[i]);
+			min.y = MIN(min.y, p_node.min_y[i]);
+			min.z = MIN(min.z, p_node.min_z[i]);
+			max.x = MAX(max.x, p_node.max_x[i]);
+			max.y = MAX(max.y, p_node.max_y[i]);
+			max.z = MAX(max.z, p_node.max_z[i]);
+		}
+		return AABB(min, max - min);
+	}
+
+	_FORCE_INLINE_ static uint32_t _get_node_mask(const Node &p_node) {
+		return p_node.mask[0] | p_node.mask[1] | p_node.mask[2] | p_node.mask[3];
+	}
+
+	_FORCE_INLINE_ static void _set_child_range_from_node(Node &r_node, int p_child, const Node &p_from) {
+		r_node.range_begin[p_child] = MIN(MIN(p_from.range_begin[0], p_from.range_begin[1]), MIN(p_from.range_begin[2], p_from.range_begin[3]));
+		r_node.range_end[p_child] = MAX(MAX(p_from.range_end[0], p_from.range_end[1]), MAX(p_from.range_end[2], p_from.range_end[3]));
+	}
+
+	void _mark_dirty(uint32_t p_node) {
+		while (p_node != INVALID_INDEX && !nodes[p_node].dirty) {
+			nodes[p_node].dirty = true;
+			p_node = nodes[p_node].parent;
+		}
+		needs_refit = true;
+	}
+
+	uint32_t _create_node(uint32_t p_parent) {
+		Node node;
+		for (int i = 0; i < 4; i++) {
+			_set_child_empty(node, i);
+		}
+		node.parent = p_parent;
+		node.dirty = false;
+		nodes.push_back(node);
+		return nodes.size() - 1;
+	}
+
+	void _make_leaf(uint32_t p_node, int p_child, const BuildRef *p_refs, uint32_t p_count) {
+		AABB aabb = elements[p_refs[0].id].aabb;
+		uint32_t mask = 0;
+		real_t range_begin = RANGE_UNLIMITED;
+		real_t range_end = 0;
+		Node &node = nodes[p_node];
+		node.child[p_child] = leaf_elements.size();
+		node.leaf_count[p_child] = p_count;
+		for (uint32_t i = 0; i < p_count; i++) {
+			Element &e = elements[p_refs[i].id];
+			e.state = STATE_TREE;
+			e.index = p_node;
+			aabb.merge_with(e.aabb);
+			mask |= e.mask;
+			range_begin = MIN(range_begin, e.range_begin);
+			range_end = MAX(range_end, e.range_end);
+			leaf_elements.push_back(p_refs[i].id);
+		}
+		_set_child_bounds(node, p_child, aabb);
+		node.mask[p_child] = mask;
+		node.range_begin[p_child] = range_begin;
+		node.range_end[p_child] = range_end;
+	}
+
+	uint32_t _split(BuildRef *p_refs, uint32_t p_count) {
+		// Median split along the longest axis of the centers.
+		AABB bounds(p_refs[0].center, Vector3());
+		for (uint32_t i = 1; i < p_count; i++) {
+			bounds.expand_to(p_refs[i].center);
+		}
+
+		SortArray<BuildRef, BuildRefCompare> sorter;
+		sorter.compare.axis = bounds.get_longest_axis_index();
+		uint32_t half = p_count / 2;
+		sorter.nth_element(0, p_count, half, p_refs);
+		return half;
+	}
+
+	void _build_node(uint32_t p_node, BuildRef *p_refs, uint32_t p_count) {
+		// Split in two, then each half in two again, to fill up to four children.
+		BuildRef *groups[4];
+		uint32_t group_counts[4];
+		int group_count = 0;
+
+		uint32_t half = _split(p_refs, p_count);
+		BuildRef *halves[2] = { p_refs, p_refs + half };
+		uint32_t half_counts[2] = { half, p_count - half };
+		for (int i = 0; i < 2; i++) {
+			if (half_counts[i] > LEAF_SIZE) {
+				uint32_t quarter = _split(halves[i], half_counts[i]);
+				groups[group_count] = halves[i];
+				group_counts[group_count++] = quarter;
+				groups[group_count] = halves[i] + quarter;
+				group_counts[group_count++] = half_counts[i] - quarter;
+			} else {
+				groups[group_count] = halves[i];
+				group_counts[group_count++] = half_counts[i];
+			}
+		}
+
+		for (int i = 0; i < group_count; i++) {
+			if (group_counts[i] <= LEAF_SIZE) {
+				_make_leaf(p_node, i, groups[i], group_counts[i]);
+			} else {
+				uint32_t child = _create_node(p_node);
+				nodes[p_node].child[i] = child;
+				_build_node(child, groups[i], group_counts[i]);
+				_set_child_bounds(nodes[p_node], i, _get_node_bounds(nodes[child]));
+				nodes[p_node].mask[i] = _get_node_mask(nodes[child]);
+				_set_child_range_from_node(nodes[p_node], i, nodes[child]);
+			}
+		}
+	}
+
+	void _rebuild() {
+		LocalVector<BuildRef> refs;
+		refs.reserve(tree_element_count + pending.size());
+		for (uint32_t i = 0; i < leaf_elements.size(); i++) {
+			const Element &e = elements[leaf_elements[i]];
+			if (e.state == STATE_TREE) {
+				refs.push_back({ leaf_elements[i], e.aabb.position + e.aabb.size * 0.5 });
+			}
+		}
+		for (uint32_t i = 0; i < pending.size(); i++) {
+			const Element &e = elements[pending[i]];
+			refs.push_back({ pending[i], e.aabb.position + e.aabb.size * 0.5 });
+		}
+
+		for (uint32_t i = 0; i < removed_elements.size(); i++) {
+			elements[removed_elements[i]].state = STATE_FREE;
+			free_elements.push_back(removed_elements[i]);
+		}
+		removed_elements.clear();
+		pending.clear();
+		nodes.clear();
+		leaf_elements.clear();
+
+		tree_element_count = refs.size();
+		moves_since_build = 0;
+		needs_refit = false;
+
+		if (refs.size() == 0) {
+			return;
+		}
+
+		uint32_t root = _create_node(INVALID_INDEX);
+		if (refs.size() <= LEAF_SIZE) {
+			_make_leaf(root, 0, refs.ptr(), refs.size());
+		} else {
+			_build_node(root, refs.ptr(), refs.size());
+		}
+	}
+
+	void _refit() {
+		// Children are always created after their parents, so going backwards refits bottom up.
+		for (int64_t i = int64_t(nodes.size()) - 1; i >= 0; i--) {
+			Node &node = nodes[i];
+			if (!node.dirty) {
+				continue;
+			}
+			for (int j = 0; j < 4; j++) {
+				if (node.child[j] == INVALID_INDEX) {
+					continue;
+				}
+				if (node.leaf_count[j]) {
+					AABB aabb;
+					uint32_t mask = 0;
+					real_t range_begin = RANGE_UNLIMITED;
+					real_t range_end = 0;
+					const uint32_t *ids = &leaf_elements[node.child[j]];
+					for (uint32_t k = 0; k < node.leaf_count[j]; k++) {
+						const Element &e = elements[ids[k]];
+						if (e.state != STATE_TREE) {
+							continue;
+						}
+						if (mask == 0) {
+							aabb = e.aabb;
+						} else {
+							aabb.merge_with(e.aabb);
+						}
+						mask |= e.mask;
+						range_begin = MIN(range_begin, e.range_begin);
+						range_end = MAX(range_end, e.range_end);
+					}
+					_set_child_bounds(node, j, aabb);
+					node.mask[j] = mask;
+					node.range_begin[j] = range_begin;
+					node.range_end[j] = range_end;
+				} else {
+					const Node &child = nodes[node.child[j]];
+					_set_child_bounds(node, j, _get_node_bounds(child));
+					node.mask[j] = _get_node_mask(child);
+					_set_child_range_from_node(node, j, child);
+				}
+			}
+			node.dirty = false;
+		}
+		needs_refit = false;
+	}
+
+	struct CullConvexData {
+		const Plane *planes;
+		int plane_count;
+		const Vector3 *points;
+		int point_count;
+		AABB points_aabb;
+		uint32_t mask;
+		bool use_range;
+		Vector3 range_origin;
+	};
+
+	_FORCE_INLINE_ static bool _is_in_range(const Element &p_element, const CullConvexData &p_data) {
+		if (!p_data.use_range) {
+			return true;
+		}
+		real_t d2 = (p_element.aabb.position + p_element.aabb.size * 0.5).distance_squared_to(p_data.range_origin);
+		return d2 >= p_element.range_begin * p_element.range_begin && d2 <= p_element.range_end * p_element.range_end;
+	}
+
+	// Marks the children whose centers are all too close or too far from the range origin.
+	_FORCE_INLINE_ static void _cull_children_range(const Node &p_node, const CullConvexData &p_data, bool *r_outside) {
+		const Vector3 &o = p_data.range_origin;
+		for (int i = 0; i < 4; i++) {
+			real_t near_x = MAX(MAX(p_node.min_x[i] - o.x, o.x - p_node.max_x[i]), 0);
+			real_t near_y = MAX(MAX(p_node.min_y[i] - o.y, o.y - p_node.max_y[i]), 0);
+			real_t near_z = MAX(MAX(p_node.min_z[i] - o.z, o.z - p_node.max_z[i]), 0);
+			real_t far_x = MAX(Math::abs(p_node.min_x[i] - o.x), Math::abs(p_node.max_x[i] - o.x));
+			real_t far_y = MAX(Math::abs(p_node.min_y[i] - o.y), Math::abs(p_node.max_y[i] - o.y));
+			real_t far_z = MAX(Math::abs(p_node.min_z[i] - o.z), Math::abs(p_node.max_z[i] - o.z));
+			real_t near_d2 = near_x * near_x + near_y * near_y + near_z * near_z;
+			real_t far_d2 = far_x * far_x + far_y * far_y + far_z * far_z;
+			r_outside[i] = r_outside[i] || near_d2 > p_node.range_end[i] * p_node.range_end[i] || far_d2 < p_node.range_begin[i] * p_node.range_begin[i];
+		}
+	}
+
+	_FORCE_INLINE_ void _add_leaf(uint32_t p_first, uint32_t p_count, const CullConvexData &p_data, LocalVector<T *> &r_result) const {
+		for (uint32_t i = 0; i < p_count; i++) {
+			const Element &e = elements[leaf_elements[p_first + i]];
+			if (e.state == STATE_TREE && (e.mask & p_data.mask) && _is_in_range(e, p_data)) {
+				r_result.push_back(e.userdata);
+			}
+		}
+	}
+
+	void _add_subtree(uint32_t p_node, const CullConvexData &p_data, LocalVector<T *> &r_result) const {
+		const Node &node = nodes[p_node];
+		bool outside[4];
+		for (int i = 0; i < 4; i++) {
+			outside[i] = !(node.mask[i] & p_data.mask);
+		}
+		if (p_data.use_range) {
+			_cull_children_range(node, p_data, outside);
+		}
+		for (int i = 0; i < 4; i++) {
+			if (outside[i]) {
+				continue;
+			}
+			if (node.leaf_count[i]) {
+				_add_leaf(node.child[i], node.leaf_count[i], p_data, r_result);
+			} else {
+				_add_subtree(node.child[i], p_data, r_result);
+			}
+		}
+	}
+
+	void _cull_convex(uint32_t p_node, const CullConvexData &p_data, LocalVector<T *> &r_result) const {
+		const Node &node = nodes[p_node];
+
+		// Test the four children at once against each plane.
+		bool outside[4];
+		bool inside[4];
+		const Vector3 &pmin = p_data.points_aabb.position;
+		const Vector3 pmax = p_data.points_aabb.position + p_data.points_aabb.size;
+		for (int i = 0; i < 4; i++) {
+			outside[i] = !(node.mask[i] & p_data.mask) ||
+						 node.min_x[i] > pmax.x || node.max_x[i] < pmin.x ||
+						 node.min_y[i] > pmax.y || node.max_y[i] < pmin.y ||
+						 node.min_z[i] > pmax.z || node.max_z[i] < pmin.z;
+			inside[i] = true;
+		}
+		if (p_data.use_range) {
+			_cull_children_range(node, p_data, outside);
+		}
+
+		for (int j = 0; j < p_data.plane_count; j++) {
+			const Plane &p = p_data.planes[j];
+			// Corner closest to the back of the plane decides if the box is out,
+			// the opposite one if it is fully in.
+			const real_t *near_x = p.normal.x > 0 ? node.min_x : node.max_x;
+			const real_t *near_y = p.normal.y > 0 ? node.min_y : node.max_y;
+			const real_t *near_z = p.normal.z > 0 ? node.min_z : node.max_z;
+			const real_t *far_x = p.normal.x > 0 ? node.max_x : node.min_x;
+			const real_t *far_y = p.normal.y > 0 ? node.max_y : node.min_y;
+			const real_t *far_z = p.normal.z > 0 ? node.max_z : node.min_z;
+			for (int i = 0; i < 4; i++) {
+				real_t near_d = p.normal.x * near_x[i] + p.normal.y * near_y[i] + p.normal.z * near_z[i] - p.d;
+				real_t far_d = p.normal.x * far_x[i] + p.normal.y * far_y[i] + p.normal.z * far_z[i] - p.d;
+				outside[i] = outside[i] || near_d > 0;
+				inside[i] = inside[i] && far_d <= 0;
+			}
+		}
+
+		for (int i = 0; i < 4; i++) {
+			if (outside[i]) {
+				continue;
+			}
+			if (node.leaf_count[i]) {
+				if (inside[i]) {
+					_add_leaf(node.child[i], node.leaf_count[i], p_data, r_result);
+					continue;
+				}
+				const uint32_t *ids = &leaf_elements[node.child[i]];
+				for (uint32_t k = 0; k < node.leaf_count[i]; k++) {
+					const Element &e = elements[ids[k]];
+					if (e.state == STATE_TREE && (e.mask & p_data.mask) && _is_in_range(e, p_data) && e.aabb.intersects_convex_shape(p_data.planes, p_data.plane_count, p_data.points, p_data.point_count)) {
+						r_result.push_back(e.userdata);
+					}
+				}
+			} else if (inside[i]) {
+				_add_subtree(node.child[i], p_data, r_result);
+			} else {
+				_cull_convex(node.child[i], p_data, r_result);
+			}
+		}
+	}
+
+	void _cull_aabb(uint32_t p_node, const AABB &p_aabb, uint32_t p_mask, LocalVector<T *> &r_result) const {
+		const Node &node = nodes[p_node];
+		const Vector3 &amin = p_aabb.position;
+		const Vector3 amax = p_aabb.position + p_aabb.size;
+
+		for (int i = 0; i < 4; i++) {
+			if (!(node.mask[i] & p_mask) ||
+					node.min_x[i] > amax.x || node.max_x[i] < amin.x ||
+					node.min_y[i] > amax.y || node.max_y[i] < amin.y ||
+					node.min_z[i] > amax.z || node.max_z[i] < amin.z) {
+				continue;
+			}
+			if (node.leaf_count[i]) {
+				const uint32_t *ids = &leaf_elements[node.child[i]];
+				for (uint32_t k = 0; k < node.leaf_count[i]; k++) {
+					const Element &e = elements[ids[k]];
+					if (e.state == STATE_TREE && (e.mask & p_mask) && e.aabb.intersects(p_aabb)) {
+						r_result.push_back(e.userdata);
+					}
+				}
+			} else {
+				_cull_aabb(node.child[i], p_aabb, p_mask, r_result);
+			}
+		}
+	}
+
+	void _cull_convex_begin(const Plane *p_planes, int p_plane_count, const Vector3 *p_range_origin, LocalVector<T *> &r_result, uint32_t p_mask) const {
+		if (p_plane_count == 0 || (nodes.size() == 0 && pending.size() == 0)) {
+			return;
+		}
+
+		Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(p_planes, p_plane_count);
+		if (points.size() == 0) {
+			return;
+		}
+
+		CullConvexData data;
+		data.planes = p_planes;
+		data.plane_count = p_plane_count;
+		data.points = points.ptr();
+		data.point_count = points.size();
+		data.points_aabb = AABB(points[0], Vector3());
+		for (int i = 1; i < points.size(); i++) {
+			data.points_aabb.expand_to(points[i]);
+		}
+		data.mask = p_mask;
+		data.use_range = p_range_origin != nullptr;
+		if (data.use_range) {
+			data.range_origin = *p_range_origin;
+		}
+
+		if (nodes.size()) {
+			_cull_convex(0, data, r_result);
+		}
+
+		for (uint32_t i = 0; i < pending.size(); i++) {
+			const Element &e = elements[pending[i]];
+			if ((e.mask & p_mask) && _is_in_range(e, data) && e.aabb.intersects_convex_shape(data.planes, data.plane_count, data.points, data.point_count)) {
+				r_result.push_back(e.userdata);
+			}
+		}
+	}
+
+public:
+	CullBVHElementID create(T *p_userdata, const AABB &p_aabb, uint32_t p_mask = 1) {
+		uint32_t index;
+		if (free_elements.size()) {
+			index = free_elements[free_elements.size() - 1];
+			free_elements.resize(free_elements.size() - 1);
+		} else {
+			index = elements.size();
+			elements.push_back(Element());
+		}
+
+		Element &e = elements[index];
+		e.aabb = p_aabb;
+		e.userdata = p_userdata;
+		e.mask = p_mask;
+		e.state = STATE_PENDING;
+		e.index = pending.size();
+		pending.push_back(index);
+
+		return index + 1;
+	}
+
+	void move(CullBVHElementID p_id, const AABB &p_aabb) {
+		ERR_FAIL_COND(p_id == CULL_BVH_INVALID_ID || p_id > elements.size());
+		Element &e = elements[p_id - 1];
+		ERR_FAIL_COND(e.state != STATE_PENDING && e.state != STATE_TREE);
+		e.aabb = p_aabb;
+		if (e.state == STATE_TREE) {
+			moves_since_build++;
+			_mark_dirty(e.index);
+		}
+	}
+
+	void set_mask(CullBVHElementID p_id, uint32_t p_mask) {
+		ERR_FAIL_COND(p_id == CULL_BVH_INVALID_ID || p_id > elements.size());
+		Element &e = elements[p_id - 1];
+		ERR_FAIL_COND(e.state != STATE_PENDING && e.state != STATE_TREE);
+		e.mask = p_mask;
+		if (e.state == STATE_TREE) {
+			_mark_dirty(e.index);
+		}
+	}
+
+	// Distances from the range origin to the center of the element between which it is culled,
+	// an end of 0 means no limit. Only used by cull_convex() when it is given a range origin.
+	void set_visibility_range(CullBVHElementID p_id, real_t p_begin, real_t p_end) {
+		ERR_FAIL_COND(p_id == CULL_BVH_INVALID_ID || p_id > elements.size());
+		Element &e = elements[p_id - 1];
+		ERR_FAIL_COND(e.state != STATE_PENDING && e.state != STATE_TREE);
+		e.range_begin = CLAMP(p_begin, 0, RANGE_UNLIMITED);
+		e.range_end = p_end > 0 ? MIN(p_end, RANGE_UNLIMITED) : RANGE_UNLIMITED;
+		if (e.state == STATE_TREE) {
+			_mark_dirty(e.index);
+		}
+	}
+
+	void erase(CullBVHElementID p_id) {
+		ERR_FAIL_COND(p_id == CULL_BVH_INVALID_ID || p_id > elements.size());
+		uint32_t index = p_id - 1;
+		Element &e = elements[index];
+		if (e.state == STATE_PENDING) {
+			// Swap with the last pending element.
+			uint32_t last = pending[pending.size() - 1];
+			pending[e.index] = last;
+			elements[last].index = e.index;
+			pending.resize(pending.size() - 1);
+			e.state = STATE_FREE;
+			e.userdata = nullptr;
+			e.range_begin = 0;
+			e.range_end = RANGE_UNLIMITED;
+			free_elements.push_back(index);
+		} else if (e.state == STATE_TREE) {
+			e.state = STATE_TREE_REMOVED;
+			e.userdata = nullptr;
+			e.range_begin = 0;
+			e.range_end = RANGE_UNLIMITED;
+			tree_element_count--;
+			removed_elements.push_back(index);
+			_mark_dirty(e.index);
+		} else {
+			ERR_FAIL_MSG("Element was already erased.");
+		}
+	}
+
+	// Applies all the changes since the last call, must be called before culling.
+	void update() {
+		uint32_t count = tree_element_count + pending.size();
+		bool rebuild = pending.size() > MAX(uint32_t(REBUILD_PENDING_MIN), count / 16);
+		// Too many removed or moved elements leave the tree loose or unbalanced.
+		rebuild = rebuild || removed_elements.size() > MAX(uint32_t(REBUILD_PENDING_MIN), count / 4);
+		rebuild = rebuild || moves_since_build > MAX(uint32_t(REBUILD_PENDING_MIN), count * 4);
+
+		if (rebuild) {
+			_rebuild();
+		} else if (needs_refit) {
+			_refit();
+		}
+	}
+
+	void cull_convex(const Plane *p_planes, int p_plane_count, LocalVector<T *> &r_result, uint32_t p_mask = 0xFFFFFFFF) const {
+		_cull_convex_begin(p_planes, p_plane_count, nullptr, r_result, p_mask);
+	}
+
+	// Same as above, but also skips the elements out of their visibility range from p_range_origin.
+	void cull_convex(const Plane *p_planes, int p_plane_count, const Vector3 &p_range_origin, LocalVector<T *> &r_result, uint32_t p_mask = 0xFFFFFFFF) const {
+		_cull_convex_begin(p_planes, p_plane_count, &p_range_origin, r_result, p_mask);
+	}
+
+	void cull_aabb(const AABB &p_aabb, LocalVector<T *> &r_result, uint32_t p_mask = 0xFFFFFFFF) const {
+		if (nodes.size()) {
+			_cull_aabb(0, p_aabb, p_mask, r_result);
+		}
+
+		for (uint32_t i = 0; i < pending.size(); i++) {
+			const Element &e = elements[pending[i]];
+			if ((e.mask & p_mask) && e.aabb.intersects(p_aabb)) {
+				r_result.push_back(e.userdata);
+			}
+		}
+	}
+
+	uint32_t get_element_count() const { return tree_element_count + pending.size(); }
+	uint32_t get_node_count() const { return nodes.size(); }
+};
+
+#endif // CULL_BVH_H
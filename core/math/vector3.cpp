@@ -151,3 +151,44 @@ bool Vector3::is_equal_approx(const Vector3 &p_v) const {
 Vector3::operator String() const {
 	return (rtos(x) + ", " + rtos(y) + ", " + rtos(z));
 }
+
+Vector2 Vector3::octahedron_encode() const {
+	real_t l1 = Math::abs(x) + Math::abs(y) + Math::abs(z);
+	if (l1 == 0) {
+		return Vector2();
+	}
+	Vector3 n = *this / l1;
+	if (n.z >= 0) {
+		return Vector2(n.x, n.y);
+	}
+	// Fold the lower hemisphere over the diagonals.
+	return Vector2((1 - Math::abs(n.y)) * (n.x >= 0 ? 1 : -1), (1 - Math::abs(n.x)) * (n.y >= 0 ? 1 : -1));
+}
+
+Vector3 Vector3::octahedron_decode(const Vector2 &p_oct) {
+	Vector3 n(p_oct.x, p_oct.y, 1 - Math::abs(p_oct.x) - Math::abs(p_oct.y));
+	real_t t = MAX(-n.z, 0);
+	n.x += n.x >= 0 ? -t : t;
+	n.y += n.y >= 0 ? -t : t;
+	return n.normalized();
+}
+
+Vector2 Vector3::octahedron_tangent_encode(real_t p_sign) const {
+	// The binormal sign is stored in the sign of y, which is remapped to [0, 1] first
+	// (and kept away from zero so the sign survives quantization).
+	Vector2 oct = octahedron_encode();
+	oct.y = MAX(oct.y * 0.5 + 0.5, (real_t)(1.0 / 32767.0));
+	if (p_sign < 0) {
+		oct.y = -oct.y;
+	}
+	return oct;
+}
+
+Vector3 Vector3::octahedron_tangent_decode(const Vector2 &p_oct, real_t *r_sign) {
+	Vector2 oct = p_oct;
+	if (r_sign) {
+		*r_sign = oct.y < 0 ? -1 : 1;
+	}
+	oct.y = Math::abs(oct.y) * 2 - 1;
+	return octahedron_decode(oct);
+}
@@ -32,6 +32,7 @@
 #define VECTOR3_H
 
 #include "core/math/math_funcs.h"
+#include "core/math/vector2.h"
 #include "core/math/vector3i.h"
 #include "core/ustring.h"
 
@@ -119,6 +120,13 @@ struct Vector3 {
 
 	bool is_equal_approx(const Vector3 &p_v) const;
 
+	/* Octahedral encoding of unit vectors, in [-1, 1] */
+
+	Vector2 octahedron_encode() const;
+	static Vector3 octahedron_decode(const Vector2 &p_oct);
+	Vector2 octahedron_tangent_encode(real_t p_sign) const;
+	static Vector3 octahedron_tangent_decode(const Vector2 &p_oct, real_t *r_sign);
+
 	/* Operators */
 
 	_FORCE_INLINE_ Vector3 &operator+=(const Vector3 &p_v);
@@ -30,6 +30,7 @@
 
 #include "dir_access.h"
 
+#include "core/local_vector.h"
 #include "core/os/file_access.h"
 #include "core/os/memory.h"
 #include "core/os/os.h"
@@ -281,11 +282,16 @@ Error DirAccess::copy(String p_from, String p_to, int p_chmod_flags) {
 		return err;
 	}
 
+	const size_t copy_buffer_limit = 65536; // 64 KB
+
 	fsrc->seek_end(0);
-	int size = fsrc->get_position();
+	uint64_t size = fsrc->get_position();
 	fsrc->seek(0);
 	err = OK;
-	while (size--) {
+	size_t buffer_size = MIN(size * sizeof(uint8_t), copy_buffer_limit);
+	LocalVector<uint8_t> buffer;
+	buffer.resize(buffer_size);
+	while (size > 0) {
 		if (fsrc->get_error() != OK) {
 			err = fsrc->get_error();
 			break;
@@ -295,7 +301,14 @@ Error DirAccess::copy(String p_from, String p_to, int p_chmod_flags) {
 			break;
 		}
 
-		fdst->store_8(fsrc->get_8());
+		int bytes_read = fsrc->get_buffer(buffer.ptr(), buffer_size);
+		if (bytes_read <= 0) {
+			err = FAILED;
+			break;
+		}
+		fdst->store_buffer(buffer.ptr(), bytes_read);
+
+		size -= bytes_read;
 	}
 
 	if (err == OK && p_chmod_flags != -1) {
@@ -578,6 +578,7 @@ Error ProjectSettings::_load_settings_text(const String &p_path) {
 
 	VariantParser::StreamFile stream;
 	stream.f = f;
+	stream.readahead_enabled = true;
 
 	String assign;
 	Variant value;
@@ -0,0 +1,99 @@
+/*************************************************************************/
+/*  radix_sort.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "core/os/copymem.h"
+#include "core/typedefs.h"
+
+template <class T>
+struct _DefaultRadixKey {
+	_FORCE_INLINE_ uint64_t operator()(const T &p_value) const { return uint64_t(p_value); }
+};
+
+// Stable least-significant-digit radix sort on 64-bit keys, 8 bits per pass.
+// Passes in which every key shares the same digit are skipped, so keys that
+// only use their lower bits cost fewer passes. Requires a temporary buffer
+// at least as large as the array being sorted.
+template <class T, class KeyGetter = _DefaultRadixKey<T>>
+class RadixSort {
+public:
+	KeyGetter get_key;
+
+	void sort(T *p_array, T *p_temp, uint32_t p_count) const {
+		if (p_count < 2) {
+			return;
+		}
+
+		uint32_t histograms[8][256];
+		zeromem(histograms, sizeof(histograms));
+
+		for (uint32_t i = 0; i < p_count; i++) {
+			uint64_t key = get_key(p_array[i]);
+			for (uint32_t j = 0; j < 8; j++) {
+				histograms[j][(key >> (j * 8)) & 0xFF]++;
+			}
+		}
+
+		T *src = p_array;
+		T *dst = p_temp;
+
+		for (uint32_t j = 0; j < 8; j++) {
+			uint32_t *histogram = histograms[j];
+			uint32_t shift = j * 8;
+
+			if (histogram[(get_key(src[0]) >> shift) & 0xFF] == p_count) {
+				continue; // All keys share this digit, nothing to reorder.
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t k = 0; k < 256; k++) {
+				uint32_t c = histogram[k];
+				histogram[k] = offset;
+				offset += c;
+			}
+
+			for (uint32_t i = 0; i < p_count; i++) {
+				dst[histogram[(get_key(src[i]) >> shift) & 0xFF]++] = src[i];
+			}
+
+			SWAP(src, dst);
+		}
+
+		if (src != p_array) {
+			for (uint32_t i = 0; i < p_count; i++) {
+				p_array[i] = src[i];
+			}
+		}
+	}
+};
+
+#endif // RADIX_SORT_H
@@ -73,35 +73,127 @@ class ThreadWorkPool {
 
 	ThreadData *threads = nullptr;
 	uint32_t thread_count = 0;
+	uint32_t threads_working = 0;
+	BaseWork *current_work = nullptr;
+	bool current_work_owned = false;
 
 	static void _thread_function(ThreadData *p_thread);
 
+	void _begin_work(BaseWork *p_work, uint32_t p_elements, bool p_owned) {
+		index.store(0, std::memory_order_release);
+
+		p_work->index = &index;
+		p_work->max_elements = p_elements;
+
+		current_work = p_work;
+		current_work_owned = p_owned;
+
+		// No point in waking up more threads than there are elements.
+		threads_working = MIN(p_elements, thread_count);
+
+		for (uint32_t i = 0; i < threads_working; i++) {
+			threads[i].work = p_work;
+			threads[i].start.post();
+		}
+	}
+
 public:
 	template <class C, class M, class U>
-	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+	void begin_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
 		ERR_FAIL_COND(!threads); //never initialized
-
-		index.store(0);
+		ERR_FAIL_COND(current_work != nullptr);
 
 		Work<C, M, U> *w = memnew((Work<C, M, U>));
 		w->instance = p_instance;
 		w->userdata = p_userdata;
 		w->method = p_method;
-		w->index = &index;
-		w->max_elements = p_elements;
+		_begin_work(w, p_elements, true);
+	}
 
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].work = w;
-			threads[i].start.post();
-		}
-		for (uint32_t i = 0; i < thread_count; i++) {
+	bool is_working() const {
+		return current_work != nullptr;
+	}
+
+	// True once every element has been handed to a thread (some may still be running).
+	bool is_done_dispatching() const {
+		ERR_FAIL_COND_V(current_work == nullptr, true);
+		return index.load(std::memory_order_acquire) >= current_work->max_elements;
+	}
+
+	// Number of elements handed out so far, useful to report progress.
+	uint32_t get_work_index() const {
+		ERR_FAIL_COND_V(current_work == nullptr, 0);
+		uint32_t idx = index.load(std::memory_order_acquire);
+		return MIN(idx, current_work->max_elements);
+	}
+
+	void end_work() {
+		ERR_FAIL_COND(current_work == nullptr);
+		for (uint32_t i = 0; i < threads_working; i++) {
 			threads[i].completed.wait();
 			threads[i].work = nullptr;
 		}
 
-		memdelete(w);
+		threads_working = 0;
+		if (current_work_owned) {
+			memdelete(current_work);
+		}
+		current_work = nullptr;
 	}
 
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		switch (p_elements) {
+			case 0:
+				// Nothing to do, so do nothing.
+				break;
+			case 1:
+				// No value in pushing the work to another thread if it's a single job
+				// and we're going to wait for it to finish. Just run it right here.
+				(p_instance->*p_method)(0, p_userdata);
+				break;
+			default:
+				// Multiple jobs to do; commence threaded business.
+				begin_work(p_elements, p_instance, p_method, p_userdata);
+				end_work();
+		}
+	}
+
+	// Work item kept by the caller, so it can be dispatched over and over without allocating
+	// (for instance from the audio thread). Only the semaphores are posted for each dispatch.
+	template <class C, class M, class U>
+	class PreparedWork {
+		friend class ThreadWorkPool;
+		Work<C, M, U> work;
+
+	public:
+		PreparedWork(C *p_instance, M p_method) {
+			work.instance = p_instance;
+			work.method = p_method;
+		}
+	};
+
+	template <class C, class M, class U>
+	void do_work(PreparedWork<C, M, U> &p_work, uint32_t p_elements, U p_userdata) {
+		switch (p_elements) {
+			case 0:
+				break;
+			case 1:
+				(p_work.work.instance->*p_work.work.method)(0, p_userdata);
+				break;
+			default:
+				ERR_FAIL_COND(!threads); //never initialized
+				ERR_FAIL_COND(current_work != nullptr);
+
+				p_work.work.userdata = p_userdata;
+				_begin_work(&p_work.work, p_elements, false);
+				end_work();
+		}
+	}
+
+	_FORCE_INLINE_ int get_thread_count() const { return thread_count; }
+	_FORCE_INLINE_ bool is_initialized() const { return threads != nullptr; }
+
 	void init(int p_thread_count = -1);
 	void finish();
 	~ThreadWorkPool();
@@ -33,41 +33,57 @@
 #include "core/input/input_event.h"
 #include "core/io/resource_loader.h"
 #include "core/os/keyboard.h"
+#include "core/local_vector.h"
 #include "core/string_buffer.h"
 
-CharType VariantParser::StreamFile::get_char() {
-	return f->get_8();
+CharType VariantParser::Stream::_read_ahead() {
+	readahead_filled = _read_buffer(readahead_buffer, readahead_enabled ? READAHEAD_SIZE : 1);
+	if (readahead_filled == 0) {
+		// Keep returning 0 once the end is reached, like FileAccess does.
+		readahead_pointer = 0;
+		eof = true;
+		return 0;
+	}
+
+	readahead_pointer = 1;
+	return readahead_buffer[0];
 }
 
-bool VariantParser::StreamFile::is_utf8() const {
-	return true;
+uint32_t VariantParser::StreamFile::_read_buffer(CharType *p_buffer, uint32_t p_num_chars) {
+	uint8_t temp[2048];
+	uint32_t to_read = MIN(p_num_chars, (uint32_t)sizeof(temp));
+	int read = f->get_buffer(temp, to_read);
+	if (read <= 0) {
+		return 0;
+	}
+
+	// Bytes are widened as is, strings are decoded as UTF-8 by the tokenizer.
+	for (int i = 0; i < read; i++) {
+		p_buffer[i] = temp[i];
+	}
+	return read;
 }
 
-bool VariantParser::StreamFile::is_eof() const {
-	return f->eof_reached();
+bool VariantParser::StreamFile::is_utf8() const {
+	return true;
 }
 
-CharType VariantParser::StreamString::get_char() {
-	if (pos > s.length()) {
-		return 0;
-	} else if (pos == s.length()) {
-		// You need to try to read again when you have reached the end for EOF to be reported,
-		// so this works the same as files (like StreamFile does)
-		pos++;
+uint32_t VariantParser::StreamString::_read_buffer(CharType *p_buffer, uint32_t p_num_chars) {
+	int available = s.length() - pos;
+	if (available <= 0) {
 		return 0;
-	} else {
-		return s[pos++];
 	}
+
+	uint32_t to_read = MIN(p_num_chars, (uint32_t)available);
+	memcpy(p_buffer, s.ptr() + pos, to_read * sizeof(CharType));
+	pos += to_read;
+	return to_read;
 }
 
 bool VariantParser::StreamString::is_utf8() const {
 	return false;
 }
 
-bool VariantParser::StreamString::is_eof() const {
-	return pos > s.length();
-}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 const char *VariantParser::tk_name[TK_MAX] = {
@@ -202,7 +218,12 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 				[[fallthrough]];
 			}
 			case '"': {
-				String str;
+				// Characters are collected in a buffer and converted once. UTF-8
+				// streams deliver raw bytes, which are decoded at the end.
+				const bool utf8 = p_stream->is_utf8();
+				StringBuffer<> str;
+				LocalVector<char> utf8_str;
+
 				while (true) {
 					CharType ch = p_stream->get_char();
 
@@ -276,26 +297,45 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 							} break;
 						}
 
-						str += res;
+						if (!utf8) {
+							str += res;
+						} else if (res < 0x80) {
+							utf8_str.push_back(res);
+						} else {
+							CharString encoded = String::chr(res).utf8();
+							for (int i = 0; i < encoded.length(); i++) {
+								utf8_str.push_back(encoded[i]);
+							}
+						}
 
 					} else {
 						if (ch == '\n') {
 							line++;
 						}
-						str += ch;
+						if (utf8) {
+							utf8_str.push_back(ch);
+						} else {
+							str += ch;
+						}
 					}
 				}
 
-				if (p_stream->is_utf8()) {
-					str.parse_utf8(str.ascii(true).get_data());
+				String result;
+				if (utf8) {
+					if (utf8_str.size()) {
+						result.parse_utf8(utf8_str.ptr(), utf8_str.size());
+					}
+				} else {
+					result = str.as_string();
 				}
+
 				if (string_name) {
 					r_token.type = TK_STRING_NAME;
-					r_token.value = StringName(str);
+					r_token.value = StringName(result);
 					string_name = false; //reset
 				} else {
 					r_token.type = TK_STRING;
-					r_token.value = str;
+					r_token.value = result;
 				}
 				return OK;
 
@@ -316,8 +356,10 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 #define READING_DONE 4
 					int reading = READING_INT;
 
+					bool negative = false;
 					if (cchar == '-') {
 						num += '-';
+						negative = true;
 						cchar = p_stream->get_char();
 					}
 
@@ -326,11 +368,22 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 					bool exp_beg = false;
 					bool is_float = false;
 
+					// Digits are also accumulated here, so most numbers don't need to be
+					// parsed again from the buffer.
+					uint64_t mantissa = 0;
+					int mantissa_digits = 0;
+					int frac_digits = 0;
+					int exponent = 0;
+					bool exp_negative = false;
+
 					while (true) {
 						switch (reading) {
 							case READING_INT: {
 								if (c >= '0' && c <= '9') {
-									//pass
+									if (mantissa || c != '0') {
+										mantissa_digits++;
+									}
+									mantissa = mantissa * 10 + (c - '0');
 								} else if (c == '.') {
 									reading = READING_DEC;
 									is_float = true;
@@ -344,6 +397,11 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 							} break;
 							case READING_DEC: {
 								if (c >= '0' && c <= '9') {
+									if (mantissa || c != '0') {
+										mantissa_digits++;
+									}
+									mantissa = mantissa * 10 + (c - '0');
+									frac_digits++;
 								} else if (c == 'e') {
 									reading = READING_EXP;
 								} else {
@@ -354,9 +412,13 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 							case READING_EXP: {
 								if (c >= '0' && c <= '9') {
 									exp_beg = true;
+									if (exponent < 10000) {
+										exponent = exponent * 10 + (c - '0');
+									}
 
 								} else if ((c == '-' || c == '+') && !exp_sign && !exp_beg) {
 									exp_sign = true;
+									exp_negative = c == '-';
 
 								} else {
 									reading = READING_DONE;
@@ -376,7 +438,20 @@ Error VariantParser::get_token(Stream *p_stream, Token &r_token, int &line, Stri
 					r_token.type = TK_NUMBER;
 
 					if (is_float) {
-						r_token.value = num.as_double();
+						// Exact when both the mantissa and the power of ten are exactly representable.
+						static const double pow10[] = {
+							1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+							1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+						};
+						int exp10 = (exp_negative ? -exponent : exponent) - frac_digits;
+						if (mantissa_digits <= 15 && exp10 >= -22 && exp10 <= 22) {
+							double value = exp10 < 0 ? double(mantissa) / pow10[-exp10] : double(mantissa) * pow10[exp10];
+							r_token.value = negative ? -value : value;
+						} else {
+							r_token.value = num.as_double();
+						}
+					} else if (mantissa_digits <= 18) {
+						r_token.value = negative ? -int64_t(mantissa) : int64_t(mantissa);
 					} else {
 						r_token.value = num.as_int();
 					}
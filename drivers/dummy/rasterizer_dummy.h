@@ -175,6 +175,7 @@ public:
 	virtual TypedArray<Image> bake_render_uv2(RID p_base, const Vector<RID> &p_material_overrides, const Size2i &p_image_size) { return TypedArray<Image>(); }
 
 	bool free(RID p_rid) { return true; }
+	void instance_free_render_data(InstanceBase *p_instance) {}
 	virtual void update() {}
 	virtual void sdfgi_set_debug_probe_select(const Vector3 &p_position, const Vector3 &p_dir) {}
 
@@ -384,6 +385,7 @@ public:
 	bool material_casts_shadows(RID p_material) { return false; }
 	virtual void material_get_instance_shader_parameters(RID p_material, List<InstanceShaderParam> *r_parameters) {}
 	void material_update_dependency(RID p_material, RasterizerScene::InstanceBase *p_instance) {}
+	void material_get_textures(RID p_material, List<RID> *r_textures) {}
 
 	/* MESH API */
 
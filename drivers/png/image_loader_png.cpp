@@ -57,6 +57,14 @@ void ImageLoaderPNG::get_recognized_extensions(List<String> *p_extensions) const
 	p_extensions->push_back("png");
 }
 
+Error ImageLoaderPNG::get_buffer_info(const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) const {
+	return PNGDriverCommon::png_get_info(p_buffer, p_size, r_size, r_format);
+}
+
+Error ImageLoaderPNG::decode_buffer(const uint8_t *p_buffer, int p_size, int p_reduce, uint8_t *p_dst) const {
+	return PNGDriverCommon::png_to_buffer(p_buffer, p_size, false, p_reduce, p_dst);
+}
+
 Ref<Image> ImageLoaderPNG::load_mem_png(const uint8_t *p_png, int p_size) {
 	Ref<Image> img;
 	img.instance();
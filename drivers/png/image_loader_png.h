@@ -42,6 +42,9 @@ private:
 public:
 	virtual Error load_image(Ref<Image> p_image, FileAccess *f, bool p_force_linear, float p_scale);
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
+	virtual bool can_decode_buffer() const { return true; }
+	virtual Error get_buffer_info(const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) const;
+	virtual Error decode_buffer(const uint8_t *p_buffer, int p_size, int p_reduce, uint8_t *p_dst) const;
 	ImageLoaderPNG();
 };
 
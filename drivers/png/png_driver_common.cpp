@@ -30,6 +30,7 @@
 
 #include "png_driver_common.h"
 
+#include "core/io/image_loader.h"
 #include "core/os/os.h"
 
 #include <png.h>
@@ -58,14 +59,13 @@ static bool check_error(const png_image &image) {
 	return false;
 }
 
-Error png_to_image(const uint8_t *p_source, size_t p_size, bool p_force_linear, Ref<Image> p_image) {
-	png_image png_img;
-	zeromem(&png_img, sizeof(png_img));
-	png_img.version = PNG_IMAGE_VERSION;
+static Error _begin_read(png_image &r_png_img, const uint8_t *p_source, size_t p_size, Image::Format &r_format) {
+	zeromem(&r_png_img, sizeof(r_png_img));
+	r_png_img.version = PNG_IMAGE_VERSION;
 
 	// fetch image properties
-	int success = png_image_begin_read_from_memory(&png_img, p_source, p_size);
-	ERR_FAIL_COND_V_MSG(check_error(png_img), ERR_FILE_CORRUPT, png_img.message);
+	int success = png_image_begin_read_from_memory(&r_png_img, p_source, p_size);
+	ERR_FAIL_COND_V_MSG(check_error(r_png_img), ERR_FILE_CORRUPT, r_png_img.message);
 	ERR_FAIL_COND_V(!success, ERR_FILE_CORRUPT);
 
 	// flags to be masked out of input format to give target format
@@ -77,47 +77,112 @@ Error png_to_image(const uint8_t *p_source, size_t p_size, bool p_force_linear,
 			// convert indexed image to direct color
 			| PNG_FORMAT_FLAG_COLORMAP);
 
-	png_img.format &= format_mask;
+	r_png_img.format &= format_mask;
 
-	Image::Format dest_format;
-	switch (png_img.format) {
+	switch (r_png_img.format) {
 		case PNG_FORMAT_GRAY:
-			dest_format = Image::FORMAT_L8;
+			r_format = Image::FORMAT_L8;
 			break;
 		case PNG_FORMAT_GA:
-			dest_format = Image::FORMAT_LA8;
+			r_format = Image::FORMAT_LA8;
 			break;
 		case PNG_FORMAT_RGB:
-			dest_format = Image::FORMAT_RGB8;
+			r_format = Image::FORMAT_RGB8;
 			break;
 		case PNG_FORMAT_RGBA:
-			dest_format = Image::FORMAT_RGBA8;
+			r_format = Image::FORMAT_RGBA8;
 			break;
 		default:
-			png_image_free(&png_img); // only required when we return before finish_read
+			png_image_free(&r_png_img); // only required when we return before finish_read
 			ERR_PRINT("Unsupported png format.");
 			return ERR_UNAVAILABLE;
 	}
 
+	return OK;
+}
+
+static Error _finish_read(png_image &p_png_img, bool p_force_linear, int p_reduce, uint8_t *p_dst) {
 	if (!p_force_linear) {
 		// assume 16 bit pngs without sRGB or gAMA chunks are in sRGB format
-		png_img.flags |= PNG_IMAGE_FLAG_16BIT_sRGB;
+		p_png_img.flags |= PNG_IMAGE_FLAG_16BIT_sRGB;
+	}
+
+	const png_uint_32 stride = PNG_IMAGE_ROW_STRIDE(p_png_img);
+
+	if (p_reduce == 0) {
+		// read image data to buffer and release libpng resources
+		int success = png_image_finish_read(&p_png_img, nullptr, p_dst, stride, nullptr);
+		ERR_FAIL_COND_V_MSG(check_error(p_png_img), ERR_FILE_CORRUPT, p_png_img.message);
+		ERR_FAIL_COND_V(!success, ERR_FILE_CORRUPT);
+		return OK;
 	}
 
-	const png_uint_32 stride = PNG_IMAGE_ROW_STRIDE(png_img);
+	// The simplified API only reads whole images, so the full size one is reduced afterwards.
 	Vector<uint8_t> buffer;
-	Error err = buffer.resize(PNG_IMAGE_BUFFER_SIZE(png_img, stride));
+	Error err = buffer.resize(PNG_IMAGE_BUFFER_SIZE(p_png_img, stride));
 	if (err) {
-		png_image_free(&png_img); // only required when we return before finish_read
+		png_image_free(&p_png_img); // only required when we return before finish_read
 		return err;
 	}
-	uint8_t *writer = buffer.ptrw();
 
-	// read image data to buffer and release libpng resources
-	success = png_image_finish_read(&png_img, nullptr, writer, stride, nullptr);
-	ERR_FAIL_COND_V_MSG(check_error(png_img), ERR_FILE_CORRUPT, png_img.message);
+	int success = png_image_finish_read(&p_png_img, nullptr, buffer.ptrw(), stride, nullptr);
+	ERR_FAIL_COND_V_MSG(check_error(p_png_img), ERR_FILE_CORRUPT, p_png_img.message);
 	ERR_FAIL_COND_V(!success, ERR_FILE_CORRUPT);
 
+	const int channels = PNG_IMAGE_PIXEL_CHANNELS(p_png_img.format);
+	ImageRowReducer reducer;
+	reducer.init(p_png_img.width, p_png_img.height, channels, p_reduce, p_dst);
+	const uint8_t *reader = buffer.ptr();
+	for (png_uint_32 y = 0; y < p_png_img.height; y++) {
+		reducer.push_row(&reader[y * stride], channels);
+	}
+
+	return OK;
+}
+
+Error png_get_info(const uint8_t *p_source, size_t p_size, Size2i &r_size, Image::Format &r_format) {
+	png_image png_img;
+	Error err = _begin_read(png_img, p_source, p_size, r_format);
+	if (err) {
+		return err;
+	}
+
+	r_size = Size2i(png_img.width, png_img.height);
+	png_image_free(&png_img);
+	return OK;
+}
+
+Error png_to_buffer(const uint8_t *p_source, size_t p_size, bool p_force_linear, int p_reduce, uint8_t *p_dst) {
+	png_image png_img;
+	Image::Format format;
+	Error err = _begin_read(png_img, p_source, p_size, format);
+	if (err) {
+		return err;
+	}
+
+	return _finish_read(png_img, p_force_linear, p_reduce, p_dst);
+}
+
+Error png_to_image(const uint8_t *p_source, size_t p_size, bool p_force_linear, Ref<Image> p_image) {
+	png_image png_img;
+	Image::Format dest_format;
+	Error err = _begin_read(png_img, p_source, p_size, dest_format);
+	if (err) {
+		return err;
+	}
+
+	Vector<uint8_t> buffer;
+	err = buffer.resize(Image::get_image_data_size(png_img.width, png_img.height, dest_format));
+	if (err) {
+		png_image_free(&png_img); // only required when we return before finish_read
+		return err;
+	}
+
+	err = _finish_read(png_img, p_force_linear, 0, buffer.ptrw());
+	if (err) {
+		return err;
+	}
+
 	//print_line("png width: "+itos(png_img.width)+" height: "+itos(png_img.height));
 	p_image->create(png_img.width, png_img.height, false, dest_format, buffer);
 
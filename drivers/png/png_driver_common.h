@@ -38,6 +38,13 @@ namespace PNGDriverCommon {
 // Attempt to load png from buffer (p_source, p_size) into p_image
 Error png_to_image(const uint8_t *p_source, size_t p_size, bool p_force_linear, Ref<Image> p_image);
 
+// Read the size and format of the png in buffer (p_source, p_size), without decoding it
+Error png_get_info(const uint8_t *p_source, size_t p_size, Size2i &r_size, Image::Format &r_format);
+
+// Decode the png in buffer (p_source, p_size) into p_dst, halved p_reduce times
+// (see ImageRowReducer). Safe to call from several threads at once.
+Error png_to_buffer(const uint8_t *p_source, size_t p_size, bool p_force_linear, int p_reduce, uint8_t *p_dst);
+
 // Append p_image, as a png, to p_buffer.
 // Contents of p_buffer is unspecified if error returned.
 Error image_to_png(const Ref<Image> &p_image, Vector<uint8_t> &p_buffer);
@@ -30,6 +30,8 @@
 
 #include "audio_stream_preview.h"
 
+#include "servers/audio/audio_decode_ahead.h"
+
 /////////////////////
 
 float AudioStreamPreview::get_length() const {
@@ -113,6 +115,12 @@ void AudioStreamPreviewGenerator::_preview_thread(void *p_preview) {
 	int frames_total = AudioServer::get_singleton()->get_mix_rate() * preview->preview->length;
 	int frames_todo = frames_total;
 
+	// Mixed much faster than real time, decoding ahead on other threads wouldn't keep up.
+	Ref<AudioStreamPlaybackDecodeAhead> decode_ahead = preview->playback;
+	if (decode_ahead.is_valid()) {
+		decode_ahead->set_synchronous(true);
+	}
+
 	preview->playback->start();
 
 	while (frames_todo) {
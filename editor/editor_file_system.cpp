@@ -33,6 +33,7 @@
 #include "core/io/resource_importer.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
+#include "core/local_vector.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
@@ -284,14 +285,12 @@ void EditorFileSystem::_scan_filesystem() {
 	new_filesystem = memnew(EditorFileSystemDirectory);
 	new_filesystem->parent = nullptr;
 
-	DirAccess *d = DirAccess::create(DirAccess::ACCESS_RESOURCES);
-	d->change_dir("res://");
-	_scan_new_dir(new_filesystem, d, sp);
+	ScanDirListing *listing = _list_dir_tree("res://");
+	_scan_new_dir(new_filesystem, listing, sp);
+	memdelete(listing);
 
 	file_cache.clear(); //clear caches, no longer needed
 
-	memdelete(d);
-
 	if (!first_scan) {
 		//on the first scan this is done from the main thread after re-importing
 		_save_filesystem_cache();
@@ -342,6 +341,7 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 
 	VariantParser::StreamFile stream;
 	stream.f = f;
+	stream.readahead_enabled = true;
 
 	String assign;
 	Variant value;
@@ -403,6 +403,7 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 
 	VariantParser::StreamFile md5_stream;
 	md5_stream.f = md5s;
+	md5_stream.readahead_enabled = true;
 
 	while (true) {
 		assign = Variant();
@@ -463,6 +464,10 @@ bool EditorFileSystem::_test_for_reimport(const String &p_path, bool p_only_impo
 	return false; //nothing changed
 }
 
+void EditorFileSystem::_test_for_reimport_thread(uint32_t p_index, TestReimportData *p_data) {
+	p_data[p_index].reimport = _test_for_reimport(p_data[p_index].path, false);
+}
+
 bool EditorFileSystem::_update_scan_actions() {
 	sources_changed.clear();
 
@@ -471,6 +476,20 @@ bool EditorFileSystem::_update_scan_actions() {
 	Vector<String> reimports;
 	Vector<String> reloads;
 
+	// Comparing the md5 of every candidate is the slow part here, do it in parallel up front.
+	LocalVector<TestReimportData> test_reimports;
+	for (List<ItemAction>::Element *E = scan_actions.front(); E; E = E->next()) {
+		if (E->get().action == ItemAction::ACTION_FILE_TEST_REIMPORT) {
+			TestReimportData trd;
+			trd.path = E->get().dir->get_path().plus_file(E->get().file);
+			test_reimports.push_back(trd);
+		}
+	}
+
+	_do_threaded_work(test_reimports.size(), &EditorFileSystem::_test_for_reimport_thread, test_reimports.ptr());
+
+	uint32_t test_reimport_idx = 0;
+
 	for (List<ItemAction>::Element *E = scan_actions.front(); E; E = E->next()) {
 		ItemAction &ia = E->get();
 
@@ -527,10 +546,11 @@ bool EditorFileSystem::_update_scan_actions() {
 
 			} break;
 			case ItemAction::ACTION_FILE_TEST_REIMPORT: {
+				bool must_reimport = test_reimports[test_reimport_idx++].reimport;
 				int idx = ia.dir->find_file_index(ia.file);
 				ERR_CONTINUE(idx == -1);
 				String full_path = ia.dir->get_file_path(idx);
-				if (_test_for_reimport(full_path, false)) {
+				if (must_reimport) {
 					//must reimport
 					reimports.push_back(full_path);
 					reimports.append_array(_get_dependencies(full_path));
@@ -628,13 +648,21 @@ EditorFileSystem::ScanProgress EditorFileSystem::ScanProgress::get_sub(int p_cur
 	return sp;
 }
 
-void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess *da, const ScanProgress &p_progress) {
-	List<String> dirs;
-	List<String> files;
+void EditorFileSystem::_list_dir_thread(uint32_t p_index, ScanDirListing **p_listings) {
+	// Runs on the scan thread pool, each listing is only touched by its own thread.
+	ScanDirListing *listing = p_listings[p_index];
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_RESOURCES);
+	if (da->change_dir(listing->path) != OK) {
+		ERR_PRINT("Cannot go into subdir '" + listing->path + "'.");
+		return;
+	}
 
 	String cd = da->get_current_dir();
+	listing->path = cd;
+	listing->modified_time = FileAccess::get_modified_time(cd);
 
-	p_dir->modified_time = FileAccess::get_modified_time(cd);
+	List<String> dirs;
 
 	da->list_dir_begin();
 	while (true) {
@@ -662,55 +690,93 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 			dirs.push_back(f);
 
 		} else {
-			files.push_back(f);
+			listing->files.push_back(f);
 		}
 	}
 
 	da->list_dir_end();
 
 	dirs.sort_custom<NaturalNoCaseComparator>();
-	files.sort_custom<NaturalNoCaseComparator>();
+	listing->files.sort_custom<NaturalNoCaseComparator>();
 
-	int total = dirs.size() + files.size();
-	int idx = 0;
-
-	for (List<String>::Element *E = dirs.front(); E; E = E->next(), idx++) {
+	for (List<String>::Element *E = dirs.front(); E; E = E->next()) {
 		if (da->change_dir(E->get()) == OK) {
 			String d = da->get_current_dir();
 
-			if (d == cd || !d.begins_with(cd)) {
-				da->change_dir(cd); //avoid recursion
-			} else {
-				EditorFileSystemDirectory *efd = memnew(EditorFileSystemDirectory);
+			if (d != cd && d.begins_with(cd)) { //avoid recursion
+				ScanDirListing *subdir = memnew(ScanDirListing);
+				subdir->path = d;
+				subdir->name = E->get();
+				listing->subdirs.push_back(subdir);
+			}
 
-				efd->parent = p_dir;
-				efd->name = E->get();
+			da->change_dir(cd);
+		} else {
+			ERR_PRINT("Cannot go into subdir '" + E->get() + "'.");
+		}
+	}
+}
 
-				_scan_new_dir(efd, da, p_progress.get_sub(idx, total));
+EditorFileSystem::ScanDirListing *EditorFileSystem::_list_dir_tree(const String &p_path) {
+	ScanDirListing *root = memnew(ScanDirListing);
+	root->path = p_path;
 
-				int idx2 = 0;
-				for (int i = 0; i < p_dir->subdirs.size(); i++) {
-					if (efd->name < p_dir->subdirs[i]->name) {
-						break;
-					}
-					idx2++;
-				}
-				if (idx2 == p_dir->subdirs.size()) {
-					p_dir->subdirs.push_back(efd);
-				} else {
-					p_dir->subdirs.insert(idx2, efd);
-				}
+	// Each level of the tree is listed in parallel, the subdirectories found make up the next one.
+	LocalVector<ScanDirListing *> level;
+	level.push_back(root);
+	while (level.size()) {
+		_do_threaded_work(level.size(), &EditorFileSystem::_list_dir_thread, level.ptr());
 
-				da->change_dir("..");
+		LocalVector<ScanDirListing *> next_level;
+		for (uint32_t i = 0; i < level.size(); i++) {
+			for (uint32_t j = 0; j < level[i]->subdirs.size(); j++) {
+				next_level.push_back(level[i]->subdirs[j]);
 			}
+		}
+		level = next_level;
+	}
+
+	return root;
+}
+
+void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, const ScanDirListing *p_listing, const ScanProgress &p_progress) {
+	const String &cd = p_listing->path;
+	const List<String> &files = p_listing->files;
+
+	p_dir->modified_time = p_listing->modified_time;
+
+	int total = p_listing->subdirs.size() + files.size();
+	int idx = 0;
+
+	for (uint32_t i = 0; i < p_listing->subdirs.size(); i++, idx++) {
+		EditorFileSystemDirectory *efd = memnew(EditorFileSystemDirectory);
+
+		efd->parent = p_dir;
+		efd->name = p_listing->subdirs[i]->name;
+
+		_scan_new_dir(efd, p_listing->subdirs[i], p_progress.get_sub(idx, total));
+
+		int idx2 = 0;
+		for (int j = 0; j < p_dir->subdirs.size(); j++) {
+			if (efd->name < p_dir->subdirs[j]->name) {
+				break;
+			}
+			idx2++;
+		}
+		if (idx2 == p_dir->subdirs.size()) {
+			p_dir->subdirs.push_back(efd);
 		} else {
-			ERR_PRINT("Cannot go into subdir '" + E->get() + "'.");
+			p_dir->subdirs.insert(idx2, efd);
 		}
 
 		p_progress.update(idx, total);
 	}
 
-	for (List<String>::Element *E = files.front(); E; E = E->next(), idx++) {
+	// Gather the files first, so the disk checks for all of them can run in parallel.
+	LocalVector<ScanFileData> scan_files;
+	LocalVector<EditorFileSystemDirectory::FileInfo *> file_infos;
+
+	for (const List<String>::Element *E = files.front(); E; E = E->next()) {
 		String ext = E->get().get_extension().to_lower();
 		if (!valid_extensions.has(ext)) {
 			continue; //invalid
@@ -719,19 +785,26 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 		EditorFileSystemDirectory::FileInfo *fi = memnew(EditorFileSystemDirectory::FileInfo);
 		fi->file = E->get();
 
-		String path = cd.plus_file(fi->file);
+		ScanFileData sf;
+		sf.path = cd.plus_file(fi->file);
+		sf.imported = import_extensions.has(ext);
+		sf.cache = file_cache.getptr(sf.path);
 
-		FileCache *fc = file_cache.getptr(path);
-		uint64_t mt = FileAccess::get_modified_time(path);
+		scan_files.push_back(sf);
+		file_infos.push_back(fi);
+	}
 
-		if (import_extensions.has(ext)) {
-			//is imported
-			uint64_t import_mt = 0;
-			if (FileAccess::exists(path + ".import")) {
-				import_mt = FileAccess::get_modified_time(path + ".import");
-			}
+	_do_threaded_work(scan_files.size(), &EditorFileSystem::_scan_new_file_thread, scan_files.ptr());
 
-			if (fc && fc->modification_time == mt && fc->import_modification_time == import_mt && !_test_for_reimport(path, true)) {
+	for (uint32_t i = 0; i < scan_files.size(); i++, idx++) {
+		EditorFileSystemDirectory::FileInfo *fi = file_infos[i];
+		const ScanFileData &sf = scan_files[i];
+		const String &path = sf.path;
+		const FileCache *fc = sf.cache;
+
+		if (sf.imported) {
+			//is imported
+			if (sf.up_to_date) {
 				fi->type = fc->type;
 				fi->deps = fc->deps;
 				fi->modified_time = fc->modification_time;
@@ -743,11 +816,11 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				fi->script_class_extends = fc->script_class_extends;
 				fi->script_class_icon_path = fc->script_class_icon_path;
 
-				if (revalidate_import_files && !ResourceFormatImporter::get_singleton()->are_import_settings_valid(path)) {
+				if (!sf.settings_valid) {
 					ItemAction ia;
 					ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
 					ia.dir = p_dir;
-					ia.file = E->get();
+					ia.file = fi->file;
 					scan_actions.push_back(ia);
 				}
 
@@ -769,11 +842,11 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				ItemAction ia;
 				ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
 				ia.dir = p_dir;
-				ia.file = E->get();
+				ia.file = fi->file;
 				scan_actions.push_back(ia);
 			}
 		} else {
-			if (fc && fc->modification_time == mt) {
+			if (sf.up_to_date) {
 				//not imported, so just update type if changed
 				fi->type = fc->type;
 				fi->modified_time = fc->modification_time;
@@ -788,7 +861,7 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 				fi->type = ResourceLoader::get_resource_type(path);
 				fi->script_class_name = _get_global_script_class(fi->type, path, &fi->script_class_extends, &fi->script_class_icon_path);
 				fi->deps = _get_dependencies(path);
-				fi->modified_time = mt;
+				fi->modified_time = sf.modified_time;
 				fi->import_modified_time = 0;
 				fi->import_valid = true;
 			}
@@ -799,6 +872,44 @@ void EditorFileSystem::_scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess
 	}
 }
 
+void EditorFileSystem::_scan_new_file_thread(uint32_t p_index, ScanFileData *p_data) {
+	// Runs on the scan thread pool, so only disk access and read-only lookups are allowed here.
+	ScanFileData &sf = p_data[p_index];
+	const FileCache *fc = sf.cache;
+
+	sf.modified_time = FileAccess::get_modified_time(sf.path);
+
+	if (sf.imported) {
+		if (FileAccess::exists(sf.path + ".import")) {
+			sf.import_modified_time = FileAccess::get_modified_time(sf.path + ".import");
+		}
+
+		sf.up_to_date = fc && fc->modification_time == sf.modified_time && fc->import_modification_time == sf.import_modified_time && !_test_for_reimport(sf.path, true);
+
+		if (sf.up_to_date && revalidate_import_files) {
+			sf.settings_valid = ResourceFormatImporter::get_singleton()->are_import_settings_valid(sf.path);
+		}
+	} else {
+		sf.up_to_date = fc && fc->modification_time == sf.modified_time;
+	}
+}
+
+void EditorFileSystem::_scan_changed_file_thread(uint32_t p_index, ScanFileData *p_data) {
+	// Runs on the scan thread pool, so only disk access and read-only lookups are allowed here.
+	ScanFileData &sf = p_data[p_index];
+
+	sf.modified_time = FileAccess::get_modified_time(sf.path);
+
+	if (sf.modified_time != sf.info->modified_time) {
+		sf.up_to_date = false; //it was modified, must be reimported.
+	} else if (!FileAccess::exists(sf.path + ".import")) {
+		sf.up_to_date = false; //no .import file, obviously reimport
+	} else {
+		sf.import_modified_time = FileAccess::get_modified_time(sf.path + ".import");
+		sf.up_to_date = sf.import_modified_time == sf.info->import_modified_time && !_test_for_reimport(sf.path, true);
+	}
+}
+
 void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const ScanProgress &p_progress) {
 	uint64_t current_mtime = FileAccess::get_modified_time(p_dir->get_path());
 
@@ -854,10 +965,9 @@ void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const
 
 					efd->parent = p_dir;
 					efd->name = f;
-					DirAccess *d = DirAccess::create(DirAccess::ACCESS_RESOURCES);
-					d->change_dir(cd.plus_file(f));
-					_scan_new_dir(efd, d, p_progress.get_sub(1, 1));
-					memdelete(d);
+					ScanDirListing *listing = _list_dir_tree(cd.plus_file(f));
+					_scan_new_dir(efd, listing, p_progress.get_sub(1, 1));
+					memdelete(listing);
 
 					ItemAction ia;
 					ia.action = ItemAction::ACTION_DIR_ADD;
@@ -918,6 +1028,27 @@ void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const
 		memdelete(da);
 	}
 
+	// Check imported files in parallel first, the rest is cheap enough to do in order.
+	LocalVector<ScanFileData> scan_files;
+	LocalVector<int> scan_file_indices;
+
+	for (int i = 0; i < p_dir->files.size(); i++) {
+		if (updated_dir && !p_dir->files[i]->verified) {
+			continue;
+		}
+		if (import_extensions.has(p_dir->files[i]->file.get_extension().to_lower())) {
+			ScanFileData sf;
+			sf.path = cd.plus_file(p_dir->files[i]->file);
+			sf.imported = true;
+			sf.info = p_dir->files[i];
+			scan_files.push_back(sf);
+			scan_file_indices.push_back(i);
+		}
+	}
+
+	_do_threaded_work(scan_files.size(), &EditorFileSystem::_scan_changed_file_thread, scan_files.ptr());
+
+	uint32_t scanned = 0;
 	for (int i = 0; i < p_dir->files.size(); i++) {
 		if (updated_dir && !p_dir->files[i]->verified) {
 			//this file was removed, add action to remove it
@@ -931,27 +1062,9 @@ void EditorFileSystem::_scan_fs_changes(EditorFileSystemDirectory *p_dir, const
 
 		String path = cd.plus_file(p_dir->files[i]->file);
 
-		if (import_extensions.has(p_dir->files[i]->file.get_extension().to_lower())) {
-			//check here if file must be imported or not
-
-			uint64_t mt = FileAccess::get_modified_time(path);
-
-			bool reimport = false;
-
-			if (mt != p_dir->files[i]->modified_time) {
-				reimport = true; //it was modified, must be reimported.
-			} else if (!FileAccess::exists(path + ".import")) {
-				reimport = true; //no .import file, obviously reimport
-			} else {
-				uint64_t import_mt = FileAccess::get_modified_time(path + ".import");
-				if (import_mt != p_dir->files[i]->import_modified_time) {
-					reimport = true;
-				} else if (_test_for_reimport(path, true)) {
-					reimport = true;
-				}
-			}
-
-			if (reimport) {
+		if (scanned < scan_file_indices.size() && scan_file_indices[scanned] == i) {
+			//checked above if file must be imported or not
+			if (!scan_files[scanned++].up_to_date) {
 				ItemAction ia;
 				ia.action = ItemAction::ACTION_FILE_TEST_REIMPORT;
 				ia.dir = p_dir;
@@ -1452,7 +1565,11 @@ void EditorFileSystem::update_file(const String &p_file) {
 	if (cpos == -1) {
 		//the file did not exist, it was added
 
-		late_added_files.insert(p_file); //remember that it was added. This mean it will be scanned and imported on editor restart
+		{
+			MutexLock lock(import_mutex);
+			late_added_files.insert(p_file); //remember that it was added. This mean it will be scanned and imported on editor restart
+		}
+
 		int idx = 0;
 
 		for (int i = 0; i < fs->files.size(); i++) {
@@ -1655,6 +1772,16 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 	bool found = _find_file(p_file, &fs, cpos);
 	ERR_FAIL_COND_MSG(!found, "Can't find file '" + p_file + "'.");
 
+	String type;
+	if (_import_file_data(p_file, type)) {
+		_finish_reimport_file(p_file, type);
+	}
+}
+
+bool EditorFileSystem::_import_file_data(const String &p_file, String &r_type) {
+	// This may run from the import thread pool, anything touching the editor, the filesystem tree
+	// or the resource cache goes in _finish_reimport_file().
+
 	//try to obtain existing params
 
 	Map<StringName, Variant> params;
@@ -1679,6 +1806,7 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 		}
 
 	} else {
+		MutexLock lock(import_mutex);
 		late_added_files.insert(p_file); //imported files do not call update_file(), but just in case..
 	}
 
@@ -1695,7 +1823,7 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 		load_default = true;
 		if (importer.is_null()) {
 			ERR_PRINT("BUG: File queued for import, but can't be imported!");
-			ERR_FAIL();
+			ERR_FAIL_V(false);
 		}
 	}
 
@@ -1726,7 +1854,20 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 	List<String> import_variants;
 	List<String> gen_files;
 	Variant metadata;
-	Error err = importer->import(p_file, base_path, params, &import_variants, &gen_files, &metadata);
+
+	// Identical source data imported with identical options can be restored from the cache.
+	String cache_key;
+	if (import_cache.is_enabled() && importer->can_cache_import(params)) {
+		cache_key = EditorImportCache::get_key(p_file, importer, params);
+	}
+
+	Error err = OK;
+	bool cached = cache_key != String() && import_cache.restore(cache_key, base_path, &import_variants, &gen_files, &metadata);
+	if (cached) {
+		print_verbose("Restored import of '" + p_file + "' from the import cache.");
+	} else {
+		err = importer->import(p_file, base_path, params, &import_variants, &gen_files, &metadata);
+	}
 
 	if (err != OK) {
 		ERR_PRINT("Error importing '" + p_file + "'.");
@@ -1735,7 +1876,7 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 	//as import is complete, save the .import file
 
 	FileAccess *f = FileAccess::open(p_file + ".import", FileAccess::WRITE);
-	ERR_FAIL_COND_MSG(!f, "Cannot open file from path '" + p_file + ".import'.");
+	ERR_FAIL_COND_V_MSG(!f, false, "Cannot open file from path '" + p_file + ".import'.");
 
 	//write manually, as order matters ([remap] has to go first for performance).
 	f->store_line("[remap]");
@@ -1816,7 +1957,7 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 
 	// Store the md5's of the various files. These are stored separately so that the .import files can be version controlled.
 	FileAccess *md5s = FileAccess::open(base_path + ".md5", FileAccess::WRITE);
-	ERR_FAIL_COND_MSG(!md5s, "Cannot open MD5 file '" + base_path + ".md5'.");
+	ERR_FAIL_COND_V_MSG(!md5s, false, "Cannot open MD5 file '" + base_path + ".md5'.");
 
 	md5s->store_line("source_md5=\"" + FileAccess::get_md5(p_file) + "\"");
 	if (dest_paths.size()) {
@@ -1825,11 +1966,25 @@ void EditorFileSystem::_reimport_file(const String &p_file) {
 	md5s->close();
 	memdelete(md5s);
 
+	if (!cached && err == OK && cache_key != String()) {
+		import_cache.store(cache_key, base_path, dest_paths, import_variants, gen_files, metadata);
+	}
+
+	r_type = importer->get_resource_type();
+	return true;
+}
+
+void EditorFileSystem::_finish_reimport_file(const String &p_file, const String &p_type) {
+	EditorFileSystemDirectory *fs = nullptr;
+	int cpos = -1;
+	bool found = _find_file(p_file, &fs, cpos);
+	ERR_FAIL_COND_MSG(!found, "Can't find file '" + p_file + "'.");
+
 	//update modified times, to avoid reimport
 	fs->files[cpos]->modified_time = FileAccess::get_modified_time(p_file);
 	fs->files[cpos]->import_modified_time = FileAccess::get_modified_time(p_file + ".import");
 	fs->files[cpos]->deps = _get_dependencies(p_file);
-	fs->files[cpos]->type = importer->get_resource_type();
+	fs->files[cpos]->type = p_type;
 	fs->files[cpos]->import_valid = ResourceLoader::is_import_valid(p_file);
 
 	//if file is currently up, maybe the source it was loaded from changed, so import math must be updated for it
@@ -1864,6 +2019,75 @@ void EditorFileSystem::_find_group_files(EditorFileSystemDirectory *efd, Map<Str
 	}
 }
 
+void EditorFileSystem::_reimport_thread(uint32_t p_index, ImportThreadData *p_data) {
+	if (p_data->valid[p_index]) {
+		p_data->valid[p_index] = _import_file_data(p_data->files[p_index].path, p_data->types[p_index]);
+	}
+}
+
+void EditorFileSystem::_reimport_threaded(const Vector<ImportFile> &p_files, int p_from, int p_to, EditorProgress &r_progress) {
+	Ref<ResourceImporter> importer = ResourceFormatImporter::get_singleton()->get_importer_by_name(p_files[p_from].importer);
+	ERR_FAIL_COND(importer.is_null());
+
+	int count = p_to - p_from;
+	LocalVector<String> types;
+	LocalVector<bool> valid;
+	types.resize(count);
+	valid.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		EditorFileSystemDirectory *fs = nullptr;
+		int cpos = -1;
+		valid[i] = _find_file(p_files[p_from + i].path, &fs, cpos);
+		ERR_CONTINUE_MSG(!valid[i], "Can't find file '" + p_files[p_from + i].path + "'.");
+	}
+
+	ImportThreadData data;
+	data.files = &p_files[p_from];
+	data.types = types.ptr();
+	data.valid = valid.ptr();
+
+	// Scans are short, so wait for the pool rather than importing on a single thread. Once locked,
+	// the pool can only be busy with an import on this thread that called back here through progress.
+	bool threaded = false;
+	if (count > 1) {
+		thread_pool_mutex.lock();
+		threaded = !thread_pool.is_working();
+		if (!threaded) {
+			thread_pool_mutex.unlock();
+		}
+	}
+
+	if (!threaded) {
+		for (int i = 0; i < count; i++) {
+			r_progress.step(p_files[p_from + i].path.get_file(), p_from + i);
+			_reimport_thread(i, &data);
+		}
+	} else {
+		thread_pool.begin_work(count, this, &EditorFileSystem::_reimport_thread, &data);
+
+		int current = -1;
+		while (!thread_pool.is_done_dispatching()) {
+			int index = MIN(thread_pool.get_work_index(), uint32_t(count - 1));
+			if (index != current) {
+				current = index;
+				r_progress.step(p_files[p_from + index].path.get_file(), p_from + index);
+			}
+			OS::get_singleton()->delay_usec(1000);
+		}
+
+		thread_pool.end_work();
+		thread_pool_mutex.unlock();
+	}
+
+	// Updating the filesystem and the resources in use can only be done from here.
+	for (int i = 0; i < count; i++) {
+		if (valid[i]) {
+			_finish_reimport_file(p_files[p_from + i].path, types[i]);
+		}
+	}
+}
+
 void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 	{ //check that .import folder exists
 		DirAccess *da = DirAccess::open("res://");
@@ -1898,7 +2122,7 @@ void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 			//it's a regular file
 			ImportFile ifile;
 			ifile.path = p_files[i];
-			ifile.order = ResourceFormatImporter::get_singleton()->get_import_order(p_files[i]);
+			ResourceFormatImporter::get_singleton()->get_import_order_threads_and_importer(p_files[i], ifile.order, ifile.threaded, ifile.importer);
 			files.push_back(ifile);
 		}
 
@@ -1912,9 +2136,21 @@ void EditorFileSystem::reimport_files(const Vector<String> &p_files) {
 
 	files.sort();
 
-	for (int i = 0; i < files.size(); i++) {
-		pr.step(files[i].path.get_file(), i);
-		_reimport_file(files[i].path);
+	bool use_multiple_threads = GLOBAL_GET("editor/import/use_multiple_threads");
+
+	for (int i = 0; i < files.size();) {
+		if (use_multiple_threads && files[i].threaded) {
+			// Files are sorted by importer, so import the whole run of them at once.
+			int from = i;
+			while (i < files.size() && files[i].importer == files[from].importer) {
+				i++;
+			}
+			_reimport_threaded(files, from, i, pr);
+		} else {
+			pr.step(files[i].path.get_file(), i);
+			_reimport_file(files[i].path);
+			i++;
+		}
 	}
 
 	//reimport groups
@@ -2067,7 +2303,22 @@ EditorFileSystem::EditorFileSystem() {
 	first_scan = true;
 	scan_changes_pending = false;
 	revalidate_import_files = false;
+
+	GLOBAL_DEF("editor/import/use_multiple_threads", true);
+
+	String import_cache_path = GLOBAL_DEF("editor/import/cache_path", "");
+	ProjectSettings::get_singleton()->set_custom_property_info("editor/import/cache_path", PropertyInfo(Variant::STRING, "editor/import/cache_path", PROPERTY_HINT_GLOBAL_DIR));
+	if (import_cache_path != String()) {
+		if (import_cache_path.is_rel_path()) {
+			// Relative to the project, so a cache next to it can be shared by every checkout.
+			import_cache_path = "res://" + import_cache_path;
+		}
+		import_cache.set_cache_path(ProjectSettings::get_singleton()->globalize_path(import_cache_path).simplify_path());
+	}
+
+	thread_pool.init();
 }
 
 EditorFileSystem::~EditorFileSystem() {
+	thread_pool.finish();
 }
@@ -31,13 +31,18 @@
 #ifndef EDITOR_FILE_SYSTEM_H
 #define EDITOR_FILE_SYSTEM_H
 
+#include "core/local_vector.h"
 #include "core/os/dir_access.h"
+#include "core/os/mutex.h"
 #include "core/os/thread.h"
 #include "core/os/thread_safe.h"
 #include "core/set.h"
+#include "core/thread_work_pool.h"
+#include "editor/import/editor_import_cache.h"
 #include "scene/main/node.h"
 class FileAccess;
 
+struct EditorProgress;
 struct EditorProgressBG;
 class EditorFileSystemDirectory : public Object {
 	GDCLASS(EditorFileSystemDirectory, Object);
@@ -193,7 +198,61 @@ class EditorFileSystem : public Node {
 	Set<String> valid_extensions;
 	Set<String> import_extensions;
 
-	void _scan_new_dir(EditorFileSystemDirectory *p_dir, DirAccess *da, const ScanProgress &p_progress);
+	/* Directory listings, read in parallel one tree level at a time before scanning */
+	struct ScanDirListing {
+		String path;
+		String name;
+		uint64_t modified_time = 0;
+		List<String> files; // Sorted.
+		LocalVector<ScanDirListing *> subdirs; // Sorted, owned by the listing.
+
+		~ScanDirListing() {
+			for (uint32_t i = 0; i < subdirs.size(); i++) {
+				memdelete(subdirs[i]);
+			}
+		}
+	};
+
+	void _list_dir_thread(uint32_t p_index, ScanDirListing **p_listings);
+	ScanDirListing *_list_dir_tree(const String &p_path);
+
+	void _scan_new_dir(EditorFileSystemDirectory *p_dir, const ScanDirListing *p_listing, const ScanProgress &p_progress);
+
+	/* Per-file checks that only touch the disk, run in parallel while scanning */
+	struct ScanFileData {
+		String path;
+		bool imported = false;
+		const FileCache *cache = nullptr;
+		const EditorFileSystemDirectory::FileInfo *info = nullptr;
+		uint64_t modified_time = 0;
+		uint64_t import_modified_time = 0;
+		bool up_to_date = false;
+		bool settings_valid = true;
+	};
+
+	// Shared by scanning and importing, which can happen at once on different threads. Whoever
+	// finds it busy runs its work on its own thread rather than starting more threads.
+	ThreadWorkPool thread_pool;
+	Mutex thread_pool_mutex;
+
+	template <class M, class U>
+	void _do_threaded_work(uint32_t p_elements, M p_method, U p_userdata) {
+		if (thread_pool_mutex.try_lock() == OK) {
+			// The mutex is recursive, so also check for an import waiting on progress that called back here.
+			if (!thread_pool.is_working()) {
+				thread_pool.do_work(p_elements, this, p_method, p_userdata);
+				thread_pool_mutex.unlock();
+				return;
+			}
+			thread_pool_mutex.unlock();
+		}
+		for (uint32_t i = 0; i < p_elements; i++) {
+			(this->*p_method)(i, p_userdata);
+		}
+	}
+
+	void _scan_new_file_thread(uint32_t p_index, ScanFileData *p_data);
+	void _scan_changed_file_thread(uint32_t p_index, ScanFileData *p_data);
 
 	Thread *thread_sources;
 	bool scanning_changes;
@@ -209,6 +268,8 @@ class EditorFileSystem : public Node {
 	void _update_extensions();
 
 	void _reimport_file(const String &p_file);
+	bool _import_file_data(const String &p_file, String &r_type);
+	void _finish_reimport_file(const String &p_file, const String &p_type);
 	Error _reimport_group(const String &p_group_file, const Vector<String> &p_files);
 
 	bool _test_for_reimport(const String &p_path, bool p_only_imported_files);
@@ -219,12 +280,33 @@ class EditorFileSystem : public Node {
 
 	struct ImportFile {
 		String path;
-		int order;
+		String importer;
+		bool threaded = false;
+		int order = 0;
 		bool operator<(const ImportFile &p_if) const {
-			return order < p_if.order;
+			// Keep files sharing an importer together, so they can be imported in one threaded batch.
+			return order == p_if.order ? importer < p_if.importer : order < p_if.order;
 		}
 	};
 
+	struct ImportThreadData {
+		const ImportFile *files = nullptr;
+		String *types = nullptr;
+		bool *valid = nullptr;
+	};
+
+	Mutex import_mutex;
+	EditorImportCache import_cache;
+	void _reimport_thread(uint32_t p_index, ImportThreadData *p_data);
+	void _reimport_threaded(const Vector<ImportFile> &p_files, int p_from, int p_to, EditorProgress &r_progress);
+
+	struct TestReimportData {
+		String path;
+		bool reimport = false;
+	};
+
+	void _test_for_reimport_thread(uint32_t p_index, TestReimportData *p_data);
+
 	void _scan_script_classes(EditorFileSystemDirectory *p_dir);
 	volatile bool update_script_classes_queued;
 	void _queue_update_script_classes();
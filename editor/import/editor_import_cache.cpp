@@ -0,0 +1,194 @@
+/*************************************************************************/
+/*  editor_import_cache.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "editor_import_cache.h"
+
+#include "core/io/config_file.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/variant_parser.h"
+#include "core/version.h"
+
+#define CACHE_ENTRY_FILE "entry.cfg"
+
+String EditorImportCache::_get_entry_path(const String &p_key) const {
+	// Split entries in subdirectories, to avoid having a single directory with too many files.
+	return cache_path.plus_file(p_key.substr(0, 2)).plus_file(p_key);
+}
+
+Error EditorImportCache::_erase_dir(const String &p_path) {
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->change_dir(p_path) != OK) {
+		return ERR_FILE_NOT_FOUND;
+	}
+	Error err = da->erase_contents_recursive();
+	if (err != OK) {
+		return err;
+	}
+	return da->remove(p_path);
+}
+
+String EditorImportCache::get_key(const String &p_source_file, const Ref<ResourceImporter> &p_importer, const Map<StringName, Variant> &p_options) {
+	ERR_FAIL_COND_V(p_importer.is_null(), String());
+
+	String source_hash = FileAccess::get_sha256(p_source_file);
+	ERR_FAIL_COND_V_MSG(source_hash == String(), String(), "Can't read '" + p_source_file + "' to compute its import cache key.");
+
+	// StringName ordering is not stable between runs, so sort the option names as strings.
+	Vector<String> option_names;
+	for (const Map<StringName, Variant>::Element *E = p_options.front(); E; E = E->next()) {
+		option_names.push_back(E->key());
+	}
+	option_names.sort();
+
+	String key = "version=" + String(VERSION_FULL_CONFIG) + "\n";
+	key += "importer=" + p_importer->get_importer_name() + "\n";
+	key += "settings=" + p_importer->get_import_settings_string() + "\n";
+	key += "extension=" + p_source_file.get_extension().to_lower() + "\n";
+	key += "source=" + source_hash + "\n";
+
+	for (int i = 0; i < option_names.size(); i++) {
+		String value;
+		VariantWriter::write_to_string(p_options[option_names[i]], value);
+		key += option_names[i] + "=" + value + "\n";
+	}
+
+	return key.sha256_text();
+}
+
+bool EditorImportCache::restore(const String &p_key, const String &p_base_path, List<String> *r_platform_variants, List<String> *r_gen_files, Variant *r_metadata) const {
+	ERR_FAIL_COND_V(!is_enabled(), false);
+
+	String entry_path = _get_entry_path(p_key);
+
+	Ref<ConfigFile> cf;
+	cf.instance();
+	if (cf->load(entry_path.plus_file(CACHE_ENTRY_FILE)) != OK) {
+		return false; // Not cached yet.
+	}
+
+	Vector<String> files = cf->get_value("entry", "files", Vector<String>());
+	Vector<String> gen_files = cf->get_value("entry", "gen_files", Vector<String>());
+	Vector<String> variants = cf->get_value("entry", "platform_variants", Vector<String>());
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	for (int i = 0; i < files.size(); i++) {
+		String from = entry_path.plus_file("data" + files[i]);
+		String to = p_base_path + files[i];
+		if (da->copy(from, to) != OK) {
+			WARN_PRINT("Import cache entry '" + p_key + "' is damaged, importing again.");
+			return false;
+		}
+	}
+
+	for (int i = 0; i < variants.size(); i++) {
+		r_platform_variants->push_back(variants[i]);
+	}
+	if (r_gen_files) {
+		for (int i = 0; i < gen_files.size(); i++) {
+			r_gen_files->push_back(p_base_path + gen_files[i]);
+		}
+	}
+	if (r_metadata) {
+		*r_metadata = cf->get_value("entry", "metadata", Variant());
+	}
+
+	return true;
+}
+
+Error EditorImportCache::store(const String &p_key, const String &p_base_path, const Vector<String> &p_dest_paths, const List<String> &p_platform_variants, const List<String> &p_gen_files, const Variant &p_metadata) const {
+	ERR_FAIL_COND_V(!is_enabled(), ERR_UNCONFIGURED);
+
+	// Only files living next to the imported data can be restored for another source path.
+	Vector<String> files;
+	for (int i = 0; i < p_dest_paths.size(); i++) {
+		if (!p_dest_paths[i].begins_with(p_base_path)) {
+			return ERR_UNAVAILABLE;
+		}
+		files.push_back(p_dest_paths[i].substr(p_base_path.length()));
+	}
+
+	Vector<String> gen_files;
+	for (const List<String>::Element *E = p_gen_files.front(); E; E = E->next()) {
+		if (!E->get().begins_with(p_base_path)) {
+			return ERR_UNAVAILABLE;
+		}
+		gen_files.push_back(E->get().substr(p_base_path.length()));
+	}
+
+	String entry_path = _get_entry_path(p_key);
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->dir_exists(entry_path)) {
+		return OK; // Already cached, possibly by another editor sharing the cache.
+	}
+
+	// Write to a temporary directory and move it in place once complete,
+	// so other editors (or threads) never see half written entries.
+	String temp_path = entry_path + ".tmp" + itos(Thread::get_caller_id()) + "_" + itos(OS::get_singleton()->get_ticks_usec());
+	Error err = da->make_dir_recursive(temp_path);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Can't create import cache directory '" + temp_path + "'.");
+
+	for (int i = 0; i < files.size(); i++) {
+		err = da->copy(p_dest_paths[i], temp_path.plus_file("data" + files[i]));
+		if (err != OK) {
+			_erase_dir(temp_path);
+			ERR_FAIL_V_MSG(err, "Can't copy '" + p_dest_paths[i] + "' to the import cache.");
+		}
+	}
+
+	Vector<String> variants;
+	for (const List<String>::Element *E = p_platform_variants.front(); E; E = E->next()) {
+		variants.push_back(E->get());
+	}
+
+	Ref<ConfigFile> cf;
+	cf.instance();
+	cf->set_value("entry", "files", files);
+	cf->set_value("entry", "gen_files", gen_files);
+	cf->set_value("entry", "platform_variants", variants);
+	if (p_metadata.get_type() != Variant::NIL) {
+		cf->set_value("entry", "metadata", p_metadata);
+	}
+	err = cf->save(temp_path.plus_file(CACHE_ENTRY_FILE));
+	if (err != OK) {
+		_erase_dir(temp_path);
+		ERR_FAIL_V_MSG(err, "Can't save import cache entry '" + p_key + "'.");
+	}
+
+	if (da->rename(temp_path, entry_path) != OK) {
+		// Someone else stored the same entry meanwhile.
+		_erase_dir(temp_path);
+	}
+
+	return OK;
+}
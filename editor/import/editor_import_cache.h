@@ -0,0 +1,56 @@
+/*************************************************************************/
+/*  editor_import_cache.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef EDITOR_IMPORT_CACHE_H
+#define EDITOR_IMPORT_CACHE_H
+
+#include "core/io/resource_importer.h"
+
+// Stores the artifacts of past imports in a local directory, addressed by a hash of the
+// source file contents and the import options, so an identical import can be restored
+// into res://.import without running the importer again.
+class EditorImportCache {
+	String cache_path;
+
+	String _get_entry_path(const String &p_key) const;
+	static Error _erase_dir(const String &p_path);
+
+public:
+	void set_cache_path(const String &p_path) { cache_path = p_path; }
+	String get_cache_path() const { return cache_path; }
+	bool is_enabled() const { return cache_path != String(); }
+
+	static String get_key(const String &p_source_file, const Ref<ResourceImporter> &p_importer, const Map<StringName, Variant> &p_options);
+
+	bool restore(const String &p_key, const String &p_base_path, List<String> *r_platform_variants, List<String> *r_gen_files, Variant *r_metadata) const;
+	Error store(const String &p_key, const String &p_base_path, const Vector<String> &p_dest_paths, const List<String> &p_platform_variants, const List<String> &p_gen_files, const Variant &p_metadata) const;
+};
+
+#endif // EDITOR_IMPORT_CACHE_H
@@ -620,6 +620,11 @@ bool ResourceImporterTexture::are_import_settings_valid(const String &p_path) co
 	return valid;
 }
 
+bool ResourceImporterTexture::can_cache_import(const Map<StringName, Variant> &p_options) const {
+	// The normal map used to detect roughness is another file, which the cache can't keep track of.
+	return !p_options.has("roughness/src_normal") || String(p_options["roughness/src_normal"]) == String();
+}
+
 ResourceImporterTexture *ResourceImporterTexture::singleton = nullptr;
 
 ResourceImporterTexture::ResourceImporterTexture() {
@@ -109,6 +109,9 @@ public:
 	virtual bool are_import_settings_valid(const String &p_path) const override;
 	virtual String get_import_settings_string() const override;
 
+	virtual bool can_import_threaded() const override { return true; }
+	virtual bool can_cache_import(const Map<StringName, Variant> &p_options) const override;
+
 	ResourceImporterTexture();
 	~ResourceImporterTexture();
 };
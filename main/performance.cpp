@@ -77,6 +77,10 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RENDER_SYNC_STALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_SYNC_STALL_TIME_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_2D_BATCHES_IN_FRAME);
+	BIND_ENUM_CONSTANT(AUDIO_DECODE_UNDERRUNS);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -121,6 +125,10 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"raster/sync_stalls",
+		"raster/sync_stall_time",
+		"raster/2d_batches",
+		"audio/decode_underruns",
 
 	};
 
@@ -183,6 +191,14 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case RENDER_SYNC_STALLS_IN_FRAME:
+			return RS::get_singleton()->get_render_info(RS::INFO_SYNC_STALLS_IN_FRAME);
+		case RENDER_SYNC_STALL_TIME_IN_FRAME:
+			return RS::get_singleton()->get_render_info(RS::INFO_SYNC_STALL_TIME_IN_FRAME) / 1000000.0;
+		case RENDER_2D_BATCHES_IN_FRAME:
+			return RS::get_singleton()->get_render_info(RS::INFO_2D_BATCHES_IN_FRAME);
+		case AUDIO_DECODE_UNDERRUNS:
+			return AudioServer::get_singleton()->get_decode_underrun_count();
 
 		default: {
 		}
@@ -223,6 +239,10 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
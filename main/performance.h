@@ -92,6 +92,10 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		RENDER_SYNC_STALLS_IN_FRAME,
+		RENDER_SYNC_STALL_TIME_IN_FRAME,
+		RENDER_2D_BATCHES_IN_FRAME,
+		AUDIO_DECODE_UNDERRUNS,
 		MONITOR_MAX
 	};
 
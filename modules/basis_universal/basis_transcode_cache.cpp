@@ -0,0 +1,180 @@
+/*************************************************************************/
+/*  basis_transcode_cache.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "basis_transcode_cache.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/version.h"
+
+#define CACHE_ENTRY_MAGIC "GBTC"
+#define CACHE_ENTRY_VERSION 1
+
+String BasisTranscodeCache::_get_version_dir() const {
+	return cache_path.plus_file(String(VERSION_FULL_CONFIG) + "-" + itos(CACHE_ENTRY_VERSION));
+}
+
+String BasisTranscodeCache::get_entry_path(const String &p_key) const {
+	// Split entries in subdirectories, to avoid having a single directory with too many files.
+	return _get_version_dir().plus_file(p_key.substr(0, 2)).plus_file(p_key + ".btc");
+}
+
+String BasisTranscodeCache::get_key(const uint8_t *p_data, int p_size, int p_transcoder_format, Image::Format p_format) {
+	unsigned char hash[32];
+	ERR_FAIL_COND_V(CryptoCore::sha256(p_data, p_size, hash) != OK, String());
+
+	// The transcoder ships with the engine, so its output may change with the version.
+	String key = "version=" + String(VERSION_FULL_CONFIG) + "\n";
+	key += "transcoder_format=" + itos(p_transcoder_format) + "\n";
+	key += "format=" + itos(p_format) + "\n";
+	key += "data=" + String::hex_encode_buffer(hash, 32) + "\n";
+
+	return key.sha256_text();
+}
+
+Ref<Image> BasisTranscodeCache::load(const String &p_key) const {
+	ERR_FAIL_COND_V(!is_enabled(), Ref<Image>());
+
+	FileAccessRef f = FileAccess::open(get_entry_path(p_key), FileAccess::READ);
+	if (!f) {
+		return Ref<Image>(); // Not cached yet.
+	}
+
+	uint8_t magic[4];
+	f->get_buffer(magic, 4);
+	if (memcmp(magic, CACHE_ENTRY_MAGIC, 4) != 0 || f->get_32() != CACHE_ENTRY_VERSION) {
+		return Ref<Image>();
+	}
+
+	int width = f->get_32();
+	int height = f->get_32();
+	uint32_t format = f->get_32();
+	bool mipmaps = f->get_32() != 0;
+	int size = f->get_32();
+
+	if (width <= 0 || width > Image::MAX_WIDTH || height <= 0 || height > Image::MAX_HEIGHT || format >= Image::FORMAT_MAX || size != Image::get_image_data_size(width, height, Image::Format(format), mipmaps)) {
+		WARN_PRINT("Basis Universal transcode cache entry '" + p_key + "' is damaged, transcoding again.");
+		return Ref<Image>();
+	}
+
+	Vector<uint8_t> data;
+	data.resize(size);
+	if (f->get_buffer(data.ptrw(), size) != size) {
+		WARN_PRINT("Basis Universal transcode cache entry '" + p_key + "' is damaged, transcoding again.");
+		return Ref<Image>();
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(width, height, mipmaps, Image::Format(format), data);
+	return image;
+}
+
+Error BasisTranscodeCache::store(const String &p_key, const Ref<Image> &p_image) const {
+	ERR_FAIL_COND_V(!is_enabled(), ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V(p_image.is_null() || p_image->empty(), ERR_INVALID_PARAMETER);
+
+	String entry_path = get_entry_path(p_key);
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->file_exists(entry_path)) {
+		return OK; // Already cached, possibly by another thread.
+	}
+
+	Error err = da->make_dir_recursive(entry_path.get_base_dir());
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Can't create Basis Universal transcode cache directory '" + entry_path.get_base_dir() + "'.");
+
+	// Write to a temporary file and move it in place once complete,
+	// so other threads (or instances of the game) never read half written entries.
+	String temp_path = entry_path + ".tmp" + itos(Thread::get_caller_id()) + "_" + itos(OS::get_singleton()->get_ticks_usec());
+	FileAccess *f = FileAccess::open(temp_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Can't write Basis Universal transcode cache entry '" + temp_path + "'.");
+
+	Vector<uint8_t> data = p_image->get_data();
+
+	f->store_buffer((const uint8_t *)CACHE_ENTRY_MAGIC, 4);
+	f->store_32(CACHE_ENTRY_VERSION);
+	f->store_32(p_image->get_width());
+	f->store_32(p_image->get_height());
+	f->store_32(p_image->get_format());
+	f->store_32(p_image->has_mipmaps());
+	f->store_32(data.size());
+	f->store_buffer(data.ptr(), data.size());
+
+	err = f->get_error();
+	memdelete(f);
+	if (err != OK) {
+		da->remove(temp_path);
+		ERR_FAIL_V_MSG(err, "Can't write Basis Universal transcode cache entry '" + temp_path + "'.");
+	}
+
+	if (da->rename(temp_path, entry_path) != OK) {
+		// Someone else stored the same entry meanwhile.
+		da->remove(temp_path);
+	}
+
+	return OK;
+}
+
+void BasisTranscodeCache::prune_other_versions() const {
+	ERR_FAIL_COND(!is_enabled());
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->change_dir(cache_path) != OK) {
+		return; // Nothing cached yet.
+	}
+
+	// Entries of other versions can never be read again, and would otherwise pile up with every update.
+	const String version_dir = _get_version_dir().get_file();
+	Vector<String> stale_dirs;
+	da->list_dir_begin();
+	String name = da->get_next();
+	while (name != String()) {
+		if (da->current_is_dir() && name != "." && name != ".." && name != version_dir) {
+			stale_dirs.push_back(name);
+		}
+		name = da->get_next();
+	}
+	da->list_dir_end();
+
+	for (int i = 0; i < stale_dirs.size(); i++) {
+		String stale_path = da->get_current_dir().plus_file(stale_dirs[i]);
+		DirAccessRef stale_da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		if (stale_da->change_dir(stale_path) == OK) {
+			stale_da->erase_contents_recursive();
+		}
+		if (da->remove(stale_dirs[i]) != OK) {
+			WARN_PRINT("Can't remove stale Basis Universal transcode cache directory '" + stale_path + "'.");
+		}
+	}
+}
@@ -0,0 +1,59 @@
+/*************************************************************************/
+/*  basis_transcode_cache.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BASIS_TRANSCODE_CACHE_H
+#define BASIS_TRANSCODE_CACHE_H
+
+#include "core/image.h"
+
+// Keeps Basis Universal textures already transcoded to a GPU format in a local directory,
+// addressed by a hash of the Basis data and the target format, so they load without being
+// transcoded again on the next run. Entries are grouped by engine version, since the
+// transcoder output may change with it; prune_other_versions() removes the groups left
+// behind by other versions.
+class BasisTranscodeCache {
+	String cache_path;
+
+	String _get_version_dir() const;
+
+public:
+	void set_cache_path(const String &p_path) { cache_path = p_path; }
+	String get_cache_path() const { return cache_path; }
+	bool is_enabled() const { return cache_path != String(); }
+
+	static String get_key(const uint8_t *p_data, int p_size, int p_transcoder_format, Image::Format p_format);
+	String get_entry_path(const String &p_key) const;
+
+	Ref<Image> load(const String &p_key) const;
+	Error store(const String &p_key, const Ref<Image> &p_image) const;
+	void prune_other_versions() const;
+};
+
+#endif // BASIS_TRANSCODE_CACHE_H
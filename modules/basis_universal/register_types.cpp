@@ -30,7 +30,9 @@
 
 #include "register_types.h"
 
+#include "basis_transcode_cache.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "servers/rendering_server.h"
 #include "texture_basisu.h"
 
@@ -52,6 +54,8 @@ enum BasisDecompressFormat {
 
 basist::etc1_global_selector_codebook *sel_codebook = nullptr;
 
+static BasisTranscodeCache transcode_cache;
+
 #ifdef TOOLS_ENABLED
 static Vector<uint8_t> basis_universal_packer(const Ref<Image> &p_image, Image::UsedChannels p_channels) {
 	Vector<uint8_t> budata;
@@ -69,17 +73,6 @@ static Vector<uint8_t> basis_universal_packer(const Ref<Image> &p_image, Image::
 			image->convert(Image::FORMAT_RGBA8);
 		}
 
-		basisu::image buimg(image->get_width(), image->get_height());
-
-		{
-			Vector<uint8_t> vec = image->get_data();
-			const uint8_t *r = vec.ptr();
-
-			memcpy(buimg.get_ptr(), r, vec.size());
-		}
-
-		//image->save_png("pepeche.png");
-
 		basisu::basis_compressor_params params;
 		params.m_max_endpoint_clusters = 512;
 		params.m_max_selector_clusters = 512;
@@ -91,11 +84,11 @@ static Vector<uint8_t> basis_universal_packer(const Ref<Image> &p_image, Image::
 		//params.m_no_selector_rdo = true;
 		params.m_auto_global_sel_pal = false;
 
-		basisu::job_pool jpool(OS::get_singleton()->get_processor_count());
+		// The encoder needs its own pool, sized like the one the other compressors share.
+		basisu::job_pool jpool(MAX(Image::get_thread_count(), 1));
 		params.m_pJob_pool = &jpool;
 
 		params.m_mip_gen = false; //sorry, please some day support provided mipmaps.
-		params.m_source_images.push_back(buimg);
 
 		BasisDecompressFormat decompress_format = BASIS_DECOMPRESS_RG;
 		params.m_check_for_alpha = false;
@@ -113,6 +106,7 @@ static Vector<uint8_t> basis_universal_packer(const Ref<Image> &p_image, Image::
 			} break;
 			case Image::USED_CHANNELS_RG: {
 #ifdef USE_RG_AS_RGBA
+				params.m_force_alpha = true;
 				image->convert_rg_to_ra_rgba8();
 				decompress_format = BASIS_DECOMPRESS_RG_AS_RA;
 #else
@@ -129,6 +123,18 @@ static Vector<uint8_t> basis_universal_packer(const Ref<Image> &p_image, Image::
 			} break;
 		}
 
+		// Copied once the channels are rearranged above.
+		basisu::image buimg(image->get_width(), image->get_height());
+
+		{
+			Vector<uint8_t> vec = image->get_data();
+			const uint8_t *r = vec.ptr();
+
+			memcpy(buimg.get_ptr(), r, vec.size());
+		}
+
+		params.m_source_images.push_back(buimg);
+
 		basisu::basis_compressor c;
 		c.init(params);
 
@@ -150,6 +156,34 @@ static Vector<uint8_t> basis_universal_packer(const Ref<Image> &p_image, Image::
 }
 #endif // TOOLS_ENABLED
 
+struct BasisTranscodeJob {
+	const basist::basisu_transcoder *transcoder = nullptr;
+	const uint8_t *data = nullptr;
+	uint32_t size = 0;
+	basist::transcoder_texture_format format = basist::transcoder_texture_format::cTFTotalTextureFormats;
+	uint8_t *dst = nullptr;
+	const int *offsets = nullptr; // Of each mipmap in dst, followed by the end of the last one.
+	int unit_size = 0; // Bytes per block, or per pixel for uncompressed formats.
+	uint8_t *transcoded = nullptr; // One flag per mipmap.
+};
+
+static void _transcode_levels(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+	BasisTranscodeJob *job = (BasisTranscodeJob *)p_userdata;
+
+	// Without a state of its own, the transcoder shares one between all calls.
+	basist::basisu_transcoder_state state;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		uint32_t units = (job->offsets[i + 1] - job->offsets[i]) / job->unit_size;
+		job->transcoded[i] = job->transcoder->transcode_image_level(job->data, job->size, 0, i, job->dst + job->offsets[i], units, job->format, 0, 0, &state);
+	}
+}
+
+static bool _has_os_feature(const String &p_feature) {
+	// Without a rendering server (as when running tests), only the uncompressed formats are picked.
+	return RS::get_singleton() && RS::get_singleton()->has_os_feature(p_feature);
+}
+
 static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 	Ref<Image> image;
 
@@ -162,10 +196,10 @@ static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 
 	switch (*(uint32_t *)(ptr)) {
 		case BASIS_DECOMPRESS_RG: {
-			if (RS::get_singleton()->has_os_feature("rgtc")) {
+			if (_has_os_feature("rgtc")) {
 				format = basist::transcoder_texture_format::cTFBC5; // get this from renderer
 				imgfmt = Image::FORMAT_RGTC_RG;
-			} else if (RS::get_singleton()->has_os_feature("etc2")) {
+			} else if (_has_os_feature("etc2")) {
 				//unfortunately, basis universal does not support
 				//
 				ERR_FAIL_V(image); //unimplemented here
@@ -177,13 +211,13 @@ static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 			}
 		} break;
 		case BASIS_DECOMPRESS_RGB: {
-			if (RS::get_singleton()->has_os_feature("bptc")) {
+			if (_has_os_feature("bptc")) {
 				format = basist::transcoder_texture_format::cTFBC7_M6_OPAQUE_ONLY; // get this from renderer
 				imgfmt = Image::FORMAT_BPTC_RGBA;
-			} else if (RS::get_singleton()->has_os_feature("s3tc")) {
+			} else if (_has_os_feature("s3tc")) {
 				format = basist::transcoder_texture_format::cTFBC1; // get this from renderer
 				imgfmt = Image::FORMAT_DXT1;
-			} else if (RS::get_singleton()->has_os_feature("etc")) {
+			} else if (_has_os_feature("etc")) {
 				format = basist::transcoder_texture_format::cTFETC1; // get this from renderer
 				imgfmt = Image::FORMAT_ETC;
 			} else {
@@ -193,13 +227,13 @@ static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 
 		} break;
 		case BASIS_DECOMPRESS_RGBA: {
-			if (RS::get_singleton()->has_os_feature("bptc")) {
+			if (_has_os_feature("bptc")) {
 				format = basist::transcoder_texture_format::cTFBC7_M5; // get this from renderer
 				imgfmt = Image::FORMAT_BPTC_RGBA;
-			} else if (RS::get_singleton()->has_os_feature("s3tc")) {
+			} else if (_has_os_feature("s3tc")) {
 				format = basist::transcoder_texture_format::cTFBC3; // get this from renderer
 				imgfmt = Image::FORMAT_DXT5;
-			} else if (RS::get_singleton()->has_os_feature("etc2")) {
+			} else if (_has_os_feature("etc2")) {
 				format = basist::transcoder_texture_format::cTFETC2; // get this from renderer
 				imgfmt = Image::FORMAT_ETC2_RGBA8;
 			} else {
@@ -209,10 +243,10 @@ static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 			}
 		} break;
 		case BASIS_DECOMPRESS_RG_AS_RA: {
-			if (RS::get_singleton()->has_os_feature("s3tc")) {
+			if (_has_os_feature("s3tc")) {
 				format = basist::transcoder_texture_format::cTFBC3; // get this from renderer
 				imgfmt = Image::FORMAT_DXT5_RA_AS_RG;
-			} else if (RS::get_singleton()->has_os_feature("etc2")) {
+			} else if (_has_os_feature("etc2")) {
 				format = basist::transcoder_texture_format::cTFETC2; // get this from renderer
 				imgfmt = Image::FORMAT_ETC2_RGBA8;
 			} else {
@@ -223,9 +257,20 @@ static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 		} break;
 	}
 
+	ERR_FAIL_COND_V_MSG(imgfmt == Image::FORMAT_MAX, image, "Unknown Basis Universal decompression format.");
+
 	ptr += 4;
 	size -= 4;
 
+	String cache_key;
+	if (transcode_cache.is_enabled()) {
+		cache_key = BasisTranscodeCache::get_key(ptr, size, int(format), imgfmt);
+		image = transcode_cache.load(cache_key);
+		if (image.is_valid()) {
+			return image;
+		}
+	}
+
 	basist::basisu_transcoder tr(nullptr);
 
 	ERR_FAIL_COND_V(!tr.validate_header(ptr, size), image);
@@ -233,35 +278,51 @@ static Ref<Image> basis_universal_unpacker(const Vector<uint8_t> &p_buffer) {
 	basist::basisu_image_info info;
 	tr.get_image_info(ptr, size, info, 0);
 
-	int block_size = basist::basis_get_bytes_per_block(format);
+	int width = info.m_orig_width;
+	int height = info.m_orig_height;
+	bool mipmaps = info.m_total_levels > 1;
+
 	Vector<uint8_t> gpudata;
-	gpudata.resize(info.m_total_blocks * block_size);
+	gpudata.resize(Image::get_image_data_size(width, height, imgfmt, mipmaps));
+	zeromem(gpudata.ptrw(), gpudata.size());
 
-	{
-		uint8_t *w = gpudata.ptrw();
-		uint8_t *dst = w;
-		for (int i = 0; i < gpudata.size(); i++) {
-			dst[i] = 0x00;
-		}
+	Vector<int> offsets;
+	offsets.resize(info.m_total_levels + 1);
+	for (uint32_t i = 0; i <= info.m_total_levels; i++) {
+		offsets.write[i] = MIN(Image::get_image_mipmap_offset(width, height, imgfmt, i), gpudata.size());
+	}
 
-		int ofs = 0;
-		tr.start_transcoding(ptr, size);
-		for (uint32_t i = 0; i < info.m_total_levels; i++) {
-			basist::basisu_image_level_info level;
-			tr.get_image_level_info(ptr, size, level, 0, i);
+	Vector<uint8_t> transcoded;
+	transcoded.resize(info.m_total_levels);
+
+	ERR_FAIL_COND_V(!tr.start_transcoding(ptr, size), image);
+
+	BasisTranscodeJob job;
+	job.transcoder = &tr;
+	job.data = ptr;
+	job.size = size;
+	job.format = format;
+	job.dst = gpudata.ptrw();
+	job.offsets = offsets.ptr();
+	if (basist::basis_transcoder_format_is_uncompressed(format)) {
+		job.unit_size = basist::basis_get_uncompressed_bytes_per_pixel(format);
+	} else {
+		job.unit_size = basist::basis_get_bytes_per_block(format);
+	}
+	job.transcoded = transcoded.ptrw();
 
-			bool ret = tr.transcode_image_level(ptr, size, 0, i, dst + ofs, level.m_total_blocks - i, format);
-			if (!ret) {
-				printf("failed! on level %i\n", i);
-				break;
-			};
+	Image::process_rows(info.m_total_levels, width * height / info.m_total_levels, _transcode_levels, &job);
 
-			ofs += level.m_total_blocks * block_size;
-		};
-	};
+	for (uint32_t i = 0; i < info.m_total_levels; i++) {
+		ERR_FAIL_COND_V_MSG(!job.transcoded[i], image, "Failed transcoding Basis Universal mipmap " + itos(i) + ".");
+	}
 
 	image.instance();
-	image->create(info.m_width, info.m_height, info.m_total_levels > 1, imgfmt, gpudata);
+	image->create(width, height, mipmaps, imgfmt, gpudata);
+
+	if (transcode_cache.is_enabled()) {
+		transcode_cache.store(cache_key, image);
+	}
 
 	return image;
 }
@@ -271,6 +332,11 @@ void register_basis_universal_types() {
 	sel_codebook = new basist::etc1_global_selector_codebook(basist::g_global_selector_cb_size, basist::g_global_selector_cb);
 	Image::basis_universal_packer = basis_universal_packer;
 #endif
+	basist::basisu_transcoder_init();
+	if (GLOBAL_DEF_RST("rendering/vram_compression/basis_universal_transcode_cache", false)) {
+		transcode_cache.set_cache_path(ProjectSettings::get_singleton()->globalize_path("user://basis_transcode_cache"));
+		transcode_cache.prune_other_versions();
+	}
 	Image::basis_universal_unpacker = basis_universal_unpacker;
 	//ClassDB::register_class<TextureBasisU>();
 }
@@ -30,8 +30,6 @@
 
 #include "image_compress_cvtt.h"
 
-#include "core/os/os.h"
-#include "core/os/thread.h"
 #include "core/print_string.h"
 
 #include <ConvectionKernels.h>
@@ -44,33 +42,16 @@ struct CVTTCompressionJobParams {
 	cvtt::Options options;
 };
 
-struct CVTTCompressionRowTask {
-	const uint8_t *in_mm_bytes;
-	uint8_t *out_mm_bytes;
-	int y_start;
-	int width;
-	int height;
-};
-
-struct CVTTCompressionJobQueue {
-	CVTTCompressionJobParams job_params;
-	const CVTTCompressionRowTask *job_tasks;
-	uint32_t num_tasks;
-	uint32_t current_task;
-};
-
-static void _digest_row_task(const CVTTCompressionJobParams &p_job_params, const CVTTCompressionRowTask &p_row_task) {
-	const uint8_t *in_bytes = p_row_task.in_mm_bytes;
-	uint8_t *out_bytes = p_row_task.out_mm_bytes;
-	int w = p_row_task.width;
-	int h = p_row_task.height;
-
-	int y_start = p_row_task.y_start;
-	int y_end = y_start + 4;
+static void _digest_row_task(void *p_job_params, const Image::CompressBlockRow &p_row) {
+	const CVTTCompressionJobParams &job_params = *static_cast<const CVTTCompressionJobParams *>(p_job_params);
+	const uint8_t *in_bytes = p_row.src;
+	uint8_t *out_bytes = p_row.dst;
+	int w = p_row.width;
+	int h = p_row.height;
 
-	int bytes_per_pixel = p_job_params.bytes_per_pixel;
-	bool is_hdr = p_job_params.is_hdr;
-	bool is_signed = p_job_params.is_signed;
+	int bytes_per_pixel = job_params.bytes_per_pixel;
+	bool is_hdr = job_params.is_hdr;
+	bool is_signed = job_params.is_signed;
 
 	cvtt::PixelBlockU8 input_blocks_ldr[cvtt::NumParallelBlocks];
 	cvtt::PixelBlockF16 input_blocks_hdr[cvtt::NumParallelBlocks];
@@ -78,8 +59,8 @@ static void _digest_row_task(const CVTTCompressionJobParams &p_job_params, const
 	for (int x_start = 0; x_start < w; x_start += 4 * cvtt::NumParallelBlocks) {
 		int x_end = x_start + 4 * cvtt::NumParallelBlocks;
 
-		for (int y = y_start; y < y_end; y++) {
-			int first_input_element = (y - y_start) * 4;
+		for (int y = 0; y < 4; y++) {
+			int first_input_element = y * 4;
 			const uint8_t *row_start;
 			if (y >= h) {
 				row_start = in_bytes + (h - 1) * (w * bytes_per_pixel);
@@ -110,12 +91,12 @@ static void _digest_row_task(const CVTTCompressionJobParams &p_job_params, const
 
 		if (is_hdr) {
 			if (is_signed) {
-				cvtt::Kernels::EncodeBC6HS(output_blocks, input_blocks_hdr, p_job_params.options);
+				cvtt::Kernels::EncodeBC6HS(output_blocks, input_blocks_hdr, job_params.options);
 			} else {
-				cvtt::Kernels::EncodeBC6HU(output_blocks, input_blocks_hdr, p_job_params.options);
+				cvtt::Kernels::EncodeBC6HU(output_blocks, input_blocks_hdr, job_params.options);
 			}
 		} else {
-			cvtt::Kernels::EncodeBC7(output_blocks, input_blocks_ldr, p_job_params.options);
+			cvtt::Kernels::EncodeBC7(output_blocks, input_blocks_ldr, job_params.options);
 		}
 
 		unsigned int num_real_blocks = ((w - x_start) + 3) / 4;
@@ -128,14 +109,6 @@ static void _digest_row_task(const CVTTCompressionJobParams &p_job_params, const
 	}
 }
 
-static void _digest_job_queue(void *p_job_queue) {
-	CVTTCompressionJobQueue *job_queue = static_cast<CVTTCompressionJobQueue *>(p_job_queue);
-
-	for (uint32_t next_task = atomic_increment(&job_queue->current_task); next_task <= job_queue->num_tasks; next_task = atomic_increment(&job_queue->current_task)) {
-		_digest_row_task(job_queue->job_params, job_queue->job_tasks[next_task - 1]);
-	}
-}
-
 void image_compress_cvtt(Image *p_image, float p_lossy_quality, Image::UsedChannels p_channels) {
 	if (p_image->get_format() >= Image::FORMAT_BPTC_RGBA) {
 		return; //do not compress, already compressed
@@ -196,85 +169,17 @@ void image_compress_cvtt(Image *p_image, float p_lossy_quality, Image::UsedChann
 		p_image->convert(Image::FORMAT_RGBA8); //still uses RGBA to convert
 	}
 
-	const uint8_t *rb = p_image->get_data().ptr();
-
 	Vector<uint8_t> data;
 	int target_size = Image::get_image_data_size(w, h, target_format, p_image->has_mipmaps());
-	int mm_count = p_image->has_mipmaps() ? Image::get_image_required_mipmaps(w, h, target_format) : 0;
 	data.resize(target_size);
-	int shift = Image::get_format_pixel_rshift(target_format);
-
-	uint8_t *wb = data.ptrw();
-
-	int dst_ofs = 0;
-
-	CVTTCompressionJobQueue job_queue;
-	job_queue.job_params.is_hdr = is_hdr;
-	job_queue.job_params.is_signed = is_signed;
-	job_queue.job_params.options = options;
-	job_queue.job_params.bytes_per_pixel = is_hdr ? 6 : 4;
-
-#ifdef NO_THREADS
-	int num_job_threads = 0;
-#else
-	int num_job_threads = OS::get_singleton()->can_use_threads() ? (OS::get_singleton()->get_processor_count() - 1) : 0;
-#endif
-
-	Vector<CVTTCompressionRowTask> tasks;
-
-	for (int i = 0; i <= mm_count; i++) {
-		int bw = w % 4 != 0 ? w + (4 - w % 4) : w;
-		int bh = h % 4 != 0 ? h + (4 - h % 4) : h;
 
-		int src_ofs = p_image->get_mipmap_offset(i);
-
-		const uint8_t *in_bytes = &rb[src_ofs];
-		uint8_t *out_bytes = &wb[dst_ofs];
-
-		for (int y_start = 0; y_start < h; y_start += 4) {
-			CVTTCompressionRowTask row_task;
-			row_task.width = w;
-			row_task.height = h;
-			row_task.y_start = y_start;
-			row_task.in_mm_bytes = in_bytes;
-			row_task.out_mm_bytes = out_bytes;
-
-			if (num_job_threads > 0) {
-				tasks.push_back(row_task);
-			} else {
-				_digest_row_task(job_queue.job_params, row_task);
-			}
-
-			out_bytes += 16 * (bw / 4);
-		}
-
-		dst_ofs += (MAX(4, bw) * MAX(4, bh)) >> shift;
-		w = MAX(w / 2, 1);
-		h = MAX(h / 2, 1);
-	}
-
-	if (num_job_threads > 0) {
-		Vector<Thread *> threads;
-		threads.resize(num_job_threads);
-
-		Thread **threads_wb = threads.ptrw();
-
-		const CVTTCompressionRowTask *tasks_rb = tasks.ptr();
-
-		job_queue.job_tasks = &tasks_rb[0];
-		job_queue.current_task = 0;
-		job_queue.num_tasks = static_cast<uint32_t>(tasks.size());
-
-		for (int i = 0; i < num_job_threads; i++) {
-			threads_wb[i] = Thread::create(_digest_job_queue, &job_queue);
-		}
-		_digest_job_queue(&job_queue);
+	CVTTCompressionJobParams job_params;
+	job_params.is_hdr = is_hdr;
+	job_params.is_signed = is_signed;
+	job_params.options = options;
+	job_params.bytes_per_pixel = is_hdr ? 6 : 4;
 
-		for (int i = 0; i < num_job_threads; i++) {
-			Thread::wait_to_finish(threads_wb[i]);
-			memdelete(threads_wb[i]);
-		}
-	}
+	p_image->compress_block_rows(target_format, data.ptrw(), _digest_row_task, &job_params);
 
 	p_image->create(p_image->get_width(), p_image->get_height(), p_image->has_mipmaps(), target_format, data);
 }
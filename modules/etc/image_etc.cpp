@@ -88,6 +88,38 @@ static Etc::Image::Format _image_format_to_etc2comp_format(Image::Format format)
 	}
 }
 
+struct ETCCompressionParams {
+	Etc::Image::Format format;
+	Etc::ErrorMetric error_metric;
+	float effort;
+	unsigned int block_size;
+};
+
+static void _compress_block_row(void *p_params, const Image::CompressBlockRow &p_row) {
+	const ETCCompressionParams &params = *static_cast<const ETCCompressionParams *>(p_params);
+
+	// convert source row to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
+	int pixel_count = p_row.width * p_row.height;
+	Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[pixel_count];
+	for (int j = 0; j < pixel_count; j++) {
+		int si = j * 4; // RGBA8
+		src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(p_row.src[si], p_row.src[si + 1], p_row.src[si + 2], p_row.src[si + 3]);
+	}
+
+	unsigned char *etc_data = nullptr;
+	unsigned int etc_data_len = 0;
+	unsigned int extended_width = 0, extended_height = 0;
+	int encoding_time = 0;
+	// A single job, rows are already spread over the image thread pool.
+	Etc::Encode((float *)src_rgba_f, p_row.width, p_row.height, params.format, params.error_metric, params.effort, 1, 1, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
+
+	CRASH_COND(etc_data_len != params.block_size * ((p_row.width + 3) / 4));
+	memcpy(p_row.dst, etc_data, etc_data_len);
+
+	delete[] etc_data;
+	delete[] src_rgba_f;
+}
+
 static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_format, Image::UsedChannels p_channels) {
 	Image::Format img_format = p_img->get_format();
 
@@ -150,63 +182,30 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
 		}
 	}
 
-	const uint8_t *r = img->get_data().ptr();
-	ERR_FAIL_COND(!r);
-
 	unsigned int target_size = Image::get_image_data_size(imgw, imgh, etc_format, p_img->has_mipmaps());
-	int mmc = 1 + (p_img->has_mipmaps() ? Image::get_image_required_mipmaps(imgw, imgh, etc_format) : 0);
 
 	Vector<uint8_t> dst_data;
 	dst_data.resize(target_size);
 
-	uint8_t *w = dst_data.ptrw();
-
 	// prepare parameters to be passed to etc2comp
-	int num_cpus = OS::get_singleton()->get_processor_count();
-	int encoding_time = 0;
-	float effort = 0.0; //default, reasonable time
+	ETCCompressionParams params;
+	params.effort = 0.0; //default, reasonable time
 
 	if (p_lossy_quality > 0.75) {
-		effort = 0.4;
+		params.effort = 0.4;
 	} else if (p_lossy_quality > 0.85) {
-		effort = 0.6;
+		params.effort = 0.6;
 	} else if (p_lossy_quality > 0.95) {
-		effort = 0.8;
+		params.effort = 0.8;
 	}
 
-	Etc::ErrorMetric error_metric = Etc::ErrorMetric::RGBX; // NOTE: we can experiment with other error metrics
-	Etc::Image::Format etc2comp_etc_format = _image_format_to_etc2comp_format(etc_format);
-
-	int wofs = 0;
+	params.error_metric = Etc::ErrorMetric::RGBX; // NOTE: we can experiment with other error metrics
+	params.format = _image_format_to_etc2comp_format(etc_format);
+	params.block_size = (16 * Image::get_format_pixel_size(etc_format)) >> Image::get_format_pixel_rshift(etc_format);
 
 	print_verbose("ETC: Begin encoding, format: " + Image::get_format_name(etc_format));
 	uint64_t t = OS::get_singleton()->get_ticks_msec();
-	for (int i = 0; i < mmc; i++) {
-		// convert source image to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
-		// NOTE: We can alternatively add a case to Image::convert to handle Image::FORMAT_RGBAF conversion.
-		int mipmap_ofs = 0, mipmap_size = 0, mipmap_w = 0, mipmap_h = 0;
-		img->get_mipmap_offset_size_and_dimensions(i, mipmap_ofs, mipmap_size, mipmap_w, mipmap_h);
-		const uint8_t *src = &r[mipmap_ofs];
-
-		Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[mipmap_w * mipmap_h];
-		for (int j = 0; j < mipmap_w * mipmap_h; j++) {
-			int si = j * 4; // RGBA8
-			src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(src[si], src[si + 1], src[si + 2], src[si + 3]);
-		}
-
-		unsigned char *etc_data = nullptr;
-		unsigned int etc_data_len = 0;
-		unsigned int extended_width = 0, extended_height = 0;
-		Etc::Encode((float *)src_rgba_f, mipmap_w, mipmap_h, etc2comp_etc_format, error_metric, effort, num_cpus, num_cpus, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
-
-		CRASH_COND(wofs + etc_data_len > target_size);
-		memcpy(&w[wofs], etc_data, etc_data_len);
-		wofs += etc_data_len;
-
-		delete[] etc_data;
-		delete[] src_rgba_f;
-	}
-
+	img->compress_block_rows(etc_format, dst_data.ptrw(), _compress_block_row, &params);
 	print_verbose("ETC: Time encoding: " + rtos(OS::get_singleton()->get_ticks_msec() - t));
 
 	p_img->create(imgw, imgh, p_img->has_mipmaps(), etc_format, dst_data);
@@ -36,69 +36,73 @@
 #include <jpgd.h>
 #include <string.h>
 
-Error jpeg_load_image_from_buffer(Image *p_image, const uint8_t *p_buffer, int p_buffer_len) {
-	jpgd::jpeg_decoder_mem_stream mem_stream(p_buffer, p_buffer_len);
-
-	jpgd::jpeg_decoder decoder(&mem_stream);
-
-	if (decoder.get_error_code() != jpgd::JPGD_SUCCESS) {
+static Error _jpeg_get_info(jpgd::jpeg_decoder &p_decoder, Size2i &r_size, Image::Format &r_format) {
+	if (p_decoder.get_error_code() != jpgd::JPGD_SUCCESS) {
 		return ERR_CANT_OPEN;
 	}
 
-	const int image_width = decoder.get_width();
-	const int image_height = decoder.get_height();
-	const int comps = decoder.get_num_components();
+	const int comps = p_decoder.get_num_components();
 	if (comps != 1 && comps != 3) {
 		return ERR_FILE_CORRUPT;
 	}
 
-	if (decoder.begin_decoding() != jpgd::JPGD_SUCCESS) {
+	r_size = Size2i(p_decoder.get_width(), p_decoder.get_height());
+	r_format = comps == 1 ? Image::FORMAT_L8 : Image::FORMAT_RGB8;
+	return OK;
+}
+
+// jpgd has no scaled IDCT, so reduced images are box filtered as the scan lines are decoded,
+// which still avoids holding the full size image in memory.
+static Error _jpeg_decode(jpgd::jpeg_decoder &p_decoder, int p_reduce, uint8_t *p_dst) {
+	if (p_decoder.begin_decoding() != jpgd::JPGD_SUCCESS) {
 		return ERR_FILE_CORRUPT;
 	}
 
-	const int dst_bpl = image_width * comps;
-
-	Vector<uint8_t> data;
-
-	data.resize(dst_bpl * image_height);
-
-	uint8_t *dw = data.ptrw();
+	const int image_width = p_decoder.get_width();
+	const int image_height = p_decoder.get_height();
+	const int comps = p_decoder.get_num_components();
 
-	jpgd::uint8 *pImage_data = (jpgd::uint8 *)dw;
+	ImageRowReducer reducer;
+	reducer.init(image_width, image_height, comps, p_reduce, p_dst);
 
 	for (int y = 0; y < image_height; y++) {
 		const jpgd::uint8 *pScan_line;
 		jpgd::uint scan_line_len;
-		if (decoder.decode((const void **)&pScan_line, &scan_line_len) != jpgd::JPGD_SUCCESS) {
+		if (p_decoder.decode((const void **)&pScan_line, &scan_line_len) != jpgd::JPGD_SUCCESS) {
 			return ERR_FILE_CORRUPT;
 		}
 
-		jpgd::uint8 *pDst = pImage_data + y * dst_bpl;
-
-		if (comps == 1) {
-			memcpy(pDst, pScan_line, dst_bpl);
-		} else {
-			// For images with more than 1 channel pScan_line will always point to a buffer
-			// containing 32-bit RGBA pixels. Alpha is always 255 and we ignore it.
-			for (int x = 0; x < image_width; x++) {
-				pDst[0] = pScan_line[x * 4 + 0];
-				pDst[1] = pScan_line[x * 4 + 1];
-				pDst[2] = pScan_line[x * 4 + 2];
-				pDst += 3;
-			}
-		}
+		// For images with more than 1 channel pScan_line will always point to a buffer
+		// containing 32-bit RGBA pixels. Alpha is always 255 and we ignore it.
+		reducer.push_row(pScan_line, comps == 1 ? 1 : 4);
 	}
 
-	//all good
+	return OK;
+}
 
+Error jpeg_load_image_from_buffer(Image *p_image, const uint8_t *p_buffer, int p_buffer_len) {
+	jpgd::jpeg_decoder_mem_stream mem_stream(p_buffer, p_buffer_len);
+
+	jpgd::jpeg_decoder decoder(&mem_stream);
+
+	Size2i size;
 	Image::Format fmt;
-	if (comps == 1) {
-		fmt = Image::FORMAT_L8;
-	} else {
-		fmt = Image::FORMAT_RGB8;
+	Error err = _jpeg_get_info(decoder, size, fmt);
+	if (err != OK) {
+		return err;
 	}
 
-	p_image->create(image_width, image_height, false, fmt, data);
+	Vector<uint8_t> data;
+	data.resize(Image::get_image_data_size(size.width, size.height, fmt));
+
+	err = _jpeg_decode(decoder, 0, data.ptrw());
+	if (err != OK) {
+		return err;
+	}
+
+	//all good
+
+	p_image->create(size.width, size.height, false, fmt, data);
 
 	return OK;
 }
@@ -125,6 +129,25 @@ void ImageLoaderJPG::get_recognized_extensions(List<String> *p_extensions) const
 	p_extensions->push_back("jpeg");
 }
 
+Error ImageLoaderJPG::get_buffer_info(const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) const {
+	jpgd::jpeg_decoder_mem_stream mem_stream(p_buffer, p_size);
+	jpgd::jpeg_decoder decoder(&mem_stream);
+	return _jpeg_get_info(decoder, r_size, r_format);
+}
+
+Error ImageLoaderJPG::decode_buffer(const uint8_t *p_buffer, int p_size, int p_reduce, uint8_t *p_dst) const {
+	jpgd::jpeg_decoder_mem_stream mem_stream(p_buffer, p_size);
+	jpgd::jpeg_decoder decoder(&mem_stream);
+
+	Size2i size;
+	Image::Format format;
+	Error err = _jpeg_get_info(decoder, size, format);
+	if (err != OK) {
+		return err;
+	}
+	return _jpeg_decode(decoder, p_reduce, p_dst);
+}
+
 static Ref<Image> _jpegd_mem_loader_func(const uint8_t *p_png, int p_size) {
 	Ref<Image> img;
 	img.instance();
@@ -77,6 +77,10 @@ void image_decompress_squish(Image *p_image) {
 	}
 }
 
+static void _compress_block_row(void *p_squish_flags, const Image::CompressBlockRow &p_row) {
+	squish::CompressImage(p_row.src, p_row.width, p_row.height, p_row.dst, *static_cast<int *>(p_squish_flags));
+}
+
 void image_compress_squish(Image *p_image, float p_lossy_quality, Image::UsedChannels p_channels) {
 	if (p_image->get_format() >= Image::FORMAT_DXT1) {
 		return; //do not compress, already compressed
@@ -133,25 +137,9 @@ void image_compress_squish(Image *p_image, float p_lossy_quality, Image::UsedCha
 
 		Vector<uint8_t> data;
 		int target_size = Image::get_image_data_size(w, h, target_format, p_image->has_mipmaps());
-		int mm_count = p_image->has_mipmaps() ? Image::get_image_required_mipmaps(w, h, target_format) : 0;
 		data.resize(target_size);
-		int shift = Image::get_format_pixel_rshift(target_format);
-
-		const uint8_t *rb = p_image->get_data().ptr();
-		uint8_t *wb = data.ptrw();
 
-		int dst_ofs = 0;
-
-		for (int i = 0; i <= mm_count; i++) {
-			int bw = w % 4 != 0 ? w + (4 - w % 4) : w;
-			int bh = h % 4 != 0 ? h + (4 - h % 4) : h;
-
-			int src_ofs = p_image->get_mipmap_offset(i);
-			squish::CompressImage(&rb[src_ofs], w, h, &wb[dst_ofs], squish_comp);
-			dst_ofs += (MAX(4, bw) * MAX(4, bh)) >> shift;
-			w = MAX(w / 2, 1);
-			h = MAX(h / 2, 1);
-		}
+		p_image->compress_block_rows(target_format, data.ptrw(), _compress_block_row, &squish_comp);
 
 		p_image->create(p_image->get_width(), p_image->get_height(), p_image->has_mipmaps(), target_format, data);
 	}
@@ -32,14 +32,13 @@
 
 #include "core/os/file_access.h"
 
-void AudioStreamPlaybackOGGVorbis::_mix_internal(AudioFrame *p_buffer, int p_frames) {
-	ERR_FAIL_COND(!active);
-
+// Called on a decode thread.
+int AudioStreamPlaybackOGGVorbis::_decode(AudioFrame *p_buffer, int p_frames) {
 	int todo = p_frames;
 
 	int start_buffer = 0;
 
-	while (todo && active) {
+	while (todo) {
 		float *buffer = (float *)p_buffer;
 		if (start_buffer > 0) {
 			buffer = (buffer + start_buffer * 2);
@@ -47,71 +46,119 @@ void AudioStreamPlaybackOGGVorbis::_mix_internal(AudioFrame *p_buffer, int p_fra
 		int mixed = stb_vorbis_get_samples_float_interleaved(ogg_stream, 2, buffer, todo * 2);
 		if (vorbis_stream->channels == 1 && mixed > 0) {
 			//mix mono to stereo
-			for (int i = start_buffer; i < mixed; i++) {
+			for (int i = start_buffer; i < start_buffer + mixed; i++) {
 				p_buffer[i].r = p_buffer[i].l;
 			}
 		}
 		todo -= mixed;
-		frames_mixed += mixed;
 
 		if (todo) {
 			//end of file!
 			bool is_not_empty = mixed > 0 || stb_vorbis_stream_length_in_samples(ogg_stream) > 0;
 			if (vorbis_stream->loop && is_not_empty) {
 				//loop
-				seek(vorbis_stream->loop_offset);
-				loops++;
+				_decode_seek(vorbis_stream->loop_offset);
 				// we still have buffer to fill, start from this element in the next iteration.
 				start_buffer = p_frames - todo;
 			} else {
-				for (int i = p_frames - todo; i < p_frames; i++) {
-					p_buffer[i] = AudioFrame(0, 0);
-				}
-				active = false;
-				todo = 0;
+				break;
 			}
 		}
 	}
+
+	return p_frames - todo;
+}
+
+void AudioStreamPlaybackOGGVorbis::_decode_seek(float p_time) {
+	stb_vorbis_seek(ogg_stream, uint32_t(vorbis_stream->sample_rate * p_time));
 }
 
 float AudioStreamPlaybackOGGVorbis::get_stream_sampling_rate() {
 	return vorbis_stream->sample_rate;
 }
 
-void AudioStreamPlaybackOGGVorbis::start(float p_from_pos) {
-	active = true;
-	seek(p_from_pos);
-	loops = 0;
-	_begin_resample();
-}
+// Position of what was mixed so far, wrapped around the loop like the decoder does.
+float AudioStreamPlaybackOGGVorbis::_get_position(int *r_loops) const {
+	float length = vorbis_stream->get_length();
+	float pos = get_start_position() + get_frames_played() / vorbis_stream->sample_rate;
+	int played_loops = 0;
+
+	float loop_offset = vorbis_stream->loop_offset;
+	float loop_length = length - loop_offset;
+	if (vorbis_stream->loop && pos >= length && loop_length > 0) {
+		played_loops = int((pos - loop_offset) / loop_length);
+		pos = loop_offset + Math::fmod(pos - loop_offset, loop_length);
+	}
 
-void AudioStreamPlaybackOGGVorbis::stop() {
-	active = false;
+	if (r_loops) {
+		*r_loops = played_loops;
+	}
+	return pos;
 }
 
-bool AudioStreamPlaybackOGGVorbis::is_playing() const {
-	return active;
+void AudioStreamPlaybackOGGVorbis::start(float p_from_pos) {
+	loops = 0;
+	if (p_from_pos >= vorbis_stream->get_length()) {
+		p_from_pos = 0;
+	}
+	AudioStreamPlaybackDecodeAhead::start(p_from_pos);
 }
 
 int AudioStreamPlaybackOGGVorbis::get_loop_count() const {
-	return loops;
+	int played_loops;
+	_get_position(&played_loops);
+	return loops + played_loops;
 }
 
 float AudioStreamPlaybackOGGVorbis::get_playback_position() const {
-	return float(frames_mixed) / vorbis_stream->sample_rate;
+	return _get_position(nullptr);
 }
 
 void AudioStreamPlaybackOGGVorbis::seek(float p_time) {
-	if (!active) {
+	if (!is_playing()) {
 		return;
 	}
 
 	if (p_time >= vorbis_stream->get_length()) {
 		p_time = 0;
 	}
-	frames_mixed = uint32_t(vorbis_stream->sample_rate * p_time);
 
-	stb_vorbis_seek(ogg_stream, frames_mixed);
+	// Restarting counts the frames played from the new position, keep the loops done until now.
+	int played_loops;
+	_get_position(&played_loops);
+	loops += played_loops;
+
+	AudioStreamPlaybackDecodeAhead::seek(p_time);
+}
+
+void AudioStreamPlaybackOGGVorbis::skip(float p_time) {
+	if (!is_playing()) {
+		return;
+	}
+
+	float length = vorbis_stream->get_length();
+	float to = get_playback_position() + p_time;
+	int skipped_loops = 0;
+
+	if (to >= length) {
+		if (!vorbis_stream->loop || length <= 0) {
+			stop();
+			return;
+		}
+
+		float loop_offset = vorbis_stream->loop_offset;
+		float loop_length = length - loop_offset;
+		if (loop_length > 0) {
+			skipped_loops = int((to - loop_offset) / loop_length);
+			to = loop_offset + Math::fmod(to - loop_offset, loop_length);
+		} else {
+			skipped_loops = 1;
+			to = loop_offset;
+		}
+	}
+
+	seek(to);
+	loops += skipped_loops;
 }
 
 AudioStreamPlaybackOGGVorbis::~AudioStreamPlaybackOGGVorbis() {
@@ -130,8 +177,6 @@ Ref<AudioStreamPlayback> AudioStreamOGGVorbis::instance_playback() {
 	ovs->vorbis_stream = Ref<AudioStreamOGGVorbis>(this);
 	ovs->ogg_alloc.alloc_buffer = (char *)memalloc(decode_mem_size);
 	ovs->ogg_alloc.alloc_buffer_length_in_bytes = decode_mem_size;
-	ovs->frames_mixed = 0;
-	ovs->active = false;
 	ovs->loops = 0;
 	int error;
 	ovs->ogg_stream = stb_vorbis_open_memory((const unsigned char *)data, data_len, &error, &ovs->ogg_alloc);
@@ -140,6 +185,7 @@ Ref<AudioStreamPlayback> AudioStreamOGGVorbis::instance_playback() {
 		ovs->ogg_alloc.alloc_buffer = nullptr;
 		ERR_FAIL_COND_V(!ovs->ogg_stream, Ref<AudioStreamPlaybackOGGVorbis>());
 	}
+	ovs->_init_decode_ahead(sample_rate);
 
 	return ovs;
 }
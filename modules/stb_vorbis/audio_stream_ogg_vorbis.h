@@ -32,38 +32,38 @@
 #define AUDIO_STREAM_STB_VORBIS_H
 
 #include "core/io/resource_loader.h"
-#include "servers/audio/audio_stream.h"
+#include "servers/audio/audio_decode_ahead.h"
 
 #include "thirdparty/misc/stb_vorbis.h"
 
 class AudioStreamOGGVorbis;
 
-class AudioStreamPlaybackOGGVorbis : public AudioStreamPlaybackResampled {
-	GDCLASS(AudioStreamPlaybackOGGVorbis, AudioStreamPlaybackResampled);
+class AudioStreamPlaybackOGGVorbis : public AudioStreamPlaybackDecodeAhead {
+	GDCLASS(AudioStreamPlaybackOGGVorbis, AudioStreamPlaybackDecodeAhead);
 
 	stb_vorbis *ogg_stream;
 	stb_vorbis_alloc ogg_alloc;
-	uint32_t frames_mixed;
-	bool active;
 	int loops;
 
 	friend class AudioStreamOGGVorbis;
 
 	Ref<AudioStreamOGGVorbis> vorbis_stream;
 
+	float _get_position(int *r_loops) const;
+
 protected:
-	virtual void _mix_internal(AudioFrame *p_buffer, int p_frames) override;
+	virtual void _decode_seek(float p_time) override;
+	virtual int _decode(AudioFrame *p_buffer, int p_frames) override;
 	virtual float get_stream_sampling_rate() override;
 
 public:
 	virtual void start(float p_from_pos = 0.0) override;
-	virtual void stop() override;
-	virtual bool is_playing() const override;
 
 	virtual int get_loop_count() const override; //times it looped
 
 	virtual float get_playback_position() const override;
 	virtual void seek(float p_time) override;
+	virtual void skip(float p_time) override;
 
 	AudioStreamPlaybackOGGVorbis() {}
 	~AudioStreamPlaybackOGGVorbis();
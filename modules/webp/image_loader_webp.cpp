@@ -166,6 +166,49 @@ void ImageLoaderWEBP::get_recognized_extensions(List<String> *p_extensions) cons
 	p_extensions->push_back("webp");
 }
 
+Error ImageLoaderWEBP::get_buffer_info(const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) const {
+	WebPBitstreamFeatures features;
+	if (WebPGetFeatures(p_buffer, p_size, &features) != VP8_STATUS_OK) {
+		return ERR_FILE_CORRUPT;
+	}
+
+	r_size = Size2i(features.width, features.height);
+	r_format = features.has_alpha ? Image::FORMAT_RGBA8 : Image::FORMAT_RGB8;
+	return OK;
+}
+
+Error ImageLoaderWEBP::decode_buffer(const uint8_t *p_buffer, int p_size, int p_reduce, uint8_t *p_dst) const {
+	WebPDecoderConfig config;
+	if (!WebPInitDecoderConfig(&config)) {
+		return ERR_BUG;
+	}
+	if (WebPGetFeatures(p_buffer, p_size, &config.input) != VP8_STATUS_OK) {
+		return ERR_FILE_CORRUPT;
+	}
+
+	// libwebp scales while decoding, so the full size image is never held in memory.
+	const int width = MAX(config.input.width >> p_reduce, 1);
+	const int height = MAX(config.input.height >> p_reduce, 1);
+	const int comps = config.input.has_alpha ? 4 : 3;
+	if (p_reduce > 0) {
+		config.options.use_scaling = 1;
+		config.options.scaled_width = width;
+		config.options.scaled_height = height;
+	}
+
+	config.output.colorspace = config.input.has_alpha ? MODE_RGBA : MODE_RGB;
+	config.output.is_external_memory = 1;
+	config.output.u.RGBA.rgba = p_dst;
+	config.output.u.RGBA.stride = width * comps;
+	config.output.u.RGBA.size = width * height * comps;
+
+	VP8StatusCode status = WebPDecode(p_buffer, p_size, &config);
+	WebPFreeDecBuffer(&config.output);
+	ERR_FAIL_COND_V_MSG(status != VP8_STATUS_OK, ERR_FILE_CORRUPT, "Failed decoding WebP image.");
+
+	return OK;
+}
+
 ImageLoaderWEBP::ImageLoaderWEBP() {
 	Image::_webp_mem_loader_func = _webp_mem_loader_func;
 	Image::lossy_packer = _webp_lossy_pack;
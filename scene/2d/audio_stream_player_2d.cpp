@@ -34,124 +34,104 @@
 #include "scene/2d/area_2d.h"
 #include "scene/main/window.h"
 
-void AudioStreamPlayer2D::_mix_audio() {
-	if (!stream_playback.is_valid() || !active ||
-			(stream_paused && !stream_paused_fade_out)) {
-		return;
-	}
+void AudioStreamPlayer2D::_update_voice_targets() {
+	Ref<World2D> world_2d = get_world_2d();
+	ERR_FAIL_COND(world_2d.is_null());
 
-	if (setseek >= 0.0) {
-		stream_playback->start(setseek);
-		setseek = -1.0; //reset seek
-	}
+	AudioServer::VoiceTarget targets[MAX_OUTPUTS];
+	int target_count = 0;
 
-	//get data
-	AudioFrame *buffer = mix_buffer.ptrw();
-	int buffer_size = mix_buffer.size();
+	Vector2 global_pos = get_global_position();
 
-	if (stream_paused_fade_out) {
-		// Short fadeout ramp
-		buffer_size = MIN(buffer_size, 128);
-	}
+	StringName target_bus = bus;
 
-	stream_playback->mix(buffer, pitch_scale, buffer_size);
+	//check if any area is diverting sound into a bus
 
-	//write all outputs
-	for (int i = 0; i < output_count; i++) {
-		Output current = outputs[i];
+	PhysicsDirectSpaceState2D *space_state = PhysicsServer2D::get_singleton()->space_get_direct_state(world_2d->get_space());
 
-		//see if current output exists, to keep volume ramp
-		bool found = false;
-		for (int j = i; j < prev_output_count; j++) {
-			if (prev_outputs[j].viewport == current.viewport) {
-				if (j != i) {
-					SWAP(prev_outputs[j], prev_outputs[i]);
-				}
-				found = true;
-				break;
-			}
+	PhysicsDirectSpaceState2D::ShapeResult sr[MAX_INTERSECT_AREAS];
+
+	int areas = space_state->intersect_point(global_pos, sr, MAX_INTERSECT_AREAS, Set<RID>(), area_mask, false, true);
+
+	for (int i = 0; i < areas; i++) {
+		Area2D *area2d = Object::cast_to<Area2D>(sr[i].collider);
+		if (!area2d) {
+			continue;
 		}
 
-		if (!found) {
-			//create new if was not used before
-			if (prev_output_count < MAX_OUTPUTS) {
-				prev_outputs[prev_output_count] = prev_outputs[i]; //may be owned by another viewport
-				prev_output_count++;
-			}
-			prev_outputs[i] = current;
+		if (!area2d->is_overriding_audio_bus()) {
+			continue;
 		}
 
-		//mix!
-		AudioFrame target_volume = stream_paused_fade_out ? AudioFrame(0.f, 0.f) : current.vol;
-		AudioFrame vol_prev = stream_paused_fade_in ? AudioFrame(0.f, 0.f) : prev_outputs[i].vol;
-		AudioFrame vol_inc = (target_volume - vol_prev) / float(buffer_size);
-		AudioFrame vol = vol_prev;
+		target_bus = area2d->get_audio_bus_name();
+		break;
+	}
 
-		int cc = AudioServer::get_singleton()->get_channel_count();
+	int cc = MIN(AudioServer::get_singleton()->get_channel_count(), (int)AudioServer::MAX_CHANNELS_PER_BUS);
 
-		if (cc == 1) {
-			if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.bus_index, 0)) {
-				continue; //may have been removed
-			}
+	List<Viewport *> viewports;
+	world_2d->get_viewport_list(&viewports);
+	for (List<Viewport *>::Element *E = viewports.front(); E; E = E->next()) {
+		Viewport *vp = E->get();
+		if (vp->is_audio_listener_2d()) {
+			//compute matrix to convert to screen
+			Transform2D to_screen = vp->get_global_canvas_transform() * vp->get_canvas_transform();
+			Vector2 screen_size = vp->get_visible_rect().size;
 
-			AudioFrame *target = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, 0);
+			//screen in global is used for attenuation
+			Vector2 screen_in_global = to_screen.affine_inverse().xform(screen_size * 0.5);
 
-			for (int j = 0; j < buffer_size; j++) {
-				target[j] += buffer[j] * vol;
-				vol += vol_inc;
+			float dist = global_pos.distance_to(screen_in_global); //distance to screen center
+
+			if (dist > max_distance) {
+				continue; //can't hear this sound in this viewport
 			}
 
-		} else {
-			AudioFrame *targets[4];
-			bool valid = true;
+			float multiplier = Math::pow(1.0f - dist / max_distance, attenuation);
+			multiplier *= Math::db2linear(volume_db); //also apply player volume!
 
-			for (int k = 0; k < cc; k++) {
-				if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.bus_index, k)) {
-					valid = false; //may have been removed
-					break;
-				}
+			//point in screen is used for panning
+			Vector2 point_in_screen = to_screen.xform(global_pos);
 
-				targets[k] = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, k);
-			}
+			float pan = CLAMP(point_in_screen.x / screen_size.width, 0.0, 1.0);
 
-			if (!valid) {
-				continue;
-			}
+			float l = 1.0 - pan;
+			float r = pan;
 
-			for (int j = 0; j < buffer_size; j++) {
-				AudioFrame frame = buffer[j] * vol;
-				for (int k = 0; k < cc; k++) {
-					targets[k][j] += frame;
-				}
-				vol += vol_inc;
+			AudioServer::VoiceTarget &target = targets[target_count];
+			target.bus = target_bus;
+			for (int k = 0; k < cc; k++) {
+				target.volume[k] = AudioFrame(l, r) * multiplier;
+			}
+			target_count++;
+			if (target_count == MAX_OUTPUTS) {
+				break;
 			}
 		}
-
-		prev_outputs[i] = current;
 	}
 
-	prev_output_count = output_count;
+	AudioServer::get_singleton()->voice_set_targets(voice, targets, target_count);
+}
 
-	//stream is no longer active, disable this.
-	if (!stream_playback->is_playing()) {
-		active = false;
+void AudioStreamPlayer2D::_update_voice_paused() {
+	if (voice.is_valid()) {
+		//not mixed while outside the tree, like any node that can't process
+		AudioServer::get_singleton()->voice_set_paused(voice, stream_paused || !is_inside_tree());
 	}
-
-	output_ready = false;
-	stream_paused_fade_in = false;
-	stream_paused_fade_out = false;
 }
 
 void AudioStreamPlayer2D::_notification(int p_what) {
 	if (p_what == NOTIFICATION_ENTER_TREE) {
-		AudioServer::get_singleton()->add_callback(_mix_audios, this);
+		_update_voice_paused();
 		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
 			play();
 		}
 	}
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
-		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+		if (voice.is_valid()) {
+			AudioServer::get_singleton()->voice_set_paused(voice, true);
+		}
 	}
 
 	if (p_what == NOTIFICATION_PAUSED) {
@@ -167,94 +147,21 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 
 	if (p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS) {
 		//update anything related to position first, if possible of course
-
-		if (!output_ready) {
-			List<Viewport *> viewports;
-			Ref<World2D> world_2d = get_world_2d();
-			ERR_FAIL_COND(world_2d.is_null());
-
-			int new_output_count = 0;
-
-			Vector2 global_pos = get_global_position();
-
-			int bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus);
-
-			//check if any area is diverting sound into a bus
-
-			PhysicsDirectSpaceState2D *space_state = PhysicsServer2D::get_singleton()->space_get_direct_state(world_2d->get_space());
-
-			PhysicsDirectSpaceState2D::ShapeResult sr[MAX_INTERSECT_AREAS];
-
-			int areas = space_state->intersect_point(global_pos, sr, MAX_INTERSECT_AREAS, Set<RID>(), area_mask, false, true);
-
-			for (int i = 0; i < areas; i++) {
-				Area2D *area2d = Object::cast_to<Area2D>(sr[i].collider);
-				if (!area2d) {
-					continue;
-				}
-
-				if (!area2d->is_overriding_audio_bus()) {
-					continue;
-				}
-
-				StringName bus_name = area2d->get_audio_bus_name();
-				bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus_name);
-				break;
-			}
-
-			world_2d->get_viewport_list(&viewports);
-			for (List<Viewport *>::Element *E = viewports.front(); E; E = E->next()) {
-				Viewport *vp = E->get();
-				if (vp->is_audio_listener_2d()) {
-					//compute matrix to convert to screen
-					Transform2D to_screen = vp->get_global_canvas_transform() * vp->get_canvas_transform();
-					Vector2 screen_size = vp->get_visible_rect().size;
-
-					//screen in global is used for attenuation
-					Vector2 screen_in_global = to_screen.affine_inverse().xform(screen_size * 0.5);
-
-					float dist = global_pos.distance_to(screen_in_global); //distance to screen center
-
-					if (dist > max_distance) {
-						continue; //can't hear this sound in this viewport
-					}
-
-					float multiplier = Math::pow(1.0f - dist / max_distance, attenuation);
-					multiplier *= Math::db2linear(volume_db); //also apply player volume!
-
-					//point in screen is used for panning
-					Vector2 point_in_screen = to_screen.xform(global_pos);
-
-					float pan = CLAMP(point_in_screen.x / screen_size.width, 0.0, 1.0);
-
-					float l = 1.0 - pan;
-					float r = pan;
-
-					outputs[new_output_count].vol = AudioFrame(l, r) * multiplier;
-					outputs[new_output_count].bus_index = bus_index;
-					outputs[new_output_count].viewport = vp; //keep pointer only for reference
-					new_output_count++;
-					if (new_output_count == MAX_OUTPUTS) {
-						break;
-					}
-				}
-			}
-
-			output_count = new_output_count;
-			output_ready = true;
+		if (voice.is_valid()) {
+			_update_voice_targets();
 		}
 
 		//start playing if requested
 		if (setplay >= 0.0) {
-			setseek = setplay;
-			active = true;
+			AudioServer::get_singleton()->voice_play(voice, setplay);
 			setplay = -1;
 			//do not update, this makes it easier to animate (will shut off otherwise)
 			//_change_notify("playing"); //update property in editor
 		}
 
 		//stop playing if no longer active
-		if (!active) {
+		if (!active || !AudioServer::get_singleton()->voice_is_playing(voice)) {
+			active = false;
 			set_physics_process_internal(false);
 			//do not update, this makes it easier to animate (will shut off otherwise)
 			//_change_notify("playing"); //update property in editor
@@ -264,26 +171,25 @@ void AudioStreamPlayer2D::_notification(int p_what) {
 }
 
 void AudioStreamPlayer2D::set_stream(Ref<AudioStream> p_stream) {
-	AudioServer::get_singleton()->lock();
-
-	mix_buffer.resize(AudioServer::get_singleton()->thread_get_mix_buffer_size());
-
-	if (stream_playback.is_valid()) {
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_free(voice);
+		voice = RID();
 		stream_playback.unref();
 		stream.unref();
 		active = false;
-		setseek = -1;
+		setplay = -1;
 	}
 
 	if (p_stream.is_valid()) {
-		stream = p_stream;
-		stream_playback = p_stream->instance_playback();
+		voice = AudioServer::get_singleton()->voice_create(p_stream);
 	}
 
-	AudioServer::get_singleton()->unlock();
-
-	if (p_stream.is_valid() && stream_playback.is_null()) {
-		stream.unref();
+	if (voice.is_valid()) {
+		stream = p_stream;
+		stream_playback = AudioServer::get_singleton()->voice_get_playback(voice);
+		AudioServer::get_singleton()->voice_set_pitch_scale(voice, pitch_scale);
+		AudioServer::get_singleton()->voice_set_priority(voice, priority);
+		_update_voice_paused();
 	}
 }
 
@@ -302,34 +208,45 @@ float AudioStreamPlayer2D::get_volume_db() const {
 void AudioStreamPlayer2D::set_pitch_scale(float p_pitch_scale) {
 	ERR_FAIL_COND(p_pitch_scale <= 0.0);
 	pitch_scale = p_pitch_scale;
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_set_pitch_scale(voice, pitch_scale);
+	}
 }
 
 float AudioStreamPlayer2D::get_pitch_scale() const {
 	return pitch_scale;
 }
 
-void AudioStreamPlayer2D::play(float p_from_pos) {
-	if (!is_playing()) {
-		// Reset the prev_output_count if the stream is stopped
-		prev_output_count = 0;
+void AudioStreamPlayer2D::set_priority(float p_priority) {
+	ERR_FAIL_COND(p_priority < 0.0);
+	priority = p_priority;
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_set_priority(voice, priority);
 	}
+}
+
+float AudioStreamPlayer2D::get_priority() const {
+	return priority;
+}
 
-	if (stream_playback.is_valid()) {
+void AudioStreamPlayer2D::play(float p_from_pos) {
+	if (voice.is_valid()) {
+		//started in the next physics step, once the outputs are known
 		active = true;
 		setplay = p_from_pos;
-		output_ready = false;
 		set_physics_process_internal(true);
 	}
 }
 
 void AudioStreamPlayer2D::seek(float p_seconds) {
-	if (stream_playback.is_valid()) {
-		setseek = p_seconds;
+	if (voice.is_valid() && active) {
+		setplay = p_seconds;
 	}
 }
 
 void AudioStreamPlayer2D::stop() {
-	if (stream_playback.is_valid()) {
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_stop(voice);
 		active = false;
 		set_physics_process_internal(false);
 		setplay = -1;
@@ -337,26 +254,23 @@ void AudioStreamPlayer2D::stop() {
 }
 
 bool AudioStreamPlayer2D::is_playing() const {
-	if (stream_playback.is_valid()) {
-		return active; // && stream_playback->is_playing();
+	if (voice.is_valid()) {
+		return active;
 	}
 
 	return false;
 }
 
 float AudioStreamPlayer2D::get_playback_position() {
-	if (stream_playback.is_valid()) {
-		return stream_playback->get_playback_position();
+	if (voice.is_valid()) {
+		return AudioServer::get_singleton()->voice_get_playback_position(voice);
 	}
 
 	return 0;
 }
 
 void AudioStreamPlayer2D::set_bus(const StringName &p_bus) {
-	//if audio is active, must lock this
-	AudioServer::get_singleton()->lock();
 	bus = p_bus;
-	AudioServer::get_singleton()->unlock();
 }
 
 StringName AudioStreamPlayer2D::get_bus() const {
@@ -435,8 +349,7 @@ uint32_t AudioStreamPlayer2D::get_area_mask() const {
 void AudioStreamPlayer2D::set_stream_paused(bool p_pause) {
 	if (p_pause != stream_paused) {
 		stream_paused = p_pause;
-		stream_paused_fade_in = !p_pause;
-		stream_paused_fade_out = p_pause;
+		_update_voice_paused();
 	}
 }
 
@@ -458,6 +371,9 @@ void AudioStreamPlayer2D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_pitch_scale", "pitch_scale"), &AudioStreamPlayer2D::set_pitch_scale);
 	ClassDB::bind_method(D_METHOD("get_pitch_scale"), &AudioStreamPlayer2D::get_pitch_scale);
 
+	ClassDB::bind_method(D_METHOD("set_priority", "priority"), &AudioStreamPlayer2D::set_priority);
+	ClassDB::bind_method(D_METHOD("get_priority"), &AudioStreamPlayer2D::get_priority);
+
 	ClassDB::bind_method(D_METHOD("play", "from_position"), &AudioStreamPlayer2D::play, DEFVAL(0.0));
 	ClassDB::bind_method(D_METHOD("seek", "to_position"), &AudioStreamPlayer2D::seek);
 	ClassDB::bind_method(D_METHOD("stop"), &AudioStreamPlayer2D::stop);
@@ -491,6 +407,7 @@ void AudioStreamPlayer2D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "stream", PROPERTY_HINT_RESOURCE_TYPE, "AudioStream"), "set_stream", "get_stream");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "volume_db", PROPERTY_HINT_RANGE, "-80,24"), "set_volume_db", "get_volume_db");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "pitch_scale", PROPERTY_HINT_RANGE, "0.01,4,0.01,or_greater"), "set_pitch_scale", "get_pitch_scale");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "priority", PROPERTY_HINT_RANGE, "0,4,0.01,or_greater"), "set_priority", "get_priority");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "playing", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_EDITOR), "_set_playing", "is_playing");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "autoplay"), "set_autoplay", "is_autoplay_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "stream_paused", PROPERTY_HINT_NONE, ""), "set_stream_paused", "get_stream_paused");
@@ -505,21 +422,19 @@ void AudioStreamPlayer2D::_bind_methods() {
 AudioStreamPlayer2D::AudioStreamPlayer2D() {
 	volume_db = 0;
 	pitch_scale = 1.0;
+	priority = 1.0;
 	autoplay = false;
-	setseek = -1;
 	active = false;
-	output_count = 0;
-	prev_output_count = 0;
 	max_distance = 2000;
 	attenuation = 1;
 	setplay = -1;
-	output_ready = false;
 	area_mask = 1;
 	stream_paused = false;
-	stream_paused_fade_in = false;
-	stream_paused_fade_out = false;
 	AudioServer::get_singleton()->connect("bus_layout_changed", callable_mp(this, &AudioStreamPlayer2D::_bus_layout_changed));
 }
 
 AudioStreamPlayer2D::~AudioStreamPlayer2D() {
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_free(voice);
+	}
 }
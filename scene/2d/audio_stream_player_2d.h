@@ -45,38 +45,22 @@ private:
 
 	};
 
-	struct Output {
-		AudioFrame vol;
-		int bus_index;
-		Viewport *viewport; //pointer only used for reference to previous mix
-	};
-
-	Output outputs[MAX_OUTPUTS];
-	volatile int output_count;
-	volatile bool output_ready;
-
-	//these are used by audio thread to have a reference of previous volumes (for ramping volume and avoiding clicks)
-	Output prev_outputs[MAX_OUTPUTS];
-	int prev_output_count;
-
 	Ref<AudioStreamPlayback> stream_playback;
 	Ref<AudioStream> stream;
-	Vector<AudioFrame> mix_buffer;
+	RID voice;
 
-	volatile float setseek;
-	volatile bool active;
-	volatile float setplay;
+	bool active;
+	float setplay;
 
 	float volume_db;
 	float pitch_scale;
+	float priority;
 	bool autoplay;
 	bool stream_paused;
-	bool stream_paused_fade_in;
-	bool stream_paused_fade_out;
 	StringName bus;
 
-	void _mix_audio();
-	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer2D *>(self)->_mix_audio(); }
+	void _update_voice_targets();
+	void _update_voice_paused();
 
 	void _set_playing(bool p_enable);
 	bool _is_active() const;
@@ -103,6 +87,9 @@ public:
 	void set_pitch_scale(float p_pitch_scale);
 	float get_pitch_scale() const;
 
+	void set_priority(float p_priority);
+	float get_priority() const;
+
 	void play(float p_from_pos = 0.0);
 	void seek(float p_seconds);
 	void stop();
@@ -137,166 +137,6 @@ void AudioStreamPlayer3D::_calc_output_vol(const Vector3 &source_dir, real_t tig
 	}
 }
 
-void AudioStreamPlayer3D::_mix_audio() {
-	if (!stream_playback.is_valid() || !active ||
-			(stream_paused && !stream_paused_fade_out)) {
-		return;
-	}
-
-	bool started = false;
-	if (setseek >= 0.0) {
-		stream_playback->start(setseek);
-		setseek = -1.0; //reset seek
-		started = true;
-	}
-
-	//get data
-	AudioFrame *buffer = mix_buffer.ptrw();
-	int buffer_size = mix_buffer.size();
-
-	if (stream_paused_fade_out) {
-		// Short fadeout ramp
-		buffer_size = MIN(buffer_size, 128);
-	}
-
-	// Mix if we're not paused or we're fading out
-	if ((output_count > 0 || out_of_range_mode == OUT_OF_RANGE_MIX)) {
-		float output_pitch_scale = 0.0;
-		if (output_count) {
-			//used for doppler, not realistic but good enough
-			for (int i = 0; i < output_count; i++) {
-				output_pitch_scale += outputs[i].pitch_scale;
-			}
-			output_pitch_scale /= float(output_count);
-		} else {
-			output_pitch_scale = 1.0;
-		}
-
-		stream_playback->mix(buffer, pitch_scale * output_pitch_scale, buffer_size);
-	}
-
-	//write all outputs
-	for (int i = 0; i < output_count; i++) {
-		Output current = outputs[i];
-
-		//see if current output exists, to keep volume ramp
-		bool found = false;
-		for (int j = i; j < prev_output_count; j++) {
-			if (prev_outputs[j].viewport == current.viewport) {
-				if (j != i) {
-					SWAP(prev_outputs[j], prev_outputs[i]);
-				}
-				found = true;
-				break;
-			}
-		}
-
-		bool interpolate_filter = !started;
-
-		if (!found) {
-			//create new if was not used before
-			if (prev_output_count < MAX_OUTPUTS) {
-				prev_outputs[prev_output_count] = prev_outputs[i]; //may be owned by another viewport
-				prev_output_count++;
-			}
-			prev_outputs[i] = current;
-			interpolate_filter = false;
-		}
-
-		//mix!
-
-		int buffers = AudioServer::get_singleton()->get_channel_count();
-
-		for (int k = 0; k < buffers; k++) {
-			AudioFrame target_volume = stream_paused_fade_out ? AudioFrame(0.f, 0.f) : current.vol[k];
-			AudioFrame vol_prev = stream_paused_fade_in ? AudioFrame(0.f, 0.f) : prev_outputs[i].vol[k];
-			AudioFrame vol_inc = (target_volume - vol_prev) / float(buffer_size);
-			AudioFrame vol = vol_prev;
-
-			if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.bus_index, k)) {
-				continue; //may have been deleted, will be updated on process
-			}
-
-			AudioFrame *target = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.bus_index, k);
-			current.filter.set_mode(AudioFilterSW::HIGHSHELF);
-			current.filter.set_sampling_rate(AudioServer::get_singleton()->get_mix_rate());
-			current.filter.set_cutoff(attenuation_filter_cutoff_hz);
-			current.filter.set_resonance(1);
-			current.filter.set_stages(1);
-			current.filter.set_gain(current.filter_gain);
-
-			if (interpolate_filter) {
-				current.filter_process[k * 2 + 0] = prev_outputs[i].filter_process[k * 2 + 0];
-				current.filter_process[k * 2 + 1] = prev_outputs[i].filter_process[k * 2 + 1];
-
-				current.filter_process[k * 2 + 0].set_filter(&current.filter, false);
-				current.filter_process[k * 2 + 1].set_filter(&current.filter, false);
-
-				current.filter_process[k * 2 + 0].update_coeffs(buffer_size);
-				current.filter_process[k * 2 + 1].update_coeffs(buffer_size);
-				for (int j = 0; j < buffer_size; j++) {
-					AudioFrame f = buffer[j] * vol;
-					current.filter_process[k * 2 + 0].process_one_interp(f.l);
-					current.filter_process[k * 2 + 1].process_one_interp(f.r);
-
-					target[j] += f;
-					vol += vol_inc;
-				}
-			} else {
-				current.filter_process[k * 2 + 0].set_filter(&current.filter);
-				current.filter_process[k * 2 + 1].set_filter(&current.filter);
-
-				current.filter_process[k * 2 + 0].update_coeffs();
-				current.filter_process[k * 2 + 1].update_coeffs();
-				for (int j = 0; j < buffer_size; j++) {
-					AudioFrame f = buffer[j] * vol;
-					current.filter_process[k * 2 + 0].process_one(f.l);
-					current.filter_process[k * 2 + 1].process_one(f.r);
-
-					target[j] += f;
-					vol += vol_inc;
-				}
-			}
-
-			if (current.reverb_bus_index >= 0) {
-				if (!AudioServer::get_singleton()->thread_has_channel_mix_buffer(current.reverb_bus_index, k)) {
-					continue; //may have been deleted, will be updated on process
-				}
-
-				AudioFrame *rtarget = AudioServer::get_singleton()->thread_get_channel_mix_buffer(current.reverb_bus_index, k);
-
-				if (current.reverb_bus_index == prev_outputs[i].reverb_bus_index) {
-					AudioFrame rvol_inc = (current.reverb_vol[k] - prev_outputs[i].reverb_vol[k]) / float(buffer_size);
-					AudioFrame rvol = prev_outputs[i].reverb_vol[k];
-
-					for (int j = 0; j < buffer_size; j++) {
-						rtarget[j] += buffer[j] * rvol;
-						rvol += rvol_inc;
-					}
-				} else {
-					AudioFrame rvol = current.reverb_vol[k];
-					for (int j = 0; j < buffer_size; j++) {
-						rtarget[j] += buffer[j] * rvol;
-					}
-				}
-			}
-		}
-
-		prev_outputs[i] = current;
-	}
-
-	prev_output_count = output_count;
-
-	//stream is no longer active, disable this.
-	if (!stream_playback->is_playing()) {
-		active = false;
-	}
-
-	output_ready = false;
-	stream_paused_fade_in = false;
-	stream_paused_fade_out = false;
-}
-
 float AudioStreamPlayer3D::_get_attenuation_db(float p_distance) const {
 	float att = 0;
 	switch (attenuation_model) {
@@ -327,293 +167,346 @@ float AudioStreamPlayer3D::_get_attenuation_db(float p_distance) const {
 	return att;
 }
 
-void _update_sound() {
-}
+void AudioStreamPlayer3D::_update_voice_targets() {
+	Output outputs[MAX_OUTPUTS];
+	int output_count = 0;
 
-void AudioStreamPlayer3D::_notification(int p_what) {
-	if (p_what == NOTIFICATION_ENTER_TREE) {
-		velocity_tracker->reset(get_global_transform().origin);
-		AudioServer::get_singleton()->add_callback(_mix_audios, this);
-		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
-			play();
-		}
-	}
+	Vector3 linear_velocity;
 
-	if (p_what == NOTIFICATION_EXIT_TREE) {
-		AudioServer::get_singleton()->remove_callback(_mix_audios, this);
+	//compute linear velocity for doppler
+	if (doppler_tracking != DOPPLER_TRACKING_DISABLED) {
+		linear_velocity = velocity_tracker->get_tracked_linear_velocity();
 	}
 
-	if (p_what == NOTIFICATION_PAUSED) {
-		if (!can_process()) {
-			// Node can't process so we start fading out to silence
-			set_stream_paused(true);
+	Ref<World3D> world_3d = get_world_3d();
+	ERR_FAIL_COND(world_3d.is_null());
+
+	Vector3 global_pos = get_global_transform().origin;
+
+
+	//check if any area is diverting sound into a bus
+
+	PhysicsDirectSpaceState3D *space_state = PhysicsServer3D::get_singleton()->space_get_direct_state(world_3d->get_space());
+
+	PhysicsDirectSpaceState3D::ShapeResult sr[MAX_INTERSECT_AREAS];
+
+	int areas = space_state->intersect_point(global_pos, sr, MAX_INTERSECT_AREAS, Set<RID>(), area_mask, false, true);
+	Area3D *area = nullptr;
+
+	for (int i = 0; i < areas; i++) {
+		if (!sr[i].collider) {
+			continue;
 		}
-	}
 
-	if (p_what == NOTIFICATION_UNPAUSED) {
-		set_stream_paused(false);
-	}
+		Area3D *tarea = Object::cast_to<Area3D>(sr[i].collider);
+		if (!tarea) {
+			continue;
+		}
 
-	if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
-		if (doppler_tracking != DOPPLER_TRACKING_DISABLED) {
-			velocity_tracker->update_position(get_global_transform().origin);
+		if (!tarea->is_overriding_audio_bus() && !tarea->is_using_reverb_bus()) {
+			continue;
 		}
+
+		area = tarea;
+		break;
 	}
 
-	if (p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS) {
-		//update anything related to position first, if possible of course
+	List<Camera3D *> cameras;
+	world_3d->get_camera_list(&cameras);
 
-		if (!output_ready) {
-			Vector3 linear_velocity;
+	for (List<Camera3D *>::Element *E = cameras.front(); E; E = E->next()) {
+		Camera3D *camera = E->get();
+		Viewport *vp = camera->get_viewport();
+		if (!vp->is_audio_listener()) {
+			continue;
+		}
 
-			//compute linear velocity for doppler
-			if (doppler_tracking != DOPPLER_TRACKING_DISABLED) {
-				linear_velocity = velocity_tracker->get_tracked_linear_velocity();
-			}
+		bool listener_is_camera = true;
+		Node3D *listener_node = camera;
 
-			Ref<World3D> world_3d = get_world_3d();
-			ERR_FAIL_COND(world_3d.is_null());
+		Listener3D *listener = vp->get_listener();
+		if (listener) {
+			listener_node = listener;
+			listener_is_camera = false;
+		}
+
+		Vector3 local_pos = listener_node->get_global_transform().orthonormalized().affine_inverse().xform(global_pos);
+
+		float dist = local_pos.length();
+
+		Vector3 area_sound_pos;
+		Vector3 listener_area_pos;
+
+		if (area && area->is_using_reverb_bus() && area->get_reverb_uniformity() > 0) {
+			area_sound_pos = space_state->get_closest_point_to_object_volume(area->get_rid(), listener_node->get_global_transform().origin);
+			listener_area_pos = listener_node->get_global_transform().affine_inverse().xform(area_sound_pos);
+		}
 
-			int new_output_count = 0;
+		if (max_distance > 0) {
+			float total_max = max_distance;
 
-			Vector3 global_pos = get_global_transform().origin;
+			if (area && area->is_using_reverb_bus() && area->get_reverb_uniformity() > 0) {
+				total_max = MAX(total_max, listener_area_pos.length());
+			}
+			if (total_max > max_distance) {
+				continue; //can't hear this sound in this listener
+			}
+		}
 
-			int bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus);
+		float multiplier = Math::db2linear(_get_attenuation_db(dist));
+		if (max_distance > 0) {
+			multiplier *= MAX(0, 1.0 - (dist / max_distance));
+		}
 
-			//check if any area is diverting sound into a bus
+		Output output;
+		output.bus = bus;
 
-			PhysicsDirectSpaceState3D *space_state = PhysicsServer3D::get_singleton()->space_get_direct_state(world_3d->get_space());
+		float db_att = (1.0 - MIN(1.0, multiplier)) * attenuation_filter_db;
 
-			PhysicsDirectSpaceState3D::ShapeResult sr[MAX_INTERSECT_AREAS];
+		if (emission_angle_enabled) {
+			Vector3 listenertopos = global_pos - listener_node->get_global_transform().origin;
+			float c = listenertopos.normalized().dot(get_global_transform().basis.get_axis(2).normalized()); //it's z negative
+			float angle = Math::rad2deg(Math::acos(c));
+			if (angle > emission_angle) {
+				db_att -= -emission_angle_filter_attenuation_db;
+			}
+		}
 
-			int areas = space_state->intersect_point(global_pos, sr, MAX_INTERSECT_AREAS, Set<RID>(), area_mask, false, true);
-			Area3D *area = nullptr;
+		output.filter_gain = Math::db2linear(db_att);
 
-			for (int i = 0; i < areas; i++) {
-				if (!sr[i].collider) {
-					continue;
-				}
+		//TODO: The lower the second parameter (tightness) the more the sound will "enclose" the listener (more undirected / playing from
+		//      speakers not facing the source) - this could be made distance dependent.
+		_calc_output_vol(local_pos.normalized(), 4.0, output);
 
-				Area3D *tarea = Object::cast_to<Area3D>(sr[i].collider);
-				if (!tarea) {
-					continue;
-				}
+		unsigned int cc = AudioServer::get_singleton()->get_channel_count();
+		for (unsigned int k = 0; k < cc; k++) {
+			output.vol[k] *= multiplier;
+		}
 
-				if (!tarea->is_overriding_audio_bus() && !tarea->is_using_reverb_bus()) {
-					continue;
-				}
+		bool filled_reverb = false;
+		int vol_index_max = AudioServer::get_singleton()->get_speaker_mode() + 1;
 
-				area = tarea;
-				break;
+		if (area) {
+			if (area->is_overriding_audio_bus()) {
+				//override audio bus
+				output.bus = area->get_audio_bus();
 			}
 
-			List<Camera3D *> cameras;
-			world_3d->get_camera_list(&cameras);
+			if (area->is_using_reverb_bus()) {
+				filled_reverb = true;
+				output.reverb_bus = area->get_reverb_bus();
 
-			for (List<Camera3D *>::Element *E = cameras.front(); E; E = E->next()) {
-				Camera3D *camera = E->get();
-				Viewport *vp = camera->get_viewport();
-				if (!vp->is_audio_listener()) {
-					continue;
-				}
+				float uniformity = area->get_reverb_uniformity();
+				float area_send = area->get_reverb_amount();
 
-				bool listener_is_camera = true;
-				Node3D *listener_node = camera;
+				if (uniformity > 0.0) {
+					float distance = listener_area_pos.length();
+					float attenuation = Math::db2linear(_get_attenuation_db(distance));
 
-				Listener3D *listener = vp->get_listener();
-				if (listener) {
-					listener_node = listener;
-					listener_is_camera = false;
-				}
+					//float dist_att_db = -20 * Math::log(dist + 0.00001); //logarithmic attenuation, like in real life
+
+					float center_val[3] = { 0.5f, 0.25f, 0.16666f };
+					AudioFrame center_frame(center_val[vol_index_max - 1], center_val[vol_index_max - 1]);
 
-				Vector3 local_pos = listener_node->get_global_transform().orthonormalized().affine_inverse().xform(global_pos);
+					if (attenuation < 1.0) {
+						//pan the uniform sound
+						Vector3 rev_pos = listener_area_pos;
+						rev_pos.y = 0;
+						rev_pos.normalize();
 
-				float dist = local_pos.length();
+						if (cc >= 1) {
+							// Stereo pair
+							float c = rev_pos.x * 0.5 + 0.5;
+							output.reverb_vol[0].l = 1.0 - c;
+							output.reverb_vol[0].r = c;
+						}
 
-				Vector3 area_sound_pos;
-				Vector3 listener_area_pos;
+						if (cc >= 3) {
+							// Center pair + Side pair
+							float xl = Vector3(-1, 0, -1).normalized().dot(rev_pos) * 0.5 + 0.5;
+							float xr = Vector3(1, 0, -1).normalized().dot(rev_pos) * 0.5 + 0.5;
 
-				if (area && area->is_using_reverb_bus() && area->get_reverb_uniformity() > 0) {
-					area_sound_pos = space_state->get_closest_point_to_object_volume(area->get_rid(), listener_node->get_global_transform().origin);
-					listener_area_pos = listener_node->get_global_transform().affine_inverse().xform(area_sound_pos);
-				}
+							output.reverb_vol[1].l = xl;
+							output.reverb_vol[1].r = xr;
+							output.reverb_vol[2].l = 1.0 - xr;
+							output.reverb_vol[2].r = 1.0 - xl;
+						}
 
-				if (max_distance > 0) {
-					float total_max = max_distance;
+						if (cc >= 4) {
+							// Rear pair
+							// FIXME: Not sure what math should be done here
+							float c = rev_pos.x * 0.5 + 0.5;
+							output.reverb_vol[3].l = 1.0 - c;
+							output.reverb_vol[3].r = c;
+						}
 
-					if (area && area->is_using_reverb_bus() && area->get_reverb_uniformity() > 0) {
-						total_max = MAX(total_max, listener_area_pos.length());
+						for (int i = 0; i < vol_index_max; i++) {
+							output.reverb_vol[i] = output.reverb_vol[i].lerp(center_frame, attenuation);
+						}
+					} else {
+						for (int i = 0; i < vol_index_max; i++) {
+							output.reverb_vol[i] = center_frame;
+						}
 					}
-					if (total_max > max_distance) {
-						continue; //can't hear this sound in this listener
+
+					for (int i = 0; i < vol_index_max; i++) {
+						output.reverb_vol[i] = output.vol[i].lerp(output.reverb_vol[i] * attenuation, uniformity);
+						output.reverb_vol[i] *= area_send;
 					}
-				}
 
-				float multiplier = Math::db2linear(_get_attenuation_db(dist));
-				if (max_distance > 0) {
-					multiplier *= MAX(0, 1.0 - (dist / max_distance));
+				} else {
+					for (int i = 0; i < vol_index_max; i++) {
+						output.reverb_vol[i] = output.vol[i] * area_send;
+					}
 				}
+			}
+		}
 
-				Output output;
-				output.bus_index = bus_index;
-				output.reverb_bus_index = -1; //no reverb by default
-				output.viewport = vp;
+		if (doppler_tracking != DOPPLER_TRACKING_DISABLED) {
+			Vector3 listener_velocity;
 
-				float db_att = (1.0 - MIN(1.0, multiplier)) * attenuation_filter_db;
+			if (listener_is_camera) {
+				listener_velocity = camera->get_doppler_tracked_velocity();
+			}
 
-				if (emission_angle_enabled) {
-					Vector3 listenertopos = global_pos - listener_node->get_global_transform().origin;
-					float c = listenertopos.normalized().dot(get_global_transform().basis.get_axis(2).normalized()); //it's z negative
-					float angle = Math::rad2deg(Math::acos(c));
-					if (angle > emission_angle) {
-						db_att -= -emission_angle_filter_attenuation_db;
-					}
-				}
+			Vector3 local_velocity = listener_node->get_global_transform().orthonormalized().basis.xform_inv(linear_velocity - listener_velocity);
 
-				output.filter_gain = Math::db2linear(db_att);
+			if (local_velocity == Vector3()) {
+				output.pitch_scale = 1.0;
+			} else {
+				float approaching = local_pos.normalized().dot(local_velocity.normalized());
+				float velocity = local_velocity.length();
+				float speed_of_sound = 343.0;
 
-				//TODO: The lower the second parameter (tightness) the more the sound will "enclose" the listener (more undirected / playing from
-				//      speakers not facing the source) - this could be made distance dependent.
-				_calc_output_vol(local_pos.normalized(), 4.0, output);
+				output.pitch_scale = speed_of_sound / (speed_of_sound + velocity * approaching);
+				output.pitch_scale = CLAMP(output.pitch_scale, (1 / 8.0), 8.0); //avoid crazy stuff
+			}
 
-				unsigned int cc = AudioServer::get_singleton()->get_channel_count();
-				for (unsigned int k = 0; k < cc; k++) {
-					output.vol[k] *= multiplier;
-				}
+		} else {
+			output.pitch_scale = 1.0;
+		}
 
-				bool filled_reverb = false;
-				int vol_index_max = AudioServer::get_singleton()->get_speaker_mode() + 1;
+		if (!filled_reverb) {
+			for (int i = 0; i < vol_index_max; i++) {
+				output.reverb_vol[i] = AudioFrame(0, 0);
+			}
+		}
 
-				if (area) {
-					if (area->is_overriding_audio_bus()) {
-						//override audio bus
-						StringName bus_name = area->get_audio_bus();
-						output.bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus_name);
-					}
+		outputs[output_count] = output;
+		output_count++;
+		if (output_count == MAX_OUTPUTS) {
+			break;
+		}
+	}
 
-					if (area->is_using_reverb_bus()) {
-						filled_reverb = true;
-						StringName bus_name = area->get_reverb_bus();
-						output.reverb_bus_index = AudioServer::get_singleton()->thread_find_bus_index(bus_name);
-
-						float uniformity = area->get_reverb_uniformity();
-						float area_send = area->get_reverb_amount();
-
-						if (uniformity > 0.0) {
-							float distance = listener_area_pos.length();
-							float attenuation = Math::db2linear(_get_attenuation_db(distance));
-
-							//float dist_att_db = -20 * Math::log(dist + 0.00001); //logarithmic attenuation, like in real life
-
-							float center_val[3] = { 0.5f, 0.25f, 0.16666f };
-							AudioFrame center_frame(center_val[vol_index_max - 1], center_val[vol_index_max - 1]);
-
-							if (attenuation < 1.0) {
-								//pan the uniform sound
-								Vector3 rev_pos = listener_area_pos;
-								rev_pos.y = 0;
-								rev_pos.normalize();
-
-								if (cc >= 1) {
-									// Stereo pair
-									float c = rev_pos.x * 0.5 + 0.5;
-									output.reverb_vol[0].l = 1.0 - c;
-									output.reverb_vol[0].r = c;
-								}
-
-								if (cc >= 3) {
-									// Center pair + Side pair
-									float xl = Vector3(-1, 0, -1).normalized().dot(rev_pos) * 0.5 + 0.5;
-									float xr = Vector3(1, 0, -1).normalized().dot(rev_pos) * 0.5 + 0.5;
-
-									output.reverb_vol[1].l = xl;
-									output.reverb_vol[1].r = xr;
-									output.reverb_vol[2].l = 1.0 - xr;
-									output.reverb_vol[2].r = 1.0 - xl;
-								}
-
-								if (cc >= 4) {
-									// Rear pair
-									// FIXME: Not sure what math should be done here
-									float c = rev_pos.x * 0.5 + 0.5;
-									output.reverb_vol[3].l = 1.0 - c;
-									output.reverb_vol[3].r = c;
-								}
-
-								for (int i = 0; i < vol_index_max; i++) {
-									output.reverb_vol[i] = output.reverb_vol[i].lerp(center_frame, attenuation);
-								}
-							} else {
-								for (int i = 0; i < vol_index_max; i++) {
-									output.reverb_vol[i] = center_frame;
-								}
-							}
-
-							for (int i = 0; i < vol_index_max; i++) {
-								output.reverb_vol[i] = output.vol[i].lerp(output.reverb_vol[i] * attenuation, uniformity);
-								output.reverb_vol[i] *= area_send;
-							}
-
-						} else {
-							for (int i = 0; i < vol_index_max; i++) {
-								output.reverb_vol[i] = output.vol[i] * area_send;
-							}
-						}
-					}
-				}
+	//each output goes to its bus and, when in a reverb area, also to the reverb bus
+	AudioServer::VoiceTarget targets[AudioServer::MAX_BUSES_PER_VOICE];
+	int target_count = 0;
+	float output_pitch_scale = 0.0;
+	int cc = MIN(AudioServer::get_singleton()->get_channel_count(), (int)AudioServer::MAX_CHANNELS_PER_BUS);
 
-				if (doppler_tracking != DOPPLER_TRACKING_DISABLED) {
-					Vector3 listener_velocity;
+	for (int i = 0; i < output_count; i++) {
+		const Output &output = outputs[i];
+		int needed = output.reverb_bus == StringName() ? 1 : 2;
+		if (target_count + needed > AudioServer::MAX_BUSES_PER_VOICE) {
+			break;
+		}
 
-					if (listener_is_camera) {
-						listener_velocity = camera->get_doppler_tracked_velocity();
-					}
+		AudioServer::VoiceTarget &target = targets[target_count++];
+		target.bus = output.bus;
+		target.highshelf_gain = output.filter_gain;
+		for (int k = 0; k < cc; k++) {
+			target.volume[k] = output.vol[k];
+		}
 
-					Vector3 local_velocity = listener_node->get_global_transform().orthonormalized().basis.xform_inv(linear_velocity - listener_velocity);
+		if (needed == 2) {
+			AudioServer::VoiceTarget &reverb_target = targets[target_count++];
+			reverb_target.bus = output.reverb_bus;
+			for (int k = 0; k < cc; k++) {
+				reverb_target.volume[k] = output.reverb_vol[k];
+			}
+		}
 
-					if (local_velocity == Vector3()) {
-						output.pitch_scale = 1.0;
-					} else {
-						float approaching = local_pos.normalized().dot(local_velocity.normalized());
-						float velocity = local_velocity.length();
-						float speed_of_sound = 343.0;
+		//used for doppler, not realistic but good enough
+		output_pitch_scale += output.pitch_scale;
+	}
 
-						output.pitch_scale = speed_of_sound / (speed_of_sound + velocity * approaching);
-						output.pitch_scale = CLAMP(output.pitch_scale, (1 / 8.0), 8.0); //avoid crazy stuff
-					}
+	if (output_count) {
+		output_pitch_scale /= float(output_count);
+	} else {
+		output_pitch_scale = 1.0;
+	}
 
-				} else {
-					output.pitch_scale = 1.0;
-				}
+	AudioServer::get_singleton()->voice_set_targets(voice, targets, target_count);
+	AudioServer::get_singleton()->voice_set_pitch_scale(voice, pitch_scale * output_pitch_scale);
 
-				if (!filled_reverb) {
-					for (int i = 0; i < vol_index_max; i++) {
-						output.reverb_vol[i] = AudioFrame(0, 0);
-					}
-				}
+	bool paused = output_count == 0 && out_of_range_mode == OUT_OF_RANGE_PAUSE;
+	if (paused != out_of_range_paused) {
+		out_of_range_paused = paused;
+		_update_voice_paused();
+	}
+}
 
-				outputs[new_output_count] = output;
-				new_output_count++;
-				if (new_output_count == MAX_OUTPUTS) {
-					break;
-				}
-			}
+void AudioStreamPlayer3D::_update_voice_paused() {
+	if (voice.is_valid()) {
+		//not mixed while outside the tree, like any node that can't process
+		AudioServer::get_singleton()->voice_set_paused(voice, stream_paused || out_of_range_paused || !is_inside_tree());
+	}
+}
 
-			output_count = new_output_count;
-			output_ready = true;
+void _update_sound() {
+}
+
+void AudioStreamPlayer3D::_notification(int p_what) {
+	if (p_what == NOTIFICATION_ENTER_TREE) {
+		velocity_tracker->reset(get_global_transform().origin);
+		_update_voice_paused();
+		if (autoplay && !Engine::get_singleton()->is_editor_hint()) {
+			play();
+		}
+	}
+
+	if (p_what == NOTIFICATION_EXIT_TREE) {
+		if (voice.is_valid()) {
+			AudioServer::get_singleton()->voice_set_paused(voice, true);
+		}
+	}
+
+	if (p_what == NOTIFICATION_PAUSED) {
+		if (!can_process()) {
+			// Node can't process so we start fading out to silence
+			set_stream_paused(true);
+		}
+	}
+
+	if (p_what == NOTIFICATION_UNPAUSED) {
+		set_stream_paused(false);
+	}
+
+	if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+		if (doppler_tracking != DOPPLER_TRACKING_DISABLED) {
+			velocity_tracker->update_position(get_global_transform().origin);
+		}
+	}
+
+	if (p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS) {
+		//update anything related to position first, if possible of course
+
+		if (voice.is_valid()) {
+			_update_voice_targets();
 		}
 
 		//start playing if requested
 		if (setplay >= 0.0) {
-			setseek = setplay;
-			active = true;
+			AudioServer::get_singleton()->voice_play(voice, setplay);
 			setplay = -1;
 			//do not update, this makes it easier to animate (will shut off otherwise)
 			///_change_notify("playing"); //update property in editor
 		}
 
 		//stop playing if no longer active
-		if (!active) {
+		if (!active || !AudioServer::get_singleton()->voice_is_playing(voice)) {
+			active = false;
 			set_physics_process_internal(false);
 			//do not update, this makes it easier to animate (will shut off otherwise)
 			//_change_notify("playing"); //update property in editor
@@ -623,26 +516,26 @@ void AudioStreamPlayer3D::_notification(int p_what) {
 }
 
 void AudioStreamPlayer3D::set_stream(Ref<AudioStream> p_stream) {
-	AudioServer::get_singleton()->lock();
-
-	mix_buffer.resize(AudioServer::get_singleton()->thread_get_mix_buffer_size());
-
-	if (stream_playback.is_valid()) {
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_free(voice);
+		voice = RID();
 		stream_playback.unref();
 		stream.unref();
 		active = false;
-		setseek = -1;
+		setplay = -1;
 	}
 
 	if (p_stream.is_valid()) {
-		stream = p_stream;
-		stream_playback = p_stream->instance_playback();
+		voice = AudioServer::get_singleton()->voice_create(p_stream);
 	}
 
-	AudioServer::get_singleton()->unlock();
-
-	if (p_stream.is_valid() && stream_playback.is_null()) {
-		stream.unref();
+	if (voice.is_valid()) {
+		stream = p_stream;
+		stream_playback = AudioServer::get_singleton()->voice_get_playback(voice);
+		AudioServer::get_singleton()->voice_set_pitch_scale(voice, pitch_scale);
+		AudioServer::get_singleton()->voice_set_priority(voice, priority);
+		AudioServer::get_singleton()->voice_set_highshelf_cutoff(voice, attenuation_filter_cutoff_hz);
+		_update_voice_paused();
 	}
 }
 
@@ -683,28 +576,36 @@ float AudioStreamPlayer3D::get_pitch_scale() const {
 	return pitch_scale;
 }
 
-void AudioStreamPlayer3D::play(float p_from_pos) {
-	if (!is_playing()) {
-		// Reset the prev_output_count if the stream is stopped
-		prev_output_count = 0;
+void AudioStreamPlayer3D::set_priority(float p_priority) {
+	ERR_FAIL_COND(p_priority < 0.0);
+	priority = p_priority;
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_set_priority(voice, priority);
 	}
+}
 
-	if (stream_playback.is_valid()) {
+float AudioStreamPlayer3D::get_priority() const {
+	return priority;
+}
+
+void AudioStreamPlayer3D::play(float p_from_pos) {
+	if (voice.is_valid()) {
+		//started in the next physics step, once the outputs are known
 		active = true;
 		setplay = p_from_pos;
-		output_ready = false;
 		set_physics_process_internal(true);
 	}
 }
 
 void AudioStreamPlayer3D::seek(float p_seconds) {
-	if (stream_playback.is_valid()) {
-		setseek = p_seconds;
+	if (voice.is_valid() && active) {
+		setplay = p_seconds;
 	}
 }
 
 void AudioStreamPlayer3D::stop() {
-	if (stream_playback.is_valid()) {
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_stop(voice);
 		active = false;
 		set_physics_process_internal(false);
 		setplay = -1;
@@ -712,26 +613,23 @@ void AudioStreamPlayer3D::stop() {
 }
 
 bool AudioStreamPlayer3D::is_playing() const {
-	if (stream_playback.is_valid()) {
-		return active; // && stream_playback->is_playing();
+	if (voice.is_valid()) {
+		return active;
 	}
 
 	return false;
 }
 
 float AudioStreamPlayer3D::get_playback_position() {
-	if (stream_playback.is_valid()) {
-		return stream_playback->get_playback_position();
+	if (voice.is_valid()) {
+		return AudioServer::get_singleton()->voice_get_playback_position(voice);
 	}
 
 	return 0;
 }
 
 void AudioStreamPlayer3D::set_bus(const StringName &p_bus) {
-	//if audio is active, must lock this
-	AudioServer::get_singleton()->lock();
 	bus = p_bus;
-	AudioServer::get_singleton()->unlock();
 }
 
 StringName AudioStreamPlayer3D::get_bus() const {
@@ -829,6 +727,9 @@ float AudioStreamPlayer3D::get_emission_angle_filter_attenuation_db() const {
 
 void AudioStreamPlayer3D::set_attenuation_filter_cutoff_hz(float p_hz) {
 	attenuation_filter_cutoff_hz = p_hz;
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_set_highshelf_cutoff(voice, attenuation_filter_cutoff_hz);
+	}
 }
 
 float AudioStreamPlayer3D::get_attenuation_filter_cutoff_hz() const {
@@ -886,8 +787,7 @@ AudioStreamPlayer3D::DopplerTracking AudioStreamPlayer3D::get_doppler_tracking()
 void AudioStreamPlayer3D::set_stream_paused(bool p_pause) {
 	if (p_pause != stream_paused) {
 		stream_paused = p_pause;
-		stream_paused_fade_in = !stream_paused;
-		stream_paused_fade_out = stream_paused;
+		_update_voice_paused();
 	}
 }
 
@@ -915,6 +815,9 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_pitch_scale", "pitch_scale"), &AudioStreamPlayer3D::set_pitch_scale);
 	ClassDB::bind_method(D_METHOD("get_pitch_scale"), &AudioStreamPlayer3D::get_pitch_scale);
 
+	ClassDB::bind_method(D_METHOD("set_priority", "priority"), &AudioStreamPlayer3D::set_priority);
+	ClassDB::bind_method(D_METHOD("get_priority"), &AudioStreamPlayer3D::get_priority);
+
 	ClassDB::bind_method(D_METHOD("play", "from_position"), &AudioStreamPlayer3D::play, DEFVAL(0.0));
 	ClassDB::bind_method(D_METHOD("seek", "to_position"), &AudioStreamPlayer3D::seek);
 	ClassDB::bind_method(D_METHOD("stop"), &AudioStreamPlayer3D::stop);
@@ -972,6 +875,7 @@ void AudioStreamPlayer3D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "unit_size", PROPERTY_HINT_RANGE, "0.1,100,0.1"), "set_unit_size", "get_unit_size");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_db", PROPERTY_HINT_RANGE, "-24,6"), "set_max_db", "get_max_db");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "pitch_scale", PROPERTY_HINT_RANGE, "0.01,4,0.01,or_greater"), "set_pitch_scale", "get_pitch_scale");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "priority", PROPERTY_HINT_RANGE, "0,4,0.01,or_greater"), "set_priority", "get_priority");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "playing", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_EDITOR), "_set_playing", "is_playing");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "autoplay"), "set_autoplay", "is_autoplay_enabled");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "stream_paused", PROPERTY_HINT_NONE, ""), "set_stream_paused", "get_stream_paused");
@@ -1010,14 +914,12 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 	attenuation_model = ATTENUATION_INVERSE_DISTANCE;
 	max_db = 3;
 	pitch_scale = 1.0;
+	priority = 1.0;
 	autoplay = false;
-	setseek = -1;
 	active = false;
-	output_count = 0;
-	prev_output_count = 0;
 	max_distance = 0;
 	setplay = -1;
-	output_ready = false;
+	out_of_range_paused = false;
 	area_mask = 1;
 	emission_angle = 45;
 	emission_angle_enabled = false;
@@ -1027,8 +929,6 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 	out_of_range_mode = OUT_OF_RANGE_MIX;
 	doppler_tracking = DOPPLER_TRACKING_DISABLED;
 	stream_paused = false;
-	stream_paused_fade_in = false;
-	stream_paused_fade_out = false;
 
 	velocity_tracker.instance();
 	AudioServer::get_singleton()->connect("bus_layout_changed", callable_mp(this, &AudioStreamPlayer3D::_bus_layout_changed));
@@ -1036,4 +936,7 @@ AudioStreamPlayer3D::AudioStreamPlayer3D() {
 }
 
 AudioStreamPlayer3D::~AudioStreamPlayer3D() {
+	if (voice.is_valid()) {
+		AudioServer::get_singleton()->voice_free(voice);
+	}
 }
@@ -33,7 +33,6 @@
 
 #include "scene/3d/node_3d.h"
 #include "scene/3d/velocity_tracker_3d.h"
-#include "servers/audio/audio_filter_sw.h"
 #include "servers/audio/audio_stream.h"
 #include "servers/audio_server.h"
 
@@ -68,54 +67,35 @@ private:
 	};
 
 	struct Output {
-		AudioFilterSW filter;
-		AudioFilterSW::Processor filter_process[8];
 		AudioFrame vol[4];
-		float filter_gain;
-		float pitch_scale;
-		int bus_index;
-		int reverb_bus_index;
+		float filter_gain = 0;
+		float pitch_scale = 1.0;
+		StringName bus;
+		StringName reverb_bus; //empty if not using reverb
 		AudioFrame reverb_vol[4];
-		Viewport *viewport; //pointer only used for reference to previous mix
-
-		Output() {
-			filter_gain = 0;
-			viewport = nullptr;
-			reverb_bus_index = -1;
-			bus_index = -1;
-		}
 	};
 
-	Output outputs[MAX_OUTPUTS];
-	volatile int output_count;
-	volatile bool output_ready;
-
-	//these are used by audio thread to have a reference of previous volumes (for ramping volume and avoiding clicks)
-	Output prev_outputs[MAX_OUTPUTS];
-	int prev_output_count;
-
 	Ref<AudioStreamPlayback> stream_playback;
 	Ref<AudioStream> stream;
-	Vector<AudioFrame> mix_buffer;
+	RID voice;
 
-	volatile float setseek;
-	volatile bool active;
-	volatile float setplay;
+	bool active;
+	float setplay;
+	bool out_of_range_paused;
 
 	AttenuationModel attenuation_model;
 	float unit_db;
 	float unit_size;
 	float max_db;
 	float pitch_scale;
+	float priority;
 	bool autoplay;
 	bool stream_paused;
-	bool stream_paused_fade_in;
-	bool stream_paused_fade_out;
 	StringName bus;
 
 	static void _calc_output_vol(const Vector3 &source_dir, real_t tightness, Output &output);
-	void _mix_audio();
-	static void _mix_audios(void *self) { reinterpret_cast<AudioStreamPlayer3D *>(self)->_mix_audio(); }
+	void _update_voice_targets();
+	void _update_voice_paused();
 
 	void _set_playing(bool p_enable);
 	bool _is_active() const;
@@ -161,6 +141,9 @@ public:
 	void set_pitch_scale(float p_pitch_scale);
 	float get_pitch_scale() const;
 
+	void set_priority(float p_priority);
+	float get_priority() const;
+
 	void play(float p_from_pos = 0.0);
 	void seek(float p_seconds);
 	void stop();
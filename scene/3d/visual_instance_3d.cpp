@@ -188,7 +188,44 @@ float GeometryInstance3D::get_lod_max_hysteresis() const {
 	return lod_max_hysteresis;
 }
 
+void GeometryInstance3D::_resolve_lod_parent_path() {
+	RID parent_instance;
+	if (!lod_parent_path.is_empty()) {
+		GeometryInstance3D *parent = Object::cast_to<GeometryInstance3D>(get_node_or_null(lod_parent_path));
+		if (parent) {
+			parent_instance = parent->get_instance();
+		}
+	}
+	RS::get_singleton()->instance_geometry_set_as_instance_lod(get_instance(), parent_instance);
+}
+
+void GeometryInstance3D::set_lod_parent_path(const NodePath &p_path) {
+	lod_parent_path = p_path;
+	if (!is_inside_tree()) {
+		return;
+	}
+	_resolve_lod_parent_path();
+}
+
+NodePath GeometryInstance3D::get_lod_parent_path() const {
+	return lod_parent_path;
+}
+
 void GeometryInstance3D::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_ENTER_TREE:
+		case NOTIFICATION_READY: {
+			// Also done when ready, in case the parent is a sibling further down the tree.
+			if (!lod_parent_path.is_empty()) {
+				_resolve_lod_parent_path();
+			}
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+			if (!lod_parent_path.is_empty()) {
+				RS::get_singleton()->instance_geometry_set_as_instance_lod(get_instance(), RID());
+			}
+		} break;
+	}
 }
 
 const StringName *GeometryInstance3D::_instance_uniform_get_remap(const StringName p_name) const {
@@ -352,6 +389,9 @@ void GeometryInstance3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_lod_min_distance", "mode"), &GeometryInstance3D::set_lod_min_distance);
 	ClassDB::bind_method(D_METHOD("get_lod_min_distance"), &GeometryInstance3D::get_lod_min_distance);
 
+	ClassDB::bind_method(D_METHOD("set_lod_parent_path", "path"), &GeometryInstance3D::set_lod_parent_path);
+	ClassDB::bind_method(D_METHOD("get_lod_parent_path"), &GeometryInstance3D::get_lod_parent_path);
+
 	ClassDB::bind_method(D_METHOD("set_extra_cull_margin", "margin"), &GeometryInstance3D::set_extra_cull_margin);
 	ClassDB::bind_method(D_METHOD("get_extra_cull_margin"), &GeometryInstance3D::get_extra_cull_margin);
 
@@ -374,10 +414,11 @@ void GeometryInstance3D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "gi_lightmap_scale", PROPERTY_HINT_ENUM, "1x,2x,4x,8x"), "set_lightmap_scale", "get_lightmap_scale");
 
 	ADD_GROUP("LOD", "lod_");
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_min_distance", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_min_distance", "get_lod_min_distance");
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_min_hysteresis", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_min_hysteresis", "get_lod_min_hysteresis");
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_max_distance", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_max_distance", "get_lod_max_distance");
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_max_hysteresis", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_max_hysteresis", "get_lod_max_hysteresis");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_min_distance", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_min_distance", "get_lod_min_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_min_hysteresis", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_min_hysteresis", "get_lod_min_hysteresis");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_max_distance", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_max_distance", "get_lod_max_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lod_max_hysteresis", PROPERTY_HINT_RANGE, "0,32768,0.01"), "set_lod_max_hysteresis", "get_lod_max_hysteresis");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "lod_parent", PROPERTY_HINT_NODE_PATH_VALID_TYPES, "GeometryInstance3D"), "set_lod_parent_path", "get_lod_parent_path");
 
 	//ADD_SIGNAL( MethodInfo("visibility_changed"));
 
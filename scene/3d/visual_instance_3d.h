@@ -111,6 +111,7 @@ private:
 	float lod_max_distance;
 	float lod_min_hysteresis;
 	float lod_max_hysteresis;
+	NodePath lod_parent_path;
 
 	mutable HashMap<StringName, Variant> instance_uniforms;
 	mutable HashMap<StringName, StringName> instance_uniform_property_remap;
@@ -120,6 +121,7 @@ private:
 	GIMode gi_mode;
 
 	const StringName *_instance_uniform_get_remap(const StringName p_name) const;
+	void _resolve_lod_parent_path();
 
 protected:
 	bool _set(const StringName &p_name, const Variant &p_value);
@@ -145,6 +147,9 @@ public:
 	void set_lod_max_hysteresis(float p_dist);
 	float get_lod_max_hysteresis() const;
 
+	void set_lod_parent_path(const NodePath &p_path);
+	NodePath get_lod_parent_path() const;
+
 	void set_material_override(const Ref<Material> &p_material);
 	Ref<Material> get_material_override() const;
 
@@ -46,6 +46,7 @@
 #include "scene/resources/material.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/packed_scene.h"
+#include "scene/resources/texture_streamer.h"
 #include "scene/scene_string_names.h"
 #include "servers/display_server.h"
 #include "servers/navigation_server_3d.h"
@@ -455,6 +456,11 @@ bool SceneTree::idle(float p_time) {
 
 	_flush_delete_queue();
 
+	if (TextureStreamer::get_singleton()) {
+		// Loads the mipmaps needed by the textures drawn in the last frames.
+		TextureStreamer::get_singleton()->update();
+	}
+
 	//go through timers
 
 	List<Ref<SceneTreeTimer>>::Element *L = timers.back(); //last element
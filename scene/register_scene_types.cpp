@@ -166,6 +166,7 @@
 #include "scene/resources/syntax_highlighter.h"
 #include "scene/resources/text_file.h"
 #include "scene/resources/texture.h"
+#include "scene/resources/texture_streamer.h"
 #include "scene/resources/tile_set.h"
 #include "scene/resources/video_stream.h"
 #include "scene/resources/visual_shader.h"
@@ -230,6 +231,7 @@ static Ref<ResourceFormatLoaderDynamicFont> resource_loader_dynamic_font;
 
 static Ref<ResourceFormatLoaderStreamTexture2D> resource_loader_stream_texture;
 static Ref<ResourceFormatLoaderStreamTextureLayered> resource_loader_texture_layered;
+static TextureStreamer *texture_streamer = nullptr;
 
 static Ref<ResourceFormatLoaderBMFont> resource_loader_bmfont;
 
@@ -252,6 +254,18 @@ void register_scene_types() {
 	resource_loader_texture_layered.instance();
 	ResourceLoader::add_resource_format_loader(resource_loader_texture_layered);
 
+	texture_streamer = memnew(TextureStreamer);
+	bool texture_streaming = GLOBAL_DEF_RST("rendering/texture_streaming/enabled", false);
+	int texture_streaming_budget = GLOBAL_DEF_RST("rendering/texture_streaming/memory_budget_mb", 512);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/memory_budget_mb", PropertyInfo(Variant::INT, "rendering/texture_streaming/memory_budget_mb", PROPERTY_HINT_RANGE, "16,16384,1,or_greater"));
+	int texture_streaming_initial_size = GLOBAL_DEF_RST("rendering/texture_streaming/initial_size", 64);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/initial_size", PropertyInfo(Variant::INT, "rendering/texture_streaming/initial_size", PROPERTY_HINT_RANGE, "4,1024,1"));
+	int texture_streaming_threads = GLOBAL_DEF_RST("rendering/texture_streaming/loading_threads", 1);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/loading_threads", PropertyInfo(Variant::INT, "rendering/texture_streaming/loading_threads", PROPERTY_HINT_RANGE, "0,8,1"));
+	if (texture_streaming) {
+		texture_streamer->init(texture_streaming_threads, uint64_t(texture_streaming_budget) * 1024 * 1024, texture_streaming_initial_size);
+	}
+
 	resource_saver_text.instance();
 	ResourceSaver::add_resource_format_saver(resource_saver_text, true);
 
@@ -949,6 +963,9 @@ void unregister_scene_types() {
 	ResourceLoader::remove_resource_format_loader(resource_loader_stream_texture);
 	resource_loader_stream_texture.unref();
 
+	memdelete(texture_streamer);
+	texture_streamer = nullptr;
+
 	DynamicFont::finish_dynamic_fonts();
 
 	ResourceSaver::remove_resource_format_saver(resource_saver_text);
@@ -86,6 +86,82 @@ void AudioStreamPlaybackSample::seek(float p_time) {
 	offset = uint64_t(p_time * base->mix_rate) << MIX_FRAC_BITS;
 }
 
+void AudioStreamPlaybackSample::skip(float p_time) {
+	if (!base->data || !active) {
+		return;
+	}
+
+	if (base->format == AudioStreamSample::FORMAT_IMA_ADPCM) {
+		return; //decoder state can't be advanced without decoding
+	}
+
+	int len = base->data_bytes;
+	if (base->format == AudioStreamSample::FORMAT_16_BITS) {
+		len /= 2;
+	}
+	if (base->stereo) {
+		len /= 2;
+	}
+
+	int64_t amount = int64_t(double(p_time) * base->mix_rate * MIX_FRAC_LEN);
+	int64_t loop_begin_fp = ((int64_t)base->loop_begin << MIX_FRAC_BITS);
+	int64_t loop_end_fp = ((int64_t)base->loop_end << MIX_FRAC_BITS);
+	int64_t loop_len_fp = loop_end_fp - loop_begin_fp;
+	int64_t length_fp = ((int64_t)len << MIX_FRAC_BITS);
+
+	AudioStreamSample::LoopMode loop_mode = base->loop_mode;
+	if (loop_len_fp <= 0) {
+		loop_mode = AudioStreamSample::LOOP_DISABLED;
+	}
+
+	switch (loop_mode) {
+		case AudioStreamSample::LOOP_DISABLED: {
+			offset += amount;
+			if (offset >= length_fp) {
+				active = false;
+			}
+		} break;
+		case AudioStreamSample::LOOP_FORWARD: {
+			offset += amount;
+			if (offset >= loop_end_fp) {
+				offset = loop_begin_fp + (offset - loop_begin_fp) % loop_len_fp;
+			}
+		} break;
+		case AudioStreamSample::LOOP_BACKWARD: {
+			offset -= amount;
+			if (offset < loop_begin_fp) {
+				offset = loop_end_fp - (loop_begin_fp - offset) % loop_len_fp;
+			}
+		} break;
+		case AudioStreamSample::LOOP_PING_PONG: {
+			//a full back and forth cycle is twice the loop length
+			if (sign > 0) {
+				offset += amount;
+				if (offset >= loop_end_fp) {
+					int64_t past = (offset - loop_end_fp) % (loop_len_fp * 2);
+					if (past < loop_len_fp) {
+						offset = loop_end_fp - past;
+						sign = -1;
+					} else {
+						offset = loop_begin_fp + (past - loop_len_fp);
+					}
+				}
+			} else {
+				offset -= amount;
+				if (offset < loop_begin_fp) {
+					int64_t past = (loop_begin_fp - offset) % (loop_len_fp * 2);
+					if (past < loop_len_fp) {
+						offset = loop_begin_fp + past;
+						sign = 1;
+					} else {
+						offset = loop_end_fp - (past - loop_len_fp);
+					}
+				}
+			}
+		} break;
+	}
+}
+
 template <class Depth, bool is_stereo, bool is_ima_adpcm>
 void AudioStreamPlaybackSample::do_resample(const Depth *p_src, AudioFrame *p_dst, int64_t &offset, int32_t &increment, uint32_t amount, IMA_ADPCM_State *ima_adpcm) {
 	// this function will be compiled branchless by any decent compiler
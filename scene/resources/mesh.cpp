@@ -498,6 +498,7 @@ void Mesh::_bind_methods() {
 	BIND_ENUM_CONSTANT(ARRAY_FORMAT_WEIGHTS);
 	BIND_ENUM_CONSTANT(ARRAY_FORMAT_INDEX);
 
+	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_VERTEX);
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_NORMAL);
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_TANGENT);
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_COLOR);
@@ -506,6 +507,7 @@ void Mesh::_bind_methods() {
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_INDEX);
 
 	BIND_ENUM_CONSTANT(ARRAY_FLAG_USE_2D_VERTICES);
+	BIND_ENUM_CONSTANT(ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION);
 
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_DEFAULT);
 
@@ -1319,6 +1321,85 @@ struct ArrayMeshLightmapSurface {
 	uint32_t format;
 };
 
+Vector<ArrayMesh::SurfaceArrays> ArrayMesh::_get_surfaces_as_arrays() const {
+	Vector<SurfaceArrays> ret;
+	for (int i = 0; i < surfaces.size(); i++) {
+		SurfaceArrays s;
+		s.primitive = surface_get_primitive_type(i);
+		s.format = surface_get_format(i);
+		s.arrays = surface_get_arrays(i);
+		s.blend_shape_arrays = surface_get_blend_shape_arrays(i);
+		s.lods = surface_get_lods(i);
+		s.material = surface_get_material(i);
+		s.name = surface_get_name(i);
+		ret.push_back(s);
+	}
+	return ret;
+}
+
+void ArrayMesh::_set_surfaces_from_arrays(const Vector<SurfaceArrays> &p_surfaces) {
+	clear_surfaces();
+
+	for (int i = 0; i < p_surfaces.size(); i++) {
+		const SurfaceArrays &s = p_surfaces[i];
+		add_surface_from_arrays(s.primitive, s.arrays, s.blend_shape_arrays, s.lods, s.format);
+		surface_set_material(i, s.material);
+		surface_set_name(i, s.name);
+	}
+}
+
+void ArrayMesh::generate_lods(float p_max_error_ratio) {
+	Vector<SurfaceArrays> arrays = _get_surfaces_as_arrays();
+
+	for (int i = 0; i < arrays.size(); i++) {
+		SurfaceArrays &s = arrays.write[i];
+		s.lods = s.primitive == PRIMITIVE_TRIANGLES ? SurfaceTool::generate_lods_from_arrays(s.arrays, p_max_error_ratio) : Dictionary();
+	}
+
+	_set_surfaces_from_arrays(arrays);
+}
+
+void ArrayMesh::optimize_surfaces() {
+	Vector<SurfaceArrays> arrays = _get_surfaces_as_arrays();
+
+	for (int i = 0; i < arrays.size(); i++) {
+		SurfaceArrays &s = arrays.write[i];
+		if (s.primitive != PRIMITIVE_TRIANGLES || s.arrays[ARRAY_INDEX].get_type() != Variant::PACKED_INT32_ARRAY || s.arrays[ARRAY_VERTEX].get_type() != Variant::PACKED_VECTOR3_ARRAY) {
+			continue;
+		}
+
+		Vector<Vector3> vertices = s.arrays[ARRAY_VERTEX];
+		Vector<int> indices = s.arrays[ARRAY_INDEX];
+		float acmr = SurfaceTool::get_acmr(indices);
+
+		indices = SurfaceTool::optimize_vertex_cache_indices(indices, vertices.size());
+		indices = SurfaceTool::optimize_overdraw_indices(vertices, indices);
+		s.arrays[ARRAY_INDEX] = indices;
+
+		Vector<int> remap = SurfaceTool::optimize_vertex_fetch_remap(indices, vertices.size());
+		ERR_CONTINUE(remap.size() != vertices.size());
+
+		s.arrays = SurfaceTool::remap_vertex_arrays(s.arrays, remap);
+		for (int j = 0; j < s.blend_shape_arrays.size(); j++) {
+			s.blend_shape_arrays[j] = SurfaceTool::remap_vertex_arrays(s.blend_shape_arrays[j], remap);
+		}
+
+		Array errors = s.lods.keys();
+		for (int j = 0; j < errors.size(); j++) {
+			Vector<int> lod = s.lods[errors[j]];
+			int *w = lod.ptrw();
+			for (int k = 0; k < lod.size(); k++) {
+				w[k] = remap[w[k]];
+			}
+			s.lods[errors[j]] = lod;
+		}
+
+		print_verbose("Mesh: Optimized surface " + itos(i) + " of '" + get_name() + "', ACMR " + rtos(acmr) + " -> " + rtos(SurfaceTool::get_acmr(s.arrays[ARRAY_INDEX])) + ".");
+	}
+
+	_set_surfaces_from_arrays(arrays);
+}
+
 Error ArrayMesh::lightmap_unwrap(const Transform &p_base_transform, float p_texel_size) {
 	int *cache_data = nullptr;
 	unsigned int cache_size = 0;
@@ -1528,6 +1609,10 @@ void ArrayMesh::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("create_outline", "margin"), &ArrayMesh::create_outline);
 	ClassDB::bind_method(D_METHOD("regen_normalmaps"), &ArrayMesh::regen_normalmaps);
 	ClassDB::set_method_flags(get_class_static(), _scs_create("regen_normalmaps"), METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
+	ClassDB::bind_method(D_METHOD("generate_lods", "max_error_ratio"), &ArrayMesh::generate_lods, DEFVAL(0.25));
+	ClassDB::set_method_flags(get_class_static(), _scs_create("generate_lods"), METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
+	ClassDB::bind_method(D_METHOD("optimize_surfaces"), &ArrayMesh::optimize_surfaces);
+	ClassDB::set_method_flags(get_class_static(), _scs_create("optimize_surfaces"), METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
 	ClassDB::bind_method(D_METHOD("lightmap_unwrap", "transform", "texel_size"), &ArrayMesh::lightmap_unwrap);
 	ClassDB::set_method_flags(get_class_static(), _scs_create("lightmap_unwrap"), METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
 	ClassDB::bind_method(D_METHOD("get_faces"), &ArrayMesh::get_faces);
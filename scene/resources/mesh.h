@@ -83,6 +83,7 @@ public:
 		ARRAY_FORMAT_INDEX = 1 << ARRAY_INDEX,
 
 		ARRAY_COMPRESS_BASE = (ARRAY_INDEX + 1),
+		ARRAY_COMPRESS_VERTEX = 1 << (ARRAY_VERTEX + ARRAY_COMPRESS_BASE),
 		ARRAY_COMPRESS_NORMAL = 1 << (ARRAY_NORMAL + ARRAY_COMPRESS_BASE),
 		ARRAY_COMPRESS_TANGENT = 1 << (ARRAY_TANGENT + ARRAY_COMPRESS_BASE),
 		ARRAY_COMPRESS_COLOR = 1 << (ARRAY_COLOR + ARRAY_COMPRESS_BASE),
@@ -91,6 +92,7 @@ public:
 		ARRAY_COMPRESS_INDEX = 1 << (ARRAY_INDEX + ARRAY_COMPRESS_BASE),
 
 		ARRAY_FLAG_USE_2D_VERTICES = ARRAY_COMPRESS_INDEX << 1,
+		ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION = ARRAY_COMPRESS_INDEX << 2,
 		ARRAY_FLAG_USE_DYNAMIC_UPDATE = ARRAY_COMPRESS_INDEX << 3,
 
 		ARRAY_COMPRESS_DEFAULT = ARRAY_COMPRESS_NORMAL | ARRAY_COMPRESS_TANGENT | ARRAY_COMPRESS_COLOR | ARRAY_COMPRESS_TEX_UV | ARRAY_COMPRESS_TEX_UV2
@@ -180,6 +182,19 @@ private:
 	_FORCE_INLINE_ void _create_if_empty() const;
 	void _recompute_aabb();
 
+	// Used by the passes that rebuild every surface from its arrays.
+	struct SurfaceArrays {
+		PrimitiveType primitive;
+		uint32_t format;
+		Array arrays;
+		Array blend_shape_arrays;
+		Dictionary lods;
+		Ref<Material> material;
+		String name;
+	};
+	Vector<SurfaceArrays> _get_surfaces_as_arrays() const;
+	void _set_surfaces_from_arrays(const Vector<SurfaceArrays> &p_surfaces);
+
 protected:
 	virtual bool _is_generated() const { return false; }
 
@@ -236,6 +251,9 @@ public:
 
 	void regen_normalmaps();
 
+	void generate_lods(float p_max_error_ratio = 0.25);
+	void optimize_surfaces();
+
 	Error lightmap_unwrap(const Transform &p_base_transform = Transform(), float p_texel_size = 0.05);
 	Error lightmap_unwrap_cached(int *&r_cache_data, unsigned int &r_cache_size, bool &r_used_cache, const Transform &p_base_transform = Transform(), float p_texel_size = 0.05);
 
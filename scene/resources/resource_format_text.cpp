@@ -711,6 +711,9 @@ ResourceLoaderText::ResourceLoaderText() {
 	translation_remapped = false;
 	use_sub_threads = false;
 	error = OK;
+
+	// The file is only read through the parser, except when renaming dependencies.
+	stream.readahead_enabled = true;
 }
 
 ResourceLoaderText::~ResourceLoaderText() {
@@ -763,6 +766,8 @@ void ResourceLoaderText::get_dependencies(FileAccess *p_f, List<String> *p_depen
 }
 
 Error ResourceLoaderText::rename_dependencies(FileAccess *p_f, const String &p_path, const Map<String, String> &p_map) {
+	// The file position is used to copy everything after the last ext_resource tag.
+	stream.readahead_enabled = false;
 	open(p_f, true);
 	ERR_FAIL_COND_V(error != OK, error);
 	ignore_resource_parsing = true;
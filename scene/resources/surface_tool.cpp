@@ -30,6 +30,7 @@
 
 #include "surface_tool.h"
 
+#include "core/local_vector.h"
 #include "core/method_bind_ext.gen.inc"
 
 #define _VERTEX_SNAP 0.0001
@@ -438,7 +439,7 @@ Ref<ArrayMesh> SurfaceTool::commit(const Ref<ArrayMesh> &p_existing, uint32_t p_
 
 	Array a = commit_to_arrays();
 
-	mesh->add_surface_from_arrays(primitive, a, Array(), Dictionary(), p_flags);
+	mesh->add_surface_from_arrays(primitive, a, Array(), lods, p_flags);
 
 	if (material.is_valid()) {
 		mesh->surface_set_material(surface, material);
@@ -492,6 +493,898 @@ void SurfaceTool::deindex() {
 	}
 	format &= ~Mesh::ARRAY_FORMAT_INDEX;
 	index_array.clear();
+	lods.clear();
+}
+
+// Quadric error metric (Garland & Heckbert), the plane equations are weighted by triangle area.
+struct SimplifyQuadric {
+	double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+	double b2 = 0.0, bc = 0.0, bd = 0.0;
+	double c2 = 0.0, cd = 0.0;
+	double d2 = 0.0;
+	double weight = 0.0;
+
+	void add_plane(const Vector3 &p_normal, double p_d, double p_weight) {
+		double a = p_normal.x;
+		double b = p_normal.y;
+		double c = p_normal.z;
+
+		a2 += a * a * p_weight;
+		ab += a * b * p_weight;
+		ac += a * c * p_weight;
+		ad += a * p_d * p_weight;
+		b2 += b * b * p_weight;
+		bc += b * c * p_weight;
+		bd += b * p_d * p_weight;
+		c2 += c * c * p_weight;
+		cd += c * p_d * p_weight;
+		d2 += p_d * p_d * p_weight;
+		weight += p_weight;
+	}
+
+	void operator+=(const SimplifyQuadric &p_q) {
+		a2 += p_q.a2;
+		ab += p_q.ab;
+		ac += p_q.ac;
+		ad += p_q.ad;
+		b2 += p_q.b2;
+		bc += p_q.bc;
+		bd += p_q.bd;
+		c2 += p_q.c2;
+		cd += p_q.cd;
+		d2 += p_q.d2;
+		weight += p_q.weight;
+	}
+
+	// Weighted sum of squared distances from p_point to all planes.
+	double evaluate(const Vector3 &p_point) const {
+		double x = p_point.x;
+		double y = p_point.y;
+		double z = p_point.z;
+		return a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) + 2.0 * (ad * x + bd * y + cd * z) + d2;
+	}
+};
+
+struct SimplifyPositionHasher {
+	static _FORCE_INLINE_ uint32_t hash(const Vector3 &p_vec) {
+		return hash_djb2_buffer((const uint8_t *)&p_vec, sizeof(real_t) * 3);
+	}
+};
+
+struct SimplifyCollapse {
+	uint32_t from;
+	uint32_t to;
+	double error;
+
+	bool operator<(const SimplifyCollapse &p_other) const {
+		return error < p_other.error;
+	}
+};
+
+// Edge collapse simplifier. Vertices are only ever moved onto existing ones, so LODs can share the
+// vertex buffer and just use a different index buffer. Quadrics keep accumulating between calls to
+// simplify(), so successive LODs can be built from each other while the error is still measured
+// against the original surface.
+class SurfaceSimplifier {
+	const Vector3 *vertices = nullptr;
+	uint32_t vertex_count = 0;
+
+	LocalVector<uint32_t> indices;
+	LocalVector<uint32_t> weld;
+	LocalVector<bool> locked;
+	LocalVector<SimplifyQuadric> quadrics;
+	double worst_error = 0.0;
+
+	LocalVector<uint32_t> adjacency_offsets;
+	LocalVector<uint32_t> adjacency;
+	LocalVector<SimplifyCollapse> collapses;
+	LocalVector<uint32_t> collapse_to;
+	LocalVector<bool> touched;
+
+	void _build_adjacency();
+	bool _can_collapse(uint32_t p_from, uint32_t p_to, uint32_t &r_removed) const;
+
+public:
+	bool init(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices);
+	void simplify(uint32_t p_target_index_count, float p_max_error);
+
+	const LocalVector<uint32_t> &get_indices() const { return indices; }
+	float get_error() const { return Math::sqrt(worst_error); }
+};
+
+bool SurfaceSimplifier::init(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices) {
+	ERR_FAIL_COND_V(p_indices.size() % 3 != 0, false);
+
+	vertices = p_vertices.ptr();
+	vertex_count = p_vertices.size();
+
+	indices.resize(p_indices.size());
+	for (int i = 0; i < p_indices.size(); i++) {
+		ERR_FAIL_INDEX_V(p_indices[i], (int)vertex_count, false);
+		indices[i] = p_indices[i];
+	}
+
+	// Vertices sharing a position (UV or normal seams) are welded, so the seams can be found and kept intact.
+	LocalVector<uint32_t> weld_count;
+	weld.resize(vertex_count);
+	weld_count.resize(vertex_count);
+	{
+		HashMap<Vector3, uint32_t, SimplifyPositionHasher> positions;
+		for (uint32_t i = 0; i < vertex_count; i++) {
+			weld_count[i] = 0;
+			const uint32_t *existing = positions.getptr(vertices[i]);
+			if (existing) {
+				weld[i] = *existing;
+			} else {
+				weld[i] = i;
+				positions[vertices[i]] = i;
+			}
+			weld_count[weld[i]]++;
+		}
+	}
+
+	// Edges not shared by exactly two triangles are open borders (or non manifold), their vertices are locked too.
+	locked.resize(vertex_count);
+	for (uint32_t i = 0; i < vertex_count; i++) {
+		locked[i] = weld_count[weld[i]] > 1;
+	}
+
+	{
+		HashMap<uint64_t, uint32_t> edges;
+		for (uint32_t i = 0; i < indices.size(); i += 3) {
+			for (uint32_t j = 0; j < 3; j++) {
+				uint64_t a = weld[indices[i + j]];
+				uint64_t b = weld[indices[i + (j + 1) % 3]];
+				uint64_t key = a < b ? (a << 32) | b : (b << 32) | a;
+				uint32_t *count = edges.getptr(key);
+				if (count) {
+					(*count)++;
+				} else {
+					edges[key] = 1;
+				}
+			}
+		}
+
+		const uint64_t *key = nullptr;
+		while ((key = edges.next(key))) {
+			if (edges[*key] != 2) {
+				locked[*key >> 32] = true;
+				locked[*key & 0xFFFFFFFF] = true;
+			}
+		}
+
+		for (uint32_t i = 0; i < vertex_count; i++) {
+			locked[i] = locked[i] || locked[weld[i]];
+		}
+	}
+
+	quadrics.resize(vertex_count);
+	for (uint32_t i = 0; i < indices.size(); i += 3) {
+		const Vector3 &v0 = vertices[indices[i + 0]];
+		Vector3 normal = (vertices[indices[i + 1]] - v0).cross(vertices[indices[i + 2]] - v0);
+		real_t area = normal.length();
+		if (area <= CMP_EPSILON2) {
+			continue;
+		}
+		normal /= area;
+		double d = -normal.dot(v0);
+		for (uint32_t j = 0; j < 3; j++) {
+			quadrics[weld[indices[i + j]]].add_plane(normal, d, area * 0.5);
+		}
+	}
+
+	worst_error = 0.0;
+	collapse_to.resize(vertex_count);
+	touched.resize(vertex_count);
+
+	return true;
+}
+
+void SurfaceSimplifier::_build_adjacency() {
+	adjacency_offsets.resize(vertex_count + 1);
+	for (uint32_t i = 0; i <= vertex_count; i++) {
+		adjacency_offsets[i] = 0;
+	}
+	for (uint32_t i = 0; i < indices.size(); i++) {
+		adjacency_offsets[indices[i] + 1]++;
+	}
+	for (uint32_t i = 0; i < vertex_count; i++) {
+		adjacency_offsets[i + 1] += adjacency_offsets[i];
+	}
+	adjacency.resize(indices.size());
+	for (uint32_t i = 0; i < indices.size(); i++) {
+		adjacency[adjacency_offsets[indices[i]]++] = i / 3;
+	}
+	for (uint32_t i = vertex_count; i > 0; i--) {
+		adjacency_offsets[i] = adjacency_offsets[i - 1];
+	}
+	adjacency_offsets[0] = 0;
+}
+
+bool SurfaceSimplifier::_can_collapse(uint32_t p_from, uint32_t p_to, uint32_t &r_removed) const {
+	const Vector3 &target = vertices[p_to];
+	r_removed = 0;
+
+	for (uint32_t i = adjacency_offsets[p_from]; i < adjacency_offsets[p_from + 1]; i++) {
+		const uint32_t *tri = &indices[adjacency[i] * 3];
+		if (tri[0] == p_to || tri[1] == p_to || tri[2] == p_to) {
+			r_removed++;
+			continue;
+		}
+
+		Vector3 p[3];
+		for (uint32_t j = 0; j < 3; j++) {
+			p[j] = vertices[tri[j]];
+		}
+		Vector3 old_normal = (p[1] - p[0]).cross(p[2] - p[0]);
+		for (uint32_t j = 0; j < 3; j++) {
+			if (tri[j] == p_from) {
+				p[j] = target;
+			}
+		}
+		Vector3 new_normal = (p[1] - p[0]).cross(p[2] - p[0]);
+
+		// Reject triangles that flip or become slivers.
+		if (new_normal.dot(old_normal) <= 0.0 || new_normal.length_squared() <= old_normal.length_squared() * 1e-6) {
+			return false;
+		}
+	}
+
+	if (r_removed == 0) {
+		return false;
+	}
+
+	// Link condition, both vertices may only share the neighbors of the triangles being removed.
+	// Otherwise the collapse pinches the surface into a non manifold shape.
+	uint32_t shared_neighbors = 0;
+	for (uint32_t i = adjacency_offsets[p_from]; i < adjacency_offsets[p_from + 1]; i++) {
+		const uint32_t *tri = &indices[adjacency[i] * 3];
+		for (uint32_t j = 0; j < 3; j++) {
+			uint32_t n = weld[tri[j]];
+			if (n == weld[p_from] || n == weld[p_to]) {
+				continue;
+			}
+			bool seen = false;
+			for (uint32_t k = adjacency_offsets[p_from]; k < i && !seen; k++) {
+				const uint32_t *prev = &indices[adjacency[k] * 3];
+				seen = weld[prev[0]] == n || weld[prev[1]] == n || weld[prev[2]] == n;
+			}
+			for (uint32_t k = 0; k < j && !seen; k++) {
+				seen = weld[tri[k]] == n;
+			}
+			if (seen) {
+				continue;
+			}
+			for (uint32_t k = adjacency_offsets[p_to]; k < adjacency_offsets[p_to + 1]; k++) {
+				const uint32_t *other = &indices[adjacency[k] * 3];
+				if (weld[other[0]] == n || weld[other[1]] == n || weld[other[2]] == n) {
+					shared_neighbors++;
+					break;
+				}
+			}
+		}
+	}
+
+	return shared_neighbors <= r_removed;
+}
+
+void SurfaceSimplifier::simplify(uint32_t p_target_index_count, float p_max_error) {
+	const double max_error_squared = double(p_max_error) * double(p_max_error);
+
+	// Collapses are done in passes, cheapest first. Only vertices untouched during the pass are collapsed,
+	// so the flip test always sees up to date neighbors.
+	while (indices.size() > p_target_index_count) {
+		_build_adjacency();
+
+		collapses.clear();
+		for (uint32_t i = 0; i < indices.size(); i += 3) {
+			for (uint32_t j = 0; j < 3; j++) {
+				uint32_t a = indices[i + j];
+				uint32_t b = indices[i + (j + 1) % 3];
+				for (uint32_t k = 0; k < 2; k++) {
+					if (!locked[a]) {
+						SimplifyQuadric q = quadrics[weld[a]];
+						q += quadrics[weld[b]];
+						double error = q.weight > 0.0 ? MAX(q.evaluate(vertices[b]) / q.weight, 0.0) : 0.0;
+						if (error <= max_error_squared) {
+							SimplifyCollapse collapse;
+							collapse.from = a;
+							collapse.to = b;
+							collapse.error = error;
+							collapses.push_back(collapse);
+						}
+					}
+					SWAP(a, b);
+				}
+			}
+		}
+
+		if (collapses.empty()) {
+			break;
+		}
+
+		collapses.sort();
+
+		for (uint32_t i = 0; i < vertex_count; i++) {
+			collapse_to[i] = i;
+			touched[i] = false;
+		}
+
+		uint32_t triangles_to_remove = (indices.size() - p_target_index_count + 2) / 3;
+		uint32_t triangles_removed = 0;
+
+		for (uint32_t i = 0; i < collapses.size() && triangles_removed < triangles_to_remove; i++) {
+			const SimplifyCollapse &collapse = collapses[i];
+			uint32_t a = collapse.from;
+			uint32_t b = collapse.to;
+			uint32_t removed = 0;
+			if (touched[a] || touched[b] || !_can_collapse(a, b, removed)) {
+				continue;
+			}
+
+			collapse_to[a] = b;
+			quadrics[weld[b]] += quadrics[weld[a]];
+			worst_error = MAX(worst_error, collapse.error);
+			triangles_removed += removed;
+
+			touched[a] = true;
+			touched[b] = true;
+			for (uint32_t j = adjacency_offsets[a]; j < adjacency_offsets[a + 1]; j++) {
+				const uint32_t *tri = &indices[adjacency[j] * 3];
+				touched[tri[0]] = true;
+				touched[tri[1]] = true;
+				touched[tri[2]] = true;
+			}
+		}
+
+		if (triangles_removed == 0) {
+			break;
+		}
+
+		uint32_t write = 0;
+		for (uint32_t i = 0; i < indices.size(); i += 3) {
+			uint32_t v0 = collapse_to[indices[i + 0]];
+			uint32_t v1 = collapse_to[indices[i + 1]];
+			uint32_t v2 = collapse_to[indices[i + 2]];
+			if (weld[v0] == weld[v1] || weld[v1] == weld[v2] || weld[v2] == weld[v0]) {
+				continue;
+			}
+			indices[write++] = v0;
+			indices[write++] = v1;
+			indices[write++] = v2;
+		}
+		indices.resize(write);
+	}
+}
+
+static Vector<int> _simplified_index_array(const LocalVector<uint32_t> &p_indices) {
+	Vector<int> ret;
+	ret.resize(p_indices.size());
+	int *w = ret.ptrw();
+	for (uint32_t i = 0; i < p_indices.size(); i++) {
+		w[i] = p_indices[i];
+	}
+	return ret;
+}
+
+Vector<int> SurfaceTool::simplify_indices(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices, int p_target_index_count, float p_max_error, float *r_error) {
+	if (r_error) {
+		*r_error = 0.0;
+	}
+
+	SurfaceSimplifier simplifier;
+	if (!simplifier.init(p_vertices, p_indices)) {
+		return p_indices;
+	}
+
+	simplifier.simplify(MAX(p_target_index_count, 0), p_max_error);
+
+	if (r_error) {
+		*r_error = simplifier.get_error();
+	}
+	return _simplified_index_array(simplifier.get_indices());
+}
+
+Dictionary SurfaceTool::generate_lods_from_arrays(const Array &p_arrays, float p_max_error_ratio) {
+	Dictionary ret;
+	ERR_FAIL_COND_V(p_arrays.size() != Mesh::ARRAY_MAX, ret);
+
+	if (p_arrays[Mesh::ARRAY_VERTEX].get_type() != Variant::PACKED_VECTOR3_ARRAY || p_arrays[Mesh::ARRAY_INDEX].get_type() != Variant::PACKED_INT32_ARRAY) {
+		return ret; // Only indexed 3D geometry can be simplified.
+	}
+
+	Vector<Vector3> vertices = p_arrays[Mesh::ARRAY_VERTEX];
+	Vector<int> indices = p_arrays[Mesh::ARRAY_INDEX];
+
+	AABB aabb;
+	for (int i = 0; i < vertices.size(); i++) {
+		if (i == 0) {
+			aabb.position = vertices[i];
+		} else {
+			aabb.expand_to(vertices[i]);
+		}
+	}
+
+	float size = aabb.get_longest_axis_size();
+	if (size <= CMP_EPSILON) {
+		return ret;
+	}
+	float max_error = size * p_max_error_ratio;
+	// LODs need strictly increasing errors, flat areas simplify without any.
+	float min_error_step = size * 0.0001;
+
+	SurfaceSimplifier simplifier;
+	if (!simplifier.init(vertices, indices)) {
+		return ret;
+	}
+
+	// Each LOD aims at half the triangles of the previous one.
+	uint32_t last_index_count = indices.size();
+	float last_error = 0.0;
+
+	while (true) {
+		uint32_t target_index_count = (last_index_count / 2) / 3 * 3;
+		if (target_index_count < 36) {
+			break;
+		}
+
+		simplifier.simplify(target_index_count, max_error);
+
+		uint32_t index_count = simplifier.get_indices().size();
+		if (index_count == 0 || index_count > last_index_count * 3 / 4) {
+			break; // Not worth another level, the error limit was reached.
+		}
+
+		float error = MAX(simplifier.get_error(), last_error + min_error_step);
+		ret[error] = optimize_vertex_cache_indices(_simplified_index_array(simplifier.get_indices()), vertices.size());
+
+		last_index_count = index_count;
+		last_error = error;
+	}
+
+	return ret;
+}
+
+float SurfaceTool::get_acmr(const Vector<int> &p_indices, int p_cache_size) {
+	ERR_FAIL_COND_V(p_cache_size <= 0, 0.0);
+	if (p_indices.size() < 3) {
+		return 0.0;
+	}
+
+	// FIFO cache, as used by most hardware.
+	LocalVector<int> cache;
+	cache.resize(p_cache_size);
+	for (int i = 0; i < p_cache_size; i++) {
+		cache[i] = -1;
+	}
+
+	int misses = 0;
+	int cache_pos = 0;
+	for (int i = 0; i < p_indices.size(); i++) {
+		int index = p_indices[i];
+		bool hit = false;
+		for (int j = 0; j < p_cache_size && !hit; j++) {
+			hit = cache[j] == index;
+		}
+		if (!hit) {
+			cache[cache_pos] = index;
+			cache_pos = (cache_pos + 1) % p_cache_size;
+			misses++;
+		}
+	}
+
+	return float(misses) / (p_indices.size() / 3);
+}
+
+Vector<int> SurfaceTool::optimize_vertex_cache_indices(const Vector<int> &p_indices, int p_vertex_count, int p_cache_size) {
+	ERR_FAIL_COND_V(p_indices.size() % 3 != 0, p_indices);
+	ERR_FAIL_COND_V(p_cache_size <= 0, p_indices);
+
+	// Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+	// Triangles are emitted as fans around a vertex, the next fanning vertex is the one that will still be in the
+	// cache after its remaining triangles are emitted, which keeps the whole pass linear.
+	const int triangle_count = p_indices.size() / 3;
+	const int *indices = p_indices.ptr();
+
+	LocalVector<int> adjacency_offsets;
+	LocalVector<int> adjacency;
+	LocalVector<int> live_triangles;
+	adjacency_offsets.resize(p_vertex_count + 1);
+	live_triangles.resize(p_vertex_count);
+	for (int i = 0; i <= p_vertex_count; i++) {
+		adjacency_offsets[i] = 0;
+	}
+	for (int i = 0; i < p_indices.size(); i++) {
+		ERR_FAIL_INDEX_V(indices[i], p_vertex_count, p_indices);
+		adjacency_offsets[indices[i] + 1]++;
+	}
+	for (int i = 0; i < p_vertex_count; i++) {
+		live_triangles[i] = adjacency_offsets[i + 1];
+		adjacency_offsets[i + 1] += adjacency_offsets[i];
+	}
+	adjacency.resize(p_indices.size());
+	{
+		LocalVector<int> fill;
+		fill.resize(p_vertex_count);
+		for (int i = 0; i < p_vertex_count; i++) {
+			fill[i] = adjacency_offsets[i];
+		}
+		for (int i = 0; i < p_indices.size(); i++) {
+			adjacency[fill[indices[i]]++] = i / 3;
+		}
+	}
+
+	LocalVector<int> cache_time;
+	LocalVector<bool> emitted;
+	LocalVector<int> dead_end;
+	LocalVector<int> candidates;
+	cache_time.resize(p_vertex_count);
+	emitted.resize(triangle_count);
+	for (int i = 0; i < p_vertex_count; i++) {
+		cache_time[i] = 0;
+	}
+	for (int i = 0; i < triangle_count; i++) {
+		emitted[i] = false;
+	}
+
+	Vector<int> ret;
+	ret.resize(p_indices.size());
+	int *w = ret.ptrw();
+	int written = 0;
+
+	int time = p_cache_size + 1;
+	int cursor = 0;
+	int fanning = triangle_count > 0 ? indices[0] : -1;
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		for (int i = adjacency_offsets[fanning]; i < adjacency_offsets[fanning + 1]; i++) {
+			int t = adjacency[i];
+			if (emitted[t]) {
+				continue;
+			}
+			emitted[t] = true;
+
+			for (int j = 0; j < 3; j++) {
+				int v = indices[t * 3 + j];
+				w[written++] = v;
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				live_triangles[v]--;
+				if (time - cache_time[v] > p_cache_size) {
+					cache_time[v] = time;
+					time++;
+				}
+			}
+		}
+
+		// Pick the candidate that stays in the cache the longest, if any.
+		int next = -1;
+		int best_priority = -1;
+		for (uint32_t i = 0; i < candidates.size(); i++) {
+			int v = candidates[i];
+			if (live_triangles[v] <= 0) {
+				continue;
+			}
+			int priority = 0;
+			if (time - cache_time[v] + 2 * live_triangles[v] <= p_cache_size) {
+				priority = time - cache_time[v];
+			}
+			if (priority > best_priority) {
+				best_priority = priority;
+				next = v;
+			}
+		}
+
+		if (next == -1) {
+			// Dead end, go back to a recently used vertex, or to the next vertex with triangles left.
+			while (!dead_end.empty() && next == -1) {
+				int v = dead_end[dead_end.size() - 1];
+				dead_end.resize(dead_end.size() - 1);
+				if (live_triangles[v] > 0) {
+					next = v;
+				}
+			}
+			while (next == -1 && cursor < p_vertex_count) {
+				if (live_triangles[cursor] > 0) {
+					next = cursor;
+				}
+				cursor++;
+			}
+		}
+
+		fanning = next;
+	}
+
+	ERR_FAIL_COND_V(written != p_indices.size(), p_indices);
+
+	return ret;
+}
+
+struct OverdrawCluster {
+	int from;
+	int to;
+	real_t sort_key;
+
+	bool operator<(const OverdrawCluster &p_other) const {
+		return sort_key > p_other.sort_key;
+	}
+};
+
+Vector<int> SurfaceTool::optimize_overdraw_indices(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices, int p_cache_size) {
+	ERR_FAIL_COND_V(p_indices.size() % 3 != 0, p_indices);
+	ERR_FAIL_COND_V(p_cache_size <= 0, p_indices);
+
+	// Expects triangles already sorted for the vertex cache. They are split into clusters wherever the cache
+	// starts over (all three vertices miss), so moving clusters around barely changes the cache efficiency.
+	// Clusters facing away from the center of the mesh are likely to occlude the rest, so they go first.
+	const int triangle_count = p_indices.size() / 3;
+	const int *indices = p_indices.ptr();
+	const Vector3 *vertices = p_vertices.ptr();
+
+	LocalVector<OverdrawCluster> clusters;
+	{
+		LocalVector<int> cache;
+		cache.resize(p_cache_size);
+		for (int i = 0; i < p_cache_size; i++) {
+			cache[i] = -1;
+		}
+		int cache_pos = 0;
+
+		for (int i = 0; i < triangle_count; i++) {
+			int misses = 0;
+			for (int j = 0; j < 3; j++) {
+				int index = indices[i * 3 + j];
+				ERR_FAIL_INDEX_V(index, p_vertices.size(), p_indices);
+				bool hit = false;
+				for (int k = 0; k < p_cache_size && !hit; k++) {
+					hit = cache[k] == index;
+				}
+				if (!hit) {
+					cache[cache_pos] = index;
+					cache_pos = (cache_pos + 1) % p_cache_size;
+					misses++;
+				}
+			}
+
+			if (i == 0 || misses == 3) {
+				OverdrawCluster cluster;
+				cluster.from = i;
+				cluster.to = i + 1;
+				cluster.sort_key = 0;
+				clusters.push_back(cluster);
+			} else {
+				clusters[clusters.size() - 1].to = i + 1;
+			}
+		}
+	}
+
+	if (clusters.size() < 2) {
+		return p_indices;
+	}
+
+	Vector3 mesh_center;
+	real_t mesh_area = 0;
+	for (int i = 0; i < triangle_count; i++) {
+		const Vector3 &a = vertices[indices[i * 3 + 0]];
+		const Vector3 &b = vertices[indices[i * 3 + 1]];
+		const Vector3 &c = vertices[indices[i * 3 + 2]];
+		real_t area = (b - a).cross(c - a).length();
+		mesh_center += (a + b + c) * (area / 3.0);
+		mesh_area += area;
+	}
+	if (mesh_area <= CMP_EPSILON) {
+		return p_indices;
+	}
+	mesh_center /= mesh_area;
+
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		Vector3 center;
+		Vector3 normal;
+		real_t area = 0;
+		for (int j = clusters[i].from; j < clusters[i].to; j++) {
+			const Vector3 &a = vertices[indices[j * 3 + 0]];
+			const Vector3 &b = vertices[indices[j * 3 + 1]];
+			const Vector3 &c = vertices[indices[j * 3 + 2]];
+			Vector3 n = (b - a).cross(c - a);
+			real_t triangle_area = n.length();
+			center += (a + b + c) * (triangle_area / 3.0);
+			normal += n;
+			area += triangle_area;
+		}
+		if (area > CMP_EPSILON) {
+			center /= area;
+		}
+		clusters[i].sort_key = (center - mesh_center).dot(normal.normalized());
+	}
+
+	clusters.sort();
+
+	Vector<int> ret;
+	ret.resize(p_indices.size());
+	int *w = ret.ptrw();
+	int written = 0;
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		for (int j = clusters[i].from * 3; j < clusters[i].to * 3; j++) {
+			w[written++] = indices[j];
+		}
+	}
+
+	return ret;
+}
+
+Vector<int> SurfaceTool::optimize_vertex_fetch_remap(const Vector<int> &p_indices, int p_vertex_count) {
+	// Vertices are renumbered in the order they are first used, unused ones go last.
+	Vector<int> remap;
+	remap.resize(p_vertex_count);
+	int *w = remap.ptrw();
+	for (int i = 0; i < p_vertex_count; i++) {
+		w[i] = -1;
+	}
+
+	int next = 0;
+	for (int i = 0; i < p_indices.size(); i++) {
+		ERR_FAIL_INDEX_V(p_indices[i], p_vertex_count, Vector<int>());
+		if (w[p_indices[i]] == -1) {
+			w[p_indices[i]] = next++;
+		}
+	}
+	for (int i = 0; i < p_vertex_count; i++) {
+		if (w[i] == -1) {
+			w[i] = next++;
+		}
+	}
+
+	return remap;
+}
+
+template <class T>
+static Vector<T> _remap_vertex_array(const Vector<T> &p_array, const Vector<int> &p_remap) {
+	const int vertex_count = p_remap.size();
+	ERR_FAIL_COND_V(vertex_count == 0 || p_array.size() % vertex_count != 0, p_array);
+	const int stride = p_array.size() / vertex_count;
+
+	Vector<T> ret;
+	ret.resize(p_array.size());
+	T *w = ret.ptrw();
+	const T *r = p_array.ptr();
+	for (int i = 0; i < vertex_count; i++) {
+		for (int j = 0; j < stride; j++) {
+			w[p_remap[i] * stride + j] = r[i * stride + j];
+		}
+	}
+	return ret;
+}
+
+Array SurfaceTool::remap_vertex_arrays(const Array &p_arrays, const Vector<int> &p_remap) {
+	ERR_FAIL_COND_V(p_arrays.size() != Mesh::ARRAY_MAX, p_arrays);
+
+	Array ret;
+	ret.resize(Mesh::ARRAY_MAX);
+
+	for (int i = 0; i < Mesh::ARRAY_MAX; i++) {
+		const Variant &array = p_arrays[i];
+
+		if (i == Mesh::ARRAY_INDEX) {
+			if (array.get_type() == Variant::PACKED_INT32_ARRAY) {
+				Vector<int> indices = array;
+				int *w = indices.ptrw();
+				for (int j = 0; j < indices.size(); j++) {
+					ERR_FAIL_INDEX_V(w[j], p_remap.size(), p_arrays);
+					w[j] = p_remap[w[j]];
+				}
+				ret[i] = indices;
+			}
+			continue;
+		}
+
+		switch (array.get_type()) {
+			case Variant::PACKED_VECTOR2_ARRAY: {
+				ret[i] = _remap_vertex_array<Vector2>(array, p_remap);
+			} break;
+			case Variant::PACKED_VECTOR3_ARRAY: {
+				ret[i] = _remap_vertex_array<Vector3>(array, p_remap);
+			} break;
+			case Variant::PACKED_COLOR_ARRAY: {
+				ret[i] = _remap_vertex_array<Color>(array, p_remap);
+			} break;
+			case Variant::PACKED_FLOAT32_ARRAY: {
+				ret[i] = _remap_vertex_array<float>(array, p_remap);
+			} break;
+			case Variant::PACKED_INT32_ARRAY: {
+				ret[i] = _remap_vertex_array<int32_t>(array, p_remap);
+			} break;
+			default: {
+				ret[i] = array;
+			}
+		}
+	}
+
+	return ret;
+}
+
+Vector<int> SurfaceTool::_get_index_vector() const {
+	Vector<int> indices;
+	indices.resize(index_array.size());
+	int *w = indices.ptrw();
+	int idx = 0;
+	for (const List<int>::Element *E = index_array.front(); E; E = E->next()) {
+		w[idx++] = E->get();
+	}
+	return indices;
+}
+
+void SurfaceTool::_set_index_vector(const Vector<int> &p_indices) {
+	index_array.clear();
+	for (int i = 0; i < p_indices.size(); i++) {
+		index_array.push_back(p_indices[i]);
+	}
+}
+
+void SurfaceTool::optimize_vertex_cache() {
+	ERR_FAIL_COND(primitive != Mesh::PRIMITIVE_TRIANGLES);
+
+	index();
+	_set_index_vector(optimize_vertex_cache_indices(_get_index_vector(), vertex_array.size()));
+}
+
+void SurfaceTool::optimize_overdraw() {
+	ERR_FAIL_COND(primitive != Mesh::PRIMITIVE_TRIANGLES);
+
+	index();
+
+	Vector<Vector3> vertices;
+	vertices.resize(vertex_array.size());
+	Vector3 *w = vertices.ptrw();
+	int idx = 0;
+	for (List<Vertex>::Element *E = vertex_array.front(); E; E = E->next()) {
+		w[idx++] = E->get().vertex;
+	}
+
+	_set_index_vector(optimize_overdraw_indices(vertices, _get_index_vector()));
+}
+
+void SurfaceTool::optimize_vertex_fetch() {
+	ERR_FAIL_COND(primitive != Mesh::PRIMITIVE_TRIANGLES);
+
+	index();
+
+	Vector<int> remap = optimize_vertex_fetch_remap(_get_index_vector(), vertex_array.size());
+	ERR_FAIL_COND(remap.size() != vertex_array.size());
+
+	Vector<Vertex> vertices;
+	vertices.resize(vertex_array.size());
+	int idx = 0;
+	for (List<Vertex>::Element *E = vertex_array.front(); E; E = E->next()) {
+		vertices.write[remap[idx++]] = E->get();
+	}
+	vertex_array.clear();
+	for (int i = 0; i < vertices.size(); i++) {
+		vertex_array.push_back(vertices[i]);
+	}
+
+	for (List<int>::Element *E = index_array.front(); E; E = E->next()) {
+		E->get() = remap[E->get()];
+	}
+
+	Array errors = lods.keys();
+	for (int i = 0; i < errors.size(); i++) {
+		Vector<int> lod = lods[errors[i]];
+		int *w = lod.ptrw();
+		for (int j = 0; j < lod.size(); j++) {
+			w[j] = remap[w[j]];
+		}
+		lods[errors[i]] = lod;
+	}
+}
+
+void SurfaceTool::generate_lods(float p_max_error_ratio) {
+	ERR_FAIL_COND(!begun);
+	ERR_FAIL_COND(primitive != Mesh::PRIMITIVE_TRIANGLES);
+
+	index();
+	lods = generate_lods_from_arrays(commit_to_arrays(), p_max_error_ratio);
 }
 
 void SurfaceTool::_create_list(const Ref<Mesh> &p_existing, int p_surface, List<Vertex> *r_vertex, List<int> *r_index, int &lformat) {
@@ -976,6 +1869,7 @@ void SurfaceTool::clear() {
 	index_array.clear();
 	vertex_array.clear();
 	smooth_groups.clear();
+	lods.clear();
 	material.unref();
 }
 
@@ -1000,6 +1894,10 @@ void SurfaceTool::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("deindex"), &SurfaceTool::deindex);
 	ClassDB::bind_method(D_METHOD("generate_normals", "flip"), &SurfaceTool::generate_normals, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("generate_tangents"), &SurfaceTool::generate_tangents);
+	ClassDB::bind_method(D_METHOD("generate_lods", "max_error_ratio"), &SurfaceTool::generate_lods, DEFVAL(0.25));
+	ClassDB::bind_method(D_METHOD("optimize_vertex_cache"), &SurfaceTool::optimize_vertex_cache);
+	ClassDB::bind_method(D_METHOD("optimize_overdraw"), &SurfaceTool::optimize_overdraw);
+	ClassDB::bind_method(D_METHOD("optimize_vertex_fetch"), &SurfaceTool::optimize_vertex_fetch);
 
 	ClassDB::bind_method(D_METHOD("set_material", "material"), &SurfaceTool::set_material);
 
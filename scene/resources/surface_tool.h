@@ -77,6 +77,7 @@ private:
 	List<Vertex> vertex_array;
 	List<int> index_array;
 	Map<int, bool> smooth_groups;
+	Dictionary lods;
 
 	//memory
 	Color last_color;
@@ -88,6 +89,8 @@ private:
 	Plane last_tangent;
 
 	void _create_list_from_arrays(Array arr, List<Vertex> *r_vertex, List<int> *r_index, int &lformat);
+	Vector<int> _get_index_vector() const;
+	void _set_index_vector(const Vector<int> &p_indices);
 	void _create_list(const Ref<Mesh> &p_existing, int p_surface, List<Vertex> *r_vertex, List<int> *r_index, int &lformat);
 
 	//mikktspace callbacks
@@ -123,6 +126,10 @@ public:
 	void deindex();
 	void generate_normals(bool p_flip = false);
 	void generate_tangents();
+	void generate_lods(float p_max_error_ratio = 0.25);
+	void optimize_vertex_cache();
+	void optimize_overdraw();
+	void optimize_vertex_fetch();
 
 	void set_material(const Ref<Material> &p_material);
 
@@ -132,6 +139,13 @@ public:
 
 	void create_from_triangle_arrays(const Array &p_arrays);
 	static Vector<Vertex> create_vertex_array_from_triangle_arrays(const Array &p_arrays);
+	static Vector<int> simplify_indices(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices, int p_target_index_count, float p_max_error, float *r_error = nullptr);
+	static Dictionary generate_lods_from_arrays(const Array &p_arrays, float p_max_error_ratio = 0.25);
+	static float get_acmr(const Vector<int> &p_indices, int p_cache_size = 16);
+	static Vector<int> optimize_vertex_cache_indices(const Vector<int> &p_indices, int p_vertex_count, int p_cache_size = 16);
+	static Vector<int> optimize_overdraw_indices(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices, int p_cache_size = 16);
+	static Vector<int> optimize_vertex_fetch_remap(const Vector<int> &p_indices, int p_vertex_count);
+	static Array remap_vertex_arrays(const Array &p_arrays, const Vector<int> &p_remap);
 	Array commit_to_arrays();
 	void create_from(const Ref<Mesh> &p_existing, int p_surface);
 	void create_from_blend_shape(const Ref<Mesh> &p_existing, int p_surface, const String &p_blend_shape_name);
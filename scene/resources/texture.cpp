@@ -31,11 +31,13 @@
 #include "texture.h"
 
 #include "core/core_string_names.h"
+#include "core/engine.h"
 #include "core/io/image_loader.h"
 #include "core/method_bind_ext.gen.inc"
 #include "core/os/os.h"
 #include "mesh.h"
 #include "scene/resources/bit_map.h"
+#include "scene/resources/texture_streamer.h"
 #include "servers/camera/camera_feed.h"
 
 Size2 Texture2D::get_size() const {
@@ -336,29 +338,56 @@ ImageTexture::~ImageTexture() {
 
 //////////////////////////////////////////
 
-Ref<Image> StreamTexture2D::load_image_from_file(FileAccess *f, int p_size_limit) {
+// A mipmap stored as a PNG, WebP or Basis Universal file, read but not decoded yet.
+struct StreamTextureBlob {
+	uint32_t data_format = 0;
+	int width = 0;
+	int height = 0;
+	Vector<uint8_t> data;
+	Ref<Image> image;
+};
+
+static void _unpack_blobs(void *p_userdata, uint32_t p_from, uint32_t p_to) {
+	StreamTextureBlob *blobs = (StreamTextureBlob *)p_userdata;
+	for (uint32_t i = p_from; i < p_to; i++) {
+		if (blobs[i].data_format == StreamTexture2D::DATA_FORMAT_BASIS_UNIVERSAL) {
+			blobs[i].image = Image::basis_universal_unpacker(blobs[i].data);
+		} else if (blobs[i].data_format == StreamTexture2D::DATA_FORMAT_LOSSLESS) {
+			blobs[i].image = Image::lossless_unpacker(blobs[i].data);
+		} else {
+			blobs[i].image = Image::lossy_unpacker(blobs[i].data);
+		}
+		blobs[i].data = Vector<uint8_t>(); // Not needed anymore.
+	}
+}
+
+// Returns the image stored at the current position of f, or appends its mipmaps to r_blobs when they
+// are stored as separate files, to be decoded later.
+static Ref<Image> _load_stream_texture_image(FileAccess *f, int p_size_limit, int *r_width, int *r_height, Vector<StreamTextureBlob> &r_blobs, uint64_t &r_blob_pixels) {
 	uint32_t data_format = f->get_32();
 	uint32_t w = f->get_16();
 	uint32_t h = f->get_16();
 	uint32_t mipmaps = f->get_32();
 	Image::Format format = Image::Format(f->get_32());
 
-	if (data_format == DATA_FORMAT_LOSSLESS || data_format == DATA_FORMAT_LOSSY || data_format == DATA_FORMAT_BASIS_UNIVERSAL) {
+	if (r_width) {
+		*r_width = w;
+	}
+	if (r_height) {
+		*r_height = h;
+	}
+
+	if (data_format == StreamTexture2D::DATA_FORMAT_LOSSLESS || data_format == StreamTexture2D::DATA_FORMAT_LOSSY || data_format == StreamTexture2D::DATA_FORMAT_BASIS_UNIVERSAL) {
 		//look for a PNG or WEBP file inside
 
 		int sw = w;
 		int sh = h;
 
 		//mipmaps need to be read independently, they will be later combined
-		Vector<Ref<Image>> mipmap_images;
-		int total_size = 0;
-
-		bool first = true;
-
 		for (uint32_t i = 0; i < mipmaps + 1; i++) {
 			uint32_t size = f->get_32();
 
-			if (p_size_limit > 0 && i < (mipmaps - 1) && (sw > p_size_limit || sh > p_size_limit)) {
+			if (p_size_limit > 0 && i < mipmaps && (sw > p_size_limit || sh > p_size_limit)) {
 				//can't load this due to size limit
 				sw = MAX(sw >> 1, 1);
 				sh = MAX(sh >> 1, 1);
@@ -366,107 +395,203 @@ Ref<Image> StreamTexture2D::load_image_from_file(FileAccess *f, int p_size_limit
 				continue;
 			}
 
-			Vector<uint8_t> pv;
-			pv.resize(size);
+			StreamTextureBlob blob;
+			blob.data_format = data_format;
+			blob.width = sw;
+			blob.height = sh;
+			blob.data.resize(size);
 			{
-				uint8_t *wr = pv.ptrw();
+				uint8_t *wr = blob.data.ptrw();
 				f->get_buffer(wr, size);
 			}
+			r_blobs.push_back(blob);
+			r_blob_pixels += sw * sh;
+
+			sw = MAX(sw >> 1, 1);
+			sh = MAX(sh >> 1, 1);
+		}
+
+		return Ref<Image>(); // Decoded by the caller.
+
+	} else if (data_format == StreamTexture2D::DATA_FORMAT_IMAGE) {
+		int size = Image::get_image_data_size(w, h, format, mipmaps ? true : false);
+
+		for (uint32_t i = 0; i < mipmaps + 1; i++) {
+			int tw = MAX(int(w >> i), 1);
+			int th = MAX(int(h >> i), 1);
+
+			if (p_size_limit > 0 && i < mipmaps && (tw > p_size_limit || th > p_size_limit)) {
+				continue; //oops, size limit enforced, go to next
+			}
 
-			Ref<Image> img;
-			if (data_format == DATA_FORMAT_BASIS_UNIVERSAL) {
-				img = Image::basis_universal_unpacker(pv);
-			} else if (data_format == DATA_FORMAT_LOSSLESS) {
-				img = Image::lossless_unpacker(pv);
-			} else {
-				img = Image::lossy_unpacker(pv);
+			int ofs = Image::get_image_mipmap_offset(w, h, format, i);
+			if (ofs) {
+				f->seek(f->get_position() + ofs);
 			}
 
-			if (img.is_null() || img->empty()) {
-				ERR_FAIL_COND_V(img.is_null() || img->empty(), Ref<Image>());
+			Vector<uint8_t> data;
+			data.resize(size - ofs);
+
+			{
+				uint8_t *wr = data.ptrw();
+				f->get_buffer(wr, data.size());
 			}
 
-			if (first) {
+			Ref<Image> image;
+			image.instance();
+
+			image->create(tw, th, mipmaps - i ? true : false, format, data);
+
+			return image;
+		}
+	}
+
+	return Ref<Image>();
+}
+
+Ref<Image> StreamTexture2D::load_image_from_file(FileAccess *f, int p_size_limit, int *r_width, int *r_height) {
+	Ref<Image> image;
+	load_images_from_file(f, 1, p_size_limit, &image, r_width, r_height);
+	return image;
+}
+
+void StreamTexture2D::load_images_from_file(FileAccess *f, int p_count, int p_size_limit, Ref<Image> *r_images, int *r_width, int *r_height) {
+	// Images whose mipmaps are stored as separate files, combined once all are decoded.
+	struct BlobImage {
+		int index = 0;
+		int first_blob = 0;
+		int blob_count = 0;
+	};
+
+	Vector<BlobImage> blob_images;
+	Vector<StreamTextureBlob> blobs;
+	uint64_t blob_pixels = 0;
+
+	for (int i = 0; i < p_count; i++) {
+		int first_blob = blobs.size();
+		r_images[i] = _load_stream_texture_image(f, p_size_limit, i == 0 ? r_width : nullptr, i == 0 ? r_height : nullptr, blobs, blob_pixels);
+		if (blobs.size() > first_blob) {
+			BlobImage bi;
+			bi.index = i;
+			bi.first_blob = first_blob;
+			bi.blob_count = blobs.size() - first_blob;
+			blob_images.push_back(bi);
+		}
+	}
+
+	if (blobs.size() == 0) {
+		return;
+	}
+
+	// Each mipmap (of each layer) is a file of its own, so they can all be decoded in parallel.
+	Image::process_rows(blobs.size(), blob_pixels / blobs.size(), _unpack_blobs, blobs.ptrw());
+
+	for (int i = 0; i < blob_images.size(); i++) {
+		const BlobImage &bi = blob_images[i];
+
+		Vector<Ref<Image>> mipmap_images;
+		int total_size = 0;
+		Image::Format format = Image::FORMAT_MAX;
+
+		for (int j = 0; j < bi.blob_count; j++) {
+			Ref<Image> img = blobs[bi.first_blob + j].image;
+			ERR_CONTINUE(img.is_null() || img->empty());
+
+			if (j == 0) {
 				//format will actually be the format of the first image,
 				//as it may have changed on compression
 				format = img->get_format();
-				first = false;
 			} else if (img->get_format() != format) {
 				img->convert(format); //all needs to be the same format
 			}
 
 			total_size += img->get_data().size();
-
 			mipmap_images.push_back(img);
-
-			sw = MAX(sw >> 1, 1);
-			sh = MAX(sh >> 1, 1);
 		}
 
-		//print_line("mipmap read total: " + itos(mipmap_images.size()));
-
-		Ref<Image> image;
-		image.instance();
+		if (mipmap_images.size() != bi.blob_count) {
+			continue; // Failed decoding, the image stays null.
+		}
 
 		if (mipmap_images.size() == 1) {
 			//only one image (which will most likely be the case anyway for this format)
-			image = mipmap_images[0];
-			return image;
+			r_images[bi.index] = mipmap_images[0];
+			continue;
+		}
 
-		} else {
-			//rarer use case, but needs to be supported
-			Vector<uint8_t> img_data;
-			img_data.resize(total_size);
+		//rarer use case, but needs to be supported
+		Vector<uint8_t> img_data;
+		img_data.resize(total_size);
 
-			{
-				uint8_t *wr = img_data.ptrw();
-
-				int ofs = 0;
-				for (int i = 0; i < mipmap_images.size(); i++) {
-					Vector<uint8_t> id = mipmap_images[i]->get_data();
-					int len = id.size();
-					const uint8_t *r = id.ptr();
-					copymem(&wr[ofs], r, len);
-					ofs += len;
-				}
-			}
+		{
+			uint8_t *wr = img_data.ptrw();
 
-			image->create(w, h, true, mipmap_images[0]->get_format(), img_data);
-			return image;
+			int ofs = 0;
+			for (int j = 0; j < mipmap_images.size(); j++) {
+				Vector<uint8_t> id = mipmap_images[j]->get_data();
+				int len = id.size();
+				const uint8_t *r = id.ptr();
+				copymem(&wr[ofs], r, len);
+				ofs += len;
+			}
 		}
 
-	} else if (data_format == DATA_FORMAT_IMAGE) {
-		int size = Image::get_image_data_size(w, h, format, mipmaps ? true : false);
-
-		for (uint32_t i = 0; i < mipmaps + 1; i++) {
-			int tw, th;
-			int ofs = Image::get_image_mipmap_offset_and_dimensions(w, h, format, i, tw, th);
+		Ref<Image> image;
+		image.instance();
+		image->create(blobs[bi.first_blob].width, blobs[bi.first_blob].height, true, format, img_data);
+		r_images[bi.index] = image;
+	}
+}
 
-			if (p_size_limit > 0 && i < mipmaps && (p_size_limit > tw || p_size_limit > th)) {
-				if (ofs) {
-					f->seek(f->get_position() + ofs);
-				}
-				continue; //oops, size limit enforced, go to next
-			}
+Ref<Image> StreamTexture2D::load_image_from_path(const String &p_path, int p_size_limit) {
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	ERR_FAIL_COND_V(!f, Ref<Image>());
 
-			Vector<uint8_t> data;
-			data.resize(size - ofs);
+	int tw_custom, th_custom, mipmap_limit;
+	uint32_t flags;
+	Error err = _read_header(f, tw_custom, th_custom, flags, mipmap_limit);
+	if (err != OK) {
+		memdelete(f);
+		return Ref<Image>();
+	}
 
-			{
-				uint8_t *wr = data.ptrw();
-				f->get_buffer(wr, data.size());
-			}
+	Ref<Image> image = load_image_from_file(f, p_size_limit);
+	memdelete(f);
+	return image;
+}
 
-			Ref<Image> image;
-			image.instance();
+void StreamTexture2D::_stream_upload(void *p_userdata, const Ref<Image> &p_image) {
+	StreamTexture2D *st = (StreamTexture2D *)p_userdata;
 
-			image->create(tw, th, mipmaps - i ? true : false, format, data);
+	RID new_texture = RS::get_singleton()->texture_2d_create(p_image);
+	RS::get_singleton()->texture_replace(st->texture, new_texture);
+	// Replacing takes the size and path of the new texture.
+	RS::get_singleton()->texture_set_size_override(st->texture, st->w, st->h);
+	RS::get_singleton()->texture_set_path(st->texture, st->get_path() == String() ? st->path_to_file : st->get_path());
+}
 
-			return image;
-		}
+void StreamTexture2D::_stream_unregister() {
+	if (!streamed) {
+		return;
 	}
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	if (streamer && streamer->is_texture_registered(texture)) {
+		streamer->unregister_texture(texture);
+	}
+	streamed = false;
+	stream_pinned = false;
+}
 
-	return Ref<Image>();
+void StreamTexture2D::_stream_pin() const {
+	// Canvas items give no feedback on their size on screen, so 2D uses keep all the mipmaps.
+	if (!streamed || stream_pinned) {
+		return;
+	}
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	if (streamer && streamer->is_texture_registered(texture)) {
+		streamer->set_texture_pinned(texture, true);
+	}
+	stream_pinned = true;
 }
 
 void StreamTexture2D::set_path(const String &p_path, bool p_take_over) {
@@ -506,30 +631,21 @@ Image::Format StreamTexture2D::get_format() const {
 	return format;
 }
 
-Error StreamTexture2D::_load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, Ref<Image> &image, bool &r_request_3d, bool &r_request_normal, bool &r_request_roughness, int &mipmap_limit, int p_size_limit) {
-	alpha_cache.unref();
-
-	ERR_FAIL_COND_V(image.is_null(), ERR_INVALID_PARAMETER);
-
-	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
-	ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
-
+Error StreamTexture2D::_read_header(FileAccess *f, int &tw_custom, int &th_custom, uint32_t &flags, int &mipmap_limit) {
 	uint8_t header[4];
 	f->get_buffer(header, 4);
 	if (header[0] != 'G' || header[1] != 'S' || header[2] != 'T' || header[3] != '2') {
-		memdelete(f);
 		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Stream texture file is corrupt (Bad header).");
 	}
 
 	uint32_t version = f->get_32();
 
 	if (version > FORMAT_VERSION) {
-		memdelete(f);
 		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Stream texture file is too new.");
 	}
 	tw_custom = f->get_32();
 	th_custom = f->get_32();
-	uint32_t df = f->get_32(); //data format
+	flags = f->get_32(); //data format
 
 	//skip reserved
 	mipmap_limit = int(f->get_32());
@@ -538,6 +654,24 @@ Error StreamTexture2D::_load_data(const String &p_path, int &tw, int &th, int &t
 	f->get_32();
 	f->get_32();
 
+	return OK;
+}
+
+Error StreamTexture2D::_load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, Ref<Image> &image, bool &r_request_3d, bool &r_request_normal, bool &r_request_roughness, int &mipmap_limit, int p_size_limit) {
+	alpha_cache.unref();
+
+	ERR_FAIL_COND_V(image.is_null(), ERR_INVALID_PARAMETER);
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
+
+	uint32_t df;
+	Error err = _read_header(f, tw_custom, th_custom, df, mipmap_limit);
+	if (err != OK) {
+		memdelete(f);
+		return err;
+	}
+
 #ifdef TOOLS_ENABLED
 
 	r_request_3d = request_3d_callback && df & FORMAT_BIT_DETECT_3D;
@@ -555,7 +689,7 @@ Error StreamTexture2D::_load_data(const String &p_path, int &tw, int &th, int &t
 		p_size_limit = 0;
 	}
 
-	image = load_image_from_file(f, p_size_limit);
+	image = load_image_from_file(f, p_size_limit, &tw, &th);
 
 	memdelete(f);
 
@@ -576,11 +710,17 @@ Error StreamTexture2D::load(const String &p_path) {
 	bool request_roughness;
 	int mipmap_limit;
 
-	Error err = _load_data(p_path, lw, lh, lwc, lhc, image, request_3d, request_normal, request_roughness, mipmap_limit);
+	// Only the small mipmaps are loaded here (if the texture was imported as streamed), the streamer loads the others.
+	TextureStreamer *streamer = TextureStreamer::get_singleton();
+	bool can_stream = streamer && streamer->is_enabled() && !Engine::get_singleton()->is_editor_hint();
+
+	Error err = _load_data(p_path, lw, lh, lwc, lhc, image, request_3d, request_normal, request_roughness, mipmap_limit, can_stream ? streamer->get_initial_size() : 0);
 	if (err) {
 		return err;
 	}
 
+	_stream_unregister();
+
 	if (texture.is_valid()) {
 		RID new_texture = RS::get_singleton()->texture_2d_create(image);
 		RS::get_singleton()->texture_replace(texture, new_texture);
@@ -596,6 +736,14 @@ Error StreamTexture2D::load(const String &p_path) {
 	path_to_file = p_path;
 	format = image->get_format();
 
+	if (can_stream && (image->get_width() < lw || image->get_height() < lh)) {
+		if (!(lwc || lhc)) {
+			RS::get_singleton()->texture_set_size_override(texture, w, h);
+		}
+		streamer->register_texture(texture, p_path, lw, lh, image, _stream_upload, this);
+		streamed = true;
+	}
+
 	if (get_path() == String()) {
 		//temporarily set path if no path set for resource, helps find errors
 		RenderingServer::get_singleton()->texture_set_path(texture, p_path);
@@ -656,6 +804,7 @@ void StreamTexture2D::draw(RID p_canvas_item, const Point2 &p_pos, const Color &
 	if ((w | h) == 0) {
 		return;
 	}
+	_stream_pin();
 	RID normal_rid = p_normal_map.is_valid() ? p_normal_map->get_rid() : RID();
 	RID specular_rid = p_specular_map.is_valid() ? p_specular_map->get_rid() : RID();
 	RenderingServer::get_singleton()->canvas_item_add_texture_rect(p_canvas_item, Rect2(p_pos, Size2(w, h)), texture, false, p_modulate, p_transpose, normal_rid, specular_rid, p_specular_color_shininess, p_texture_filter, p_texture_repeat);
@@ -665,6 +814,7 @@ void StreamTexture2D::draw_rect(RID p_canvas_item, const Rect2 &p_rect, bool p_t
 	if ((w | h) == 0) {
 		return;
 	}
+	_stream_pin();
 	RID normal_rid = p_normal_map.is_valid() ? p_normal_map->get_rid() : RID();
 	RID specular_rid = p_specular_map.is_valid() ? p_specular_map->get_rid() : RID();
 	RenderingServer::get_singleton()->canvas_item_add_texture_rect(p_canvas_item, p_rect, texture, p_tile, p_modulate, p_transpose, normal_rid, specular_rid, p_specular_color_shininess, p_texture_filter, p_texture_repeat);
@@ -674,6 +824,7 @@ void StreamTexture2D::draw_rect_region(RID p_canvas_item, const Rect2 &p_rect, c
 	if ((w | h) == 0) {
 		return;
 	}
+	_stream_pin();
 	RID normal_rid = p_normal_map.is_valid() ? p_normal_map->get_rid() : RID();
 	RID specular_rid = p_specular_map.is_valid() ? p_specular_map->get_rid() : RID();
 	RenderingServer::get_singleton()->canvas_item_add_texture_rect_region(p_canvas_item, p_rect, texture, p_src_rect, p_modulate, p_transpose, normal_rid, specular_rid, p_specular_color_shininess, p_clip_uv, p_texture_filter, p_texture_repeat);
@@ -757,6 +908,7 @@ StreamTexture2D::StreamTexture2D() {
 }
 
 StreamTexture2D::~StreamTexture2D() {
+	_stream_unregister();
 	if (texture.is_valid()) {
 		RS::get_singleton()->free(texture);
 	}
@@ -2090,10 +2242,9 @@ Error StreamTextureLayered::_load_data(const String &p_path, Vector<Ref<Image>>
 
 	images.resize(layer_count);
 
+	StreamTexture2D::load_images_from_file(f, layer_count, p_size_limit, images.ptrw());
 	for (uint32_t i = 0; i < layer_count; i++) {
-		Ref<Image> image = StreamTexture2D::load_image_from_file(f, p_size_limit);
-		ERR_FAIL_COND_V(image.is_null() || image->empty(), ERR_CANT_OPEN);
-		images.write[i] = image;
+		ERR_FAIL_COND_V(images[i].is_null() || images[i]->empty(), ERR_CANT_OPEN);
 	}
 
 	return OK;
@@ -157,6 +157,7 @@ public:
 	};
 
 private:
+	static Error _read_header(FileAccess *f, int &tw_custom, int &th_custom, uint32_t &flags, int &mipmap_limit);
 	Error _load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, Ref<Image> &image, bool &r_request_3d, bool &r_request_normal, bool &r_request_roughness, int &mipmap_limit, int p_size_limit = 0);
 	String path_to_file;
 	mutable RID texture;
@@ -164,6 +165,14 @@ private:
 	int w, h;
 	mutable Ref<BitMap> alpha_cache;
 
+	// Only the small mipmaps were loaded, the texture streamer loads the others when needed.
+	bool streamed = false;
+	mutable bool stream_pinned = false;
+
+	static void _stream_upload(void *p_userdata, const Ref<Image> &p_image);
+	void _stream_unregister();
+	void _stream_pin() const;
+
 	virtual void reload_from_file() override;
 
 	static void _requested_3d(void *p_ud);
@@ -175,7 +184,11 @@ protected:
 	void _validate_property(PropertyInfo &property) const override;
 
 public:
-	static Ref<Image> load_image_from_file(FileAccess *p_file, int p_size_limit);
+	static Ref<Image> load_image_from_file(FileAccess *p_file, int p_size_limit, int *r_width = nullptr, int *r_height = nullptr);
+	// Loads p_count images stored one after another, like the layers of a StreamTextureLayered.
+	// Mipmaps stored as PNG, WebP or Basis Universal files are decoded together on the image thread pool.
+	static void load_images_from_file(FileAccess *p_file, int p_count, int p_size_limit, Ref<Image> *r_images, int *r_width = nullptr, int *r_height = nullptr);
+	static Ref<Image> load_image_from_path(const String &p_path, int p_size_limit);
 
 	typedef void (*TextureFormatRequestCallback)(const Ref<StreamTexture2D> &);
 	typedef void (*TextureFormatRoughnessRequestCallback)(const Ref<StreamTexture2D> &, const String &p_normal_path, RS::TextureDetectRoughnessChannel p_roughness_channel);
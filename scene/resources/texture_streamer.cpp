@@ -0,0 +1,478 @@
+/*************************************************************************/
+/*  texture_streamer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "texture_streamer.h"
+
+#include "core/sort_array.h"
+#include "scene/resources/texture.h"
+#include "servers/rendering_server.h"
+
+class TextureStreamerFileStorage : public TextureStreamer::Storage {
+public:
+	virtual Ref<Image> load(const String &p_path, int p_size_limit) override {
+		return StreamTexture2D::load_image_from_path(p_path, p_size_limit);
+	}
+};
+
+static TextureStreamerFileStorage texture_streamer_file_storage;
+
+TextureStreamer *TextureStreamer::singleton = nullptr;
+
+TextureStreamer *TextureStreamer::get_singleton() {
+	return singleton;
+}
+
+void TextureStreamer::_thread_function(TextureStreamer *p_streamer) {
+	while (true) {
+		p_streamer->load_semaphore.wait();
+		if (p_streamer->exit.load()) {
+			break;
+		}
+		p_streamer->_run_pending_loads();
+	}
+}
+
+void TextureStreamer::_feedback_callback(void *p_userdata, const RID *p_textures, const float *p_sizes, int p_count) {
+	TextureStreamer *streamer = (TextureStreamer *)p_userdata;
+
+	MutexLock lock(streamer->mutex);
+	for (int i = 0; i < p_count; i++) {
+		Texture **texture = streamer->textures.getptr(p_textures[i]);
+		if (texture) {
+			(*texture)->feedback_size = MAX((*texture)->feedback_size, p_sizes[i]);
+		}
+	}
+}
+
+uint64_t TextureStreamer::_get_mipmap_memory(const Texture *p_texture, int p_mipmap) const {
+	int total = Image::get_image_mipmap_offset(p_texture->width, p_texture->height, p_texture->format, p_texture->mipmap_count + 1);
+	return total - Image::get_image_mipmap_offset(p_texture->width, p_texture->height, p_texture->format, p_mipmap);
+}
+
+int TextureStreamer::_get_mipmap_size_limit(const Texture *p_texture, int p_mipmap) const {
+	return MAX(MAX(p_texture->width >> p_mipmap, 1), MAX(p_texture->height >> p_mipmap, 1));
+}
+
+int TextureStreamer::_get_mipmap_for_screen_size(const Texture *p_texture, float p_screen_size) const {
+	// Smallest mipmap that still has a texel for each pixel the texture covers.
+	int size = MAX(p_texture->width, p_texture->height);
+	int mipmap = 0;
+	while (mipmap < p_texture->base_mipmap && (size >> (mipmap + 1)) >= p_screen_size) {
+		mipmap++;
+	}
+	return mipmap;
+}
+
+int TextureStreamer::_get_committed_mipmap(const Texture *p_texture) const {
+	return p_texture->loading_mipmap >= 0 ? p_texture->loading_mipmap : p_texture->resident_mipmap;
+}
+
+bool TextureStreamer::_evict_next(const LocalVector<Texture *> &p_victims, uint32_t &r_next, const Texture *p_for, uint64_t &r_memory) {
+	while (r_next < p_victims.size()) {
+		Texture *victim = p_victims[r_next++];
+		if (victim == p_for || victim->loading_mipmap >= 0) {
+			continue;
+		}
+
+		// Textures used at least as recently only give up the mipmaps they don't need anymore.
+		bool in_use = victim->last_used == frame || (p_for && victim->last_used >= p_for->last_used);
+		int keep = in_use ? victim->wanted_mipmap : victim->base_mipmap;
+		if (keep <= victim->resident_mipmap) {
+			continue;
+		}
+
+		r_memory -= _get_mipmap_memory(victim, victim->resident_mipmap) - _get_mipmap_memory(victim, keep);
+		_queue_load(victim, keep);
+		return true;
+	}
+	return false;
+}
+
+void TextureStreamer::_queue_load(Texture *p_texture, int p_mipmap) {
+	p_texture->loading_mipmap = p_mipmap;
+
+	Load load;
+	load.texture = p_texture->self;
+	load.version = p_texture->version;
+	load.path = p_texture->path;
+	load.mipmap = p_mipmap;
+	load.size_limit = _get_mipmap_size_limit(p_texture, p_mipmap);
+
+	load_mutex.lock();
+	pending_loads.push_back(load);
+	load_mutex.unlock();
+
+	if (thread_count) {
+		load_semaphore.post();
+	}
+}
+
+void TextureStreamer::_run_pending_loads() {
+	while (true) {
+		load_mutex.lock();
+		if (pending_loads.empty()) {
+			load_mutex.unlock();
+			break;
+		}
+		Load load = pending_loads[0];
+		pending_loads.remove(0);
+		load_mutex.unlock();
+
+		load.image = storage->load(load.path, load.size_limit);
+
+		load_mutex.lock();
+		finished_loads.push_back(load);
+		load_mutex.unlock();
+	}
+}
+
+void TextureStreamer::_apply_finished_loads() {
+	LocalVector<Load> loads;
+	load_mutex.lock();
+	for (uint32_t i = 0; i < finished_loads.size(); i++) {
+		loads.push_back(finished_loads[i]);
+	}
+	finished_loads.clear();
+	load_mutex.unlock();
+
+	for (uint32_t i = 0; i < loads.size(); i++) {
+		const Load &load = loads[i];
+
+		MutexLock upload_lock(upload_mutex);
+		mutex.lock();
+		Texture **texture_ptr = textures.getptr(load.texture);
+		if (!texture_ptr || (*texture_ptr)->version != load.version) {
+			// Unregistered (or registered again) while loading.
+			mutex.unlock();
+			continue;
+		}
+		Texture *texture = *texture_ptr;
+		texture->loading_mipmap = -1;
+
+		if (load.image.is_null() || load.image->empty() || load.image->get_width() != MAX(texture->width >> load.mipmap, 1)) {
+			mutex.unlock();
+			ERR_PRINT("Couldn't load the mipmaps of streamed texture '" + load.path + "'.");
+			continue;
+		}
+		texture->resident_mipmap = load.mipmap;
+		UploadCallback upload = texture->upload;
+		void *userdata = texture->userdata;
+		mutex.unlock();
+
+		// Outside the lock, uploading may wait for the rendering thread, which may be reporting feedback.
+		upload(userdata, load.image);
+	}
+}
+
+void TextureStreamer::init(int p_thread_count, uint64_t p_memory_budget, int p_initial_size) {
+	ERR_FAIL_COND(enabled);
+
+	enabled = true;
+	memory_budget = p_memory_budget;
+	initial_size = MAX(p_initial_size, 1);
+	thread_count = MAX(p_thread_count, 0);
+	exit.store(false);
+
+	if (thread_count) {
+		threads = memnew_arr(std::thread *, thread_count);
+		for (int i = 0; i < thread_count; i++) {
+			threads[i] = memnew(std::thread(TextureStreamer::_thread_function, this));
+		}
+	}
+
+	if (RenderingServer::get_singleton()) {
+		RenderingServer::get_singleton()->texture_set_stream_feedback_callback(_feedback_callback, this);
+	}
+}
+
+void TextureStreamer::finish() {
+	if (!enabled) {
+		return;
+	}
+
+	if (threads) {
+		exit.store(true);
+		for (int i = 0; i < thread_count; i++) {
+			load_semaphore.post();
+		}
+		for (int i = 0; i < thread_count; i++) {
+			threads[i]->join();
+			memdelete(threads[i]);
+		}
+		memdelete_arr(threads);
+		threads = nullptr;
+	}
+	thread_count = 0;
+
+	pending_loads.clear();
+	finished_loads.clear();
+
+	if (RenderingServer::get_singleton()) {
+		RenderingServer::get_singleton()->texture_set_stream_feedback_callback(nullptr, nullptr);
+	}
+
+	const RID *key = nullptr;
+	while ((key = textures.next(key))) {
+		if (RenderingServer::get_singleton()) {
+			RenderingServer::get_singleton()->texture_set_stream_feedback_enabled(*key, false);
+		}
+		memdelete(textures[*key]);
+	}
+	textures.clear();
+
+	enabled = false;
+}
+
+bool TextureStreamer::is_enabled() const {
+	return enabled;
+}
+
+void TextureStreamer::set_storage(Storage *p_storage) {
+	storage = p_storage ? p_storage : &texture_streamer_file_storage;
+}
+
+void TextureStreamer::set_memory_budget(uint64_t p_bytes) {
+	memory_budget = p_bytes;
+}
+
+uint64_t TextureStreamer::get_memory_budget() const {
+	return memory_budget;
+}
+
+uint64_t TextureStreamer::get_memory_usage() const {
+	MutexLock lock(mutex);
+
+	uint64_t memory = 0;
+	const RID *key = nullptr;
+	while ((key = textures.next(key))) {
+		const Texture *texture = textures[*key];
+		memory += _get_mipmap_memory(texture, _get_committed_mipmap(texture));
+	}
+	return memory;
+}
+
+int TextureStreamer::get_initial_size() const {
+	return initial_size;
+}
+
+void TextureStreamer::register_texture(RID p_texture, const String &p_path, int p_width, int p_height, const Ref<Image> &p_resident_image, UploadCallback p_upload, void *p_userdata) {
+	ERR_FAIL_COND(!enabled);
+	ERR_FAIL_COND(p_resident_image.is_null() || p_resident_image->empty());
+	ERR_FAIL_COND(p_width <= 0 || p_height <= 0);
+	ERR_FAIL_COND(!p_upload);
+
+	// The resident image must be one of the mipmaps of the full texture.
+	int resident_mipmap = 0;
+	int required_mipmaps = Image::get_image_required_mipmaps(p_width, p_height, p_resident_image->get_format());
+	while (resident_mipmap < required_mipmaps && (MAX(p_width >> resident_mipmap, 1) != p_resident_image->get_width() || MAX(p_height >> resident_mipmap, 1) != p_resident_image->get_height())) {
+		resident_mipmap++;
+	}
+	ERR_FAIL_COND_MSG(MAX(p_width >> resident_mipmap, 1) != p_resident_image->get_width() || MAX(p_height >> resident_mipmap, 1) != p_resident_image->get_height(), "The resident image of streamed texture '" + p_path + "' isn't one of its mipmaps.");
+
+	MutexLock lock(mutex);
+	ERR_FAIL_COND_MSG(textures.has(p_texture), "Texture '" + p_path + "' is already streamed.");
+
+	Texture *texture = memnew(Texture);
+	texture->self = p_texture;
+	texture->path = p_path;
+	texture->width = p_width;
+	texture->height = p_height;
+	texture->format = p_resident_image->get_format();
+	texture->mipmap_count = resident_mipmap + p_resident_image->get_mipmap_count();
+	texture->base_mipmap = resident_mipmap;
+	texture->resident_mipmap = resident_mipmap;
+	texture->wanted_mipmap = resident_mipmap;
+	texture->version = ++last_version;
+	texture->last_used = frame;
+	texture->upload = p_upload;
+	texture->userdata = p_userdata;
+	textures.set(p_texture, texture);
+
+	if (RenderingServer::get_singleton()) {
+		RenderingServer::get_singleton()->texture_set_stream_feedback_enabled(p_texture, true);
+	}
+}
+
+void TextureStreamer::unregister_texture(RID p_texture) {
+	// An upload to this texture may be running outside the texture lock, wait for it.
+	MutexLock upload_lock(upload_mutex);
+	MutexLock lock(mutex);
+
+	Texture **texture = textures.getptr(p_texture);
+	ERR_FAIL_COND(!texture);
+	// Loads in flight are discarded when they finish.
+	memdelete(*texture);
+	textures.erase(p_texture);
+
+	if (RenderingServer::get_singleton()) {
+		RenderingServer::get_singleton()->texture_set_stream_feedback_enabled(p_texture, false);
+	}
+}
+
+bool TextureStreamer::is_texture_registered(RID p_texture) const {
+	MutexLock lock(mutex);
+	return textures.has(p_texture);
+}
+
+void TextureStreamer::report_usage(RID p_texture, float p_screen_size) {
+	_feedback_callback(this, &p_texture, &p_screen_size, 1);
+}
+
+void TextureStreamer::set_texture_pinned(RID p_texture, bool p_pinned) {
+	MutexLock lock(mutex);
+
+	Texture **texture = textures.getptr(p_texture);
+	ERR_FAIL_COND(!texture);
+	(*texture)->pinned = p_pinned;
+}
+
+int TextureStreamer::get_resident_mipmap(RID p_texture) const {
+	MutexLock lock(mutex);
+
+	Texture *const *texture = textures.getptr(p_texture);
+	ERR_FAIL_COND_V(!texture, -1);
+	return (*texture)->resident_mipmap;
+}
+
+bool TextureStreamer::has_pending_loads() const {
+	MutexLock lock(mutex);
+
+	const RID *key = nullptr;
+	while ((key = textures.next(key))) {
+		if (textures[*key]->loading_mipmap >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+struct TextureStreamerRequestSort {
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T *p_a, const T *p_b) const {
+		// Most recently used first, then the ones missing the most detail.
+		if (p_a->last_used != p_b->last_used) {
+			return p_a->last_used > p_b->last_used;
+		}
+		return p_a->resident_mipmap - p_a->wanted_mipmap > p_b->resident_mipmap - p_b->wanted_mipmap;
+	}
+};
+
+struct TextureStreamerVictimSort {
+	template <class T>
+	_FORCE_INLINE_ bool operator()(const T *p_a, const T *p_b) const {
+		return p_a->last_used < p_b->last_used;
+	}
+};
+
+void TextureStreamer::update() {
+	if (!enabled) {
+		return;
+	}
+
+	_apply_finished_loads();
+
+	mutex.lock();
+	frame++;
+
+	uint64_t memory = 0;
+	int pending = 0;
+	LocalVector<Texture *> requests;
+	LocalVector<Texture *> victims;
+
+	const RID *key = nullptr;
+	while ((key = textures.next(key))) {
+		Texture *texture = textures[*key];
+		if (texture->pinned || texture->feedback_size > 0.0) {
+			texture->last_used = frame;
+			texture->wanted_mipmap = texture->pinned ? 0 : _get_mipmap_for_screen_size(texture, texture->feedback_size);
+			texture->feedback_size = 0.0;
+		}
+
+		memory += _get_mipmap_memory(texture, _get_committed_mipmap(texture));
+		if (texture->loading_mipmap >= 0) {
+			if (texture->loading_mipmap < texture->resident_mipmap) {
+				pending++;
+			}
+		} else if (texture->wanted_mipmap < texture->resident_mipmap) {
+			requests.push_back(texture);
+		}
+		victims.push_back(texture);
+	}
+
+	SortArray<Texture *, TextureStreamerRequestSort> request_sort;
+	request_sort.sort(requests.ptr(), requests.size());
+	SortArray<Texture *, TextureStreamerVictimSort> victim_sort;
+	victim_sort.sort(victims.ptr(), victims.size());
+
+	uint32_t next_victim = 0;
+	for (uint32_t i = 0; i < requests.size() && pending < MAX_PENDING_LOADS; i++) {
+		Texture *texture = requests[i];
+		uint64_t resident_memory = _get_mipmap_memory(texture, texture->resident_mipmap);
+
+		int mipmap = texture->wanted_mipmap;
+		while (mipmap < texture->resident_mipmap && memory - resident_memory + _get_mipmap_memory(texture, mipmap) > memory_budget) {
+			// Make room by dropping mipmaps of the least recently used textures, or settle for fewer.
+			if (!_evict_next(victims, next_victim, texture, memory)) {
+				mipmap++;
+			}
+		}
+
+		if (mipmap < texture->resident_mipmap) {
+			memory += _get_mipmap_memory(texture, mipmap) - resident_memory;
+			_queue_load(texture, mipmap);
+			pending++;
+		}
+	}
+
+	// The budget may have been lowered.
+	while (memory > memory_budget) {
+		if (!_evict_next(victims, next_victim, nullptr, memory)) {
+			break;
+		}
+	}
+
+	mutex.unlock();
+
+	if (!thread_count) {
+		_run_pending_loads();
+		_apply_finished_loads();
+	}
+}
+
+TextureStreamer::TextureStreamer() {
+	storage = &texture_streamer_file_storage;
+	exit.store(false);
+	singleton = this;
+}
+
+TextureStreamer::~TextureStreamer() {
+	finish();
+	singleton = nullptr;
+}
@@ -0,0 +1,172 @@
+/*************************************************************************/
+/*  texture_streamer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include "core/hash_map.h"
+#include "core/image.h"
+#include "core/local_vector.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/rid.h"
+
+#include <atomic>
+#include <thread>
+
+// Keeps the large mipmaps of streamed textures in video memory only while they are needed.
+// Textures are registered with their small mipmaps loaded. The rendering server reports how large
+// each one was drawn on screen, and update() loads the mipmaps needed for that size within a memory
+// budget. When over budget, the least recently used textures drop back to their small mipmaps.
+class TextureStreamer {
+public:
+	// Reads the mipmaps of streamed textures, called from the loading threads.
+	class Storage {
+	public:
+		// Returns the mipmaps no larger than p_size_limit in either dimension, as a single image.
+		virtual Ref<Image> load(const String &p_path, int p_size_limit) = 0;
+		virtual ~Storage() {}
+	};
+
+	// Replaces the texture with the mipmaps just loaded, always called from update().
+	typedef void (*UploadCallback)(void *p_userdata, const Ref<Image> &p_image);
+
+private:
+	enum {
+		MAX_PENDING_LOADS = 16, // Loads that add mipmaps, dropping mipmaps is never limited.
+	};
+
+	struct Texture {
+		RID self;
+		String path;
+		int width = 0;
+		int height = 0;
+		Image::Format format = Image::FORMAT_MAX;
+		int mipmap_count = 0;
+		int base_mipmap = 0; // Loaded on registration and never dropped.
+		int resident_mipmap = 0; // Largest mipmap in video memory, 0 is full resolution.
+		int wanted_mipmap = 0;
+		int loading_mipmap = -1; // Target of the load in flight, if any.
+		uint32_t version = 0;
+		uint64_t last_used = 0;
+		float feedback_size = 0.0; // Largest screen size reported since the last update.
+		bool pinned = false;
+		UploadCallback upload = nullptr;
+		void *userdata = nullptr;
+	};
+
+	struct Load {
+		RID texture;
+		uint32_t version = 0;
+		String path;
+		int mipmap = 0;
+		int size_limit = 0;
+		Ref<Image> image;
+	};
+
+	static TextureStreamer *singleton;
+
+	Storage *storage = nullptr;
+	bool enabled = false;
+	uint64_t memory_budget = 0;
+	int initial_size = 64;
+	uint64_t frame = 0;
+	uint32_t last_version = 0;
+
+	// Guards the textures, feedback may arrive from the rendering thread at any time.
+	mutable Mutex mutex;
+	HashMap<RID, Texture *> textures;
+
+	// Held while a texture's upload callback runs, so unregistering waits for it to return
+	// before the texture (and its callback userdata) can go away. Taken before mutex.
+	Mutex upload_mutex;
+
+	// Guards the load queues, shared with the loading threads.
+	mutable Mutex load_mutex;
+	Semaphore load_semaphore;
+	LocalVector<Load> pending_loads;
+	LocalVector<Load> finished_loads;
+	std::thread **threads = nullptr;
+	int thread_count = 0;
+	std::atomic<bool> exit;
+
+	static void _thread_function(TextureStreamer *p_streamer);
+	static void _feedback_callback(void *p_userdata, const RID *p_textures, const float *p_sizes, int p_count);
+
+	uint64_t _get_mipmap_memory(const Texture *p_texture, int p_mipmap) const;
+	int _get_mipmap_size_limit(const Texture *p_texture, int p_mipmap) const;
+	int _get_mipmap_for_screen_size(const Texture *p_texture, float p_screen_size) const;
+	int _get_committed_mipmap(const Texture *p_texture) const;
+
+	bool _evict_next(const LocalVector<Texture *> &p_victims, uint32_t &r_next, const Texture *p_for, uint64_t &r_memory);
+	void _queue_load(Texture *p_texture, int p_mipmap);
+	void _run_pending_loads();
+	void _apply_finished_loads();
+
+public:
+	static TextureStreamer *get_singleton();
+
+	// With no threads, mipmaps are loaded inside update().
+	void init(int p_thread_count, uint64_t p_memory_budget, int p_initial_size);
+	void finish();
+	bool is_enabled() const;
+
+	// Used when none is set, reads the .stex files written by the texture importer.
+	void set_storage(Storage *p_storage);
+
+	void set_memory_budget(uint64_t p_bytes);
+	uint64_t get_memory_budget() const;
+	// Video memory of the streamed textures, counting loads in flight at their target size.
+	uint64_t get_memory_usage() const;
+
+	// Largest size the mipmaps loaded at registration can have.
+	int get_initial_size() const;
+
+	// p_resident_image holds the mipmaps already uploaded, p_width and p_height are the full size.
+	void register_texture(RID p_texture, const String &p_path, int p_width, int p_height, const Ref<Image> &p_resident_image, UploadCallback p_upload, void *p_userdata);
+	void unregister_texture(RID p_texture);
+	bool is_texture_registered(RID p_texture) const;
+
+	// Size in pixels the texture covered on screen, may be called from any thread.
+	void report_usage(RID p_texture, float p_screen_size);
+	// Pinned textures keep all their mipmaps, for uses that give no feedback (such as 2D).
+	void set_texture_pinned(RID p_texture, bool p_pinned);
+
+	int get_resident_mipmap(RID p_texture) const;
+	bool has_pending_loads() const;
+
+	// Turns the usage reported since the last call into loads, and applies the finished ones.
+	void update();
+
+	TextureStreamer();
+	~TextureStreamer();
+};
+
+#endif // TEXTURE_STREAMER_H
@@ -0,0 +1,352 @@
+/*************************************************************************/
+/*  audio_decode_ahead.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "audio_decode_ahead.h"
+
+#include "core/math/math_funcs.h"
+
+AudioDecodePool *AudioDecodePool::singleton = nullptr;
+
+AudioDecodePool *AudioDecodePool::get_singleton() {
+	return singleton;
+}
+
+void AudioDecodePool::_thread_function(AudioDecodePool *p_pool) {
+	while (true) {
+		p_pool->semaphore.wait();
+		if (p_pool->exit.load()) {
+			break;
+		}
+
+		Ref<AudioStreamPlaybackDecodeAhead> playback;
+		p_pool->mutex.lock();
+		if (p_pool->queue_count) {
+			playback = p_pool->queue[p_pool->queue_head];
+			p_pool->queue[p_pool->queue_head].unref();
+			p_pool->queue_head = (p_pool->queue_head + 1) % QUEUE_SIZE;
+			p_pool->queue_count--;
+		}
+		p_pool->mutex.unlock();
+
+		if (playback.is_valid()) {
+			playback->_decode_ahead(playback->ring_size);
+			playback->decoding.store(false);
+		}
+	}
+}
+
+void AudioDecodePool::init(int p_thread_count, int p_buffer_msec) {
+	ERR_FAIL_COND(threads != nullptr);
+
+	buffer_msec = MAX(p_buffer_msec, 10);
+	thread_count = MAX(p_thread_count, 0);
+	exit.store(false);
+
+	if (thread_count) {
+		threads = memnew_arr(std::thread *, thread_count);
+		for (int i = 0; i < thread_count; i++) {
+			threads[i] = memnew(std::thread(AudioDecodePool::_thread_function, this));
+		}
+	}
+}
+
+void AudioDecodePool::finish() {
+	if (threads) {
+		exit.store(true);
+		for (int i = 0; i < thread_count; i++) {
+			semaphore.post();
+		}
+		for (int i = 0; i < thread_count; i++) {
+			threads[i]->join();
+			memdelete(threads[i]);
+		}
+		memdelete_arr(threads);
+		threads = nullptr;
+	}
+	thread_count = 0;
+
+	for (uint32_t i = 0; i < queue_count; i++) {
+		Ref<AudioStreamPlaybackDecodeAhead> &playback = queue[(queue_head + i) % QUEUE_SIZE];
+		playback->decoding.store(false);
+		playback.unref();
+	}
+	queue_head = 0;
+	queue_count = 0;
+}
+
+int AudioDecodePool::get_thread_count() const {
+	return thread_count;
+}
+
+int AudioDecodePool::get_buffer_msec() const {
+	return buffer_msec;
+}
+
+bool AudioDecodePool::queue_decode(AudioStreamPlaybackDecodeAhead *p_playback) {
+	mutex.lock();
+	if (!thread_count || queue_count == QUEUE_SIZE) {
+		mutex.unlock();
+		return false;
+	}
+	queue[(queue_head + queue_count) % QUEUE_SIZE] = Ref<AudioStreamPlaybackDecodeAhead>(p_playback);
+	queue_count++;
+	mutex.unlock();
+
+	semaphore.post();
+	return true;
+}
+
+void AudioDecodePool::add_underrun() {
+	underruns.fetch_add(1);
+}
+
+uint64_t AudioDecodePool::get_underrun_count() const {
+	return underruns.load();
+}
+
+AudioDecodePool::AudioDecodePool() {
+	exit.store(false);
+	underruns.store(0);
+	singleton = this;
+}
+
+AudioDecodePool::~AudioDecodePool() {
+	finish();
+	singleton = nullptr;
+}
+
+//////////////////////////////
+
+void AudioStreamPlaybackDecodeAhead::_init_decode_ahead(float p_mix_rate) {
+	ERR_FAIL_COND(ring != nullptr);
+
+	int msec = AudioDecodePool::get_singleton() ? AudioDecodePool::get_singleton()->get_buffer_msec() : 250;
+	ring_size = next_power_of_2(MAX(uint32_t(p_mix_rate * msec / 1000), uint32_t(PRIME_FRAMES * 2)));
+	ring_mask = ring_size - 1;
+	ring = memnew_arr(AudioFrame, ring_size);
+}
+
+// Only called by the holder of the decoder.
+void AudioStreamPlaybackDecodeAhead::_decode_ahead(uint32_t p_max_frames) {
+	uint32_t gen = generation.load();
+	if (decoded_generation.load() != gen) {
+		// Started, seeked or stopped since the last decode. The audio thread doesn't read
+		// until decoded_generation matches again, so the ring can be reset from here.
+		decoded_end.store(false);
+		write_pos.store(read_pos.load());
+		float position = start_position.load();
+		if (position >= 0) {
+			_decode_seek(position);
+		}
+		decoded_generation.store(gen);
+	}
+
+	if (start_position.load() < 0 || decoded_end.load()) {
+		return;
+	}
+
+	uint32_t w = write_pos.load();
+	uint32_t todo = MIN(ring_size - (w - read_pos.load()), p_max_frames);
+	while (todo) {
+		uint32_t offset = w & ring_mask;
+		int chunk = MIN(MIN(todo, ring_size - offset), uint32_t(DECODE_CHUNK));
+		int decoded = _decode(&ring[offset], chunk);
+		w += decoded;
+		todo -= decoded;
+		write_pos.store(w);
+
+		if (decoded < chunk) {
+			decoded_end.store(true);
+			break;
+		}
+		if (generation.load() != gen) {
+			break; // Restarted meanwhile, these frames won't be played.
+		}
+	}
+}
+
+void AudioStreamPlaybackDecodeAhead::_restart(float p_position) {
+	ERR_FAIL_COND_MSG(!ring, "Decode ahead buffer not initialized.");
+
+	start_position.store(p_position);
+	generation.fetch_add(1);
+	frames_played = 0;
+
+	AudioDecodePool *pool = AudioDecodePool::get_singleton();
+	bool threaded = !synchronous && pool && pool->get_thread_count();
+	if (p_position < 0 || !threaded) {
+		return; // Stopping, or decoding as it's mixed.
+	}
+
+	// Prime a little on this thread if no pool thread holds the decoder, the rest is decoded ahead.
+	bool expected = false;
+	if (decoding.compare_exchange_strong(expected, true)) {
+		_decode_ahead(PRIME_FRAMES);
+		if (!pool->queue_decode(this)) {
+			decoding.store(false);
+		}
+	}
+}
+
+void AudioStreamPlaybackDecodeAhead::_mix_internal(AudioFrame *p_buffer, int p_frames) {
+	int done = 0;
+
+	if (active) {
+		AudioDecodePool *pool = AudioDecodePool::get_singleton();
+		bool threaded = !synchronous && pool && pool->get_thread_count();
+
+		// Just switched from threaded decoding, and a pool thread still holds the decoder.
+		// Don't wait for it, the frames are mixed once it's done.
+		bool held = synchronous && decoding.load();
+
+		uint32_t available = 0;
+		bool end = false;
+		while (!held) {
+			if (!threaded) {
+				_decode_ahead(p_frames - done);
+			}
+
+			int copied = 0;
+			if (decoded_generation.load() == generation.load()) {
+				// The end flag is stored after the last frames, so it's loaded before them.
+				end = decoded_end.load();
+				uint32_t r = read_pos.load();
+				available = write_pos.load() - r;
+
+				copied = MIN(available, uint32_t(p_frames - done));
+				uint32_t offset = r & ring_mask;
+				uint32_t first = MIN(uint32_t(copied), ring_size - offset);
+				for (uint32_t i = 0; i < first; i++) {
+					p_buffer[done + i] = ring[offset + i];
+				}
+				for (uint32_t i = first; i < uint32_t(copied); i++) {
+					p_buffer[done + i] = ring[i - first];
+				}
+				read_pos.store(r + copied);
+				frames_played += copied;
+				available -= copied;
+				done += copied;
+			}
+
+			// Without threads, mixing more than the ring holds takes several decodes.
+			if (threaded || done == p_frames || end || copied == 0) {
+				break;
+			}
+		}
+
+		if (done < p_frames) {
+			if (end) {
+				active = false;
+			} else {
+				underruns++;
+				if (pool) {
+					pool->add_underrun();
+				}
+			}
+		}
+
+		if (threaded && !end && available < ring_size / 2) {
+			bool expected = false;
+			if (decoding.compare_exchange_strong(expected, true) && !pool->queue_decode(this)) {
+				decoding.store(false);
+			}
+		}
+	}
+
+	for (int i = done; i < p_frames; i++) {
+		p_buffer[i] = AudioFrame(0, 0);
+	}
+}
+
+float AudioStreamPlaybackDecodeAhead::get_start_position() const {
+	return MAX(start_position.load(), 0.0f);
+}
+
+uint64_t AudioStreamPlaybackDecodeAhead::get_frames_played() const {
+	return frames_played;
+}
+
+void AudioStreamPlaybackDecodeAhead::start(float p_from_pos) {
+	active = true;
+	_restart(MAX(p_from_pos, 0.0f));
+	_begin_resample();
+}
+
+void AudioStreamPlaybackDecodeAhead::stop() {
+	active = false;
+	_restart(-1);
+}
+
+bool AudioStreamPlaybackDecodeAhead::is_playing() const {
+	return active;
+}
+
+void AudioStreamPlaybackDecodeAhead::seek(float p_time) {
+	if (!active) {
+		return;
+	}
+	_restart(MAX(p_time, 0.0f));
+}
+
+int AudioStreamPlaybackDecodeAhead::get_underrun_count() const {
+	return underruns;
+}
+
+void AudioStreamPlaybackDecodeAhead::set_synchronous(bool p_enabled) {
+	synchronous = p_enabled;
+}
+
+bool AudioStreamPlaybackDecodeAhead::is_synchronous() const {
+	return synchronous;
+}
+
+void AudioStreamPlaybackDecodeAhead::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_underrun_count"), &AudioStreamPlaybackDecodeAhead::get_underrun_count);
+	ClassDB::bind_method(D_METHOD("set_synchronous", "enabled"), &AudioStreamPlaybackDecodeAhead::set_synchronous);
+	ClassDB::bind_method(D_METHOD("is_synchronous"), &AudioStreamPlaybackDecodeAhead::is_synchronous);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "synchronous"), "set_synchronous", "is_synchronous");
+}
+
+AudioStreamPlaybackDecodeAhead::AudioStreamPlaybackDecodeAhead() {
+	generation.store(0);
+	start_position.store(-1);
+	read_pos.store(0);
+	decoded_generation.store(0);
+	write_pos.store(0);
+	decoded_end.store(false);
+	decoding.store(false);
+}
+
+AudioStreamPlaybackDecodeAhead::~AudioStreamPlaybackDecodeAhead() {
+	if (ring) {
+		memdelete_arr(ring);
+	}
+}
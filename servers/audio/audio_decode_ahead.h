@@ -0,0 +1,156 @@
+/*************************************************************************/
+/*  audio_decode_ahead.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AUDIO_DECODE_AHEAD_H
+#define AUDIO_DECODE_AHEAD_H
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "servers/audio/audio_stream.h"
+
+#include <atomic>
+#include <thread>
+
+class AudioStreamPlaybackDecodeAhead;
+
+// Threads decoding compressed streams ahead of the audio thread.
+// Playbacks queue themselves when their buffer runs low, the audio thread never waits for them.
+class AudioDecodePool {
+	enum {
+		QUEUE_SIZE = 1024, // Fixed, so queuing doesn't allocate on the audio thread.
+	};
+
+	static AudioDecodePool *singleton;
+
+	std::thread **threads = nullptr;
+	int thread_count = 0;
+	int buffer_msec = 250;
+	std::atomic<bool> exit;
+	std::atomic<uint64_t> underruns;
+
+	Mutex mutex;
+	Semaphore semaphore;
+	Ref<AudioStreamPlaybackDecodeAhead> queue[QUEUE_SIZE];
+	uint32_t queue_head = 0;
+	uint32_t queue_count = 0;
+
+	static void _thread_function(AudioDecodePool *p_pool);
+
+public:
+	static AudioDecodePool *get_singleton();
+
+	// With no threads, streams are decoded on the audio thread as they are mixed.
+	void init(int p_thread_count, int p_buffer_msec);
+	void finish();
+
+	int get_thread_count() const;
+	int get_buffer_msec() const;
+
+	bool queue_decode(AudioStreamPlaybackDecodeAhead *p_playback);
+
+	void add_underrun();
+	uint64_t get_underrun_count() const;
+
+	AudioDecodePool();
+	~AudioDecodePool();
+};
+
+// Base for playbacks of compressed streams. Frames are decoded into a ring buffer on the
+// AudioDecodePool threads, mixing only copies them out, and starting or seeking only
+// discards what was decoded past the new position.
+class AudioStreamPlaybackDecodeAhead : public AudioStreamPlaybackResampled {
+	GDCLASS(AudioStreamPlaybackDecodeAhead, AudioStreamPlaybackResampled);
+
+	friend class AudioDecodePool;
+
+	enum {
+		PRIME_FRAMES = 512, // Decoded right away on start, so playback doesn't begin with an underrun.
+		DECODE_CHUNK = 1024, // Frames decoded between checks for a restart.
+	};
+
+	AudioFrame *ring = nullptr;
+	uint32_t ring_size = 0;
+	uint32_t ring_mask = 0;
+
+	// Written by the audio thread, start and stop bump the generation so the decoder restarts.
+	std::atomic<uint32_t> generation;
+	std::atomic<float> start_position;
+	std::atomic<uint32_t> read_pos;
+	bool active = false;
+	bool synchronous = false;
+	uint64_t frames_played = 0;
+	uint32_t underruns = 0;
+
+	// Written by whoever holds the decoder: a pool thread, or the audio thread while priming.
+	std::atomic<uint32_t> decoded_generation;
+	std::atomic<uint32_t> write_pos;
+	std::atomic<bool> decoded_end;
+	std::atomic<bool> decoding; // Set while queued or decoding, the holder owns the decoder.
+
+	void _decode_ahead(uint32_t p_max_frames);
+	void _restart(float p_position);
+
+protected:
+	static void _bind_methods();
+
+	// Allocates the ring buffer, must be called before the first start().
+	void _init_decode_ahead(float p_mix_rate);
+
+	// Implemented by the decoders, never called from two threads at once.
+	virtual void _decode_seek(float p_time) = 0;
+	// Returns less than p_frames once the stream ends, loops are up to the decoder.
+	virtual int _decode(AudioFrame *p_buffer, int p_frames) = 0;
+
+	virtual void _mix_internal(AudioFrame *p_buffer, int p_frames) override;
+
+	// Position of the last start or seek, and frames mixed since.
+	float get_start_position() const;
+	uint64_t get_frames_played() const;
+
+public:
+	virtual void start(float p_from_pos = 0.0) override;
+	virtual void stop() override;
+	virtual bool is_playing() const override;
+	virtual void seek(float p_time) override;
+
+	// Times the audio thread found fewer frames than it needed and mixed silence instead.
+	int get_underrun_count() const;
+
+	// For consumers mixing faster than real time off the audio thread, like waveform previews.
+	// Frames are decoded on the mixing thread as they are needed, so they never underrun,
+	// except right after switching while a pool thread still holds the decoder.
+	void set_synchronous(bool p_enabled);
+	bool is_synchronous() const;
+
+	AudioStreamPlaybackDecodeAhead();
+	~AudioStreamPlaybackDecodeAhead();
+};
+
+#endif // AUDIO_DECODE_AHEAD_H
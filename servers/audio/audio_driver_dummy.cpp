@@ -48,7 +48,9 @@ Error AudioDriverDummy::init() {
 
 	samples_in = memnew_arr(int32_t, buffer_frames * channels);
 
-	thread = Thread::create(AudioDriverDummy::thread_func, this);
+	if (use_threads) {
+		thread = Thread::create(AudioDriverDummy::thread_func, this);
+	}
 
 	return OK;
 };
@@ -99,18 +101,29 @@ void AudioDriverDummy::unlock() {
 	mutex.unlock();
 };
 
+void AudioDriverDummy::set_use_threads(bool p_use_threads) {
+	ERR_FAIL_COND_MSG(thread, "The dummy audio driver is already running its thread.");
+	use_threads = p_use_threads;
+}
+
+void AudioDriverDummy::mix_audio(int p_frames, int32_t *p_buffer) {
+	ERR_FAIL_COND(!active);
+	ERR_FAIL_COND_MSG(thread, "The dummy audio driver mixes in its own thread.");
+
+	audio_server_process(p_frames, p_buffer);
+}
+
 void AudioDriverDummy::finish() {
-	if (!thread) {
-		return;
-	}
+	if (thread) {
+		exit_thread = true;
+		Thread::wait_to_finish(thread);
 
-	exit_thread = true;
-	Thread::wait_to_finish(thread);
+		memdelete(thread);
+		thread = nullptr;
+	}
 
 	if (samples_in) {
 		memdelete_arr(samples_in);
+		samples_in = nullptr;
 	};
-
-	memdelete(thread);
-	thread = nullptr;
 };
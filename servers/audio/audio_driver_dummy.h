@@ -40,7 +40,7 @@ class AudioDriverDummy : public AudioDriver {
 	Thread *thread = nullptr;
 	Mutex mutex;
 
-	int32_t *samples_in;
+	int32_t *samples_in = nullptr;
 
 	static void thread_func(void *p_udata);
 
@@ -54,6 +54,8 @@ class AudioDriverDummy : public AudioDriver {
 	bool thread_exited;
 	mutable bool exit_thread;
 
+	bool use_threads = true;
+
 public:
 	const char *get_name() const {
 		return "Dummy";
@@ -67,6 +69,10 @@ public:
 	virtual void unlock();
 	virtual void finish();
 
+	// Without threads nothing is mixed until mix_audio() is called, useful for headless runs and benchmarks.
+	void set_use_threads(bool p_use_threads);
+	void mix_audio(int p_frames, int32_t *p_buffer);
+
 	AudioDriverDummy() {}
 	~AudioDriverDummy() {}
 };
@@ -30,6 +30,8 @@
 
 #include "audio_filter_sw.h"
 
+#include "servers/audio/audio_mix_kernels.h"
+
 void AudioFilterSW::set_mode(Mode p_mode) {
 	mode = p_mode;
 }
@@ -275,3 +277,73 @@ void AudioFilterSW::Processor::process(float *p_samples, int p_amount, int p_str
 		}
 	}
 }
+
+void AudioFilterSW::Processor::process_stereo(Processor *p_left, Processor *p_right, int p_stages, const AudioFrame *p_src, AudioFrame *p_dst, int p_frames) {
+	ERR_FAIL_COND(p_stages < 1 || p_stages > MAX_STEREO_STAGES);
+
+#ifdef SIMD_ENABLED
+	if (AudioMixKernels::is_simd_enabled()) {
+		// Left and right run in the two low lanes, with the same operation order as process_one().
+		AudioVec4 b0[MAX_STEREO_STAGES], b1[MAX_STEREO_STAGES], b2[MAX_STEREO_STAGES], a1[MAX_STEREO_STAGES], a2[MAX_STEREO_STAGES];
+		AudioVec4 ha1[MAX_STEREO_STAGES], ha2[MAX_STEREO_STAGES], hb1[MAX_STEREO_STAGES], hb2[MAX_STEREO_STAGES];
+
+		for (int s = 0; s < p_stages; s++) {
+			const Processor &l = p_left[s];
+			const Processor &r = p_right[s];
+			b0[s] = audio_vec4_set(l.coeffs.b0, r.coeffs.b0, 0, 0);
+			b1[s] = audio_vec4_set(l.coeffs.b1, r.coeffs.b1, 0, 0);
+			b2[s] = audio_vec4_set(l.coeffs.b2, r.coeffs.b2, 0, 0);
+			a1[s] = audio_vec4_set(l.coeffs.a1, r.coeffs.a1, 0, 0);
+			a2[s] = audio_vec4_set(l.coeffs.a2, r.coeffs.a2, 0, 0);
+			ha1[s] = audio_vec4_set(l.ha1, r.ha1, 0, 0);
+			ha2[s] = audio_vec4_set(l.ha2, r.ha2, 0, 0);
+			hb1[s] = audio_vec4_set(l.hb1, r.hb1, 0, 0);
+			hb2[s] = audio_vec4_set(l.hb2, r.hb2, 0, 0);
+		}
+
+		for (int i = 0; i < p_frames; i++) {
+			AudioVec4 x = audio_vec4_load2(&p_src[i].l);
+			for (int s = 0; s < p_stages; s++) {
+				AudioVec4 y = audio_vec4_mul(x, b0[s]);
+				y = audio_vec4_add(y, audio_vec4_mul(hb1[s], b1[s]));
+				y = audio_vec4_add(y, audio_vec4_mul(hb2[s], b2[s]));
+				y = audio_vec4_add(y, audio_vec4_mul(ha1[s], a1[s]));
+				y = audio_vec4_add(y, audio_vec4_mul(ha2[s], a2[s]));
+				ha2[s] = ha1[s];
+				hb2[s] = hb1[s];
+				hb1[s] = x;
+				ha1[s] = y;
+				x = y;
+			}
+			audio_vec4_store2(&p_dst[i].l, x);
+		}
+
+		for (int s = 0; s < p_stages; s++) {
+			float h[4][4];
+			audio_vec4_store(h[0], ha1[s]);
+			audio_vec4_store(h[1], ha2[s]);
+			audio_vec4_store(h[2], hb1[s]);
+			audio_vec4_store(h[3], hb2[s]);
+			p_left[s].ha1 = h[0][0];
+			p_left[s].ha2 = h[1][0];
+			p_left[s].hb1 = h[2][0];
+			p_left[s].hb2 = h[3][0];
+			p_right[s].ha1 = h[0][1];
+			p_right[s].ha2 = h[1][1];
+			p_right[s].hb1 = h[2][1];
+			p_right[s].hb2 = h[3][1];
+		}
+		return;
+	}
+#endif
+
+	for (int i = 0; i < p_frames; i++) {
+		float l = p_src[i].l;
+		float r = p_src[i].r;
+		for (int s = 0; s < p_stages; s++) {
+			p_left[s].process_one(l);
+			p_right[s].process_one(r);
+		}
+		p_dst[i] = AudioFrame(l, r);
+	}
+}
@@ -31,6 +31,7 @@
 #ifndef AUDIO_FILTER_SW_H
 #define AUDIO_FILTER_SW_H
 
+#include "core/math/audio_frame.h"
 #include "core/math/math_funcs.h"
 
 class AudioFilterSW {
@@ -63,12 +64,20 @@ public:
 		Coeffs incr_coeffs;
 
 	public:
+		enum {
+			MAX_STEREO_STAGES = 4
+		};
+
 		void set_filter(AudioFilterSW *p_filter, bool p_clear_history = true);
 		void process(float *p_samples, int p_amount, int p_stride = 1, bool p_interpolate = false);
 		void update_coeffs(int p_interp_buffer_len = 0);
 		_ALWAYS_INLINE_ void process_one(float &p_sample);
 		_ALWAYS_INLINE_ void process_one_interp(float &p_sample);
 
+		// Runs a stereo buffer through p_stages chained processors per channel,
+		// both channels at once when SIMD is available.
+		static void process_stereo(Processor *p_left, Processor *p_right, int p_stages, const AudioFrame *p_src, AudioFrame *p_dst, int p_frames);
+
 		Processor();
 	};
 
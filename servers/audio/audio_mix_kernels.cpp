@@ -0,0 +1,199 @@
+/*************************************************************************/
+/*  audio_mix_kernels.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "audio_mix_kernels.h"
+
+#ifdef SIMD_ENABLED
+bool AudioMixKernels::simd_enabled = true;
+#else
+bool AudioMixKernels::simd_enabled = false;
+#endif
+
+void AudioMixKernels::set_simd_enabled(bool p_enabled) {
+#ifdef SIMD_ENABLED
+	simd_enabled = p_enabled;
+#endif
+}
+
+bool AudioMixKernels::is_simd_enabled() {
+	return simd_enabled;
+}
+
+void AudioMixKernels::clear(AudioFrame *p_dst, int p_frames) {
+	int i = 0;
+#ifdef SIMD_ENABLED
+	if (simd_enabled) {
+		AudioVec4 zero = audio_vec4_zero();
+		float *dst = (float *)p_dst;
+		for (; i + 1 < p_frames; i += 2) {
+			audio_vec4_store(dst + i * 2, zero);
+		}
+	}
+#endif
+	for (; i < p_frames; i++) {
+		p_dst[i] = AudioFrame(0, 0);
+	}
+}
+
+void AudioMixKernels::add(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames) {
+	int i = 0;
+#ifdef SIMD_ENABLED
+	if (simd_enabled) {
+		float *dst = (float *)p_dst;
+		const float *src = (const float *)p_src;
+		for (; i + 1 < p_frames; i += 2) {
+			audio_vec4_store(dst + i * 2, audio_vec4_add(audio_vec4_load(dst + i * 2), audio_vec4_load(src + i * 2)));
+		}
+	}
+#endif
+	for (; i < p_frames; i++) {
+		p_dst[i] += p_src[i];
+	}
+}
+
+void AudioMixKernels::add_ramp(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, const AudioFrame &p_volume, const AudioFrame &p_volume_inc) {
+	int i = 0;
+	AudioFrame vol = p_volume;
+#ifdef SIMD_ENABLED
+	if (simd_enabled) {
+		float *dst = (float *)p_dst;
+		const float *src = (const float *)p_src;
+		// Two frames per vector, so the volume advances two steps per iteration.
+		AudioVec4 v = audio_vec4_set(vol.l, vol.r, vol.l + p_volume_inc.l, vol.r + p_volume_inc.r);
+		AudioVec4 v_inc = audio_vec4_set(p_volume_inc.l * 2, p_volume_inc.r * 2, p_volume_inc.l * 2, p_volume_inc.r * 2);
+		for (; i + 1 < p_frames; i += 2) {
+			AudioVec4 mixed = audio_vec4_mul(audio_vec4_load(src + i * 2), v);
+			audio_vec4_store(dst + i * 2, audio_vec4_add(audio_vec4_load(dst + i * 2), mixed));
+			v = audio_vec4_add(v, v_inc);
+		}
+		if (i < p_frames) {
+			float lanes[4];
+			audio_vec4_store(lanes, v);
+			vol = AudioFrame(lanes[0], lanes[1]);
+		}
+	}
+#endif
+	for (; i < p_frames; i++) {
+		p_dst[i] += p_src[i] * vol;
+		vol += p_volume_inc;
+	}
+}
+
+AudioFrame AudioMixKernels::scale_and_peak(AudioFrame *p_buffer, int p_frames, float p_volume) {
+	int i = 0;
+	AudioFrame peak = AudioFrame(0, 0);
+#ifdef SIMD_ENABLED
+	if (simd_enabled) {
+		float *buf = (float *)p_buffer;
+		AudioVec4 v = audio_vec4_splat(p_volume);
+		AudioVec4 vpeak = audio_vec4_zero();
+		for (; i + 1 < p_frames; i += 2) {
+			AudioVec4 scaled = audio_vec4_mul(audio_vec4_load(buf + i * 2), v);
+			audio_vec4_store(buf + i * 2, scaled);
+			vpeak = audio_vec4_max(vpeak, audio_vec4_abs(scaled));
+		}
+		float lanes[4];
+		audio_vec4_store(lanes, vpeak);
+		peak = AudioFrame(MAX(lanes[0], lanes[2]), MAX(lanes[1], lanes[3]));
+	}
+#endif
+	for (; i < p_frames; i++) {
+		p_buffer[i] *= p_volume;
+
+		float l = ABS(p_buffer[i].l);
+		if (l > peak.l) {
+			peak.l = l;
+		}
+		float r = ABS(p_buffer[i].r);
+		if (r > peak.r) {
+			peak.r = r;
+		}
+	}
+	return peak;
+}
+
+void AudioMixKernels::scale_add(float *p_dst, const float *p_src, int p_count, float p_dst_scale, float p_src_scale) {
+	int i = 0;
+#ifdef SIMD_ENABLED
+	if (simd_enabled) {
+		AudioVec4 dst_scale = audio_vec4_splat(p_dst_scale);
+		AudioVec4 src_scale = audio_vec4_splat(p_src_scale);
+		for (; i + 3 < p_count; i += 4) {
+			AudioVec4 d = audio_vec4_mul(audio_vec4_load(p_dst + i), dst_scale);
+			AudioVec4 s = audio_vec4_mul(audio_vec4_load(p_src + i), src_scale);
+			audio_vec4_store(p_dst + i, audio_vec4_add(d, s));
+		}
+	}
+#endif
+	for (; i < p_count; i++) {
+		p_dst[i] = p_dst[i] * p_dst_scale + p_src[i] * p_src_scale;
+	}
+}
+
+void AudioMixKernels::to_int32(const AudioFrame *p_src, int32_t *p_dst, int p_frames, int p_dst_stride) {
+	int i = 0;
+#ifdef SIMD_ENABLED
+	if (simd_enabled) {
+		// Truncates towards zero and shifts, exactly like the scalar path below.
+		const float *src = (const float *)p_src;
+		AudioVec4 lo = audio_vec4_splat(-1.0);
+		AudioVec4 hi = audio_vec4_splat(1.0);
+		AudioVec4 scale = audio_vec4_splat((1 << 20) - 1);
+		for (; i + 1 < p_frames; i += 2) {
+			AudioVec4 f = audio_vec4_mul(audio_vec4_min(audio_vec4_max(audio_vec4_load(src + i * 2), lo), hi), scale);
+			int32_t *dst = p_dst + i * p_dst_stride;
+#ifdef SIMD_SSE2
+			__m128i v = _mm_slli_epi32(_mm_cvttps_epi32(f), 11);
+			if (p_dst_stride == 2) {
+				_mm_storeu_si128((__m128i *)dst, v);
+			} else {
+				_mm_storel_epi64((__m128i *)dst, v);
+				_mm_storel_epi64((__m128i *)(dst + p_dst_stride), _mm_unpackhi_epi64(v, v));
+			}
+#else
+			int32x4_t v = vshlq_n_s32(vcvtq_s32_f32(f), 11);
+			vst1_s32(dst, vget_low_s32(v));
+			vst1_s32(dst + p_dst_stride, vget_high_s32(v));
+#endif
+		}
+	}
+#endif
+	for (; i < p_frames; i++) {
+		int32_t *dst = p_dst + i * p_dst_stride;
+
+		float l = CLAMP(p_src[i].l, -1.0, 1.0);
+		int32_t vl = l * ((1 << 20) - 1);
+		dst[0] = (vl < 0 ? -1 : 1) * (ABS(vl) << 11);
+
+		float r = CLAMP(p_src[i].r, -1.0, 1.0);
+		int32_t vr = r * ((1 << 20) - 1);
+		dst[1] = (vr < 0 ? -1 : 1) * (ABS(vr) << 11);
+	}
+}
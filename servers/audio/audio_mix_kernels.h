@@ -0,0 +1,138 @@
+/*************************************************************************/
+/*  audio_mix_kernels.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AUDIO_MIX_KERNELS_H
+#define AUDIO_MIX_KERNELS_H
+
+#include "core/math/audio_frame.h"
+#include "core/simd.h"
+#include "core/typedefs.h"
+
+// Inner loops shared by the audio server and the built-in effects.
+// Every kernel has a scalar fallback, used when the target has no SSE2 or NEON
+// or when SIMD was disabled at runtime (to compare results or timings).
+class AudioMixKernels {
+	static bool simd_enabled;
+
+public:
+	static void set_simd_enabled(bool p_enabled);
+	static bool is_simd_enabled();
+
+	// p_dst[i] = 0
+	static void clear(AudioFrame *p_dst, int p_frames);
+	// p_dst[i] += p_src[i]
+	static void add(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames);
+	// p_dst[i] += p_src[i] * (p_volume + p_volume_inc * i)
+	static void add_ramp(AudioFrame *p_dst, const AudioFrame *p_src, int p_frames, const AudioFrame &p_volume, const AudioFrame &p_volume_inc);
+	// p_buffer[i] *= p_volume, returns the absolute peak of the result.
+	static AudioFrame scale_and_peak(AudioFrame *p_buffer, int p_frames, float p_volume);
+	// p_dst[i] = p_dst[i] * p_dst_scale + p_src[i] * p_src_scale
+	static void scale_add(float *p_dst, const float *p_src, int p_count, float p_dst_scale, float p_src_scale);
+	// Clamps to [-1, 1] and converts to the 32 bits format expected by the drivers.
+	// A frame takes two samples and frames are written p_dst_stride samples apart.
+	static void to_int32(const AudioFrame *p_src, int32_t *p_dst, int p_frames, int p_dst_stride);
+};
+
+#ifdef SIMD_ENABLED
+
+// Minimal four wide float vector used by the kernels above and by the effects.
+// Only operations that round exactly like their scalar counterparts are exposed,
+// so a kernel doing the same operations in the same order gives the same result.
+
+#ifdef SIMD_SSE2
+
+typedef __m128 AudioVec4;
+
+_FORCE_INLINE_ AudioVec4 audio_vec4_load(const float *p_src) { return _mm_loadu_ps(p_src); }
+_FORCE_INLINE_ void audio_vec4_store(float *p_dst, AudioVec4 p_v) { _mm_storeu_ps(p_dst, p_v); }
+// Loads two floats in the low lanes, the high lanes are zeroed.
+_FORCE_INLINE_ AudioVec4 audio_vec4_load2(const float *p_src) { return _mm_castpd_ps(_mm_load_sd((const double *)p_src)); }
+_FORCE_INLINE_ void audio_vec4_store2(float *p_dst, AudioVec4 p_v) { _mm_store_sd((double *)p_dst, _mm_castps_pd(p_v)); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_splat(float p_v) { return _mm_set1_ps(p_v); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_set(float p_a, float p_b, float p_c, float p_d) { return _mm_setr_ps(p_a, p_b, p_c, p_d); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_zero() { return _mm_setzero_ps(); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_add(AudioVec4 p_a, AudioVec4 p_b) { return _mm_add_ps(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_sub(AudioVec4 p_a, AudioVec4 p_b) { return _mm_sub_ps(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_mul(AudioVec4 p_a, AudioVec4 p_b) { return _mm_mul_ps(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_min(AudioVec4 p_a, AudioVec4 p_b) { return _mm_min_ps(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_max(AudioVec4 p_a, AudioVec4 p_b) { return _mm_max_ps(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_abs(AudioVec4 p_v) { return _mm_and_ps(p_v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+// { a0, b0, a1, b1 } and { a2, b2, a3, b3 }.
+_FORCE_INLINE_ AudioVec4 audio_vec4_interleave_lo(AudioVec4 p_a, AudioVec4 p_b) { return _mm_unpacklo_ps(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_interleave_hi(AudioVec4 p_a, AudioVec4 p_b) { return _mm_unpackhi_ps(p_a, p_b); }
+// Same test as ::undenormalise(), per lane.
+_FORCE_INLINE_ AudioVec4 audio_vec4_undenormalise(AudioVec4 p_v) {
+	__m128i exponent = _mm_and_si128(_mm_castps_si128(p_v), _mm_set1_epi32(0x7f800000));
+	__m128i tiny = _mm_cmplt_epi32(exponent, _mm_set1_epi32(0x08000000));
+	return _mm_andnot_ps(_mm_castsi128_ps(tiny), p_v);
+}
+_FORCE_INLINE_ float audio_vec4_sum(AudioVec4 p_v) {
+	__m128 pairs = _mm_add_ps(p_v, _mm_movehl_ps(p_v, p_v));
+	return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+#else // SIMD_NEON
+
+typedef float32x4_t AudioVec4;
+
+_FORCE_INLINE_ AudioVec4 audio_vec4_load(const float *p_src) { return vld1q_f32(p_src); }
+_FORCE_INLINE_ void audio_vec4_store(float *p_dst, AudioVec4 p_v) { vst1q_f32(p_dst, p_v); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_load2(const float *p_src) { return vcombine_f32(vld1_f32(p_src), vdup_n_f32(0)); }
+_FORCE_INLINE_ void audio_vec4_store2(float *p_dst, AudioVec4 p_v) { vst1_f32(p_dst, vget_low_f32(p_v)); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_splat(float p_v) { return vdupq_n_f32(p_v); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_set(float p_a, float p_b, float p_c, float p_d) {
+	const float v[4] = { p_a, p_b, p_c, p_d };
+	return vld1q_f32(v);
+}
+_FORCE_INLINE_ AudioVec4 audio_vec4_zero() { return vdupq_n_f32(0); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_add(AudioVec4 p_a, AudioVec4 p_b) { return vaddq_f32(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_sub(AudioVec4 p_a, AudioVec4 p_b) { return vsubq_f32(p_a, p_b); }
+// Not vmlaq_f32, which may fuse and round differently than the scalar code.
+_FORCE_INLINE_ AudioVec4 audio_vec4_mul(AudioVec4 p_a, AudioVec4 p_b) { return vmulq_f32(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_min(AudioVec4 p_a, AudioVec4 p_b) { return vminq_f32(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_max(AudioVec4 p_a, AudioVec4 p_b) { return vmaxq_f32(p_a, p_b); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_abs(AudioVec4 p_v) { return vabsq_f32(p_v); }
+_FORCE_INLINE_ AudioVec4 audio_vec4_interleave_lo(AudioVec4 p_a, AudioVec4 p_b) { return vzipq_f32(p_a, p_b).val[0]; }
+_FORCE_INLINE_ AudioVec4 audio_vec4_interleave_hi(AudioVec4 p_a, AudioVec4 p_b) { return vzipq_f32(p_a, p_b).val[1]; }
+_FORCE_INLINE_ AudioVec4 audio_vec4_undenormalise(AudioVec4 p_v) {
+	uint32x4_t exponent = vandq_u32(vreinterpretq_u32_f32(p_v), vdupq_n_u32(0x7f800000));
+	uint32x4_t tiny = vcltq_u32(exponent, vdupq_n_u32(0x08000000));
+	return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(p_v), tiny));
+}
+_FORCE_INLINE_ float audio_vec4_sum(AudioVec4 p_v) {
+	float32x2_t pairs = vadd_f32(vget_low_f32(p_v), vget_high_f32(p_v));
+	return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+}
+
+#endif
+
+#endif // SIMD_ENABLED
+
+#endif // AUDIO_MIX_KERNELS_H
@@ -31,6 +31,7 @@
 #include "audio_rb_resampler.h"
 #include "core/math/math_funcs.h"
 #include "core/os/os.h"
+#include "servers/audio/audio_resampler.h"
 #include "servers/audio_server.h"
 
 int AudioRBResampler::get_channel_count() const {
@@ -41,13 +42,16 @@ int AudioRBResampler::get_channel_count() const {
 	return channels;
 }
 
-// Linear interpolation based sample rate conversion (low quality)
-// Note that AudioStreamPlaybackResampled::mix has better algorithm,
-// but it wasn't obvious to integrate that with VideoPlayer
+// Linear interpolation based sample rate conversion (low quality),
+// unless a sinc quality is selected in AudioResampler.
 template <int C>
 uint32_t AudioRBResampler::_resample(AudioFrame *p_dest, int p_todo, int32_t p_increment) {
 	uint32_t read = offset & MIX_FRAC_MASK;
 
+	const float *filter = AudioResampler::get_quality() == AudioResampler::QUALITY_CUBIC ? nullptr : AudioResampler::get_filter(double(src_mix_rate) / target_mix_rate);
+	uint32_t taps = AudioResampler::get_taps();
+	AudioFrame window[AudioResampler::MAX_TAPS];
+
 	for (int i = 0; i < p_todo; i++) {
 		offset = (offset + p_increment) & (((1 << (rb_bits + MIX_FRAC_BITS)) - 1));
 		read += p_increment;
@@ -56,6 +60,21 @@ uint32_t AudioRBResampler::_resample(AudioFrame *p_dest, int p_todo, int32_t p_i
 		ERR_FAIL_COND_V(pos >= rb_len, 0);
 		uint32_t pos_next = (pos + 1) & rb_mask;
 
+		if (filter) {
+			// The window is centered between pos and pos_next, like the linear interpolation.
+			uint32_t start = (pos + rb_len - taps / 2 + 1) & rb_mask;
+			if (C == 2 && start + taps <= rb_len) {
+				p_dest[i] = AudioResampler::interpolate(filter, (const AudioFrame *)&rb[start << 1], frac);
+				continue;
+			}
+			for (uint32_t k = 0; k < taps; k++) {
+				uint32_t idx = (start + k) & rb_mask;
+				window[k] = C == 1 ? AudioFrame(rb[idx], rb[idx]) : AudioFrame(rb[idx * C + 0], rb[idx * C + 1]);
+			}
+			p_dest[i] = AudioResampler::interpolate(filter, window, frac);
+			continue;
+		}
+
 		// since this is a template with a known compile time value (C), conditionals go away when compiling.
 		if (C == 1) {
 			float v0 = rb[pos];
@@ -154,7 +173,8 @@ int AudioRBResampler::get_num_of_ready_frames() {
 		return 0;
 	}
 	int32_t increment = (src_mix_rate * MIX_FRAC_LEN) / target_mix_rate;
-	int read_space = get_reader_space();
+	// The sinc filters read ahead of the position.
+	int read_space = MAX(get_reader_space() - AudioResampler::get_taps() / 2, 0);
 	return (int64_t(read_space) << MIX_FRAC_BITS) / increment;
 }
 
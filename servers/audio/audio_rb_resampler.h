@@ -33,6 +33,7 @@
 
 #include "core/os/memory.h"
 #include "core/typedefs.h"
+#include "servers/audio/audio_resampler.h"
 #include "servers/audio_server.h"
 
 struct AudioRBResampler {
@@ -89,7 +90,8 @@ public:
 			space = (rb_len - r) + w - 1;
 		}
 
-		return space;
+		// Keep the frames right behind the read position, the sinc filters still need them.
+		return MAX(space - AudioResampler::MAX_TAPS, 0);
 	}
 
 	_FORCE_INLINE_ int get_reader_space() const {
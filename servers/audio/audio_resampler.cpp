@@ -0,0 +1,170 @@
+/*************************************************************************/
+/*  audio_resampler.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "audio_resampler.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/memory.h"
+#include "servers/audio/audio_mix_kernels.h"
+
+AudioResampler::Quality AudioResampler::quality = AudioResampler::QUALITY_CUBIC;
+int AudioResampler::taps = 4;
+float *AudioResampler::filters[AudioResampler::CUTOFF_COUNT] = {};
+
+// Highest ratio of source to output frames each table is designed for.
+static const double cutoff_ratios[AudioResampler::CUTOFF_COUNT] = { 1.0, 1.25, 1.5, 2.0 };
+
+static const int quality_taps[AudioResampler::QUALITY_MAX] = { 4, 16, 32, 64 };
+// Kaiser window shape, higher values trade a wider transition band for a lower stopband.
+static const double quality_betas[AudioResampler::QUALITY_MAX] = { 0.0, 5.0, 7.0, 9.0 };
+
+static double _bessel_i0(double p_x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (p_x / (2.0 * k)) * (p_x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12) {
+			break;
+		}
+	}
+	return sum;
+}
+
+void AudioResampler::_free_filters() {
+	for (int i = 0; i < CUTOFF_COUNT; i++) {
+		if (filters[i]) {
+			memdelete_arr(filters[i]);
+			filters[i] = nullptr;
+		}
+	}
+}
+
+void AudioResampler::set_quality(Quality p_quality) {
+	ERR_FAIL_INDEX(p_quality, QUALITY_MAX);
+
+	_free_filters();
+	quality = p_quality;
+
+	taps = quality_taps[quality];
+	if (quality == QUALITY_CUBIC) {
+		return;
+	}
+
+	double beta = quality_betas[quality];
+
+	// Kaiser estimate of the transition width for this window, in cycles per sample.
+	// The stopband starts at the source Nyquist frequency.
+	double attenuation = beta / 0.1102 + 8.7;
+	double transition = (attenuation - 8.0) / (2.285 * Math_TAU * taps);
+	double i0_beta = _bessel_i0(beta);
+	int half = taps / 2;
+
+	for (int i = 0; i < CUTOFF_COUNT; i++) {
+		double cutoff = (0.5 - transition / 2.0) / cutoff_ratios[i];
+		filters[i] = memnew_arr(float, (PHASES + 1) * taps);
+
+		for (int p = 0; p <= PHASES; p++) {
+			float *row = &filters[i][p * taps];
+			double sum = 0;
+			for (int k = 0; k < taps; k++) {
+				double t = (k - (half - 1)) - double(p) / PHASES;
+				double x = t / half;
+				double window = ABS(x) < 1.0 ? _bessel_i0(beta * Math::sqrt(1.0 - x * x)) / i0_beta : 0.0;
+				double sinc = t == 0.0 ? 1.0 : Math::sin(Math_PI * 2.0 * cutoff * t) / (Math_PI * 2.0 * cutoff * t);
+				row[k] = sinc * window;
+				sum += row[k];
+			}
+			// Unity gain at DC on every phase.
+			for (int k = 0; k < taps; k++) {
+				row[k] /= sum;
+			}
+		}
+	}
+}
+
+AudioResampler::Quality AudioResampler::get_quality() {
+	return quality;
+}
+
+void AudioResampler::finish() {
+	_free_filters();
+	quality = QUALITY_CUBIC;
+	taps = quality_taps[QUALITY_CUBIC];
+}
+
+int AudioResampler::get_taps() {
+	return taps;
+}
+
+const float *AudioResampler::get_filter(double p_ratio) {
+	for (int i = 0; i < CUTOFF_COUNT - 1; i++) {
+		if (p_ratio <= cutoff_ratios[i]) {
+			return filters[i];
+		}
+	}
+	// Reading more than twice as fast still aliases, but it's rare enough not to need longer filters.
+	return filters[CUTOFF_COUNT - 1];
+}
+
+AudioFrame AudioResampler::interpolate(const float *p_filter, const AudioFrame *p_window, float p_frac) {
+	float phase = p_frac * PHASES;
+	int index = MIN(int(phase), PHASES - 1);
+	float mu = phase - index;
+	const float *c0 = &p_filter[index * taps];
+	const float *c1 = c0 + taps;
+
+#ifdef SIMD_ENABLED
+	if (AudioMixKernels::is_simd_enabled()) {
+		// Two frames per vector, so each coefficient is used for both channels.
+		const float *window = (const float *)p_window;
+		AudioVec4 vmu = audio_vec4_splat(mu);
+		AudioVec4 acc_a = audio_vec4_zero();
+		AudioVec4 acc_b = audio_vec4_zero();
+		for (int k = 0; k < taps; k += 4) {
+			AudioVec4 a = audio_vec4_load(c0 + k);
+			AudioVec4 c = audio_vec4_add(a, audio_vec4_mul(vmu, audio_vec4_sub(audio_vec4_load(c1 + k), a)));
+			acc_a = audio_vec4_add(acc_a, audio_vec4_mul(audio_vec4_load(window + k * 2), audio_vec4_interleave_lo(c, c)));
+			acc_b = audio_vec4_add(acc_b, audio_vec4_mul(audio_vec4_load(window + k * 2 + 4), audio_vec4_interleave_hi(c, c)));
+		}
+		float lanes[4];
+		audio_vec4_store(lanes, audio_vec4_add(acc_a, acc_b));
+		return AudioFrame(lanes[0] + lanes[2], lanes[1] + lanes[3]);
+	}
+#endif
+
+	AudioFrame out = AudioFrame(0, 0);
+	for (int k = 0; k < taps; k++) {
+		float c = c0[k] + mu * (c1[k] - c0[k]);
+		out.l += p_window[k].l * c;
+		out.r += p_window[k].r * c;
+	}
+	return out;
+}
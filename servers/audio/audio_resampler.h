@@ -0,0 +1,78 @@
+/*************************************************************************/
+/*  audio_resampler.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AUDIO_RESAMPLER_H
+#define AUDIO_RESAMPLER_H
+
+#include "core/math/audio_frame.h"
+#include "core/typedefs.h"
+
+// Windowed sinc interpolation for the resamplers, using polyphase filter tables
+// shared by all streams. The cubic quality has no tables, callers interpolate it
+// themselves with the four frames around the position.
+class AudioResampler {
+public:
+	enum Quality {
+		QUALITY_CUBIC,
+		QUALITY_SINC_LOW,
+		QUALITY_SINC_MEDIUM,
+		QUALITY_SINC_HIGH,
+		QUALITY_MAX
+	};
+
+	enum {
+		MAX_TAPS = 64,
+		PHASES = 256, // Phases in between are interpolated linearly.
+		CUTOFF_COUNT = 4, // Tables with a lower cutoff, to avoid aliasing when reading faster than the output rate.
+	};
+
+private:
+	static Quality quality;
+	static int taps;
+	static float *filters[CUTOFF_COUNT];
+
+	static void _free_filters();
+
+public:
+	// Builds the filter tables, must not be called while mixing.
+	static void set_quality(Quality p_quality);
+	static Quality get_quality();
+	static void finish();
+
+	// Number of frames read around each interpolated position: the position is
+	// between window[taps / 2 - 1] and window[taps / 2].
+	static int get_taps();
+
+	// p_ratio is the amount of source frames per output frame.
+	static const float *get_filter(double p_ratio);
+	static AudioFrame interpolate(const float *p_filter, const AudioFrame *p_window, float p_frac);
+};
+
+#endif // AUDIO_RESAMPLER_H
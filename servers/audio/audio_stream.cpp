@@ -32,17 +32,21 @@
 
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "servers/audio/audio_resampler.h"
+
+void AudioStreamPlayback::skip(float p_time) {
+	seek(get_playback_position() + p_time);
+}
 
 //////////////////////////////
 
 void AudioStreamPlaybackResampled::_begin_resample() {
-	//clear cubic interpolation history
-	internal_buffer[0] = AudioFrame(0.0, 0.0);
-	internal_buffer[1] = AudioFrame(0.0, 0.0);
-	internal_buffer[2] = AudioFrame(0.0, 0.0);
-	internal_buffer[3] = AudioFrame(0.0, 0.0);
+	//clear interpolation history
+	for (int i = 0; i < INTERP_HISTORY; i++) {
+		internal_buffer[i] = AudioFrame(0.0, 0.0);
+	}
 	//mix buffer
-	_mix_internal(internal_buffer + 4, INTERNAL_BUFFER_LEN);
+	_mix_internal(internal_buffer + INTERP_HISTORY, INTERNAL_BUFFER_LEN);
 	mix_offset = 0;
 }
 
@@ -50,39 +54,47 @@ void AudioStreamPlaybackResampled::mix(AudioFrame *p_buffer, float p_rate_scale,
 	float target_rate = AudioServer::get_singleton()->get_mix_rate();
 	float global_rate_scale = AudioServer::get_singleton()->get_global_rate_scale();
 
-	uint64_t mix_increment = uint64_t(((get_stream_sampling_rate() * p_rate_scale) / double(target_rate * global_rate_scale)) * double(FP_LEN));
+	double ratio = (get_stream_sampling_rate() * p_rate_scale) / double(target_rate * global_rate_scale);
+	uint64_t mix_increment = uint64_t(ratio * double(FP_LEN));
+
+	int taps = AudioResampler::get_taps();
+	const float *filter = AudioResampler::get_quality() == AudioResampler::QUALITY_CUBIC ? nullptr : AudioResampler::get_filter(ratio);
 
 	for (int i = 0; i < p_frames; i++) {
-		uint32_t idx = CUBIC_INTERP_HISTORY + uint32_t(mix_offset >> FP_BITS);
-		//standard cubic interpolation (great quality/performance ratio)
-		//this used to be moved to a LUT for greater performance, but nowadays CPU speed is generally faster than memory.
+		uint32_t idx = INTERP_HISTORY + uint32_t(mix_offset >> FP_BITS);
 		float mu = (mix_offset & FP_MASK) / float(FP_LEN);
-		AudioFrame y0 = internal_buffer[idx - 3];
-		AudioFrame y1 = internal_buffer[idx - 2];
-		AudioFrame y2 = internal_buffer[idx - 1];
-		AudioFrame y3 = internal_buffer[idx - 0];
-
-		float mu2 = mu * mu;
-		AudioFrame a0 = y3 - y2 - y0 + y1;
-		AudioFrame a1 = y0 - y1 - a0;
-		AudioFrame a2 = y2 - y0;
-		AudioFrame a3 = y1;
 
-		p_buffer[i] = (a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3);
+		if (filter) {
+			p_buffer[i] = AudioResampler::interpolate(filter, &internal_buffer[idx - taps + 1], mu);
+		} else {
+			//standard cubic interpolation (great quality/performance ratio)
+			//this used to be moved to a LUT for greater performance, but nowadays CPU speed is generally faster than memory.
+			AudioFrame y0 = internal_buffer[idx - 3];
+			AudioFrame y1 = internal_buffer[idx - 2];
+			AudioFrame y2 = internal_buffer[idx - 1];
+			AudioFrame y3 = internal_buffer[idx - 0];
+
+			float mu2 = mu * mu;
+			AudioFrame a0 = y3 - y2 - y0 + y1;
+			AudioFrame a1 = y0 - y1 - a0;
+			AudioFrame a2 = y2 - y0;
+			AudioFrame a3 = y1;
+
+			p_buffer[i] = (a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3);
+		}
 
 		mix_offset += mix_increment;
 
 		while ((mix_offset >> FP_BITS) >= INTERNAL_BUFFER_LEN) {
-			internal_buffer[0] = internal_buffer[INTERNAL_BUFFER_LEN + 0];
-			internal_buffer[1] = internal_buffer[INTERNAL_BUFFER_LEN + 1];
-			internal_buffer[2] = internal_buffer[INTERNAL_BUFFER_LEN + 2];
-			internal_buffer[3] = internal_buffer[INTERNAL_BUFFER_LEN + 3];
+			for (int j = 0; j < INTERP_HISTORY; j++) {
+				internal_buffer[j] = internal_buffer[INTERNAL_BUFFER_LEN + j];
+			}
 			if (is_playing()) {
-				_mix_internal(internal_buffer + 4, INTERNAL_BUFFER_LEN);
+				_mix_internal(internal_buffer + INTERP_HISTORY, INTERNAL_BUFFER_LEN);
 			} else {
 				//fill with silence, not playing
 				for (int j = 0; j < INTERNAL_BUFFER_LEN; ++j) {
-					internal_buffer[j + 4] = AudioFrame(0, 0);
+					internal_buffer[j + INTERP_HISTORY] = AudioFrame(0, 0);
 				}
 			}
 			mix_offset -= (INTERNAL_BUFFER_LEN << FP_BITS);
@@ -345,6 +357,12 @@ void AudioStreamPlaybackRandomPitch::seek(float p_time) {
 	}
 }
 
+void AudioStreamPlaybackRandomPitch::skip(float p_time) {
+	if (playing.is_valid()) {
+		playing->skip(p_time * pitch_scale);
+	}
+}
+
 void AudioStreamPlaybackRandomPitch::mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) {
 	if (playing.is_valid()) {
 		playing->mix(p_buffer, p_rate_scale * pitch_scale, p_frames);
@@ -48,6 +48,7 @@ public:
 
 	virtual float get_playback_position() const = 0;
 	virtual void seek(float p_time) = 0;
+	virtual void skip(float p_time); // Advance without mixing, wrapping around loops.
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) = 0;
 };
@@ -60,10 +61,10 @@ class AudioStreamPlaybackResampled : public AudioStreamPlayback {
 		FP_LEN = (1 << FP_BITS),
 		FP_MASK = FP_LEN - 1,
 		INTERNAL_BUFFER_LEN = 256,
-		CUBIC_INTERP_HISTORY = 4
+		INTERP_HISTORY = 64 // Enough for the longest AudioResampler filter.
 	};
 
-	AudioFrame internal_buffer[INTERNAL_BUFFER_LEN + CUBIC_INTERP_HISTORY];
+	AudioFrame internal_buffer[INTERNAL_BUFFER_LEN + INTERP_HISTORY];
 	uint64_t mix_offset;
 
 protected:
@@ -190,6 +191,7 @@ public:
 
 	virtual float get_playback_position() const override;
 	virtual void seek(float p_time) override;
+	virtual void skip(float p_time) override;
 
 	virtual void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) override;
 
@@ -40,23 +40,8 @@ void AudioEffectEQInstance::process(const AudioFrame *p_src_frames, AudioFrame *
 		bgain[i] = Math::db2linear(base->gain[i]);
 	}
 
-	for (int i = 0; i < p_frame_count; i++) {
-		AudioFrame src = p_src_frames[i];
-		AudioFrame dst = AudioFrame(0, 0);
-
-		for (int j = 0; j < band_count; j++) {
-			float l = src.l;
-			float r = src.r;
-
-			proc_l[j].process_one(l);
-			proc_r[j].process_one(r);
-
-			dst.l += l * bgain[j];
-			dst.r += r * bgain[j];
-		}
-
-		p_dst_frames[i] = dst;
-	}
+	EQ::process_bands(proc_l, bgain, band_count, &p_src_frames[0].l, &p_dst_frames[0].l, p_frame_count, 2);
+	EQ::process_bands(proc_r, bgain, band_count, &p_src_frames[0].r, &p_dst_frames[0].r, p_frame_count, 2);
 }
 
 Ref<AudioEffectInstance> AudioEffectEQ::instance() {
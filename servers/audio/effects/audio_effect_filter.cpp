@@ -31,41 +31,6 @@
 #include "audio_effect_filter.h"
 #include "servers/audio_server.h"
 
-template <int S>
-void AudioEffectFilterInstance::_process_filter(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) {
-	for (int i = 0; i < p_frame_count; i++) {
-		float f = p_src_frames[i].l;
-		filter_process[0][0].process_one(f);
-		if (S > 1) {
-			filter_process[0][1].process_one(f);
-		}
-		if (S > 2) {
-			filter_process[0][2].process_one(f);
-		}
-		if (S > 3) {
-			filter_process[0][3].process_one(f);
-		}
-
-		p_dst_frames[i].l = f;
-	}
-
-	for (int i = 0; i < p_frame_count; i++) {
-		float f = p_src_frames[i].r;
-		filter_process[1][0].process_one(f);
-		if (S > 1) {
-			filter_process[1][1].process_one(f);
-		}
-		if (S > 2) {
-			filter_process[1][2].process_one(f);
-		}
-		if (S > 3) {
-			filter_process[1][3].process_one(f);
-		}
-
-		p_dst_frames[i].r = f;
-	}
-}
-
 void AudioEffectFilterInstance::process(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) {
 	filter.set_cutoff(base->cutoff);
 	filter.set_gain(base->gain);
@@ -76,25 +41,17 @@ void AudioEffectFilterInstance::process(const AudioFrame *p_src_frames, AudioFra
 	filter.set_sampling_rate(AudioServer::get_singleton()->get_mix_rate());
 
 	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 4; j++) {
+		for (int j = 0; j < AudioFilterSW::Processor::MAX_STEREO_STAGES; j++) {
 			filter_process[i][j].update_coeffs();
 		}
 	}
 
-	if (stages == 1) {
-		_process_filter<1>(p_src_frames, p_dst_frames, p_frame_count);
-	} else if (stages == 2) {
-		_process_filter<2>(p_src_frames, p_dst_frames, p_frame_count);
-	} else if (stages == 3) {
-		_process_filter<3>(p_src_frames, p_dst_frames, p_frame_count);
-	} else if (stages == 4) {
-		_process_filter<4>(p_src_frames, p_dst_frames, p_frame_count);
-	}
+	AudioFilterSW::Processor::process_stereo(filter_process[0], filter_process[1], stages, p_src_frames, p_dst_frames, p_frame_count);
 }
 
 AudioEffectFilterInstance::AudioEffectFilterInstance() {
 	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < 4; j++) {
+		for (int j = 0; j < AudioFilterSW::Processor::MAX_STEREO_STAGES; j++) {
 			filter_process[i][j].set_filter(&filter);
 		}
 	}
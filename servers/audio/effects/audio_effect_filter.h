@@ -43,10 +43,7 @@ class AudioEffectFilterInstance : public AudioEffectInstance {
 	Ref<AudioEffectFilter> base;
 
 	AudioFilterSW filter;
-	AudioFilterSW::Processor filter_process[2][4];
-
-	template <int S>
-	void _process_filter(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count);
+	AudioFilterSW::Processor filter_process[2][AudioFilterSW::Processor::MAX_STEREO_STAGES];
 
 public:
 	virtual void process(const AudioFrame *p_src_frames, AudioFrame *p_dst_frames, int p_frame_count) override;
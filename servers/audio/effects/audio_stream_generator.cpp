@@ -191,6 +191,13 @@ void AudioStreamGeneratorPlayback::seek(float p_time) {
 	//no seek possible
 }
 
+void AudioStreamGeneratorPlayback::skip(float p_time) {
+	//drop what would have been played, so pushing does not stall while not mixed
+	int frames = MIN(int(p_time * generator->get_mix_rate()), buffer.data_left());
+	buffer.advance_read(frames);
+	mixed += p_time;
+}
+
 void AudioStreamGeneratorPlayback::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("push_frame", "frame"), &AudioStreamGeneratorPlayback::push_frame);
 	ClassDB::bind_method(D_METHOD("can_push_buffer", "amount"), &AudioStreamGeneratorPlayback::can_push_buffer);
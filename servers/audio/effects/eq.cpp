@@ -33,6 +33,7 @@
 #include "eq.h"
 #include "core/error_macros.h"
 #include "core/math/math_funcs.h"
+#include "servers/audio/audio_mix_kernels.h"
 #include <math.h>
 
 #define POW2(v) ((v) * (v))
@@ -195,6 +196,86 @@ EQ::BandProcess EQ::get_band_processor(int p_band) const {
 	return band_proc;
 }
 
+void EQ::process_bands(BandProcess *p_bands, const float *p_gains, int p_band_count, const float *p_src, float *p_dst, int p_frames, int p_stride) {
+#ifdef SIMD_ENABLED
+	if (AudioMixKernels::is_simd_enabled() && p_band_count > 0 && p_band_count <= MAX_SIMD_BANDS) {
+		// Structure of arrays, four bands per vector. Padding lanes have zero
+		// coefficients and gain, so they never contribute to the output.
+		float lanes[6][MAX_SIMD_BANDS];
+		int vec_count = (p_band_count + 3) / 4;
+
+		for (int i = 0; i < vec_count * 4; i++) {
+			bool used = i < p_band_count;
+			lanes[0][i] = used ? p_bands[i].c1 : 0;
+			lanes[1][i] = used ? p_bands[i].c2 : 0;
+			lanes[2][i] = used ? p_bands[i].c3 : 0;
+			lanes[3][i] = used ? p_bands[i].history.b2 : 0;
+			lanes[4][i] = used ? p_bands[i].history.b3 : 0;
+			lanes[5][i] = used ? p_gains[i] : 0;
+		}
+
+		AudioVec4 c1[MAX_SIMD_BANDS / 4], c2[MAX_SIMD_BANDS / 4], c3[MAX_SIMD_BANDS / 4];
+		AudioVec4 b2[MAX_SIMD_BANDS / 4], b3[MAX_SIMD_BANDS / 4], gain[MAX_SIMD_BANDS / 4];
+		for (int v = 0; v < vec_count; v++) {
+			c1[v] = audio_vec4_load(&lanes[0][v * 4]);
+			c2[v] = audio_vec4_load(&lanes[1][v * 4]);
+			c3[v] = audio_vec4_load(&lanes[2][v * 4]);
+			b2[v] = audio_vec4_load(&lanes[3][v * 4]);
+			b3[v] = audio_vec4_load(&lanes[4][v * 4]);
+			gain[v] = audio_vec4_load(&lanes[5][v * 4]);
+		}
+
+		float a1 = p_bands[0].history.a1;
+		float a2 = p_bands[0].history.a2;
+		float a3 = p_bands[0].history.a3;
+
+		for (int i = 0; i < p_frames; i++) {
+			a1 = p_src[i * p_stride];
+			// Same operation order as BandProcess::process_one().
+			AudioVec4 d = audio_vec4_splat(a1 - a3);
+			AudioVec4 out = audio_vec4_zero();
+			for (int v = 0; v < vec_count; v++) {
+				AudioVec4 b1 = audio_vec4_sub(audio_vec4_add(audio_vec4_mul(c1[v], d), audio_vec4_mul(c3[v], b2[v])), audio_vec4_mul(c2[v], b3[v]));
+				out = audio_vec4_add(out, audio_vec4_mul(b1, gain[v]));
+				b3[v] = b2[v];
+				b2[v] = b1;
+			}
+			p_dst[i * p_stride] = audio_vec4_sum(out);
+			a3 = a2;
+			a2 = a1;
+		}
+
+		for (int v = 0; v < vec_count; v++) {
+			audio_vec4_store(&lanes[3][v * 4], b2[v]);
+			audio_vec4_store(&lanes[4][v * 4], b3[v]);
+		}
+		for (int i = 0; i < p_band_count; i++) {
+			BandProcess::History &h = p_bands[i].history;
+			h.a1 = a1;
+			h.a2 = a2;
+			h.a3 = a3;
+			h.b1 = lanes[3][i];
+			h.b2 = lanes[3][i];
+			h.b3 = lanes[4][i];
+		}
+		return;
+	}
+#endif
+
+	for (int i = 0; i < p_frames; i++) {
+		float src = p_src[i * p_stride];
+		float dst = 0;
+
+		for (int j = 0; j < p_band_count; j++) {
+			float v = src;
+			p_bands[j].process_one(v);
+			dst += v * p_gains[j];
+		}
+
+		p_dst[i * p_stride] = dst;
+	}
+}
+
 EQ::EQ() {
 	mix_rate = 44100;
 }
@@ -67,6 +67,10 @@ public:
 	};
 
 private:
+	enum {
+		MAX_SIMD_BANDS = 32
+	};
+
 	struct Band {
 		float freq;
 		float c1, c2, c3;
@@ -87,6 +91,11 @@ public:
 	BandProcess get_band_processor(int p_band) const;
 	float get_band_frequency(int p_band);
 
+	// Runs p_frames samples, p_stride floats apart, through all the band processors
+	// and sums their outputs scaled by p_gains. The bands must always be fed the
+	// same input (so they share the input history), four of them at once with SIMD.
+	static void process_bands(BandProcess *p_bands, const float *p_gains, int p_band_count, const float *p_src, float *p_dst, int p_frames, int p_stride);
+
 	EQ();
 	~EQ();
 };
@@ -33,6 +33,7 @@
 #include "reverb.h"
 
 #include "core/math/math_funcs.h"
+#include "servers/audio/audio_mix_kernels.h"
 
 #include <math.h>
 
@@ -104,23 +105,7 @@ void Reverb::process(float *p_src, float *p_dst, int p_frames) {
 		}
 	}
 
-	for (int i = 0; i < MAX_COMBS; i++) {
-		Comb &c = comb[i];
-
-		int size_limit = c.size - lrintf((float)c.extra_spread_frames * (1.0 - params.extra_spread));
-		for (int j = 0; j < p_frames; j++) {
-			if (c.pos >= size_limit) { //reset this now just in case
-				c.pos = 0;
-			}
-
-			float out = undenormalise(c.buffer[c.pos] * c.feedback);
-			out = out * (1.0 - c.damp) + c.damp_h * c.damp; //lowpass
-			c.damp_h = out;
-			c.buffer[c.pos] = input_buffer[j] + out;
-			p_dst[j] += out;
-			c.pos++;
-		}
-	}
+	_process_combs(p_dst, p_frames);
 
 	static const float allpass_feedback = 0.7;
 	/* this one works, but the other version is just nicer....
@@ -175,8 +160,85 @@ void Reverb::process(float *p_src, float *p_dst, int p_frames) {
 
 	static const float wet_scale = 0.6;
 
-	for (int i = 0; i < p_frames; i++) {
-		p_dst[i] = p_dst[i] * params.wet * wet_scale + p_src[i] * params.dry;
+	AudioMixKernels::scale_add(p_dst, p_src, p_frames, params.wet * wet_scale, params.dry);
+}
+
+void Reverb::_process_combs(float *p_dst, int p_frames) {
+	int size_limit[MAX_COMBS];
+	for (int i = 0; i < MAX_COMBS; i++) {
+		size_limit[i] = comb[i].size - lrintf((float)comb[i].extra_spread_frames * (1.0 - params.extra_spread));
+	}
+
+#ifdef SIMD_ENABLED
+	if (AudioMixKernels::is_simd_enabled()) {
+		// Run all the combs side by side, four per vector. Each one still reads and
+		// writes its own delay line, so only the filtering itself is vectorized.
+		enum {
+			COMB_VECTORS = MAX_COMBS / 4
+		};
+
+		AudioVec4 feedback[COMB_VECTORS], damp[COMB_VECTORS], damp_inv[COMB_VECTORS], damp_h[COMB_VECTORS];
+		for (int v = 0; v < COMB_VECTORS; v++) {
+			const Comb *c = &comb[v * 4];
+			feedback[v] = audio_vec4_set(c[0].feedback, c[1].feedback, c[2].feedback, c[3].feedback);
+			damp[v] = audio_vec4_set(c[0].damp, c[1].damp, c[2].damp, c[3].damp);
+			damp_inv[v] = audio_vec4_set(1.0 - c[0].damp, 1.0 - c[1].damp, 1.0 - c[2].damp, 1.0 - c[3].damp);
+			damp_h[v] = audio_vec4_set(c[0].damp_h, c[1].damp_h, c[2].damp_h, c[3].damp_h);
+		}
+
+		for (int j = 0; j < p_frames; j++) {
+			float delayed[MAX_COMBS];
+			for (int i = 0; i < MAX_COMBS; i++) {
+				Comb &c = comb[i];
+				if (c.pos >= size_limit[i]) { //reset this now just in case
+					c.pos = 0;
+				}
+				delayed[i] = c.buffer[c.pos];
+			}
+
+			AudioVec4 sum = audio_vec4_zero();
+			for (int v = 0; v < COMB_VECTORS; v++) {
+				AudioVec4 out = audio_vec4_undenormalise(audio_vec4_mul(audio_vec4_load(&delayed[v * 4]), feedback[v]));
+				out = audio_vec4_add(audio_vec4_mul(out, damp_inv[v]), audio_vec4_mul(damp_h[v], damp[v])); //lowpass
+				damp_h[v] = out;
+				sum = audio_vec4_add(sum, out);
+				audio_vec4_store(&delayed[v * 4], out);
+			}
+
+			for (int i = 0; i < MAX_COMBS; i++) {
+				Comb &c = comb[i];
+				c.buffer[c.pos] = input_buffer[j] + delayed[i];
+				c.pos++;
+			}
+			p_dst[j] += audio_vec4_sum(sum);
+		}
+
+		for (int v = 0; v < COMB_VECTORS; v++) {
+			float h[4];
+			audio_vec4_store(h, damp_h[v]);
+			for (int i = 0; i < 4; i++) {
+				comb[v * 4 + i].damp_h = h[i];
+			}
+		}
+		return;
+	}
+#endif
+
+	for (int i = 0; i < MAX_COMBS; i++) {
+		Comb &c = comb[i];
+
+		for (int j = 0; j < p_frames; j++) {
+			if (c.pos >= size_limit[i]) { //reset this now just in case
+				c.pos = 0;
+			}
+
+			float out = undenormalise(c.buffer[c.pos] * c.feedback);
+			out = out * (1.0 - c.damp) + c.damp_h * c.damp; //lowpass
+			c.damp_h = out;
+			c.buffer[c.pos] = input_buffer[j] + out;
+			p_dst[j] += out;
+			c.pos++;
+		}
 	}
 }
 
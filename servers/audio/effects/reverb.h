@@ -98,6 +98,8 @@ private:
 		float hpf;
 	} params;
 
+	void _process_combs(float *p_dst, int p_frames);
+
 	void configure_buffers();
 	void update_parameters();
 	void clear_buffers();
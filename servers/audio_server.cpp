@@ -35,8 +35,13 @@
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "core/sort_array.h"
 #include "scene/resources/audio_stream_sample.h"
+#include "servers/audio/audio_decode_ahead.h"
 #include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio/audio_mix_kernels.h"
+#include "servers/audio/audio_resampler.h"
+#include "servers/audio/audio_stream.h"
 #include "servers/audio/effects/audio_effect_compressor.h"
 
 #ifdef TOOLS_ENABLED
@@ -256,19 +261,7 @@ void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 		for (int k = 0; k < cs; k++) {
 			if (master->channels[k].active) {
 				const AudioFrame *buf = master->channels[k].buffer.ptr();
-
-				for (int j = 0; j < to_copy; j++) {
-					float l = CLAMP(buf[from + j].l, -1.0, 1.0);
-					int32_t vl = l * ((1 << 20) - 1);
-					int32_t vl2 = (vl < 0 ? -1 : 1) * (ABS(vl) << 11);
-					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 0] = vl2;
-
-					float r = CLAMP(buf[from + j].r, -1.0, 1.0);
-					int32_t vr = r * ((1 << 20) - 1);
-					int32_t vr2 = (vr < 0 ? -1 : 1) * (ABS(vr) << 11);
-					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 1] = vr2;
-				}
-
+				AudioMixKernels::to_int32(&buf[from], &p_buffer[from_buf * (cs * 2) + k * 2], to_copy, cs * 2);
 			} else {
 				for (int j = 0; j < to_copy; j++) {
 					p_buffer[(from_buf + j) * (cs * 2) + k * 2 + 0] = 0;
@@ -329,130 +322,220 @@ void AudioServer::_mix_step() {
 		E->get().callback(E->get().userdata);
 	}
 
-	for (int i = buses.size() - 1; i >= 0; i--) {
-		//go bus by bus
-		Bus *bus = buses[i];
+	_mix_voices();
 
-		for (int k = 0; k < bus->channels.size(); k++) {
-			if (bus->channels[k].active && !bus->channels[k].used) {
-				//buffer was not used, but it's still active, so it must be cleaned
-				AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+	mix_solo_mode = solo_mode;
+	uint64_t mix_ticks = OS::get_singleton()->get_ticks_usec();
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					buf[j] = AudioFrame(0, 0);
-				}
-			}
+	if (_update_bus_graph()) {
+		for (uint32_t i = 0; i + 1 < bus_graph_waves.size(); i++) {
+			bus_thread_pool.do_work(bus_wave_work, bus_graph_waves[i + 1] - bus_graph_waves[i], bus_graph_waves[i]);
 		}
+	} else {
+		for (int i = buses.size() - 1; i >= 0; i--) {
+			//go bus by bus
+			uint64_t ticks = OS::get_singleton()->get_ticks_usec();
 
-		//process effects
-		if (!bus->bypass) {
-			for (int j = 0; j < bus->effects.size(); j++) {
-				if (!bus->effects[j].enabled) {
-					continue;
-				}
+			_mix_bus(i);
+			_mix_bus_send(i);
 
+			buses[i]->cpu_time = OS::get_singleton()->get_ticks_usec() - ticks;
 #ifdef DEBUG_ENABLED
-				uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+			buses[i]->prof_time += buses[i]->cpu_time;
 #endif
+		}
+	}
 
-				for (int k = 0; k < bus->channels.size(); k++) {
-					if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
-						continue;
-					}
-					bus->channels.write[k].effect_instances.write[j]->process(bus->channels[k].buffer.ptr(), temp_buffer.write[k].ptrw(), buffer_size);
-				}
+	mix_cpu_time = OS::get_singleton()->get_ticks_usec() - mix_ticks;
+	mix_frames += buffer_size;
+	to_mix = buffer_size;
+}
 
-				//swap buffers, so internal buffer always has the right data
-				for (int k = 0; k < bus->channels.size(); k++) {
-					if (!(buses[i]->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
-						continue;
-					}
-					SWAP(bus->channels.write[k].buffer, temp_buffer.write[k]);
-				}
+bool AudioServer::_update_bus_graph() {
+	bool sidechained = false;
 
-#ifdef DEBUG_ENABLED
-				bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - ticks;
-#endif
+	for (int i = 0; i < buses.size(); i++) {
+		Bus *bus = buses[i];
+		bus->graph_depth = 0;
+
+		//everything has a send save for master bus
+		if (i == 0) {
+			bus->send_index = -1;
+		} else if (!bus_map.has(bus->send)) {
+			bus->send_index = 0;
+		} else {
+			bus->send_index = bus_map[bus->send]->index_cache;
+			if (bus->send_index >= bus->index_cache) { //invalid, send to master
+				bus->send_index = 0;
 			}
 		}
 
-		//process send
-
-		Bus *send = nullptr;
-
-		if (i > 0) {
-			//everything has a send save for master bus
-			if (!bus_map.has(bus->send)) {
-				send = buses[0];
-			} else {
-				send = bus_map[bus->send];
-				if (send->index_cache >= bus->index_cache) { //invalid, send to master
-					send = buses[0];
+		if (!bus->bypass) {
+			for (int j = 0; j < bus->effects.size(); j++) {
+				const AudioEffectCompressor *compressor = Object::cast_to<AudioEffectCompressor>(*bus->effects[j].effect);
+				if (bus->effects[j].enabled && compressor && compressor->get_sidechain() != StringName()) {
+					sidechained = true;
 				}
 			}
 		}
+	}
 
-		for (int k = 0; k < bus->channels.size(); k++) {
-			if (!bus->channels[k].active) {
-				continue;
-			}
+	// A sidechain reads another bus in the middle of the mix, only the serial order gives the same result.
+	if (!bus_thread_pool.is_initialized() || buses.size() < 3 || sidechained) {
+		return false;
+	}
 
-			AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+	// Sends always go to a lower index, so walking down the buses visits all the sources of a bus before it.
+	// The source lists are filled in that same order, which is the order sends are added in the serial mix.
+	int depth_count = 1;
+	bus_graph_source_offsets.resize(buses.size() + 1);
+	for (int i = 0; i <= buses.size(); i++) {
+		bus_graph_source_offsets[i] = 0;
+	}
+	for (int i = buses.size() - 1; i > 0; i--) {
+		Bus *send = buses[buses[i]->send_index];
+		send->graph_depth = MAX(send->graph_depth, buses[i]->graph_depth + 1);
+		depth_count = MAX(depth_count, send->graph_depth + 1);
+		bus_graph_source_offsets[buses[i]->send_index + 1]++;
+	}
 
-			AudioFrame peak = AudioFrame(0, 0);
+	bus_graph_fill.resize(buses.size());
+	for (int i = 0; i < buses.size(); i++) {
+		bus_graph_source_offsets[i + 1] += bus_graph_source_offsets[i];
+		bus_graph_fill[i] = bus_graph_source_offsets[i];
+	}
+	bus_graph_sources.resize(buses.size() - 1);
+	for (int i = buses.size() - 1; i > 0; i--) {
+		bus_graph_sources[bus_graph_fill[buses[i]->send_index]++] = i;
+	}
 
-			float volume = Math::db2linear(bus->volume_db);
+	if (depth_count == buses.size()) {
+		return false; // A single chain, nothing can run at the same time.
+	}
 
-			if (solo_mode) {
-				if (!bus->soloed) {
-					volume = 0.0;
-				}
-			} else {
-				if (bus->mute) {
-					volume = 0.0;
-				}
+	bus_graph_waves.resize(depth_count + 1);
+	for (int i = 0; i <= depth_count; i++) {
+		bus_graph_waves[i] = 0;
+	}
+	for (int i = 0; i < buses.size(); i++) {
+		bus_graph_waves[buses[i]->graph_depth + 1]++;
+	}
+	for (int i = 0; i < depth_count; i++) {
+		bus_graph_waves[i + 1] += bus_graph_waves[i];
+		bus_graph_fill[i] = bus_graph_waves[i];
+	}
+	bus_graph_order.resize(buses.size());
+	for (int i = buses.size() - 1; i >= 0; i--) {
+		bus_graph_order[bus_graph_fill[buses[i]->graph_depth]++] = i;
+	}
+
+	return true;
+}
+
+void AudioServer::_mix_bus_wave(uint32_t p_index, uint32_t p_wave_start) {
+	int bus_index = bus_graph_order[p_wave_start + p_index];
+	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+
+	// Sends are added by the receiving bus, in the same order as the serial mix.
+	for (uint32_t i = bus_graph_source_offsets[bus_index]; i < bus_graph_source_offsets[bus_index + 1]; i++) {
+		_mix_bus_send(bus_graph_sources[i]);
+	}
+	_mix_bus(bus_index);
+
+	Bus *bus = buses[bus_index];
+	bus->cpu_time = OS::get_singleton()->get_ticks_usec() - ticks;
+#ifdef DEBUG_ENABLED
+	bus->prof_time += bus->cpu_time;
+#endif
+}
+
+void AudioServer::_mix_bus(int p_bus) {
+	Bus *bus = buses[p_bus];
+
+	for (int k = 0; k < bus->channels.size(); k++) {
+		if (bus->channels[k].active && !bus->channels[k].used) {
+			//buffer was not used, but it's still active, so it must be cleaned
+			AudioMixKernels::clear(bus->channels.write[k].buffer.ptrw(), buffer_size);
+		}
+	}
+
+	//process effects
+	if (!bus->bypass) {
+		for (int j = 0; j < bus->effects.size(); j++) {
+			if (!bus->effects[j].enabled) {
+				continue;
 			}
 
-			//apply volume and compute peak
-			for (uint32_t j = 0; j < buffer_size; j++) {
-				buf[j] *= volume;
+#ifdef DEBUG_ENABLED
+			uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+#endif
 
-				float l = ABS(buf[j].l);
-				if (l > peak.l) {
-					peak.l = l;
-				}
-				float r = ABS(buf[j].r);
-				if (r > peak.r) {
-					peak.r = r;
+			for (int k = 0; k < bus->channels.size(); k++) {
+				if (!(bus->channels[k].active || bus->channels[k].effect_instances[j]->process_silence())) {
+					continue;
 				}
+				Bus::Channel &channel = bus->channels.write[k];
+				channel.effect_instances.write[j]->process(channel.buffer.ptr(), channel.effect_buffer.ptrw(), buffer_size);
+				//swap buffers, so internal buffer always has the right data
+				SWAP(channel.buffer, channel.effect_buffer);
 			}
 
-			bus->channels.write[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+#ifdef DEBUG_ENABLED
+			bus->effects.write[j].prof_time += OS::get_singleton()->get_ticks_usec() - ticks;
+#endif
+		}
+	}
 
-			if (!bus->channels[k].used) {
-				//see if any audio is contained, because channel was not used
+	for (int k = 0; k < bus->channels.size(); k++) {
+		if (!bus->channels[k].active) {
+			continue;
+		}
 
-				if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
-					bus->channels.write[k].last_mix_with_audio = mix_frames;
-				} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
-					bus->channels.write[k].active = false;
-					continue; //went inactive, don't mix.
-				}
+		AudioFrame *buf = bus->channels.write[k].buffer.ptrw();
+
+		float volume = Math::db2linear(bus->volume_db);
+
+		if (mix_solo_mode) {
+			if (!bus->soloed) {
+				volume = 0.0;
 			}
+		} else {
+			if (bus->mute) {
+				volume = 0.0;
+			}
+		}
 
-			if (send) {
-				//if not master bus, send
-				AudioFrame *target_buf = thread_get_channel_mix_buffer(send->index_cache, k);
+		//apply volume and compute peak
+		AudioFrame peak = AudioMixKernels::scale_and_peak(buf, buffer_size, volume);
 
-				for (uint32_t j = 0; j < buffer_size; j++) {
-					target_buf[j] += buf[j];
-				}
+		bus->channels.write[k].peak_volume = AudioFrame(Math::linear2db(peak.l + 0.0000000001), Math::linear2db(peak.r + 0.0000000001));
+
+		if (!bus->channels[k].used) {
+			//see if any audio is contained, because channel was not used
+
+			if (MAX(peak.r, peak.l) > Math::db2linear(channel_disable_threshold_db)) {
+				bus->channels.write[k].last_mix_with_audio = mix_frames;
+			} else if (mix_frames - bus->channels[k].last_mix_with_audio > channel_disable_frames) {
+				bus->channels.write[k].active = false;
 			}
 		}
 	}
+}
 
-	mix_frames += buffer_size;
-	to_mix = buffer_size;
+void AudioServer::_mix_bus_send(int p_bus) {
+	Bus *bus = buses[p_bus];
+	if (bus->send_index < 0) {
+		return;
+	}
+
+	for (int k = 0; k < bus->channels.size(); k++) {
+		if (!bus->channels[k].active) {
+			continue; //inactive or went inactive, don't mix.
+		}
+
+		AudioFrame *target_buf = thread_get_channel_mix_buffer(bus->send_index, k);
+		AudioMixKernels::add(target_buf, bus->channels[k].buffer.ptr(), buffer_size);
+	}
 }
 
 bool AudioServer::thread_has_channel_mix_buffer(int p_bus, int p_buffer) const {
@@ -475,9 +558,7 @@ AudioFrame *AudioServer::thread_get_channel_mix_buffer(int p_bus, int p_buffer)
 		buses.write[p_bus]->channels.write[p_buffer].used = true;
 		buses.write[p_bus]->channels.write[p_buffer].active = true;
 		buses.write[p_bus]->channels.write[p_buffer].last_mix_with_audio = mix_frames;
-		for (uint32_t i = 0; i < buffer_size; i++) {
-			data[i] = AudioFrame(0, 0);
-		}
+		AudioMixKernels::clear(data, buffer_size);
 	}
 
 	return data;
@@ -537,6 +618,7 @@ void AudioServer::set_bus_count(int p_count) {
 		buses.write[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].effect_buffer.resize(buffer_size);
 		}
 		buses[i]->name = attempt;
 		buses[i]->solo = false;
@@ -606,6 +688,7 @@ void AudioServer::add_bus(int p_at_pos) {
 	bus->channels.resize(channel_count);
 	for (int j = 0; j < channel_count; j++) {
 		bus->channels.write[j].buffer.resize(buffer_size);
+		bus->channels.write[j].effect_buffer.resize(buffer_size);
 	}
 	bus->name = attempt;
 	bus->solo = false;
@@ -904,6 +987,27 @@ bool AudioServer::is_bus_channel_active(int p_bus, int p_channel) const {
 	return buses[p_bus]->channels[p_channel].active;
 }
 
+float AudioServer::get_bus_cpu_time(int p_bus) const {
+	ERR_FAIL_INDEX_V(p_bus, buses.size(), 0);
+	return USEC_TO_SEC(buses[p_bus]->cpu_time);
+}
+
+float AudioServer::get_mix_cpu_time() const {
+	return USEC_TO_SEC(mix_cpu_time);
+}
+
+float AudioServer::get_mix_time_budget() const {
+	return buffer_size / get_mix_rate();
+}
+
+int AudioServer::get_bus_thread_count() const {
+	return bus_thread_count;
+}
+
+uint64_t AudioServer::get_decode_underrun_count() const {
+	return decode_pool ? decode_pool->get_underrun_count() : 0;
+}
+
 void AudioServer::set_global_rate_scale(float p_scale) {
 	global_rate_scale = p_scale;
 }
@@ -914,16 +1018,12 @@ float AudioServer::get_global_rate_scale() const {
 
 void AudioServer::init_channels_and_buffers() {
 	channel_count = get_channel_count();
-	temp_buffer.resize(channel_count);
-
-	for (int i = 0; i < temp_buffer.size(); i++) {
-		temp_buffer.write[i].resize(buffer_size);
-	}
 
 	for (int i = 0; i < buses.size(); i++) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].effect_buffer.resize(buffer_size);
 		}
 	}
 }
@@ -934,6 +1034,35 @@ void AudioServer::init() {
 	ProjectSettings::get_singleton()->set_custom_property_info("audio/channel_disable_time", PropertyInfo(Variant::FLOAT, "audio/channel_disable_time", PROPERTY_HINT_RANGE, "0,5,0.01,or_greater"));
 	buffer_size = 1024; //hardcoded for now
 
+	max_voices = GLOBAL_DEF("audio/max_voices", 128);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/max_voices", PropertyInfo(Variant::INT, "audio/max_voices", PROPERTY_HINT_RANGE, "1,1024,1,or_greater"));
+	voice_virtualize_threshold = Math::db2linear(float(GLOBAL_DEF("audio/voice_virtualize_threshold_db", -60.0)));
+	voice_buffer.resize(buffer_size);
+
+	bus_thread_count = GLOBAL_DEF_RST("audio/bus_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/bus_threads", PropertyInfo(Variant::INT, "audio/bus_threads", PROPERTY_HINT_RANGE, "-1,16,1"));
+	if (bus_thread_count < 0) {
+		// Leave most cores to the game, and don't bother with a single extra thread.
+		bus_thread_count = MIN(OS::get_singleton()->get_processor_count() / 2, 4);
+		if (bus_thread_count < 2) {
+			bus_thread_count = 0;
+		}
+	}
+	if (bus_thread_count > 0) {
+		bus_thread_pool.init(bus_thread_count);
+	}
+
+	int resampler_quality = GLOBAL_DEF_RST("audio/resampler_quality", AudioResampler::QUALITY_SINC_MEDIUM);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/resampler_quality", PropertyInfo(Variant::INT, "audio/resampler_quality", PROPERTY_HINT_ENUM, "Cubic,Sinc Low,Sinc Medium,Sinc High"));
+	AudioResampler::set_quality(AudioResampler::Quality(CLAMP(resampler_quality, 0, AudioResampler::QUALITY_MAX - 1)));
+
+	int decode_threads = GLOBAL_DEF_RST("audio/decode_threads", 1);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/decode_threads", PropertyInfo(Variant::INT, "audio/decode_threads", PROPERTY_HINT_RANGE, "0,8,1"));
+	int decode_ahead_ms = GLOBAL_DEF_RST("audio/decode_ahead_ms", 250);
+	ProjectSettings::get_singleton()->set_custom_property_info("audio/decode_ahead_ms", PropertyInfo(Variant::INT, "audio/decode_ahead_ms", PROPERTY_HINT_RANGE, "20,2000,1"));
+	decode_pool = memnew(AudioDecodePool);
+	decode_pool->init(decode_threads, decode_ahead_ms);
+
 	init_channels_and_buffers();
 
 	mix_count = 0;
@@ -968,6 +1097,11 @@ void AudioServer::update() {
 
 		for (int i = buses.size() - 1; i >= 0; i--) {
 			Bus *bus = buses[i];
+
+			// Includes the effect times, which are also reported on their own below.
+			values.push_back(String(bus->name) + " (bus)");
+			values.push_back(USEC_TO_SEC(bus->prof_time));
+
 			if (bus->bypass) {
 				continue;
 			}
@@ -1002,6 +1136,7 @@ void AudioServer::update() {
 	// Reset profiling times
 	for (int i = buses.size() - 1; i >= 0; i--) {
 		Bus *bus = buses[i];
+		bus->prof_time = 0;
 		if (bus->bypass) {
 			continue;
 		}
@@ -1036,10 +1171,33 @@ void AudioServer::load_default_bus_layout() {
 }
 
 void AudioServer::finish() {
+	List<RID> owned_voices;
+	voice_owner.get_owned_list(&owned_voices);
+	if (owned_voices.size()) {
+		WARN_PRINT(itos(owned_voices.size()) + " audio voices were not freed.");
+		for (List<RID>::Element *E = owned_voices.front(); E; E = E->next()) {
+			voice_free(E->get());
+		}
+	}
+	for (uint32_t i = 0; i < voices.size(); i++) {
+		memdelete(voices[i]);
+	}
+	voices.clear();
+
 	for (int i = 0; i < AudioDriverManager::get_driver_count(); i++) {
 		AudioDriverManager::get_driver(i)->finish();
 	}
 
+	bus_thread_pool.finish();
+	bus_thread_count = 0;
+
+	AudioResampler::finish();
+
+	if (decode_pool) {
+		memdelete(decode_pool);
+		decode_pool = nullptr;
+	}
+
 	for (int i = 0; i < buses.size(); i++) {
 		memdelete(buses[i]);
 	}
@@ -1123,6 +1281,411 @@ void AudioServer::remove_update_callback(AudioCallback p_callback, void *p_userd
 	unlock();
 }
 
+/* VOICES */
+
+void AudioServer::_mix_voices() {
+	voices_playing.clear();
+
+	int fade_frames = MIN((int)VOICE_FADE_FRAMES, (int)buffer_size);
+
+	for (uint32_t i = 0; i < voices.size(); i++) {
+		Voice *voice = voices[i];
+
+		if (voice->freed) {
+			if (voice->mix_state == VOICE_MIX_PLAYING && !voice->mix_virtual) {
+				_mix_voice(voice, fade_frames, voice->mix_fade_in ? 0.0 : 1.0, 0.0);
+			}
+			voices[i] = voices[voices.size() - 1];
+			voices.resize(voices.size() - 1);
+			memdelete(voice);
+			i--;
+			continue;
+		}
+
+		voice->lock.lock();
+		if (voice->targets_changed) {
+			for (int j = 0; j < voice->target_count; j++) {
+				Voice::MixTarget &mt = voice->mix_targets[j];
+				if (j >= voice->mix_target_count || mt.target.bus != voice->targets[j].bus) {
+					// Moved to another bus, don't ramp from the volume it had in the previous one.
+					for (int k = 0; k < MAX_CHANNELS_PER_BUS; k++) {
+						mt.prev_volume[k] = voice->targets[j].volume[k];
+					}
+					mt.prev_highshelf_gain = 1.0;
+				}
+				mt.target = voice->targets[j];
+			}
+			voice->mix_target_count = voice->target_count;
+			voice->targets_changed = false;
+		}
+		voice->mix_pitch_scale = voice->pitch_scale;
+		voice->mix_priority = voice->priority;
+		voice->mix_highshelf_cutoff = voice->highshelf_cutoff;
+		float start_from = voice->start_from;
+		voice->start_from = -1;
+		bool stop = voice->stop_requested;
+		voice->stop_requested = false;
+		bool paused = voice->paused;
+		voice->lock.unlock();
+
+		// Whatever was heard in the previous mix is faded out before changing state, to avoid clicks.
+		bool audible = voice->mix_state == VOICE_MIX_PLAYING && !voice->mix_virtual;
+
+		if (stop) {
+			if (audible) {
+				_mix_voice(voice, fade_frames, voice->mix_fade_in ? 0.0 : 1.0, 0.0);
+				audible = false;
+			}
+			voice->playback->stop();
+			voice->mix_state = VOICE_MIX_STOPPED;
+			voice->virtual_time = 0;
+		}
+
+		if (start_from >= 0) {
+			if (audible) {
+				_mix_voice(voice, fade_frames, voice->mix_fade_in ? 0.0 : 1.0, 0.0);
+				audible = false;
+			}
+			voice->playback->start(start_from);
+			voice->mix_state = VOICE_MIX_PLAYING;
+			// Starts as virtual with no time to catch up, so it is either mixed from its start or not at all.
+			voice->mix_virtual = true;
+			voice->mix_fade_in = false;
+			voice->virtual_time = 0;
+			for (int j = 0; j < voice->mix_target_count; j++) {
+				Voice::MixTarget &mt = voice->mix_targets[j];
+				for (int k = 0; k < MAX_CHANNELS_PER_BUS; k++) {
+					mt.prev_volume[k] = mt.target.volume[k];
+				}
+			}
+		}
+
+		if (paused && voice->mix_state == VOICE_MIX_PLAYING) {
+			if (audible) {
+				_mix_voice(voice, fade_frames, voice->mix_fade_in ? 0.0 : 1.0, 0.0);
+				voice->mix_fade_in = true;
+			}
+			voice->mix_state = VOICE_MIX_PAUSED;
+		} else if (!paused && voice->mix_state == VOICE_MIX_PAUSED) {
+			voice->mix_state = VOICE_MIX_PLAYING;
+		}
+
+		if (voice->mix_state != VOICE_MIX_PLAYING) {
+			continue;
+		}
+
+		float loudest = 0;
+		for (int j = 0; j < voice->mix_target_count; j++) {
+			const VoiceTarget &target = voice->mix_targets[j].target;
+			for (int k = 0; k < MAX_CHANNELS_PER_BUS; k++) {
+				loudest = MAX(loudest, MAX(target.volume[k].l, target.volume[k].r));
+			}
+		}
+		voice->audibility = loudest * voice->mix_priority;
+		voices_playing.push_back(voice);
+	}
+
+	uint32_t mix_limit = voices_playing.size();
+	if (mix_limit > (uint32_t)max_voices) {
+		// Only the most audible voices are mixed, their order does not matter.
+		SortArray<Voice *, VoiceSort> sorter;
+		sorter.nth_element(0, voices_playing.size(), max_voices, voices_playing.ptr());
+		mix_limit = max_voices;
+	}
+
+	float mix_rate = get_mix_rate();
+	int mixed_count = 0;
+	int virtual_count = 0;
+
+	for (uint32_t i = 0; i < voices_playing.size(); i++) {
+		Voice *voice = voices_playing[i];
+
+		if (i < mix_limit && voice->audibility >= voice_virtualize_threshold) {
+			if (voice->mix_virtual) {
+				voice->mix_fade_in = voice->mix_fade_in || voice->virtual_time > 0;
+				_virtual_voice_skip(voice);
+				voice->mix_virtual = false;
+			}
+			if (voice->playback->is_playing()) {
+				_mix_voice(voice, buffer_size, voice->mix_fade_in ? 0.0 : 1.0, 1.0);
+				voice->mix_fade_in = false;
+				mixed_count++;
+			}
+		} else {
+			if (!voice->mix_virtual) {
+				_mix_voice(voice, fade_frames, voice->mix_fade_in ? 0.0 : 1.0, 0.0);
+				voice->mix_virtual = true;
+				voice->mix_fade_in = false;
+				voice->virtual_time = float(buffer_size - fade_frames) / mix_rate * voice->mix_pitch_scale;
+			} else {
+				voice->virtual_time += float(buffer_size) / mix_rate * voice->mix_pitch_scale;
+			}
+			if (voice->virtual_time * 1000.0 >= VOICE_VIRTUAL_SKIP_MSEC) {
+				_virtual_voice_skip(voice);
+			}
+			virtual_count++;
+		}
+
+		if (!voice->playback->is_playing()) {
+			_voice_finished(voice);
+		}
+	}
+
+	voices_mixed_count = mixed_count;
+	voices_virtual_count = virtual_count;
+}
+
+void AudioServer::_mix_voice(Voice *p_voice, int p_frames, float p_fade_from, float p_fade_to) {
+	AudioFrame *buffer = voice_buffer.ptrw();
+	p_voice->playback->mix(buffer, p_voice->mix_pitch_scale, p_frames);
+
+	int channel_count = MIN(get_channel_count(), (int)MAX_CHANNELS_PER_BUS);
+
+	for (int i = 0; i < p_voice->mix_target_count; i++) {
+		Voice::MixTarget &mt = p_voice->mix_targets[i];
+		int bus_index = thread_find_bus_index(mt.target.bus);
+
+		bool filtered = mt.target.highshelf_gain < 1.0 || mt.prev_highshelf_gain < 1.0;
+		// Coefficients can only be interpolated if the processors were running in the previous mix.
+		bool interpolate_filter = mt.prev_highshelf_gain < 1.0;
+		if (filtered) {
+			mt.filter.set_mode(AudioFilterSW::HIGHSHELF);
+			mt.filter.set_sampling_rate(get_mix_rate());
+			mt.filter.set_cutoff(p_voice->mix_highshelf_cutoff);
+			mt.filter.set_resonance(1);
+			mt.filter.set_stages(1);
+			mt.filter.set_gain(mt.target.highshelf_gain);
+		}
+
+		for (int k = 0; k < channel_count; k++) {
+			AudioFrame vol = mt.prev_volume[k] * p_fade_from;
+			AudioFrame vol_to = mt.target.volume[k] * p_fade_to;
+
+			if (vol.l == 0 && vol.r == 0 && vol_to.l == 0 && vol_to.r == 0) {
+				continue;
+			}
+
+			if (!thread_has_channel_mix_buffer(bus_index, k)) {
+				continue;
+			}
+
+			AudioFrame *target = thread_get_channel_mix_buffer(bus_index, k);
+			AudioFrame vol_inc = (vol_to - vol) / float(p_frames);
+
+			if (filtered) {
+				AudioFilterSW::Processor *processor_l = &mt.filter_process[k * 2 + 0];
+				AudioFilterSW::Processor *processor_r = &mt.filter_process[k * 2 + 1];
+
+				if (interpolate_filter) {
+					processor_l->set_filter(&mt.filter, false);
+					processor_r->set_filter(&mt.filter, false);
+					processor_l->update_coeffs(p_frames);
+					processor_r->update_coeffs(p_frames);
+
+					for (int j = 0; j < p_frames; j++) {
+						AudioFrame f = buffer[j] * vol;
+						processor_l->process_one_interp(f.l);
+						processor_r->process_one_interp(f.r);
+						target[j] += f;
+						vol += vol_inc;
+					}
+				} else {
+					processor_l->set_filter(&mt.filter);
+					processor_r->set_filter(&mt.filter);
+					processor_l->update_coeffs();
+					processor_r->update_coeffs();
+
+					for (int j = 0; j < p_frames; j++) {
+						AudioFrame f = buffer[j] * vol;
+						processor_l->process_one(f.l);
+						processor_r->process_one(f.r);
+						target[j] += f;
+						vol += vol_inc;
+					}
+				}
+			} else {
+				AudioMixKernels::add_ramp(target, buffer, p_frames, vol, vol_inc);
+			}
+		}
+
+		for (int k = 0; k < MAX_CHANNELS_PER_BUS; k++) {
+			mt.prev_volume[k] = mt.target.volume[k];
+		}
+		mt.prev_highshelf_gain = mt.target.highshelf_gain;
+	}
+}
+
+void AudioServer::_virtual_voice_skip(Voice *p_voice) {
+	if (p_voice->virtual_time > 0) {
+		p_voice->playback->skip(p_voice->virtual_time);
+		p_voice->virtual_time = 0;
+	}
+}
+
+void AudioServer::_voice_finished(Voice *p_voice) {
+	p_voice->mix_state = VOICE_MIX_STOPPED;
+	p_voice->mix_virtual = false;
+	p_voice->virtual_time = 0;
+
+	p_voice->lock.lock();
+	if (p_voice->start_from < 0) { // Otherwise it was played again while mixing.
+		p_voice->playing = false;
+	}
+	p_voice->lock.unlock();
+}
+
+RID AudioServer::voice_create(Ref<AudioStream> p_stream) {
+	ERR_FAIL_COND_V(p_stream.is_null(), RID());
+
+	Ref<AudioStreamPlayback> playback = p_stream->instance_playback();
+	if (playback.is_null()) {
+		return RID();
+	}
+
+	Voice *voice = memnew(Voice);
+	voice->playback = playback;
+
+	lock();
+	voices.push_back(voice);
+	unlock();
+
+	return voice_owner.make_rid(voice);
+}
+
+Ref<AudioStreamPlayback> AudioServer::voice_get_playback(RID p_voice) const {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND_V(!voice, Ref<AudioStreamPlayback>());
+	return voice->playback;
+}
+
+void AudioServer::voice_set_targets(RID p_voice, const VoiceTarget *p_targets, int p_count) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+	ERR_FAIL_COND(p_count < 0 || p_count > MAX_BUSES_PER_VOICE);
+
+	voice->lock.lock();
+	for (int i = 0; i < p_count; i++) {
+		voice->targets[i] = p_targets[i];
+	}
+	voice->target_count = p_count;
+	voice->targets_changed = true;
+	voice->lock.unlock();
+}
+
+void AudioServer::voice_set_pitch_scale(RID p_voice, float p_pitch_scale) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+	ERR_FAIL_COND(p_pitch_scale <= 0.0);
+
+	voice->lock.lock();
+	voice->pitch_scale = p_pitch_scale;
+	voice->lock.unlock();
+}
+
+void AudioServer::voice_set_priority(RID p_voice, float p_priority) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+	ERR_FAIL_COND(p_priority < 0.0);
+
+	voice->lock.lock();
+	voice->priority = p_priority;
+	voice->lock.unlock();
+}
+
+void AudioServer::voice_set_highshelf_cutoff(RID p_voice, float p_hz) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+
+	voice->lock.lock();
+	voice->highshelf_cutoff = p_hz;
+	voice->lock.unlock();
+}
+
+void AudioServer::voice_play(RID p_voice, float p_from_pos) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+
+	voice->lock.lock();
+	voice->start_from = MAX(p_from_pos, 0.0);
+	voice->stop_requested = false;
+	voice->playing = true;
+	voice->lock.unlock();
+}
+
+void AudioServer::voice_stop(RID p_voice) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+
+	voice->lock.lock();
+	voice->start_from = -1;
+	voice->stop_requested = true;
+	voice->playing = false;
+	voice->lock.unlock();
+}
+
+void AudioServer::voice_set_paused(RID p_voice, bool p_paused) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+
+	voice->lock.lock();
+	voice->paused = p_paused;
+	voice->lock.unlock();
+}
+
+bool AudioServer::voice_is_playing(RID p_voice) const {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND_V(!voice, false);
+
+	voice->lock.lock();
+	bool playing = voice->playing;
+	voice->lock.unlock();
+	return playing;
+}
+
+float AudioServer::voice_get_playback_position(RID p_voice) const {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND_V(!voice, 0);
+
+	// Virtual voices only catch up periodically, the time they were not mixed is added here.
+	return voice->playback->get_playback_position() + voice->virtual_time;
+}
+
+void AudioServer::voice_free(RID p_voice) {
+	Voice *voice = voice_owner.getornull(p_voice);
+	ERR_FAIL_COND(!voice);
+
+	voice_owner.free(p_voice);
+
+	lock();
+	if (voice->mix_state == VOICE_MIX_PLAYING && !voice->mix_virtual) {
+		// Still heard, fade it out in the next mix instead of cutting it.
+		voice->freed = true;
+	} else {
+		voices.erase(voice);
+		memdelete(voice);
+	}
+	unlock();
+}
+
+void AudioServer::set_max_voices(int p_count) {
+	ERR_FAIL_COND(p_count < 1);
+	lock();
+	max_voices = p_count;
+	unlock();
+}
+
+int AudioServer::get_max_voices() const {
+	return max_voices;
+}
+
+int AudioServer::get_mixed_voice_count() const {
+	return voices_mixed_count;
+}
+
+int AudioServer::get_virtual_voice_count() const {
+	return voices_virtual_count;
+}
+
 void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 	ERR_FAIL_COND(p_bus_layout.is_null() || p_bus_layout->buses.size() == 0);
 
@@ -1163,6 +1726,7 @@ void AudioServer::set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout) {
 		buses[i]->channels.resize(channel_count);
 		for (int j = 0; j < channel_count; j++) {
 			buses.write[i]->channels.write[j].buffer.resize(buffer_size);
+			buses.write[i]->channels.write[j].effect_buffer.resize(buffer_size);
 		}
 		_update_bus_effects(i);
 	}
@@ -1263,6 +1827,12 @@ void AudioServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_bus_peak_volume_left_db", "bus_idx", "channel"), &AudioServer::get_bus_peak_volume_left_db);
 	ClassDB::bind_method(D_METHOD("get_bus_peak_volume_right_db", "bus_idx", "channel"), &AudioServer::get_bus_peak_volume_right_db);
 
+	ClassDB::bind_method(D_METHOD("get_bus_cpu_time", "bus_idx"), &AudioServer::get_bus_cpu_time);
+	ClassDB::bind_method(D_METHOD("get_mix_cpu_time"), &AudioServer::get_mix_cpu_time);
+	ClassDB::bind_method(D_METHOD("get_mix_time_budget"), &AudioServer::get_mix_time_budget);
+	ClassDB::bind_method(D_METHOD("get_bus_thread_count"), &AudioServer::get_bus_thread_count);
+	ClassDB::bind_method(D_METHOD("get_decode_underrun_count"), &AudioServer::get_decode_underrun_count);
+
 	ClassDB::bind_method(D_METHOD("set_global_rate_scale", "scale"), &AudioServer::set_global_rate_scale);
 	ClassDB::bind_method(D_METHOD("get_global_rate_scale"), &AudioServer::get_global_rate_scale);
 
@@ -1286,9 +1856,15 @@ void AudioServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_bus_layout", "bus_layout"), &AudioServer::set_bus_layout);
 	ClassDB::bind_method(D_METHOD("generate_bus_layout"), &AudioServer::generate_bus_layout);
 
+	ClassDB::bind_method(D_METHOD("set_max_voices", "count"), &AudioServer::set_max_voices);
+	ClassDB::bind_method(D_METHOD("get_max_voices"), &AudioServer::get_max_voices);
+	ClassDB::bind_method(D_METHOD("get_mixed_voice_count"), &AudioServer::get_mixed_voice_count);
+	ClassDB::bind_method(D_METHOD("get_virtual_voice_count"), &AudioServer::get_virtual_voice_count);
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "bus_count"), "set_bus_count", "get_bus_count");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "device"), "set_device", "get_device");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "global_rate_scale"), "set_global_rate_scale", "get_global_rate_scale");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_voices", PROPERTY_HINT_RANGE, "1,1024,1,or_greater"), "set_max_voices", "get_max_voices");
 
 	ADD_SIGNAL(MethodInfo("bus_layout_changed"));
 
@@ -1298,8 +1874,14 @@ void AudioServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(SPEAKER_SURROUND_71);
 }
 
-AudioServer::AudioServer() {
+AudioServer::AudioServer() :
+		bus_wave_work(this, &AudioServer::_mix_bus_wave) {
 	singleton = this;
+	voice_owner.set_description("AudioServer voice");
+	max_voices = 128;
+	voice_virtualize_threshold = Math::db2linear(-60.0);
+	voices_mixed_count = 0;
+	voices_virtual_count = 0;
 	mix_frames = 0;
 	channel_count = 0;
 	to_mix = 0;
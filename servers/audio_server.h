@@ -31,14 +31,21 @@
 #ifndef AUDIO_SERVER_H
 #define AUDIO_SERVER_H
 
+#include "core/local_vector.h"
 #include "core/math/audio_frame.h"
 #include "core/object.h"
 #include "core/os/os.h"
+#include "core/rid_owner.h"
+#include "core/spin_lock.h"
+#include "core/thread_work_pool.h"
 #include "core/variant.h"
 #include "servers/audio/audio_effect.h"
+#include "servers/audio/audio_filter_sw.h"
 
+class AudioDecodePool;
 class AudioDriverDummy;
 class AudioStream;
+class AudioStreamPlayback;
 class AudioStreamSample;
 
 class AudioDriver {
@@ -161,6 +168,24 @@ public:
 
 	typedef void (*AudioCallback)(void *p_userdata);
 
+	enum {
+		MAX_CHANNELS_PER_BUS = 4,
+		MAX_BUSES_PER_VOICE = 8,
+	};
+
+	// A bus a voice is mixed to, with its volume in each channel of the bus.
+	struct VoiceTarget {
+		StringName bus;
+		AudioFrame volume[MAX_CHANNELS_PER_BUS];
+		float highshelf_gain = 1.0; // Below 1 dampens the frequencies above the voice cutoff, 1 disables the filter.
+
+		VoiceTarget() {
+			for (int i = 0; i < MAX_CHANNELS_PER_BUS; i++) {
+				volume[i] = AudioFrame(0, 0);
+			}
+		}
+	};
+
 private:
 	uint64_t mix_time;
 	int mix_size;
@@ -194,6 +219,7 @@ private:
 			bool active;
 			AudioFrame peak_volume;
 			Vector<AudioFrame> buffer;
+			Vector<AudioFrame> effect_buffer; // Effects write here, then it's swapped with buffer.
 			Vector<Ref<AudioEffectInstance>> effect_instances;
 			uint64_t last_mix_with_audio;
 			Channel() {
@@ -218,9 +244,14 @@ private:
 		float volume_db;
 		StringName send;
 		int index_cache;
+		int send_index = -1; // Resolved from send on every mix, -1 for the master bus.
+		int graph_depth = 0;
+		uint64_t cpu_time = 0; // Usecs spent mixing this bus in the last mix step.
+#ifdef DEBUG_ENABLED
+		uint64_t prof_time = 0;
+#endif
 	};
 
-	Vector<Vector<AudioFrame>> temp_buffer; //temp_buffer for each level
 	Vector<Bus *> buses;
 	Map<StringName, Bus *> bus_map;
 
@@ -232,6 +263,26 @@ private:
 
 	void _mix_step();
 
+	/* BUS GRAPH */
+
+	// Buses are mixed in waves. A wave only receives sends from the previous waves,
+	// so its buses are independent and can be mixed at the same time.
+	ThreadWorkPool bus_thread_pool;
+	ThreadWorkPool::PreparedWork<AudioServer, void (AudioServer::*)(uint32_t, uint32_t), uint32_t> bus_wave_work;
+	int bus_thread_count = 0;
+	bool mix_solo_mode = false;
+	LocalVector<int> bus_graph_order; // Bus indices, grouped by wave.
+	LocalVector<uint32_t> bus_graph_waves; // Start of each wave in bus_graph_order, plus the end.
+	LocalVector<int> bus_graph_sources; // Buses sending to each bus, highest index first like the serial mix.
+	LocalVector<uint32_t> bus_graph_source_offsets;
+	LocalVector<uint32_t> bus_graph_fill;
+	uint64_t mix_cpu_time = 0;
+
+	bool _update_bus_graph();
+	void _mix_bus(int p_bus);
+	void _mix_bus_send(int p_bus);
+	void _mix_bus_wave(uint32_t p_index, uint32_t p_wave_start);
+
 	struct CallbackItem {
 		AudioCallback callback;
 		void *userdata;
@@ -244,6 +295,78 @@ private:
 	Set<CallbackItem> callbacks;
 	Set<CallbackItem> update_callbacks;
 
+	/* VOICES */
+
+	enum {
+		VOICE_FADE_FRAMES = 128,
+		VOICE_VIRTUAL_SKIP_MSEC = 250, // How often virtual voices catch up with the time they were not mixed.
+	};
+
+	enum VoiceMixState {
+		VOICE_MIX_STOPPED,
+		VOICE_MIX_PLAYING,
+		VOICE_MIX_PAUSED,
+	};
+
+	struct Voice {
+		Ref<AudioStreamPlayback> playback;
+
+		// Set by the main thread under the lock, and taken by the audio thread once per mix.
+		SpinLock lock;
+		VoiceTarget targets[MAX_BUSES_PER_VOICE];
+		int target_count = 0;
+		bool targets_changed = false;
+		float pitch_scale = 1.0;
+		float priority = 1.0;
+		float highshelf_cutoff = 5000;
+		bool paused = false;
+		float start_from = -1; // A start was requested if not negative.
+		bool stop_requested = false;
+		bool playing = false;
+		bool freed = false; // Set under the driver lock, the audio thread fades it out and deletes it.
+
+		// Only used by the audio thread.
+		struct MixTarget {
+			VoiceTarget target;
+			AudioFrame prev_volume[MAX_CHANNELS_PER_BUS];
+			float prev_highshelf_gain = 1.0;
+			AudioFilterSW filter;
+			AudioFilterSW::Processor filter_process[MAX_CHANNELS_PER_BUS * 2];
+		};
+
+		MixTarget mix_targets[MAX_BUSES_PER_VOICE];
+		int mix_target_count = 0;
+		float mix_pitch_scale = 1.0;
+		float mix_priority = 1.0;
+		float mix_highshelf_cutoff = 5000;
+		VoiceMixState mix_state = VOICE_MIX_STOPPED;
+		bool mix_virtual = false;
+		bool mix_fade_in = false;
+		float virtual_time = 0;
+		float audibility = 0;
+	};
+
+	struct VoiceSort {
+		_FORCE_INLINE_ bool operator()(const Voice *p_a, const Voice *p_b) const {
+			return p_a->audibility > p_b->audibility;
+		}
+	};
+
+	mutable RID_PtrOwner<Voice> voice_owner;
+	LocalVector<Voice *> voices;
+	LocalVector<Voice *> voices_playing;
+	Vector<AudioFrame> voice_buffer;
+	int max_voices;
+	float voice_virtualize_threshold;
+	volatile int voices_mixed_count;
+	volatile int voices_virtual_count;
+	AudioDecodePool *decode_pool = nullptr; // Decodes compressed streams ahead of the voices.
+
+	void _mix_voices();
+	void _mix_voice(Voice *p_voice, int p_frames, float p_fade_from, float p_fade_to);
+	void _virtual_voice_skip(Voice *p_voice);
+	void _voice_finished(Voice *p_voice);
+
 	friend class AudioDriver;
 	void _driver_process(int p_frames, int32_t *p_buffer);
 
@@ -317,6 +440,15 @@ public:
 
 	bool is_bus_channel_active(int p_bus, int p_channel) const;
 
+	// CPU time of the last mix step, to compare with the time budget (the audio length of a step).
+	// With bus threads, the bus times are per thread and can add up to more than the mix time.
+	float get_bus_cpu_time(int p_bus) const;
+	float get_mix_cpu_time() const;
+	float get_mix_time_budget() const;
+	int get_bus_thread_count() const;
+	// Times a compressed stream wasn't decoded in time and was mixed as silence.
+	uint64_t get_decode_underrun_count() const;
+
 	void set_global_rate_scale(float p_scale);
 	float get_global_rate_scale() const;
 
@@ -347,6 +479,27 @@ public:
 	void add_update_callback(AudioCallback p_callback, void *p_userdata);
 	void remove_update_callback(AudioCallback p_callback, void *p_userdata);
 
+	// Voices own a playback and are mixed by the server. When there are more than the maximum,
+	// the least audible ones are virtualized: they keep advancing in time without being mixed.
+	RID voice_create(Ref<AudioStream> p_stream);
+	Ref<AudioStreamPlayback> voice_get_playback(RID p_voice) const;
+	void voice_set_targets(RID p_voice, const VoiceTarget *p_targets, int p_count);
+	void voice_set_pitch_scale(RID p_voice, float p_pitch_scale);
+	void voice_set_priority(RID p_voice, float p_priority);
+	void voice_set_highshelf_cutoff(RID p_voice, float p_hz);
+	void voice_play(RID p_voice, float p_from_pos = 0.0);
+	void voice_stop(RID p_voice);
+	void voice_set_paused(RID p_voice, bool p_paused);
+	bool voice_is_playing(RID p_voice) const;
+	float voice_get_playback_position(RID p_voice) const;
+	void voice_free(RID p_voice);
+
+	void set_max_voices(int p_count);
+	int get_max_voices() const;
+
+	int get_mixed_voice_count() const;
+	int get_virtual_voice_count() const;
+
 	void set_bus_layout(const Ref<AudioBusLayout> &p_bus_layout);
 	Ref<AudioBusLayout> generate_bus_layout() const;
 
@@ -34,6 +34,7 @@
 #include "core/project_settings.h"
 
 #include "audio/audio_effect.h"
+#include "audio/audio_decode_ahead.h"
 #include "audio/audio_stream.h"
 #include "audio/effects/audio_effect_amplify.h"
 #include "audio/effects/audio_effect_chorus.h"
@@ -117,6 +118,7 @@ void register_server_types() {
 	ClassDB::register_virtual_class<AudioStream>();
 	ClassDB::register_virtual_class<AudioStreamPlayback>();
 	ClassDB::register_virtual_class<AudioStreamPlaybackResampled>();
+	ClassDB::register_virtual_class<AudioStreamPlaybackDecodeAhead>();
 	ClassDB::register_class<AudioStreamMicrophone>();
 	ClassDB::register_class<AudioStreamRandomPitch>();
 	ClassDB::register_virtual_class<AudioEffect>();
@@ -0,0 +1,77 @@
+/*************************************************************************/
+/*  mesh_lod.h                                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include "core/math/camera_matrix.h"
+
+// Screen space error based selection of the index LODs stored in mesh surfaces.
+// LOD errors are in mesh space units, LOD 0 is always the full detail surface.
+class MeshLOD {
+public:
+	// Largest mesh space error an instance can show while staying below p_threshold_pixels on screen.
+	// Returns 0 (full detail) when the camera is inside the instance or the threshold is disabled.
+	static _FORCE_INLINE_ float get_error_limit(const CameraMatrix &p_projection, float p_viewport_height, float p_distance, float p_model_scale, float p_threshold_pixels) {
+		if (p_threshold_pixels <= 0.0 || p_viewport_height <= 0.0 || p_model_scale <= 0.0) {
+			return 0.0;
+		}
+
+		float pixels_per_unit = p_projection.matrix[1][1] * p_viewport_height * 0.5 * p_model_scale;
+		if (!p_projection.is_orthogonal()) {
+			if (p_distance <= 0.0) {
+				return 0.0;
+			}
+			pixels_per_unit /= p_distance;
+		}
+
+		if (pixels_per_unit <= 0.0) {
+			return 0.0;
+		}
+
+		return p_threshold_pixels / pixels_per_unit;
+	}
+
+	// Picks the coarsest LOD whose error fits the limit, LODs are 1-based so 0 means full detail.
+	template <class T>
+	static _FORCE_INLINE_ uint32_t select(const T *p_lods, uint32_t p_lod_count, float p_error_limit) {
+		uint32_t lod = 0;
+		float lod_error = 0.0;
+		for (uint32_t i = 0; i < p_lod_count; i++) {
+			if (p_lods[i].edge_length <= p_error_limit && p_lods[i].edge_length > lod_error) {
+				lod = i + 1;
+				lod_error = p_lods[i].edge_length;
+			}
+		}
+		return lod;
+	}
+};
+
+#endif // MESH_LOD_H
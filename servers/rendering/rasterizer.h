@@ -150,6 +150,8 @@ public:
 		RID instance_data;
 
 		Transform transform;
+		uint32_t transform_version; //increased every time the transform changes
+		uint32_t transform_slot; //persistent render data slot, owned by the scene renderer
 
 		int depth_layer;
 		uint32_t layer_mask;
@@ -175,6 +177,7 @@ public:
 		bool redraw_if_visible : 4;
 
 		float depth; //used for sorting
+		float lod_error_limit; //largest mesh LOD error allowed in the current pass, 0 draws full detail
 
 		SelfList<InstanceBase> dependency_item;
 
@@ -249,12 +252,15 @@ public:
 			depth_layer = 0;
 			layer_mask = 1;
 			instance_version = 0;
+			transform_version = 1;
+			transform_slot = 0xFFFFFFFF;
 			baked_light = false;
 			dynamic_gi = false;
 			redraw_if_visible = false;
 			lightmap_slice_index = 0;
 			lightmap = nullptr;
 			lightmap_cull_index = 0;
+			lod_error_limit = 0;
 		}
 
 		virtual ~InstanceBase() {
@@ -315,6 +321,7 @@ public:
 	virtual TypedArray<Image> bake_render_uv2(RID p_base, const Vector<RID> &p_material_overrides, const Size2i &p_image_size) = 0;
 
 	virtual bool free(RID p_rid) = 0;
+	virtual void instance_free_render_data(InstanceBase *p_instance) = 0;
 
 	virtual void sdfgi_set_debug_probe_select(const Vector3 &p_position, const Vector3 &p_dir) = 0;
 
@@ -406,6 +413,8 @@ public:
 	virtual void material_get_instance_shader_parameters(RID p_material, List<InstanceShaderParam> *r_parameters) = 0;
 
 	virtual void material_update_dependency(RID p_material, RasterizerScene::InstanceBase *p_instance) = 0;
+	// Textures assigned to the material parameters, including those of the next passes.
+	virtual void material_get_textures(RID p_material, List<RID> *r_textures) = 0;
 
 	/* MESH API */
 
@@ -0,0 +1,137 @@
+/*************************************************************************/
+/*  canvas_rect_batcher_rd.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef CANVAS_RECT_BATCHER_RD_H
+#define CANVAS_RECT_BATCHER_RD_H
+
+#include "core/local_vector.h"
+
+/* Groups consecutive rect and ninepatch commands that can be drawn with the same
+ * bound state. The renderer asks whether a rect fits the open batch, draws the open batch
+ * (flush()) when it does not, and appends the rect. Instances of all batches are
+ * kept in order so they can be uploaded with a single buffer update at the end of
+ * the pass. It does not talk to the RenderingDevice, so it can be tested on its own.
+ */
+
+class CanvasRectBatcherRD {
+public:
+	// Must match RectInstance in canvas_uniforms_inc.glsl.
+	struct Instance {
+		float world[6];
+		uint32_t pad[2];
+		float modulation[4];
+		float dst_rect[4];
+		float src_rect[4];
+		float ninepatch_margins[4]; // Zero for plain rects.
+	};
+
+	// Everything a rect draw depends on besides its instance data.
+	struct State {
+		uint64_t texture_binding = 0;
+		uint64_t pipeline = 0;
+		uint64_t item_state = 0; // Uniform set of lit items, lights can't be shared across items. Zero when unlit.
+		uint32_t flags = 0;
+		uint32_t specular_shininess = 0;
+		uint32_t lights[4] = { 0, 0, 0, 0 };
+		float world[6] = { 0, 0, 0, 0, 0, 0 }; // Used for normals of lit items, zero when unlit.
+		float color_texture_pixel_size[2] = { 0, 0 };
+
+		bool operator==(const State &p_state) const {
+			if (texture_binding != p_state.texture_binding || pipeline != p_state.pipeline || item_state != p_state.item_state || flags != p_state.flags || specular_shininess != p_state.specular_shininess) {
+				return false;
+			}
+			for (int i = 0; i < 4; i++) {
+				if (lights[i] != p_state.lights[i]) {
+					return false;
+				}
+			}
+			for (int i = 0; i < 6; i++) {
+				if (world[i] != p_state.world[i]) {
+					return false;
+				}
+			}
+			return color_texture_pixel_size[0] == p_state.color_texture_pixel_size[0] && color_texture_pixel_size[1] == p_state.color_texture_pixel_size[1];
+		}
+		bool operator!=(const State &p_state) const { return !(*this == p_state); }
+	};
+
+	struct Batch {
+		State state;
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+private:
+	LocalVector<Instance> instances;
+	Batch open_batch;
+	bool open = false;
+	uint32_t batch_count = 0;
+
+public:
+	void begin() {
+		instances.clear();
+		open = false;
+		batch_count = 0;
+	}
+
+	_FORCE_INLINE_ bool is_open() const { return open; }
+	_FORCE_INLINE_ const Batch &get_open_batch() const { return open_batch; }
+
+	// False when the rect needs a new batch, the open one (if any) must be flushed before binding p_state.
+	_FORCE_INLINE_ bool can_append(const State &p_state) const {
+		return open && open_batch.state == p_state;
+	}
+
+	void append(const State &p_state, const Instance &p_instance) {
+		if (!can_append(p_state)) {
+			ERR_FAIL_COND_MSG(open, "The open batch must be flushed before starting a new one.");
+			open_batch.state = p_state;
+			open_batch.first = instances.size();
+			open_batch.count = 0;
+			open = true;
+		}
+		instances.push_back(p_instance);
+		open_batch.count++;
+	}
+
+	// Closes the open batch and returns it, so the caller can issue its draw.
+	Batch flush() {
+		ERR_FAIL_COND_V(!open, Batch());
+		open = false;
+		batch_count++;
+		return open_batch;
+	}
+
+	_FORCE_INLINE_ uint32_t get_batch_count() const { return batch_count; }
+	_FORCE_INLINE_ uint32_t get_instance_count() const { return instances.size(); }
+	_FORCE_INLINE_ const Instance *get_instances() const { return instances.ptr(); }
+};
+
+#endif // CANVAS_RECT_BATCHER_RD_H
@@ -0,0 +1,181 @@
+/*************************************************************************/
+/*  instance_transform_slots_rd.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef INSTANCE_TRANSFORM_SLOTS_RD_H
+#define INSTANCE_TRANSFORM_SLOTS_RD_H
+
+#include "core/error_macros.h"
+#include "core/local_vector.h"
+
+/* Keeps instance transforms in slots that each instance owns for its whole life, so
+ * only the regions of the buffer holding changed transforms need to be uploaded. Freed
+ * slots are reused before the buffer grows, and it grows by doubling. The renderer
+ * recreates the buffer when is_resized() and uploads the ranges returned by
+ * get_uploads(). It does not talk to the RenderingDevice, so it can be tested on its own.
+ */
+
+class InstanceTransformSlotsRD {
+public:
+	enum {
+		INITIAL_CAPACITY = 1024,
+		DIRTY_REGION_SIZE = 64, // In slots.
+		INVALID_SLOT = 0xFFFFFFFF
+	};
+
+	// Must match InstanceTransformData in scene_high_end_inc.glsl.
+	struct Transform {
+		float transform[16];
+		float normal_transform[16];
+	};
+
+	// Slots [from, to) to upload with a single buffer update.
+	struct Upload {
+		uint32_t from = 0;
+		uint32_t to = 0;
+	};
+
+private:
+	uint32_t capacity = 0;
+	uint32_t slot_count = 0; // Slots ever handed out, the rest of the buffer is unused.
+	LocalVector<uint32_t> free_slots;
+
+	LocalVector<Transform> transforms;
+	LocalVector<uint32_t> versions; // Version last stored in each slot, zero when free.
+
+	LocalVector<bool> dirty_regions;
+	uint32_t dirty_region_count = 0;
+	bool resized = false; // The buffer must be recreated and fully uploaded.
+
+	void _resize(uint32_t p_capacity) {
+		uint32_t old_regions = dirty_regions.size();
+		capacity = p_capacity;
+		transforms.resize(p_capacity);
+		versions.resize(p_capacity);
+		for (uint32_t i = slot_count; i < p_capacity; i++) {
+			versions[i] = 0;
+		}
+		dirty_regions.resize((p_capacity + DIRTY_REGION_SIZE - 1) / DIRTY_REGION_SIZE);
+		for (uint32_t i = old_regions; i < dirty_regions.size(); i++) {
+			dirty_regions[i] = false;
+		}
+	}
+
+public:
+	void init(uint32_t p_capacity = INITIAL_CAPACITY) {
+		ERR_FAIL_COND(p_capacity == 0);
+		slot_count = 0;
+		free_slots.clear();
+		dirty_regions.clear();
+		dirty_region_count = 0;
+		_resize(p_capacity);
+		resized = false;
+	}
+
+	uint32_t allocate() {
+		if (free_slots.size()) {
+			uint32_t slot = free_slots[free_slots.size() - 1];
+			free_slots.resize(free_slots.size() - 1);
+			return slot;
+		}
+
+		if (slot_count == capacity) {
+			_resize(capacity * 2);
+			resized = true;
+		}
+
+		return slot_count++;
+	}
+
+	void free(uint32_t p_slot) {
+		ERR_FAIL_UNSIGNED_INDEX(p_slot, slot_count);
+		versions[p_slot] = 0; // Whoever gets it next must store its transform.
+		free_slots.push_back(p_slot);
+	}
+
+	_FORCE_INLINE_ void mark_dirty(uint32_t p_slot) {
+		uint32_t region = p_slot / DIRTY_REGION_SIZE;
+		if (!dirty_regions[region]) {
+			dirty_regions[region] = true;
+			dirty_region_count++;
+		}
+	}
+
+	_FORCE_INLINE_ Transform &get_transform(uint32_t p_slot) { return transforms[p_slot]; }
+	_FORCE_INLINE_ const Transform *get_transforms() const { return transforms.ptr(); }
+	_FORCE_INLINE_ uint32_t get_version(uint32_t p_slot) const { return versions[p_slot]; }
+	_FORCE_INLINE_ void set_version(uint32_t p_slot, uint32_t p_version) { versions[p_slot] = p_version; }
+
+	_FORCE_INLINE_ uint32_t get_capacity() const { return capacity; }
+	_FORCE_INLINE_ uint32_t get_slot_count() const { return slot_count; }
+	_FORCE_INLINE_ uint32_t get_dirty_region_count() const { return dirty_region_count; }
+	_FORCE_INLINE_ bool is_resized() const { return resized; }
+
+	// Returns the ranges changed since the last call and clears the dirty regions. Once a
+	// quarter or more of the used regions are dirty (or the buffer was recreated), the whole
+	// used part is returned as a single range, as one large update is cheaper than many small ones.
+	void get_uploads(LocalVector<Upload> &r_uploads) {
+		r_uploads.clear();
+
+		uint32_t used_regions = (slot_count + DIRTY_REGION_SIZE - 1) / DIRTY_REGION_SIZE;
+
+		if (resized || dirty_region_count * 4 >= used_regions) {
+			if (resized || dirty_region_count > 0) {
+				Upload upload;
+				upload.to = slot_count;
+				r_uploads.push_back(upload);
+			}
+			for (uint32_t i = 0; i < used_regions; i++) {
+				dirty_regions[i] = false;
+			}
+		} else {
+			// Upload runs of consecutive dirty regions in a single range each.
+			uint32_t i = 0;
+			while (i < used_regions) {
+				if (!dirty_regions[i]) {
+					i++;
+					continue;
+				}
+				Upload upload;
+				upload.from = i * DIRTY_REGION_SIZE;
+				while (i < used_regions && dirty_regions[i]) {
+					dirty_regions[i] = false;
+					i++;
+				}
+				upload.to = MIN(i * DIRTY_REGION_SIZE, slot_count);
+				r_uploads.push_back(upload);
+			}
+		}
+
+		resized = false;
+		dirty_region_count = 0;
+	}
+};
+
+#endif // INSTANCE_TRANSFORM_SLOTS_RD_H
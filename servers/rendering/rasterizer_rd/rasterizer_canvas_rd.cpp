@@ -457,9 +457,10 @@ void RasterizerCanvasRD::free_polygon(PolygonID p_polygon) {
 	polygon_buffers.polygons.erase(p_polygon);
 }
 
-Size2i RasterizerCanvasRD::_bind_texture_binding(TextureBindingID p_binding, RD::DrawListID p_draw_list, uint32_t &flags) {
+RID RasterizerCanvasRD::_get_texture_binding_uniform_set(TextureBindingID p_binding, uint32_t &flags, Size2i &r_size) {
+	r_size = Size2i();
 	TextureBinding **texture_binding_ptr = bindings.texture_bindings.getptr(p_binding);
-	ERR_FAIL_COND_V(!texture_binding_ptr, Size2i());
+	ERR_FAIL_COND_V(!texture_binding_ptr, RID());
 	TextureBinding *texture_binding = *texture_binding_ptr;
 
 	if (texture_binding->key.normalmap.is_valid()) {
@@ -472,15 +473,151 @@ Size2i RasterizerCanvasRD::_bind_texture_binding(TextureBindingID p_binding, RD:
 	if (!RD::get_singleton()->uniform_set_is_valid(texture_binding->uniform_set)) {
 		//texture may have changed (erased or replaced, see if we can fix)
 		texture_binding->uniform_set = _create_texture_binding(texture_binding->key.texture, texture_binding->key.normalmap, texture_binding->key.specular, texture_binding->key.texture_filter, texture_binding->key.texture_repeat, texture_binding->key.multimesh);
-		ERR_FAIL_COND_V(!texture_binding->uniform_set.is_valid(), Size2i(1, 1));
+		if (!texture_binding->uniform_set.is_valid()) {
+			r_size = Size2i(1, 1);
+			ERR_FAIL_V(RID());
+		}
 	}
 
-	RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, texture_binding->uniform_set, 0);
 	if (texture_binding->key.texture.is_valid()) {
-		return storage->texture_2d_get_size(texture_binding->key.texture);
+		r_size = storage->texture_2d_get_size(texture_binding->key.texture);
 	} else {
-		return Size2i(1, 1);
+		r_size = Size2i(1, 1);
 	}
+	return texture_binding->uniform_set;
+}
+
+Size2i RasterizerCanvasRD::_bind_texture_binding(TextureBindingID p_binding, RD::DrawListID p_draw_list, uint32_t &flags) {
+	Size2i size;
+	RID uniform_set = _get_texture_binding_uniform_set(p_binding, flags, size);
+	if (uniform_set.is_valid()) {
+		RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, uniform_set, 0);
+	}
+	return size;
+}
+
+void RasterizerCanvasRD::_rect_batching_begin_pass(int p_item_count) {
+	rect_batching.batcher.begin();
+
+	if (!rect_batching.enabled) {
+		return;
+	}
+
+	uint64_t frame = RasterizerRD::singleton->get_frame_number();
+	if (rect_batching.last_frame != frame) {
+		//all uploads of a frame happen before its draws, so passes within a frame can't share buffer space
+		rect_batching.frame_offset = 0;
+		rect_batching.last_frame = frame;
+	}
+
+	uint32_t rect_count = 0;
+	for (int i = 0; i < p_item_count; i++) {
+		const Item::Command *c = items[i]->commands;
+		while (c) {
+			if (c->type == Item::Command::TYPE_RECT || c->type == Item::Command::TYPE_NINEPATCH) {
+				rect_count++;
+			}
+			c = c->next;
+		}
+	}
+
+	uint32_t required = rect_batching.frame_offset + rect_count;
+	if (required <= rect_batching.capacity) {
+		return;
+	}
+
+	//passes already recorded this frame keep the old buffer until it's disposed of
+	if (rect_batching.instance_buffer.is_valid()) {
+		RD::get_singleton()->free(rect_batching.instance_buffer);
+	}
+	rect_batching.capacity = MAX(uint32_t(RectBatching::INITIAL_CAPACITY), next_power_of_2(required));
+	rect_batching.instance_buffer = RD::get_singleton()->storage_buffer_create(rect_batching.capacity * sizeof(CanvasRectBatcherRD::Instance));
+	//canvas item uniform sets reference the buffer, they are recreated when found invalid
+}
+
+void RasterizerCanvasRD::_rect_batching_end_pass() {
+	uint32_t instance_count = rect_batching.batcher.get_instance_count();
+	if (instance_count == 0) {
+		return;
+	}
+
+	ERR_FAIL_COND(rect_batching.frame_offset + instance_count > rect_batching.capacity);
+	RD::get_singleton()->buffer_update(rect_batching.instance_buffer, rect_batching.frame_offset * sizeof(CanvasRectBatcherRD::Instance), instance_count * sizeof(CanvasRectBatcherRD::Instance), rect_batching.batcher.get_instances());
+	rect_batching.frame_offset += instance_count;
+
+	storage->render_info_add_2d_batches(rect_batching.batcher.get_batch_count());
+}
+
+void RasterizerCanvasRD::_flush_rect_batch(RD::DrawListID p_draw_list) {
+	if (!rect_batching.batcher.is_open()) {
+		return;
+	}
+
+	CanvasRectBatcherRD::Batch batch = rect_batching.batcher.flush();
+
+	PushConstant push_constant;
+	for (int i = 0; i < 6; i++) {
+		push_constant.world[i] = batch.state.world[i];
+	}
+	push_constant.flags = batch.state.flags | FLAGS_BATCHED_RECTS;
+	push_constant.specular_shininess = batch.state.specular_shininess;
+	for (int i = 0; i < 4; i++) {
+		push_constant.modulation[i] = 0;
+		push_constant.ninepatch_margins[i] = 0;
+		push_constant.dst_rect[i] = 0;
+		push_constant.src_rect[i] = 0;
+		push_constant.lights[i] = batch.state.lights[i];
+	}
+	push_constant.batch_offset = rect_batching.frame_offset + batch.first;
+	push_constant.pad = 0;
+	push_constant.color_texture_pixel_size[0] = batch.state.color_texture_pixel_size[0];
+	push_constant.color_texture_pixel_size[1] = batch.state.color_texture_pixel_size[1];
+
+	RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
+	RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
+	RD::get_singleton()->draw_list_draw(p_draw_list, true, batch.count);
+}
+
+void RasterizerCanvasRD::_add_rect_batch_instance(RD::DrawListID p_draw_list, const PushConstant &p_push_constant, TextureBindingID p_texture_binding, RID p_pipeline, RID p_texture_uniform_set, RID p_item_state, bool p_lit) {
+	CanvasRectBatcherRD::State batch_state;
+	batch_state.texture_binding = p_texture_binding;
+	batch_state.pipeline = p_pipeline.get_id();
+	batch_state.flags = p_push_constant.flags;
+	batch_state.specular_shininess = p_push_constant.specular_shininess;
+	batch_state.color_texture_pixel_size[0] = p_push_constant.color_texture_pixel_size[0];
+	batch_state.color_texture_pixel_size[1] = p_push_constant.color_texture_pixel_size[1];
+	if (p_lit) {
+		//lights and normals depend on the item, don't merge with other items
+		batch_state.item_state = p_item_state.get_id();
+		for (int j = 0; j < 4; j++) {
+			batch_state.lights[j] = p_push_constant.lights[j];
+		}
+		for (int j = 0; j < 6; j++) {
+			batch_state.world[j] = p_push_constant.world[j];
+		}
+	}
+
+	if (!rect_batching.batcher.can_append(batch_state)) {
+		_flush_rect_batch(p_draw_list);
+		RD::get_singleton()->draw_list_bind_render_pipeline(p_draw_list, p_pipeline);
+		if (p_texture_uniform_set.is_valid()) {
+			RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, p_texture_uniform_set, 0);
+		}
+	}
+
+	CanvasRectBatcherRD::Instance instance;
+	for (int j = 0; j < 6; j++) {
+		instance.world[j] = p_push_constant.world[j];
+	}
+	instance.pad[0] = 0;
+	instance.pad[1] = 0;
+	for (int j = 0; j < 4; j++) {
+		instance.modulation[j] = p_push_constant.modulation[j];
+		instance.dst_rect[j] = p_push_constant.dst_rect[j];
+		instance.src_rect[j] = p_push_constant.src_rect[j];
+		instance.ninepatch_margins[j] = p_push_constant.ninepatch_margins[j];
+	}
+	rect_batching.batcher.append(batch_state, instance);
 }
 
 ////////////////////
@@ -503,8 +640,8 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 	push_constant.color_texture_pixel_size[0] = 0;
 	push_constant.color_texture_pixel_size[1] = 0;
 
-	push_constant.pad[0] = 0;
-	push_constant.pad[1] = 0;
+	push_constant.batch_offset = 0;
+	push_constant.pad = 0;
 
 	push_constant.lights[0] = 0;
 	push_constant.lights[1] = 0;
@@ -525,6 +662,7 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 	Light *light_cache[DEFAULT_MAX_LIGHTS_PER_ITEM];
 	uint16_t light_count = 0;
 	PipelineLightMode light_mode;
+	RID item_state;
 
 	{
 		Light *light = p_lights;
@@ -608,6 +746,14 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 				uniforms.push_back(u);
 			}
 
+			{
+				RD::Uniform u;
+				u.type = RD::UNIFORM_TYPE_STORAGE_BUFFER;
+				u.binding = 8;
+				u.ids.push_back(rect_batching.instance_buffer);
+				uniforms.push_back(u);
+			}
+
 			//validate and update lighs if they are being used
 
 			if (light_count > 0) {
@@ -675,7 +821,13 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 			}
 		}
 
+		//unlit items bind equivalent canvas item state, so rect batches can continue across them
+		if (light_count > 0 || (rect_batching.batcher.is_open() && rect_batching.batcher.get_open_batch().state.item_state != 0)) {
+			_flush_rect_batch(p_draw_list);
+		}
+
 		RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, canvas_item_state, 2);
+		item_state = canvas_item_state;
 	}
 
 	light_mode = light_count > 0 ? PIPELINE_LIGHT_MODE_ENABLED : PIPELINE_LIGHT_MODE_DISABLED;
@@ -693,17 +845,15 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 			case Item::Command::TYPE_RECT: {
 				const Item::CommandRect *rect = static_cast<const Item::CommandRect *>(c);
 
-				//bind pipeline
-				{
-					RID pipeline = pipeline_variants->variants[light_mode][PIPELINE_VARIANT_QUAD].get_render_pipeline(RD::INVALID_ID, p_framebuffer_format);
-					RD::get_singleton()->draw_list_bind_render_pipeline(p_draw_list, pipeline);
-				}
+				RID pipeline = pipeline_variants->variants[light_mode][PIPELINE_VARIANT_QUAD].get_render_pipeline(RD::INVALID_ID, p_framebuffer_format);
 
-				//bind textures
+				//textures are bound below, once it's known whether the rect starts a new batch
+				Size2i texture_size;
+				RID texture_uniform_set = _get_texture_binding_uniform_set(rect->texture_binding.binding_id, push_constant.flags, texture_size);
 
 				Size2 texpixel_size;
 				{
-					texpixel_size = _bind_texture_binding(rect->texture_binding.binding_id, p_draw_list, push_constant.flags);
+					texpixel_size = texture_size;
 					texpixel_size.x = 1.0 / texpixel_size.x;
 					texpixel_size.y = 1.0 / texpixel_size.y;
 				}
@@ -783,26 +933,34 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 				push_constant.color_texture_pixel_size[0] = texpixel_size.x;
 				push_constant.color_texture_pixel_size[1] = texpixel_size.y;
 
-				RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
-				RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
-				RD::get_singleton()->draw_list_draw(p_draw_list, true);
+				if (rect_batching.enabled && !(push_constant.flags & FLAGS_CLIP_RECT_UV)) {
+					_add_rect_batch_instance(p_draw_list, push_constant, rect->texture_binding.binding_id, pipeline, texture_uniform_set, item_state, light_count > 0);
+				} else {
+					_flush_rect_batch(p_draw_list);
+					RD::get_singleton()->draw_list_bind_render_pipeline(p_draw_list, pipeline);
+					if (texture_uniform_set.is_valid()) {
+						RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, texture_uniform_set, 0);
+					}
+
+					RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
+					RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
+					RD::get_singleton()->draw_list_draw(p_draw_list, true);
+				}
 
 			} break;
 
 			case Item::Command::TYPE_NINEPATCH: {
 				const Item::CommandNinePatch *np = static_cast<const Item::CommandNinePatch *>(c);
 
-				//bind pipeline
-				{
-					RID pipeline = pipeline_variants->variants[light_mode][PIPELINE_VARIANT_NINEPATCH].get_render_pipeline(RD::INVALID_ID, p_framebuffer_format);
-					RD::get_singleton()->draw_list_bind_render_pipeline(p_draw_list, pipeline);
-				}
+				RID pipeline = pipeline_variants->variants[light_mode][PIPELINE_VARIANT_NINEPATCH].get_render_pipeline(RD::INVALID_ID, p_framebuffer_format);
 
-				//bind textures
+				//textures are bound below, once it's known whether the ninepatch starts a new batch
+				Size2i texture_size;
+				RID texture_uniform_set = _get_texture_binding_uniform_set(np->texture_binding.binding_id, push_constant.flags, texture_size);
 
 				Size2 texpixel_size;
 				{
-					texpixel_size = _bind_texture_binding(np->texture_binding.binding_id, p_draw_list, push_constant.flags);
+					texpixel_size = texture_size;
 					texpixel_size.x = 1.0 / texpixel_size.x;
 					texpixel_size.y = 1.0 / texpixel_size.y;
 				}
@@ -859,13 +1017,24 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 				push_constant.ninepatch_margins[2] = np->margin[MARGIN_RIGHT];
 				push_constant.ninepatch_margins[3] = np->margin[MARGIN_BOTTOM];
 
-				RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
-				RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
-				RD::get_singleton()->draw_list_draw(p_draw_list, true);
+				if (rect_batching.enabled) {
+					//axis modes and draw center are in the flags, so only ninepatches sharing them are merged
+					_add_rect_batch_instance(p_draw_list, push_constant, np->texture_binding.binding_id, pipeline, texture_uniform_set, item_state, light_count > 0);
+				} else {
+					RD::get_singleton()->draw_list_bind_render_pipeline(p_draw_list, pipeline);
+					if (texture_uniform_set.is_valid()) {
+						RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, texture_uniform_set, 0);
+					}
+
+					RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
+					RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
+					RD::get_singleton()->draw_list_draw(p_draw_list, true);
+				}
 
 			} break;
 			case Item::Command::TYPE_POLYGON: {
 				const Item::CommandPolygon *polygon = static_cast<const Item::CommandPolygon *>(c);
+				_flush_rect_batch(p_draw_list);
 
 				PolygonBuffers *pb = polygon_buffers.polygons.getptr(polygon->polygon.polygon_id);
 				ERR_CONTINUE(!pb);
@@ -921,6 +1090,7 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 			} break;
 			case Item::Command::TYPE_PRIMITIVE: {
 				const Item::CommandPrimitive *primitive = static_cast<const Item::CommandPrimitive *>(c);
+				_flush_rect_batch(p_draw_list);
 
 				//bind pipeline
 				{
@@ -1273,6 +1443,7 @@ void RasterizerCanvasRD::_render_item(RD::DrawListID p_draw_list, const Item *p_
 				const Item::CommandClipIgnore *ci = static_cast<const Item::CommandClipIgnore *>(c);
 				if (current_clip) {
 					if (ci->ignore != reclip) {
+						_flush_rect_batch(p_draw_list);
 						if (ci->ignore) {
 							RD::get_singleton()->draw_list_disable_scissor(p_draw_list);
 							reclip = true;
@@ -1315,6 +1486,8 @@ void RasterizerCanvasRD::_render_items(RID p_to_render_target, int p_item_count,
 
 	RD::FramebufferFormatID fb_format = RD::get_singleton()->framebuffer_get_format(framebuffer);
 
+	_rect_batching_begin_pass(p_item_count);
+
 	RD::DrawListID draw_list = RD::get_singleton()->draw_list_begin(framebuffer, clear ? RD::INITIAL_ACTION_CLEAR : RD::INITIAL_ACTION_KEEP, RD::FINAL_ACTION_READ, RD::INITIAL_ACTION_KEEP, RD::FINAL_ACTION_DISCARD, clear_colors);
 
 	if (p_screen_uniform_set.is_valid()) {
@@ -1328,6 +1501,7 @@ void RasterizerCanvasRD::_render_items(RID p_to_render_target, int p_item_count,
 		Item *ci = items[i];
 
 		if (current_clip != ci->final_clip_owner) {
+			_flush_rect_batch(draw_list);
 			current_clip = ci->final_clip_owner;
 
 			//setup clip
@@ -1340,6 +1514,8 @@ void RasterizerCanvasRD::_render_items(RID p_to_render_target, int p_item_count,
 		}
 
 		if (ci->material != prev_material) {
+			_flush_rect_batch(draw_list);
+
 			MaterialData *material_data = nullptr;
 			if (ci->material.is_valid()) {
 				material_data = (MaterialData *)storage->material_get_data(ci->material, RasterizerStorageRD::SHADER_TYPE_2D);
@@ -1364,7 +1540,11 @@ void RasterizerCanvasRD::_render_items(RID p_to_render_target, int p_item_count,
 		prev_material = ci->material;
 	}
 
+	_flush_rect_batch(draw_list);
+
 	RD::get_singleton()->draw_list_end();
+
+	_rect_batching_end_pass();
 }
 
 void RasterizerCanvasRD::canvas_render_items(RID p_to_render_target, Item *p_item_list, const Color &p_modulate, Light *p_light_list, const Transform2D &p_canvas_transform) {
@@ -2332,7 +2512,7 @@ RasterizerCanvasRD::RasterizerCanvasRD(RasterizerStorageRD *p_storage) {
 		actions.base_uniform_string = "material.";
 		actions.default_filter = ShaderLanguage::FILTER_LINEAR;
 		actions.default_repeat = ShaderLanguage::REPEAT_DISABLE;
-		actions.base_varying_index = 4;
+		actions.base_varying_index = 5; //location 4 is the instance index of batched ninepatches
 
 		actions.global_buffer_array_variable = "global_variables.data";
 
@@ -2433,6 +2613,12 @@ RasterizerCanvasRD::RasterizerCanvasRD(RasterizerStorageRD *p_storage) {
 		primitive_arrays.index_array[3] = shader.quad_index_array = RD::get_singleton()->index_array_create(shader.quad_index_buffer, 0, 6);
 	}
 
+	{ //rect batching
+		rect_batching.enabled = GLOBAL_DEF("rendering/quality/2d/use_batching", true);
+		rect_batching.capacity = RectBatching::INITIAL_CAPACITY;
+		rect_batching.instance_buffer = RD::get_singleton()->storage_buffer_create(rect_batching.capacity * sizeof(CanvasRectBatcherRD::Instance));
+	}
+
 	{ //default skeleton buffer
 
 		shader.default_skeleton_uniform_buffer = RD::get_singleton()->uniform_buffer_create(sizeof(SkeletonUniform));
@@ -2481,6 +2667,7 @@ RasterizerCanvasRD::~RasterizerCanvasRD() {
 		RD::get_singleton()->free(state.lights_uniform_buffer);
 		RD::get_singleton()->free(shader.default_skeleton_uniform_buffer);
 		RD::get_singleton()->free(shader.default_skeleton_texture_buffer);
+		RD::get_singleton()->free(rect_batching.instance_buffer);
 	}
 
 	//shadow rendering
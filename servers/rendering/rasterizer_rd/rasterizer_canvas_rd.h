@@ -32,6 +32,7 @@
 #define RASTERIZER_CANVAS_RD_H
 
 #include "servers/rendering/rasterizer.h"
+#include "servers/rendering/rasterizer_rd/canvas_rect_batcher_rd.h"
 #include "servers/rendering/rasterizer_rd/rasterizer_storage_rd.h"
 #include "servers/rendering/rasterizer_rd/render_pipeline_vertex_format_cache_rd.h"
 #include "servers/rendering/rasterizer_rd/shader_compiler_rd.h"
@@ -79,6 +80,8 @@ class RasterizerCanvasRD : public RasterizerCanvas {
 		FLAGS_NINEPATCH_V_MODE_SHIFT = 18,
 		FLAGS_LIGHT_COUNT_SHIFT = 20,
 
+		FLAGS_BATCHED_RECTS = (1 << 24),
+
 		FLAGS_DEFAULT_NORMAL_MAP_USED = (1 << 26),
 		FLAGS_DEFAULT_SPECULAR_MAP_USED = (1 << 27)
 
@@ -432,7 +435,8 @@ class RasterizerCanvasRD : public RasterizerCanvas {
 				float ninepatch_margins[4];
 				float dst_rect[4];
 				float src_rect[4];
-				float pad[2];
+				uint32_t batch_offset;
+				uint32_t pad;
 			};
 			//primitive
 			struct {
@@ -450,8 +454,31 @@ class RasterizerCanvasRD : public RasterizerCanvas {
 		float skeleton_inverse[16];
 	};
 
+	/* RECT BATCHING */
+
+	// Consecutive rects and ninepatches sharing texture, material, clip and lights are drawn instanced,
+	// reading their rect data from a buffer streamed every frame.
+	struct RectBatching {
+		enum {
+			INITIAL_CAPACITY = 4096
+		};
+
+		bool enabled = true;
+		CanvasRectBatcherRD batcher;
+		RID instance_buffer;
+		uint32_t capacity = 0; // in instances
+		uint32_t frame_offset = 0; // instances already used by previous passes this frame
+		uint64_t last_frame = 0;
+	} rect_batching;
+
+	void _rect_batching_begin_pass(int p_item_count);
+	void _rect_batching_end_pass();
+	void _flush_rect_batch(RenderingDevice::DrawListID p_draw_list);
+	void _add_rect_batch_instance(RenderingDevice::DrawListID p_draw_list, const PushConstant &p_push_constant, TextureBindingID p_texture_binding, RID p_pipeline, RID p_texture_uniform_set, RID p_item_state, bool p_lit);
+
 	Item *items[MAX_RENDER_ITEMS];
 
+	RID _get_texture_binding_uniform_set(TextureBindingID p_binding, uint32_t &flags, Size2i &r_size);
 	Size2i _bind_texture_binding(TextureBindingID p_binding, RenderingDevice::DrawListID p_draw_list, uint32_t &flags);
 	void _render_item(RenderingDevice::DrawListID p_draw_list, const Item *p_item, RenderingDevice::FramebufferFormatID p_framebuffer_format, const Transform2D &p_canvas_transform_inverse, Item *&current_clip, Light *p_lights, PipelineVariants *p_pipeline_variants);
 	void _render_items(RID p_to_render_target, int p_item_count, const Transform2D &p_canvas_transform_inverse, Light *p_lights, RID p_screen_uniform_set);
@@ -86,6 +86,8 @@ void RasterizerRD::begin_frame(double frame_step) {
 
 	canvas->set_time(time);
 	scene->set_time(time, frame_step);
+
+	storage->render_info_begin_frame();
 }
 
 void RasterizerRD::end_frame(bool p_swap_buffers) {
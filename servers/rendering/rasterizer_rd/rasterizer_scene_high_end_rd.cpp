@@ -30,6 +30,7 @@
 
 #include "rasterizer_scene_high_end_rd.h"
 #include "core/project_settings.h"
+#include "servers/rendering/rasterizer_rd/rasterizer_rd.h"
 #include "servers/rendering/rendering_device.h"
 #include "servers/rendering/rendering_server_raster.h"
 
@@ -776,14 +777,23 @@ bool RasterizerSceneHighEndRD::free(RID p_rid) {
 	return false;
 }
 
-void RasterizerSceneHighEndRD::_fill_instances(RenderList::Element **p_elements, int p_element_count, bool p_for_depth, bool p_has_sdfgi, bool p_has_opaque_gi) {
-	uint32_t lightmap_captures_used = 0;
+uint32_t RasterizerSceneHighEndRD::_get_render_list_chunk_count(uint32_t p_count) const {
+	if (p_count < threaded_render_list_minimum_instances || !RasterizerRD::thread_work_pool.is_initialized()) {
+		return 1;
+	}
+	// A few chunks per thread, so uneven chunks (instances with many surfaces or passes) balance out.
+	return MIN(p_count, (uint32_t)RasterizerRD::thread_work_pool.get_thread_count() * 4);
+}
 
-	for (int i = 0; i < p_element_count; i++) {
-		const RenderList::Element *e = p_elements[i];
+void RasterizerSceneHighEndRD::_fill_instances_chunk(uint32_t p_chunk, const FillInstancesData *p_data) {
+	uint32_t from = p_chunk * p_data->chunk_size;
+	uint32_t to = MIN(from + p_data->chunk_size, p_data->element_count);
+	bool uses_lightmap_captures = false;
+
+	for (uint32_t i = from; i < to; i++) {
+		const RenderList::Element *e = p_data->elements[i];
 		InstanceData &id = scene_state.instances[i];
-		RasterizerStorageRD::store_transform(e->instance->transform, id.transform);
-		RasterizerStorageRD::store_transform(Transform(e->instance->transform.basis.inverse().transposed()), id.normal_transform);
+		id.transform_slot = e->instance->transform_slot;
 		id.flags = 0;
 		id.mask = e->instance->layer_mask;
 		id.instance_uniforms_ofs = e->instance->instance_allocated_shader_parameters_offset >= 0 ? e->instance->instance_allocated_shader_parameters_offset : 0;
@@ -813,7 +823,7 @@ void RasterizerSceneHighEndRD::_fill_instances(RenderList::Element **p_elements,
 			}
 		}
 
-		if (p_for_depth) {
+		if (p_data->for_depth) {
 			id.gi_offset = 0xFFFFFFFF;
 			continue;
 		}
@@ -836,22 +846,11 @@ void RasterizerSceneHighEndRD::_fill_instances(RenderList::Element **p_elements,
 				id.gi_offset = 0xFFFFFFFF;
 			}
 		} else if (!e->instance->lightmap_sh.empty()) {
-			if (lightmap_captures_used < scene_state.max_lightmap_captures) {
-				const Color *src_capture = e->instance->lightmap_sh.ptr();
-				LightmapCaptureData &lcd = scene_state.lightmap_captures[lightmap_captures_used];
-				for (int j = 0; j < 9; j++) {
-					lcd.sh[j * 4 + 0] = src_capture[j].r;
-					lcd.sh[j * 4 + 1] = src_capture[j].g;
-					lcd.sh[j * 4 + 2] = src_capture[j].b;
-					lcd.sh[j * 4 + 3] = src_capture[j].a;
-				}
-				id.flags |= INSTANCE_DATA_FLAG_USE_LIGHTMAP_CAPTURE;
-				id.gi_offset = lightmap_captures_used;
-				lightmap_captures_used++;
-			}
-
+			// Capture slots are handed out in element order once all chunks are done.
+			id.gi_offset = 0xFFFFFFFF;
+			uses_lightmap_captures = true;
 		} else {
-			if (p_has_opaque_gi) {
+			if (p_data->has_opaque_gi) {
 				id.flags |= INSTANCE_DATA_FLAG_USE_GI_BUFFERS;
 			}
 
@@ -878,7 +877,7 @@ void RasterizerSceneHighEndRD::_fill_instances(RenderList::Element **p_elements,
 					id.gi_offset |= 0xFFFF0000;
 				}
 			} else {
-				if (p_has_sdfgi && (e->instance->baked_light || e->instance->dynamic_gi)) {
+				if (p_data->has_sdfgi && (e->instance->baked_light || e->instance->dynamic_gi)) {
 					id.flags |= INSTANCE_DATA_FLAG_USE_SDFGI;
 				}
 				id.gi_offset = 0xFFFFFFFF;
@@ -886,10 +885,96 @@ void RasterizerSceneHighEndRD::_fill_instances(RenderList::Element **p_elements,
 		}
 	}
 
+	p_data->chunk_uses_lightmap_captures[p_chunk] = uses_lightmap_captures;
+}
+
+void RasterizerSceneHighEndRD::_fill_instances(RenderList::Element **p_elements, int p_element_count, bool p_for_depth, bool p_has_sdfgi, bool p_has_opaque_gi) {
+	if (p_element_count == 0) {
+		return;
+	}
+
+	uint32_t chunk_count = _get_render_list_chunk_count(p_element_count);
+	fill_instances_chunk_captures.resize(chunk_count);
+
+	FillInstancesData data;
+	data.elements = p_elements;
+	data.element_count = p_element_count;
+	data.chunk_size = (p_element_count + chunk_count - 1) / chunk_count;
+	data.for_depth = p_for_depth;
+	data.has_sdfgi = p_has_sdfgi;
+	data.has_opaque_gi = p_has_opaque_gi;
+	data.chunk_uses_lightmap_captures = fill_instances_chunk_captures.ptr();
+
+	RasterizerRD::thread_work_pool.do_work(chunk_count, this, &RasterizerSceneHighEndRD::_fill_instances_chunk, (const FillInstancesData *)&data);
+
+	uint32_t lightmap_captures_used = 0;
+
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		if (!fill_instances_chunk_captures[i]) {
+			continue;
+		}
+		uint32_t from = i * data.chunk_size;
+		uint32_t to = MIN(from + data.chunk_size, data.element_count);
+		for (uint32_t j = from; j < to && lightmap_captures_used < scene_state.max_lightmap_captures; j++) {
+			const RenderList::Element *e = p_elements[j];
+			if (e->instance->lightmap || e->instance->lightmap_sh.empty()) {
+				continue;
+			}
+			const Color *src_capture = e->instance->lightmap_sh.ptr();
+			LightmapCaptureData &lcd = scene_state.lightmap_captures[lightmap_captures_used];
+			for (int k = 0; k < 9; k++) {
+				lcd.sh[k * 4 + 0] = src_capture[k].r;
+				lcd.sh[k * 4 + 1] = src_capture[k].g;
+				lcd.sh[k * 4 + 2] = src_capture[k].b;
+				lcd.sh[k * 4 + 3] = src_capture[k].a;
+			}
+			InstanceData &id = scene_state.instances[j];
+			id.flags |= INSTANCE_DATA_FLAG_USE_LIGHTMAP_CAPTURE;
+			id.gi_offset = lightmap_captures_used;
+			lightmap_captures_used++;
+		}
+	}
+
 	RD::get_singleton()->buffer_update(scene_state.instance_buffer, 0, sizeof(InstanceData) * p_element_count, scene_state.instances, true);
 	if (lightmap_captures_used) {
 		RD::get_singleton()->buffer_update(scene_state.lightmap_capture_buffer, 0, sizeof(LightmapCaptureData) * lightmap_captures_used, scene_state.lightmap_captures, true);
 	}
+
+	storage->render_info_add_instance_data_upload(0, sizeof(InstanceData) * p_element_count + sizeof(LightmapCaptureData) * lightmap_captures_used);
+}
+
+void RasterizerSceneHighEndRD::instance_free_render_data(InstanceBase *p_instance) {
+	if (p_instance->transform_slot == InstanceTransformSlotsRD::INVALID_SLOT) {
+		return;
+	}
+	instance_transforms.slots.free(p_instance->transform_slot);
+	p_instance->transform_slot = InstanceTransformSlotsRD::INVALID_SLOT;
+}
+
+void RasterizerSceneHighEndRD::_update_instance_transforms() {
+	InstanceTransformSlotsRD &slots = instance_transforms.slots;
+
+	if (slots.is_resized()) {
+		// Grown past the buffer, recreate it, everything is uploaded below.
+		RD::get_singleton()->free(instance_transforms.buffer);
+		instance_transforms.buffer = RD::get_singleton()->storage_buffer_create(sizeof(InstanceTransformData) * slots.get_capacity());
+		_update_render_base_uniform_set(); //was using the old buffer
+	}
+
+	slots.get_uploads(instance_transforms.uploads);
+	if (instance_transforms.uploads.size() == 0) {
+		return;
+	}
+
+	uint64_t bytes_uploaded = 0;
+	for (uint32_t i = 0; i < instance_transforms.uploads.size(); i++) {
+		const InstanceTransformSlotsRD::Upload &upload = instance_transforms.uploads[i];
+		uint32_t size = sizeof(InstanceTransformData) * (upload.to - upload.from);
+		RD::get_singleton()->buffer_update(instance_transforms.buffer, sizeof(InstanceTransformData) * upload.from, size, &slots.get_transforms()[upload.from], true);
+		bytes_uploaded += size;
+	}
+
+	storage->render_info_add_instance_data_upload(bytes_uploaded / sizeof(InstanceTransformData), bytes_uploaded);
 }
 
 /// RENDERING ///
@@ -947,10 +1032,13 @@ void RasterizerSceneHighEndRD::_render_list(RenderingDevice::DrawListID p_draw_l
 
 		//find primitive and vertex format
 		RS::PrimitiveType primitive;
+		uint32_t surface_format = 0;
+		AABB surface_aabb;
 
 		switch (e->instance->base_type) {
 			case RS::INSTANCE_MESH: {
 				primitive = storage->mesh_surface_get_primitive(e->instance->base, e->surface_index);
+				surface_format = storage->mesh_surface_get_format_and_aabb(e->instance->base, e->surface_index, surface_aabb);
 				if (e->instance->skeleton.is_valid()) {
 					xforms_uniform_set = storage->skeleton_get_3d_uniform_set(e->instance->skeleton, default_shader_rd, TRANSFORMS_UNIFORM_SET);
 				}
@@ -959,6 +1047,7 @@ void RasterizerSceneHighEndRD::_render_list(RenderingDevice::DrawListID p_draw_l
 				RID mesh = storage->multimesh_get_mesh(e->instance->base);
 				ERR_CONTINUE(!mesh.is_valid()); //should be a bug
 				primitive = storage->mesh_surface_get_primitive(mesh, e->surface_index);
+				surface_format = storage->mesh_surface_get_format_and_aabb(mesh, e->surface_index, surface_aabb);
 
 				xforms_uniform_set = storage->multimesh_get_3d_uniform_set(e->instance->base, default_shader_rd, TRANSFORMS_UNIFORM_SET);
 
@@ -1025,12 +1114,12 @@ void RasterizerSceneHighEndRD::_render_list(RenderingDevice::DrawListID p_draw_l
 
 		switch (e->instance->base_type) {
 			case RS::INSTANCE_MESH: {
-				storage->mesh_surface_get_arrays_and_format(e->instance->base, e->surface_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
+				storage->mesh_surface_get_arrays_and_format(e->instance->base, e->surface_index, e->lod_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
 			} break;
 			case RS::INSTANCE_MULTIMESH: {
 				RID mesh = storage->multimesh_get_mesh(e->instance->base);
 				ERR_CONTINUE(!mesh.is_valid()); //should be a bug
-				storage->mesh_surface_get_arrays_and_format(mesh, e->surface_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
+				storage->mesh_surface_get_arrays_and_format(mesh, e->surface_index, e->lod_index, pipeline->get_vertex_input_mask(), vertex_array_rd, index_array_rd, vertex_format);
 			} break;
 			case RS::INSTANCE_IMMEDIATE: {
 				ERR_CONTINUE(true); //should be a bug
@@ -1079,6 +1168,26 @@ void RasterizerSceneHighEndRD::_render_list(RenderingDevice::DrawListID p_draw_l
 		}
 
 		push_constant.index = i;
+		push_constant.flags = 0;
+		if (surface_format & RS::ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION) {
+			if (surface_format & RS::ARRAY_COMPRESS_NORMAL) {
+				push_constant.flags |= PUSH_CONSTANT_FLAG_OCTAHEDRAL_NORMAL;
+			}
+			if (surface_format & RS::ARRAY_COMPRESS_TANGENT) {
+				push_constant.flags |= PUSH_CONSTANT_FLAG_OCTAHEDRAL_TANGENT;
+			}
+		}
+		if (surface_format & RS::ARRAY_COMPRESS_VERTEX) {
+			for (int j = 0; j < 3; j++) {
+				push_constant.vertex_offset[j] = surface_aabb.position[j];
+				push_constant.vertex_scale[j] = surface_aabb.size[j];
+			}
+		} else {
+			for (int j = 0; j < 3; j++) {
+				push_constant.vertex_offset[j] = 0.0;
+				push_constant.vertex_scale[j] = 1.0;
+			}
+		}
 		RD::get_singleton()->draw_list_set_push_constant(draw_list, &push_constant, sizeof(PushConstant));
 
 		switch (e->instance->base_type) {
@@ -1332,7 +1441,7 @@ void RasterizerSceneHighEndRD::_setup_environment(RID p_environment, RID p_rende
 	RD::get_singleton()->buffer_update(scene_state.uniform_buffer, 0, sizeof(SceneState::UBO), &scene_state.ubo, true);
 }
 
-void RasterizerSceneHighEndRD::_add_geometry(InstanceBase *p_instance, uint32_t p_surface, RID p_material, PassMode p_pass_mode, uint32_t p_geometry_index, bool p_using_sdfgi) {
+void RasterizerSceneHighEndRD::_add_geometry(RenderListChunk &r_chunk, InstanceBase *p_instance, uint32_t p_surface, RID p_mesh, RID p_material, PassMode p_pass_mode, bool p_using_sdfgi) {
 	RID m_src;
 
 	m_src = p_instance->material_override.is_valid() ? p_instance->material_override : p_material;
@@ -1361,37 +1470,37 @@ void RasterizerSceneHighEndRD::_add_geometry(InstanceBase *p_instance, uint32_t
 
 	ERR_FAIL_COND(!material);
 
-	_add_geometry_with_material(p_instance, p_surface, material, m_src, p_pass_mode, p_geometry_index, p_using_sdfgi);
+	_add_geometry_with_material(r_chunk, p_instance, p_surface, p_mesh, material, m_src, p_pass_mode, p_using_sdfgi);
 
 	while (material->next_pass.is_valid()) {
 		material = (MaterialData *)storage->material_get_data(material->next_pass, RasterizerStorageRD::SHADER_TYPE_3D);
 		if (!material || !material->shader_data->valid) {
 			break;
 		}
-		_add_geometry_with_material(p_instance, p_surface, material, material->next_pass, p_pass_mode, p_geometry_index, p_using_sdfgi);
+		_add_geometry_with_material(r_chunk, p_instance, p_surface, p_mesh, material, material->next_pass, p_pass_mode, p_using_sdfgi);
 	}
 }
 
-void RasterizerSceneHighEndRD::_add_geometry_with_material(InstanceBase *p_instance, uint32_t p_surface, MaterialData *p_material, RID p_material_rid, PassMode p_pass_mode, uint32_t p_geometry_index, bool p_using_sdfgi) {
+void RasterizerSceneHighEndRD::_add_geometry_with_material(RenderListChunk &r_chunk, InstanceBase *p_instance, uint32_t p_surface, RID p_mesh, MaterialData *p_material, RID p_material_rid, PassMode p_pass_mode, bool p_using_sdfgi) {
 	bool has_read_screen_alpha = p_material->shader_data->uses_screen_texture || p_material->shader_data->uses_depth_texture || p_material->shader_data->uses_normal_texture;
 	bool has_base_alpha = (p_material->shader_data->uses_alpha || has_read_screen_alpha);
 	bool has_blend_alpha = p_material->shader_data->uses_blend_alpha;
 	bool has_alpha = has_base_alpha || has_blend_alpha;
 
 	if (p_material->shader_data->uses_sss) {
-		scene_state.used_sss = true;
+		r_chunk.used_sss = true;
 	}
 
 	if (p_material->shader_data->uses_screen_texture) {
-		scene_state.used_screen_texture = true;
+		r_chunk.used_screen_texture = true;
 	}
 
 	if (p_material->shader_data->uses_depth_texture) {
-		scene_state.used_depth_texture = true;
+		r_chunk.used_depth_texture = true;
 	}
 
 	if (p_material->shader_data->uses_normal_texture) {
-		scene_state.used_normal_texture = true;
+		r_chunk.used_normal_texture = true;
 	}
 
 	if (p_pass_mode != PASS_MODE_COLOR && p_pass_mode != PASS_MODE_COLOR_SPECULAR) {
@@ -1414,57 +1523,54 @@ void RasterizerSceneHighEndRD::_add_geometry_with_material(InstanceBase *p_insta
 
 	has_alpha = has_alpha || p_material->shader_data->depth_test == ShaderData::DEPTH_TEST_DISABLED;
 
-	RenderList::Element *e = has_alpha ? render_list.add_alpha_element() : render_list.add_element();
-
-	if (!e) {
-		return;
+	if (p_material->shader_data->uses_time) {
+		r_chunk.uses_time = true;
 	}
 
+	r_chunk.surfaces.push_back(RenderListChunk::Surface());
+	RenderListChunk::Surface &surface = r_chunk.surfaces[r_chunk.surfaces.size() - 1];
+	surface.material_rid = p_material_rid;
+	surface.mesh = p_mesh;
+	surface.alpha = has_alpha;
+
+	// Material and geometry indices are shared between chunks, they are assigned when merging.
+	RenderList::Element *e = &surface.element;
 	e->instance = p_instance;
 	e->material = p_material;
 	e->surface_index = p_surface;
+	e->lod_index = p_instance->lod_error_limit > 0.0 ? storage->mesh_surface_get_lod(p_mesh, p_surface, p_instance->lod_error_limit) : 0;
 	e->sort_key = 0;
-
-	if (e->material->last_pass != render_pass) {
-		if (!RD::get_singleton()->uniform_set_is_valid(e->material->uniform_set)) {
-			//uniform set no longer valid, probably a texture changed
-			storage->material_force_update_textures(p_material_rid, RasterizerStorageRD::SHADER_TYPE_3D);
-		}
-		e->material->last_pass = render_pass;
-		e->material->index = scene_state.current_material_index++;
-		if (e->material->shader_data->last_pass != render_pass) {
-			e->material->shader_data->last_pass = scene_state.current_material_index++;
-			e->material->shader_data->index = scene_state.current_shader_index++;
-		}
-	}
-	e->geometry_index = p_geometry_index;
-	e->material_index = e->material->index;
 	e->uses_instancing = e->instance->base_type == RS::INSTANCE_MULTIMESH;
 	e->uses_lightmap = e->instance->lightmap != nullptr || !e->instance->lightmap_sh.empty();
 	e->uses_forward_gi = has_alpha && (e->instance->gi_probe_instances.size() || p_using_sdfgi);
-	e->shader_index = e->shader_index;
 	e->depth_layer = e->instance->depth_layer;
 	e->priority = p_material->priority;
-
-	if (p_material->shader_data->uses_time) {
-		RenderingServerRaster::redraw_request();
-	}
 }
 
-void RasterizerSceneHighEndRD::_fill_render_list(InstanceBase **p_cull_result, int p_cull_count, PassMode p_pass_mode, bool p_using_sdfgi) {
-	scene_state.current_shader_index = 0;
-	scene_state.current_material_index = 0;
-	scene_state.used_sss = false;
-	scene_state.used_screen_texture = false;
-	scene_state.used_normal_texture = false;
-	scene_state.used_depth_texture = false;
+void RasterizerSceneHighEndRD::_fill_render_list_chunk(uint32_t p_chunk, const RenderListBuild *p_build) {
+	RenderListChunk &chunk = render_list_chunks[p_chunk];
+	chunk.surfaces.clear();
+	chunk.unallocated_instances.clear();
+	chunk.dirty_transform_slots.clear();
+	chunk.used_sss = false;
+	chunk.used_screen_texture = false;
+	chunk.used_normal_texture = false;
+	chunk.used_depth_texture = false;
+	chunk.uses_time = false;
 
-	uint32_t geometry_index = 0;
+	uint32_t from = p_chunk * p_build->chunk_size;
+	uint32_t to = MIN(from + p_build->chunk_size, p_build->cull_count);
 
-	//fill list
+	for (uint32_t i = from; i < to; i++) {
+		InstanceBase *inst = p_build->cull_result[i];
 
-	for (int i = 0; i < p_cull_count; i++) {
-		InstanceBase *inst = p_cull_result[i];
+		// Each instance belongs to a single chunk, so its slot can be written here.
+		if (inst->transform_slot == InstanceTransformSlotsRD::INVALID_SLOT) {
+			chunk.unallocated_instances.push_back(inst);
+		} else if (instance_transforms.slots.get_version(inst->transform_slot) != inst->transform_version) {
+			_store_instance_transform(inst);
+			chunk.dirty_transform_slots.push_back(inst->transform_slot);
+		}
 
 		//add geometry for drawing
 		switch (inst->base_type) {
@@ -1481,13 +1587,9 @@ void RasterizerSceneHighEndRD::_fill_render_list(InstanceBase **p_cull_result, i
 
 				for (uint32_t j = 0; j < surface_count; j++) {
 					RID material = inst_materials[j].is_valid() ? inst_materials[j] : materials[j];
-
-					uint32_t surface_index = storage->mesh_surface_get_render_pass_index(inst->base, j, render_pass, &geometry_index);
-					_add_geometry(inst, j, material, p_pass_mode, surface_index, p_using_sdfgi);
+					_add_geometry(chunk, inst, j, inst->base, material, p_build->pass_mode, p_build->using_sdfgi);
 				}
 
-				//mesh->last_pass=frame;
-
 			} break;
 
 			case RS::INSTANCE_MULTIMESH: {
@@ -1510,8 +1612,7 @@ void RasterizerSceneHighEndRD::_fill_render_list(InstanceBase **p_cull_result, i
 				}
 
 				for (uint32_t j = 0; j < surface_count; j++) {
-					uint32_t surface_index = storage->mesh_surface_get_multimesh_render_pass_index(mesh, j, render_pass, &geometry_index);
-					_add_geometry(inst, j, materials[j], p_pass_mode, surface_index, p_using_sdfgi);
+					_add_geometry(chunk, inst, j, mesh, materials[j], p_build->pass_mode, p_build->using_sdfgi);
 				}
 
 			} break;
@@ -1555,6 +1656,97 @@ void RasterizerSceneHighEndRD::_fill_render_list(InstanceBase **p_cull_result, i
 	}
 }
 
+void RasterizerSceneHighEndRD::_fill_render_list(InstanceBase **p_cull_result, int p_cull_count, PassMode p_pass_mode, bool p_using_sdfgi) {
+	scene_state.current_shader_index = 0;
+	scene_state.current_material_index = 0;
+	scene_state.used_sss = false;
+	scene_state.used_screen_texture = false;
+	scene_state.used_normal_texture = false;
+	scene_state.used_depth_texture = false;
+
+	if (p_cull_count == 0) {
+		return;
+	}
+
+	uint32_t chunk_count = _get_render_list_chunk_count(p_cull_count);
+	if (render_list_chunks.size() < chunk_count) {
+		render_list_chunks.resize(chunk_count);
+	}
+
+	RenderListBuild build;
+	build.cull_result = p_cull_result;
+	build.cull_count = p_cull_count;
+	build.chunk_size = (p_cull_count + chunk_count - 1) / chunk_count;
+	build.pass_mode = p_pass_mode;
+	build.using_sdfgi = p_using_sdfgi;
+
+	RasterizerRD::thread_work_pool.do_work(chunk_count, this, &RasterizerSceneHighEndRD::_fill_render_list_chunk, (const RenderListBuild *)&build);
+
+	//merge chunks in order
+
+	uint32_t geometry_index = 0;
+	bool uses_time = false;
+
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		RenderListChunk &chunk = render_list_chunks[i];
+
+		scene_state.used_sss = scene_state.used_sss || chunk.used_sss;
+		scene_state.used_screen_texture = scene_state.used_screen_texture || chunk.used_screen_texture;
+		scene_state.used_normal_texture = scene_state.used_normal_texture || chunk.used_normal_texture;
+		scene_state.used_depth_texture = scene_state.used_depth_texture || chunk.used_depth_texture;
+		uses_time = uses_time || chunk.uses_time;
+
+		for (uint32_t j = 0; j < chunk.unallocated_instances.size(); j++) {
+			InstanceBase *inst = chunk.unallocated_instances[j];
+			inst->transform_slot = instance_transforms.slots.allocate();
+			_store_instance_transform(inst);
+			instance_transforms.slots.mark_dirty(inst->transform_slot);
+		}
+
+		for (uint32_t j = 0; j < chunk.dirty_transform_slots.size(); j++) {
+			instance_transforms.slots.mark_dirty(chunk.dirty_transform_slots[j]);
+		}
+
+		for (uint32_t j = 0; j < chunk.surfaces.size(); j++) {
+			const RenderListChunk::Surface &surface = chunk.surfaces[j];
+
+			RenderList::Element *e = surface.alpha ? render_list.add_alpha_element() : render_list.add_element();
+
+			if (!e) {
+				continue;
+			}
+
+			*e = surface.element;
+
+			if (e->material->last_pass != render_pass) {
+				if (!RD::get_singleton()->uniform_set_is_valid(e->material->uniform_set)) {
+					//uniform set no longer valid, probably a texture changed
+					storage->material_force_update_textures(surface.material_rid, RasterizerStorageRD::SHADER_TYPE_3D);
+				}
+				e->material->last_pass = render_pass;
+				e->material->index = scene_state.current_material_index++;
+				if (e->material->shader_data->last_pass != render_pass) {
+					e->material->shader_data->last_pass = scene_state.current_material_index++;
+					e->material->shader_data->index = scene_state.current_shader_index++;
+				}
+			}
+
+			if (e->uses_instancing) {
+				e->geometry_index = storage->mesh_surface_get_multimesh_render_pass_index(surface.mesh, e->surface_index, render_pass, &geometry_index);
+			} else {
+				e->geometry_index = storage->mesh_surface_get_render_pass_index(surface.mesh, e->surface_index, render_pass, &geometry_index);
+			}
+			e->material_index = e->material->index;
+		}
+	}
+
+	if (uses_time) {
+		RenderingServerRaster::redraw_request();
+	}
+
+	_update_instance_transforms();
+}
+
 void RasterizerSceneHighEndRD::_setup_lightmaps(InstanceBase **p_lightmap_cull_result, int p_lightmap_cull_count, const Transform &p_cam_transform) {
 	uint32_t lightmaps_used = 0;
 	for (int i = 0; i < p_lightmap_cull_count; i++) {
@@ -2255,6 +2447,13 @@ void RasterizerSceneHighEndRD::_update_render_base_uniform_set() {
 			u.ids.push_back(scene_state.instance_buffer);
 			uniforms.push_back(u);
 		}
+		{
+			RD::Uniform u;
+			u.binding = 8;
+			u.type = RD::UNIFORM_TYPE_STORAGE_BUFFER;
+			u.ids.push_back(instance_transforms.buffer);
+			uniforms.push_back(u);
+		}
 
 		{
 			RD::Uniform u;
@@ -2777,6 +2976,7 @@ RasterizerSceneHighEndRD::RasterizerSceneHighEndRD(RasterizerStorageRD *p_storag
 
 	//render list
 	render_list.max_elements = GLOBAL_DEF_RST("rendering/limits/rendering/max_renderable_elements", (int)128000);
+	threaded_render_list_minimum_instances = GLOBAL_DEF("rendering/limits/rendering/threaded_render_list_minimum_instances", 1024);
 	render_list.init();
 	render_pass = 0;
 
@@ -2784,6 +2984,9 @@ RasterizerSceneHighEndRD::RasterizerSceneHighEndRD(RasterizerStorageRD *p_storag
 		scene_state.max_instances = render_list.max_elements;
 		scene_state.instances = memnew_arr(InstanceData, scene_state.max_instances);
 		scene_state.instance_buffer = RD::get_singleton()->storage_buffer_create(sizeof(InstanceData) * scene_state.max_instances);
+
+		instance_transforms.slots.init();
+		instance_transforms.buffer = RD::get_singleton()->storage_buffer_create(sizeof(InstanceTransformData) * instance_transforms.slots.get_capacity());
 	}
 
 	scene_state.uniform_buffer = RD::get_singleton()->uniform_buffer_create(sizeof(SceneState::UBO));
@@ -2913,6 +3116,7 @@ RasterizerSceneHighEndRD::~RasterizerSceneHighEndRD() {
 	{
 		RD::get_singleton()->free(scene_state.uniform_buffer);
 		RD::get_singleton()->free(scene_state.instance_buffer);
+		RD::get_singleton()->free(instance_transforms.buffer);
 		RD::get_singleton()->free(scene_state.lightmap_buffer);
 		RD::get_singleton()->free(scene_state.lightmap_capture_buffer);
 		memdelete_arr(scene_state.instances);
@@ -31,6 +31,8 @@
 #ifndef RASTERIZER_SCENE_HIGHEND_RD_H
 #define RASTERIZER_SCENE_HIGHEND_RD_H
 
+#include "core/radix_sort.h"
+#include "servers/rendering/rasterizer_rd/instance_transform_slots_rd.h"
 #include "servers/rendering/rasterizer_rd/rasterizer_scene_rd.h"
 #include "servers/rendering/rasterizer_rd/rasterizer_storage_rd.h"
 #include "servers/rendering/rasterizer_rd/render_pipeline_vertex_format_cache_rd.h"
@@ -193,10 +195,17 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 
 	/* Push Constant */
 
+	enum {
+		PUSH_CONSTANT_FLAG_OCTAHEDRAL_NORMAL = 1 << 0,
+		PUSH_CONSTANT_FLAG_OCTAHEDRAL_TANGENT = 1 << 1,
+	};
+
 	struct PushConstant {
 		uint32_t index;
-		uint32_t pad;
+		uint32_t flags;
 		float bake_uv2_offset[2];
+		float vertex_offset[4]; // Scale and offset undo the quantization of compressed vertices.
+		float vertex_scale[4];
 	};
 
 	/* Framebuffer */
@@ -288,15 +297,36 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 	};
 
 	struct InstanceData {
-		float transform[16];
-		float normal_transform[16];
 		uint32_t flags;
 		uint32_t instance_uniforms_ofs; //instance_offset in instancing/skeleton buffer
 		uint32_t gi_offset; //GI information when using lightmapping (VCT or lightmap)
 		uint32_t mask;
 		float lightmap_uv_scale[4];
+		uint32_t transform_slot; //index in InstanceTransforms::buffer
+		uint32_t pad[3];
 	};
 
+	typedef InstanceTransformSlotsRD::Transform InstanceTransformData;
+
+	/* Persistent Instance Transforms */
+
+	// Transforms are kept in a buffer indexed by a slot the instance owns for its whole life,
+	// so only those that changed since they were last drawn need to be uploaded.
+	struct InstanceTransforms {
+		RID buffer;
+		InstanceTransformSlotsRD slots;
+		LocalVector<InstanceTransformSlotsRD::Upload> uploads;
+	} instance_transforms;
+
+	_FORCE_INLINE_ void _store_instance_transform(InstanceBase *p_instance) {
+		InstanceTransformData &itd = instance_transforms.slots.get_transform(p_instance->transform_slot);
+		RasterizerStorageRD::store_transform(p_instance->transform, itd.transform);
+		RasterizerStorageRD::store_transform(Transform(p_instance->transform.basis.inverse().transposed()), itd.normal_transform);
+		instance_transforms.slots.set_version(p_instance->transform_slot, p_instance->transform_version);
+	}
+
+	void _update_instance_transforms();
+
 	struct SceneState {
 		struct UBO {
 			float projection_matrix[16];
@@ -425,6 +455,7 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 				uint64_t sort_key;
 			};
 			uint32_t surface_index;
+			uint32_t lod_index;
 		};
 
 		Element *base_elements;
@@ -438,20 +469,47 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 			alpha_element_count = 0;
 		}
 
-		//should eventually be replaced by radix
-
 		struct SortByKey {
 			_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
 				return A->sort_key < B->sort_key;
 			}
 		};
 
+		// Keys are copied next to their element so the radix passes don't chase pointers.
+		struct SortItem {
+			uint64_t key;
+			Element *element;
+		};
+
+		struct SortItemKey {
+			_FORCE_INLINE_ uint64_t operator()(const SortItem &A) const {
+				return A.key;
+			}
+		};
+
+		enum {
+			RADIX_SORT_THRESHOLD = 256 // Below this, introsort is faster than the radix passes.
+		};
+
+		SortItem *sort_items; // Twice max_elements, the second half is scratch space.
+
 		void sort_by_key(bool p_alpha) {
-			SortArray<Element *, SortByKey> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
-			} else {
-				sorter.sort(elements, element_count);
+			Element **array = p_alpha ? &elements[max_elements - alpha_element_count] : elements;
+			int count = p_alpha ? alpha_element_count : element_count;
+			if (count < RADIX_SORT_THRESHOLD) {
+				SortArray<Element *, SortByKey> sorter;
+				sorter.sort(array, count);
+				return;
+			}
+
+			for (int i = 0; i < count; i++) {
+				sort_items[i].key = array[i]->sort_key;
+				sort_items[i].element = array[i];
+			}
+			RadixSort<SortItem, SortItemKey> sorter;
+			sorter.sort(sort_items, &sort_items[max_elements], count);
+			for (int i = 0; i < count; i++) {
+				array[i] = sort_items[i].element;
 			}
 		}
 
@@ -515,6 +573,7 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 			element_count = 0;
 			alpha_element_count = 0;
 			elements = memnew_arr(Element *, max_elements);
+			sort_items = memnew_arr(SortItem, max_elements * 2);
 			base_elements = memnew_arr(Element, max_elements);
 			for (int i = 0; i < max_elements; i++) {
 				elements[i] = &base_elements[i]; // assign elements
@@ -527,6 +586,7 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 
 		~RenderList() {
 			memdelete_arr(elements);
+			memdelete_arr(sort_items);
 			memdelete_arr(base_elements);
 		}
 	};
@@ -566,10 +626,60 @@ class RasterizerSceneHighEndRD : public RasterizerSceneRD {
 	void _setup_environment(RID p_environment, RID p_render_buffers, const CameraMatrix &p_cam_projection, const Transform &p_cam_transform, RID p_reflection_probe, bool p_no_fog, const Size2 &p_screen_pixel_size, RID p_shadow_atlas, bool p_flip_y, const Color &p_default_bg_color, float p_znear, float p_zfar, bool p_opaque_render_buffers = false, bool p_pancake_shadows = false);
 	void _setup_lightmaps(InstanceBase **p_lightmap_cull_result, int p_lightmap_cull_count, const Transform &p_cam_transform);
 
+	/* Threaded Render List Building */
+
+	// Instances are split in contiguous chunks which gather their surfaces on worker threads.
+	// Anything that mutates shared state (material and geometry indices, stale uniform sets)
+	// is deferred to a serial merge, which walks the chunks in order so the result does not
+	// depend on scheduling.
+	struct RenderListChunk {
+		struct Surface {
+			RenderList::Element element;
+			RID material_rid;
+			RID mesh;
+			bool alpha;
+		};
+
+		LocalVector<Surface> surfaces;
+		LocalVector<InstanceBase *> unallocated_instances; //need a transform slot
+		LocalVector<uint32_t> dirty_transform_slots;
+		bool used_sss;
+		bool used_screen_texture;
+		bool used_normal_texture;
+		bool used_depth_texture;
+		bool uses_time;
+	};
+
+	struct RenderListBuild {
+		InstanceBase **cull_result;
+		uint32_t cull_count;
+		uint32_t chunk_size;
+		PassMode pass_mode;
+		bool using_sdfgi;
+	};
+
+	struct FillInstancesData {
+		RenderList::Element **elements;
+		uint32_t element_count;
+		uint32_t chunk_size;
+		bool for_depth;
+		bool has_sdfgi;
+		bool has_opaque_gi;
+		bool *chunk_uses_lightmap_captures;
+	};
+
+	LocalVector<RenderListChunk> render_list_chunks;
+	LocalVector<bool> fill_instances_chunk_captures;
+	uint32_t threaded_render_list_minimum_instances = 1024;
+
+	uint32_t _get_render_list_chunk_count(uint32_t p_count) const;
+	void _fill_render_list_chunk(uint32_t p_chunk, const RenderListBuild *p_build);
+	void _fill_instances_chunk(uint32_t p_chunk, const FillInstancesData *p_data);
+
 	void _fill_instances(RenderList::Element **p_elements, int p_element_count, bool p_for_depth, bool p_has_sdfgi = false, bool p_has_opaque_gi = false);
 	void _render_list(RenderingDevice::DrawListID p_draw_list, RenderingDevice::FramebufferFormatID p_framebuffer_Format, RenderList::Element **p_elements, int p_element_count, bool p_reverse_cull, PassMode p_pass_mode, bool p_no_gi, RID p_radiance_uniform_set, RID p_render_buffers_uniform_set, bool p_force_wireframe = false, const Vector2 &p_uv_offset = Vector2());
-	_FORCE_INLINE_ void _add_geometry(InstanceBase *p_instance, uint32_t p_surface, RID p_material, PassMode p_pass_mode, uint32_t p_geometry_index, bool p_using_sdfgi = false);
-	_FORCE_INLINE_ void _add_geometry_with_material(InstanceBase *p_instance, uint32_t p_surface, MaterialData *p_material, RID p_material_rid, PassMode p_pass_mode, uint32_t p_geometry_index, bool p_using_sdfgi = false);
+	_FORCE_INLINE_ void _add_geometry(RenderListChunk &r_chunk, InstanceBase *p_instance, uint32_t p_surface, RID p_mesh, RID p_material, PassMode p_pass_mode, bool p_using_sdfgi);
+	_FORCE_INLINE_ void _add_geometry_with_material(RenderListChunk &r_chunk, InstanceBase *p_instance, uint32_t p_surface, RID p_mesh, MaterialData *p_material, RID p_material_rid, PassMode p_pass_mode, bool p_using_sdfgi);
 
 	void _fill_render_list(InstanceBase **p_cull_result, int p_cull_count, PassMode p_pass_mode, bool p_using_sdfgi = false);
 
@@ -586,6 +696,7 @@ public:
 	virtual void set_time(double p_time, double p_step);
 
 	virtual bool free(RID p_rid);
+	virtual void instance_free_render_data(InstanceBase *p_instance);
 
 	RasterizerSceneHighEndRD(RasterizerStorageRD *p_storage);
 	~RasterizerSceneHighEndRD();
@@ -7790,6 +7790,7 @@ TypedArray<Image> RasterizerSceneRD::bake_render_uv2(RID p_base, const Vector<RI
 
 	InstanceBase *cull = &ins;
 	_render_uv2(&cull, 1, fb, Rect2i(0, 0, p_image_size.width, p_image_size.height));
+	instance_free_render_data(&ins);
 
 	TypedArray<Image> ret;
 
@@ -1291,6 +1291,29 @@ void RasterizerStorageRD::material_update_dependency(RID p_material, RasterizerS
 	}
 }
 
+void RasterizerStorageRD::material_get_textures(RID p_material, List<RID> *r_textures) {
+	Material *material = material_owner.getornull(p_material);
+	if (!material) {
+		return;
+	}
+
+	for (Map<StringName, Variant>::Element *E = material->params.front(); E; E = E->next()) {
+		// Texture parameters hold either the RID or the Texture resource.
+		Variant::Type type = E->get().get_type();
+		if (type != Variant::_RID && type != Variant::OBJECT) {
+			continue;
+		}
+		RID texture = E->get();
+		if (texture_owner.owns(texture)) {
+			r_textures->push_back(texture);
+		}
+	}
+
+	if (material->next_pass.is_valid()) {
+		material_get_textures(material->next_pass, r_textures);
+	}
+}
+
 void RasterizerStorageRD::material_set_data_request_function(ShaderType p_shader_type, MaterialDataRequestFunction p_function) {
 	ERR_FAIL_INDEX(p_shader_type, SHADER_TYPE_MAX);
 	material_data_request_func[p_shader_type] = p_function;
@@ -2031,6 +2054,8 @@ void RasterizerStorageRD::mesh_add_surface(RID p_mesh, const RS::SurfaceData &p_
 					case RS::ARRAY_VERTEX: {
 						if (p_surface.format & RS::ARRAY_FLAG_USE_2D_VERTICES) {
 							stride += sizeof(float) * 2;
+						} else if (p_surface.format & RS::ARRAY_COMPRESS_VERTEX) {
+							stride += sizeof(uint16_t) * 4;
 						} else {
 							stride += sizeof(float) * 3;
 						}
@@ -2040,7 +2065,7 @@ void RasterizerStorageRD::mesh_add_surface(RID p_mesh, const RS::SurfaceData &p_
 						if (p_surface.format & RS::ARRAY_COMPRESS_NORMAL) {
 							stride += sizeof(int8_t) * 4;
 						} else {
-							stride += sizeof(float) * 4;
+							stride += sizeof(float) * 3;
 						}
 
 					} break;
@@ -2153,7 +2178,7 @@ void RasterizerStorageRD::mesh_add_surface(RID p_mesh, const RS::SurfaceData &p_
 
 	mesh->instance_dependency.instance_notify_changed(true, true);
 
-	mesh->material_cache.clear();
+	_mesh_update_material_cache(mesh);
 }
 
 int RasterizerStorageRD::mesh_get_blend_shape_count(RID p_mesh) const {
@@ -2187,6 +2212,13 @@ void RasterizerStorageRD::mesh_surface_update_region(RID p_mesh, int p_surface,
 	RD::get_singleton()->buffer_update(mesh->surfaces[p_surface]->vertex_buffer, p_offset, data_size, r);
 }
 
+void RasterizerStorageRD::_mesh_update_material_cache(Mesh *p_mesh) {
+	p_mesh->material_cache.resize(p_mesh->surface_count);
+	for (uint32_t i = 0; i < p_mesh->surface_count; i++) {
+		p_mesh->material_cache.write[i] = p_mesh->surfaces[i]->material;
+	}
+}
+
 void RasterizerStorageRD::mesh_surface_set_material(RID p_mesh, int p_surface, RID p_material) {
 	Mesh *mesh = mesh_owner.getornull(p_mesh);
 	ERR_FAIL_COND(!mesh);
@@ -2194,7 +2226,7 @@ void RasterizerStorageRD::mesh_surface_set_material(RID p_mesh, int p_surface, R
 	mesh->surfaces[p_surface]->material = p_material;
 
 	mesh->instance_dependency.instance_notify_changed(false, true);
-	mesh->material_cache.clear();
+	_mesh_update_material_cache(mesh);
 }
 
 RID RasterizerStorageRD::mesh_surface_get_material(RID p_mesh, int p_surface) const {
@@ -2463,6 +2495,9 @@ void RasterizerStorageRD::_mesh_surface_generate_version_for_input_mask(Mesh::Su
 					if (s->format & RS::ARRAY_FLAG_USE_2D_VERTICES) {
 						vd.format = RD::DATA_FORMAT_R32G32_SFLOAT;
 						stride += sizeof(float) * 2;
+					} else if (s->format & RS::ARRAY_COMPRESS_VERTEX) {
+						vd.format = RD::DATA_FORMAT_R16G16B16A16_UNORM; // Scaled back by the shader.
+						stride += sizeof(uint16_t) * 4;
 					} else {
 						vd.format = RD::DATA_FORMAT_R32G32B32_SFLOAT;
 						stride += sizeof(float) * 3;
@@ -2470,17 +2505,23 @@ void RasterizerStorageRD::_mesh_surface_generate_version_for_input_mask(Mesh::Su
 
 				} break;
 				case RS::ARRAY_NORMAL: {
-					if (s->format & RS::ARRAY_COMPRESS_NORMAL) {
+					if ((s->format & RS::ARRAY_COMPRESS_NORMAL) && (s->format & RS::ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION)) {
+						vd.format = RD::DATA_FORMAT_R16G16_SNORM; // Decoded by the shader.
+						stride += sizeof(int16_t) * 2;
+					} else if (s->format & RS::ARRAY_COMPRESS_NORMAL) {
 						vd.format = RD::DATA_FORMAT_R8G8B8A8_SNORM;
 						stride += sizeof(int8_t) * 4;
 					} else {
-						vd.format = RD::DATA_FORMAT_R32G32B32A32_SFLOAT;
-						stride += sizeof(float) * 4;
+						vd.format = RD::DATA_FORMAT_R32G32B32_SFLOAT;
+						stride += sizeof(float) * 3;
 					}
 
 				} break;
 				case RS::ARRAY_TANGENT: {
-					if (s->format & RS::ARRAY_COMPRESS_TANGENT) {
+					if ((s->format & RS::ARRAY_COMPRESS_TANGENT) && (s->format & RS::ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION)) {
+						vd.format = RD::DATA_FORMAT_R16G16_SNORM;
+						stride += sizeof(int16_t) * 2;
+					} else if (s->format & RS::ARRAY_COMPRESS_TANGENT) {
 						vd.format = RD::DATA_FORMAT_R8G8B8A8_SNORM;
 						stride += sizeof(int8_t) * 4;
 					} else {
@@ -5620,6 +5661,19 @@ void RasterizerStorageRD::update_dirty_resources() {
 	_update_decal_atlas();
 }
 
+int RasterizerStorageRD::get_render_info(RS::RenderInfo p_info) {
+	switch (p_info) {
+		case RS::INFO_INSTANCE_TRANSFORMS_UPLOADED_IN_FRAME:
+			return last_frame_info.instance_transforms_uploaded;
+		case RS::INFO_INSTANCE_DATA_BYTES_UPLOADED_IN_FRAME:
+			return MIN(last_frame_info.instance_data_bytes_uploaded, (uint64_t)INT32_MAX);
+		case RS::INFO_2D_BATCHES_IN_FRAME:
+			return last_frame_info.canvas_batches;
+		default:
+			return 0;
+	}
+}
+
 bool RasterizerStorageRD::has_os_feature(const String &p_feature) const {
 	if (p_feature == "rgtc" && RD::get_singleton()->texture_is_format_supported_for_usage(RD::DATA_FORMAT_BC5_UNORM_BLOCK, RD::TEXTURE_USAGE_SAMPLING_BIT)) {
 		return true;
@@ -32,6 +32,7 @@
 #define RASTERIZER_STORAGE_RD_H
 
 #include "core/rid_owner.h"
+#include "servers/rendering/mesh_lod.h"
 #include "servers/rendering/rasterizer.h"
 #include "servers/rendering/rasterizer_rd/rasterizer_effects_rd.h"
 #include "servers/rendering/rasterizer_rd/shader_compiler_rd.h"
@@ -407,6 +408,7 @@ private:
 	mutable RID_Owner<Mesh> mesh_owner;
 
 	void _mesh_surface_generate_version_for_input_mask(Mesh::Surface *s, uint32_t p_input_mask);
+	void _mesh_update_material_cache(Mesh *p_mesh);
 
 	RID mesh_default_rd_buffers[DEFAULT_RD_BUFFER_MAX];
 
@@ -723,6 +725,18 @@ private:
 	void _global_variable_mark_buffer_dirty(int32_t p_index, int32_t p_elements);
 
 	void _update_global_variables();
+
+	/* RENDER INFO */
+
+	struct FrameInfo {
+		uint32_t instance_transforms_uploaded = 0;
+		uint64_t instance_data_bytes_uploaded = 0;
+		uint32_t canvas_batches = 0;
+	};
+
+	FrameInfo frame_info; //being accumulated by the frame in progress
+	FrameInfo last_frame_info; //what get_render_info() reports
+
 	/* EFFECTS */
 
 	RasterizerEffectsRD effects;
@@ -846,6 +860,7 @@ public:
 	void material_get_instance_shader_parameters(RID p_material, List<InstanceShaderParam> *r_parameters);
 
 	void material_update_dependency(RID p_material, RasterizerScene::InstanceBase *p_instance);
+	void material_get_textures(RID p_material, List<RID> *r_textures);
 	void material_force_update_textures(RID p_material, ShaderType p_shader_type);
 
 	void material_set_data_request_function(ShaderType p_shader_type, MaterialDataRequestFunction p_function);
@@ -894,13 +909,8 @@ public:
 		if (r_surface_count == 0) {
 			return nullptr;
 		}
-		if (mesh->material_cache.empty()) {
-			mesh->material_cache.resize(mesh->surface_count);
-			for (uint32_t i = 0; i < r_surface_count; i++) {
-				mesh->material_cache.write[i] = mesh->surfaces[i]->material;
-			}
-		}
 
+		// Read only, render lists are filled from several threads at once.
 		return mesh->material_cache.ptr();
 	}
 
@@ -912,14 +922,33 @@ public:
 		return mesh->surfaces[p_surface_index]->primitive;
 	}
 
-	_FORCE_INLINE_ void mesh_surface_get_arrays_and_format(RID p_mesh, uint32_t p_surface_index, uint32_t p_input_mask, RID &r_vertex_array_rd, RID &r_index_array_rd, RD::VertexFormatID &r_vertex_format) {
+	// Returns the format flags, plus the box compressed positions are quantized to.
+	_FORCE_INLINE_ uint32_t mesh_surface_get_format_and_aabb(RID p_mesh, uint32_t p_surface_index, AABB &r_aabb) {
+		Mesh *mesh = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!mesh, 0);
+		ERR_FAIL_UNSIGNED_INDEX_V(p_surface_index, mesh->surface_count, 0);
+
+		r_aabb = mesh->surfaces[p_surface_index]->aabb;
+		return mesh->surfaces[p_surface_index]->format;
+	}
+
+	_FORCE_INLINE_ uint32_t mesh_surface_get_lod(RID p_mesh, uint32_t p_surface_index, float p_error_limit) {
+		Mesh *mesh = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!mesh, 0);
+		ERR_FAIL_UNSIGNED_INDEX_V(p_surface_index, mesh->surface_count, 0);
+
+		Mesh::Surface *s = mesh->surfaces[p_surface_index];
+		return MeshLOD::select(s->lods, s->lod_count, p_error_limit);
+	}
+
+	_FORCE_INLINE_ void mesh_surface_get_arrays_and_format(RID p_mesh, uint32_t p_surface_index, uint32_t p_lod, uint32_t p_input_mask, RID &r_vertex_array_rd, RID &r_index_array_rd, RD::VertexFormatID &r_vertex_format) {
 		Mesh *mesh = mesh_owner.getornull(p_mesh);
 		ERR_FAIL_COND(!mesh);
 		ERR_FAIL_UNSIGNED_INDEX(p_surface_index, mesh->surface_count);
 
 		Mesh::Surface *s = mesh->surfaces[p_surface_index];
 
-		r_index_array_rd = s->index_array;
+		r_index_array_rd = (p_lod > 0 && p_lod <= s->lod_count) ? s->lods[p_lod - 1].index_array : s->index_array;
 
 		s->version_lock.lock();
 
@@ -1499,7 +1528,22 @@ public:
 	void render_info_end_capture() {}
 	int get_captured_render_info(RS::RenderInfo p_info) { return 0; }
 
-	int get_render_info(RS::RenderInfo p_info) { return 0; }
+	int get_render_info(RS::RenderInfo p_info);
+
+	void render_info_begin_frame() {
+		last_frame_info = frame_info;
+		frame_info = FrameInfo();
+	}
+
+	_FORCE_INLINE_ void render_info_add_instance_data_upload(uint32_t p_transforms, uint64_t p_bytes) {
+		frame_info.instance_transforms_uploaded += p_transforms;
+		frame_info.instance_data_bytes_uploaded += p_bytes;
+	}
+
+	_FORCE_INLINE_ void render_info_add_2d_batches(uint32_t p_batches) {
+		frame_info.canvas_batches += p_batches;
+	}
+
 	String get_video_adapter_name() const { return String(); }
 	String get_video_adapter_vendor() const { return String(); }
 
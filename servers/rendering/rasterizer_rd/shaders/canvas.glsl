@@ -22,6 +22,7 @@ layout(location = 2) out vec2 vertex_interp;
 #ifdef USE_NINEPATCH
 
 layout(location = 3) out vec2 pixel_size_interp;
+layout(location = 4) flat out uint instance_index; //rect instance of batched ninepatches
 
 #endif
 
@@ -39,6 +40,9 @@ VERTEX_SHADER_GLOBALS
 
 void main() {
 	vec4 instance_custom = vec4(0.0);
+	vec2 world_x = draw_data.world_x;
+	vec2 world_y = draw_data.world_y;
+	vec2 world_ofs = draw_data.world_ofs;
 #ifdef USE_PRIMITIVE
 
 	//weird bug,
@@ -74,14 +78,31 @@ void main() {
 	vec2 vertex_base_arr[4] = vec2[](vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0));
 	vec2 vertex_base = vertex_base_arr[gl_VertexIndex];
 
-	vec2 uv = draw_data.src_rect.xy + abs(draw_data.src_rect.zw) * ((draw_data.flags & FLAGS_TRANSPOSE_RECT) != 0 ? vertex_base.yx : vertex_base.xy);
+	vec4 src_rect = draw_data.src_rect;
+	vec4 dst_rect = draw_data.dst_rect;
 	vec4 color = draw_data.modulation;
-	vec2 vertex = draw_data.dst_rect.xy + abs(draw_data.dst_rect.zw) * mix(vertex_base, vec2(1.0, 1.0) - vertex_base, lessThan(draw_data.src_rect.zw, vec2(0.0, 0.0)));
+
+	if (bool(draw_data.flags & FLAGS_BATCHED_RECTS)) {
+		RectInstance rect = rect_instances.data[draw_data.batch_offset + gl_InstanceIndex];
+		world_x = rect.world_x;
+		world_y = rect.world_y;
+		world_ofs = rect.world_ofs;
+		src_rect = rect.src_rect;
+		dst_rect = rect.dst_rect;
+		color = rect.modulation;
+	}
+
+#ifdef USE_NINEPATCH
+	instance_index = draw_data.batch_offset + gl_InstanceIndex;
+#endif
+
+	vec2 uv = src_rect.xy + abs(src_rect.zw) * ((draw_data.flags & FLAGS_TRANSPOSE_RECT) != 0 ? vertex_base.yx : vertex_base.xy);
+	vec2 vertex = dst_rect.xy + abs(dst_rect.zw) * mix(vertex_base, vec2(1.0, 1.0) - vertex_base, lessThan(src_rect.zw, vec2(0.0, 0.0)));
 	uvec4 bones = uvec4(0, 0, 0, 0);
 
 #endif
 
-	mat4 world_matrix = mat4(vec4(draw_data.world_x, 0.0, 0.0), vec4(draw_data.world_y, 0.0, 0.0), vec4(0.0, 0.0, 1.0, 0.0), vec4(draw_data.world_ofs, 0.0, 1.0));
+	mat4 world_matrix = mat4(vec4(world_x, 0.0, 0.0), vec4(world_y, 0.0, 0.0), vec4(0.0, 0.0, 1.0, 0.0), vec4(world_ofs, 0.0, 1.0));
 
 #if 0
 	if (draw_data.flags & FLAGS_INSTANCING_ENABLED) {
@@ -135,7 +156,7 @@ VERTEX_SHADER_CODE
 	}
 
 #ifdef USE_NINEPATCH
-	pixel_size_interp = abs(draw_data.dst_rect.zw) * vertex_base;
+	pixel_size_interp = abs(dst_rect.zw) * vertex_base;
 #endif
 
 #if !defined(SKIP_TRANSFORM_USED)
@@ -220,6 +241,7 @@ layout(location = 2) in vec2 vertex_interp;
 #ifdef USE_NINEPATCH
 
 layout(location = 3) in vec2 pixel_size_interp;
+layout(location = 4) flat in uint instance_index;
 
 #endif
 
@@ -311,16 +333,27 @@ void main() {
 
 #ifdef USE_NINEPATCH
 
+	vec4 src_rect = draw_data.src_rect;
+	vec4 dst_rect = draw_data.dst_rect;
+	vec4 ninepatch_margins = draw_data.ninepatch_margins;
+
+	if (bool(draw_data.flags & FLAGS_BATCHED_RECTS)) {
+		RectInstance rect = rect_instances.data[instance_index];
+		src_rect = rect.src_rect;
+		dst_rect = rect.dst_rect;
+		ninepatch_margins = rect.ninepatch_margins;
+	}
+
 	int draw_center = 2;
 	uv = vec2(
-			map_ninepatch_axis(pixel_size_interp.x, abs(draw_data.dst_rect.z), draw_data.color_texture_pixel_size.x, draw_data.ninepatch_margins.x, draw_data.ninepatch_margins.z, int(draw_data.flags >> FLAGS_NINEPATCH_H_MODE_SHIFT) & 0x3, draw_center),
-			map_ninepatch_axis(pixel_size_interp.y, abs(draw_data.dst_rect.w), draw_data.color_texture_pixel_size.y, draw_data.ninepatch_margins.y, draw_data.ninepatch_margins.w, int(draw_data.flags >> FLAGS_NINEPATCH_V_MODE_SHIFT) & 0x3, draw_center));
+			map_ninepatch_axis(pixel_size_interp.x, abs(dst_rect.z), draw_data.color_texture_pixel_size.x, ninepatch_margins.x, ninepatch_margins.z, int(draw_data.flags >> FLAGS_NINEPATCH_H_MODE_SHIFT) & 0x3, draw_center),
+			map_ninepatch_axis(pixel_size_interp.y, abs(dst_rect.w), draw_data.color_texture_pixel_size.y, ninepatch_margins.y, ninepatch_margins.w, int(draw_data.flags >> FLAGS_NINEPATCH_V_MODE_SHIFT) & 0x3, draw_center));
 
 	if (draw_center == 0) {
 		color.a = 0.0;
 	}
 
-	uv = uv * draw_data.src_rect.zw + draw_data.src_rect.xy; //apply region if needed
+	uv = uv * src_rect.zw + src_rect.xy; //apply region if needed
 
 #endif
 	if (bool(draw_data.flags & FLAGS_CLIP_RECT_UV)) {
@@ -19,6 +19,8 @@
 
 #define FLAGS_LIGHT_COUNT_SHIFT 20
 
+#define FLAGS_BATCHED_RECTS (1 << 24)
+
 #define FLAGS_DEFAULT_NORMAL_MAP_USED (1 << 26)
 #define FLAGS_DEFAULT_SPECULAR_MAP_USED (1 << 27)
 
@@ -45,7 +47,8 @@ layout(push_constant, binding = 0, std430) uniform DrawData {
 	vec4 ninepatch_margins;
 	vec4 dst_rect; //for built-in rect and UV
 	vec4 src_rect;
-	vec2 pad;
+	uint batch_offset; //first rect instance when FLAGS_BATCHED_RECTS is set
+	uint pad;
 
 #endif
 	vec2 color_texture_pixel_size;
@@ -137,6 +140,23 @@ layout(set = 2, binding = 7, std430) restrict readonly buffer GlobalVariableData
 }
 global_variables;
 
+struct RectInstance {
+	vec2 world_x;
+	vec2 world_y;
+	vec2 world_ofs;
+	uint pad0;
+	uint pad1;
+	vec4 modulation;
+	vec4 dst_rect;
+	vec4 src_rect;
+	vec4 ninepatch_margins;
+};
+
+layout(set = 2, binding = 8, std430) restrict readonly buffer RectInstanceData {
+	RectInstance data[];
+}
+rect_instances;
+
 /* SET3: Render Target Data */
 
 #ifdef SCREEN_TEXTURE_USED
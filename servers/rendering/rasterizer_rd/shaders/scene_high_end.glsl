@@ -64,6 +64,13 @@ invariant gl_Position;
 
 layout(location = 7) flat out uint instance_index;
 
+vec3 oct_to_vec3(vec2 e) {
+	vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-v.z, 0.0);
+	v.xy += mix(vec2(t), vec2(-t), greaterThanEqual(v.xy, vec2(0.0)));
+	return normalize(v);
+}
+
 #ifdef MODE_DUAL_PARABOLOID
 
 layout(location = 8) out float dp_clip;
@@ -77,8 +84,9 @@ void main() {
 	color_interp = color_attrib;
 #endif
 
-	mat4 world_matrix = instances.data[instance_index].transform;
-	mat3 world_normal_matrix = mat3(instances.data[instance_index].normal_transform);
+	uint transform_slot = instances.data[instance_index].transform_slot;
+	mat4 world_matrix = instance_transforms.data[transform_slot].transform;
+	mat3 world_normal_matrix = mat3(instance_transforms.data[transform_slot].normal_transform);
 
 	if (bool(instances.data[instance_index].flags & INSTANCE_FLAGS_MULTIMESH)) {
 		//multimesh, instances are for it
@@ -115,12 +123,20 @@ void main() {
 		instance_index += gl_InstanceIndex;
 	}
 
-	vec3 vertex = vertex_attrib;
+	vec3 vertex = vertex_attrib * draw_call.vertex_scale.xyz + draw_call.vertex_offset.xyz;
 	vec3 normal = normal_attrib;
+	if (bool(draw_call.flags & DRAW_CALL_FLAGS_OCTAHEDRAL_NORMAL)) {
+		normal = oct_to_vec3(normal_attrib.xy);
+	}
 
 #if defined(TANGENT_USED) || defined(NORMALMAP_USED) || defined(LIGHT_ANISOTROPY_USED)
 	vec3 tangent = tangent_attrib.xyz;
 	float binormalf = tangent_attrib.a;
+	if (bool(draw_call.flags & DRAW_CALL_FLAGS_OCTAHEDRAL_TANGENT)) {
+		// The binormal sign is stored in the sign of y, see Vector3::octahedron_tangent_encode().
+		binormalf = tangent_attrib.y < 0.0 ? -1.0 : 1.0;
+		tangent = oct_to_vec3(vec2(tangent_attrib.x, abs(tangent_attrib.y) * 2.0 - 1.0));
+	}
 	vec3 binormal = normalize(cross(normal, tangent) * binormalf);
 #endif
 
@@ -305,8 +321,8 @@ layout(location = 8) in float dp_clip;
 
 //defines to keep compatibility with vertex
 
-#define world_matrix instances.data[instance_index].transform
-#define world_normal_matrix instances.data[instance_index].normal_transform
+#define world_matrix instance_transforms.data[instances.data[instance_index].transform_slot].transform
+#define world_normal_matrix instance_transforms.data[instances.data[instance_index].transform_slot].normal_transform
 #define projection_matrix scene_data.projection_matrix
 
 #if defined(ENABLE_SSS) && defined(ENABLE_TRANSMITTANCE)
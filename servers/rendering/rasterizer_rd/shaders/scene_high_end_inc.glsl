@@ -5,10 +5,15 @@
 
 #include "cluster_data_inc.glsl"
 
+#define DRAW_CALL_FLAGS_OCTAHEDRAL_NORMAL (1 << 0)
+#define DRAW_CALL_FLAGS_OCTAHEDRAL_TANGENT (1 << 1)
+
 layout(push_constant, binding = 0, std430) uniform DrawCall {
 	uint instance_index;
-	uint pad; //16 bits minimum size
+	uint flags;
 	vec2 bake_uv2_offset; //used for bake to uv2, ignored otherwise
+	vec4 vertex_offset; //compressed vertices are relative to the surface AABB
+	vec4 vertex_scale;
 }
 draw_call;
 
@@ -129,13 +134,15 @@ scene_data;
 #define INSTANCE_FLAGS_SKELETON (1 << 19)
 
 struct InstanceData {
-	mat4 transform;
-	mat4 normal_transform;
 	uint flags;
 	uint instance_uniforms_ofs; //base offset in global buffer for instance variables
 	uint gi_offset; //GI information when using lightmapping (VCT or lightmap index)
 	uint layer_mask;
 	vec4 lightmap_uv_scale;
+	uint transform_slot; //index in instance_transforms, persistent across frames
+	uint pad0;
+	uint pad1;
+	uint pad2;
 };
 
 layout(set = 0, binding = 4, std430) restrict readonly buffer Instances {
@@ -143,6 +150,16 @@ layout(set = 0, binding = 4, std430) restrict readonly buffer Instances {
 }
 instances;
 
+struct InstanceTransformData {
+	mat4 transform;
+	mat4 normal_transform;
+};
+
+layout(set = 0, binding = 8, std430) restrict readonly buffer InstanceTransforms {
+	InstanceTransformData data[];
+}
+instance_transforms;
+
 layout(set = 0, binding = 5, std430) restrict readonly buffer Lights {
 	LightData data[];
 }
@@ -31,6 +31,8 @@
 #include "rendering_server_canvas.h"
 
 #include "core/math/geometry_2d.h"
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
 #include "rendering_server_globals.h"
 #include "rendering_server_raster.h"
 #include "rendering_server_viewport.h"
@@ -43,11 +45,19 @@ void RenderingServerCanvas::_render_canvas_item_tree(RID p_to_render_target, Can
 	memset(z_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
 	memset(z_last_list, 0, z_range * sizeof(RasterizerCanvas::Item *));
 
+	CullOutput output;
+	output.z_list = z_list;
+	output.z_last_list = z_last_list;
+
 	for (int i = 0; i < p_child_item_count; i++) {
-		_cull_canvas_item(p_child_items[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr);
+		_cull_canvas_item(p_child_items[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, output, nullptr, nullptr);
 	}
 	if (p_canvas_item) {
-		_cull_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr);
+		_cull_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, output, nullptr, nullptr);
+	}
+
+	if (output.redraw_requested) {
+		RenderingServerRaster::redraw_request();
 	}
 
 	RasterizerCanvas::Item *list = nullptr;
@@ -71,27 +81,94 @@ void RenderingServerCanvas::_render_canvas_item_tree(RID p_to_render_target, Can
 	RSG::canvas_render->canvas_render_items(p_to_render_target, list, p_modulate, p_lights, p_transform);
 }
 
-void _collect_ysort_children(RenderingServerCanvas::Item *p_canvas_item, Transform2D p_transform, RenderingServerCanvas::Item *p_material_owner, RenderingServerCanvas::Item **r_items, int &r_index) {
+static _FORCE_INLINE_ void _link_z_list(RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, RasterizerCanvas::Item *p_item) {
+	int zidx = p_item->z_final - RS::CANVAS_ITEM_Z_MIN;
+
+	if (z_last_list[zidx]) {
+		z_last_list[zidx]->next = p_item;
+		z_last_list[zidx] = p_item;
+
+	} else {
+		z_list[zidx] = p_item;
+		z_last_list[zidx] = p_item;
+	}
+
+	p_item->next = nullptr;
+}
+
+void _collect_ysort_children(RenderingServerCanvas::Item *p_canvas_item, Transform2D p_transform, RenderingServerCanvas::Item *p_material_owner, LocalVector<RenderingServerCanvas::Item *> *r_items) {
 	int child_item_count = p_canvas_item->child_items.size();
 	RenderingServerCanvas::Item **child_items = p_canvas_item->child_items.ptrw();
 	for (int i = 0; i < child_item_count; i++) {
 		if (child_items[i]->visible) {
 			if (r_items) {
-				r_items[r_index] = child_items[i];
-				child_items[i]->ysort_xform = p_transform;
-				child_items[i]->ysort_pos = p_transform.xform(child_items[i]->xform.elements[2]);
-				child_items[i]->material_owner = child_items[i]->use_parent_material ? p_material_owner : nullptr;
+				r_items->push_back(child_items[i]);
 			}
-
-			r_index++;
+			child_items[i]->ysort_xform = p_transform;
+			child_items[i]->ysort_pos = p_transform.xform(child_items[i]->xform.elements[2]);
+			child_items[i]->material_owner = child_items[i]->use_parent_material ? p_material_owner : nullptr;
 
 			if (child_items[i]->sort_y) {
-				_collect_ysort_children(child_items[i], p_transform * child_items[i]->xform, child_items[i]->use_parent_material ? p_material_owner : child_items[i], r_items, r_index);
+				_collect_ysort_children(child_items[i], p_transform * child_items[i]->xform, child_items[i]->use_parent_material ? p_material_owner : child_items[i], r_items);
 			}
 		}
 	}
 }
 
+// Re-sorts a list whose previous order is mostly still valid: items breaking the order are pulled out,
+// sorted on their own and merged back, which is linear when few items moved. Returns false when too
+// many items moved, so the caller can fall back to a full sort.
+static bool _ysort_resort(LocalVector<RenderingServerCanvas::Item *> &r_items) {
+	RenderingServerCanvas::ItemPtrSort compare;
+	uint32_t count = r_items.size();
+	RenderingServerCanvas::Item **items = r_items.ptr();
+
+	LocalVector<RenderingServerCanvas::Item *> kept;
+	LocalVector<RenderingServerCanvas::Item *> moved;
+	kept.reserve(count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		// Kept items stay in order. On an inversion, the next item tells which side moved: if it is
+		// also before the last kept item, that one moved forward, otherwise this one moved back.
+		bool keep = true;
+		while (kept.size() && compare(items[i], kept[kept.size() - 1])) {
+			if (i + 1 < count && compare(items[i + 1], kept[kept.size() - 1])) {
+				moved.push_back(kept[kept.size() - 1]);
+				kept.resize(kept.size() - 1);
+			} else {
+				moved.push_back(items[i]);
+				keep = false;
+				break;
+			}
+		}
+		if (moved.size() > count / 4) {
+			return false;
+		}
+		if (keep) {
+			kept.push_back(items[i]);
+		}
+	}
+
+	if (moved.size() == 0) {
+		return true;
+	}
+
+	SortArray<RenderingServerCanvas::Item *, RenderingServerCanvas::ItemPtrSort> sorter;
+	sorter.sort(moved.ptr(), moved.size());
+
+	uint32_t k = 0;
+	uint32_t m = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (m == moved.size() || (k < kept.size() && !compare(moved[m], kept[k]))) {
+			items[i] = kept[k++];
+		} else {
+			items[i] = moved[m++];
+		}
+	}
+
+	return true;
+}
+
 void _mark_ysort_dirty(RenderingServerCanvas::Item *ysort_owner, RID_PtrOwner<RenderingServerCanvas::Item> &canvas_item_owner) {
 	do {
 		ysort_owner->ysort_children_count = -1;
@@ -99,7 +176,71 @@ void _mark_ysort_dirty(RenderingServerCanvas::Item *ysort_owner, RID_PtrOwner<Re
 	} while (ysort_owner && ysort_owner->sort_y);
 }
 
-void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner) {
+void _mark_ysort_xform_dirty(RenderingServerCanvas::Item *p_item, RID_PtrOwner<RenderingServerCanvas::Item> &canvas_item_owner) {
+	RenderingServerCanvas::Item *ysort_owner = canvas_item_owner.owns(p_item->parent) ? canvas_item_owner.getornull(p_item->parent) : nullptr;
+	while (ysort_owner && ysort_owner->sort_y) {
+		ysort_owner->ysort_xform_dirty = true;
+		ysort_owner = canvas_item_owner.owns(ysort_owner->parent) ? canvas_item_owner.getornull(ysort_owner->parent) : nullptr;
+	}
+}
+
+void RenderingServerCanvas::update_ysort_children(Item *p_canvas_item, Item *p_material_owner) {
+	Item *ci = p_canvas_item;
+
+	if (ci->ysort_children_count == -1) {
+		ci->ysort_children.clear();
+		_collect_ysort_children(ci, Transform2D(), p_material_owner, &ci->ysort_children);
+		ci->ysort_children_count = ci->ysort_children.size();
+
+		SortArray<Item *, ItemPtrSort> sorter;
+		sorter.sort(ci->ysort_children.ptr(), ci->ysort_children.size());
+
+	} else if (ci->ysort_xform_dirty || ci->ysort_material_owner != p_material_owner) {
+		_collect_ysort_children(ci, Transform2D(), p_material_owner, nullptr);
+
+		if (!_ysort_resort(ci->ysort_children)) {
+			SortArray<Item *, ItemPtrSort> sorter;
+			sorter.sort(ci->ysort_children.ptr(), ci->ysort_children.size());
+		}
+	}
+
+	ci->ysort_xform_dirty = false;
+	ci->ysort_material_owner = p_material_owner;
+}
+
+void RenderingServerCanvas::_cull_canvas_item_child(Item *p_parent, Item *p_child, const Transform2D &p_xform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, CullOutput &r_output, Item *p_material_owner) {
+	if (p_parent->sort_y) {
+		_cull_canvas_item(p_child, p_xform * p_child->ysort_xform, p_clip_rect, p_modulate, p_z, r_output, (Item *)p_parent->final_clip_owner, (Item *)p_child->material_owner);
+	} else {
+		_cull_canvas_item(p_child, p_xform, p_clip_rect, p_modulate, p_z, r_output, (Item *)p_parent->final_clip_owner, p_material_owner);
+	}
+}
+
+void RenderingServerCanvas::_cull_children_chunk(uint32_t p_chunk, CullChildren *p_children) {
+	CullChunk &chunk = cull_chunks[p_chunk];
+	chunk.behind_items.clear();
+	chunk.items.clear();
+
+	CullOutput behind_output;
+	behind_output.items = &chunk.behind_items;
+	CullOutput output;
+	output.items = &chunk.items;
+
+	uint32_t from = p_chunk * p_children->chunk_size;
+	uint32_t to = MIN(from + p_children->chunk_size, p_children->child_item_count);
+
+	for (uint32_t i = from; i < to; i++) {
+		Item *child = p_children->child_items[i];
+		if (p_children->parent->sort_y && child->sort_y) {
+			continue;
+		}
+		_cull_canvas_item_child(p_children->parent, child, p_children->xform, p_children->clip_rect, p_children->modulate, p_children->z, child->behind ? behind_output : output, p_children->material_owner);
+	}
+
+	chunk.redraw_requested = behind_output.redraw_requested || output.redraw_requested;
+}
+
+void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, CullOutput &r_output, Item *p_canvas_clip, Item *p_material_owner) {
 	Item *ci = p_canvas_item;
 
 	if (!ci->visible) {
@@ -111,9 +252,16 @@ void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transfo
 		ci->children_order_dirty = false;
 	}
 
-	Rect2 rect = ci->get_rect();
-	Transform2D xform = p_transform * ci->xform;
-	Rect2 global_rect = xform.xform(rect);
+	bool rect_changes = !ci->custom_rect && (ci->rect_dirty || ci->update_when_visible);
+	if (ci->cull_cache_dirty || rect_changes || ci->cull_parent_xform != p_transform) {
+		ci->cull_parent_xform = p_transform;
+		ci->cull_xform = p_transform * ci->xform;
+		ci->cull_global_rect = ci->cull_xform.xform(ci->get_rect());
+		ci->cull_cache_dirty = false;
+	}
+
+	const Transform2D &xform = ci->cull_xform;
+	Rect2 global_rect = ci->cull_global_rect;
 	global_rect.position += p_clip_rect.position;
 
 	if (ci->use_parent_material && p_material_owner) {
@@ -145,19 +293,10 @@ void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transfo
 	}
 
 	if (ci->sort_y) {
-		if (ci->ysort_children_count == -1) {
-			ci->ysort_children_count = 0;
-			_collect_ysort_children(ci, Transform2D(), p_material_owner, nullptr, ci->ysort_children_count);
-		}
-
-		child_item_count = ci->ysort_children_count;
-		child_items = (Item **)alloca(child_item_count * sizeof(Item *));
-
-		int i = 0;
-		_collect_ysort_children(ci, Transform2D(), p_material_owner, child_items, i);
+		update_ysort_children(ci, p_material_owner);
 
-		SortArray<Item *, ItemPtrSort> sorter;
-		sorter.sort(child_items, child_item_count);
+		child_item_count = ci->ysort_children.size();
+		child_items = ci->ysort_children.ptr();
 	}
 
 	if (ci->z_relative) {
@@ -166,14 +305,43 @@ void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transfo
 		p_z = ci->z_index;
 	}
 
-	for (int i = 0; i < child_item_count; i++) {
-		if (!child_items[i]->behind || (ci->sort_y && child_items[i]->sort_y)) {
-			continue;
+	// Only split from the thread that links the z lists, threads never split again.
+	bool threaded = r_output.items == nullptr && child_item_count > 1 && uint32_t(child_item_count) >= threaded_cull_minimum_children && RSG::thread_pool && RSG::thread_pool->get_thread_count() > 1;
+
+	uint32_t chunk_count = 0;
+	if (threaded) {
+		chunk_count = MIN(uint32_t(child_item_count), uint32_t(RSG::thread_pool->get_thread_count()) * 4);
+		if (cull_chunks.size() < chunk_count) {
+			cull_chunks.resize(chunk_count);
 		}
-		if (ci->sort_y) {
-			_cull_canvas_item(child_items[i], xform * child_items[i]->ysort_xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, (Item *)child_items[i]->material_owner);
-		} else {
-			_cull_canvas_item(child_items[i], xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, p_material_owner);
+
+		CullChildren children;
+		children.parent = ci;
+		children.child_items = child_items;
+		children.child_item_count = child_item_count;
+		children.chunk_size = (child_item_count + chunk_count - 1) / chunk_count;
+		children.xform = xform;
+		children.clip_rect = p_clip_rect;
+		children.modulate = modulate;
+		children.z = p_z;
+		children.material_owner = p_material_owner;
+
+		chunk_count = (child_item_count + children.chunk_size - 1) / children.chunk_size;
+		RSG::thread_pool->do_work(chunk_count, this, &RenderingServerCanvas::_cull_children_chunk, &children);
+
+		for (uint32_t i = 0; i < chunk_count; i++) {
+			const CullChunk &chunk = cull_chunks[i];
+			for (uint32_t j = 0; j < chunk.behind_items.size(); j++) {
+				_link_z_list(r_output.z_list, r_output.z_last_list, chunk.behind_items[j]);
+			}
+			r_output.redraw_requested = r_output.redraw_requested || chunk.redraw_requested;
+		}
+	} else {
+		for (int i = 0; i < child_item_count; i++) {
+			if (!child_items[i]->behind || (ci->sort_y && child_items[i]->sort_y)) {
+				continue;
+			}
+			_cull_canvas_item_child(ci, child_items[i], xform, p_clip_rect, modulate, p_z, r_output, p_material_owner);
 		}
 	}
 
@@ -182,7 +350,7 @@ void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transfo
 	}
 
 	if (ci->update_when_visible) {
-		RenderingServerRaster::redraw_request();
+		r_output.redraw_requested = true;
 	}
 
 	if ((ci->commands != nullptr && p_clip_rect.intersects(global_rect, true)) || ci->vp_render || ci->copy_back_buffer) {
@@ -192,31 +360,28 @@ void RenderingServerCanvas::_cull_canvas_item(Item *p_canvas_item, const Transfo
 		ci->global_rect_cache = global_rect;
 		ci->global_rect_cache.position -= p_clip_rect.position;
 		ci->light_masked = false;
+		ci->z_final = p_z;
 
-		int zidx = p_z - RS::CANVAS_ITEM_Z_MIN;
-
-		if (z_last_list[zidx]) {
-			z_last_list[zidx]->next = ci;
-			z_last_list[zidx] = ci;
-
+		if (r_output.items) {
+			r_output.items->push_back(ci);
 		} else {
-			z_list[zidx] = ci;
-			z_last_list[zidx] = ci;
+			_link_z_list(r_output.z_list, r_output.z_last_list, ci);
 		}
-
-		ci->z_final = p_z;
-
-		ci->next = nullptr;
 	}
 
-	for (int i = 0; i < child_item_count; i++) {
-		if (child_items[i]->behind || (ci->sort_y && child_items[i]->sort_y)) {
-			continue;
+	if (threaded) {
+		for (uint32_t i = 0; i < chunk_count; i++) {
+			const CullChunk &chunk = cull_chunks[i];
+			for (uint32_t j = 0; j < chunk.items.size(); j++) {
+				_link_z_list(r_output.z_list, r_output.z_last_list, chunk.items[j]);
+			}
 		}
-		if (ci->sort_y) {
-			_cull_canvas_item(child_items[i], xform * child_items[i]->ysort_xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, (Item *)child_items[i]->material_owner);
-		} else {
-			_cull_canvas_item(child_items[i], xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, p_material_owner);
+	} else {
+		for (int i = 0; i < child_item_count; i++) {
+			if (child_items[i]->behind || (ci->sort_y && child_items[i]->sort_y)) {
+				continue;
+			}
+			_cull_canvas_item_child(ci, child_items[i], xform, p_clip_rect, modulate, p_z, r_output, p_material_owner);
 		}
 	}
 }
@@ -398,6 +563,9 @@ void RenderingServerCanvas::canvas_item_set_transform(RID p_item, const Transfor
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->xform = p_transform;
+	canvas_item->cull_cache_dirty = true;
+
+	_mark_ysort_xform_dirty(canvas_item, canvas_item_owner);
 }
 
 void RenderingServerCanvas::canvas_item_set_clip(RID p_item, bool p_clip) {
@@ -419,6 +587,7 @@ void RenderingServerCanvas::canvas_item_set_custom_rect(RID p_item, bool p_custo
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->custom_rect = p_custom_rect;
+	canvas_item->cull_cache_dirty = true;
 	canvas_item->rect = p_rect;
 }
 
@@ -931,6 +1100,9 @@ void RenderingServerCanvas::canvas_item_set_draw_index(RID p_item, int p_index)
 	if (canvas_item_owner.owns(canvas_item->parent)) {
 		Item *canvas_item_parent = canvas_item_owner.getornull(canvas_item->parent);
 		canvas_item_parent->children_order_dirty = true;
+		if (canvas_item_parent->sort_y) {
+			_mark_ysort_dirty(canvas_item_parent, canvas_item_owner);
+		}
 		return;
 	}
 
@@ -953,6 +1125,8 @@ void RenderingServerCanvas::canvas_item_set_use_parent_material(RID p_item, bool
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->use_parent_material = p_enable;
+
+	_mark_ysort_xform_dirty(canvas_item, canvas_item_owner);
 }
 
 RID RenderingServerCanvas::canvas_light_create() {
@@ -1394,6 +1568,9 @@ RenderingServerCanvas::RenderingServerCanvas() {
 	z_last_list = (RasterizerCanvas::Item **)memalloc(z_range * sizeof(RasterizerCanvas::Item *));
 
 	disable_scale = false;
+
+	threaded_cull_minimum_children = GLOBAL_DEF("rendering/limits/canvas/threaded_cull_minimum_children", 256);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/limits/canvas/threaded_cull_minimum_children", PropertyInfo(Variant::INT, "rendering/limits/canvas/threaded_cull_minimum_children", PROPERTY_HINT_RANGE, "0,65536,1,or_greater"));
 }
 
 RenderingServerCanvas::~RenderingServerCanvas() {
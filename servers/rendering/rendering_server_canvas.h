@@ -31,6 +31,7 @@
 #ifndef VISUALSERVERCANVAS_H
 #define VISUALSERVERCANVAS_H
 
+#include "core/local_vector.h"
 #include "rasterizer.h"
 #include "rendering_server_viewport.h"
 
@@ -54,6 +55,19 @@ public:
 		RS::CanvasItemTextureFilter texture_filter;
 		RS::CanvasItemTextureRepeat texture_repeat;
 
+		// Y-sorted descendants in the order of the last sort, re-sorted incrementally
+		// when a transform in the group changes and rebuilt when the group changes.
+		LocalVector<Item *> ysort_children;
+		bool ysort_xform_dirty;
+		Item *ysort_material_owner;
+
+		// Global transform and rect of the last cull, reused while neither this item's
+		// transform or rect nor the parent's global transform change.
+		bool cull_cache_dirty;
+		Transform2D cull_parent_xform;
+		Transform2D cull_xform;
+		Rect2 cull_global_rect;
+
 		Vector<Item *> child_items;
 
 		Item() {
@@ -69,6 +83,9 @@ public:
 			ysort_children_count = -1;
 			ysort_xform = Transform2D();
 			ysort_pos = Vector2();
+			ysort_xform_dirty = true;
+			ysort_material_owner = nullptr;
+			cull_cache_dirty = true;
 			texture_filter = RS::CANVAS_ITEM_TEXTURE_FILTER_DEFAULT;
 			texture_repeat = RS::CANVAS_ITEM_TEXTURE_REPEAT_DEFAULT;
 		}
@@ -156,14 +173,51 @@ public:
 	bool disable_scale;
 
 private:
+	// Where culled items go: linked into the z lists right away, or, when culling on a
+	// thread, collected in draw order to be linked once all threads are done.
+	struct CullOutput {
+		RasterizerCanvas::Item **z_list = nullptr;
+		RasterizerCanvas::Item **z_last_list = nullptr;
+		LocalVector<Item *> *items = nullptr;
+		bool redraw_requested = false;
+	};
+
+	// Children of a canvas item with many children are culled in chunks on multiple threads.
+	struct CullChunk {
+		LocalVector<Item *> behind_items;
+		LocalVector<Item *> items;
+		bool redraw_requested = false;
+	};
+
+	struct CullChildren {
+		Item *parent;
+		Item **child_items;
+		uint32_t child_item_count;
+		uint32_t chunk_size;
+		Transform2D xform;
+		Rect2 clip_rect;
+		Color modulate;
+		int z;
+		Item *material_owner;
+	};
+
+	LocalVector<CullChunk> cull_chunks;
+	uint32_t threaded_cull_minimum_children = 256;
+
 	void _render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RasterizerCanvas::Light *p_lights);
-	void _cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RasterizerCanvas::Item **z_list, RasterizerCanvas::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner);
+	void _cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, CullOutput &r_output, Item *p_canvas_clip, Item *p_material_owner);
+	void _cull_canvas_item_child(Item *p_parent, Item *p_child, const Transform2D &p_xform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, CullOutput &r_output, Item *p_material_owner);
+	void _cull_children_chunk(uint32_t p_chunk, CullChildren *p_children);
 	void _light_mask_canvas_items(int p_z, RasterizerCanvas::Item *p_canvas_item, RasterizerCanvas::Light *p_masked_lights);
 
 	RasterizerCanvas::Item **z_list;
 	RasterizerCanvas::Item **z_last_list;
 
 public:
+	// Fills ysort_children of a y-sorted item with its y-sorted descendants in draw order. When only
+	// transforms changed since the last call, the previous order is repaired instead of sorted again.
+	static void update_ysort_children(Item *p_canvas_item, Item *p_material_owner);
+
 	void render_canvas(RID p_render_target, Canvas *p_canvas, const Transform2D &p_transform, RasterizerCanvas::Light *p_lights, RasterizerCanvas::Light *p_masked_lights, const Rect2 &p_clip_rect);
 
 	RID canvas_create();
@@ -38,3 +38,5 @@ Rasterizer *RenderingServerGlobals::rasterizer = nullptr;
 RenderingServerCanvas *RenderingServerGlobals::canvas = nullptr;
 RenderingServerViewport *RenderingServerGlobals::viewport = nullptr;
 RenderingServerScene *RenderingServerGlobals::scene = nullptr;
+
+ThreadWorkPool *RenderingServerGlobals::thread_pool = nullptr;
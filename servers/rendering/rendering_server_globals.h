@@ -36,6 +36,7 @@
 class RenderingServerCanvas;
 class RenderingServerViewport;
 class RenderingServerScene;
+class ThreadWorkPool;
 
 class RenderingServerGlobals {
 public:
@@ -47,6 +48,8 @@ public:
 	static RenderingServerCanvas *canvas;
 	static RenderingServerViewport *viewport;
 	static RenderingServerScene *scene;
+
+	static ThreadWorkPool *thread_pool; // Shared by everything run on the render thread, one task at a time.
 };
 
 #define RSG RenderingServerGlobals
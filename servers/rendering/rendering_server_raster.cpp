@@ -34,6 +34,7 @@
 #include "core/os/os.h"
 #include "core/project_settings.h"
 #include "core/sort_array.h"
+#include "core/thread_work_pool.h"
 #include "rendering_server_canvas.h"
 #include "rendering_server_globals.h"
 #include "rendering_server_scene.h"
@@ -110,6 +111,7 @@ void RenderingServerRaster::draw(bool p_swap_buffers, double frame_step) {
 
 	RSG::scene->render_probes();
 	RSG::viewport->draw_viewports();
+	RSG::scene->update_texture_stream_feedback();
 	RSG::canvas_render->update();
 
 	_draw_margins();
@@ -254,6 +256,9 @@ bool RenderingServerRaster::is_low_end() const {
 }
 
 RenderingServerRaster::RenderingServerRaster() {
+	RSG::thread_pool = memnew(ThreadWorkPool);
+	RSG::thread_pool->init();
+
 	RSG::canvas = memnew(RenderingServerCanvas);
 	RSG::viewport = memnew(RenderingServerViewport);
 	RSG::scene = memnew(RenderingServerScene);
@@ -275,4 +280,7 @@ RenderingServerRaster::~RenderingServerRaster() {
 	memdelete(RSG::viewport);
 	memdelete(RSG::rasterizer);
 	memdelete(RSG::scene);
+
+	memdelete(RSG::thread_pool);
+	RSG::thread_pool = nullptr;
 }
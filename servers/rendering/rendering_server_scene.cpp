@@ -31,6 +31,9 @@
 #include "rendering_server_scene.h"
 
 #include "core/os/os.h"
+#include "core/project_settings.h"
+#include "core/thread_work_pool.h"
+#include "mesh_lod.h"
 #include "rendering_server_globals.h"
 #include "rendering_server_raster.h"
 
@@ -323,6 +326,7 @@ void RenderingServerScene::scenario_set_reflection_atlas_size(RID p_scenario, in
 	Scenario *scenario = scenario_owner.getornull(p_scenario);
 	ERR_FAIL_COND(!scenario);
 	RSG::scene_render->reflection_atlas_set_size(scenario->reflection_atlas, p_reflection_size, p_reflection_count);
+	scenario->reflection_size = p_reflection_size;
 }
 
 /* INSTANCING API */
@@ -366,6 +370,11 @@ void RenderingServerScene::instance_set_base(RID p_instance, RID p_base) {
 			instance->octree_id = 0;
 		}
 
+		if (scenario && instance->cull_id) {
+			scenario->cull_bvh.erase(instance->cull_id);
+			instance->cull_id = CULL_BVH_INVALID_ID;
+		}
+
 		switch (instance->base_type) {
 			case RS::INSTANCE_LIGHT: {
 				InstanceLightData *light = static_cast<InstanceLightData *>(instance->base_data);
@@ -521,6 +530,11 @@ void RenderingServerScene::instance_set_scenario(RID p_instance, RID p_scenario)
 			instance->octree_id = 0;
 		}
 
+		if (instance->cull_id) {
+			instance->scenario->cull_bvh.erase(instance->cull_id);
+			instance->cull_id = CULL_BVH_INVALID_ID;
+		}
+
 		switch (instance->base_type) {
 			case RS::INSTANCE_LIGHT: {
 				InstanceLightData *light = static_cast<InstanceLightData *>(instance->base_data);
@@ -623,9 +637,20 @@ void RenderingServerScene::instance_set_transform(RID p_instance, const Transfor
 
 #endif
 	instance->transform = p_transform;
+	instance->transform_version++;
 	_instance_queue_update(instance, true);
 }
 
+void RenderingServerScene::instances_set_transforms(const Vector<RID> &p_instances, const Vector<Transform> &p_transforms) {
+	ERR_FAIL_COND(p_instances.size() != p_transforms.size());
+
+	const RID *rids = p_instances.ptr();
+	const Transform *transforms = p_transforms.ptr();
+	for (int i = 0; i < p_instances.size(); i++) {
+		instance_set_transform(rids[i], transforms[i]);
+	}
+}
+
 void RenderingServerScene::instance_attach_object_instance_id(RID p_instance, ObjectID p_id) {
 	Instance *instance = instance_owner.getornull(p_instance);
 	ERR_FAIL_COND(!instance);
@@ -889,9 +914,119 @@ void RenderingServerScene::instance_geometry_set_material_override(RID p_instanc
 }
 
 void RenderingServerScene::instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) {
+	Instance *instance = instance_owner.getornull(p_instance);
+	ERR_FAIL_COND(!instance);
+
+	instance->lod_begin = MAX(p_min, 0);
+	instance->lod_end = MAX(p_max, 0);
+	instance->lod_begin_hysteresis = MAX(p_min_margin, 0);
+	instance->lod_end_hysteresis = MAX(p_max_margin, 0);
+	instance->lod_too_close = false;
+	instance->lod_too_far = false;
+
+	_instance_update_cull_range(instance);
+	// The range of the children depends on the begin distance of their parent.
+	for (Set<Instance *>::Element *E = instance->lod_children.front(); E; E = E->next()) {
+		_instance_update_cull_range(E->get());
+	}
 }
 
 void RenderingServerScene::instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) {
+	Instance *instance = instance_owner.getornull(p_instance);
+	ERR_FAIL_COND(!instance);
+
+	Instance *parent = nullptr;
+	if (p_as_lod_of_instance.is_valid()) {
+		parent = instance_owner.getornull(p_as_lod_of_instance);
+		ERR_FAIL_COND(!parent);
+		ERR_FAIL_COND_MSG(parent == instance, "An instance can't be a LOD of itself.");
+		ERR_FAIL_COND_MSG(parent->lod_parent != nullptr, "The LOD parent can't be a LOD of another instance.");
+		ERR_FAIL_COND_MSG(!instance->lod_children.empty(), "An instance with LOD children can't be a LOD of another instance.");
+	}
+
+	if (instance->lod_parent) {
+		instance->lod_parent->lod_children.erase(instance);
+	}
+	instance->lod_parent = parent;
+	if (parent) {
+		parent->lod_children.insert(instance);
+	}
+
+	_instance_update_cull_range(instance);
+}
+
+void RenderingServerScene::_instance_update_cull_range(Instance *p_instance) {
+	if (p_instance->cull_id == CULL_BVH_INVALID_ID) {
+		return;
+	}
+
+	// Conservative, the exact test with the hysteresis state is done in _instance_is_in_lod_range().
+	real_t begin = MAX(p_instance->lod_begin - p_instance->lod_begin_hysteresis, 0);
+	real_t end = p_instance->lod_end > 0 ? p_instance->lod_end + p_instance->lod_end_hysteresis : 0;
+
+	const Instance *parent = p_instance->lod_parent;
+	if (parent && parent->lod_begin > 0) {
+		// Drawn only while the parent is too close, which bounds the distance to the child too.
+		Vector3 parent_center = parent->transformed_aabb.position + parent->transformed_aabb.size * 0.5;
+		Vector3 center = p_instance->transformed_aabb.position + p_instance->transformed_aabb.size * 0.5;
+		real_t parent_end = parent->lod_begin + parent->lod_begin_hysteresis + parent_center.distance_to(center);
+		end = end > 0 ? MIN(end, parent_end) : parent_end;
+	}
+
+	p_instance->scenario->cull_bvh.set_visibility_range(p_instance->cull_id, begin, end);
+}
+
+void RenderingServerScene::_instance_get_lod_state(Instance *p_instance, const Vector3 &p_origin, bool p_update, bool &r_too_close, bool &r_too_far) {
+	r_too_close = p_instance->lod_too_close;
+	r_too_far = p_instance->lod_too_far;
+
+	if (p_update && p_instance->lod_pass == lod_range_pass) {
+		return; // Already updated in this pass, as the parent of another instance.
+	}
+
+	if (p_instance->lod_begin > 0 || p_instance->lod_end > 0) {
+		real_t d = p_origin.distance_to(p_instance->transformed_aabb.position + p_instance->transformed_aabb.size * 0.5);
+		// Crossing a limit needs to go past the margin on the other side, so instances don't flicker there.
+		if (p_instance->lod_begin > 0) {
+			r_too_close = d < p_instance->lod_begin + (r_too_close ? p_instance->lod_begin_hysteresis : -p_instance->lod_begin_hysteresis);
+		}
+		if (p_instance->lod_end > 0) {
+			r_too_far = d > p_instance->lod_end + (r_too_far ? -p_instance->lod_end_hysteresis : p_instance->lod_end_hysteresis);
+		}
+	}
+
+	if (p_update) {
+		p_instance->lod_too_close = r_too_close;
+		p_instance->lod_too_far = r_too_far;
+		p_instance->lod_pass = lod_range_pass;
+	}
+}
+
+void RenderingServerScene::_reset_stale_lod_error_limits(Instance **p_instances, int p_count) {
+	// Mesh LOD limits are only computed in the camera pass. Instances it didn't keep may still
+	// hold the limit of another frame or viewport, so they are drawn in full detail instead.
+	for (int i = 0; i < p_count; i++) {
+		if (p_instances[i]->last_render_pass != render_pass) {
+			p_instances[i]->lod_error_limit = 0;
+		}
+	}
+}
+
+bool RenderingServerScene::_instance_is_in_lod_range(Instance *p_instance, const Vector3 &p_origin, bool p_update) {
+	bool too_close;
+	bool too_far;
+	_instance_get_lod_state(p_instance, p_origin, p_update, too_close, too_far);
+	if (too_close || too_far) {
+		return false;
+	}
+
+	if (p_instance->lod_parent) {
+		// The parent is a proxy for its children, which replace it once it is too close.
+		_instance_get_lod_state(p_instance->lod_parent, p_origin, p_update, too_close, too_far);
+		return too_close;
+	}
+
+	return true;
 }
 
 void RenderingServerScene::instance_geometry_set_lightmap(RID p_instance, RID p_lightmap, const Rect2 &p_lightmap_uv_scale, int p_slice_index) {
@@ -1102,6 +1237,21 @@ void RenderingServerScene::_update_instance(Instance *p_instance) {
 
 		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
 	}
+
+	// Pairing still goes through the octree, so instances are kept in both structures.
+	// Moving in the BVH only refits the branch, far cheaper than the octree move.
+	if (p_instance->cull_id == CULL_BVH_INVALID_ID) {
+		p_instance->cull_id = p_instance->scenario->cull_bvh.create(p_instance, new_aabb, 1 << p_instance->base_type);
+	} else {
+		p_instance->scenario->cull_bvh.move(p_instance->cull_id, new_aabb);
+	}
+
+	if (p_instance->lod_begin > 0 || p_instance->lod_end > 0 || p_instance->lod_parent) {
+		_instance_update_cull_range(p_instance);
+	}
+	for (Set<Instance *>::Element *E = p_instance->lod_children.front(); E; E = E->next()) {
+		_instance_update_cull_range(E->get());
+	}
 }
 
 void RenderingServerScene::_update_instance_aabb(Instance *p_instance) {
@@ -1256,6 +1406,38 @@ void RenderingServerScene::_update_instance_lightmap_captures(Instance *p_instan
 	}
 }
 
+void RenderingServerScene::_shadow_cull_job(uint32_t p_index, Scenario *p_scenario) {
+	ShadowCullJob &job = shadow_cull_jobs[p_index];
+	job.result.clear();
+	p_scenario->cull_bvh.cull_convex(job.planes.ptr(), job.planes.size(), job.range_origin, job.result, RS::INSTANCE_GEOMETRY_MASK);
+
+	// Shadows follow what the camera sees, without touching the hysteresis state from the threads.
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < job.result.size(); i++) {
+		if (_instance_is_in_lod_range(job.result[i], job.range_origin, false)) {
+			job.result[count++] = job.result[i];
+		}
+	}
+	job.result.resize(count);
+}
+
+void RenderingServerScene::_cull_shadow_jobs(Scenario *p_scenario, uint32_t p_count, const Vector3 &p_range_origin) {
+	ERR_FAIL_COND(p_count > MAX_SHADOW_CULL_JOBS);
+
+	for (uint32_t i = 0; i < p_count; i++) {
+		shadow_cull_jobs[i].range_origin = p_range_origin;
+	}
+
+	// Small scenes cull faster than it takes to wake up the threads.
+	if (p_count > 1 && RSG::thread_pool && p_scenario->cull_bvh.get_element_count() >= threaded_cull_minimum_instances) {
+		RSG::thread_pool->do_work(p_count, this, &RenderingServerScene::_shadow_cull_job, p_scenario);
+	} else {
+		for (uint32_t i = 0; i < p_count; i++) {
+			_shadow_cull_job(i, p_scenario);
+		}
+	}
+}
+
 bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, RID p_shadow_atlas, Scenario *p_scenario) {
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
 
@@ -1281,7 +1463,9 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			if (depth_range_mode == RS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
 				//optimize min/max
 				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+				instance_shadow_cull_result.clear();
+				p_scenario->cull_bvh.cull_convex(planes.ptr(), planes.size(), p_cam_transform.origin, instance_shadow_cull_result, RS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = instance_shadow_cull_result.size();
 				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
 				//check distance max and min
 
@@ -1291,7 +1475,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 
 				for (int i = 0; i < cull_count; i++) {
 					Instance *instance = instance_shadow_cull_result[i];
-					if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+					if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows || !_instance_is_in_lod_range(instance, p_cam_transform.origin, false)) {
 						continue;
 					}
 
@@ -1351,14 +1535,31 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 
 			real_t min_distance_bias_scale = pancake_size > 0 ? distances[1] / 10.0 : 0;
 
-			for (int i = 0; i < splits; i++) {
-				RENDER_TIMESTAMP("Culling Directional Light split" + itos(i));
+			// Splits are set up first, culled together (in parallel if worth it), then rendered in order.
+			struct DirectionalShadowSplit {
+				bool valid = false;
+				CameraMatrix camera_matrix;
+				Vector3 center;
+				real_t radius = 0;
+				real_t bias_scale = 1.0;
+				real_t x_min_cam = 0, x_max_cam = 0;
+				real_t y_min_cam = 0, y_max_cam = 0;
+				real_t z_min_cam = 0, z_max = 0;
+			};
+
+			DirectionalShadowSplit splits_data[4];
 
+			real_t aspect = p_cam_projection.get_aspect();
+
+			Vector3 x_vec = light_transform.basis.get_axis(Vector3::AXIS_X).normalized();
+			Vector3 y_vec = light_transform.basis.get_axis(Vector3::AXIS_Y).normalized();
+			Vector3 z_vec = light_transform.basis.get_axis(Vector3::AXIS_Z).normalized();
+			//z_vec points agsint the camera, like in default opengl
+
+			for (int i = 0; i < splits; i++) {
 				// setup a camera matrix for that range!
 				CameraMatrix camera_matrix;
 
-				real_t aspect = p_cam_projection.get_aspect();
-
 				if (p_cam_orthogonal) {
 					Vector2 vp_he = p_cam_projection.get_viewport_half_extents();
 
@@ -1376,13 +1577,6 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 
 				// obtain the light frustm ranges (given endpoints)
 
-				Transform transform = light_transform; //discard scale and stabilize light
-
-				Vector3 x_vec = transform.basis.get_axis(Vector3::AXIS_X).normalized();
-				Vector3 y_vec = transform.basis.get_axis(Vector3::AXIS_Y).normalized();
-				Vector3 z_vec = transform.basis.get_axis(Vector3::AXIS_Z).normalized();
-				//z_vec points agsint the camera, like in default opengl
-
 				real_t x_min = 0.f, x_max = 0.f;
 				real_t y_min = 0.f, y_max = 0.f;
 				real_t z_min = 0.f, z_max = 0.f;
@@ -1395,7 +1589,6 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 				//real_t z_max_cam = 0.f;
 
 				real_t bias_scale = 1.0;
-				real_t aspect_bias_scale = 1.0;
 
 				//used for culling
 
@@ -1492,7 +1685,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 
 				//now that we now all ranges, we can proceed to make the light frustum planes, for culling octree
 
-				Vector<Plane> light_frustum_planes;
+				Vector<Plane> &light_frustum_planes = shadow_cull_jobs[i].planes;
 				light_frustum_planes.resize(6);
 
 				//right/left
@@ -1505,7 +1698,39 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+				DirectionalShadowSplit &split = splits_data[i];
+				split.camera_matrix = camera_matrix;
+				split.center = center;
+				split.radius = radius;
+				split.bias_scale = bias_scale;
+				split.x_min_cam = x_min_cam;
+				split.x_max_cam = x_max_cam;
+				split.y_min_cam = y_min_cam;
+				split.y_max_cam = y_max_cam;
+				split.z_min_cam = z_min_cam;
+				split.z_max = z_max;
+				split.valid = true;
+			}
+
+			// Culling does not depend on the other splits, so it can be done for all of them at once.
+			RENDER_TIMESTAMP("Culling Directional Light splits");
+			_cull_shadow_jobs(p_scenario, splits, p_cam_transform.origin);
+
+			for (int i = 0; i < splits; i++) {
+				const DirectionalShadowSplit &split = splits_data[i];
+				if (!split.valid) {
+					continue;
+				}
+
+				const CameraMatrix &camera_matrix = split.camera_matrix;
+				const Vector3 &center = split.center;
+				real_t radius = split.radius;
+				real_t z_min_cam = split.z_min_cam;
+				real_t z_max = split.z_max;
+				real_t aspect_bias_scale = 1.0;
+
+				LocalVector<Instance *> &cull_result = shadow_cull_jobs[i].result;
+				int cull_count = cull_result.size();
 
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
@@ -1514,10 +1739,10 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 				real_t cull_max = 0;
 				for (int j = 0; j < cull_count; j++) {
 					real_t min, max;
-					Instance *instance = instance_shadow_cull_result[j];
+					Instance *instance = cull_result[j];
 					if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
 						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
+						SWAP(cull_result[j], cull_result[cull_count]);
 						j--;
 						continue;
 					}
@@ -1561,7 +1786,7 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					}
 
 					Vector3 endpoints_square[8]; // frustum plane endpoints
-					res = camera_matrix_square.get_endpoints(p_cam_transform, endpoints_square);
+					bool res = camera_matrix_square.get_endpoints(p_cam_transform, endpoints_square);
 					ERR_CONTINUE(!res);
 					Vector3 center_square;
 					real_t z_max_square = 0;
@@ -1608,16 +1833,16 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 
 				{
 					CameraMatrix ortho_camera;
-					real_t half_x = (x_max_cam - x_min_cam) * 0.5;
-					real_t half_y = (y_max_cam - y_min_cam) * 0.5;
+					real_t half_x = (split.x_max_cam - split.x_min_cam) * 0.5;
+					real_t half_y = (split.y_max_cam - split.y_min_cam) * 0.5;
 
 					ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - z_min_cam));
 
-					Vector2 uv_scale(1.0 / (x_max_cam - x_min_cam), 1.0 / (y_max_cam - y_min_cam));
+					Vector2 uv_scale(1.0 / (split.x_max_cam - split.x_min_cam), 1.0 / (split.y_max_cam - split.y_min_cam));
 
 					Transform ortho_transform;
-					ortho_transform.basis = transform.basis;
-					ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
+					ortho_transform.basis = light_transform.basis;
+					ortho_transform.origin = x_vec * (split.x_min_cam + half_x) + y_vec * (split.y_min_cam + half_y) + z_vec * z_max;
 
 					{
 						Vector3 max_in_view = p_cam_transform.affine_inverse().xform(z_vec * cull_max);
@@ -1625,10 +1850,11 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 						cull_max = dir_in_view.dot(max_in_view);
 					}
 
-					RSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, z_max - z_min_cam, distances[i + 1], i, radius * 2.0 / texture_size, bias_scale * aspect_bias_scale * min_distance_bias_scale, z_max, uv_scale);
+					RSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, z_max - z_min_cam, distances[i + 1], i, radius * 2.0 / texture_size, split.bias_scale * aspect_bias_scale * min_distance_bias_scale, z_max, uv_scale);
 				}
 
-				RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+				_reset_stale_lod_error_limits(cull_result.ptr(), cull_count);
+				RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)cull_result.ptr(), cull_count);
 			}
 
 		} break;
@@ -1636,14 +1862,11 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			RS::LightOmniShadowMode shadow_mode = RSG::storage->light_omni_get_shadow_mode(p_instance->base);
 
 			if (shadow_mode == RS::LIGHT_OMNI_SHADOW_DUAL_PARABOLOID || !RSG::scene_render->light_instances_can_render_shadow_cube()) {
-				for (int i = 0; i < 2; i++) {
-					//using this one ensures that raster deferred will have it
-					RENDER_TIMESTAMP("Culling Shadow Paraboloid" + itos(i));
-
-					real_t radius = RSG::storage->light_get_param(p_instance->base, RS::LIGHT_PARAM_RANGE);
+				real_t radius = RSG::storage->light_get_param(p_instance->base, RS::LIGHT_PARAM_RANGE);
 
+				for (int i = 0; i < 2; i++) {
 					real_t z = i == 0 ? -1 : 1;
-					Vector<Plane> planes;
+					Vector<Plane> &planes = shadow_cull_jobs[i].planes;
 					planes.resize(6);
 					planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
 					planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
@@ -1651,15 +1874,24 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
 					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 					planes.write[5] = light_transform.xform(Plane(Vector3(0, 0, -z), 0));
+				}
 
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+				RENDER_TIMESTAMP("Culling Shadow Paraboloids");
+				_cull_shadow_jobs(p_scenario, 2, p_cam_transform.origin);
+
+				for (int i = 0; i < 2; i++) {
+					//using this one ensures that raster deferred will have it
+					real_t z = i == 0 ? -1 : 1;
+
+					LocalVector<Instance *> &cull_result = shadow_cull_jobs[i].result;
+					int cull_count = cull_result.size();
 					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
 
 					for (int j = 0; j < cull_count; j++) {
-						Instance *instance = instance_shadow_cull_result[j];
+						Instance *instance = cull_result[j];
 						if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
 							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
+							SWAP(cull_result[j], cull_result[cull_count]);
 							j--;
 						} else {
 							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
@@ -1672,7 +1904,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					}
 
 					RSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i, 0);
-					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					_reset_stale_lod_error_limits(cull_result.ptr(), cull_count);
+					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)cull_result.ptr(), cull_count);
 				}
 			} else { //shadow cube
 
@@ -1680,39 +1913,45 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 				CameraMatrix cm;
 				cm.set_perspective(90, 1, 0.01, radius);
 
+				static const Vector3 view_normals[6] = {
+					Vector3(+1, 0, 0),
+					Vector3(-1, 0, 0),
+					Vector3(0, -1, 0),
+					Vector3(0, +1, 0),
+					Vector3(0, 0, +1),
+					Vector3(0, 0, -1)
+				};
+				static const Vector3 view_up[6] = {
+					Vector3(0, -1, 0),
+					Vector3(0, -1, 0),
+					Vector3(0, 0, -1),
+					Vector3(0, 0, +1),
+					Vector3(0, -1, 0),
+					Vector3(0, -1, 0)
+				};
+
+				Transform xforms[6];
+				for (int i = 0; i < 6; i++) {
+					xforms[i] = light_transform * Transform().looking_at(view_normals[i], view_up[i]);
+					shadow_cull_jobs[i].planes = cm.get_projection_planes(xforms[i]);
+				}
+
+				RENDER_TIMESTAMP("Culling Shadow Cube sides");
+				_cull_shadow_jobs(p_scenario, 6, p_cam_transform.origin);
+
 				for (int i = 0; i < 6; i++) {
-					RENDER_TIMESTAMP("Culling Shadow Cube side" + itos(i));
 					//using this one ensures that raster deferred will have it
+					const Transform &xform = xforms[i];
 
-					static const Vector3 view_normals[6] = {
-						Vector3(+1, 0, 0),
-						Vector3(-1, 0, 0),
-						Vector3(0, -1, 0),
-						Vector3(0, +1, 0),
-						Vector3(0, 0, +1),
-						Vector3(0, 0, -1)
-					};
-					static const Vector3 view_up[6] = {
-						Vector3(0, -1, 0),
-						Vector3(0, -1, 0),
-						Vector3(0, 0, -1),
-						Vector3(0, 0, +1),
-						Vector3(0, -1, 0),
-						Vector3(0, -1, 0)
-					};
-
-					Transform xform = light_transform * Transform().looking_at(view_normals[i], view_up[i]);
-
-					Vector<Plane> planes = cm.get_projection_planes(xform);
-
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+					LocalVector<Instance *> &cull_result = shadow_cull_jobs[i].result;
+					int cull_count = cull_result.size();
 
 					Plane near_plane(xform.origin, -xform.basis.get_axis(2));
 					for (int j = 0; j < cull_count; j++) {
-						Instance *instance = instance_shadow_cull_result[j];
+						Instance *instance = cull_result[j];
 						if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
 							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
+							SWAP(cull_result[j], cull_result[cull_count]);
 							j--;
 						} else {
 							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
@@ -1724,7 +1963,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 					}
 
 					RSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i, 0);
-					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					_reset_stale_lod_error_limits(cull_result.ptr(), cull_count);
+					RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)cull_result.ptr(), cull_count);
 				}
 
 				//restore the regular DP matrix
@@ -1741,15 +1981,18 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			CameraMatrix cm;
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
-			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, RS::INSTANCE_GEOMETRY_MASK);
+			shadow_cull_jobs[0].planes = cm.get_projection_planes(light_transform);
+			_cull_shadow_jobs(p_scenario, 1, p_cam_transform.origin);
+
+			LocalVector<Instance *> &cull_result = shadow_cull_jobs[0].result;
+			int cull_count = cull_result.size();
 
 			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
 			for (int j = 0; j < cull_count; j++) {
-				Instance *instance = instance_shadow_cull_result[j];
+				Instance *instance = cull_result[j];
 				if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
 					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
+					SWAP(cull_result[j], cull_result[cull_count]);
 					j--;
 				} else {
 					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
@@ -1761,7 +2004,8 @@ bool RenderingServerScene::_light_instance_update_shadow(Instance *p_instance, c
 			}
 
 			RSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0, 0);
-			RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+			_reset_stale_lod_error_limits(cull_result.ptr(), cull_count);
+			RSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)cull_result.ptr(), cull_count);
 
 		} break;
 	}
@@ -1814,7 +2058,7 @@ void RenderingServerScene::render_camera(RID p_render_buffers, RID p_camera, RID
 
 	RID environment = _render_get_environment(p_camera, p_scenario);
 
-	_prepare_scene(camera->transform, camera_matrix, ortho, camera->vaspect, p_render_buffers, environment, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+	_prepare_scene(camera->transform, camera_matrix, ortho, camera->vaspect, p_viewport_size.height, p_render_buffers, environment, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
 	_render_scene(p_render_buffers, camera->transform, camera_matrix, ortho, environment, camera->effects, p_scenario, p_shadow_atlas, RID(), -1);
 #endif
 }
@@ -1893,17 +2137,17 @@ void RenderingServerScene::render_camera(RID p_render_buffers, Ref<XRInterface>
 		mono_transform *= apply_z_shift;
 
 		// now prepare our scene with our adjusted transform projection matrix
-		_prepare_scene(mono_transform, combined_matrix, false, false, p_render_buffers, environment, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+		_prepare_scene(mono_transform, combined_matrix, false, false, p_viewport_size.height, p_render_buffers, environment, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
 	} else if (p_eye == XRInterface::EYE_MONO) {
 		// For mono render, prepare as per usual
-		_prepare_scene(cam_transform, camera_matrix, false, false, p_render_buffers, environment, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+		_prepare_scene(cam_transform, camera_matrix, false, false, p_viewport_size.height, p_render_buffers, environment, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
 	}
 
 	// And render our scene...
 	_render_scene(p_render_buffers, cam_transform, camera_matrix, false, environment, camera->effects, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
-void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, RID p_render_buffers, RID p_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows) {
+void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, float p_viewport_height, RID p_render_buffers, RID p_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
 	// - p_cam_projection is a wider frustrum that encompasses both eyes
@@ -1929,7 +2173,16 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	// Reflection probes see the scene from elsewhere, they must not change the visibility range state of the camera.
+	bool update_lod_state = p_reflection_probe.is_null();
+	if (update_lod_state) {
+		lod_range_pass++;
+	}
+
+	scenario->cull_bvh.update();
+	instance_cull_result.clear();
+	scenario->cull_bvh.cull_convex(planes.ptr(), planes.size(), p_cam_transform.origin, instance_cull_result);
+	instance_cull_count = instance_cull_result.size();
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -2028,7 +2281,7 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 				lightmap_cull_count++;
 			}
 
-		} else if (((1 << ins->base_type) & RS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != RS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+		} else if (((1 << ins->base_type) & RS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != RS::SHADOW_CASTING_SETTING_SHADOWS_ONLY && _instance_is_in_lod_range(ins, p_cam_transform.origin, update_lod_state)) {
 			keep = true;
 
 			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
@@ -2101,6 +2354,30 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 
 			ins->depth = near_plane.distance_to(ins->transform.origin);
 			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
+
+			bool use_mesh_lod = mesh_lod_threshold > 0.0 && (ins->base_type == RS::INSTANCE_MESH || ins->base_type == RS::INSTANCE_MULTIMESH);
+			bool use_texture_stream = update_lod_state && !texture_stream_sizes.empty();
+			ins->lod_error_limit = 0;
+
+			if (use_mesh_lod || use_texture_stream) {
+				// Measured to the closest point of the bounds, so large instances keep full detail up close.
+				const AABB &aabb = ins->transformed_aabb;
+				Vector3 closest;
+				for (int j = 0; j < 3; j++) {
+					closest[j] = CLAMP(p_cam_transform.origin[j], aabb.position[j], aabb.position[j] + aabb.size[j]);
+				}
+				float distance = p_cam_transform.origin.distance_to(closest);
+
+				if (use_mesh_lod) {
+					Vector3 scale = ins->transform.basis.get_scale_abs();
+					ins->lod_error_limit = MeshLOD::get_error_limit(p_cam_projection, p_viewport_height, distance, scale[scale.max_axis()], mesh_lod_threshold);
+				}
+				if (use_texture_stream) {
+					// Size of a pixel at that distance, the bounds are already in world space.
+					float pixel_size = MeshLOD::get_error_limit(p_cam_projection, p_viewport_height, distance, 1.0, 1.0);
+					_texture_stream_add_instance(ins, pixel_size > 0.0 ? aabb.get_longest_axis_size() / pixel_size : Math_INF);
+				}
+			}
 		}
 
 		if (!keep) {
@@ -2279,7 +2556,9 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 				sdfgi_light_cull_pass++;
 				prev_cascade = region_cascade;
 			}
-			uint32_t sdfgi_cull_count = scenario->octree.cull_aabb(region, instance_shadow_cull_result, MAX_INSTANCE_CULL);
+			instance_shadow_cull_result.clear();
+			scenario->cull_bvh.cull_aabb(region, instance_shadow_cull_result);
+			uint32_t sdfgi_cull_count = instance_shadow_cull_result.size();
 
 			for (uint32_t j = 0; j < sdfgi_cull_count; j++) {
 				Instance *ins = instance_shadow_cull_result[j];
@@ -2311,7 +2590,8 @@ void RenderingServerScene::_prepare_scene(const Transform p_cam_transform, const
 				}
 			}
 
-			RSG::scene_render->render_sdfgi(p_render_buffers, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, sdfgi_cull_count);
+			_reset_stale_lod_error_limits(instance_shadow_cull_result.ptr(), sdfgi_cull_count);
+			RSG::scene_render->render_sdfgi(p_render_buffers, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result.ptr(), sdfgi_cull_count);
 			//have to save updated cascades, then update static lights.
 		}
 
@@ -2356,7 +2636,7 @@ void RenderingServerScene::_render_scene(RID p_render_buffers, const Transform p
 	/* PROCESS GEOMETRY AND DRAW SCENE */
 
 	RENDER_TIMESTAMP("Render Scene ");
-	RSG::scene_render->render_scene(p_render_buffers, p_cam_transform, p_cam_projection, p_cam_orthogonal, (RasterizerScene::InstanceBase **)instance_cull_result, instance_cull_count, light_instance_cull_result, light_cull_count + directional_light_count, reflection_probe_instance_cull_result, reflection_probe_cull_count, gi_probe_instance_cull_result, gi_probe_cull_count, decal_instance_cull_result, decal_cull_count, (RasterizerScene::InstanceBase **)lightmap_cull_result, lightmap_cull_count, p_environment, camera_effects, p_shadow_atlas, p_reflection_probe.is_valid() ? RID() : scenario->reflection_atlas, p_reflection_probe, p_reflection_probe_pass);
+	RSG::scene_render->render_scene(p_render_buffers, p_cam_transform, p_cam_projection, p_cam_orthogonal, (RasterizerScene::InstanceBase **)instance_cull_result.ptr(), instance_cull_count, light_instance_cull_result, light_cull_count + directional_light_count, reflection_probe_instance_cull_result, reflection_probe_cull_count, gi_probe_instance_cull_result, gi_probe_cull_count, decal_instance_cull_result, decal_cull_count, (RasterizerScene::InstanceBase **)lightmap_cull_result, lightmap_cull_count, p_environment, camera_effects, p_shadow_atlas, p_reflection_probe.is_valid() ? RID() : scenario->reflection_atlas, p_reflection_probe, p_reflection_probe_pass);
 }
 
 void RenderingServerScene::render_empty_scene(RID p_render_buffers, RID p_scenario, RID p_shadow_atlas) {
@@ -2432,7 +2712,7 @@ bool RenderingServerScene::_render_reflection_probe_step(Instance *p_instance, i
 		}
 
 		RENDER_TIMESTAMP("Render Reflection Probe, Step " + itos(p_step));
-		_prepare_scene(xform, cm, false, false, RID(), RID(), RSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, use_shadows);
+		_prepare_scene(xform, cm, false, false, scenario->reflection_size, RID(), RID(), RSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, use_shadows);
 		_render_scene(RID(), xform, cm, false, RID(), RID(), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_step);
 
 	} else {
@@ -2642,35 +2922,33 @@ void RenderingServerScene::render_probes() {
 			update_lights = true;
 		}
 
-		instance_cull_count = 0;
+		instance_cull_result.clear();
 		for (List<InstanceGIProbeData::PairInfo>::Element *E = probe->dynamic_geometries.front(); E; E = E->next()) {
-			if (instance_cull_count < MAX_INSTANCE_CULL) {
-				Instance *ins = E->get().geometry;
-				if (!ins->visible) {
-					continue;
-				}
-				InstanceGeometryData *geom = (InstanceGeometryData *)ins->base_data;
-
-				if (geom->gi_probes_dirty) {
-					//giprobes may be dirty, so update
-					int l = 0;
-					//only called when reflection probe AABB enter/exit this geometry
-					ins->gi_probe_instances.resize(geom->gi_probes.size());
+			Instance *ins = E->get().geometry;
+			if (!ins->visible) {
+				continue;
+			}
+			InstanceGeometryData *geom = (InstanceGeometryData *)ins->base_data;
 
-					for (List<Instance *>::Element *F = geom->gi_probes.front(); F; F = F->next()) {
-						InstanceGIProbeData *gi_probe2 = static_cast<InstanceGIProbeData *>(F->get()->base_data);
+			if (geom->gi_probes_dirty) {
+				//giprobes may be dirty, so update
+				int l = 0;
+				//only called when reflection probe AABB enter/exit this geometry
+				ins->gi_probe_instances.resize(geom->gi_probes.size());
 
-						ins->gi_probe_instances.write[l++] = gi_probe2->probe_instance;
-					}
+				for (List<Instance *>::Element *F = geom->gi_probes.front(); F; F = F->next()) {
+					InstanceGIProbeData *gi_probe2 = static_cast<InstanceGIProbeData *>(F->get()->base_data);
 
-					geom->gi_probes_dirty = false;
+					ins->gi_probe_instances.write[l++] = gi_probe2->probe_instance;
 				}
 
-				instance_cull_result[instance_cull_count++] = E->get().geometry;
+				geom->gi_probes_dirty = false;
 			}
+
+			instance_cull_result.push_back(E->get().geometry);
 		}
 
-		RSG::scene_render->gi_probe_update(probe->probe_instance, update_lights, probe->light_instances, instance_cull_count, (RasterizerScene::InstanceBase **)instance_cull_result);
+		RSG::scene_render->gi_probe_update(probe->probe_instance, update_lights, probe->light_instances, instance_cull_result.size(), (RasterizerScene::InstanceBase **)instance_cull_result.ptr());
 
 		gi_probe_update_list.remove(gi_probe);
 
@@ -2928,6 +3206,106 @@ void RenderingServerScene::update_dirty_instances() {
 	}
 }
 
+/* TEXTURE STREAMING */
+
+void RenderingServerScene::_texture_stream_add_material(RID p_material, float p_screen_size) {
+	if (p_material.is_null()) {
+		return;
+	}
+	float *size = texture_stream_material_sizes.getptr(p_material);
+	if (size) {
+		*size = MAX(*size, p_screen_size);
+	} else {
+		texture_stream_material_sizes.set(p_material, p_screen_size);
+	}
+}
+
+void RenderingServerScene::_texture_stream_add_instance(Instance *p_instance, float p_screen_size) {
+	if (p_instance->material_override.is_valid()) {
+		_texture_stream_add_material(p_instance->material_override, p_screen_size);
+		return;
+	}
+
+	RID mesh;
+	switch (p_instance->base_type) {
+		case RS::INSTANCE_MESH: {
+			mesh = p_instance->base;
+		} break;
+		case RS::INSTANCE_MULTIMESH: {
+			mesh = RSG::storage->multimesh_get_mesh(p_instance->base);
+		} break;
+		case RS::INSTANCE_IMMEDIATE: {
+			_texture_stream_add_material(RSG::storage->immediate_get_material(p_instance->base), p_screen_size);
+		} break;
+		default: {
+		}
+	}
+
+	if (mesh.is_null()) {
+		return;
+	}
+
+	int surface_count = RSG::storage->mesh_get_surface_count(mesh);
+	for (int i = 0; i < surface_count; i++) {
+		RID material = i < p_instance->materials.size() ? p_instance->materials[i] : RID();
+		if (material.is_null()) {
+			material = RSG::storage->mesh_surface_get_material(mesh, i);
+		}
+		_texture_stream_add_material(material, p_screen_size);
+	}
+}
+
+void RenderingServerScene::texture_set_stream_feedback_enabled(RID p_texture, bool p_enable) {
+	if (p_enable) {
+		texture_stream_sizes.set(p_texture, 0.0);
+	} else {
+		texture_stream_sizes.erase(p_texture);
+	}
+}
+
+void RenderingServerScene::texture_set_stream_feedback_callback(RS::TextureStreamFeedbackCallback p_callback, void *p_userdata) {
+	texture_stream_feedback_callback = p_callback;
+	texture_stream_feedback_userdata = p_userdata;
+}
+
+void RenderingServerScene::update_texture_stream_feedback() {
+	if (texture_stream_material_sizes.empty()) {
+		return;
+	}
+
+	// Materials are only resolved to textures once per frame, however many instances use them.
+	List<RID> textures;
+	const RID *material = nullptr;
+	while ((material = texture_stream_material_sizes.next(material))) {
+		float material_size = texture_stream_material_sizes[*material];
+		textures.clear();
+		RSG::storage->material_get_textures(*material, &textures);
+		for (List<RID>::Element *E = textures.front(); E; E = E->next()) {
+			float *size = texture_stream_sizes.getptr(E->get());
+			if (size) {
+				*size = MAX(*size, material_size);
+			}
+		}
+	}
+	texture_stream_material_sizes.clear();
+
+	texture_stream_feedback_textures.clear();
+	texture_stream_feedback_sizes.clear();
+	const RID *texture = nullptr;
+	while ((texture = texture_stream_sizes.next(texture))) {
+		float &size = texture_stream_sizes[*texture];
+		if (size > 0.0) {
+			texture_stream_feedback_textures.push_back(*texture);
+			texture_stream_feedback_sizes.push_back(size);
+			size = 0.0;
+		}
+	}
+
+	if (texture_stream_feedback_callback && texture_stream_feedback_textures.size()) {
+		texture_stream_feedback_callback(texture_stream_feedback_userdata, texture_stream_feedback_textures.ptr(), texture_stream_feedback_sizes.ptr(), texture_stream_feedback_textures.size());
+	}
+}
+
 bool RenderingServerScene::free(RID p_rid) {
 	if (camera_owner.owns(p_rid)) {
 		Camera *camera = camera_owner.getornull(p_rid);
@@ -2953,6 +3331,10 @@ bool RenderingServerScene::free(RID p_rid) {
 
 		Instance *instance = instance_owner.getornull(p_rid);
 
+		instance_geometry_set_as_instance_lod(p_rid, RID());
+		while (instance->lod_children.front()) {
+			instance_geometry_set_as_instance_lod(instance->lod_children.front()->get()->self, RID());
+		}
 		instance_geometry_set_lightmap(p_rid, RID(), Rect2(), 0);
 		instance_set_scenario(p_rid, RID());
 		instance_set_base(p_rid, RID());
@@ -2965,6 +3347,8 @@ bool RenderingServerScene::free(RID p_rid) {
 		}
 		update_dirty_instances(); //in case something changed this
 
+		RSG::scene_render->instance_free_render_data(instance);
+
 		instance_owner.free(p_rid);
 		memdelete(instance);
 	} else {
@@ -2983,6 +3367,11 @@ RenderingServerScene *RenderingServerScene::singleton = nullptr;
 RenderingServerScene::RenderingServerScene() {
 	render_pass = 1;
 	singleton = this;
+
+	threaded_cull_minimum_instances = GLOBAL_DEF("rendering/limits/spatial_indexer/threaded_cull_minimum_instances", 1000);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/limits/spatial_indexer/threaded_cull_minimum_instances", PropertyInfo(Variant::INT, "rendering/limits/spatial_indexer/threaded_cull_minimum_instances", PROPERTY_HINT_RANGE, "0,65536,1,or_greater"));
+	mesh_lod_threshold = GLOBAL_DEF("rendering/quality/mesh_lod/threshold_pixels", 1.0);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/mesh_lod/threshold_pixels", PropertyInfo(Variant::FLOAT, "rendering/quality/mesh_lod/threshold_pixels", PROPERTY_HINT_RANGE, "0,16,0.01,or_greater"));
 }
 
 RenderingServerScene::~RenderingServerScene() {
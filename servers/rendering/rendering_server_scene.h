@@ -33,7 +33,9 @@
 
 #include "servers/rendering/rasterizer.h"
 
+#include "core/hash_map.h"
 #include "core/local_vector.h"
+#include "core/math/cull_bvh.h"
 #include "core/math/geometry_3d.h"
 #include "core/math/octree.h"
 #include "core/os/semaphore.h"
@@ -46,7 +48,6 @@ class RenderingServerScene {
 public:
 	enum {
 
-		MAX_INSTANCE_CULL = 65536,
 		MAX_LIGHTS_CULLED = 4096,
 		MAX_REFLECTION_PROBES_CULLED = 4096,
 		MAX_DECALS_CULLED = 4096,
@@ -112,7 +113,8 @@ public:
 		RS::ScenarioDebugMode debug;
 		RID self;
 
-		Octree<Instance, true> octree;
+		Octree<Instance, true> octree; // Used for pairing.
+		CullBVH<Instance> cull_bvh; // Used for culling, mask is the base type.
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -120,6 +122,7 @@ public:
 		RID camera_effects;
 		RID reflection_probe_shadow_atlas;
 		RID reflection_atlas;
+		int reflection_size = 0;
 
 		SelfList<Instance>::List instances;
 
@@ -151,6 +154,7 @@ public:
 		RID self;
 		//scenario stuff
 		OctreeElementID octree_id;
+		CullBVHElementID cull_id;
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -164,11 +168,16 @@ public:
 		float extra_margin;
 		ObjectID object_id;
 
+		// Visibility range, an instance with a LOD parent is only drawn while the parent is too close.
 		float lod_begin;
 		float lod_end;
 		float lod_begin_hysteresis;
 		float lod_end_hysteresis;
-		RID lod_instance;
+		Instance *lod_parent;
+		Set<Instance *> lod_children;
+		uint64_t lod_pass; // Last camera pass that updated the hysteresis state.
+		bool lod_too_close;
+		bool lod_too_far;
 
 		Vector<Color> lightmap_target_sh; //target is used for incrementally changing the SH over time, this avoids pops in some corner cases and when going interior <-> exterior
 
@@ -197,6 +206,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 			octree_id = 0;
+			cull_id = CULL_BVH_INVALID_ID;
 			scenario = nullptr;
 
 			update_aabb = false;
@@ -210,6 +220,10 @@ public:
 			lod_end = 0;
 			lod_begin_hysteresis = 0;
 			lod_end_hysteresis = 0;
+			lod_parent = nullptr;
+			lod_pass = 0;
+			lod_too_close = false;
+			lod_too_far = false;
 
 			last_render_pass = 0;
 			last_frame_pass = 0;
@@ -386,8 +400,33 @@ public:
 	};
 
 	int instance_cull_count;
-	Instance *instance_cull_result[MAX_INSTANCE_CULL];
-	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
+	LocalVector<Instance *> instance_cull_result;
+	LocalVector<Instance *> instance_shadow_cull_result;
+
+	// Shadow passes of a light (directional splits, omni sides) are culled together.
+	struct ShadowCullJob {
+		Vector<Plane> planes;
+		Vector3 range_origin;
+		LocalVector<Instance *> result;
+	};
+
+	enum {
+		MAX_SHADOW_CULL_JOBS = 6,
+	};
+
+	ShadowCullJob shadow_cull_jobs[MAX_SHADOW_CULL_JOBS];
+	uint32_t threaded_cull_minimum_instances = 1000;
+	float mesh_lod_threshold = 1.0;
+
+	uint64_t lod_range_pass = 0;
+
+	void _instance_update_cull_range(Instance *p_instance);
+	void _instance_get_lod_state(Instance *p_instance, const Vector3 &p_origin, bool p_update, bool &r_too_close, bool &r_too_far);
+	bool _instance_is_in_lod_range(Instance *p_instance, const Vector3 &p_origin, bool p_update);
+	void _reset_stale_lod_error_limits(Instance **p_instances, int p_count);
+
+	void _shadow_cull_job(uint32_t p_index, Scenario *p_scenario);
+	void _cull_shadow_jobs(Scenario *p_scenario, uint32_t p_count, const Vector3 &p_range_origin);
 	Instance *light_cull_result[MAX_LIGHTS_CULLED];
 	RID sdfgi_light_cull_result[MAX_LIGHTS_CULLED];
 	RID light_instance_cull_result[MAX_LIGHTS_CULLED];
@@ -411,6 +450,7 @@ public:
 	virtual void instance_set_scenario(RID p_instance, RID p_scenario);
 	virtual void instance_set_layer_mask(RID p_instance, uint32_t p_mask);
 	virtual void instance_set_transform(RID p_instance, const Transform &p_transform);
+	virtual void instances_set_transforms(const Vector<RID> &p_instances, const Vector<Transform> &p_transforms);
 	virtual void instance_attach_object_instance_id(RID p_instance, ObjectID p_id);
 	virtual void instance_set_blend_shape_weight(RID p_instance, int p_shape, float p_weight);
 	virtual void instance_set_surface_material(RID p_instance, int p_surface, RID p_material);
@@ -453,7 +493,7 @@ public:
 	RID _render_get_environment(RID p_camera, RID p_scenario);
 
 	bool _render_reflection_probe_step(Instance *p_instance, int p_step);
-	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, RID p_render_buffers, RID p_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows = true);
+	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, float p_viewport_height, RID p_render_buffers, RID p_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_using_shadows = true);
 	void _render_scene(RID p_render_buffers, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_environment, RID p_force_camera_effects, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass);
 	void render_empty_scene(RID p_render_buffers, RID p_scenario, RID p_shadow_atlas);
 
@@ -465,6 +505,24 @@ public:
 
 	TypedArray<Image> bake_render_uv2(RID p_base, const Vector<RID> &p_material_overrides, const Size2i &p_image_size);
 
+	/* TEXTURE STREAMING */
+
+	// Largest screen size of each texture with feedback enabled, and of each material, in the current frame.
+	HashMap<RID, float> texture_stream_sizes;
+	HashMap<RID, float> texture_stream_material_sizes;
+	LocalVector<RID> texture_stream_feedback_textures;
+	LocalVector<float> texture_stream_feedback_sizes;
+	RS::TextureStreamFeedbackCallback texture_stream_feedback_callback = nullptr;
+	void *texture_stream_feedback_userdata = nullptr;
+
+	void _texture_stream_add_material(RID p_material, float p_screen_size);
+	void _texture_stream_add_instance(Instance *p_instance, float p_screen_size);
+
+	void texture_set_stream_feedback_enabled(RID p_texture, bool p_enable);
+	void texture_set_stream_feedback_callback(RS::TextureStreamFeedbackCallback p_callback, void *p_userdata);
+	// Sends the sizes gathered by the camera passes of this frame, called once all viewports are drawn.
+	void update_texture_stream_feedback();
+
 	bool free(RID p_rid);
 
 	RenderingServerScene();
@@ -47,6 +47,46 @@ void RenderingServerWrapMT::thread_flush() {
 	atomic_decrement(&draw_pending);
 }
 
+void RenderingServerWrapMT::thread_canvas_items_set_transforms(const Vector<RID> &p_items, const Vector<Transform2D> &p_transforms) {
+	const RID *items = p_items.ptr();
+	const Transform2D *transforms = p_transforms.ptr();
+	for (int i = 0; i < p_items.size(); i++) {
+		rendering_server->canvas_item_set_transform(items[i], transforms[i]);
+	}
+}
+
+void RenderingServerWrapMT::_flush_pending_setters() {
+	if (Thread::get_caller_id() != Thread::get_main_id()) {
+		// Only the main thread defers setters.
+		return;
+	}
+
+	if (pending_instance_transforms.rids.size()) {
+		command_queue.push(rendering_server, &RenderingServer::instances_set_transforms, pending_instance_transforms.rids, pending_instance_transforms.values);
+		pending_instance_transforms.clear();
+	}
+
+	if (pending_canvas_item_transforms.rids.size()) {
+		command_queue.push(this, &RenderingServerWrapMT::thread_canvas_items_set_transforms, pending_canvas_item_transforms.rids, pending_canvas_item_transforms.values);
+		pending_canvas_item_transforms.clear();
+	}
+}
+
+void RenderingServerWrapMT::_pre_sync(void *p_self) {
+	// Anything waiting for the server must see the deferred setters applied.
+	static_cast<RenderingServerWrapMT *>(p_self)->_flush_pending_setters();
+}
+
+void RenderingServerWrapMT::free(RID p_rid) {
+	if (Thread::get_caller_id() != server_thread) {
+		// Deferred setters could refer to it.
+		_flush_pending_setters();
+		command_queue.push(rendering_server, &RenderingServer::free, p_rid);
+	} else {
+		rendering_server->free(p_rid);
+	}
+}
+
 void RenderingServerWrapMT::_thread_callback(void *_instance) {
 	RenderingServerWrapMT *vsmt = reinterpret_cast<RenderingServerWrapMT *>(_instance);
 
@@ -84,7 +124,15 @@ void RenderingServerWrapMT::sync() {
 }
 
 void RenderingServerWrapMT::draw(bool p_swap_buffers, double frame_step) {
+	uint64_t stall_count = command_queue.get_sync_stall_count();
+	uint64_t stall_usec = command_queue.get_sync_stall_usec();
+	frame_sync_stalls = stall_count - last_sync_stall_count;
+	frame_sync_stall_usec = stall_usec - last_sync_stall_usec;
+	last_sync_stall_count = stall_count;
+	last_sync_stall_usec = stall_usec;
+
 	if (create_thread) {
+		_flush_pending_setters();
 		atomic_increment(&draw_pending);
 		command_queue.push(this, &RenderingServerWrapMT::thread_draw, p_swap_buffers, frame_step);
 	} else {
@@ -136,6 +184,7 @@ void RenderingServerWrapMT::finish() {
 	canvas_occluder_polygon_free_cached_ids();
 
 	if (thread) {
+		_flush_pending_setters();
 		command_queue.push(this, &RenderingServerWrapMT::thread_exit);
 		Thread::wait_to_finish(thread);
 		memdelete(thread);
@@ -163,6 +212,7 @@ RenderingServerWrapMT::RenderingServerWrapMT(RenderingServer *p_contained, bool
 	draw_pending = 0;
 	draw_thread_up = false;
 	pool_max_size = GLOBAL_GET("memory/limits/multithreaded_server/rid_pool_prealloc");
+	command_queue.set_pre_sync_callback(_pre_sync, this);
 
 	if (!p_create_thread) {
 		server_thread = Thread::get_caller_id();
@@ -32,6 +32,7 @@
 #define RENDERING_SERVER_WRAP_MT_H
 
 #include "core/command_queue_mt.h"
+#include "core/hash_map.h"
 #include "core/os/thread.h"
 #include "servers/rendering_server.h"
 
@@ -60,6 +61,44 @@ class RenderingServerWrapMT : public RenderingServer {
 
 	int pool_max_size;
 
+	// Transforms set from the main thread are kept until the next draw or
+	// synchronous call, so only the last one set in a frame is sent.
+	template <class T>
+	struct PendingSetters {
+		HashMap<RID, int> indices;
+		Vector<RID> rids;
+		Vector<T> values;
+
+		void set(RID p_rid, const T &p_value) {
+			const int *index = indices.getptr(p_rid);
+			if (index) {
+				values.write[*index] = p_value;
+			} else {
+				indices[p_rid] = rids.size();
+				rids.push_back(p_rid);
+				values.push_back(p_value);
+			}
+		}
+
+		void clear() {
+			indices.clear();
+			rids = Vector<RID>();
+			values = Vector<T>();
+		}
+	};
+
+	PendingSetters<Transform> pending_instance_transforms;
+	PendingSetters<Transform2D> pending_canvas_item_transforms;
+
+	void _flush_pending_setters();
+	static void _pre_sync(void *p_self);
+	void thread_canvas_items_set_transforms(const Vector<RID> &p_items, const Vector<Transform2D> &p_transforms);
+
+	uint64_t last_sync_stall_count = 0;
+	uint64_t last_sync_stall_usec = 0;
+	int frame_sync_stalls = 0;
+	int frame_sync_stall_usec = 0;
+
 	//#define DEBUG_SYNC
 
 	static RenderingServerWrapMT *singleton_mt;
@@ -116,6 +155,9 @@ public:
 
 	FUNC2(texture_set_force_redraw_if_visible, RID, bool)
 
+	FUNC2(texture_set_stream_feedback_enabled, RID, bool)
+	FUNC2(texture_set_stream_feedback_callback, TextureStreamFeedbackCallback, void *)
+
 	/* SHADER API */
 
 	FUNCRID(shader)
@@ -518,7 +560,16 @@ public:
 	FUNC2(instance_set_base, RID, RID)
 	FUNC2(instance_set_scenario, RID, RID)
 	FUNC2(instance_set_layer_mask, RID, uint32_t)
-	FUNC2(instance_set_transform, RID, const Transform &)
+	virtual void instance_set_transform(RID p_instance, const Transform &p_transform) {
+		if (Thread::get_caller_id() == server_thread) {
+			rendering_server->instance_set_transform(p_instance, p_transform);
+		} else if (Thread::get_caller_id() == Thread::get_main_id()) {
+			pending_instance_transforms.set(p_instance, p_transform);
+		} else {
+			command_queue.push(rendering_server, &RenderingServer::instance_set_transform, p_instance, p_transform);
+		}
+	}
+	FUNC2(instances_set_transforms, const Vector<RID> &, const Vector<Transform> &)
 	FUNC2(instance_attach_object_instance_id, RID, ObjectID)
 	FUNC3(instance_set_blend_shape_weight, RID, int, float)
 	FUNC3(instance_set_surface_material, RID, int, RID)
@@ -569,7 +620,15 @@ public:
 
 	FUNC2(canvas_item_set_update_when_visible, RID, bool)
 
-	FUNC2(canvas_item_set_transform, RID, const Transform2D &)
+	virtual void canvas_item_set_transform(RID p_item, const Transform2D &p_transform) {
+		if (Thread::get_caller_id() == server_thread) {
+			rendering_server->canvas_item_set_transform(p_item, p_transform);
+		} else if (Thread::get_caller_id() == Thread::get_main_id()) {
+			pending_canvas_item_transforms.set(p_item, p_transform);
+		} else {
+			command_queue.push(rendering_server, &RenderingServer::canvas_item_set_transform, p_item, p_transform);
+		}
+	}
 	FUNC2(canvas_item_set_clip, RID, bool)
 	FUNC2(canvas_item_set_distance_field_mode, RID, bool)
 	FUNC3(canvas_item_set_custom_rect, RID, bool, const Rect2 &)
@@ -665,7 +724,7 @@ public:
 
 	/* FREE */
 
-	FUNC1(free, RID)
+	virtual void free(RID p_rid);
 
 	/* EVENT QUEUING */
 
@@ -681,7 +740,14 @@ public:
 
 	//this passes directly to avoid stalling
 	virtual int get_render_info(RenderInfo p_info) {
-		return rendering_server->get_render_info(p_info);
+		switch (p_info) {
+			case INFO_SYNC_STALLS_IN_FRAME:
+				return frame_sync_stalls;
+			case INFO_SYNC_STALL_TIME_IN_FRAME:
+				return frame_sync_stall_usec;
+			default:
+				return rendering_server->get_render_info(p_info);
+		}
 	}
 
 	virtual String get_video_adapter_name() const {
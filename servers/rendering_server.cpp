@@ -367,17 +367,37 @@ Error RenderingServer::_surface_set_data(Array p_arrays, uint32_t p_format, uint
 					// setting vertices means regenerating the AABB
 					AABB aabb;
 
-					{
+					for (int i = 0; i < p_vertex_array_len; i++) {
+						if (i == 0) {
+							aabb = AABB(src[i], SMALL_VEC3);
+						} else {
+							aabb.expand_to(src[i]);
+						}
+					}
+
+					if (p_format & ARRAY_COMPRESS_VERTEX) {
+						// Quantized to the AABB, the renderer gets the same AABB to undo it.
+						Vector3 inv_size;
+						for (int j = 0; j < 3; j++) {
+							inv_size[j] = aabb.size[j] > 0 ? 1.0 / aabb.size[j] : 0.0;
+						}
+
+						for (int i = 0; i < p_vertex_array_len; i++) {
+							Vector3 v = (src[i] - aabb.position) * inv_size;
+							uint16_t vector[4] = {
+								(uint16_t)CLAMP(Math::fast_ftoi(v.x * 65535), 0, 65535),
+								(uint16_t)CLAMP(Math::fast_ftoi(v.y * 65535), 0, 65535),
+								(uint16_t)CLAMP(Math::fast_ftoi(v.z * 65535), 0, 65535),
+								0,
+							};
+
+							copymem(&vw[p_offsets[ai] + i * p_stride], vector, sizeof(uint16_t) * 4);
+						}
+					} else {
 						for (int i = 0; i < p_vertex_array_len; i++) {
 							float vector[3] = { src[i].x, src[i].y, src[i].z };
 
 							copymem(&vw[p_offsets[ai] + i * p_stride], vector, sizeof(float) * 3);
-
-							if (i == 0) {
-								aabb = AABB(src[i], SMALL_VEC3);
-							} else {
-								aabb.expand_to(src[i]);
-							}
 						}
 					}
 
@@ -395,7 +415,18 @@ Error RenderingServer::_surface_set_data(Array p_arrays, uint32_t p_format, uint
 
 				// setting vertices means regenerating the AABB
 
-				if (p_format & ARRAY_COMPRESS_NORMAL) {
+				if ((p_format & ARRAY_COMPRESS_NORMAL) && (p_format & ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION)) {
+					for (int i = 0; i < p_vertex_array_len; i++) {
+						Vector2 oct = src[i].octahedron_encode();
+						int16_t vector[2] = {
+							(int16_t)CLAMP(Math::fast_ftoi(oct.x * 32767), -32767, 32767),
+							(int16_t)CLAMP(Math::fast_ftoi(oct.y * 32767), -32767, 32767),
+						};
+
+						copymem(&vw[p_offsets[ai] + i * p_stride], vector, 4);
+					}
+
+				} else if (p_format & ARRAY_COMPRESS_NORMAL) {
 					for (int i = 0; i < p_vertex_array_len; i++) {
 						int8_t vector[4] = {
 							(int8_t)CLAMP(src[i].x * 127, -128, 127),
@@ -425,7 +456,19 @@ Error RenderingServer::_surface_set_data(Array p_arrays, uint32_t p_format, uint
 
 				const real_t *src = array.ptr();
 
-				if (p_format & ARRAY_COMPRESS_TANGENT) {
+				if ((p_format & ARRAY_COMPRESS_TANGENT) && (p_format & ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION)) {
+					for (int i = 0; i < p_vertex_array_len; i++) {
+						Vector3 tangent(src[i * 4 + 0], src[i * 4 + 1], src[i * 4 + 2]);
+						Vector2 oct = tangent.octahedron_tangent_encode(src[i * 4 + 3]);
+						int16_t vector[2] = {
+							(int16_t)CLAMP(Math::fast_ftoi(oct.x * 32767), -32767, 32767),
+							(int16_t)CLAMP(Math::fast_ftoi(oct.y * 32767), -32767, 32767),
+						};
+
+						copymem(&vw[p_offsets[ai] + i * p_stride], vector, 4);
+					}
+
+				} else if (p_format & ARRAY_COMPRESS_TANGENT) {
 					for (int i = 0; i < p_vertex_array_len; i++) {
 						int8_t xyzw[4] = {
 							(int8_t)CLAMP(src[i * 4 + 0] * 127, -128, 127),
@@ -679,13 +722,11 @@ uint32_t RenderingServer::mesh_surface_make_offsets_from_format(uint32_t p_forma
 		switch (i) {
 			case RS::ARRAY_VERTEX: {
 				if (p_format & ARRAY_FLAG_USE_2D_VERTICES) {
-					elem_size = 2;
+					elem_size = 2 * sizeof(float);
+				} else if (p_format & ARRAY_COMPRESS_VERTEX) {
+					elem_size = 4 * sizeof(uint16_t);
 				} else {
-					elem_size = 3;
-				}
-
-				{
-					elem_size *= sizeof(float);
+					elem_size = 3 * sizeof(float);
 				}
 
 				if (elem_size == 6) {
@@ -840,17 +881,22 @@ Error RenderingServer::mesh_create_surface_data_from_arrays(SurfaceData *r_surfa
 			case RS::ARRAY_VERTEX: {
 				Variant arr = p_arrays[0];
 				if (arr.get_type() == Variant::PACKED_VECTOR2_ARRAY) {
-					elem_size = 2;
 					p_compress_format |= ARRAY_FLAG_USE_2D_VERTICES;
 				} else if (arr.get_type() == Variant::PACKED_VECTOR3_ARRAY) {
 					p_compress_format &= ~ARRAY_FLAG_USE_2D_VERTICES;
-					elem_size = 3;
-				} else {
-					elem_size = (p_compress_format & ARRAY_FLAG_USE_2D_VERTICES) ? 2 : 3;
 				}
 
-				{
-					elem_size *= sizeof(float);
+				// Quantized positions can't be updated in place, and blend shapes may go outside the AABB.
+				if ((p_compress_format & (ARRAY_FLAG_USE_2D_VERTICES | ARRAY_FLAG_USE_DYNAMIC_UPDATE)) || p_blend_shapes.size()) {
+					p_compress_format &= ~ARRAY_COMPRESS_VERTEX;
+				}
+
+				if (p_compress_format & ARRAY_FLAG_USE_2D_VERTICES) {
+					elem_size = 2 * sizeof(float);
+				} else if (p_compress_format & ARRAY_COMPRESS_VERTEX) {
+					elem_size = 4 * sizeof(uint16_t);
+				} else {
+					elem_size = 3 * sizeof(float);
 				}
 
 			} break;
@@ -1024,7 +1070,7 @@ void RenderingServer::mesh_add_surface_from_arrays(RID p_mesh, PrimitiveType p_p
 	mesh_add_surface(p_mesh, sd);
 }
 
-Array RenderingServer::_get_array_from_surface(uint32_t p_format, Vector<uint8_t> p_vertex_data, int p_vertex_len, Vector<uint8_t> p_index_data, int p_index_len) const {
+Array RenderingServer::_get_array_from_surface(uint32_t p_format, Vector<uint8_t> p_vertex_data, int p_vertex_len, Vector<uint8_t> p_index_data, int p_index_len, const AABB &p_aabb) const {
 	uint32_t offsets[ARRAY_MAX];
 
 	int total_elem_size = 0;
@@ -1041,13 +1087,11 @@ Array RenderingServer::_get_array_from_surface(uint32_t p_format, Vector<uint8_t
 		switch (i) {
 			case RS::ARRAY_VERTEX: {
 				if (p_format & ARRAY_FLAG_USE_2D_VERTICES) {
-					elem_size = 2;
+					elem_size = 2 * sizeof(float);
+				} else if (p_format & ARRAY_COMPRESS_VERTEX) {
+					elem_size = 4 * sizeof(uint16_t);
 				} else {
-					elem_size = 3;
-				}
-
-				{
-					elem_size *= sizeof(float);
+					elem_size = 3 * sizeof(float);
 				}
 
 			} break;
@@ -1154,7 +1198,15 @@ Array RenderingServer::_get_array_from_surface(uint32_t p_format, Vector<uint8_t
 					Vector<Vector3> arr_3d;
 					arr_3d.resize(p_vertex_len);
 
-					{
+					if (p_format & ARRAY_COMPRESS_VERTEX) {
+						Vector3 *w = arr_3d.ptrw();
+						Vector3 scale = p_aabb.size / 65535.0;
+
+						for (int j = 0; j < p_vertex_len; j++) {
+							const uint16_t *v = (const uint16_t *)&r[j * total_elem_size + offsets[i]];
+							w[j] = p_aabb.position + Vector3(v[0], v[1], v[2]) * scale;
+						}
+					} else {
 						Vector3 *w = arr_3d.ptrw();
 
 						for (int j = 0; j < p_vertex_len; j++) {
@@ -1171,7 +1223,15 @@ Array RenderingServer::_get_array_from_surface(uint32_t p_format, Vector<uint8_t
 				Vector<Vector3> arr;
 				arr.resize(p_vertex_len);
 
-				if (p_format & ARRAY_COMPRESS_NORMAL) {
+				if ((p_format & ARRAY_COMPRESS_NORMAL) && (p_format & ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION)) {
+					Vector3 *w = arr.ptrw();
+					const float multiplier = 1.f / 32767.f;
+
+					for (int j = 0; j < p_vertex_len; j++) {
+						const int16_t *v = (const int16_t *)&r[j * total_elem_size + offsets[i]];
+						w[j] = Vector3::octahedron_decode(Vector2(float(v[0]) * multiplier, float(v[1]) * multiplier));
+					}
+				} else if (p_format & ARRAY_COMPRESS_NORMAL) {
 					Vector3 *w = arr.ptrw();
 					const float multiplier = 1.f / 127.f;
 
@@ -1195,7 +1255,20 @@ Array RenderingServer::_get_array_from_surface(uint32_t p_format, Vector<uint8_t
 			case RS::ARRAY_TANGENT: {
 				Vector<float> arr;
 				arr.resize(p_vertex_len * 4);
-				if (p_format & ARRAY_COMPRESS_TANGENT) {
+				if ((p_format & ARRAY_COMPRESS_TANGENT) && (p_format & ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION)) {
+					float *w = arr.ptrw();
+					const float multiplier = 1.f / 32767.f;
+
+					for (int j = 0; j < p_vertex_len; j++) {
+						const int16_t *v = (const int16_t *)&r[j * total_elem_size + offsets[i]];
+						real_t sign;
+						Vector3 tangent = Vector3::octahedron_tangent_decode(Vector2(float(v[0]) * multiplier, float(v[1]) * multiplier), &sign);
+						w[j * 4 + 0] = tangent.x;
+						w[j * 4 + 1] = tangent.y;
+						w[j * 4 + 2] = tangent.z;
+						w[j * 4 + 3] = sign;
+					}
+				} else if (p_format & ARRAY_COMPRESS_TANGENT) {
 					float *w = arr.ptrw();
 
 					for (int j = 0; j < p_vertex_len; j++) {
@@ -1372,7 +1445,7 @@ Dictionary RenderingServer::mesh_surface_get_lods(RID p_mesh, int p_surface) con
 			const uint16_t *rptr = (const uint16_t *)r;
 			int *w = lods.ptrw();
 			for (uint32_t j = 0; j < lc; j++) {
-				w[j] = rptr[i];
+				w[j] = rptr[j];
 			}
 		} else {
 			uint32_t lc = sd.lods[i].index_data.size() / 4;
@@ -1381,7 +1454,7 @@ Dictionary RenderingServer::mesh_surface_get_lods(RID p_mesh, int p_surface) con
 			const uint32_t *rptr = (const uint32_t *)r;
 			int *w = lods.ptrw();
 			for (uint32_t j = 0; j < lc; j++) {
-				w[j] = rptr[i];
+				w[j] = rptr[j];
 			}
 		}
 
@@ -1408,7 +1481,7 @@ Array RenderingServer::mesh_surface_get_blend_shape_arrays(RID p_mesh, int p_sur
 		Array blend_shape_array;
 		blend_shape_array.resize(blend_shape_data.size());
 		for (int i = 0; i < blend_shape_data.size(); i++) {
-			blend_shape_array.set(i, _get_array_from_surface(format, blend_shape_data[i], vertex_len, index_data, index_len));
+			blend_shape_array.set(i, _get_array_from_surface(format, blend_shape_data[i], vertex_len, index_data, index_len, sd.aabb));
 		}
 
 		return blend_shape_array;
@@ -1428,7 +1501,7 @@ Array RenderingServer::mesh_create_arrays_from_surface_data(const SurfaceData &p
 
 	uint32_t format = p_data.format;
 
-	return _get_array_from_surface(format, vertex_data, vertex_len, index_data, index_len);
+	return _get_array_from_surface(format, vertex_data, vertex_len, index_data, index_len, p_data.aabb);
 }
 #if 0
 Array RenderingServer::_mesh_surface_get_skeleton_aabb_bind(RID p_mesh, int p_surface) const {
@@ -1943,6 +2016,7 @@ void RenderingServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(ARRAY_FORMAT_WEIGHTS);
 	BIND_ENUM_CONSTANT(ARRAY_FORMAT_INDEX);
 
+	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_VERTEX);
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_NORMAL);
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_TANGENT);
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_COLOR);
@@ -1952,6 +2026,7 @@ void RenderingServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(ARRAY_COMPRESS_DEFAULT);
 
 	BIND_ENUM_CONSTANT(ARRAY_FLAG_USE_2D_VERTICES);
+	BIND_ENUM_CONSTANT(ARRAY_FLAG_USE_OCTAHEDRAL_COMPRESSION);
 	BIND_ENUM_CONSTANT(ARRAY_FLAG_USE_DYNAMIC_UPDATE);
 
 	BIND_ENUM_CONSTANT(PRIMITIVE_POINTS);
@@ -2238,6 +2313,11 @@ void RenderingServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_VIDEO_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_TEXTURE_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_VERTEX_MEM_USED);
+	BIND_ENUM_CONSTANT(INFO_SYNC_STALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_SYNC_STALL_TIME_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_INSTANCE_TRANSFORMS_UPLOADED_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_INSTANCE_DATA_BYTES_UPLOADED_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_2D_BATCHES_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(FEATURE_SHADERS);
 	BIND_ENUM_CONSTANT(FEATURE_MULTITHREADED);
@@ -0,0 +1,286 @@
+/*************************************************************************/
+/*  test_audio_decode_ahead.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_AUDIO_DECODE_AHEAD_H
+#define TEST_AUDIO_DECODE_AHEAD_H
+
+#include "core/os/os.h"
+#include "servers/audio/audio_decode_ahead.h"
+#include "tests/test_audio_voices.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAudioDecodeAhead {
+
+using TestAudioVoices::TestAudio;
+
+// "Decodes" frames holding their own index, so gaps and repeats are easy to spot.
+class TestRampPlayback : public AudioStreamPlaybackDecodeAhead {
+	int64_t position = 0;
+	int64_t length = 0;
+	int decode_usec = 0;
+	int work_per_frame = 0;
+
+protected:
+	virtual void _decode_seek(float p_time) override {
+		position = int64_t(p_time * 44100);
+		decoded.store(0);
+		seeks.fetch_add(1);
+	}
+
+	virtual int _decode(AudioFrame *p_buffer, int p_frames) override {
+		if (decode_usec) {
+			OS::get_singleton()->delay_usec(decode_usec);
+		}
+		int frames = length ? MIN(int64_t(p_frames), length - position) : p_frames;
+		for (int i = 0; i < frames; i++) {
+			float v = position + i;
+			// Stand-in for the cost of a real decoder.
+			for (int j = 0; j < work_per_frame; j++) {
+				v += Math::sin(v) * 1e-30;
+			}
+			p_buffer[i] = AudioFrame(v, v);
+		}
+		position += frames;
+		decoded.fetch_add(frames);
+		return frames;
+	}
+
+	virtual float get_stream_sampling_rate() override {
+		return 44100;
+	}
+
+public:
+	std::atomic<int64_t> decoded; // Since the last seek.
+	std::atomic<int> seeks;
+	int requested_seeks = 0;
+
+	virtual int get_loop_count() const override {
+		return 0;
+	}
+	virtual float get_playback_position() const override {
+		return get_start_position() + get_frames_played() / 44100.0;
+	}
+
+	virtual void start(float p_from_pos = 0.0) override {
+		requested_seeks++;
+		AudioStreamPlaybackDecodeAhead::start(p_from_pos);
+	}
+	virtual void seek(float p_time) override {
+		requested_seeks++;
+		AudioStreamPlaybackDecodeAhead::seek(p_time);
+	}
+
+	// Mixes without resampling, to see the decoded frames as they are.
+	void read(AudioFrame *p_buffer, int p_frames) {
+		_mix_internal(p_buffer, p_frames);
+	}
+
+	// Waits for the decode thread to get p_frames ahead of what was read.
+	bool wait_for(int64_t p_frames) {
+		if (!AudioDecodePool::get_singleton()->get_thread_count()) {
+			return true; // Decoded as it's read.
+		}
+		for (int i = 0; i < 1000; i++) {
+			if (seeks.load() == requested_seeks && decoded.load() >= int64_t(get_frames_played()) + p_frames) {
+				return true;
+			}
+			OS::get_singleton()->delay_usec(1000);
+		}
+		return false;
+	}
+
+	TestRampPlayback(int64_t p_length, int p_decode_usec = 0, int p_work_per_frame = 0) {
+		length = p_length;
+		decode_usec = p_decode_usec;
+		work_per_frame = p_work_per_frame;
+		decoded.store(0);
+		seeks.store(0);
+		_init_decode_ahead(44100);
+	}
+};
+
+static bool is_ramp(const Vector<AudioFrame> &p_frames, float p_from) {
+	for (int i = 0; i < p_frames.size(); i++) {
+		if (p_frames[i].l != p_from + i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[AudioDecodeAhead] Playback reads the decoded frames in order") {
+	TestAudio audio;
+	AudioDecodePool *pool = AudioDecodePool::get_singleton();
+	REQUIRE(pool);
+
+	for (int threads = 0; threads <= 2; threads += 2) {
+		pool->finish();
+		pool->init(threads, 50);
+
+		Ref<TestRampPlayback> playback = memnew(TestRampPlayback(0));
+		playback->start(0);
+		// Starting mixes the first frames into the resampler.
+		int64_t expected = 256;
+
+		Vector<AudioFrame> frames;
+		frames.resize(1000);
+		bool ramp = true;
+		// Several times the ring buffer size, so it wraps around.
+		for (int i = 0; i < 20; i++) {
+			CHECK(playback->wait_for(frames.size()));
+			playback->read(frames.ptrw(), frames.size());
+			ramp = ramp && is_ramp(frames, expected);
+			expected += frames.size();
+		}
+		CHECK(ramp);
+
+		// Frames decoded before the seek are dropped.
+		playback->seek(1.0);
+		CHECK(playback->wait_for(frames.size()));
+		playback->read(frames.ptrw(), frames.size());
+		CHECK(is_ramp(frames, 44100));
+		CHECK(playback->get_playback_position() == doctest::Approx(1.0 + 1000 / 44100.0));
+
+		CHECK(playback->get_underrun_count() == 0);
+	}
+
+	pool->finish();
+	pool->init(1, 250);
+}
+
+TEST_CASE("[AudioDecodeAhead] Playback stops at the end of the stream") {
+	TestAudio audio;
+
+	Ref<TestRampPlayback> playback = memnew(TestRampPlayback(3000));
+	playback->start(0);
+
+	Vector<AudioFrame> frames;
+	frames.resize(2000);
+	CHECK(playback->wait_for(2744));
+	playback->read(frames.ptrw(), frames.size());
+	CHECK(playback->is_playing());
+	playback->read(frames.ptrw(), frames.size());
+	CHECK(!playback->is_playing());
+	CHECK(frames[743].l == 2999);
+	CHECK(frames[744].l == 0);
+	CHECK(playback->get_underrun_count() == 0);
+}
+
+TEST_CASE("[AudioDecodeAhead] Late decoding is counted as underruns") {
+	TestAudio audio;
+	uint64_t before = AudioServer::get_singleton()->get_decode_underrun_count();
+
+	// Slow enough that reading right after starting runs out of the primed frames.
+	Ref<TestRampPlayback> playback = memnew(TestRampPlayback(0, 50000));
+	playback->start(0);
+
+	Vector<AudioFrame> frames;
+	frames.resize(1024);
+	playback->read(frames.ptrw(), frames.size());
+
+	CHECK(playback->get_underrun_count() == 1);
+	CHECK(AudioServer::get_singleton()->get_decode_underrun_count() == before + 1);
+	// What was primed is still played, then silence.
+	CHECK(frames[0].l == 256);
+	CHECK(frames[255].l == 511);
+	CHECK(frames[256].l == 0);
+
+	playback->stop();
+	CHECK(!playback->is_playing());
+}
+
+TEST_CASE("[AudioDecodeAhead] Synchronous playback decodes everything it mixes") {
+	TestAudio audio;
+	uint64_t before = AudioServer::get_singleton()->get_decode_underrun_count();
+
+	// Slow decoding, mixed in chunks larger than the ring buffer, like waveform previews do.
+	Ref<TestRampPlayback> playback = memnew(TestRampPlayback(0, 1000));
+	playback->set_synchronous(true);
+	playback->start(0);
+
+	Vector<AudioFrame> frames;
+	frames.resize(44100);
+	playback->read(frames.ptrw(), frames.size());
+	CHECK(is_ramp(frames, 256));
+	playback->read(frames.ptrw(), frames.size());
+	CHECK(is_ramp(frames, 256 + 44100));
+
+	CHECK(playback->get_underrun_count() == 0);
+	CHECK(AudioServer::get_singleton()->get_decode_underrun_count() == before);
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[AudioDecodeAhead] Benchmark decoding on the audio thread" * doctest::skip()) {
+	const int streams = 16;
+	const int buffers = 43;
+	const int frames = 1024;
+
+	TestAudio audio;
+	AudioDecodePool *pool = AudioDecodePool::get_singleton();
+	Vector<AudioFrame> buffer;
+	buffer.resize(frames);
+
+	float real_time[2];
+	for (int i = 0; i < 2; i++) {
+		pool->finish();
+		pool->init(i == 0 ? 0 : 1, 250);
+
+		Vector<Ref<TestRampPlayback>> playbacks;
+		for (int j = 0; j < streams; j++) {
+			Ref<TestRampPlayback> playback = memnew(TestRampPlayback(0, 0, 8));
+			playback->start(0);
+			playbacks.push_back(playback);
+		}
+
+		// Only the time spent by the audio thread counts, waiting stands for the time between mixes.
+		uint64_t usec = 0;
+		for (int j = 0; j < buffers; j++) {
+			for (int k = 0; k < streams; k++) {
+				playbacks.write[k]->wait_for(frames);
+			}
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			for (int k = 0; k < streams; k++) {
+				playbacks.write[k]->read(buffer.ptrw(), frames);
+			}
+			usec += OS::get_singleton()->get_ticks_usec() - begin;
+		}
+		real_time[i] = usec / (audio.mix_time(buffers) * 1000000.0);
+	}
+
+	pool->finish();
+	pool->init(1, 250);
+
+	MESSAGE(vformat("%d compressed streams: %.2f%% of real time on the audio thread decoding inline, %.2f%% decoding ahead.", streams, real_time[0] * 100, real_time[1] * 100).utf8().get_data());
+}
+
+} // namespace TestAudioDecodeAhead
+
+#endif // TEST_AUDIO_DECODE_AHEAD_H
@@ -0,0 +1,318 @@
+/*************************************************************************/
+/*  test_audio_mix.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_AUDIO_MIX_H
+#define TEST_AUDIO_MIX_H
+
+#include "core/math/random_number_generator.h"
+#include "core/project_settings.h"
+#include "servers/audio/audio_mix_kernels.h"
+#include "servers/audio/effects/audio_effect_eq.h"
+#include "servers/audio/effects/audio_effect_filter.h"
+#include "servers/audio/effects/audio_effect_reverb.h"
+#include "tests/test_audio_voices.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAudioMix {
+
+using TestAudioVoices::make_sample;
+using TestAudioVoices::TestAudio;
+
+// Odd on purpose, so the scalar tail of every kernel runs too.
+static const int TEST_FRAMES = 1023;
+
+static Vector<AudioFrame> make_noise(int p_frames, float p_amplitude, uint64_t p_seed) {
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(p_seed);
+
+	Vector<AudioFrame> frames;
+	frames.resize(p_frames);
+	for (int i = 0; i < p_frames; i++) {
+		frames.write[i] = AudioFrame(rng->randf_range(-p_amplitude, p_amplitude), rng->randf_range(-p_amplitude, p_amplitude));
+	}
+	return frames;
+}
+
+static bool frames_equal(const Vector<AudioFrame> &p_a, const Vector<AudioFrame> &p_b) {
+	return memcmp(p_a.ptr(), p_b.ptr(), p_a.size() * sizeof(AudioFrame)) == 0;
+}
+
+static float max_difference(const Vector<AudioFrame> &p_a, const Vector<AudioFrame> &p_b) {
+	float diff = 0;
+	for (int i = 0; i < p_a.size(); i++) {
+		diff = MAX(diff, ABS(p_a[i].l - p_b[i].l));
+		diff = MAX(diff, ABS(p_a[i].r - p_b[i].r));
+	}
+	return diff;
+}
+
+// Runs the same buffers through two instances of an effect, one with the SIMD
+// kernels and one without, and returns the largest difference between them.
+static float compare_effect(Ref<AudioEffect> p_effect) {
+	Ref<AudioEffectInstance> simd = p_effect->instance();
+	Ref<AudioEffectInstance> scalar = p_effect->instance();
+
+	float diff = 0;
+	for (int i = 0; i < 8; i++) {
+		Vector<AudioFrame> src = make_noise(TEST_FRAMES, 0.5, i);
+		Vector<AudioFrame> dst_simd;
+		Vector<AudioFrame> dst_scalar;
+		dst_simd.resize(TEST_FRAMES);
+		dst_scalar.resize(TEST_FRAMES);
+
+		AudioMixKernels::set_simd_enabled(true);
+		simd->process(src.ptr(), dst_simd.ptrw(), TEST_FRAMES);
+		AudioMixKernels::set_simd_enabled(false);
+		scalar->process(src.ptr(), dst_scalar.ptrw(), TEST_FRAMES);
+
+		diff = MAX(diff, max_difference(dst_simd, dst_scalar));
+	}
+	AudioMixKernels::set_simd_enabled(true);
+	return diff;
+}
+
+TEST_CASE("[AudioMix] SIMD kernels match the scalar kernels") {
+	Vector<AudioFrame> src = make_noise(TEST_FRAMES, 1.5, 1);
+	Vector<AudioFrame> base = make_noise(TEST_FRAMES, 0.5, 2);
+	Vector<AudioFrame> results[2];
+
+	SUBCASE("Clear and add") {
+		for (int i = 0; i < 2; i++) {
+			AudioMixKernels::set_simd_enabled(i == 0);
+			results[i] = base;
+			AudioMixKernels::add(results[i].ptrw(), src.ptr(), TEST_FRAMES);
+		}
+		CHECK(frames_equal(results[0], results[1]));
+
+		AudioMixKernels::set_simd_enabled(true);
+		AudioMixKernels::clear(results[0].ptrw(), TEST_FRAMES);
+		bool cleared = true;
+		for (int i = 0; i < TEST_FRAMES; i++) {
+			cleared = cleared && results[0][i].l == 0 && results[0][i].r == 0;
+		}
+		CHECK(cleared);
+	}
+
+	SUBCASE("Volume ramp") {
+		for (int i = 0; i < 2; i++) {
+			AudioMixKernels::set_simd_enabled(i == 0);
+			results[i] = base;
+			AudioMixKernels::add_ramp(results[i].ptrw(), src.ptr(), TEST_FRAMES, AudioFrame(1, 0), AudioFrame(-1.0 / TEST_FRAMES, 0.5 / TEST_FRAMES));
+		}
+		// The SIMD path steps the volume two frames at a time, so it may round differently.
+		CHECK(max_difference(results[0], results[1]) < 1e-5);
+	}
+
+	SUBCASE("Volume and peak") {
+		AudioFrame peaks[2];
+		for (int i = 0; i < 2; i++) {
+			AudioMixKernels::set_simd_enabled(i == 0);
+			results[i] = src;
+			peaks[i] = AudioMixKernels::scale_and_peak(results[i].ptrw(), TEST_FRAMES, 0.7);
+		}
+		CHECK(frames_equal(results[0], results[1]));
+		CHECK(peaks[0].l == peaks[1].l);
+		CHECK(peaks[0].r == peaks[1].r);
+		CHECK(peaks[0].l > 0.7);
+	}
+
+	SUBCASE("Conversion to 32 bits") {
+		for (int stride = 2; stride <= 4; stride += 2) {
+			Vector<int32_t> output[2];
+			for (int i = 0; i < 2; i++) {
+				AudioMixKernels::set_simd_enabled(i == 0);
+				output[i].resize(TEST_FRAMES * stride);
+				memset(output[i].ptrw(), 0, output[i].size() * sizeof(int32_t));
+				AudioMixKernels::to_int32(src.ptr(), output[i].ptrw(), TEST_FRAMES, stride);
+			}
+			CHECK(memcmp(output[0].ptr(), output[1].ptr(), output[0].size() * sizeof(int32_t)) == 0);
+		}
+	}
+
+	AudioMixKernels::set_simd_enabled(true);
+}
+
+TEST_CASE("[AudioMix] SIMD effects match the scalar effects") {
+	TestAudio audio;
+
+	Ref<AudioEffectLowPassFilter> filter;
+	filter.instance();
+	filter->set_cutoff(800);
+	filter->set_db(AudioEffectFilter::FILTER_24DB);
+	// Same operations in the same order, only both channels at once.
+	CHECK(compare_effect(filter) == 0);
+
+	Ref<AudioEffectEQ21> eq;
+	eq.instance();
+	for (int i = 0; i < eq->get_band_count(); i++) {
+		eq->set_band_gain_db(i, (i % 5) * 3 - 6);
+	}
+	// Only the band outputs are summed in a different order.
+	CHECK(compare_effect(eq) < 1e-5);
+
+	Ref<AudioEffectReverb> reverb;
+	reverb.instance();
+	reverb->set_wet(0.5);
+	reverb->set_spread(1.0);
+	CHECK(compare_effect(reverb) < 1e-4);
+}
+
+// Mixes a few buses sending to each other, some of them with effects, and returns the output.
+static Vector<int32_t> mix_bus_graph(int p_bus_threads) {
+	ProjectSettings::get_singleton()->set_setting("audio/bus_threads", p_bus_threads);
+
+	TestAudio audio;
+	AudioServer *as = AudioServer::get_singleton();
+	CHECK(as->get_bus_thread_count() == p_bus_threads);
+
+	// 4 and 5 send to 3, the rest to the master bus. Buses can only send to lower indices,
+	// so this gives three waves: 1, 2, 4 and 5, then 3, then the master bus.
+	as->set_bus_count(6);
+	for (int i = 1; i < 6; i++) {
+		as->set_bus_name(i, "Bus" + itos(i));
+		as->set_bus_volume_db(i, -i);
+	}
+	as->set_bus_send(4, "Bus3");
+	as->set_bus_send(5, "Bus3");
+	as->add_bus_effect(1, Ref<AudioEffect>(memnew(AudioEffectReverb)));
+	as->add_bus_effect(2, Ref<AudioEffect>(memnew(AudioEffectEQ6)));
+	as->add_bus_effect(3, Ref<AudioEffect>(memnew(AudioEffectReverb)));
+	as->add_bus_effect(4, Ref<AudioEffect>(memnew(AudioEffectLowPassFilter)));
+	as->add_bus_effect(5, Ref<AudioEffect>(memnew(AudioEffectEQ6)));
+
+	Ref<AudioStreamSample> sample = make_sample(1.0, true);
+	Vector<RID> voices;
+	for (int i = 0; i < 6; i++) {
+		if (i == 3) {
+			continue;
+		}
+		AudioServer::VoiceTarget target;
+		target.bus = as->get_bus_name(i);
+		target.volume[0] = AudioFrame(0.1 * i + 0.1, 0.2);
+		RID voice = as->voice_create(sample);
+		as->voice_set_targets(voice, &target, 1);
+		as->voice_play(voice, i * 0.01);
+		voices.push_back(voice);
+	}
+
+	Vector<int32_t> output;
+	for (int i = 0; i < 20; i++) {
+		audio.mix();
+		output.append_array(audio.get_output());
+	}
+	// No voice plays on bus 3, it only gets the sends of 4 and 5.
+	CHECK(as->get_bus_peak_volume_left_db(3, 0) > -60);
+
+	for (int i = 0; i < voices.size(); i++) {
+		as->voice_free(voices[i]);
+	}
+	ProjectSettings::get_singleton()->set_setting("audio/bus_threads", -1);
+	return output;
+}
+
+TEST_CASE("[AudioMix] Mixing buses on threads gives the same output") {
+	Vector<int32_t> serial = mix_bus_graph(0);
+	Vector<int32_t> threaded = mix_bus_graph(2);
+
+	REQUIRE(serial.size() == threaded.size());
+	CHECK(memcmp(serial.ptr(), threaded.ptr(), serial.size() * sizeof(int32_t)) == 0);
+
+	bool silent = true;
+	for (int i = 0; i < serial.size(); i++) {
+		silent = silent && serial[i] == 0;
+	}
+	CHECK(!silent);
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[AudioMix] Benchmark buses with effects" * doctest::skip()) {
+	const int bus_count = 8;
+	const int effects_per_bus = 3;
+	const int buffers = 43;
+
+	TestAudio audio;
+	AudioServer *as = AudioServer::get_singleton();
+	as->set_bus_count(bus_count + 1);
+
+	Ref<AudioStreamSample> sample = make_sample(1.0, true);
+	Vector<RID> voices;
+	for (int i = 1; i <= bus_count; i++) {
+		as->set_bus_name(i, "Bus" + itos(i));
+		as->set_bus_send(i, "Master");
+
+		for (int j = 0; j < effects_per_bus; j++) {
+			Ref<AudioEffect> effect;
+			switch (j % 3) {
+				case 0: {
+					effect = Ref<AudioEffect>(memnew(AudioEffectEQ10));
+				} break;
+				case 1: {
+					effect = Ref<AudioEffect>(memnew(AudioEffectLowPassFilter));
+				} break;
+				case 2: {
+					effect = Ref<AudioEffect>(memnew(AudioEffectReverb));
+				} break;
+			}
+			as->add_bus_effect(i, effect);
+		}
+
+		AudioServer::VoiceTarget target;
+		target.bus = as->get_bus_name(i);
+		target.volume[0] = AudioFrame(0.1, 0.1);
+		RID voice = as->voice_create(sample);
+		as->voice_set_targets(voice, &target, 1);
+		as->voice_play(voice);
+		voices.push_back(voice);
+	}
+
+	float real_time[2];
+	for (int i = 0; i < 2; i++) {
+		AudioMixKernels::set_simd_enabled(i == 0);
+		audio.mix(); // Warm up, and let the voices start.
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		audio.mix(buffers);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		real_time[i] = usec / (audio.mix_time(buffers) * 1000000.0);
+	}
+	AudioMixKernels::set_simd_enabled(true);
+
+	for (int i = 0; i < voices.size(); i++) {
+		as->voice_free(voices[i]);
+	}
+
+	MESSAGE(vformat("%d buses with %d effects: %.2f%% of real time with SIMD, %.2f%% without.", bus_count, effects_per_bus, real_time[0] * 100, real_time[1] * 100).utf8().get_data());
+}
+
+} // namespace TestAudioMix
+
+#endif // TEST_AUDIO_MIX_H
@@ -0,0 +1,290 @@
+/*************************************************************************/
+/*  test_audio_resampler.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_AUDIO_RESAMPLER_H
+#define TEST_AUDIO_RESAMPLER_H
+
+#include "servers/audio/audio_mix_kernels.h"
+#include "servers/audio/audio_rb_resampler.h"
+#include "servers/audio/audio_resampler.h"
+#include "servers/audio/audio_stream.h"
+#include "tests/test_audio_mix.h"
+#include "tests/test_audio_voices.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAudioResampler {
+
+using TestAudioMix::make_noise;
+using TestAudioVoices::TestAudio;
+
+static const char *quality_names[AudioResampler::QUALITY_MAX] = { "Cubic", "Sinc Low", "Sinc Medium", "Sinc High" };
+
+// Endless sine wave, mixed at its own rate and resampled to the server rate.
+class TestSinePlayback : public AudioStreamPlaybackResampled {
+	float rate = 32000;
+	double frequency = 1000;
+	int64_t position = 0;
+	bool active = false;
+
+protected:
+	virtual void _mix_internal(AudioFrame *p_buffer, int p_frames) override {
+		for (int i = 0; i < p_frames; i++) {
+			float v = Math::sin(Math_TAU * frequency * double(position + i) / rate) * 0.5;
+			p_buffer[i] = AudioFrame(v, v);
+		}
+		position += p_frames;
+	}
+
+	virtual float get_stream_sampling_rate() override {
+		return rate;
+	}
+
+public:
+	virtual void start(float p_from_pos = 0.0) override {
+		position = 0;
+		active = true;
+		_begin_resample();
+	}
+	virtual void stop() override {
+		active = false;
+	}
+	virtual bool is_playing() const override {
+		return active;
+	}
+	virtual int get_loop_count() const override {
+		return 0;
+	}
+	virtual float get_playback_position() const override {
+		return position / rate;
+	}
+	virtual void seek(float p_time) override {}
+
+	TestSinePlayback(float p_rate, double p_frequency) {
+		rate = p_rate;
+		frequency = p_frequency;
+	}
+};
+
+// Ratio of everything that isn't the sine (noise, distortion and aliasing) to the sine, in dB.
+// The sine is found with a least squares fit, at p_w radians per frame.
+static double thd_n(const Vector<AudioFrame> &p_output, int p_skip, double p_w) {
+	double cc = 0, cs = 0, ss = 0, yc = 0, ys = 0;
+	for (int i = p_skip; i < p_output.size(); i++) {
+		double c = Math::cos(p_w * i);
+		double s = Math::sin(p_w * i);
+		double y = p_output[i].l;
+		cc += c * c;
+		cs += c * s;
+		ss += s * s;
+		yc += y * c;
+		ys += y * s;
+	}
+	double det = cc * ss - cs * cs;
+	double a = (yc * ss - ys * cs) / det;
+	double b = (ys * cc - yc * cs) / det;
+
+	double signal = 0, residual = 0;
+	for (int i = p_skip; i < p_output.size(); i++) {
+		double fit = a * Math::cos(p_w * i) + b * Math::sin(p_w * i);
+		double diff = p_output[i].l - fit;
+		signal += fit * fit;
+		residual += diff * diff;
+	}
+	return 10.0 * Math::log(residual / signal) / Math::log(10.0);
+}
+
+// The resamplers step in fixed point, so the output frequency is off by the truncated bits.
+static double output_w(float p_rate, double p_frequency, int p_frac_bits) {
+	double ratio = p_rate / AudioServer::get_singleton()->get_mix_rate();
+	double step = double(uint64_t(ratio * (1 << p_frac_bits))) / (1 << p_frac_bits);
+	return Math_TAU * p_frequency * step / p_rate;
+}
+
+static double measure_thd_n(AudioResampler::Quality p_quality, float p_rate, double p_frequency) {
+	const int skip = 512; // Let the filter history fill up.
+	const int frames = 8192;
+
+	AudioResampler::set_quality(p_quality);
+	Ref<TestSinePlayback> playback = memnew(TestSinePlayback(p_rate, p_frequency));
+	playback->start();
+
+	Vector<AudioFrame> output;
+	output.resize(skip + frames);
+	playback->mix(output.ptrw(), 1.0, output.size());
+
+	return thd_n(output, skip, output_w(p_rate, p_frequency, 16));
+}
+
+// Output level relative to the input sine, in dB.
+static double measure_level(AudioResampler::Quality p_quality, float p_rate, double p_frequency) {
+	const int skip = 512;
+	const int frames = 8192;
+
+	AudioResampler::set_quality(p_quality);
+	Ref<TestSinePlayback> playback = memnew(TestSinePlayback(p_rate, p_frequency));
+	playback->start();
+
+	Vector<AudioFrame> output;
+	output.resize(skip + frames);
+	playback->mix(output.ptrw(), 1.0, output.size());
+
+	double energy = 0;
+	for (int i = 0; i < frames; i++) {
+		energy += output[skip + i].l * output[skip + i].l;
+	}
+	// A sine with an amplitude of 0.5 has an energy of 0.125 per frame.
+	return 10.0 * Math::log(energy / (frames * 0.125)) / Math::log(10.0);
+}
+
+TEST_CASE("[AudioResampler] Sinc qualities remove the aliasing left by cubic interpolation") {
+	TestAudio audio;
+
+	// 10 KHz at 32 KHz leaves an image at 22 KHz, right under the 44.1 KHz output Nyquist frequency.
+	double thd_n[AudioResampler::QUALITY_MAX];
+	for (int i = 0; i < AudioResampler::QUALITY_MAX; i++) {
+		thd_n[i] = measure_thd_n(AudioResampler::Quality(i), 32000, 10000);
+		MESSAGE(vformat("%s: THD+N %.1f dB", quality_names[i], thd_n[i]).utf8().get_data());
+	}
+
+	CHECK(thd_n[AudioResampler::QUALITY_SINC_LOW] < thd_n[AudioResampler::QUALITY_CUBIC] - 20);
+	CHECK(thd_n[AudioResampler::QUALITY_SINC_MEDIUM] < thd_n[AudioResampler::QUALITY_SINC_LOW]);
+	CHECK(thd_n[AudioResampler::QUALITY_SINC_HIGH] < thd_n[AudioResampler::QUALITY_SINC_MEDIUM]);
+}
+
+TEST_CASE("[AudioResampler] Downsampling uses a lower cutoff") {
+	TestAudio audio;
+
+	// 23 KHz at 48 KHz can't be represented at 44.1 KHz, it would alias down to 21.1 KHz.
+	double level[AudioResampler::QUALITY_MAX];
+	for (int i = 0; i < AudioResampler::QUALITY_MAX; i++) {
+		level[i] = measure_level(AudioResampler::Quality(i), 48000, 23000);
+		MESSAGE(vformat("%s: aliasing at %.1f dB", quality_names[i], level[i]).utf8().get_data());
+	}
+
+	CHECK(level[AudioResampler::QUALITY_CUBIC] > -20);
+	CHECK(level[AudioResampler::QUALITY_SINC_LOW] < -40);
+	CHECK(level[AudioResampler::QUALITY_SINC_MEDIUM] < -40);
+	CHECK(level[AudioResampler::QUALITY_SINC_HIGH] < -40);
+}
+
+TEST_CASE("[AudioResampler] The ring buffer resampler uses the sinc filters") {
+	TestAudio audio;
+
+	const int rate = 32000;
+	const double frequency = 10000;
+	const int frames = 8192 + 512;
+
+	double thd_n_linear = 0;
+	for (int i = 0; i < 2; i++) {
+		AudioResampler::set_quality(i == 0 ? AudioResampler::QUALITY_CUBIC : AudioResampler::QUALITY_SINC_MEDIUM);
+
+		AudioRBResampler resampler;
+		resampler.setup(1, rate, AudioServer::get_singleton()->get_mix_rate(), 100);
+
+		Vector<AudioFrame> output;
+		output.resize(frames);
+		int written = 0;
+		int mixed = 0;
+		while (mixed < frames) {
+			// Same pattern as VideoPlayer: write what fits, mix what's ready.
+			int todo = resampler.get_writer_space();
+			float *buf = resampler.get_write_buffer();
+			for (int j = 0; j < todo; j++) {
+				buf[j] = Math::sin(Math_TAU * frequency * double(written + j) / rate) * 0.5;
+			}
+			resampler.write(todo);
+			written += todo;
+
+			int ready = MIN(resampler.get_num_of_ready_frames(), frames - mixed);
+			REQUIRE(ready > 0);
+			REQUIRE(resampler.mix(output.ptrw() + mixed, ready));
+			mixed += ready;
+		}
+
+		double result = thd_n(output, 512, output_w(rate, frequency, 13));
+		if (i == 0) {
+			thd_n_linear = result;
+		} else {
+			MESSAGE(vformat("Ring buffer THD+N: %.1f dB linear, %.1f dB sinc", thd_n_linear, result).utf8().get_data());
+			CHECK(result < thd_n_linear - 30);
+			CHECK(result < -60);
+		}
+	}
+}
+
+TEST_CASE("[AudioResampler] SIMD interpolation matches the scalar interpolation") {
+	TestAudio audio;
+
+	Vector<AudioFrame> window = make_noise(AudioResampler::MAX_TAPS, 1.0, 3);
+	for (int i = AudioResampler::QUALITY_SINC_LOW; i < AudioResampler::QUALITY_MAX; i++) {
+		AudioResampler::set_quality(AudioResampler::Quality(i));
+		for (int j = 0; j < 4; j++) {
+			const float *filter = AudioResampler::get_filter(1.0 + j * 0.3);
+			float diff = 0;
+			for (int k = 0; k <= 100; k++) {
+				AudioMixKernels::set_simd_enabled(true);
+				AudioFrame simd = AudioResampler::interpolate(filter, window.ptr(), k / 100.0);
+				AudioMixKernels::set_simd_enabled(false);
+				AudioFrame scalar = AudioResampler::interpolate(filter, window.ptr(), k / 100.0);
+				diff = MAX(diff, MAX(ABS(simd.l - scalar.l), ABS(simd.r - scalar.r)));
+			}
+			// Only the products are summed in a different order.
+			CHECK(diff < 1e-5);
+		}
+	}
+	AudioMixKernels::set_simd_enabled(true);
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[AudioResampler] Benchmark resampling qualities" * doctest::skip()) {
+	TestAudio audio;
+
+	const int frames = 44100;
+	Vector<AudioFrame> output;
+	output.resize(frames);
+
+	for (int i = 0; i < AudioResampler::QUALITY_MAX; i++) {
+		AudioResampler::set_quality(AudioResampler::Quality(i));
+		Ref<TestSinePlayback> playback = memnew(TestSinePlayback(48000, 1000));
+		playback->start();
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		playback->mix(output.ptrw(), 1.0, frames);
+		uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, 1);
+
+		// Includes generating the sine, which is the same for all qualities.
+		MESSAGE(vformat("%s: %.1f streams in real time", quality_names[i], 1000000.0 / usec).utf8().get_data());
+	}
+}
+
+} // namespace TestAudioResampler
+
+#endif // TEST_AUDIO_RESAMPLER_H
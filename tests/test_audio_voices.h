@@ -0,0 +1,274 @@
+/*************************************************************************/
+/*  test_audio_voices.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_AUDIO_VOICES_H
+#define TEST_AUDIO_VOICES_H
+
+#include "core/math/random_number_generator.h"
+#include "core/project_settings.h"
+#include "scene/resources/audio_stream_sample.h"
+#include "servers/audio/audio_driver_dummy.h"
+#include "servers/audio_server.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestAudioVoices {
+
+// Runs an AudioServer on a dummy driver without threads, so the test decides when mixing happens.
+class TestAudio {
+	AudioDriverDummy driver;
+	AudioServer *server = nullptr;
+	Vector<int32_t> output;
+
+public:
+	int frames = 0;
+
+	void mix(int p_buffers = 1) {
+		for (int i = 0; i < p_buffers; i++) {
+			driver.mix_audio(frames, output.ptrw());
+		}
+	}
+
+	const Vector<int32_t> &get_output() const {
+		return output;
+	}
+
+	float mix_time(int p_buffers) const {
+		return float(frames * p_buffers) / server->get_mix_rate();
+	}
+
+	TestAudio() {
+		GLOBAL_DEF("audio/mix_rate", 44100);
+		GLOBAL_DEF("audio/output_latency", 15);
+
+		driver.set_use_threads(false);
+		driver.init();
+		driver.set_singleton();
+
+		server = memnew(AudioServer);
+		server->init();
+
+		frames = 1024;
+		output.resize(frames * 2);
+	}
+
+	~TestAudio() {
+		server->finish();
+		driver.finish();
+		memdelete(server);
+	}
+};
+
+static Ref<AudioStreamSample> make_sample(float p_length, bool p_loop) {
+	Ref<AudioStreamSample> sample;
+	sample.instance();
+	sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+	sample->set_mix_rate(44100);
+
+	int frames = int(p_length * 44100);
+	Vector<uint8_t> data;
+	data.resize(frames * 2);
+	int16_t *w = (int16_t *)data.ptrw();
+	for (int i = 0; i < frames; i++) {
+		w[i] = int16_t(Math::sin(i * Math_TAU * 440.0 / 44100.0) * 16000);
+	}
+	sample->set_data(data);
+
+	if (p_loop) {
+		sample->set_loop_mode(AudioStreamSample::LOOP_FORWARD);
+		sample->set_loop_begin(0);
+		sample->set_loop_end(frames);
+	}
+
+	return sample;
+}
+
+static void set_voice_volume(RID p_voice, float p_volume) {
+	AudioServer::VoiceTarget target;
+	target.bus = "Master";
+	target.volume[0] = AudioFrame(p_volume, p_volume);
+	AudioServer::get_singleton()->voice_set_targets(p_voice, &target, 1);
+}
+
+TEST_CASE("[AudioVoices] Only the most audible voices are mixed") {
+	TestAudio audio;
+	AudioServer *as = AudioServer::get_singleton();
+	as->set_max_voices(4);
+
+	Ref<AudioStreamSample> sample = make_sample(1.0, true);
+	Vector<RID> voices;
+	for (int i = 0; i < 10; i++) {
+		RID voice = as->voice_create(sample);
+		set_voice_volume(voice, 0.05 * (i + 1));
+		as->voice_play(voice);
+		voices.push_back(voice);
+	}
+
+	audio.mix();
+	CHECK(as->get_mixed_voice_count() == 4);
+	CHECK(as->get_virtual_voice_count() == 6);
+
+	// Only the four loudest are heard, the rest did not advance yet.
+	for (int i = 0; i < 10; i++) {
+		float position = as->voice_get_playback_position(voices[i]);
+		CHECK(Math::is_equal_approx(position, audio.mix_time(1), 0.001f));
+		CHECK(as->voice_is_playing(voices[i]));
+	}
+
+	// A higher priority makes a quiet voice be mixed instead of a louder one.
+	as->voice_set_priority(voices[0], 100.0);
+	audio.mix();
+	CHECK(as->get_mixed_voice_count() == 4);
+
+	// Silent voices are virtualized even when under the limit.
+	as->set_max_voices(128);
+	for (int i = 0; i < 5; i++) {
+		set_voice_volume(voices[i], 0.0);
+	}
+	audio.mix();
+	CHECK(as->get_mixed_voice_count() == 5);
+	CHECK(as->get_virtual_voice_count() == 5);
+
+	for (int i = 0; i < voices.size(); i++) {
+		as->voice_free(voices[i]);
+	}
+}
+
+TEST_CASE("[AudioVoices] Virtual voices keep advancing") {
+	TestAudio audio;
+	AudioServer *as = AudioServer::get_singleton();
+
+	Ref<AudioStreamSample> sample = make_sample(1.0, false);
+	RID voice = as->voice_create(sample);
+	set_voice_volume(voice, 0.0);
+	as->voice_play(voice);
+
+	audio.mix(20);
+	CHECK(as->get_virtual_voice_count() == 1);
+	CHECK(Math::is_equal_approx(as->voice_get_playback_position(voice), audio.mix_time(20), 0.01f));
+	CHECK(as->voice_is_playing(voice));
+
+	// Made audible again, it continues from where it would be.
+	set_voice_volume(voice, 1.0);
+	audio.mix();
+	CHECK(as->get_mixed_voice_count() == 1);
+	CHECK(Math::is_equal_approx(as->voice_get_playback_position(voice), audio.mix_time(21), 0.01f));
+
+	// Ends while virtual, noticed when it next catches up.
+	set_voice_volume(voice, 0.0);
+	audio.mix(45);
+	CHECK_FALSE(as->voice_is_playing(voice));
+
+	// Playing again restarts it.
+	as->voice_play(voice, 0.5);
+	audio.mix();
+	CHECK(as->voice_is_playing(voice));
+	CHECK(Math::is_equal_approx(as->voice_get_playback_position(voice), 0.5f + audio.mix_time(1), 0.01f));
+
+	as->voice_stop(voice);
+	CHECK_FALSE(as->voice_is_playing(voice));
+
+	as->voice_free(voice);
+}
+
+TEST_CASE("[AudioVoices] Skipping wraps around sample loops") {
+	TestAudio audio;
+
+	Ref<AudioStreamSample> sample = make_sample(1.0, true);
+	Ref<AudioStreamPlayback> playback = sample->instance_playback();
+	playback->start(0.25);
+	playback->skip(2.5);
+	CHECK(playback->is_playing());
+	CHECK(Math::is_equal_approx(playback->get_playback_position(), 0.75f, 0.001f));
+
+	sample->set_loop_mode(AudioStreamSample::LOOP_PING_PONG);
+	playback->start(0.25);
+	playback->skip(1.0);
+	CHECK(Math::is_equal_approx(playback->get_playback_position(), 0.75f, 0.001f));
+	playback->skip(1.0);
+	CHECK(Math::is_equal_approx(playback->get_playback_position(), 0.25f, 0.001f));
+
+	sample->set_loop_mode(AudioStreamSample::LOOP_DISABLED);
+	playback->start(0.25);
+	playback->skip(1.0);
+	CHECK_FALSE(playback->is_playing());
+}
+
+// Mixes 512 voices with random volumes, pitches and offsets, and returns the output of the last buffer.
+static Vector<int32_t> mix_many_voices(uint64_t p_seed, int p_buffers) {
+	TestAudio audio;
+	AudioServer *as = AudioServer::get_singleton();
+	as->set_max_voices(32);
+
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(p_seed);
+
+	Ref<AudioStreamSample> sample = make_sample(1.0, true);
+	Vector<RID> voices;
+	for (int i = 0; i < 512; i++) {
+		RID voice = as->voice_create(sample);
+		set_voice_volume(voice, rng->randf());
+		as->voice_set_pitch_scale(voice, 0.5 + rng->randf());
+		as->voice_play(voice, rng->randf());
+		voices.push_back(voice);
+	}
+
+	audio.mix(p_buffers);
+
+	CHECK(as->get_mixed_voice_count() == 32);
+	CHECK(as->get_virtual_voice_count() == 480);
+
+	for (int i = 0; i < voices.size(); i++) {
+		as->voice_free(voices[i]);
+	}
+
+	return audio.get_output();
+}
+
+TEST_CASE("[AudioVoices] Mixing many voices") {
+	const Vector<int32_t> output = mix_many_voices(1234, 20);
+
+	bool silent = true;
+	for (int i = 0; i < output.size(); i++) {
+		silent = silent && output[i] == 0;
+	}
+	CHECK_FALSE(silent);
+
+	const Vector<int32_t> again = mix_many_voices(1234, 20);
+	REQUIRE(again.size() == output.size());
+	CHECK_MESSAGE(
+			memcmp(again.ptr(), output.ptr(), output.size() * sizeof(int32_t)) == 0,
+			"Mixing the same voices should give the same output.");
+}
+
+} // namespace TestAudioVoices
+
+#endif // TEST_AUDIO_VOICES_H
@@ -0,0 +1,206 @@
+/*************************************************************************/
+/*  test_basis_transcode_cache.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_BASIS_TRANSCODE_CACHE_H
+#define TEST_BASIS_TRANSCODE_CACHE_H
+
+#ifdef MODULE_BASIS_UNIVERSAL_ENABLED
+
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "modules/basis_universal/basis_transcode_cache.h"
+#include "servers/rendering_server.h"
+
+#include "tests/test_macros.h"
+
+namespace TestBasisTranscodeCache {
+
+TEST_CASE("[BasisTranscodeCache] Store and load transcoded images") {
+	const String dir = OS::get_singleton()->get_cache_path().plus_file("godot_test_basis_transcode_cache");
+
+	Vector<uint8_t> basis_data;
+	basis_data.resize(256);
+	for (int i = 0; i < basis_data.size(); i++) {
+		basis_data.write[i] = i * 7;
+	}
+
+	const String key = BasisTranscodeCache::get_key(basis_data.ptr(), basis_data.size(), 2, Image::FORMAT_DXT5);
+	CHECK(key == BasisTranscodeCache::get_key(basis_data.ptr(), basis_data.size(), 2, Image::FORMAT_DXT5));
+	CHECK_MESSAGE(
+			key != BasisTranscodeCache::get_key(basis_data.ptr(), basis_data.size(), 6, Image::FORMAT_BPTC_RGBA),
+			"Transcoding to another format should change the cache key.");
+	basis_data.write[100] ^= 1;
+	CHECK_MESSAGE(
+			key != BasisTranscodeCache::get_key(basis_data.ptr(), basis_data.size(), 2, Image::FORMAT_DXT5),
+			"Changing the Basis data should change the cache key.");
+
+	BasisTranscodeCache cache;
+	cache.set_cache_path(dir);
+	CHECK(cache.load(key).is_null());
+
+	// Compressed, with mipmaps, like the transcoder output.
+	Vector<uint8_t> data;
+	data.resize(Image::get_image_data_size(64, 32, Image::FORMAT_DXT5, true));
+	for (int i = 0; i < data.size(); i++) {
+		data.write[i] = i * 13;
+	}
+	Ref<Image> image;
+	image.instance();
+	image->create(64, 32, true, Image::FORMAT_DXT5, data);
+
+	REQUIRE(cache.store(key, image) == OK);
+	CHECK_MESSAGE(cache.store(key, image) == OK, "Storing an entry again should be harmless.");
+
+	Ref<Image> loaded = cache.load(key);
+	REQUIRE(loaded.is_valid());
+	CHECK(loaded->get_width() == 64);
+	CHECK(loaded->get_height() == 32);
+	CHECK(loaded->get_format() == Image::FORMAT_DXT5);
+	CHECK(loaded->has_mipmaps());
+	REQUIRE(loaded->get_data().size() == data.size());
+	CHECK(memcmp(loaded->get_data().ptr(), data.ptr(), data.size()) == 0);
+
+	// Damaged entries are ignored, so the texture is transcoded again.
+	const String entry_path = cache.get_entry_path(key);
+	REQUIRE(FileAccess::exists(entry_path));
+	{
+		FileAccessRef f = FileAccess::open(entry_path, FileAccess::READ_WRITE);
+		REQUIRE(f);
+		f->seek(24);
+		f->store_32(12345); // Data size.
+	}
+	ERR_PRINT_OFF;
+	CHECK(cache.load(key).is_null());
+	ERR_PRINT_ON;
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->change_dir(dir) == OK) {
+		da->erase_contents_recursive();
+	}
+	da->remove(dir);
+}
+
+TEST_CASE("[BasisTranscodeCache] Prune the entries of other engine versions") {
+	const String dir = OS::get_singleton()->get_cache_path().plus_file("godot_test_basis_transcode_cache_prune");
+
+	BasisTranscodeCache cache;
+	cache.set_cache_path(dir);
+	cache.prune_other_versions(); // Harmless before anything is cached.
+
+	Ref<Image> image;
+	image.instance();
+	image->create(8, 8, false, Image::FORMAT_RGBA8);
+	image->fill(Color(1, 0, 0));
+
+	Vector<uint8_t> basis_data;
+	basis_data.resize(64);
+	zeromem(basis_data.ptrw(), basis_data.size());
+	const String key = BasisTranscodeCache::get_key(basis_data.ptr(), basis_data.size(), 13, Image::FORMAT_RGBA8);
+	REQUIRE(cache.store(key, image) == OK);
+
+	// Laid out as an older version would have left it.
+	const String old_entry_path = dir.plus_file("3.2.stable-1").plus_file("ab").plus_file("ab.btc");
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	REQUIRE(da->make_dir_recursive(old_entry_path.get_base_dir()) == OK);
+	{
+		FileAccessRef f = FileAccess::open(old_entry_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_32(0);
+	}
+
+	cache.prune_other_versions();
+
+	CHECK_MESSAGE(!da->dir_exists(dir.plus_file("3.2.stable-1")), "The entries of other versions should be removed.");
+	CHECK_MESSAGE(cache.load(key).is_valid(), "The entries of the running version should be kept.");
+
+	if (da->change_dir(dir) == OK) {
+		da->erase_contents_recursive();
+	}
+	da->remove(dir);
+}
+
+#ifdef TOOLS_ENABLED
+void check_basis_round_trip(const Ref<Image> &p_source, Image::UsedChannels p_channels, Image::Format p_format) {
+	Vector<uint8_t> basis_data = Image::basis_universal_packer(p_source, p_channels);
+	REQUIRE(basis_data.size() > 0);
+
+	Ref<Image> image = Image::basis_universal_unpacker(basis_data);
+	REQUIRE(image.is_valid());
+	CHECK(image->get_format() == p_format);
+	CHECK_MESSAGE(image->get_width() == p_source->get_width(), "The original size should be kept, not the block aligned one.");
+	CHECK(image->get_height() == p_source->get_height());
+	CHECK(image->get_data().size() == Image::get_image_data_size(p_source->get_width(), p_source->get_height(), p_format, false));
+
+	// Basis Universal is lossy, but rows laid out with the wrong size would be far off.
+	image->convert(Image::FORMAT_RGBA8);
+	int mismatches = 0;
+	for (int y = 0; y < p_source->get_height(); y++) {
+		for (int x = 0; x < p_source->get_width(); x++) {
+			Color expected = p_source->get_pixel(x, y);
+			Color got = image->get_pixel(x, y);
+			if (p_channels == Image::USED_CHANNELS_RG) {
+				// Stored as red and alpha.
+				got.g = got.a;
+			}
+			if (Math::abs(got.r - expected.r) > 0.15 || Math::abs(got.g - expected.g) > 0.15) {
+				mismatches++;
+			}
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE("[BasisTranscodeCache] Transcode to uncompressed formats") {
+	if (!Image::basis_universal_packer || !Image::basis_universal_unpacker || RenderingServer::get_singleton()) {
+		return; // With a rendering server, the target formats depend on the GPU.
+	}
+
+	// Not a multiple of the 4x4 block size.
+	Ref<Image> source;
+	source.instance();
+	source->create(30, 18, false, Image::FORMAT_RGBA8);
+	for (int y = 0; y < source->get_height(); y++) {
+		for (int x = 0; x < source->get_width(); x++) {
+			source->set_pixel(x, y, Color(x / 29.0, y / 17.0, 0.5));
+		}
+	}
+
+	check_basis_round_trip(source, Image::USED_CHANNELS_RG, Image::FORMAT_RGBA8);
+	check_basis_round_trip(source, Image::USED_CHANNELS_RGB, Image::FORMAT_RGB565);
+	check_basis_round_trip(source, Image::USED_CHANNELS_RGBA, Image::FORMAT_RGBA4444);
+}
+#endif // TOOLS_ENABLED
+
+} // namespace TestBasisTranscodeCache
+
+#endif // MODULE_BASIS_UNIVERSAL_ENABLED
+
+#endif // TEST_BASIS_TRANSCODE_CACHE_H
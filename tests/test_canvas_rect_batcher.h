@@ -0,0 +1,212 @@
+/*************************************************************************/
+/*  test_canvas_rect_batcher.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_CANVAS_RECT_BATCHER_H
+#define TEST_CANVAS_RECT_BATCHER_H
+
+#include "core/local_vector.h"
+#include "servers/rendering/rasterizer_rd/canvas_rect_batcher_rd.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestCanvasRectBatcher {
+
+typedef CanvasRectBatcherRD::State State;
+typedef CanvasRectBatcherRD::Instance Instance;
+typedef CanvasRectBatcherRD::Batch Batch;
+
+static State _state(uint64_t p_texture, uint64_t p_pipeline = 1) {
+	State state;
+	state.texture_binding = p_texture;
+	state.pipeline = p_pipeline;
+	return state;
+}
+
+static Instance _instance(float p_x, float p_world_ofs = 0) {
+	Instance instance = {};
+	instance.world[0] = 1;
+	instance.world[3] = 1;
+	instance.world[4] = p_world_ofs;
+	instance.dst_rect[0] = p_x;
+	instance.dst_rect[2] = 16;
+	instance.dst_rect[3] = 16;
+	return instance;
+}
+
+// Mimics RasterizerCanvasRD: flush whenever a rect doesn't fit the open batch.
+static void _add(CanvasRectBatcherRD &p_batcher, LocalVector<Batch> &r_draws, const State &p_state, const Instance &p_instance) {
+	if (!p_batcher.can_append(p_state) && p_batcher.is_open()) {
+		r_draws.push_back(p_batcher.flush());
+	}
+	p_batcher.append(p_state, p_instance);
+}
+
+static void _finish(CanvasRectBatcherRD &p_batcher, LocalVector<Batch> &r_draws) {
+	if (p_batcher.is_open()) {
+		r_draws.push_back(p_batcher.flush());
+	}
+}
+
+TEST_CASE("[CanvasRectBatcher] Merges rects sharing state") {
+	CanvasRectBatcherRD batcher;
+	LocalVector<Batch> draws;
+	batcher.begin();
+
+	for (int i = 0; i < 100; i++) {
+		// Different items (transforms) don't break batches of unlit rects.
+		_add(batcher, draws, _state(7), _instance(i, i * 2));
+	}
+	_finish(batcher, draws);
+
+	REQUIRE(draws.size() == 1);
+	CHECK(draws[0].first == 0);
+	CHECK(draws[0].count == 100);
+	CHECK(batcher.get_batch_count() == 1);
+	REQUIRE(batcher.get_instance_count() == 100);
+
+	bool in_order = true;
+	for (int i = 0; i < 100; i++) {
+		in_order = in_order && batcher.get_instances()[i].dst_rect[0] == i && batcher.get_instances()[i].world[4] == i * 2;
+	}
+	CHECK_MESSAGE(in_order, "Instances should be kept in submission order.");
+}
+
+TEST_CASE("[CanvasRectBatcher] Breaks on texture and material changes") {
+	CanvasRectBatcherRD batcher;
+	LocalVector<Batch> draws;
+	batcher.begin();
+
+	_add(batcher, draws, _state(1), _instance(0));
+	_add(batcher, draws, _state(1), _instance(1));
+	_add(batcher, draws, _state(2), _instance(2));
+	_add(batcher, draws, _state(2, 5), _instance(3));
+	_add(batcher, draws, _state(2, 5), _instance(4));
+	_add(batcher, draws, _state(1), _instance(5));
+	_finish(batcher, draws);
+
+	REQUIRE(draws.size() == 4);
+	CHECK(draws[0].state.texture_binding == 1);
+	CHECK(draws[0].count == 2);
+	CHECK(draws[1].state.texture_binding == 2);
+	CHECK(draws[1].count == 1);
+	CHECK(draws[2].state.pipeline == 5);
+	CHECK(draws[2].count == 2);
+	CHECK(draws[3].count == 1);
+
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < draws.size(); i++) {
+		CHECK_MESSAGE(draws[i].first == next, "Batches should cover the instances contiguously.");
+		next += draws[i].count;
+	}
+	CHECK(next == batcher.get_instance_count());
+}
+
+TEST_CASE("[CanvasRectBatcher] Keeps lit items apart") {
+	CanvasRectBatcherRD batcher;
+	LocalVector<Batch> draws;
+	batcher.begin();
+
+	State lit_a = _state(1);
+	lit_a.item_state = 100;
+	lit_a.lights[0] = 3;
+	lit_a.flags = 1 << 20;
+	State lit_b = lit_a;
+	lit_b.item_state = 101;
+
+	_add(batcher, draws, lit_a, _instance(0));
+	_add(batcher, draws, lit_a, _instance(1));
+	_add(batcher, draws, lit_b, _instance(2));
+	_add(batcher, draws, _state(1), _instance(3));
+	_finish(batcher, draws);
+
+	REQUIRE(draws.size() == 3);
+	CHECK(draws[0].count == 2);
+	CHECK(draws[0].state.lights[0] == 3);
+	CHECK(draws[1].state.item_state == 101);
+	CHECK(draws[2].state.item_state == 0);
+}
+
+TEST_CASE("[CanvasRectBatcher] Batches ninepatches by axis modes") {
+	CanvasRectBatcherRD batcher;
+	LocalVector<Batch> draws;
+	batcher.begin();
+
+	// Ninepatches use their own pipeline, and their axis modes live in the flags.
+	State stretch = _state(1, 2);
+	State tile = stretch;
+	tile.flags = 1 << 16;
+
+	for (int i = 0; i < 3; i++) {
+		Instance instance = _instance(i);
+		instance.ninepatch_margins[0] = i;
+		instance.ninepatch_margins[3] = i + 4;
+		_add(batcher, draws, stretch, instance);
+	}
+	_add(batcher, draws, tile, _instance(3));
+	_add(batcher, draws, _state(1), _instance(4));
+	_finish(batcher, draws);
+
+	REQUIRE(draws.size() == 3);
+	CHECK(draws[0].count == 3);
+	CHECK(draws[1].state.flags == tile.flags);
+	CHECK(draws[2].state.pipeline == 1);
+
+	// Margins differ per ninepatch, so they are instance data.
+	REQUIRE(batcher.get_instance_count() == 5);
+	CHECK(batcher.get_instances()[1].ninepatch_margins[0] == 1);
+	CHECK(batcher.get_instances()[2].ninepatch_margins[3] == 6);
+	CHECK(batcher.get_instances()[4].ninepatch_margins[3] == 0);
+}
+
+TEST_CASE("[CanvasRectBatcher] Explicit flushes and reuse") {
+	CanvasRectBatcherRD batcher;
+	LocalVector<Batch> draws;
+	batcher.begin();
+
+	// A clip change or a command that isn't batched in between flushes the open batch.
+	_add(batcher, draws, _state(1), _instance(0));
+	draws.push_back(batcher.flush());
+	CHECK_FALSE(batcher.is_open());
+	_add(batcher, draws, _state(1), _instance(1));
+	_finish(batcher, draws);
+
+	REQUIRE(draws.size() == 2);
+	CHECK(draws[1].first == 1);
+	CHECK(batcher.get_batch_count() == 2);
+
+	batcher.begin();
+	CHECK(batcher.get_batch_count() == 0);
+	CHECK(batcher.get_instance_count() == 0);
+	CHECK_FALSE(batcher.is_open());
+}
+
+} // namespace TestCanvasRectBatcher
+
+#endif // TEST_CANVAS_RECT_BATCHER_H
@@ -0,0 +1,153 @@
+/*************************************************************************/
+/*  test_command_queue.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_COMMAND_QUEUE_H
+#define TEST_COMMAND_QUEUE_H
+
+#include "core/command_queue_mt.h"
+#include "core/local_vector.h"
+#include "core/os/memory.h"
+#include "core/os/thread.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestCommandQueue {
+
+class Receiver {
+public:
+	enum {
+		PRODUCERS = 4,
+	};
+
+	// Only touched by the consumer thread.
+	LocalVector<uint32_t> received[PRODUCERS];
+	uint32_t large_sum = 0;
+
+	void add(int p_producer, uint32_t p_value) {
+		received[p_producer].push_back(p_value);
+	}
+
+	void add_large(Transform p_a, Transform p_b, Transform p_c) {
+		large_sum += p_a.origin.x + p_b.origin.x + p_c.origin.x;
+	}
+
+	uint32_t get_count(int p_producer) {
+		return received[p_producer].size();
+	}
+};
+
+struct TestData {
+	CommandQueueMT *queue = nullptr;
+	Receiver *receiver = nullptr;
+	int producer = 0;
+	uint32_t count = 0;
+	volatile bool exit = false;
+};
+
+static void _producer(void *p_data) {
+	TestData *data = (TestData *)p_data;
+	for (uint32_t i = 0; i < data->count; i++) {
+		data->queue->push(data->receiver, &Receiver::add, data->producer, i);
+		if (i % 1000 == 0) {
+			// Large commands make the ring buffer wrap at odd offsets.
+			Transform t;
+			t.origin.x = 1;
+			data->queue->push(data->receiver, &Receiver::add_large, t, t, t);
+		}
+	}
+}
+
+static void _consumer(void *p_data) {
+	TestData *data = (TestData *)p_data;
+	while (!data->exit) {
+		data->queue->wait_and_flush_one();
+	}
+	data->queue->flush_all();
+}
+
+class Exiter {
+public:
+	TestData *data = nullptr;
+	void exit() { data->exit = true; }
+};
+
+TEST_CASE("[CommandQueueMT] Commands from several threads run in order") {
+	CommandQueueMT queue(true);
+	Receiver receiver;
+
+	const uint32_t count = 50000;
+	TestData consumer_data;
+	consumer_data.queue = &queue;
+	Thread *consumer = Thread::create(_consumer, &consumer_data);
+
+	TestData producer_data[Receiver::PRODUCERS];
+	Thread *producers[Receiver::PRODUCERS];
+	for (int i = 0; i < Receiver::PRODUCERS; i++) {
+		producer_data[i].queue = &queue;
+		producer_data[i].receiver = &receiver;
+		producer_data[i].producer = i;
+		producer_data[i].count = count;
+		producers[i] = Thread::create(_producer, &producer_data[i]);
+	}
+
+	for (int i = 0; i < Receiver::PRODUCERS; i++) {
+		Thread::wait_to_finish(producers[i]);
+		memdelete(producers[i]);
+	}
+
+	// Waits until everything pushed so far ran.
+	uint32_t received = 0;
+	queue.push_and_ret(&receiver, &Receiver::get_count, 0, &received);
+	CHECK_MESSAGE(received == count, "All the commands pushed before a synchronous one should have run.");
+	CHECK_MESSAGE(queue.get_sync_stall_count() == 1, "The synchronous command should be counted as a stall.");
+
+	Exiter exiter;
+	exiter.data = &consumer_data;
+	queue.push(&exiter, &Exiter::exit);
+	Thread::wait_to_finish(consumer);
+	memdelete(consumer);
+
+	for (int i = 0; i < Receiver::PRODUCERS; i++) {
+		REQUIRE_MESSAGE(receiver.received[i].size() == count, "Every command should run once.");
+		bool in_order = true;
+		for (uint32_t j = 0; j < count; j++) {
+			if (receiver.received[i][j] != j) {
+				in_order = false;
+				break;
+			}
+		}
+		CHECK_MESSAGE(in_order, "Commands from one thread should run in the order they were pushed.");
+	}
+	CHECK_MESSAGE(receiver.large_sum == Receiver::PRODUCERS * 3 * (count / 1000), "Large commands should run with their arguments intact.");
+}
+
+} // namespace TestCommandQueue
+
+#endif // TEST_COMMAND_QUEUE_H
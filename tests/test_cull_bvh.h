@@ -0,0 +1,323 @@
+/*************************************************************************/
+/*  test_cull_bvh.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_CULL_BVH_H
+#define TEST_CULL_BVH_H
+
+#include "core/math/camera_matrix.h"
+#include "core/math/cull_bvh.h"
+#include "core/math/octree.h"
+#include "core/math/random_number_generator.h"
+#include "core/os/os.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestCullBVH {
+
+struct TestElement {
+	AABB aabb;
+	uint32_t mask = 1;
+	real_t range_begin = 0;
+	real_t range_end = 0;
+	CullBVHElementID id = CULL_BVH_INVALID_ID;
+	bool alive = true;
+};
+
+static AABB _random_aabb(RandomNumberGenerator &p_rng) {
+	Vector3 pos(p_rng.randf_range(-100, 100), p_rng.randf_range(-100, 100), p_rng.randf_range(-100, 100));
+	Vector3 size(p_rng.randf_range(0.1, 5), p_rng.randf_range(0.1, 5), p_rng.randf_range(0.1, 5));
+	return AABB(pos, size);
+}
+
+static Vector<Plane> _get_frustum(real_t p_yaw) {
+	CameraMatrix cm;
+	cm.set_perspective(70, 16.0 / 9.0, 0.1, 80);
+	Transform xform;
+	xform.basis.rotate(Vector3(0, 1, 0), p_yaw);
+	xform.origin = Vector3(10, 5, -10);
+	return cm.get_projection_planes(xform);
+}
+
+static void _check_convex(const CullBVH<TestElement> &p_bvh, LocalVector<TestElement> &p_elements, const Vector<Plane> &p_planes, uint32_t p_mask) {
+	LocalVector<TestElement *> result;
+	p_bvh.cull_convex(p_planes.ptr(), p_planes.size(), result, p_mask);
+
+	Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(p_planes.ptr(), p_planes.size());
+	int expected = 0;
+	for (uint32_t i = 0; i < p_elements.size(); i++) {
+		const TestElement &e = p_elements[i];
+		if (e.alive && (e.mask & p_mask) && e.aabb.intersects_convex_shape(p_planes.ptr(), p_planes.size(), points.ptr(), points.size())) {
+			expected++;
+			CHECK_MESSAGE(result.find(&p_elements[i]) != -1, "Element inside the frustum should be returned.");
+		}
+	}
+	CHECK_MESSAGE(int(result.size()) == expected, "Frustum culling should return the same elements as testing them one by one.");
+}
+
+static void _check_convex_range(const CullBVH<TestElement> &p_bvh, LocalVector<TestElement> &p_elements, const Vector<Plane> &p_planes, const Vector3 &p_origin) {
+	LocalVector<TestElement *> result;
+	p_bvh.cull_convex(p_planes.ptr(), p_planes.size(), p_origin, result);
+
+	Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(p_planes.ptr(), p_planes.size());
+	int expected = 0;
+	for (uint32_t i = 0; i < p_elements.size(); i++) {
+		const TestElement &e = p_elements[i];
+		real_t d = (e.aabb.position + e.aabb.size * 0.5).distance_to(p_origin);
+		bool in_range = d >= e.range_begin && (e.range_end == 0 || d <= e.range_end);
+		if (e.alive && in_range && e.aabb.intersects_convex_shape(p_planes.ptr(), p_planes.size(), points.ptr(), points.size())) {
+			expected++;
+			CHECK_MESSAGE(result.find(&p_elements[i]) != -1, "Element inside the frustum and its visibility range should be returned.");
+		}
+	}
+	CHECK_MESSAGE(int(result.size()) == expected, "Frustum culling with visibility ranges should return the same elements as testing them one by one.");
+}
+
+static void _check_aabb(const CullBVH<TestElement> &p_bvh, LocalVector<TestElement> &p_elements, const AABB &p_aabb) {
+	LocalVector<TestElement *> result;
+	p_bvh.cull_aabb(p_aabb, result);
+
+	int expected = 0;
+	for (uint32_t i = 0; i < p_elements.size(); i++) {
+		const TestElement &e = p_elements[i];
+		if (e.alive && e.aabb.intersects(p_aabb)) {
+			expected++;
+			CHECK_MESSAGE(result.find(&p_elements[i]) != -1, "Element inside the box should be returned.");
+		}
+	}
+	CHECK_MESSAGE(int(result.size()) == expected, "Box culling should return the same elements as testing them one by one.");
+}
+
+TEST_CASE("[CullBVH] Culling matches brute force") {
+	RandomNumberGenerator rng;
+	rng.set_seed(1234);
+
+	CullBVH<TestElement> bvh;
+	LocalVector<TestElement> elements;
+	elements.resize(2000);
+	for (uint32_t i = 0; i < elements.size(); i++) {
+		elements[i].aabb = _random_aabb(rng);
+		elements[i].mask = 1 << (i % 3);
+		elements[i].id = bvh.create(&elements[i], elements[i].aabb, elements[i].mask);
+	}
+	bvh.update();
+
+	CHECK_MESSAGE(bvh.get_element_count() == 2000, "All elements should be in the tree.");
+	CHECK_MESSAGE(bvh.get_node_count() > 1, "Enough elements should build a tree with several levels.");
+
+	for (int i = 0; i < 4; i++) {
+		_check_convex(bvh, elements, _get_frustum(Math_PI * 0.5 * i), 0xFFFFFFFF);
+	}
+	_check_convex(bvh, elements, _get_frustum(0.3), 2);
+	_check_aabb(bvh, elements, AABB(Vector3(-20, -20, -20), Vector3(40, 40, 40)));
+
+	SUBCASE("Moving elements") {
+		for (uint32_t i = 0; i < elements.size(); i += 3) {
+			elements[i].aabb = _random_aabb(rng);
+			bvh.move(elements[i].id, elements[i].aabb);
+		}
+		bvh.update();
+		_check_convex(bvh, elements, _get_frustum(1.0), 0xFFFFFFFF);
+		_check_aabb(bvh, elements, AABB(Vector3(0, 0, 0), Vector3(50, 50, 50)));
+	}
+
+	SUBCASE("Erasing and adding elements") {
+		for (uint32_t i = 0; i < elements.size(); i += 2) {
+			elements[i].alive = false;
+			bvh.erase(elements[i].id);
+		}
+		// Few enough to stay pending, without rebuilding the tree.
+		for (uint32_t i = 0; i < 10; i += 2) {
+			elements[i].alive = true;
+			elements[i].id = bvh.create(&elements[i], elements[i].aabb, elements[i].mask);
+		}
+		bvh.update();
+		CHECK_MESSAGE(bvh.get_element_count() == 1005, "Erased elements should not be counted.");
+		_check_convex(bvh, elements, _get_frustum(2.0), 0xFFFFFFFF);
+		_check_aabb(bvh, elements, AABB(Vector3(-50, -50, -50), Vector3(100, 100, 100)));
+	}
+}
+
+TEST_CASE("[CullBVH] Visibility ranges") {
+	RandomNumberGenerator rng;
+	rng.set_seed(4321);
+
+	CullBVH<TestElement> bvh;
+	LocalVector<TestElement> elements;
+	elements.resize(2000);
+	for (uint32_t i = 0; i < elements.size(); i++) {
+		elements[i].aabb = _random_aabb(rng);
+		elements[i].id = bvh.create(&elements[i], elements[i].aabb, elements[i].mask);
+		// Mix unlimited elements with close and far ones, like detail meshes and their proxies.
+		if (i % 3 == 1) {
+			elements[i].range_end = rng.randf_range(10, 60);
+		} else if (i % 3 == 2) {
+			elements[i].range_begin = rng.randf_range(10, 60);
+			elements[i].range_end = i % 2 ? 0 : elements[i].range_begin + 30;
+		}
+		bvh.set_visibility_range(elements[i].id, elements[i].range_begin, elements[i].range_end);
+	}
+	bvh.update();
+
+	for (int i = 0; i < 4; i++) {
+		_check_convex_range(bvh, elements, _get_frustum(Math_PI * 0.5 * i), Vector3(10, 5, -10));
+	}
+	_check_convex_range(bvh, elements, _get_frustum(0.5), Vector3(-40, 0, 30));
+
+	LocalVector<TestElement *> result;
+	bvh.cull_convex(_get_frustum(0).ptr(), 6, result);
+	int expected = 0;
+	Vector<Plane> planes = _get_frustum(0);
+	Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(planes.ptr(), planes.size());
+	for (uint32_t i = 0; i < elements.size(); i++) {
+		expected += elements[i].aabb.intersects_convex_shape(planes.ptr(), planes.size(), points.ptr(), points.size()) ? 1 : 0;
+	}
+	CHECK_MESSAGE(int(result.size()) == expected, "Culling without a range origin should ignore visibility ranges.");
+
+	SUBCASE("Changing ranges and moving elements") {
+		for (uint32_t i = 0; i < elements.size(); i += 5) {
+			elements[i].range_begin = 0;
+			elements[i].range_end = rng.randf_range(5, 30);
+			bvh.set_visibility_range(elements[i].id, elements[i].range_begin, elements[i].range_end);
+		}
+		for (uint32_t i = 1; i < elements.size(); i += 7) {
+			elements[i].aabb = _random_aabb(rng);
+			bvh.move(elements[i].id, elements[i].aabb);
+		}
+		bvh.update();
+		for (int i = 0; i < 4; i++) {
+			_check_convex_range(bvh, elements, _get_frustum(Math_PI * 0.5 * i), Vector3(10, 5, -10));
+		}
+	}
+}
+
+TEST_CASE("[CullBVH] Small and empty trees") {
+	CullBVH<TestElement> bvh;
+	LocalVector<TestElement> elements;
+	elements.resize(3);
+
+	bvh.update();
+	_check_convex(bvh, elements, _get_frustum(0), 0xFFFFFFFF);
+
+	for (uint32_t i = 0; i < elements.size(); i++) {
+		elements[i].aabb = AABB(Vector3(10 + i, 5, -30), Vector3(1, 1, 1));
+		elements[i].id = bvh.create(&elements[i], elements[i].aabb);
+	}
+	bvh.update();
+	_check_convex(bvh, elements, _get_frustum(0), 0xFFFFFFFF);
+
+	elements[1].alive = false;
+	bvh.erase(elements[1].id);
+	bvh.update();
+	_check_convex(bvh, elements, _get_frustum(0), 0xFFFFFFFF);
+	_check_aabb(bvh, elements, AABB(Vector3(0, 0, -40), Vector3(20, 20, 20)));
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[CullBVH] Benchmark against the octree" * doctest::skip()) {
+	RandomNumberGenerator rng;
+	rng.set_seed(5678);
+
+	const uint32_t element_count = 50000;
+	const int cull_count = 100;
+
+	LocalVector<TestElement> elements;
+	elements.resize(element_count);
+	for (uint32_t i = 0; i < element_count; i++) {
+		elements[i].aabb = _random_aabb(rng);
+	}
+
+	// Geometry is in both structures in RenderingServerScene, the octree for pairing and the BVH for culling.
+	Octree<TestElement, true> octree;
+	LocalVector<OctreeElementID> octree_ids;
+	octree_ids.resize(element_count);
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < element_count; i++) {
+		octree_ids[i] = octree.create(&elements[i], elements[i].aabb, 0, false, 1, 0);
+	}
+	uint64_t octree_create = OS::get_singleton()->get_ticks_usec() - begin;
+
+	CullBVH<TestElement> bvh;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < element_count; i++) {
+		elements[i].id = bvh.create(&elements[i], elements[i].aabb);
+	}
+	bvh.update();
+	uint64_t bvh_create = OS::get_singleton()->get_ticks_usec() - begin;
+
+	LocalVector<TestElement *> octree_result;
+	octree_result.resize(element_count);
+	int octree_culled = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < cull_count; i++) {
+		octree_culled += octree.cull_convex(_get_frustum(Math_TAU * i / cull_count), octree_result.ptr(), element_count);
+	}
+	uint64_t octree_cull = OS::get_singleton()->get_ticks_usec() - begin;
+
+	LocalVector<TestElement *> bvh_result;
+	int bvh_culled = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < cull_count; i++) {
+		Vector<Plane> planes = _get_frustum(Math_TAU * i / cull_count);
+		bvh_result.clear();
+		bvh.cull_convex(planes.ptr(), planes.size(), bvh_result);
+		bvh_culled += bvh_result.size();
+	}
+	uint64_t bvh_cull = OS::get_singleton()->get_ticks_usec() - begin;
+
+	CHECK_MESSAGE(bvh_culled == octree_culled, "Both structures should cull the same instances.");
+
+	// Moving an instance updates both structures, as instance_set_transform does.
+	for (uint32_t i = 0; i < element_count; i += 10) {
+		elements[i].aabb = _random_aabb(rng);
+	}
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < element_count; i += 10) {
+		octree.move(octree_ids[i], elements[i].aabb);
+	}
+	uint64_t octree_move = OS::get_singleton()->get_ticks_usec() - begin;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < element_count; i += 10) {
+		bvh.move(elements[i].id, elements[i].aabb);
+	}
+	bvh.update();
+	uint64_t bvh_move = OS::get_singleton()->get_ticks_usec() - begin;
+
+	MESSAGE(vformat("%d elements, create: octree %.1f ms, BVH %.1f ms", element_count, octree_create / 1000.0, bvh_create / 1000.0).utf8().get_data());
+	MESSAGE(vformat("%d frustum culls: octree %.1f ms, BVH %.1f ms", cull_count, octree_cull / 1000.0, bvh_cull / 1000.0).utf8().get_data());
+	MESSAGE(vformat("%d moves: octree %.1f ms, BVH %.1f ms", element_count / 10, octree_move / 1000.0, bvh_move / 1000.0).utf8().get_data());
+
+	for (uint32_t i = 0; i < element_count; i++) {
+		octree.erase(octree_ids[i]);
+	}
+}
+
+} // namespace TestCullBVH
+
+#endif // TEST_CULL_BVH_H
@@ -0,0 +1,251 @@
+/*************************************************************************/
+/*  test_image.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_IMAGE_H
+#define TEST_IMAGE_H
+
+#include "core/image.h"
+#include "core/os/os.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestImage {
+
+static Ref<Image> make_noise(int p_width, int p_height, Image::Format p_format, uint32_t p_seed) {
+	Ref<Image> image;
+	image.instance();
+	image->create(p_width, p_height, false, Image::FORMAT_RGBA8);
+
+	Vector<uint8_t> data = image->get_data();
+	uint8_t *w = data.ptrw();
+	uint32_t state = p_seed * 747796405u + 2891336453u;
+	for (int i = 0; i < data.size(); i++) {
+		state = state * 1664525u + 1013904223u;
+		w[i] = state >> 24;
+	}
+	image->create(p_width, p_height, false, Image::FORMAT_RGBA8, data);
+	image->convert(p_format);
+	return image;
+}
+
+static bool data_equal(const Ref<Image> &p_a, const Ref<Image> &p_b) {
+	Vector<uint8_t> a = p_a->get_data();
+	Vector<uint8_t> b = p_b->get_data();
+	return p_a->get_format() == p_b->get_format() && a.size() == b.size() && memcmp(a.ptr(), b.ptr(), a.size()) == 0;
+}
+
+// Runs p_method with the threads and SIMD kernels and without them, the results must match bit for bit.
+template <class M>
+static bool matches_serial(const Ref<Image> &p_image, M p_method) {
+	Ref<Image> results[2];
+	for (int i = 0; i < 2; i++) {
+		Image::set_thread_count(i == 0 ? 4 : 0);
+		Image::set_simd_enabled(i == 0);
+		results[i] = p_image->duplicate();
+		p_method(results[i]);
+	}
+	Image::set_thread_count(-1);
+	Image::set_simd_enabled(true);
+
+	return data_equal(results[0], results[1]);
+}
+
+static void resize_bilinear(Ref<Image> &p_image) {
+	p_image->resize(p_image->get_width() * 3 / 4, p_image->get_height() * 5 / 4, Image::INTERPOLATE_BILINEAR);
+}
+
+static void resize_cubic(Ref<Image> &p_image) {
+	p_image->resize(p_image->get_width() * 3 / 4, p_image->get_height() * 5 / 4, Image::INTERPOLATE_CUBIC);
+}
+
+static void resize_lanczos(Ref<Image> &p_image) {
+	p_image->resize(p_image->get_width() / 3, p_image->get_height() * 2, Image::INTERPOLATE_LANCZOS);
+}
+
+static void resize_nearest(Ref<Image> &p_image) {
+	p_image->resize(p_image->get_width() * 2, p_image->get_height() / 2, Image::INTERPOLATE_NEAREST);
+}
+
+static void generate_mipmaps(Ref<Image> &p_image) {
+	p_image->generate_mipmaps();
+}
+
+static void generate_mipmaps_srgb(Ref<Image> &p_image) {
+	p_image->generate_mipmaps(false, true);
+}
+
+static void convert_rgba8(Ref<Image> &p_image) {
+	p_image->convert(Image::FORMAT_RGBA8);
+}
+
+static void convert_rgbaf(Ref<Image> &p_image) {
+	p_image->convert(Image::FORMAT_RGBAF);
+}
+
+TEST_CASE("[Image] Threaded and SIMD processing match the serial result") {
+	// Odd sizes, so bands and SIMD loops have leftovers.
+	const Image::Format formats[] = { Image::FORMAT_L8, Image::FORMAT_RGB8, Image::FORMAT_RGBA8, Image::FORMAT_RGBAH, Image::FORMAT_RGBAF };
+	for (int i = 0; i < 5; i++) {
+		Ref<Image> image = make_noise(301, 203, formats[i], i);
+
+		CHECK(matches_serial(image, resize_bilinear));
+		CHECK(matches_serial(image, resize_cubic));
+		CHECK(matches_serial(image, resize_lanczos));
+		CHECK(matches_serial(image, resize_nearest));
+		CHECK(matches_serial(image, generate_mipmaps));
+		CHECK(matches_serial(image, generate_mipmaps_srgb));
+		CHECK(matches_serial(image, convert_rgba8));
+		CHECK(matches_serial(image, convert_rgbaf));
+	}
+}
+
+TEST_CASE("[Image] Conversion between RGBA8 and RGBAF matches get_pixel() and set_pixel()") {
+	Ref<Image> image = make_noise(64, 64, Image::FORMAT_RGBA8, 7);
+	// Every byte value, including the extremes.
+	Vector<uint8_t> data = image->get_data();
+	for (int i = 0; i < 256; i++) {
+		data.write[i * 4 + 0] = i;
+		data.write[i * 4 + 1] = 255 - i;
+	}
+	image->create(64, 64, false, Image::FORMAT_RGBA8, data);
+
+	Ref<Image> rgbaf = image->duplicate();
+	rgbaf->convert(Image::FORMAT_RGBAF);
+	bool same_colors = true;
+	for (int y = 0; y < 64; y++) {
+		for (int x = 0; x < 64; x++) {
+			same_colors = same_colors && rgbaf->get_pixel(x, y) == image->get_pixel(x, y);
+		}
+	}
+	CHECK(same_colors);
+
+	// Out of range values are clamped.
+	rgbaf->set_pixel(0, 0, Color(-0.5, 1.5, 1.0 / 255.0, 254.5 / 255.0));
+	Ref<Image> expected;
+	expected.instance();
+	expected->create(64, 64, false, Image::FORMAT_RGBA8);
+	for (int y = 0; y < 64; y++) {
+		for (int x = 0; x < 64; x++) {
+			expected->set_pixel(x, y, rgbaf->get_pixel(x, y));
+		}
+	}
+	rgbaf->convert(Image::FORMAT_RGBA8);
+	CHECK(data_equal(rgbaf, expected));
+}
+
+TEST_CASE("[Image] sRGB mipmaps average in linear space") {
+	Ref<Image> image;
+	image.instance();
+	image->create(64, 64, false, Image::FORMAT_RGBA8);
+	for (int y = 0; y < 64; y++) {
+		for (int x = 0; x < 64; x++) {
+			// Black and white checkerboard, with alpha alternating between 0 and 255 too.
+			image->set_pixel(x, y, ((x + y) & 1) ? Color(1, 1, 1, 1) : Color(0, 0, 0, 0));
+		}
+	}
+
+	Ref<Image> linear = image->duplicate();
+	linear->generate_mipmaps();
+	Ref<Image> srgb = image->duplicate();
+	srgb->generate_mipmaps(false, true);
+
+	int ofs = srgb->get_mipmap_offset(1);
+	// Half the light of white is 188 in sRGB, not 128.
+	CHECK(linear->get_data()[ofs] == 128);
+	CHECK(srgb->get_data()[ofs] >= 187);
+	CHECK(srgb->get_data()[ofs] <= 188);
+	// Alpha isn't color.
+	CHECK(srgb->get_data()[ofs + 3] == 128);
+
+	// A flat color stays the same at every level.
+	image->fill(Color(0.15, 0.5, 0.85, 0.3));
+	image->generate_mipmaps(false, true);
+	Vector<uint8_t> mipmaps = image->get_data();
+	int size;
+	image->get_mipmap_offset_and_size(image->get_mipmap_count(), ofs, size);
+	CHECK(memcmp(mipmaps.ptr(), mipmaps.ptr() + ofs, 4) == 0);
+}
+
+template <class M>
+static double time_usec(const Ref<Image> &p_image, M p_method, int p_threads) {
+	Image::set_thread_count(p_threads);
+	Image::set_simd_enabled(p_threads != 0);
+
+	uint64_t best = UINT64_MAX;
+	for (int i = 0; i < 3; i++) {
+		Ref<Image> image = p_image->duplicate();
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		p_method(image);
+		best = MIN(best, OS::get_singleton()->get_ticks_usec() - begin);
+	}
+
+	Image::set_thread_count(-1);
+	Image::set_simd_enabled(true);
+	return best;
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[Image] Benchmark resizing, mipmaps and conversion" * doctest::skip()) {
+	const Image::Format formats[] = { Image::FORMAT_RGB8, Image::FORMAT_RGBA8, Image::FORMAT_RGBAF };
+	const int sizes[] = { 256, 1024 };
+	const int threads = MAX(Image::get_thread_count(), 1);
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 2; j++) {
+			Ref<Image> image = make_noise(sizes[j], sizes[j], formats[i], j);
+
+			struct {
+				const char *name;
+				void (*method)(Ref<Image> &);
+			} operations[] = {
+				{ "bilinear", resize_bilinear },
+				{ "lanczos", resize_lanczos },
+				{ "mipmaps", generate_mipmaps },
+				{ "sRGB mipmaps", generate_mipmaps_srgb },
+				{ "to RGBAF", convert_rgbaf },
+				{ "to RGBA8", convert_rgba8 },
+			};
+
+			for (int k = 0; k < 6; k++) {
+				if ((k == 4 && formats[i] == Image::FORMAT_RGBAF) || (k == 5 && formats[i] == Image::FORMAT_RGBA8)) {
+					continue; // Already in that format.
+				}
+				double fast = time_usec(image, operations[k].method, -1);
+				double serial = time_usec(image, operations[k].method, 0);
+				String name = vformat("%s %dx%d %s", Image::get_format_name(formats[i]), sizes[j], sizes[j], operations[k].name);
+				MESSAGE(vformat("%s: %.2f ms with %d threads and SIMD, %.2f ms serial scalar.", name, fast / 1000.0, threads, serial / 1000.0).utf8().get_data());
+			}
+		}
+	}
+}
+
+} // namespace TestImage
+
+#endif // TEST_IMAGE_H
@@ -0,0 +1,176 @@
+/*************************************************************************/
+/*  test_image_compress.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_IMAGE_COMPRESS_H
+#define TEST_IMAGE_COMPRESS_H
+
+#include "core/image.h"
+#include "core/os/os.h"
+#include "tests/test_image.h"
+
+#ifdef MODULE_CVTT_ENABLED
+#include "modules/cvtt/image_compress_cvtt.h"
+#endif
+#ifdef MODULE_ETC_ENABLED
+#include "modules/etc/image_etc.h"
+#endif
+#ifdef MODULE_SQUISH_ENABLED
+#include "modules/squish/image_compress_squish.h"
+#endif
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestImageCompress {
+
+using TestImage::data_equal;
+using TestImage::make_noise;
+
+typedef void (*CompressFunc)(Image *);
+
+struct Compressor {
+	const char *name;
+	CompressFunc compress;
+	bool in_place = true; // False when the compressed data is returned separately and the image is left as is.
+};
+
+#ifdef MODULE_CVTT_ENABLED
+static void compress_bptc(Image *p_image) {
+	image_compress_cvtt(p_image, 0.0, Image::USED_CHANNELS_RGBA);
+}
+#endif
+
+#ifdef MODULE_ETC_ENABLED
+static void compress_etc2(Image *p_image) {
+	p_image->compress(Image::COMPRESS_ETC2, Image::COMPRESS_SOURCE_GENERIC, 0.0);
+}
+#endif
+
+#ifdef MODULE_SQUISH_ENABLED
+static void compress_s3tc(Image *p_image) {
+	image_compress_squish(p_image, 0.0, Image::USED_CHANNELS_RGBA);
+}
+#endif
+
+#ifdef MODULE_BASIS_UNIVERSAL_ENABLED
+// The encoder keeps its own job pool sized from Image::get_thread_count(), so it
+// follows the same thread settings as the other compressors. Mipmaps are dropped,
+// the packer only compresses the base level.
+static void compress_basis(Image *p_image) {
+	Vector<uint8_t> data = Image::basis_universal_packer(Ref<Image>(p_image), Image::USED_CHANNELS_RGBA);
+	CHECK(data.size() > 0);
+}
+#endif
+
+static Vector<Compressor> get_compressors() {
+	Vector<Compressor> compressors;
+#ifdef MODULE_BASIS_UNIVERSAL_ENABLED
+	if (Image::basis_universal_packer) { // Only available in editor builds.
+		compressors.push_back({ "Basis Universal", compress_basis, false });
+	}
+#endif
+#ifdef MODULE_CVTT_ENABLED
+	compressors.push_back({ "BPTC", compress_bptc });
+#endif
+#ifdef MODULE_ETC_ENABLED
+	_register_etc_compress_func();
+	compressors.push_back({ "ETC2", compress_etc2 });
+#endif
+#ifdef MODULE_SQUISH_ENABLED
+	compressors.push_back({ "S3TC", compress_s3tc });
+#endif
+	return compressors;
+}
+
+// Blocks with edges and gradients, less uniform than noise.
+static Ref<Image> make_texture(int p_width, int p_height, bool p_mipmaps) {
+	Ref<Image> image = make_noise(p_width, p_height, Image::FORMAT_RGBA8, 3);
+	for (int y = 0; y < p_height; y++) {
+		for (int x = 0; x < p_width; x++) {
+			Color noise = image->get_pixel(x, y);
+			float r = ((x / 16 + y / 16) & 1) ? 0.8 : 0.2;
+			image->set_pixel(x, y, Color(r, float(x) / p_width, float(y) / p_height, 1.0).lerp(noise, 0.1));
+		}
+	}
+	if (p_mipmaps) {
+		image->generate_mipmaps();
+	}
+	return image;
+}
+
+TEST_CASE("[ImageCompress] Threaded compression matches single threaded compression") {
+	Vector<Compressor> compressors = get_compressors();
+	// Odd size, so the last block row and column are partial.
+	Ref<Image> source = make_texture(301, 203, true);
+
+	for (int i = 0; i < compressors.size(); i++) {
+		if (!compressors[i].in_place) {
+			continue;
+		}
+		Ref<Image> results[2];
+		for (int j = 0; j < 2; j++) {
+			Image::set_thread_count(j == 0 ? 4 : 0);
+			results[j] = source->duplicate();
+			compressors[i].compress(results[j].ptr());
+		}
+		Image::set_thread_count(-1);
+
+		CHECK_MESSAGE(results[0]->is_compressed(), compressors[i].name);
+		CHECK_MESSAGE(data_equal(results[0], results[1]), compressors[i].name);
+	}
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[ImageCompress] Benchmark compressing a texture set" * doctest::skip()) {
+	// One texture per format, as when importing a texture set. Kept small,
+	// the slowest compressors take several seconds per megapixel on one thread.
+	const int size = 1024;
+	Vector<Compressor> compressors = get_compressors();
+	Ref<Image> source = make_texture(size, size, true);
+	const int threads = MAX(Image::get_thread_count(), 1);
+
+	for (int i = 0; i < compressors.size(); i++) {
+		uint64_t usec[2];
+		for (int j = 0; j < 2; j++) {
+			Image::set_thread_count(j == 0 ? -1 : 0);
+			Ref<Image> image = source->duplicate();
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			compressors[i].compress(image.ptr());
+			usec[j] = OS::get_singleton()->get_ticks_usec() - begin;
+		}
+		Image::set_thread_count(-1);
+
+		String label = vformat("%s %dx%d with mipmaps", compressors[i].name, size, size);
+		MESSAGE(vformat("%s: %.0f ms with %d threads, %.0f ms on one.", label, usec[0] / 1000.0, threads, usec[1] / 1000.0).utf8().get_data());
+	}
+}
+
+} // namespace TestImageCompress
+
+#endif // TEST_IMAGE_COMPRESS_H
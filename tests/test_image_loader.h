@@ -0,0 +1,261 @@
+/*************************************************************************/
+/*  test_image_loader.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_IMAGE_LOADER_H
+#define TEST_IMAGE_LOADER_H
+
+#include "core/io/image_loader.h"
+#include "core/io/marshalls.h"
+#include "tests/test_image.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestImageLoader {
+
+using TestImage::data_equal;
+using TestImage::make_noise;
+
+// Width and height as 16 bits each, followed by RGBA8 pixels.
+static Vector<uint8_t> encode_raw(const Ref<Image> &p_image) {
+	Vector<uint8_t> pixels = p_image->get_data();
+	Vector<uint8_t> buffer;
+	buffer.resize(4 + pixels.size());
+	encode_uint16(p_image->get_width(), buffer.ptrw());
+	encode_uint16(p_image->get_height(), buffer.ptrw() + 2);
+	copymem(buffer.ptrw() + 4, pixels.ptr(), pixels.size());
+	return buffer;
+}
+
+class TestRawLoader : public ImageFormatLoader {
+public:
+	virtual Error load_image(Ref<Image> p_image, FileAccess *f, bool p_force_linear, float p_scale) override {
+		Vector<uint8_t> buffer;
+		buffer.resize(f->get_len());
+		f->get_buffer(buffer.ptrw(), buffer.size());
+
+		Size2i size;
+		Image::Format format;
+		Error err = get_buffer_info(buffer.ptr(), buffer.size(), size, format);
+		if (err != OK) {
+			return err;
+		}
+		Vector<uint8_t> pixels;
+		pixels.resize(buffer.size() - 4);
+		copymem(pixels.ptrw(), buffer.ptr() + 4, pixels.size());
+		p_image->create(size.width, size.height, false, format, pixels);
+		return OK;
+	}
+
+	virtual void get_recognized_extensions(List<String> *p_extensions) const override {
+		p_extensions->push_back(extension);
+	}
+
+	virtual bool can_decode_buffer() const override { return decode_buffers; }
+
+	virtual Error get_buffer_info(const uint8_t *p_buffer, int p_size, Size2i &r_size, Image::Format &r_format) const override {
+		if (p_size < 4) {
+			return ERR_FILE_CORRUPT;
+		}
+		r_size = Size2i(decode_uint16(p_buffer), decode_uint16(p_buffer + 2));
+		r_format = Image::FORMAT_RGBA8;
+		return p_size == 4 + r_size.width * r_size.height * 4 ? OK : ERR_FILE_CORRUPT;
+	}
+
+	virtual Error decode_buffer(const uint8_t *p_buffer, int p_size, int p_reduce, uint8_t *p_dst) const override {
+		int width = decode_uint16(p_buffer);
+		int height = decode_uint16(p_buffer + 2);
+		ImageRowReducer reducer;
+		reducer.init(width, height, 4, p_reduce, p_dst);
+		for (int y = 0; y < height; y++) {
+			reducer.push_row(p_buffer + 4 + y * width * 4, 4);
+		}
+		return OK;
+	}
+
+	String extension;
+	bool decode_buffers = true;
+};
+
+TEST_CASE("[ImageLoader] Row reducer") {
+	Ref<Image> image = make_noise(64, 32, Image::FORMAT_RGBA8, 1);
+	Vector<uint8_t> pixels = image->get_data();
+
+	SUBCASE("Halving matches the mipmaps") {
+		Vector<uint8_t> reduced;
+		reduced.resize(32 * 16 * 4);
+		ImageRowReducer reducer;
+		reducer.init(64, 32, 4, 1, reduced.ptrw());
+		for (int y = 0; y < 32; y++) {
+			reducer.push_row(pixels.ptr() + y * 64 * 4, 4);
+		}
+		CHECK(reducer.is_done());
+
+		Ref<Image> expected = image->duplicate();
+		expected->shrink_x2();
+		CHECK(memcmp(expected->get_data().ptr(), reduced.ptr(), reduced.size()) == 0);
+	}
+
+	SUBCASE("Pixel stride and odd sizes") {
+		// Three of the four components, 5x3 reduced to 2x1: the last column takes three pixels.
+		Vector<uint8_t> reduced;
+		reduced.resize(2 * 1 * 3);
+		ImageRowReducer reducer;
+		reducer.init(5, 3, 3, 1, reduced.ptrw());
+		for (int y = 0; y < 3; y++) {
+			reducer.push_row(pixels.ptr() + y * 64 * 4, 4);
+		}
+
+		for (int c = 0; c < 3; c++) {
+			uint32_t sum = 0;
+			for (int y = 0; y < 3; y++) {
+				for (int x = 2; x < 5; x++) {
+					sum += pixels[(y * 64 + x) * 4 + c];
+				}
+			}
+			CHECK(reduced[3 + c] == (sum + 4) / 9);
+		}
+	}
+
+	SUBCASE("Reduced to a single pixel") {
+		uint8_t pixel[4];
+		ImageRowReducer reducer;
+		reducer.init(64, 32, 4, 8, pixel);
+		for (int y = 0; y < 32; y++) {
+			reducer.push_row(pixels.ptr() + y * 64 * 4, 4);
+		}
+
+		uint32_t sum = 0;
+		for (int i = 0; i < 64 * 32; i++) {
+			sum += pixels[i * 4];
+		}
+		CHECK(pixel[0] == (sum + 1024) / 2048);
+	}
+}
+
+TEST_CASE("[ImageLoader] Batch decoding") {
+	TestRawLoader buffer_loader;
+	buffer_loader.extension = "testraw";
+	TestRawLoader file_loader;
+	file_loader.extension = "testfile";
+	file_loader.decode_buffers = false;
+	ImageLoader::add_image_format_loader(&buffer_loader);
+	ImageLoader::add_image_format_loader(&file_loader);
+
+	const int count = 12;
+	Ref<Image> images[count];
+	Vector<ImageLoader::DecodeItem> items;
+	items.resize(count);
+	for (int i = 0; i < count; i++) {
+		images[i] = make_noise(64 + i * 8, 48 - i * 2, Image::FORMAT_RGBA8, i);
+		ImageLoader::DecodeItem &item = items.write[i];
+		item.buffer = encode_raw(images[i]);
+		item.extension = i == 0 ? "testfile" : "testraw";
+	}
+
+	SUBCASE("Full size, into new images") {
+		Image::set_thread_count(4);
+		CHECK(ImageLoader::decode_batch(items.ptrw(), count) == OK);
+		Image::set_thread_count(-1);
+
+		for (int i = 0; i < count; i++) {
+			CHECK(items[i].error == OK);
+			CHECK(items[i].size == images[i]->get_size());
+			CHECK(data_equal(items[i].image, images[i]));
+		}
+	}
+
+	SUBCASE("Reduced, into caller buffers") {
+		Vector<Vector<uint8_t>> buffers;
+		buffers.resize(count);
+		for (int i = 1; i < count; i++) {
+			ImageLoader::DecodeItem &item = items.write[i];
+			Size2i size;
+			Image::Format format;
+			REQUIRE(ImageLoader::get_buffer_info(item.extension, item.buffer.ptr(), item.buffer.size(), size, format) == OK);
+			item.reduce = 1;
+			buffers.write[i].resize(ImageLoader::get_decoded_size(size, format, item.reduce));
+			item.dst = buffers.write[i].ptrw();
+			item.dst_size = buffers[i].size();
+		}
+		// One too small.
+		items.write[count - 1].dst_size--;
+
+		Image::set_thread_count(4);
+		CHECK(ImageLoader::decode_batch(items.ptrw(), count) == ERR_INVALID_PARAMETER);
+		Image::set_thread_count(-1);
+
+		CHECK(items[count - 1].error == ERR_INVALID_PARAMETER);
+		for (int i = 1; i < count - 1; i++) {
+			CHECK(items[i].error == OK);
+			CHECK(items[i].image.is_null());
+			Ref<Image> expected = images[i]->duplicate();
+			expected->shrink_x2();
+			CHECK(items[i].size == expected->get_size());
+			CHECK(memcmp(buffers[i].ptr(), expected->get_data().ptr(), buffers[i].size()) == 0);
+		}
+	}
+
+	SUBCASE("Errors") {
+		items.write[1].extension = "unknown";
+		items.write[2].buffer.resize(10);
+		CHECK(ImageLoader::decode_batch(items.ptrw(), count) != OK);
+		CHECK(items[1].error == ERR_FILE_UNRECOGNIZED);
+		CHECK(items[2].error == ERR_FILE_CORRUPT);
+		CHECK(items[3].error == OK);
+	}
+
+	ImageLoader::remove_image_format_loader(&buffer_loader);
+	ImageLoader::remove_image_format_loader(&file_loader);
+}
+
+TEST_CASE("[ImageLoader] PNG decoding at reduced sizes") {
+	if (!ImageLoader::recognize("png") || !Image::save_png_buffer_func) {
+		return;
+	}
+
+	Ref<Image> image = make_noise(96, 64, Image::FORMAT_RGBA8, 7);
+	ImageLoader::DecodeItem items[3];
+	for (int i = 0; i < 3; i++) {
+		items[i].buffer = image->save_png_to_buffer();
+		items[i].extension = "png";
+		items[i].reduce = i;
+	}
+	CHECK(ImageLoader::decode_batch(items, 3) == OK);
+
+	CHECK(data_equal(items[0].image, image));
+	Ref<Image> expected = image->duplicate();
+	expected->shrink_x2();
+	CHECK(data_equal(items[1].image, expected));
+	CHECK(items[2].size == Size2i(24, 16));
+}
+
+} // namespace TestImageLoader
+
+#endif // TEST_IMAGE_LOADER_H
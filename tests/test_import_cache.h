@@ -0,0 +1,143 @@
+/*************************************************************************/
+/*  test_import_cache.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_IMPORT_CACHE_H
+#define TEST_IMPORT_CACHE_H
+
+#ifdef TOOLS_ENABLED
+
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "editor/import/editor_import_cache.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestImportCache {
+
+class TestImporter : public ResourceImporter {
+public:
+	virtual String get_importer_name() const override { return "test"; }
+	virtual String get_visible_name() const override { return "Test"; }
+	virtual void get_recognized_extensions(List<String> *p_extensions) const override { p_extensions->push_back("txt"); }
+	virtual String get_save_extension() const override { return "res"; }
+	virtual String get_resource_type() const override { return "Resource"; }
+	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const override {}
+	virtual bool get_option_visibility(const String &p_option, const Map<StringName, Variant> &p_options) const override { return true; }
+	virtual Error import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files = nullptr, Variant *r_metadata = nullptr) override { return OK; }
+};
+
+static void _write_file(const String &p_path, const String &p_contents) {
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(f);
+	f->store_string(p_contents);
+}
+
+static String _read_file(const String &p_path) {
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		return String();
+	}
+	return f->get_as_utf8_string();
+}
+
+TEST_CASE("[ImportCache] Store and restore imports by content") {
+	const String dir = OS::get_singleton()->get_cache_path().plus_file("godot_test_import_cache");
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(dir.plus_file("cache"));
+	da->make_dir_recursive(dir.plus_file("project"));
+
+	const String source = dir.plus_file("project/icon.txt");
+	const String copy = dir.plus_file("project/copy.txt");
+	_write_file(source, "source data");
+	_write_file(copy, "source data");
+
+	Ref<ResourceImporter> importer = memnew(TestImporter);
+	Map<StringName, Variant> options;
+	options["compress"] = true;
+	options["scale"] = 2.0;
+
+	const String key = EditorImportCache::get_key(source, importer, options);
+	CHECK_MESSAGE(
+			key == EditorImportCache::get_key(copy, importer, options),
+			"Files with the same contents should share cache entries.");
+
+	options["scale"] = 3.0;
+	CHECK_MESSAGE(
+			key != EditorImportCache::get_key(source, importer, options),
+			"Changing an option should change the cache key.");
+	options["scale"] = 2.0;
+
+	EditorImportCache cache;
+	cache.set_cache_path(dir.plus_file("cache"));
+
+	List<String> variants;
+	List<String> gen_files;
+	Variant metadata;
+	CHECK(!cache.restore(key, dir.plus_file("project/copy"), &variants, &gen_files, &metadata));
+
+	const String base_path = dir.plus_file("project/icon");
+	Vector<String> dest_paths;
+	dest_paths.push_back(base_path + ".s3tc.res");
+	dest_paths.push_back(base_path + ".etc2.res");
+	_write_file(dest_paths[0], "s3tc data");
+	_write_file(dest_paths[1], "etc2 data");
+	variants.push_back("s3tc");
+	variants.push_back("etc2");
+	Dictionary md;
+	md["vram_texture"] = true;
+
+	REQUIRE(cache.store(key, base_path, dest_paths, variants, gen_files, md) == OK);
+
+	Vector<String> outside;
+	outside.push_back(dir.plus_file("elsewhere.res"));
+	CHECK_MESSAGE(
+			cache.store(key, base_path, outside, variants, gen_files, md) == ERR_UNAVAILABLE,
+			"Files outside of the import base path can't be cached.");
+
+	variants.clear();
+	REQUIRE(cache.restore(key, dir.plus_file("project/copy"), &variants, &gen_files, &metadata));
+	CHECK(variants.size() == 2);
+	CHECK(variants.front()->get() == "s3tc");
+	CHECK(_read_file(dir.plus_file("project/copy.s3tc.res")) == "s3tc data");
+	CHECK(_read_file(dir.plus_file("project/copy.etc2.res")) == "etc2 data");
+	CHECK(bool(Dictionary(metadata)["vram_texture"]));
+
+	if (da->change_dir(dir) == OK) {
+		da->erase_contents_recursive();
+	}
+	da->remove(dir);
+}
+
+} // namespace TestImportCache
+
+#endif // TOOLS_ENABLED
+
+#endif // TEST_IMPORT_CACHE_H
@@ -0,0 +1,174 @@
+/*************************************************************************/
+/*  test_instance_transform_slots.h                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_INSTANCE_TRANSFORM_SLOTS_H
+#define TEST_INSTANCE_TRANSFORM_SLOTS_H
+
+#include "core/local_vector.h"
+#include "servers/rendering/rasterizer_rd/instance_transform_slots_rd.h"
+
+#include "tests/test_macros.h"
+
+namespace TestInstanceTransformSlots {
+
+typedef InstanceTransformSlotsRD::Upload Upload;
+
+static const uint32_t REGION_SIZE = InstanceTransformSlotsRD::DIRTY_REGION_SIZE;
+
+static void _allocate(InstanceTransformSlotsRD &p_slots, uint32_t p_count) {
+	for (uint32_t i = 0; i < p_count; i++) {
+		p_slots.allocate();
+	}
+}
+
+TEST_CASE("[InstanceTransformSlots] Allocates in order and grows by doubling") {
+	InstanceTransformSlotsRD slots;
+	slots.init(128);
+	CHECK(slots.get_capacity() == 128);
+	CHECK(slots.get_slot_count() == 0);
+
+	bool in_order = true;
+	for (uint32_t i = 0; i < 128; i++) {
+		in_order = in_order && slots.allocate() == i;
+	}
+	CHECK_MESSAGE(in_order, "Slots should be handed out in order while none were freed.");
+	CHECK(slots.get_capacity() == 128);
+	CHECK_FALSE(slots.is_resized());
+
+	CHECK(slots.allocate() == 128);
+	CHECK(slots.get_capacity() == 256);
+	CHECK(slots.get_slot_count() == 129);
+	CHECK_MESSAGE(slots.is_resized(), "The buffer must be recreated after growing.");
+
+	LocalVector<Upload> uploads;
+	slots.get_uploads(uploads);
+	REQUIRE_MESSAGE(uploads.size() == 1, "A recreated buffer should be uploaded whole.");
+	CHECK(uploads[0].from == 0);
+	CHECK(uploads[0].to == 129);
+	CHECK_FALSE(slots.is_resized());
+
+	slots.get_uploads(uploads);
+	CHECK_MESSAGE(uploads.size() == 0, "Nothing changed since the last upload.");
+}
+
+TEST_CASE("[InstanceTransformSlots] Reuses freed slots before growing") {
+	InstanceTransformSlotsRD slots;
+	slots.init(64);
+	_allocate(slots, 64);
+
+	slots.set_version(10, 5);
+	slots.set_version(20, 7);
+	CHECK(slots.get_version(10) == 5);
+
+	slots.free(10);
+	slots.free(20);
+	CHECK_MESSAGE(slots.get_version(10) == 0, "Freeing a slot should reset its version.");
+	CHECK(slots.get_version(20) == 0);
+
+	uint32_t a = slots.allocate();
+	uint32_t b = slots.allocate();
+	CHECK(((a == 10 && b == 20) || (a == 20 && b == 10)));
+	CHECK_MESSAGE(slots.get_capacity() == 64, "Reusing freed slots should not grow the buffer.");
+	CHECK(slots.get_slot_count() == 64);
+	CHECK_FALSE(slots.is_resized());
+
+	CHECK(slots.allocate() == 64);
+	CHECK(slots.get_capacity() == 128);
+
+	ERR_PRINT_OFF;
+	slots.free(1000);
+	ERR_PRINT_ON;
+	CHECK_MESSAGE(slots.allocate() == 65, "Freeing a slot never handed out should be ignored.");
+}
+
+TEST_CASE("[InstanceTransformSlots] Uploads runs of dirty regions") {
+	InstanceTransformSlotsRD slots;
+	slots.init(REGION_SIZE * 20);
+	_allocate(slots, REGION_SIZE * 20 - 10);
+
+	LocalVector<Upload> uploads;
+	slots.get_uploads(uploads);
+	CHECK(uploads.size() == 0);
+
+	// Regions 2 and 3 are adjacent and merge, 7 stands alone, the last region is partially used.
+	slots.mark_dirty(REGION_SIZE * 2 + 1);
+	slots.mark_dirty(REGION_SIZE * 3 + 5);
+	slots.mark_dirty(REGION_SIZE * 3 + 6);
+	slots.mark_dirty(REGION_SIZE * 7);
+	slots.mark_dirty(REGION_SIZE * 19 + 3);
+	CHECK_MESSAGE(slots.get_dirty_region_count() == 4, "Slots in the same region should be counted once.");
+
+	slots.get_uploads(uploads);
+	REQUIRE(uploads.size() == 3);
+	CHECK(uploads[0].from == REGION_SIZE * 2);
+	CHECK(uploads[0].to == REGION_SIZE * 4);
+	CHECK(uploads[1].from == REGION_SIZE * 7);
+	CHECK(uploads[1].to == REGION_SIZE * 8);
+	CHECK(uploads[2].from == REGION_SIZE * 19);
+	CHECK_MESSAGE(uploads[2].to == REGION_SIZE * 20 - 10, "Unused slots past the last one handed out should not be uploaded.");
+	CHECK(slots.get_dirty_region_count() == 0);
+
+	slots.get_uploads(uploads);
+	CHECK(uploads.size() == 0);
+}
+
+TEST_CASE("[InstanceTransformSlots] Uploads everything from a quarter of the regions dirty") {
+	InstanceTransformSlotsRD slots;
+	slots.init(REGION_SIZE * 24);
+	_allocate(slots, REGION_SIZE * 24);
+
+	// 5 of 24 regions (about 21%) are uploaded one by one.
+	for (uint32_t i = 0; i < 5; i++) {
+		slots.mark_dirty(REGION_SIZE * i * 2);
+	}
+	LocalVector<Upload> uploads;
+	slots.get_uploads(uploads);
+	CHECK(uploads.size() == 5);
+
+	// 6 of 24 regions (25%) are uploaded with the rest of the buffer.
+	for (uint32_t i = 0; i < 6; i++) {
+		slots.mark_dirty(REGION_SIZE * i * 2);
+	}
+	slots.get_uploads(uploads);
+	REQUIRE(uploads.size() == 1);
+	CHECK(uploads[0].from == 0);
+	CHECK(uploads[0].to == REGION_SIZE * 24);
+
+	// The dirty flags were cleared along with the full upload.
+	slots.mark_dirty(REGION_SIZE * 23);
+	slots.get_uploads(uploads);
+	REQUIRE(uploads.size() == 1);
+	CHECK(uploads[0].from == REGION_SIZE * 23);
+	CHECK(uploads[0].to == REGION_SIZE * 24);
+}
+
+} // namespace TestInstanceTransformSlots
+
+#endif // TEST_INSTANCE_TRANSFORM_SLOTS_H
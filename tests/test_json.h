@@ -0,0 +1,203 @@
+/*************************************************************************/
+/*  test_json.h                                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TEST_JSON_H
+#define TEST_JSON_H
+
+#include "core/io/json.h"
+#include "core/os/os.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestJSON {
+
+TEST_CASE("[JSON] Parsing into Variants") {
+	const String json = "{\"a\": [1, 2.5, -3e2, \"x\\ny\"], \"b\": {\"c\": true, \"d\": null}, \"\\u00e9\": false}";
+	Variant result;
+	String err_str;
+	int err_line;
+
+	REQUIRE(JSON::parse(json, result, err_str, err_line) == OK);
+	Dictionary d = result;
+	Array a = d["a"];
+	CHECK(a.size() == 4);
+	CHECK(double(a[0]) == 1.0);
+	CHECK(double(a[1]) == 2.5);
+	CHECK(double(a[2]) == -300.0);
+	CHECK(String(a[3]) == "x\ny");
+	Dictionary b = d["b"];
+	CHECK(bool(b["c"]) == true);
+	CHECK(b["d"].get_type() == Variant::NIL);
+	CHECK(d.has(String::chr(0xe9)));
+
+	CharString utf8 = json.utf8();
+	Variant result_utf8;
+	REQUIRE(JSON::parse_utf8((const uint8_t *)utf8.get_data(), utf8.length(), result_utf8, err_str, err_line) == OK);
+	CHECK_MESSAGE(
+			JSON::print(result_utf8) == JSON::print(result),
+			"Parsing from UTF-8 should give the same result as parsing from a String.");
+}
+
+TEST_CASE("[JSON] Parse errors") {
+	Variant result;
+	String err_str;
+	int err_line;
+
+	CHECK(JSON::parse("[1, 2", result, err_str, err_line) == ERR_PARSE_ERROR);
+	CHECK(err_str == "Expected ']'");
+	CHECK(JSON::parse("{\"a\" 1}", result, err_str, err_line) == ERR_PARSE_ERROR);
+	CHECK(err_str == "Expected ':'");
+	CHECK(JSON::parse("\n\n[nope]", result, err_str, err_line) == ERR_PARSE_ERROR);
+	CHECK(err_line == 2);
+}
+
+TEST_CASE("[JSON] Malformed input leaves the result untouched") {
+	String err_str;
+	int err_line;
+
+	Variant result = "previous";
+	CHECK(JSON::parse("{\"a\": [1, 2, {\"b\": 3}", result, err_str, err_line) == ERR_PARSE_ERROR);
+	CHECK(result == Variant("previous"));
+
+	const CharString utf8 = String("[[1, 2], [3,").utf8();
+	CHECK(JSON::parse_utf8((const uint8_t *)utf8.get_data(), utf8.length(), result, err_str, err_line) == ERR_PARSE_ERROR);
+	CHECK(result == Variant("previous"));
+}
+
+static Error _count_events(void *p_userdata, JSON::ParseEvent p_event, const Variant &p_value) {
+	int *counts = (int *)p_userdata;
+	counts[p_event]++;
+	return OK;
+}
+
+TEST_CASE("[JSON] Streaming events") {
+	int counts[JSON::PARSE_EVENT_VALUE + 1] = {};
+	String err_str;
+	int err_line;
+
+	REQUIRE(JSON::parse_events("{\"a\": [1, {\"b\": 2}], \"c\": \"d\"}", _count_events, counts, err_str, err_line) == OK);
+	CHECK(counts[JSON::PARSE_EVENT_OBJECT_BEGIN] == 2);
+	CHECK(counts[JSON::PARSE_EVENT_OBJECT_END] == 2);
+	CHECK(counts[JSON::PARSE_EVENT_ARRAY_BEGIN] == 1);
+	CHECK(counts[JSON::PARSE_EVENT_ARRAY_END] == 1);
+	CHECK(counts[JSON::PARSE_EVENT_KEY] == 3);
+	CHECK(counts[JSON::PARSE_EVENT_VALUE] == 3);
+}
+
+TEST_CASE("[JSON] Printing") {
+	Dictionary d;
+	Array a;
+	a.push_back(1);
+	a.push_back("two");
+	d["b"] = a;
+	d["a"] = Variant();
+
+	CHECK(JSON::print(d) == "{\"a\":null,\"b\":[1,\"two\"]}");
+	CHECK(JSON::print(d, "\t") == "{\n\t\"a\": null,\n\t\"b\": [\n\t\t1,\n\t\t\"two\"\n\t]\n}");
+}
+
+// Records like a large save file or exported table, about 185 bytes each when printed.
+static Array make_records(int p_count) {
+	Array records;
+	records.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		Dictionary record;
+		record["id"] = i;
+		record["name"] = vformat("Record %d \"quoted\"\n", i);
+		Array position;
+		position.push_back(i * 0.5);
+		position.push_back(-i * 0.25);
+		position.push_back(1e-3 * i);
+		record["position"] = position;
+		record["enabled"] = (i & 1) == 0;
+		record["parent"] = i > 0 ? Variant(i - 1) : Variant();
+		Dictionary stats;
+		stats["health"] = 100 - i % 100;
+		stats["speed"] = 1.5 + (i % 7) * 0.125;
+		Array tags;
+		tags.push_back("enemy");
+		tags.push_back("flying");
+		tags.push_back(String::chr(0xe9) + "t" + String::chr(0xe9));
+		stats["tags"] = tags;
+		record["stats"] = stats;
+		records[i] = record;
+	}
+	return records;
+}
+
+static Error _ignore_events(void *p_userdata, JSON::ParseEvent p_event, const Variant &p_value) {
+	(*(int *)p_userdata)++;
+	return OK;
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[JSON] Benchmark printing and parsing a large document" * doctest::skip()) {
+	const int count = 250000; // About 45 MB.
+	Array records = make_records(count);
+	String err_str;
+	int err_line;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	String json = JSON::print(records);
+	uint64_t print_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	CharString utf8 = json.utf8();
+	const double mb = utf8.length() / 1048576.0;
+
+	Variant parsed;
+	begin = OS::get_singleton()->get_ticks_usec();
+	Error err = JSON::parse(json, parsed, err_str, err_line);
+	uint64_t parse_usec = OS::get_singleton()->get_ticks_usec() - begin;
+	CHECK(err == OK);
+	CHECK(Array(parsed).size() == count);
+
+	Variant parsed_utf8;
+	begin = OS::get_singleton()->get_ticks_usec();
+	err = JSON::parse_utf8((const uint8_t *)utf8.get_data(), utf8.length(), parsed_utf8, err_str, err_line);
+	uint64_t parse_utf8_usec = OS::get_singleton()->get_ticks_usec() - begin;
+	CHECK(err == OK);
+	CHECK(Array(parsed_utf8).size() == count);
+
+	int events = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	err = JSON::parse_events_utf8((const uint8_t *)utf8.get_data(), utf8.length(), _ignore_events, &events, err_str, err_line);
+	uint64_t events_usec = OS::get_singleton()->get_ticks_usec() - begin;
+	CHECK(err == OK);
+
+	const char *names[4] = { "print", "parse", "parse_utf8", "parse_events_utf8" };
+	uint64_t usec[4] = { print_usec, parse_usec, parse_utf8_usec, events_usec };
+	for (int i = 0; i < 4; i++) {
+		usec[i] = MAX(usec[i], uint64_t(1));
+		MESSAGE(vformat("%s, %.1f MB: %.0f ms, %.1f MB/s.", names[i], mb, usec[i] / 1000.0, mb / (usec[i] / 1000000.0)).utf8().get_data());
+	}
+}
+
+} // namespace TestJSON
+
+#endif // TEST_JSON_H
@@ -33,22 +33,43 @@
 #include "core/list.h"
 
 #include "test_astar.h"
+#include "test_audio_decode_ahead.h"
+#include "test_audio_mix.h"
+#include "test_audio_resampler.h"
+#include "test_audio_voices.h"
 #include "test_basis.h"
+#include "test_basis_transcode_cache.h"
+#include "test_canvas_rect_batcher.h"
 #include "test_class_db.h"
+#include "test_cull_bvh.h"
 #include "test_color.h"
+#include "test_command_queue.h"
 #include "test_gdscript.h"
 #include "test_gradient.h"
 #include "test_gui.h"
+#include "test_image.h"
+#include "test_image_compress.h"
+#include "test_image_loader.h"
+#include "test_import_cache.h"
+#include "test_instance_transform_slots.h"
+#include "test_json.h"
 #include "test_math.h"
+#include "test_mesh_lod.h"
+#include "test_mesh_optimize.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics_2d.h"
 #include "test_physics_3d.h"
+#include "test_radix_sort.h"
 #include "test_render.h"
+#include "test_rendering_server_canvas.h"
+#include "test_resource_format_binary.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_texture_streamer.h"
 #include "test_validate_testing.h"
 #include "test_variant.h"
+#include "test_vertex_compression.h"
 
 #include "modules/modules_tests.gen.h"
 
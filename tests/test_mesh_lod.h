@@ -0,0 +1,232 @@
+/*************************************************************************/
+/*  test_mesh_lod.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESH_LOD_H
+#define TEST_MESH_LOD_H
+
+#include "scene/resources/surface_tool.h"
+#include "servers/rendering/mesh_lod.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestMeshLOD {
+
+// Closed UV sphere, poles and the seam share their vertices so nothing is locked.
+static void _make_sphere(real_t p_radius, int p_rings, int p_segments, Vector<Vector3> &r_vertices, Vector<int> &r_indices) {
+	r_vertices.push_back(Vector3(0, p_radius, 0));
+	for (int i = 1; i < p_rings; i++) {
+		real_t v = Math_PI * i / p_rings;
+		for (int j = 0; j < p_segments; j++) {
+			real_t u = Math_TAU * j / p_segments;
+			r_vertices.push_back(Vector3(Math::sin(v) * Math::cos(u), Math::cos(v), Math::sin(v) * Math::sin(u)) * p_radius);
+		}
+	}
+	r_vertices.push_back(Vector3(0, -p_radius, 0));
+
+	int bottom = r_vertices.size() - 1;
+	for (int j = 0; j < p_segments; j++) {
+		int next = (j + 1) % p_segments;
+		r_indices.push_back(0);
+		r_indices.push_back(1 + next);
+		r_indices.push_back(1 + j);
+
+		int last_ring = 1 + (p_rings - 2) * p_segments;
+		r_indices.push_back(bottom);
+		r_indices.push_back(last_ring + j);
+		r_indices.push_back(last_ring + next);
+	}
+	for (int i = 0; i < p_rings - 2; i++) {
+		int ring = 1 + i * p_segments;
+		for (int j = 0; j < p_segments; j++) {
+			int next = (j + 1) % p_segments;
+			r_indices.push_back(ring + j);
+			r_indices.push_back(ring + next);
+			r_indices.push_back(ring + p_segments + j);
+
+			r_indices.push_back(ring + next);
+			r_indices.push_back(ring + p_segments + next);
+			r_indices.push_back(ring + p_segments + j);
+		}
+	}
+}
+
+// Flat grid of p_size x p_size quads on the XZ plane, also used by the mesh optimization tests.
+static void make_grid(int p_size, Vector<Vector3> &r_vertices, Vector<int> &r_indices) {
+	for (int i = 0; i <= p_size; i++) {
+		for (int j = 0; j <= p_size; j++) {
+			r_vertices.push_back(Vector3(j, 0, i));
+		}
+	}
+	for (int i = 0; i < p_size; i++) {
+		for (int j = 0; j < p_size; j++) {
+			int a = i * (p_size + 1) + j;
+			int b = a + p_size + 1;
+			r_indices.push_back(a);
+			r_indices.push_back(a + 1);
+			r_indices.push_back(b);
+
+			r_indices.push_back(a + 1);
+			r_indices.push_back(b + 1);
+			r_indices.push_back(b);
+		}
+	}
+}
+
+static bool _is_valid_index_array(const Vector<int> &p_indices, int p_vertex_count) {
+	if (p_indices.size() % 3 != 0) {
+		return false;
+	}
+	for (int i = 0; i < p_indices.size(); i += 3) {
+		for (int j = 0; j < 3; j++) {
+			if (p_indices[i + j] < 0 || p_indices[i + j] >= p_vertex_count) {
+				return false;
+			}
+		}
+		if (p_indices[i] == p_indices[i + 1] || p_indices[i + 1] == p_indices[i + 2] || p_indices[i + 2] == p_indices[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[MeshLOD] Simplifying a closed mesh") {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	_make_sphere(1.0, 24, 48, vertices, indices);
+
+	int target = indices.size() / 4 / 3 * 3;
+	float error = 0.0;
+	Vector<int> lod = SurfaceTool::simplify_indices(vertices, indices, target, 1.0, &error);
+
+	CHECK_MESSAGE(lod.size() <= target, "Simplification should reach the requested index count.");
+	CHECK_MESSAGE(lod.size() > 0, "Simplification should not remove the whole mesh.");
+	CHECK_MESSAGE(_is_valid_index_array(lod, vertices.size()), "Simplified indices should be valid and have no degenerate triangles.");
+	CHECK_MESSAGE(error > 0.0, "Simplifying a curved surface should report an error.");
+	CHECK_MESSAGE(error < 0.1, "A quarter of the triangles should still be close to the sphere.");
+
+	// All triangles still face outwards.
+	int flipped = 0;
+	for (int i = 0; i < lod.size(); i += 3) {
+		Vector3 a = vertices[lod[i]];
+		Vector3 b = vertices[lod[i + 1]];
+		Vector3 c = vertices[lod[i + 2]];
+		Vector3 normal = (b - a).cross(c - a);
+		if (normal.dot(a + b + c) < 0.0) {
+			flipped++;
+		}
+	}
+	CHECK_MESSAGE(flipped == 0, "Simplification should not flip triangles.");
+
+	Vector<int> unchanged = SurfaceTool::simplify_indices(vertices, indices, target, 0.0001, &error);
+	CHECK_MESSAGE(unchanged.size() == indices.size(), "No triangles should be removed when every collapse exceeds the error limit.");
+}
+
+TEST_CASE("[MeshLOD] Simplifying keeps open borders") {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	make_grid(16, vertices, indices);
+
+	float error = 1.0;
+	Vector<int> lod = SurfaceTool::simplify_indices(vertices, indices, 0, 1.0, &error);
+
+	CHECK_MESSAGE(lod.size() < indices.size() / 4, "The inside of a flat grid should simplify a lot.");
+	CHECK_MESSAGE(_is_valid_index_array(lod, vertices.size()), "Simplified indices should be valid and have no degenerate triangles.");
+	CHECK_MESSAGE(error == doctest::Approx(0.0), "Simplifying a flat surface should not add any error.");
+
+	for (int i = 0; i < vertices.size(); i++) {
+		if (vertices[i].x == 0 || vertices[i].x == 16 || vertices[i].z == 0 || vertices[i].z == 16) {
+			CHECK_MESSAGE(lod.find(i) != -1, "Border vertices should not be removed.");
+		}
+	}
+}
+
+TEST_CASE("[MeshLOD] Generating LODs from arrays") {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	_make_sphere(2.0, 32, 64, vertices, indices);
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = vertices;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+
+	Dictionary lods = SurfaceTool::generate_lods_from_arrays(arrays, 0.25);
+	REQUIRE_MESSAGE(lods.size() >= 3, "A dense sphere should get several LODs.");
+
+	Array errors = lods.keys();
+	int last_size = indices.size();
+	float last_error = 0.0;
+	for (int i = 0; i < errors.size(); i++) {
+		float error = errors[i];
+		Vector<int> lod = lods[errors[i]];
+		CHECK_MESSAGE(error > last_error, "LOD errors should increase.");
+		CHECK_MESSAGE(lod.size() < last_size, "Each LOD should have fewer triangles than the previous one.");
+		CHECK_MESSAGE(_is_valid_index_array(lod, vertices.size()), "LOD indices should be valid.");
+		last_error = error;
+		last_size = lod.size();
+	}
+
+	arrays[Mesh::ARRAY_INDEX] = Variant();
+	CHECK_MESSAGE(SurfaceTool::generate_lods_from_arrays(arrays, 0.25).empty(), "Non indexed arrays should not get LODs.");
+}
+
+struct TestLOD {
+	float edge_length;
+};
+
+TEST_CASE("[MeshLOD] Screen space error selection") {
+	CameraMatrix perspective;
+	perspective.set_perspective(90, 1.0, 0.1, 100);
+
+	float near_limit = MeshLOD::get_error_limit(perspective, 1000, 10, 1.0, 1.0);
+	float far_limit = MeshLOD::get_error_limit(perspective, 1000, 20, 1.0, 1.0);
+	// With a 90 degree FOV, 1000 pixels span 20 units at distance 10.
+	CHECK(near_limit == doctest::Approx(0.02));
+	CHECK_MESSAGE(far_limit == doctest::Approx(near_limit * 2.0), "The allowed error should grow with distance.");
+	CHECK_MESSAGE(MeshLOD::get_error_limit(perspective, 1000, 10, 2.0, 1.0) == doctest::Approx(near_limit * 0.5), "Scaled up instances should allow less error in mesh space.");
+	CHECK_MESSAGE(MeshLOD::get_error_limit(perspective, 1000, 0, 1.0, 1.0) == 0.0, "Full detail should be used when the camera is inside the instance.");
+	CHECK_MESSAGE(MeshLOD::get_error_limit(perspective, 1000, 10, 1.0, 0.0) == 0.0, "A zero threshold should disable LODs.");
+
+	CameraMatrix orthogonal;
+	orthogonal.set_orthogonal(20, 1.0, 0.1, 100);
+	CHECK_MESSAGE(MeshLOD::get_error_limit(orthogonal, 1000, 10, 1.0, 1.0) == doctest::Approx(MeshLOD::get_error_limit(orthogonal, 1000, 50, 1.0, 1.0)), "Orthogonal projections should not depend on distance.");
+
+	TestLOD lods[3] = { { 0.01 }, { 0.05 }, { 0.2 } };
+	CHECK(MeshLOD::select(lods, 3, 0.0) == 0);
+	CHECK(MeshLOD::select(lods, 3, 0.005) == 0);
+	CHECK(MeshLOD::select(lods, 3, 0.01) == 1);
+	CHECK(MeshLOD::select(lods, 3, 0.1) == 2);
+	CHECK(MeshLOD::select(lods, 3, 10.0) == 3);
+	CHECK(MeshLOD::select(lods, 0, 10.0) == 0);
+}
+
+} // namespace TestMeshLOD
+
+#endif // TEST_MESH_LOD_H
@@ -0,0 +1,204 @@
+/*************************************************************************/
+/*  test_mesh_optimize.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESH_OPTIMIZE_H
+#define TEST_MESH_OPTIMIZE_H
+
+#include "core/math/random_number_generator.h"
+#include "scene/resources/surface_tool.h"
+#include "tests/test_mesh_lod.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestMeshOptimize {
+
+using TestMeshLOD::make_grid;
+
+static void _shuffle_triangles(Vector<int> &r_indices) {
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(1234);
+	int *w = r_indices.ptrw();
+	for (int i = r_indices.size() / 3 - 1; i > 0; i--) {
+		int j = rng->randi_range(0, i);
+		for (int k = 0; k < 3; k++) {
+			SWAP(w[i * 3 + k], w[j * 3 + k]);
+		}
+	}
+}
+
+// Triangles rotated so the smallest index comes first (keeping the winding), then sorted.
+static Vector<Vector3i> _get_triangle_set(const Vector<Vector3> &p_vertices, const Vector<int> &p_indices) {
+	Vector<Vector3i> ret;
+	for (int i = 0; i < p_indices.size(); i += 3) {
+		int a = p_indices[i];
+		int b = p_indices[i + 1];
+		int c = p_indices[i + 2];
+		// Compare positions rather than indices, so the set survives a vertex remap.
+		Vector3i t(int(p_vertices[a].x) * 1000 + int(p_vertices[a].z), int(p_vertices[b].x) * 1000 + int(p_vertices[b].z), int(p_vertices[c].x) * 1000 + int(p_vertices[c].z));
+		while (t.x > t.y || t.x > t.z) {
+			t = Vector3i(t.y, t.z, t.x);
+		}
+		ret.push_back(t);
+	}
+	ret.sort();
+	return ret;
+}
+
+static bool _has_same_triangles(const Vector<Vector3> &p_vertices_a, const Vector<int> &p_indices_a, const Vector<Vector3> &p_vertices_b, const Vector<int> &p_indices_b) {
+	Vector<Vector3i> a = _get_triangle_set(p_vertices_a, p_indices_a);
+	Vector<Vector3i> b = _get_triangle_set(p_vertices_b, p_indices_b);
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (int i = 0; i < a.size(); i++) {
+		if (a[i] != b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[MeshOptimize] Average cache miss ratio") {
+	Vector<int> indices;
+	indices.push_back(0);
+	indices.push_back(1);
+	indices.push_back(2);
+	CHECK_MESSAGE(SurfaceTool::get_acmr(indices) == doctest::Approx(3.0), "A single triangle should miss three times.");
+
+	indices.push_back(2);
+	indices.push_back(1);
+	indices.push_back(3);
+	CHECK_MESSAGE(SurfaceTool::get_acmr(indices) == doctest::Approx(2.0), "Two triangles sharing an edge should miss four times.");
+
+	CHECK_MESSAGE(SurfaceTool::get_acmr(indices, 1) == doctest::Approx(2.5), "A cache of one vertex should only reuse consecutive indices.");
+}
+
+TEST_CASE("[MeshOptimize] Vertex cache optimization") {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	make_grid(32, vertices, indices);
+	_shuffle_triangles(indices);
+
+	float acmr = SurfaceTool::get_acmr(indices);
+	Vector<int> optimized = SurfaceTool::optimize_vertex_cache_indices(indices, vertices.size());
+	float optimized_acmr = SurfaceTool::get_acmr(optimized);
+
+	CHECK_MESSAGE(_has_same_triangles(vertices, optimized, vertices, indices), "Optimization should only reorder the triangles.");
+	CHECK_MESSAGE(acmr > 2.0, "Shuffled triangles should have a poor cache miss ratio.");
+	CHECK_MESSAGE(optimized_acmr < 0.8, "A regular grid should reach a good cache miss ratio.");
+}
+
+TEST_CASE("[MeshOptimize] Overdraw optimization") {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	make_grid(32, vertices, indices);
+	_shuffle_triangles(indices);
+
+	Vector<int> cache_optimized = SurfaceTool::optimize_vertex_cache_indices(indices, vertices.size());
+	Vector<int> optimized = SurfaceTool::optimize_overdraw_indices(vertices, cache_optimized);
+
+	CHECK_MESSAGE(_has_same_triangles(vertices, optimized, vertices, indices), "Optimization should only reorder the triangles.");
+	CHECK_MESSAGE(SurfaceTool::get_acmr(optimized) < SurfaceTool::get_acmr(cache_optimized) * 1.1, "Overdraw ordering should keep most of the cache efficiency.");
+}
+
+TEST_CASE("[MeshOptimize] Vertex fetch remapping") {
+	Vector<Vector3> vertices;
+	Vector<int> indices;
+	make_grid(8, vertices, indices);
+	_shuffle_triangles(indices);
+
+	// An unused vertex should end up last.
+	vertices.insert(0, Vector3(-1, 0, -1));
+	for (int i = 0; i < indices.size(); i++) {
+		indices.write[i]++;
+	}
+
+	Vector<int> remap = SurfaceTool::optimize_vertex_fetch_remap(indices, vertices.size());
+	REQUIRE(remap.size() == vertices.size());
+	CHECK_MESSAGE(remap[0] == vertices.size() - 1, "Unused vertices should be moved to the end.");
+	CHECK_MESSAGE(remap[indices[0]] == 0, "The first used vertex should come first.");
+
+	Vector<bool> seen;
+	seen.resize(remap.size());
+	for (int i = 0; i < seen.size(); i++) {
+		seen.write[i] = false;
+	}
+	bool is_permutation = true;
+	for (int i = 0; i < remap.size(); i++) {
+		if (remap[i] < 0 || remap[i] >= remap.size() || seen[remap[i]]) {
+			is_permutation = false;
+			break;
+		}
+		seen.write[remap[i]] = true;
+	}
+	CHECK_MESSAGE(is_permutation, "The remap should be a permutation.");
+
+	Vector<Vector2> uvs;
+	for (int i = 0; i < vertices.size(); i++) {
+		uvs.push_back(Vector2(vertices[i].x, vertices[i].z));
+	}
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = vertices;
+	arrays[Mesh::ARRAY_TEX_UV] = uvs;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+	Array remapped = SurfaceTool::remap_vertex_arrays(arrays, remap);
+
+	Vector<Vector3> remapped_vertices = remapped[Mesh::ARRAY_VERTEX];
+	Vector<Vector2> remapped_uvs = remapped[Mesh::ARRAY_TEX_UV];
+	Vector<int> remapped_indices = remapped[Mesh::ARRAY_INDEX];
+	CHECK_MESSAGE(_has_same_triangles(remapped_vertices, remapped_indices, vertices, indices), "Remapping should keep every triangle in place.");
+
+	bool uvs_match = true;
+	for (int i = 0; i < remapped_vertices.size(); i++) {
+		if (remapped_uvs[i] != Vector2(remapped_vertices[i].x, remapped_vertices[i].z)) {
+			uvs_match = false;
+		}
+	}
+	CHECK_MESSAGE(uvs_match, "Every vertex attribute should be remapped the same way.");
+
+	// Indices are used in increasing order the first time they show up.
+	int next = 0;
+	bool is_linear = true;
+	for (int i = 0; i < remapped_indices.size(); i++) {
+		if (remapped_indices[i] > next) {
+			is_linear = false;
+		} else if (remapped_indices[i] == next) {
+			next++;
+		}
+	}
+	CHECK_MESSAGE(is_linear, "Vertices should be in the order they are first used.");
+}
+
+} // namespace TestMeshOptimize
+
+#endif // TEST_MESH_OPTIMIZE_H
@@ -0,0 +1,131 @@
+/*************************************************************************/
+/*  test_radix_sort.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RADIX_SORT_H
+#define TEST_RADIX_SORT_H
+
+#include "core/local_vector.h"
+#include "core/math/random_number_generator.h"
+#include "core/radix_sort.h"
+#include "core/sort_array.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestRadixSort {
+
+struct TestItem {
+	uint64_t key;
+	uint32_t order;
+};
+
+struct TestItemKey {
+	_FORCE_INLINE_ uint64_t operator()(const TestItem &p_item) const { return p_item.key; }
+};
+
+static uint64_t _random_key(RandomNumberGenerator &p_rng) {
+	return (uint64_t(p_rng.randi()) << 32) | uint64_t(p_rng.randi());
+}
+
+static bool _is_sorted_and_stable(const LocalVector<TestItem> &p_items) {
+	for (uint32_t i = 1; i < p_items.size(); i++) {
+		if (p_items[i - 1].key > p_items[i].key) {
+			return false;
+		}
+		if (p_items[i - 1].key == p_items[i].key && p_items[i - 1].order > p_items[i].order) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[RadixSort] Matches SortArray") {
+	RandomNumberGenerator rng;
+	rng.set_seed(7);
+
+	const uint32_t counts[] = { 0, 1, 2, 17, 255, 256, 1000, 100000 };
+	for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		LocalVector<uint64_t> keys;
+		LocalVector<uint64_t> expected;
+		LocalVector<uint64_t> temp;
+		keys.resize(counts[c]);
+		temp.resize(counts[c]);
+		for (uint32_t i = 0; i < counts[c]; i++) {
+			keys[i] = _random_key(rng);
+		}
+		expected = keys;
+
+		SortArray<uint64_t> sort_array;
+		sort_array.sort(expected.ptr(), expected.size());
+		RadixSort<uint64_t> radix_sort;
+		radix_sort.sort(keys.ptr(), temp.ptr(), keys.size());
+
+		bool equal = true;
+		for (uint32_t i = 0; i < counts[c]; i++) {
+			equal = equal && keys[i] == expected[i];
+		}
+		CHECK_MESSAGE(equal, "Radix sort should produce the same order as SortArray for " + itos(counts[c]) + " keys.");
+	}
+}
+
+TEST_CASE("[RadixSort] Stable with partially used keys") {
+	RandomNumberGenerator rng;
+	rng.set_seed(11);
+
+	// Render list keys leave most high bits untouched and have many duplicates,
+	// which exercises the skipped passes and stability.
+	LocalVector<TestItem> items;
+	LocalVector<TestItem> temp;
+	items.resize(100000);
+	temp.resize(items.size());
+	for (uint32_t i = 0; i < items.size(); i++) {
+		items[i].key = (uint64_t(rng.randi_range(0, 15)) << 47) | uint64_t(rng.randi_range(0, 300));
+		items[i].order = i;
+	}
+
+	RadixSort<TestItem, TestItemKey> radix_sort;
+	radix_sort.sort(items.ptr(), temp.ptr(), items.size());
+	CHECK_MESSAGE(_is_sorted_and_stable(items), "Keys should be sorted, keeping the original order of equal keys.");
+
+	// Sorting again is a no-op.
+	radix_sort.sort(items.ptr(), temp.ptr(), items.size());
+	CHECK_MESSAGE(_is_sorted_and_stable(items), "Sorting already sorted keys should keep them sorted.");
+
+	// All keys equal, every pass is skipped.
+	for (uint32_t i = 0; i < items.size(); i++) {
+		items[i].key = 42;
+		items[i].order = i;
+	}
+	radix_sort.sort(items.ptr(), temp.ptr(), items.size());
+	CHECK_MESSAGE(_is_sorted_and_stable(items), "Identical keys should keep their original order.");
+}
+
+} // namespace TestRadixSort
+
+#endif // TEST_RADIX_SORT_H
@@ -0,0 +1,171 @@
+/*************************************************************************/
+/*  test_rendering_server_canvas.h                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RENDERING_SERVER_CANVAS_H
+#define TEST_RENDERING_SERVER_CANVAS_H
+
+#include "core/local_vector.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/sort_array.h"
+#include "servers/rendering/rendering_server_canvas.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestRenderingServerCanvas {
+
+typedef RenderingServerCanvas::Item Item;
+
+// A y-sorted item with p_count children. The first child is y-sorted too and has p_count / 10 children
+// of its own. All positions are distinct multiples of 3 (plus 1 and 2 for the nested group), so the
+// sorted order is unique.
+class YSortTree {
+public:
+	Item root;
+	LocalVector<Item *> children;
+	LocalVector<Item *> grandchildren;
+	RandomPCG rng;
+
+	void set_position(Item *p_item, int p_y) {
+		p_item->xform.elements[2] = Vector2(rng.randf() * 1000.0, p_y);
+	}
+
+	YSortTree(int p_count) {
+		root.sort_y = true;
+		for (int i = 0; i < p_count; i++) {
+			Item *child = memnew(Item);
+			set_position(child, ((i * 7919) % p_count) * 3);
+			root.child_items.push_back(child);
+			children.push_back(child);
+		}
+
+		Item *group = children[0];
+		group->sort_y = true;
+		set_position(group, 1);
+		for (int i = 0; i < p_count / 10; i++) {
+			Item *child = memnew(Item);
+			set_position(child, ((i * 104729) % (p_count / 10)) * 3 + 1);
+			group->child_items.push_back(child);
+			grandchildren.push_back(child);
+		}
+	}
+
+	~YSortTree() {
+		for (uint32_t i = 0; i < children.size(); i++) {
+			memdelete(children[i]);
+		}
+		for (uint32_t i = 0; i < grandchildren.size(); i++) {
+			memdelete(grandchildren[i]);
+		}
+	}
+};
+
+static bool matches_full_sort(const LocalVector<Item *> &p_items) {
+	LocalVector<Item *> sorted = p_items;
+	SortArray<Item *, RenderingServerCanvas::ItemPtrSort> sorter;
+	sorter.sort(sorted.ptr(), sorted.size());
+
+	for (uint32_t i = 0; i < p_items.size(); i++) {
+		if (sorted[i] != p_items[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[RenderingServerCanvas] Incremental y-sort matches a full sort") {
+	const int count = 1000;
+	YSortTree tree(count);
+
+	RenderingServerCanvas::update_ysort_children(&tree.root, nullptr);
+	REQUIRE(tree.root.ysort_children.size() == uint32_t(count + count / 10));
+	CHECK(matches_full_sort(tree.root.ysort_children));
+
+	// New positions are multiples of 3 past the initial ones, so they stay distinct.
+	int next_y = count * 3;
+	const int moved_counts[] = { 1, 10, 100, 600 }; // The last one is above what is repaired incrementally.
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < moved_counts[i]; j++) {
+			tree.set_position(tree.children[1 + tree.rng.rand() % (count - 1)], next_y);
+			next_y += 3;
+		}
+		tree.root.ysort_xform_dirty = true;
+		RenderingServerCanvas::update_ysort_children(&tree.root, nullptr);
+		CHECK_MESSAGE(matches_full_sort(tree.root.ysort_children), vformat("%d items moved.", moved_counts[i]).utf8().get_data());
+	}
+
+	// Moving a nested y-sorted item moves its children in the sort.
+	tree.children[0]->xform.elements[2].y = next_y + 1;
+	tree.root.ysort_xform_dirty = true;
+	RenderingServerCanvas::update_ysort_children(&tree.root, nullptr);
+	CHECK(matches_full_sort(tree.root.ysort_children));
+	CHECK(tree.grandchildren[0]->ysort_pos.y > next_y);
+
+	// Moving items back to earlier positions.
+	for (int i = 0; i < 5; i++) {
+		tree.set_position(tree.children[1 + i * 100], i * 3 + 2);
+	}
+	tree.root.ysort_xform_dirty = true;
+	RenderingServerCanvas::update_ysort_children(&tree.root, nullptr);
+	CHECK(matches_full_sort(tree.root.ysort_children));
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[RenderingServerCanvas] Benchmark y-sorting" * doctest::skip()) {
+	const int count = 50000;
+	YSortTree tree(count);
+	RenderingServerCanvas::update_ysort_children(&tree.root, nullptr);
+
+	int next_y = count * 3;
+	const char *names[3] = { "full sort", "nothing moved", "1% moved" };
+	for (int i = 0; i < 3; i++) {
+		uint64_t best = UINT64_MAX;
+		for (int j = 0; j < 5; j++) {
+			if (i == 0) {
+				tree.root.ysort_children_count = -1; // As when an item is added or removed.
+			} else if (i == 2) {
+				for (int k = 0; k < count / 100; k++) {
+					tree.set_position(tree.children[1 + tree.rng.rand() % (count - 1)], next_y);
+					next_y += 3;
+				}
+			}
+			tree.root.ysort_xform_dirty = true;
+
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			RenderingServerCanvas::update_ysort_children(&tree.root, nullptr);
+			best = MIN(best, OS::get_singleton()->get_ticks_usec() - begin);
+		}
+		MESSAGE(vformat("%d items, %s: %.2f ms.", tree.root.ysort_children.size(), names[i], best / 1000.0).utf8().get_data());
+	}
+}
+
+} // namespace TestRenderingServerCanvas
+
+#endif // TEST_RENDERING_SERVER_CANVAS_H
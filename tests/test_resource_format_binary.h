@@ -0,0 +1,174 @@
+/*************************************************************************/
+/*  test_resource_format_binary.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RESOURCE_FORMAT_BINARY_H
+#define TEST_RESOURCE_FORMAT_BINARY_H
+
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/math/random_pcg.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestResourceFormatBinary {
+
+static const int BLOB_SIZE = 16384; // Large enough to be stored as a blob.
+
+static Vector<uint8_t> _make_bytes(int p_size, bool p_random) {
+	RandomPCG rng(1234);
+	Vector<uint8_t> bytes;
+	bytes.resize(p_size);
+	for (int i = 0; i < p_size; i++) {
+		bytes.write[i] = p_random ? uint8_t(rng.rand()) : uint8_t(i % 7);
+	}
+	return bytes;
+}
+
+static Vector<Vector3> _make_vertices(int p_count) {
+	Vector<Vector3> vertices;
+	vertices.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		vertices.write[i] = Vector3(i, i * 0.5, -i);
+	}
+	return vertices;
+}
+
+static Ref<Resource> _make_resource(int p_size) {
+	Ref<Resource> resource;
+	resource.instance();
+	resource->set_meta("compressible", _make_bytes(p_size, false));
+	resource->set_meta("random", _make_bytes(p_size, true));
+	resource->set_meta("vertices", _make_vertices(p_size / 12));
+	return resource;
+}
+
+static void _check_resource(const Ref<Resource> &p_loaded, int p_size) {
+	REQUIRE(p_loaded.is_valid());
+	CHECK(p_loaded->get_meta("compressible") == Variant(_make_bytes(p_size, false)));
+	CHECK(p_loaded->get_meta("random") == Variant(_make_bytes(p_size, true)));
+	CHECK(p_loaded->get_meta("vertices") == Variant(_make_vertices(p_size / 12)));
+}
+
+static String _make_dir() {
+	const String dir = OS::get_singleton()->get_cache_path().plus_file("godot_test_resource_format_binary");
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(dir);
+	return dir;
+}
+
+static void _remove_dir(const String &p_dir) {
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->change_dir(p_dir) == OK) {
+		da->erase_contents_recursive();
+	}
+	da->remove(p_dir);
+}
+
+TEST_CASE("[ResourceFormatBinary] Large packed arrays round-trip through blobs") {
+	const String dir = _make_dir();
+	const String path = dir.plus_file("blobs.res");
+
+	REQUIRE(ResourceSaver::save(path, _make_resource(BLOB_SIZE)) == OK);
+	_check_resource(ResourceLoader::load(path, "", true), BLOB_SIZE);
+
+	// The compressible blob is stored compressed, the random one as is.
+	const int64_t size = FileAccess::get_file_as_array(path).size();
+	CHECK(size > BLOB_SIZE);
+	CHECK(size < BLOB_SIZE * 2);
+
+	// Whole compressed files keep their blobs uncompressed.
+	REQUIRE(ResourceSaver::save(path, _make_resource(BLOB_SIZE), ResourceSaver::FLAG_COMPRESS) == OK);
+	_check_resource(ResourceLoader::load(path, "", true), BLOB_SIZE);
+
+	_remove_dir(dir);
+}
+
+TEST_CASE("[ResourceFormatBinary] Load files of format version 3") {
+	const String dir = _make_dir();
+	const String path = dir.plus_file("version_3.res");
+
+	// Without blobs, version 4 files only differ from version 3 in the version number:
+	// the blob table offset takes two of the reserved fields, and is zero.
+	const int size = 64;
+	REQUIRE(ResourceSaver::save(path, _make_resource(size)) == OK);
+	{
+		FileAccessRef f = FileAccess::open(path, FileAccess::READ_WRITE);
+		REQUIRE(f);
+		f->seek(20); // Magic, endianness, real size, engine major and minor versions.
+		REQUIRE(f->get_32() == 4);
+		f->seek(20);
+		f->store_32(3);
+	}
+
+	_check_resource(ResourceLoader::load(path, "", true), size);
+
+	_remove_dir(dir);
+}
+
+TEST_CASE("[ResourceFormatBinary] Rename dependencies of files with blobs") {
+	const String dir = _make_dir();
+	const String path = dir.plus_file("main.res");
+
+	// Dependencies are renamed by resource path. They are only kept in the resource
+	// cache, which is where they are loaded from, so nothing is written in the project.
+	Ref<Resource> dependency;
+	dependency.instance();
+	dependency->set_path("res://godot_test_dependency.res");
+	Ref<Resource> renamed_dependency;
+	renamed_dependency.instance();
+	renamed_dependency->set_path("res://godot_test_renamed_dependency.res");
+
+	Ref<Resource> resource = _make_resource(BLOB_SIZE);
+	resource->set_meta("dependency", dependency);
+	REQUIRE(ResourceSaver::save(path, resource) == OK);
+
+	// A longer path moves everything after the dependency list, the blob table included.
+	Map<String, String> renames;
+	renames[dependency->get_path()] = renamed_dependency->get_path();
+	REQUIRE(ResourceLoader::rename_dependencies(path, renames) == OK);
+
+	List<String> dependencies;
+	ResourceLoader::get_dependencies(path, &dependencies);
+	REQUIRE(dependencies.size() == 1);
+	CHECK(dependencies.front()->get() == renamed_dependency->get_path());
+
+	Ref<Resource> loaded = ResourceLoader::load(path, "", true);
+	_check_resource(loaded, BLOB_SIZE);
+	CHECK(Ref<Resource>(loaded->get_meta("dependency")) == renamed_dependency);
+
+	_remove_dir(dir);
+}
+
+} // namespace TestResourceFormatBinary
+
+#endif // TEST_RESOURCE_FORMAT_BINARY_H
@@ -0,0 +1,324 @@
+/*************************************************************************/
+/*  test_texture_streamer.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_TEXTURE_STREAMER_H
+#define TEST_TEXTURE_STREAMER_H
+
+#include "core/io/file_access_memory.h"
+#include "core/io/marshalls.h"
+#include "core/os/os.h"
+#include "core/rid_owner.h"
+#include "scene/resources/texture.h"
+#include "scene/resources/texture_streamer.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+#include <atomic>
+#include <thread>
+
+namespace TestTextureStreamer {
+
+// RGBA8 with all mipmaps, so a 256x256 texture takes 349524 bytes and its 64x64 mipmap 21844.
+static const uint64_t FULL_SIZE = 349524;
+static const uint64_t HALF_SIZE = 87380;
+static const uint64_t SMALL_SIZE = 21844;
+
+static Ref<Image> make_mipmaps(int p_width, int p_height, int p_mipmap) {
+	Ref<Image> image;
+	image.instance();
+	image->create(MAX(p_width >> p_mipmap, 1), MAX(p_height >> p_mipmap, 1), true, Image::FORMAT_RGBA8);
+	return image;
+}
+
+// Paths are the size of the texture, such as "256x128".
+class TestStorage : public TextureStreamer::Storage {
+public:
+	std::atomic<int> loads;
+
+	virtual Ref<Image> load(const String &p_path, int p_size_limit) override {
+		loads++;
+		int width = p_path.get_slice("x", 0).to_int();
+		int height = p_path.get_slice("x", 1).to_int();
+		int mipmap = 0;
+		while (MAX(width >> mipmap, 1) > p_size_limit || MAX(height >> mipmap, 1) > p_size_limit) {
+			mipmap++;
+		}
+		return make_mipmaps(width, height, mipmap);
+	}
+
+	TestStorage() {
+		loads.store(0);
+	}
+};
+
+struct TestTexture {
+	RID rid;
+	int uploads = 0;
+	int width = 0;
+};
+
+static void upload(void *p_userdata, const Ref<Image> &p_image) {
+	TestTexture *texture = (TestTexture *)p_userdata;
+	texture->uploads++;
+	texture->width = p_image->get_width();
+}
+
+class TestTextures {
+	RID_PtrOwner<TestTexture> owner;
+	List<TestTexture *> textures;
+
+public:
+	TestTexture *add(TextureStreamer &p_streamer, int p_width, int p_height) {
+		TestTexture *texture = memnew(TestTexture);
+		texture->rid = owner.make_rid(texture);
+		Ref<Image> resident = make_mipmaps(p_width, p_height, 2);
+		texture->width = resident->get_width();
+		p_streamer.register_texture(texture->rid, itos(p_width) + "x" + itos(p_height), p_width, p_height, resident, upload, texture);
+		textures.push_back(texture);
+		return texture;
+	}
+
+	~TestTextures() {
+		for (List<TestTexture *>::Element *E = textures.front(); E; E = E->next()) {
+			owner.free(E->get()->rid);
+			memdelete(E->get());
+		}
+	}
+};
+
+TEST_CASE("[TextureStreamer] Mipmaps are loaded for the size on screen") {
+	TestStorage storage;
+	TextureStreamer streamer;
+	streamer.set_storage(&storage);
+	streamer.init(0, 64 * 1024 * 1024, 64);
+
+	TestTextures textures;
+	TestTexture *texture = textures.add(streamer, 256, 256);
+	CHECK(streamer.get_resident_mipmap(texture->rid) == 2);
+	CHECK(streamer.get_memory_usage() == SMALL_SIZE);
+
+	streamer.update();
+	CHECK_MESSAGE(storage.loads == 0, "Nothing is loaded before the texture is drawn.");
+
+	streamer.report_usage(texture->rid, 100);
+	streamer.update();
+	CHECK(streamer.get_resident_mipmap(texture->rid) == 1);
+	CHECK(texture->width == 128);
+
+	streamer.report_usage(texture->rid, 300);
+	streamer.update();
+	CHECK(streamer.get_resident_mipmap(texture->rid) == 0);
+	CHECK(texture->width == 256);
+	CHECK(streamer.get_memory_usage() == FULL_SIZE);
+
+	for (int i = 0; i < 10; i++) {
+		streamer.update();
+	}
+	CHECK_MESSAGE(streamer.get_resident_mipmap(texture->rid) == 0, "Mipmaps are kept while within budget.");
+	CHECK(storage.loads == 2);
+
+	streamer.set_texture_pinned(texture->rid, true);
+	streamer.set_memory_budget(0);
+	streamer.update();
+	CHECK_MESSAGE(streamer.get_resident_mipmap(texture->rid) == 0, "Pinned textures keep all their mipmaps.");
+	streamer.set_texture_pinned(texture->rid, false);
+	streamer.update();
+	CHECK(streamer.get_resident_mipmap(texture->rid) == 2);
+	CHECK(texture->width == 64);
+
+	streamer.finish();
+}
+
+TEST_CASE("[TextureStreamer] Least recently used textures are dropped when over budget") {
+	TestStorage storage;
+	TextureStreamer streamer;
+	streamer.set_storage(&storage);
+	streamer.init(0, FULL_SIZE + SMALL_SIZE + 1024, 64);
+
+	TestTextures textures;
+	TestTexture *a = textures.add(streamer, 256, 256);
+	TestTexture *b = textures.add(streamer, 256, 256);
+
+	streamer.report_usage(a->rid, 256);
+	streamer.update();
+	CHECK(streamer.get_resident_mipmap(a->rid) == 0);
+
+	streamer.update();
+	streamer.report_usage(b->rid, 256);
+	streamer.update();
+	CHECK(streamer.get_resident_mipmap(a->rid) == 2);
+	CHECK(a->width == 64);
+	CHECK(streamer.get_resident_mipmap(b->rid) == 0);
+	CHECK(streamer.get_memory_usage() <= streamer.get_memory_budget());
+}
+
+TEST_CASE("[TextureStreamer] Textures in use share the budget") {
+	TestStorage storage;
+	TextureStreamer streamer;
+	streamer.set_storage(&storage);
+	streamer.init(0, FULL_SIZE + HALF_SIZE + 1024, 64);
+
+	TestTextures textures;
+	TestTexture *a = textures.add(streamer, 256, 256);
+	TestTexture *b = textures.add(streamer, 256, 256);
+
+	for (int i = 0; i < 4; i++) {
+		streamer.report_usage(a->rid, 256);
+		streamer.report_usage(b->rid, 256);
+		streamer.update();
+	}
+
+	// Neither is dropped for the other, so one of them settles for a smaller mipmap.
+	int mipmaps[2] = { streamer.get_resident_mipmap(a->rid), streamer.get_resident_mipmap(b->rid) };
+	CHECK(MIN(mipmaps[0], mipmaps[1]) == 0);
+	CHECK(MAX(mipmaps[0], mipmaps[1]) == 1);
+	CHECK(streamer.get_memory_usage() <= streamer.get_memory_budget());
+}
+
+TEST_CASE("[TextureStreamer] Loading threads") {
+	TestStorage storage;
+	TextureStreamer streamer;
+	streamer.set_storage(&storage);
+	streamer.init(1, 64 * 1024 * 1024, 64);
+
+	TestTextures textures;
+	TestTexture *texture = textures.add(streamer, 512, 256);
+	TestTexture *unregistered = textures.add(streamer, 256, 256);
+
+	streamer.report_usage(texture->rid, 512);
+	streamer.report_usage(unregistered->rid, 256);
+	streamer.update();
+	CHECK(streamer.get_memory_usage() == Image::get_image_data_size(512, 256, Image::FORMAT_RGBA8, true) + FULL_SIZE);
+	streamer.unregister_texture(unregistered->rid);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_msec();
+	while (streamer.has_pending_loads() && OS::get_singleton()->get_ticks_msec() - begin < 5000) {
+		OS::get_singleton()->delay_usec(1000);
+		streamer.update();
+	}
+	CHECK(streamer.get_resident_mipmap(texture->rid) == 0);
+	CHECK(texture->width == 512);
+	CHECK_MESSAGE(unregistered->uploads == 0, "Loads of unregistered textures are discarded.");
+
+	streamer.finish();
+	CHECK(!streamer.is_texture_registered(texture->rid));
+}
+
+struct SlowUpload {
+	std::atomic<bool> started;
+	std::atomic<bool> finished;
+	std::atomic<bool> unregistered_after_upload;
+};
+
+static void slow_upload(void *p_userdata, const Ref<Image> &p_image) {
+	SlowUpload *upload = (SlowUpload *)p_userdata;
+	upload->started.store(true);
+	OS::get_singleton()->delay_usec(50000);
+	upload->finished.store(true);
+}
+
+static void unregister_during_upload(TextureStreamer *p_streamer, RID p_texture, SlowUpload *p_upload) {
+	while (!p_upload->started.load()) {
+		OS::get_singleton()->delay_usec(100);
+	}
+	p_streamer->unregister_texture(p_texture);
+	p_upload->unregistered_after_upload.store(p_upload->finished.load());
+}
+
+TEST_CASE("[TextureStreamer] Unregistering waits for the upload in progress") {
+	TestStorage storage;
+	TextureStreamer streamer;
+	streamer.set_storage(&storage);
+	streamer.init(0, 64 * 1024 * 1024, 64);
+
+	// Stream textures unregister from their destructor, the callback userdata must stay valid until the upload returns.
+	SlowUpload upload;
+	upload.started.store(false);
+	upload.finished.store(false);
+	upload.unregistered_after_upload.store(false);
+
+	RID_PtrOwner<SlowUpload> owner;
+	RID rid = owner.make_rid(&upload);
+	streamer.register_texture(rid, "256x256", 256, 256, make_mipmaps(256, 256, 2), slow_upload, &upload);
+	streamer.report_usage(rid, 256);
+	streamer.update(); // Loads without threads.
+
+	std::thread thread(unregister_during_upload, &streamer, rid, &upload);
+	streamer.update(); // Uploads.
+	thread.join();
+
+	CHECK(upload.started.load());
+	CHECK_MESSAGE(upload.unregistered_after_upload.load(), "Unregistering must not return while the texture is being uploaded.");
+	CHECK(!streamer.is_texture_registered(rid));
+
+	streamer.finish();
+	owner.free(rid);
+}
+
+TEST_CASE("[TextureStreamer] Stream textures load the mipmaps within the size limit") {
+	// The image part of a .stex file, each mipmap filled with its index.
+	Ref<Image> image = make_mipmaps(256, 128, 0);
+	Vector<uint8_t> pixels = image->get_data();
+	for (int i = 0; i <= image->get_mipmap_count(); i++) {
+		int begin = Image::get_image_mipmap_offset(256, 128, Image::FORMAT_RGBA8, i);
+		int end = i < image->get_mipmap_count() ? Image::get_image_mipmap_offset(256, 128, Image::FORMAT_RGBA8, i + 1) : pixels.size();
+		memset(pixels.ptrw() + begin, i, end - begin);
+	}
+
+	Vector<uint8_t> data;
+	data.resize(16 + pixels.size());
+	encode_uint32(StreamTexture2D::DATA_FORMAT_IMAGE, data.ptrw());
+	encode_uint16(256, data.ptrw() + 4);
+	encode_uint16(128, data.ptrw() + 6);
+	encode_uint32(image->get_mipmap_count(), data.ptrw() + 8);
+	encode_uint32(Image::FORMAT_RGBA8, data.ptrw() + 12);
+	copymem(data.ptrw() + 16, pixels.ptr(), pixels.size());
+
+	const int limits[] = { 0, 256, 64, 1 };
+	const int mipmaps[] = { 0, 0, 2, image->get_mipmap_count() };
+	for (int i = 0; i < 4; i++) {
+		FileAccessMemory f;
+		f.open_custom(data.ptr(), data.size());
+		int width, height;
+		Ref<Image> loaded = StreamTexture2D::load_image_from_file(&f, limits[i], &width, &height);
+
+		REQUIRE(loaded.is_valid());
+		CHECK(width == 256);
+		CHECK(height == 128);
+		CHECK(loaded->get_width() == MAX(256 >> mipmaps[i], 1));
+		CHECK(loaded->get_height() == MAX(128 >> mipmaps[i], 1));
+		CHECK(loaded->get_mipmap_count() == image->get_mipmap_count() - mipmaps[i]);
+		CHECK(loaded->get_data()[0] == mipmaps[i]);
+	}
+}
+
+} // namespace TestTextureStreamer
+
+#endif // TEST_TEXTURE_STREAMER_H
@@ -31,6 +31,9 @@
 #ifndef TEST_VARIANT_H
 #define TEST_VARIANT_H
 
+#include "core/io/file_access_memory.h"
+#include "core/local_vector.h"
+#include "core/os/os.h"
 #include "core/variant.h"
 #include "core/variant_parser.h"
 
@@ -106,6 +109,136 @@ TEST_CASE("[Variant] Writer and parser float") {
 	CHECK_MESSAGE(b64_float_parsed == 340282001837565597733306976381245063168.0, "Should not overflow.");
 }
 
+TEST_CASE("[Variant] Parser tokens") {
+	VariantParser::StreamString ss;
+	String errs;
+	int line;
+	Variant parsed;
+
+	ss.s = "[1, -25, 0.5, -1.25e2, 123456789.125, \"a\\u00e9b\\n\", @\"name\"]";
+	REQUIRE(VariantParser::parse(&ss, parsed, errs, line) == OK);
+	Array a = parsed;
+	REQUIRE(a.size() == 7);
+	CHECK(a[0].get_type() == Variant::INT);
+	CHECK(int64_t(a[0]) == 1);
+	CHECK(int64_t(a[1]) == -25);
+	CHECK(a[2].get_type() == Variant::FLOAT);
+	CHECK(double(a[2]) == 0.5);
+	CHECK(double(a[3]) == -125.0);
+	CHECK(double(a[4]) == 123456789.125);
+	CHECK(String(a[5]) == "a" + String::chr(0xe9) + "b\n");
+	CHECK(a[6].get_type() == Variant::STRING_NAME);
+}
+
+TEST_CASE("[Variant] Parser long strings") {
+	// Longer than the stream's read-ahead buffer.
+	String long_str;
+	for (int i = 0; i < 5000; i++) {
+		long_str += String::chr('a' + (i % 26));
+	}
+
+	VariantParser::StreamString ss;
+	ss.readahead_enabled = true;
+	ss.s = "\"" + long_str + "\"";
+	String errs;
+	int line;
+	Variant parsed;
+
+	REQUIRE(VariantParser::parse(&ss, parsed, errs, line) == OK);
+	CHECK(String(parsed) == long_str);
+}
+
+TEST_CASE("[Variant] Parser file position") {
+	CharString text = String("[remap]\n\npath=\"res://a.stex\"\n").utf8();
+	String errs;
+	int line = 1;
+	VariantParser::Tag tag;
+
+	FileAccessMemory f;
+	f.open_custom((const uint8_t *)text.get_data(), text.length());
+	VariantParser::StreamFile stream;
+	stream.f = &f;
+	REQUIRE(VariantParser::parse_tag(&stream, line, errs, tag) == OK);
+	CHECK(tag.name == "remap");
+	CHECK_MESSAGE(f.get_position() == 7, "Without read-ahead, the file should not be read past the parsed tag.");
+
+	FileAccessMemory f_readahead;
+	f_readahead.open_custom((const uint8_t *)text.get_data(), text.length());
+	VariantParser::StreamFile stream_readahead;
+	stream_readahead.f = &f_readahead;
+	stream_readahead.readahead_enabled = true;
+	REQUIRE(VariantParser::parse_tag(&stream_readahead, line, errs, tag) == OK);
+	CHECK(tag.name == "remap");
+	CHECK_MESSAGE(f_readahead.get_position() > 7, "With read-ahead, the file is read in blocks past the parsed tag.");
+}
+
+// A scene in the text format with p_nodes nodes, about 440 bytes each.
+static void make_text_scene(int p_nodes, LocalVector<uint8_t> &r_data) {
+	String header = "[gd_scene load_steps=1 format=2]\n\n[node name=\"Root\" type=\"Node3D\"]\n\n";
+	CharString header_utf8 = header.utf8();
+	r_data.clear();
+	for (int i = 0; i < header_utf8.length(); i++) {
+		r_data.push_back(header_utf8[i]);
+	}
+
+	for (int i = 0; i < p_nodes; i++) {
+		String node = vformat("[node name=\"Mesh%d\" type=\"MeshInstance3D\" parent=\".\"]\n", i);
+		node += vformat("transform = Transform( 0.866025, 0, 0.5, 0, 1, 0, -0.5, 0, 0.866025, %d.25, 1.5, -%d.125 )\n", i % 1000, i % 777);
+		node += vformat("visible = %s\n", (i & 1) ? "true" : "false");
+		node += vformat("modulate = Color( 1, 0.%d, 0.5, 1 )\n", i % 10);
+		node += vformat("extra_cull_margin = %f\n", i * 0.001);
+		node += vformat("editor_description = \"Prop number %d, placed by hand. \\\"Quoted\\\" text.\"\n", i);
+		node += "lod_distances = PackedFloat32Array( 10, 25.5, 50, 100 )\n";
+		node += vformat("metadata/tags = [ \"static\", \"prop\", %d, { \"weight\": 0.75, \"layer\": 3 } ]\n\n", i);
+		CharString node_utf8 = node.utf8();
+		for (int j = 0; j < node_utf8.length(); j++) {
+			r_data.push_back(node_utf8[j]);
+		}
+	}
+}
+
+// Skipped by default, run it with --no-skip.
+TEST_CASE("[Variant] Benchmark parsing a large text scene" * doctest::skip()) {
+	const int nodes = 120000; // About 50 MB.
+	LocalVector<uint8_t> data;
+	make_text_scene(nodes, data);
+
+	// The same loop as ResourceLoaderText, reading from a file.
+	FileAccessMemory f;
+	f.open_custom(data.ptr(), data.size());
+	VariantParser::StreamFile stream;
+	stream.f = &f;
+	stream.readahead_enabled = true;
+
+	int tags = 0;
+	int assigns = 0;
+	int line = 1;
+	String error;
+	Error err = OK;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	while (true) {
+		VariantParser::Tag tag;
+		String assign;
+		Variant value;
+		err = VariantParser::parse_tag_assign_eof(&stream, line, error, tag, assign, value);
+		if (err != OK) {
+			break;
+		}
+		if (assign != String()) {
+			assigns++;
+		} else {
+			tags++;
+		}
+	}
+	uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - begin, uint64_t(1));
+
+	MESSAGE(vformat("%.1f MB scene: %.0f ms, %.1f MB/s.", data.size() / 1048576.0, usec / 1000.0, data.size() / 1048576.0 / (usec / 1000000.0)).utf8().get_data());
+	CHECK_MESSAGE(err == ERR_FILE_EOF, error.utf8().get_data());
+	CHECK(tags == nodes + 2);
+	CHECK(assigns == nodes * 7);
+}
+
 } // namespace TestVariant
 
 #endif // TEST_VARIANT_H
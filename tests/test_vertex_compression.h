@@ -0,0 +1,108 @@
+/*************************************************************************/
+/*  test_vertex_compression.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_VERTEX_COMPRESSION_H
+#define TEST_VERTEX_COMPRESSION_H
+
+#include "core/math/vector3.h"
+
+#include "thirdparty/doctest/doctest.h"
+
+namespace TestVertexCompression {
+
+// Same rounding as the 16 bits snorm storage used by the rendering server.
+static Vector2 _quantize(const Vector2 &p_oct) {
+	return Vector2(Math::round(p_oct.x * 32767) / 32767, Math::round(p_oct.y * 32767) / 32767);
+}
+
+// Points spread over the whole sphere, including the axes and the octahedron folds.
+static Vector<Vector3> _get_directions() {
+	Vector<Vector3> ret;
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -1; j <= 1; j++) {
+			for (int k = -1; k <= 1; k++) {
+				if (i || j || k) {
+					ret.push_back(Vector3(i, j, k).normalized());
+				}
+			}
+		}
+	}
+	for (int i = 0; i < 1000; i++) {
+		real_t z = 1.0 - 2.0 * (i + 0.5) / 1000;
+		real_t r = Math::sqrt(1.0 - z * z);
+		real_t phi = i * 2.399963; // Golden angle.
+		ret.push_back(Vector3(r * Math::cos(phi), r * Math::sin(phi), z));
+	}
+	return ret;
+}
+
+TEST_CASE("[VertexCompression] Octahedral normals") {
+	Vector<Vector3> directions = _get_directions();
+
+	real_t max_error = 0; // In radians.
+	bool in_range = true;
+	for (int i = 0; i < directions.size(); i++) {
+		Vector2 oct = directions[i].octahedron_encode();
+		if (Math::abs(oct.x) > 1 || Math::abs(oct.y) > 1) {
+			in_range = false;
+		}
+		Vector3 decoded = Vector3::octahedron_decode(_quantize(oct));
+		// The chord is as good as the angle at this scale, and more precise than acos() in single precision.
+		max_error = MAX(max_error, decoded.distance_to(directions[i]));
+	}
+
+	CHECK_MESSAGE(in_range, "Encoded normals should fit in [-1, 1].");
+	CHECK_MESSAGE(Math::rad2deg(max_error) < 0.01, "16 bits octahedral normals should be within a hundredth of a degree.");
+	CHECK_MESSAGE(Vector3::octahedron_decode(Vector3().octahedron_encode()).is_normalized(), "A zero vector should still decode to a unit vector.");
+}
+
+TEST_CASE("[VertexCompression] Octahedral tangents keep the binormal sign") {
+	Vector<Vector3> directions = _get_directions();
+
+	real_t max_error = 0; // In radians.
+	bool signs_match = true;
+	for (int i = 0; i < directions.size(); i++) {
+		real_t sign = (i % 2) ? 1 : -1;
+		Vector2 oct = _quantize(directions[i].octahedron_tangent_encode(sign));
+		real_t decoded_sign = 0;
+		Vector3 decoded = Vector3::octahedron_tangent_decode(oct, &decoded_sign);
+		if (decoded_sign != sign) {
+			signs_match = false;
+		}
+		max_error = MAX(max_error, decoded.distance_to(directions[i]));
+	}
+
+	CHECK_MESSAGE(signs_match, "The binormal sign should survive quantization.");
+	CHECK_MESSAGE(Math::rad2deg(max_error) < 0.02, "16 bits octahedral tangents should be within two hundredths of a degree.");
+}
+
+} // namespace TestVertexCompression
+
+#endif // TEST_VERTEX_COMPRESSION_H